@@ -0,0 +1,273 @@
+#!/usr/bin/python3
+#
+# Copyright (C) 2026 Red Hat, Inc.
+#
+# Licensed under the GNU Lesser General Public License Version 2.1
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+#
+
+"""
+Measure the hawkey Python calls on a synthetic repository and compare two builds.
+
+Every case runs in its own interpreter with the hawkey module of the given build
+on PYTHONPATH, so the peak RSS of a case is not hidden by the cases before it.
+The cases of two builds are run alternately, one after the other, to spread any
+drift of the machine evenly over both:
+
+    benchmarks/generate-repo.py --packages 200000 /tmp/synthetic
+    benchmarks/bench-python.py --repo /tmp/synthetic build-before build-after
+
+Without --repo, a repository of --packages packages is generated in a temporary
+directory with generate-repo.py.
+"""
+
+
+import argparse
+import json
+import os
+import random
+import resource
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+import xml.etree.ElementTree as ET
+
+
+REPO_NAME = "synthetic"
+REPOMD_NS = "{http://linux.duke.edu/metadata/repo}"
+SAMPLE = 50
+
+
+def get_parser():
+    """
+    Construct argument parser.
+
+    :returns: ArgumentParser object with arguments set up.
+    :rtype: argparse.ArgumentParser
+    """
+    parser = argparse.ArgumentParser(
+        description="Measure the hawkey Python calls on a synthetic repository and compare two builds.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter,
+    )
+    parser.add_argument("builds", metavar="build_directory", nargs="*",
+                        help="build directories to compare, the hawkey module is imported from "
+                             "<build_directory>/src/python; the installed hawkey is used when none "
+                             "is given")
+    parser.add_argument("--repo",
+                        help="directory with the repodata/ of a repository from generate-repo.py")
+    parser.add_argument("--packages", type=int, default=10000,
+                        help="number of packages of the generated repository when --repo is not given")
+    parser.add_argument("--repeat", type=int, default=5,
+                        help="number of measured runs of every case")
+    parser.add_argument("--cases", nargs="+", metavar="CASE", choices=sorted(CASES),
+                        default=sorted(CASES),
+                        help="cases to run, of: %s" % ", ".join(sorted(CASES)))
+    parser.add_argument("--output", help="write the results as JSON to this file")
+    parser.add_argument("--child", choices=sorted(CASES), help=argparse.SUPPRESS)
+    return parser
+
+
+# the measured process
+
+
+def metadata_files(path):
+    """Returns the paths of the metadata of the repository by their type, read from repomd.xml."""
+    repomd = os.path.join(path, "repodata", "repomd.xml")
+    files = {"repomd": repomd}
+    for data in ET.parse(repomd).getroot().iter(REPOMD_NS + "data"):
+        files[data.get("type")] = os.path.join(path, data.find(REPOMD_NS + "location").get("href"))
+    return files
+
+
+def new_sack(hawkey, cachedir):
+    return hawkey.Sack(cachedir=cachedir, arch="x86_64", make_cache_dir=True,
+                       logfile=os.path.join(cachedir, "hawkey.log"))
+
+
+def load_repo(hawkey, sack, path):
+    files = metadata_files(path)
+    repo = hawkey.Repo(REPO_NAME)
+    repo.repomd_fn = files["repomd"]
+    repo.primary_fn = files["primary"]
+    repo.filelists_fn = files["filelists"]
+    if "updateinfo" in files:
+        repo.updateinfo_fn = files["updateinfo"]
+    sack.load_repo(repo, load_filelists=True, load_updateinfo="updateinfo" in files)
+
+
+def sample_names(sack, hawkey):
+    names = sorted(set(pkg.name for pkg in hawkey.Query(sack)))
+    return random.Random(0).sample(names, min(SAMPLE, len(names)))
+
+
+def case_load_repo(hawkey, path, cachedir):
+    def run():
+        load_repo(hawkey, new_sack(hawkey, cachedir), path)
+    return run
+
+
+def case_query(hawkey, path, cachedir, **filters):
+    sack = new_sack(hawkey, cachedir)
+    load_repo(hawkey, sack, path)
+
+    def run():
+        hawkey.Query(sack).filter(**filters).run()
+    return run
+
+
+def case_goal_install(hawkey, path, cachedir):
+    sack = new_sack(hawkey, cachedir)
+    load_repo(hawkey, sack, path)
+    names = sample_names(sack, hawkey)
+
+    def run():
+        goal = hawkey.Goal(sack)
+        for name in names:
+            goal.install(select=hawkey.Selector(sack).set(name=name))
+        if not goal.run():
+            raise RuntimeError("goal failed: %s" % goal.problem_rules())
+    return run
+
+
+def case_subject_best_query(hawkey, path, cachedir):
+    sack = new_sack(hawkey, cachedir)
+    load_repo(hawkey, sack, path)
+    specs = sample_names(sack, hawkey)
+    specs += ["%s*" % name for name in specs[:5]]
+    specs += ["/usr/bin/%s" % name for name in specs[:5]]
+
+    def run():
+        for spec in specs:
+            hawkey.Subject(spec).get_best_query(sack).run()
+    return run
+
+
+CASES = {
+    "load_repo": case_load_repo,
+    "query_name": lambda *args: case_query(*args, name="pkg1"),
+    "query_glob": lambda *args: case_query(*args, name__glob="pkg1*"),
+    "query_provides": lambda *args: case_query(*args, provides="libpkg1.so.1()(64bit)"),
+    "query_requires": lambda *args: case_query(*args, requires="pkg1"),
+    "query_file": lambda *args: case_query(*args, file="/usr/share/pkg1/data0"),
+    "query_latest": lambda *args: case_query(*args, latest_per_arch=True),
+    "goal_install": case_goal_install,
+    "subject_best_query": case_subject_best_query,
+}
+
+
+def run_child(args):
+    """Runs one case in this process and prints its timings as JSON."""
+    import hawkey
+
+    cachedir = tempfile.mkdtemp(prefix="libdnf-bench-")
+    try:
+        run = CASES[args.child](hawkey, args.repo, cachedir)
+        rss_setup = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        times = []
+        for _ in range(args.repeat):
+            start = time.perf_counter()
+            run()
+            times.append(time.perf_counter() - start)
+        rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    finally:
+        shutil.rmtree(cachedir, ignore_errors=True)
+    json.dump({"hawkey": os.path.dirname(hawkey.__file__), "times": times,
+               "maxrss_kb": rss, "maxrss_growth_kb": rss - rss_setup}, sys.stdout)
+
+
+# the driver
+
+
+def build_env(build):
+    env = dict(os.environ)
+    if build is not None:
+        pythonpath = os.path.join(build, "src", "python")
+        if not os.path.isdir(pythonpath):
+            pythonpath = build
+        env["PYTHONPATH"] = os.path.abspath(pythonpath)
+        env["LD_LIBRARY_PATH"] = os.pathsep.join(
+            filter(None, [os.path.abspath(os.path.join(build, "libdnf")), env.get("LD_LIBRARY_PATH")]))
+    return env
+
+
+def run_case(build, case, args):
+    cmd = [sys.executable, os.path.abspath(__file__), "--child", case, "--repo", args.repo,
+           "--repeat", str(args.repeat)]
+    out = subprocess.run(cmd, env=build_env(build), stdout=subprocess.PIPE, check=True).stdout
+    result = json.loads(out.decode("utf-8"))
+    times = result["times"]
+    result["min"] = min(times)
+    result["median"] = statistics.median(times)
+    return result
+
+
+def print_results(builds, results, cases):
+    labels = [build or "installed" for build in builds]
+    header = "%-20s" % "case"
+    for label in labels:
+        header += " %12s %10s" % ("median ms", "rss MiB")
+    if len(builds) == 2:
+        header += " %8s %10s" % ("time", "rss")
+    print(header)
+    for case in cases:
+        line = "%-20s" % case
+        for label in labels:
+            res = results[label][case]
+            line += " %12.2f %10.1f" % (res["median"] * 1000, res["maxrss_kb"] / 1024.0)
+        if len(builds) == 2:
+            a, b = results[labels[0]][case], results[labels[1]][case]
+            line += " %+7.1f%% %+9.1fM" % ((b["median"] / a["median"] - 1) * 100 if a["median"] else 0,
+                                          (b["maxrss_kb"] - a["maxrss_kb"]) / 1024.0)
+        print(line)
+
+
+def main():
+    args = get_parser().parse_args()
+    if args.child:
+        run_child(args)
+        return
+
+    builds = args.builds or [None]
+    if len(builds) > 2:
+        sys.exit("at most two builds can be compared")
+
+    tmpdir = None
+    if not args.repo:
+        tmpdir = tempfile.mkdtemp(prefix="libdnf-bench-repo-")
+        args.repo = tmpdir
+        subprocess.run([sys.executable, os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                     "generate-repo.py"),
+                        "--packages", str(args.packages), tmpdir], check=True)
+    try:
+        results = {build or "installed": {} for build in builds}
+        for case in args.cases:
+            for build in builds:
+                results[build or "installed"][case] = run_case(build, case, args)
+    finally:
+        if tmpdir:
+            shutil.rmtree(tmpdir, ignore_errors=True)
+
+    print_results(builds, results, args.cases)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"repo": args.repo, "repeat": args.repeat, "results": results}, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,373 @@
+#!/usr/bin/python3
+#
+# Copyright (C) 2026 Red Hat, Inc.
+#
+# Licensed under the GNU Lesser General Public License Version 2.1
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+#
+
+"""
+Generate a synthetic rpm-md repository for scale testing of libdnf.
+
+The repository has repomd.xml, primary, filelists, updateinfo and modules
+metadata, but no packages. Package N requires capabilities of packages with
+lower numbers, the low numbers are required the most, like the core libraries
+of a distribution. The output only depends on the arguments, running the
+generator twice with the same seed gives the same repository.
+
+Generating an older and a newer release of the same packages gives a pair of
+repositories to use as the installed system and as the updates:
+
+    generate-repo.py --packages 1000000 --release 1 /tmp/system
+    generate-repo.py --packages 1000000 --release 2 /tmp/updates
+"""
+
+
+import argparse
+import gzip
+import hashlib
+import os
+import random
+import time
+from xml.sax.saxutils import escape, quoteattr
+
+
+REPO_NAME = "synthetic"
+
+
+def get_parser():
+    """
+    Construct argument parser.
+
+    :returns: ArgumentParser object with arguments set up.
+    :rtype: argparse.ArgumentParser
+    """
+    parser = argparse.ArgumentParser(
+        description="Generate a synthetic rpm-md repository for scale testing of libdnf.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter,
+    )
+    parser.add_argument("path", metavar="output_directory",
+                        help="directory to create the repodata/ directory in")
+    parser.add_argument("--packages", type=int, default=10000,
+                        help="number of non-modular packages")
+    parser.add_argument("--requires", type=float, default=4.0,
+                        help="average number of requires of a package")
+    parser.add_argument("--rich", type=float, default=0.05,
+                        help="fraction of the requires which are rich dependencies")
+    parser.add_argument("--files", type=int, default=20,
+                        help="average number of files of a package")
+    parser.add_argument("--modules", type=int, default=0,
+                        help="number of modules")
+    parser.add_argument("--streams", type=int, default=2,
+                        help="number of streams of every module")
+    parser.add_argument("--module-packages", type=int, default=20,
+                        help="number of packages in every module stream")
+    parser.add_argument("--advisories", type=float, default=0.1,
+                        help="fraction of the packages fixed by an advisory")
+    parser.add_argument("--release", default="1",
+                        help="release of all the packages")
+    parser.add_argument("--seed", type=int, default=0,
+                        help="seed of the random generator")
+    return parser
+
+
+class MetadataFile(object):
+    """
+    Gzip compressed metadata file which records the checksum and the size
+    of its content for repomd.xml.
+    """
+
+    def __init__(self, repodata, md_type):
+        self.repodata = repodata
+        self.md_type = md_type
+        self.path = os.path.join(repodata, "%s.xml.gz" % md_type)
+        self.open_checksum = hashlib.sha256()
+        self.open_size = 0
+        self.chunks = []
+        self.file = gzip.open(self.path, "wb", compresslevel=6)
+
+    def write(self, text):
+        self.chunks.append(text)
+        if len(self.chunks) >= 1024:
+            self.flush()
+
+    def flush(self):
+        data = "".join(self.chunks).encode("utf-8")
+        self.chunks = []
+        self.open_checksum.update(data)
+        self.open_size += len(data)
+        self.file.write(data)
+
+    def close(self, href_suffix=".xml.gz"):
+        """
+        Finish the file and rename it to <checksum>-<type>.xml.gz.
+
+        :returns: <data> element of repomd.xml
+        :rtype: str
+        """
+        self.flush()
+        self.file.close()
+        checksum = hashlib.sha256()
+        with open(self.path, "rb") as f:
+            for block in iter(lambda: f.read(1 << 20), b""):
+                checksum.update(block)
+        name = "%s-%s%s" % (checksum.hexdigest(), self.md_type, href_suffix)
+        os.rename(self.path, os.path.join(self.repodata, name))
+        return (
+            '<data type="%s">\n'
+            '  <checksum type="sha256">%s</checksum>\n'
+            '  <open-checksum type="sha256">%s</open-checksum>\n'
+            '  <location href="repodata/%s"/>\n'
+            '  <timestamp>%d</timestamp>\n'
+            '  <size>%d</size>\n'
+            '  <open-size>%d</open-size>\n'
+            '</data>\n' % (self.md_type, checksum.hexdigest(), self.open_checksum.hexdigest(),
+                           name, int(time.time()), os.path.getsize(os.path.join(self.repodata, name)),
+                           self.open_size))
+
+
+class Package(object):
+
+    def __init__(self, num, name, version, release, arch):
+        self.num = num
+        self.name = name
+        self.version = version
+        self.release = release
+        self.arch = arch
+
+    def nevra(self):
+        return "%s-0:%s-%s.%s" % (self.name, self.version, self.release, self.arch)
+
+    def filename(self):
+        return "%s-%s-%s.%s.rpm" % (self.name, self.version, self.release, self.arch)
+
+
+def entry(name, flags=None, version=None):
+    if flags is None:
+        return '<rpm:entry name=%s/>' % quoteattr(name)
+    return '<rpm:entry name=%s flags="%s" epoch="0" ver="%s"/>' % (quoteattr(name), flags, version)
+
+
+def soname(num):
+    return "libpkg%d.so.1()(64bit)" % num
+
+
+def pick_required(rng, num):
+    """Lower numbers are picked more often, as the core libraries are required by most packages."""
+    return int(num * rng.random() ** 3)
+
+
+def requires_of(rng, args, pkg, packages):
+    limit = min(pkg.num, len(packages))
+    if limit == 0:
+        return []
+    count = int(rng.expovariate(1.0 / args.requires)) if args.requires > 0 else 0
+    requires = []
+    for _ in range(count):
+        dep = packages[pick_required(rng, limit)]
+        kind = rng.random()
+        if rng.random() < args.rich and limit > 1:
+            other = packages[pick_required(rng, limit)]
+            if kind < 0.5:
+                requires.append(entry("(%s or %s)" % (dep.name, other.name)))
+            else:
+                requires.append(entry("(%s if %s)" % (dep.name, other.name)))
+        elif kind < 0.4 and dep.arch != "noarch":
+            requires.append(entry(soname(dep.num)))
+        elif kind < 0.7:
+            requires.append(entry(dep.name, "GE", dep.version))
+        elif kind < 0.9:
+            requires.append(entry("config(%s)" % dep.name))
+        else:
+            requires.append(entry("/usr/bin/%s" % dep.name))
+    # the same capability is often picked twice for the low numbers
+    return sorted(set(requires), key=requires.index)
+
+
+def files_of(rng, args, pkg):
+    """Returns the primary files, which are listed in primary.xml, and all the files."""
+    primary = ["/usr/bin/%s" % pkg.name, "/etc/%s.conf" % pkg.name]
+    files = list(primary)
+    if pkg.arch != "noarch":
+        files.append("/usr/lib64/libpkg%d.so.1" % pkg.num)
+    count = int(rng.expovariate(1.0 / args.files)) if args.files > 0 else 0
+    files.extend("/usr/share/%s/data%d" % (pkg.name, i) for i in range(count))
+    return primary, files
+
+
+def write_package(primary, filelists, rng, args, pkg, packages):
+    pkgid = hashlib.sha256(pkg.nevra().encode("utf-8")).hexdigest()
+    primary_files, files = files_of(rng, args, pkg)
+    provides = [entry(pkg.name, "EQ", pkg.version), entry("config(%s)" % pkg.name, "EQ", pkg.version)]
+    if pkg.arch != "noarch":
+        provides.append(entry(soname(pkg.num)))
+    requires = requires_of(rng, args, pkg, packages)
+    size = 4096 * (1 + len(files))
+
+    out = [
+        '<package type="rpm">\n',
+        '  <name>%s</name>\n' % pkg.name,
+        '  <arch>%s</arch>\n' % pkg.arch,
+        '  <version epoch="0" ver="%s" rel="%s"/>\n' % (pkg.version, escape(pkg.release)),
+        '  <checksum type="sha256" pkgid="YES">%s</checksum>\n' % pkgid,
+        '  <summary>Synthetic package %d</summary>\n' % pkg.num,
+        '  <description>Synthetic package number %d generated for the scale testing of libdnf.'
+        '</description>\n' % pkg.num,
+        '  <packager>libdnf</packager>\n',
+        '  <url>https://example.com/%s</url>\n' % pkg.name,
+        '  <time file="%d" build="%d"/>\n' % (1700000000 + pkg.num, 1700000000 + pkg.num),
+        '  <size package="%d" installed="%d" archive="%d"/>\n' % (size // 4, size, size + 1024),
+        '  <location href="Packages/%s"/>\n' % escape(pkg.filename()),
+        '  <format>\n',
+        '    <rpm:license>MIT</rpm:license>\n',
+        '    <rpm:vendor>libdnf</rpm:vendor>\n',
+        '    <rpm:group>Unspecified</rpm:group>\n',
+        '    <rpm:buildhost>localhost</rpm:buildhost>\n',
+        '    <rpm:sourcerpm>%s-%s-%s.src.rpm</rpm:sourcerpm>\n' % (pkg.name, pkg.version,
+                                                                    escape(pkg.release)),
+        '    <rpm:header-range start="4504" end="%d"/>\n' % (4504 + size // 8),
+        '    <rpm:provides>\n',
+    ]
+    out.extend('      %s\n' % p for p in provides)
+    out.append('    </rpm:provides>\n')
+    if requires:
+        out.append('    <rpm:requires>\n')
+        out.extend('      %s\n' % r for r in requires)
+        out.append('    </rpm:requires>\n')
+    out.extend('    <file>%s</file>\n' % f for f in primary_files)
+    out.append('  </format>\n</package>\n')
+    primary.write("".join(out))
+
+    out = ['<package pkgid="%s" name="%s" arch="%s">\n' % (pkgid, pkg.name, pkg.arch),
+           '  <version epoch="0" ver="%s" rel="%s"/>\n' % (pkg.version, escape(pkg.release))]
+    out.extend('  <file>%s</file>\n' % f for f in files)
+    out.append('</package>\n')
+    filelists.write("".join(out))
+
+
+def generate_packages(args):
+    rng = random.Random(args.seed)
+    packages = []
+    for num in range(args.packages):
+        arch = "noarch" if rng.random() < 0.1 else "x86_64"
+        packages.append(Package(num, "pkg%d" % num, "%d.%d" % (1 + num % 5, num % 10),
+                                args.release, arch))
+
+    # every stream of a module has its own build of module_packages non-modular packages
+    streams = []
+    for module in range(args.modules):
+        for stream in range(args.streams):
+            artifacts = []
+            for i in range(args.module_packages):
+                base = packages[rng.randrange(len(packages))] if packages else None
+                name = base.name if base else "mod%d-pkg%d" % (module, i)
+                artifacts.append(Package(len(packages) + len(artifacts), name, "%d.0" % (stream + 1),
+                                         "%s.module+mod%d+%d" % (args.release, module, stream),
+                                         "x86_64"))
+            streams.append((module, stream, artifacts))
+    return packages, streams
+
+
+def write_modules(repodata, streams):
+    modules = MetadataFile(repodata, "modules")
+    for module, stream, artifacts in streams:
+        out = [
+            '---\ndocument: modulemd\nversion: 2\ndata:\n',
+            '  name: mod%d\n  stream: "%d"\n  version: 1\n  context: 6c81f848\n' % (module, stream),
+            '  arch: x86_64\n  summary: Synthetic module\n  description: Synthetic module\n',
+            '  license:\n    module:\n    - MIT\n',
+            '  profiles:\n    default:\n      rpms:\n',
+        ]
+        out.extend('      - %s\n' % pkg.name for pkg in artifacts[:3])
+        out.append('  artifacts:\n    rpms:\n')
+        out.extend('    - %s\n' % pkg.nevra() for pkg in artifacts)
+        out.append('...\n')
+        modules.write("".join(out))
+    for module in sorted(set(s[0] for s in streams)):
+        modules.write('---\ndocument: modulemd-defaults\nversion: 1\ndata:\n'
+                      '  module: mod%d\n  stream: "0"\n  profiles:\n    "0": [default]\n...\n' % module)
+    return modules.close(".yaml.gz")
+
+
+def write_updateinfo(repodata, rng, args, packages):
+    updateinfo = MetadataFile(repodata, "updateinfo")
+    updateinfo.write('<?xml version="1.0" encoding="UTF-8"?>\n<updates>\n')
+    fixed = [pkg for pkg in packages if rng.random() < args.advisories]
+    for num in range(0, len(fixed), 5):
+        kind = ("bugfix", "security", "enhancement")[num % 3]
+        out = [
+            '<update from="libdnf" status="stable" type="%s" version="2.0">\n' % kind,
+            '  <id>SYNTH-2026-%d</id>\n' % num,
+            '  <title>Synthetic advisory %d</title>\n' % num,
+            '  <issued date="2026-01-01 00:00:00"/>\n',
+            '  <updated date="2026-01-02 00:00:00"/>\n',
+            '  <severity>%s</severity>\n' % ("Low", "Moderate", "Important")[num % 3],
+            '  <description>Synthetic advisory %d</description>\n' % num,
+            '  <references>\n',
+            '    <reference href="https://example.com/%d" id="%d" type="bugzilla" title="Bug %d"/>\n'
+            % (num, num, num),
+            '  </references>\n',
+            '  <pkglist>\n    <collection short="%s">\n      <name>%s</name>\n' % (REPO_NAME, REPO_NAME),
+        ]
+        for pkg in fixed[num:num + 5]:
+            out.append('      <package name="%s" version="%s" release="%s" epoch="0" arch="%s">\n'
+                       '        <filename>%s</filename>\n      </package>\n'
+                       % (pkg.name, pkg.version, escape(pkg.release), pkg.arch, escape(pkg.filename())))
+        out.append('    </collection>\n  </pkglist>\n</update>\n')
+        updateinfo.write("".join(out))
+    updateinfo.write('</updates>\n')
+    return updateinfo.close()
+
+
+def main():
+    args = get_parser().parse_args()
+    repodata = os.path.join(args.path, "repodata")
+    if not os.path.isdir(repodata):
+        os.makedirs(repodata)
+
+    packages, streams = generate_packages(args)
+    modular = [pkg for _, _, artifacts in streams for pkg in artifacts]
+    rng = random.Random(args.seed + 1)
+
+    primary = MetadataFile(repodata, "primary")
+    filelists = MetadataFile(repodata, "filelists")
+    total = len(packages) + len(modular)
+    primary.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+                  '<metadata xmlns="http://linux.duke.edu/metadata/common" '
+                  'xmlns:rpm="http://linux.duke.edu/metadata/rpm" packages="%d">\n' % total)
+    filelists.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+                    '<filelists xmlns="http://linux.duke.edu/metadata/filelists" packages="%d">\n'
+                    % total)
+    for pkg in packages + modular:
+        write_package(primary, filelists, rng, args, pkg, packages)
+    primary.write('</metadata>\n')
+    filelists.write('</filelists>\n')
+
+    data = [primary.close(), filelists.close(), write_updateinfo(repodata, rng, args, packages)]
+    if streams:
+        data.append(write_modules(repodata, streams))
+
+    with open(os.path.join(repodata, "repomd.xml"), "w") as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<repomd xmlns="http://linux.duke.edu/metadata/repo" '
+                'xmlns:rpm="http://linux.duke.edu/metadata/rpm">\n'
+                '<revision>%d</revision>\n' % int(time.time()))
+        f.writelines(data)
+        f.write('</repomd>\n')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "synthetic.hpp"
+
+#include "libdnf/goal/Goal.hpp"
+#include "libdnf/hy-types.h"
+#include "libdnf/sack/query.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace libdnf_benchmarks {
+
+enum class GoalJob { INSTALL, UPGRADE, DISTUPGRADE };
+
+/// Measures Goal::run() of a single job, building the goal is not timed. The install job
+/// installs the available version of the package with the longest chain of requirements.
+static void
+GoalRun(benchmark::State & state, GoalJob job)
+{
+    auto sack = syntheticSack(static_cast<int>(state.range(0)));
+    int names = syntheticNames(static_cast<int>(state.range(0)));
+
+    libdnf::Query query(sack);
+    query.addFilter(HY_PKG_NAME, HY_EQ, ("pkg" + std::to_string(names - 1)).c_str());
+    query.addFilter(HY_PKG_REPONAME, HY_EQ, SYNTHETIC_REPO_NAME);
+    if (query.empty())
+        throw std::runtime_error("synthetic package to install not found");
+    const libdnf::PackageSet * toInstall = query.getResultPset();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        libdnf::Goal goal(sack);
+        goal.set_protect_running_kernel(false);
+        switch (job) {
+            case GoalJob::INSTALL:
+                goal.install(*toInstall, false);
+                break;
+            case GoalJob::UPGRADE:
+                goal.upgrade();
+                break;
+            case GoalJob::DISTUPGRADE:
+                goal.distupgrade();
+                break;
+        }
+        state.ResumeTiming();
+        if (goal.run(DNF_NONE))
+            state.SkipWithError("the synthetic goal has no solution");
+    }
+}
+
+BENCHMARK_CAPTURE(GoalRun, install, GoalJob::INSTALL)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(GoalRun, upgrade, GoalJob::UPGRADE)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(GoalRun, distupgrade, GoalJob::DISTUPGRADE)->Apply(syntheticSizes);
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "synthetic.hpp"
+
+#include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/module/ModulePackageContainer.hpp"
+#include "libdnf/sack/packageset.hpp"
+
+#include <string>
+
+namespace libdnf_benchmarks {
+
+/// Number of synthetic packages in one synthetic module.
+constexpr int MODULE_PACKAGES = 100;
+
+static std::string
+syntheticModulemd(int names)
+{
+    std::string yaml;
+    for (int first = 0; first < names; first += MODULE_PACKAGES) {
+        auto name = "mod" + std::to_string(first / MODULE_PACKAGES);
+        yaml += "---\ndocument: modulemd\nversion: 2\ndata:\n";
+        yaml += "  name: " + name + "\n  stream: \"1\"\n  version: 1\n  context: 6c81f848\n";
+        yaml += "  arch: x86_64\n  summary: Synthetic module\n  description: Synthetic module\n";
+        yaml += "  license:\n    module:\n    - MIT\n  artifacts:\n    rpms:\n";
+        for (int i = first; i < names && i < first + MODULE_PACKAGES; ++i) {
+            yaml += "    - pkg" + std::to_string(i) + "-0:1.1-1.x86_64\n";
+        }
+        yaml += "...\n";
+    }
+    return yaml;
+}
+
+/// Measures dnf_sack_filter_modules_v2() of a module container already filled with modules,
+/// each of them owning MODULE_PACKAGES available packages, every other module enabled.
+/// The module excludes are reset between the iterations, otherwise they would be reused.
+static void
+ModuleFilter(benchmark::State & state)
+{
+    auto sack = syntheticSack(static_cast<int>(state.range(0)));
+    int names = syntheticNames(static_cast<int>(state.range(0)));
+
+    auto & installRoot = benchmarkTmpdir();
+    libdnf::ModulePackageContainer container(false, installRoot, "x86_64");
+    container.add(syntheticModulemd(names), SYNTHETIC_REPO_NAME);
+    for (int module = 0; module * MODULE_PACKAGES < names; module += 2) {
+        container.enable("mod" + std::to_string(module), "1");
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        dnf_sack_reset_module_excludes(sack);
+        state.ResumeTiming();
+        dnf_sack_filter_modules_v2(sack, &container, nullptr, installRoot.c_str(), nullptr,
+                                   true, false, false);
+    }
+
+    libdnf::PackageSet empty(sack);
+    dnf_sack_reset_module_excludes(sack);
+    dnf_sack_set_module_includes(sack, &empty);
+}
+
+BENCHMARK(ModuleFilter)->Apply(syntheticSizes);
+
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libdnf/nsvcap.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace libdnf_benchmarks {
+
+/// Measures Nsvcap::parse() of specs of several shapes in all forms, like
+/// resolve_module_spec() tries them.
+static void
+NsvcapParse(benchmark::State & state)
+{
+    const char * specs[]{
+        "nodejs:12:8020020200101:abcdef12:x86_64/development",
+        "postgresql:9.6/client",
+        "httpd:2.4::x86_64",
+        "perl-DBI",
+    };
+
+    for (auto _ : state) {
+        for (auto spec : specs) {
+            for (int form = HY_MODULE_FORM_NSVCAP; form <= HY_MODULE_FORM_N; ++form) {
+                libdnf::Nsvcap nsvcap;
+                benchmark::DoNotOptimize(nsvcap.parse(spec, static_cast<HyModuleForm>(form)));
+            }
+        }
+    }
+    constexpr int forms = HY_MODULE_FORM_N - HY_MODULE_FORM_NSVCAP + 1;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * forms *
+                            static_cast<int64_t>(sizeof(specs) / sizeof(specs[0])));
+}
+
+BENCHMARK(NsvcapParse);
+
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "synthetic.hpp"
+
+#include "libdnf/hy-types.h"
+#include "libdnf/sack/packageattrs.hpp"
+#include "libdnf/sack/query.hpp"
+
+#include <string>
+
+namespace libdnf_benchmarks {
+
+typedef void (*QueryFilter)(libdnf::Query & query, int names);
+
+static void
+filterNameEq(libdnf::Query & query, int names)
+{
+    query.addFilter(HY_PKG_NAME, HY_EQ, ("pkg" + std::to_string(names / 2)).c_str());
+}
+
+static void
+filterNameGlob(libdnf::Query & query, int)
+{
+    query.addFilter(HY_PKG_NAME, HY_GLOB, "pkg1*7");
+}
+
+static void
+filterNameIcase(libdnf::Query & query, int names)
+{
+    query.addFilter(HY_PKG_NAME, HY_EQ | HY_ICASE, ("PKG" + std::to_string(names / 2)).c_str());
+}
+
+static void
+filterProvides(libdnf::Query & query, int names)
+{
+    query.addFilter(HY_PKG_PROVIDES, HY_EQ, ("cap" + std::to_string(names / 2)).c_str());
+}
+
+static void
+filterRequires(libdnf::Query & query, int)
+{
+    query.addFilter(HY_PKG_REQUIRES, HY_EQ, "cap1");
+}
+
+static void
+filterFile(libdnf::Query & query, int names)
+{
+    query.addFilter(HY_PKG_FILE, HY_EQ, ("/usr/bin/pkg" + std::to_string(names / 2)).c_str());
+}
+
+static void
+filterSummarySubstr(libdnf::Query & query, int)
+{
+    query.addFilter(HY_PKG_SUMMARY, HY_SUBSTR, "package 123");
+}
+
+static void
+filterReponame(libdnf::Query & query, int)
+{
+    query.addFilter(HY_PKG_REPONAME, HY_EQ, SYNTHETIC_REPO_NAME);
+}
+
+static void
+filterLatest(libdnf::Query & query, int)
+{
+    query.addFilter(HY_PKG_LATEST_PER_ARCH, HY_EQ, 1);
+}
+
+static void
+filterUpgrades(libdnf::Query & query, int)
+{
+    query.addFilter(HY_PKG_UPGRADES, HY_EQ, 1);
+}
+
+static void
+filterBuildtime(libdnf::Query & query, int)
+{
+    query.filterNumRange(libdnf::PackageAttr::BUILDTIME, 1500000000, 1500001000);
+}
+
+/// Measures Query::apply() of a new query with a single filter. The indexes the filter
+/// uses are built in the untimed first apply(), as they are kept by the sack.
+static void
+QueryApply(benchmark::State & state, QueryFilter filter)
+{
+    auto sack = syntheticSack(static_cast<int>(state.range(0)));
+    int names = syntheticNames(static_cast<int>(state.range(0)));
+    {
+        libdnf::Query query(sack);
+        filter(query, names);
+        query.apply();
+    }
+    for (auto _ : state) {
+        libdnf::Query query(sack);
+        filter(query, names);
+        query.apply();
+        benchmark::DoNotOptimize(query.size());
+    }
+}
+
+BENCHMARK_CAPTURE(QueryApply, name_eq, filterNameEq)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, name_glob, filterNameGlob)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, name_icase, filterNameIcase)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, provides, filterProvides)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, requires, filterRequires)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, file, filterFile)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, summary_substr, filterSummarySubstr)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, reponame, filterReponame)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, latest_per_arch, filterLatest)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, upgrades, filterUpgrades)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(QueryApply, buildtime_range, filterBuildtime)->Apply(syntheticSizes);
+
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "synthetic.hpp"
+
+#include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/hy-repo.h"
+
+#include <glib.h>
+#include <glob.h>
+
+extern "C" {
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_rpmmd.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace libdnf_benchmarks {
+
+enum class RepoFormat { XML, SOLV };
+
+static std::string
+syntheticSolv(const std::string & xml)
+{
+    Pool * pool = pool_create();
+    Repo * repo = repo_create(pool, SYNTHETIC_REPO_NAME);
+    FILE * fp = fmemopen(const_cast<char *>(xml.data()), xml.size(), "r");
+    repo_add_rpmmd(repo, fp, nullptr, 0);
+    fclose(fp);
+    repo_internalize(repo);
+
+    char * buf = nullptr;
+    std::size_t size = 0;
+    fp = open_memstream(&buf, &size);
+    if (!fp)
+        throw std::runtime_error("cannot write the synthetic solv file");
+    repo_write(repo, fp);
+    fclose(fp);
+    pool_free(pool);
+
+    std::string solv(buf, size);
+    free(buf);
+    return solv;
+}
+
+/// Measures loading the primary metadata of the available synthetic packages into a new
+/// pool, from the rpm-md XML and from the solv file libdnf caches it in. This is the
+/// libsolv part of dnf_sack_load_repo(), which dominates the load of a real repository.
+static void
+RepoLoad(benchmark::State & state, RepoFormat format)
+{
+    auto xml = syntheticPrimaryXml(syntheticNames(static_cast<int>(state.range(0))), "1.1");
+    std::string data = format == RepoFormat::XML ? xml : syntheticSolv(xml);
+
+    for (auto _ : state) {
+        Pool * pool = pool_create();
+        Repo * repo = repo_create(pool, SYNTHETIC_REPO_NAME);
+        FILE * fp = fmemopen(const_cast<char *>(data.data()), data.size(), "r");
+        int ret = format == RepoFormat::XML ? repo_add_rpmmd(repo, fp, nullptr, 0)
+                                            : repo_add_solv(repo, fp, 0);
+        fclose(fp);
+        if (ret != 0)
+            state.SkipWithError(pool_errstr(pool));
+        repo_internalize(repo);
+        state.PauseTiming();
+        pool_free(pool);
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(data.size()));
+}
+
+BENCHMARK_CAPTURE(RepoLoad, xml, RepoFormat::XML)->Apply(syntheticSizes);
+BENCHMARK_CAPTURE(RepoLoad, solv, RepoFormat::SOLV)->Apply(syntheticSizes);
+
+/// Measures dnf_sack_make_provides_ready() recomputing the whatprovides index. The synthetic
+/// repositories have no checksums, so the on-disk whatprovides cache is never used.
+static void
+MakeProvidesReady(benchmark::State & state)
+{
+    auto sack = syntheticSack(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        dnf_sack_set_provides_not_ready(sack);
+        dnf_sack_make_provides_ready(sack);
+    }
+}
+
+BENCHMARK(MakeProvidesReady)->Apply(syntheticSizes);
+
+static std::string
+repodataFile(const std::string & repodata, const char * pattern)
+{
+    std::string path;
+    glob_t found;
+    if (glob((repodata + pattern).c_str(), 0, nullptr, &found) == 0 && found.gl_pathc > 0)
+        path = found.gl_pathv[0];
+    globfree(&found);
+    return path;
+}
+
+static HyRepo
+generatedRepo(const char * dir)
+{
+    std::string repodata = std::string(dir) + "/repodata/";
+    HyRepo repo = hy_repo_create(SYNTHETIC_REPO_NAME);
+    const struct {
+        int which;
+        const char * pattern;
+    } files[] = {
+        {HY_REPO_MD_FN, "repomd.xml"},
+        {HY_REPO_PRIMARY_FN, "*-primary.xml.gz"},
+        {HY_REPO_FILELISTS_FN, "*-filelists.xml.gz"},
+        {HY_REPO_UPDATEINFO_FN, "*-updateinfo.xml.gz"},
+        {MODULES_FN, "*-modules.yaml.gz"},
+    };
+    for (const auto & file : files) {
+        auto path = repodataFile(repodata, file.pattern);
+        if (!path.empty())
+            hy_repo_set_string(repo, file.which, path.c_str());
+    }
+    return repo;
+}
+
+/// Measures dnf_sack_load_repo() of a repository made by generate-repo.py, the directory is
+/// given by the LIBDNF_BENCHMARK_REPO environment variable. The XML variant uses an empty
+/// cache directory in every iteration, the solv variant the cache written before the loop.
+static void
+RepoLoadGenerated(benchmark::State & state, const char * dir, RepoFormat format)
+{
+    const int flags = DNF_SACK_LOAD_FLAG_USE_FILELISTS | DNF_SACK_LOAD_FLAG_USE_UPDATEINFO;
+    HyRepo repo = generatedRepo(dir);
+    auto cachedir = benchmarkTmpdir() + (format == RepoFormat::XML ? "/xml-" : "/solv");
+
+    if (format == RepoFormat::SOLV) {
+        DnfSack * sack = dnf_sack_new();
+        dnf_sack_set_cachedir(sack, cachedir.c_str());
+        dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, nullptr);
+        if (!dnf_sack_load_repo(sack, repo, flags | DNF_SACK_LOAD_FLAG_BUILD_CACHE, nullptr))
+            state.SkipWithError("cannot load the generated repository");
+        g_object_unref(sack);
+    }
+
+    int iteration = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        DnfSack * sack = dnf_sack_new();
+        auto iterationCachedir =
+            format == RepoFormat::XML ? cachedir + std::to_string(iteration++) : cachedir;
+        dnf_sack_set_cachedir(sack, iterationCachedir.c_str());
+        dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, nullptr);
+        state.ResumeTiming();
+        if (!dnf_sack_load_repo(sack, repo, flags, nullptr))
+            state.SkipWithError("cannot load the generated repository");
+        state.PauseTiming();
+        g_object_unref(sack);
+        state.ResumeTiming();
+    }
+    hy_repo_free(repo);
+}
+
+static bool
+registerGenerated()
+{
+    const char * dir = getenv("LIBDNF_BENCHMARK_REPO");
+    if (!dir || !*dir)
+        return false;
+    benchmark::RegisterBenchmark("RepoLoadGenerated/xml", RepoLoadGenerated, dir, RepoFormat::XML)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("RepoLoadGenerated/solv", RepoLoadGenerated, dir, RepoFormat::SOLV)
+        ->Unit(benchmark::kMillisecond);
+    return true;
+}
+
+static bool generatedRegistered = registerGenerated();
+
+}
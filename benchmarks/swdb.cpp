@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "synthetic.hpp"
+
+#include "libdnf/transaction/RPMItem.hpp"
+#include "libdnf/transaction/Swdb.hpp"
+#include "libdnf/transaction/Transformer.hpp"
+#include "libdnf/transaction/Types.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace libdnf_benchmarks {
+
+/// Number of packages installed by one synthetic transaction.
+constexpr int TRANSACTION_ITEMS = 1000;
+
+/// Returns an in-memory history which installed the synthetic packages pkg0 ... pkg<names - 1>
+/// in transactions of TRANSACTION_ITEMS packages, every third of them by the user.
+static libdnf::Swdb &
+syntheticSwdb(int names)
+{
+    static std::map<int, std::unique_ptr<libdnf::Swdb>> histories;
+    auto it = histories.find(names);
+    if (it != histories.end())
+        return *it->second;
+
+    auto conn = std::make_shared<libdnf::SQLite3>(":memory:");
+    libdnf::Transformer::createDatabase(conn);
+    std::unique_ptr<libdnf::Swdb> swdb(new libdnf::Swdb(conn));
+    for (int first = 0; first < names; first += TRANSACTION_ITEMS) {
+        swdb->initTransaction();
+        for (int i = first; i < names && i < first + TRANSACTION_ITEMS; ++i) {
+            auto rpm = swdb->createRPMItem();
+            rpm->setName("pkg" + std::to_string(i));
+            rpm->setEpoch(0);
+            rpm->setVersion("1.0");
+            rpm->setRelease("1");
+            rpm->setArch("x86_64");
+            auto reason = i % 3 == 0 ? libdnf::TransactionItemReason::USER
+                                     : libdnf::TransactionItemReason::DEPENDENCY;
+            auto item = swdb->addItem(rpm, SYNTHETIC_REPO_NAME,
+                                      libdnf::TransactionItemAction::INSTALL, reason);
+            item->setState(libdnf::TransactionItemState::DONE);
+        }
+        swdb->beginTransaction(first, "", "", 0);
+        swdb->endTransaction(first + 1, "", libdnf::TransactionState::DONE);
+        swdb->closeTransaction();
+    }
+    return *histories.emplace(names, std::move(swdb)).first->second;
+}
+
+/// Measures Swdb::resolveRPMTransactionItemReason() of all the synthetic packages in turn,
+/// over the whole history (maxTransactionId -1) or over all but the last transaction.
+static void
+SwdbReason(benchmark::State & state, bool wholeHistory)
+{
+    int names = syntheticNames(static_cast<int>(state.range(0)));
+    auto & swdb = syntheticSwdb(names);
+    int64_t maxTransactionId = -1;
+    if (!wholeHistory)
+        maxTransactionId = swdb.getLastTransaction()->getId() - 1;
+
+    int i = 0;
+    for (auto _ : state) {
+        auto reason = swdb.resolveRPMTransactionItemReason(
+            "pkg" + std::to_string(i), "x86_64", maxTransactionId);
+        benchmark::DoNotOptimize(reason);
+        i = (i + 7919) % names;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK_CAPTURE(SwdbReason, whole_history, true)->Apply(syntheticSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(SwdbReason, bounded_history, false)->Apply(syntheticSizes)->Unit(benchmark::kMicrosecond);
+
+}
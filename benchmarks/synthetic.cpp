@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "synthetic.hpp"
+
+#include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/dnf-utils.h"
+#include "libdnf/hy-repo.h"
+#include "libdnf/hy-types.h"
+#include "libdnf/repo/Repo-private.hpp"
+
+extern "C" {
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_rpmmd.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+
+namespace libdnf_benchmarks {
+
+void
+syntheticSizes(benchmark::internal::Benchmark * bench)
+{
+    bench->Arg(10000)->Arg(100000)->Arg(500000)->Unit(benchmark::kMillisecond);
+}
+
+std::string
+syntheticPrimaryXml(int count, const char * version)
+{
+    std::string xml;
+    xml.reserve(static_cast<std::size_t>(count) * 700);
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" "
+           "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" packages=\"";
+    xml += std::to_string(count);
+    xml += "\">\n";
+    for (int i = 0; i < count; ++i) {
+        auto name = "pkg" + std::to_string(i);
+        xml += "<package type=\"rpm\">\n  <name>" + name + "</name>\n  <arch>x86_64</arch>\n";
+        xml += "  <version epoch=\"0\" ver=\"";
+        xml += version;
+        xml += "\" rel=\"1\"/>\n";
+        xml += "  <summary>Synthetic package " + std::to_string(i) + "</summary>\n";
+        xml += "  <description>Synthetic package number " + std::to_string(i) +
+               " generated for the libdnf benchmarks.</description>\n";
+        xml += "  <url>https://example.com/" + name + "</url>\n";
+        xml += "  <time file=\"" + std::to_string(1500000000 + i) + "\" build=\"" +
+               std::to_string(1500000000 + i) + "\"/>\n";
+        xml += "  <location href=\"Packages/" + name + "-";
+        xml += version;
+        xml += "-1.x86_64.rpm\"/>\n  <format>\n    <rpm:license>MIT</rpm:license>\n";
+        xml += "    <rpm:provides>\n      <rpm:entry name=\"" + name + "\" flags=\"EQ\" epoch=\"0\" ver=\"";
+        xml += version;
+        xml += "\" rel=\"1\"/>\n      <rpm:entry name=\"cap" + std::to_string(i) + "\"/>\n    </rpm:provides>\n";
+        if (i > 0) {
+            xml += "    <rpm:requires>\n      <rpm:entry name=\"cap" + std::to_string(i / 2) + "\"/>\n";
+            xml += "      <rpm:entry name=\"cap" + std::to_string(i / 3) + "\"/>\n    </rpm:requires>\n";
+        }
+        xml += "    <file>/usr/bin/" + name + "</file>\n  </format>\n</package>\n";
+    }
+    xml += "</metadata>\n";
+    return xml;
+}
+
+static void
+addSyntheticRepo(Pool * pool, const char * name, const std::string & xml, bool installed)
+{
+    HyRepo hrepo = hy_repo_create(name);
+    Repo * repo = repo_create(pool, name);
+    libdnf::repoGetImpl(hrepo)->attachLibsolvRepo(repo);
+    hy_repo_free(hrepo);
+
+    FILE * fp = fmemopen(const_cast<char *>(xml.data()), xml.size(), "r");
+    if (!fp)
+        throw std::runtime_error("cannot open the synthetic metadata");
+    int ret = repo_add_rpmmd(repo, fp, nullptr, 0);
+    fclose(fp);
+    if (ret != 0)
+        throw std::runtime_error(std::string("cannot parse the synthetic metadata: ") +
+                                 pool_errstr(pool));
+    repo_internalize(repo);
+    if (installed)
+        pool_set_installed(pool, repo);
+}
+
+DnfSack *
+syntheticSack(int nsolvables)
+{
+    static std::map<int, DnfSack *> sacks;
+    auto it = sacks.find(nsolvables);
+    if (it != sacks.end())
+        return it->second;
+
+    DnfSack * sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, benchmarkTmpdir().c_str());
+    dnf_sack_set_arch(sack, "x86_64", nullptr);
+    dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, nullptr);
+
+    Pool * pool = dnf_sack_get_pool(sack);
+    int count = syntheticNames(nsolvables);
+    addSyntheticRepo(pool, HY_SYSTEM_REPO_NAME, syntheticPrimaryXml(count, "1.0"), true);
+    addSyntheticRepo(pool, SYNTHETIC_REPO_NAME, syntheticPrimaryXml(count, "1.1"), false);
+    dnf_sack_make_provides_ready(sack);
+
+    sacks.emplace(nsolvables, sack);
+    return sack;
+}
+
+static std::string tmpdir;
+
+static void
+removeTmpdir()
+{
+    dnf_remove_recursive(tmpdir.c_str(), nullptr);
+}
+
+const std::string &
+benchmarkTmpdir()
+{
+    if (tmpdir.empty()) {
+        char tmpl[] = "/tmp/libdnf_benchmark_XXXXXX";
+        if (!mkdtemp(tmpl))
+            throw std::runtime_error("cannot create a temporary directory");
+        tmpdir = tmpl;
+        std::atexit(removeTmpdir);
+    }
+    return tmpdir;
+}
+
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LIBDNF_BENCHMARKS_SYNTHETIC_HPP
+#define LIBDNF_BENCHMARKS_SYNTHETIC_HPP
+
+#include "libdnf/dnf-sack.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace libdnf_benchmarks {
+
+/// Name of the repository holding the available synthetic packages.
+constexpr const char * SYNTHETIC_REPO_NAME = "synthetic";
+
+/// Number of names of the packages in a sack of the given size, each name is installed
+/// in version 1.0 and available in version 1.1.
+inline int syntheticNames(int nsolvables) { return nsolvables / 2; }
+
+/// Runs the benchmark for sacks of 10k, 100k and 500k solvables.
+void syntheticSizes(benchmark::internal::Benchmark * bench);
+
+/// Returns rpm-md primary metadata of count packages pkg0 ... pkg<count - 1> in the given
+/// version. Every package provides cap<i> and /usr/bin/pkg<i> and requires the capabilities
+/// of two packages with lower numbers, so the dependency graph is connected without cycles.
+std::string syntheticPrimaryXml(int count, const char * version);
+
+/// Returns the sack with nsolvables synthetic solvables, see syntheticNames(). The sacks are
+/// built once per size and live until the process exits, the benchmarks must not modify them.
+DnfSack * syntheticSack(int nsolvables);
+
+/// Returns a temporary directory removed when the process exits.
+const std::string & benchmarkTmpdir();
+
+}
+
+#endif // LIBDNF_BENCHMARKS_SYNTHETIC_HPP
@@ -1,4 +1,10 @@
-%module(directors="1") repo
+%module(directors="1", threads="1") repo
+
+// Only downloads release the GIL, the callback directors take it back for their calls.
+%feature("nothreadallow");
+%feature("nothreadallow", "0") libdnf::Repo::load;
+%feature("nothreadallow", "0") libdnf::Repo::downloadMetadata;
+%feature("nothreadallow", "0") libdnf::PackageTarget::downloadPackages;
 
 %include <stdint.i>
 %include <std_vector.i>
@@ -81,6 +87,11 @@
     int64_t byteRangeStart, int64_t byteRangeEnd, PackageTargetCB * callbacks,
     const char * httpHeaders[] = nullptr);
 
+// std::future is move only, the Python API uses its own threads
+%ignore libdnf::Repo::loadAsync;
+%ignore libdnf::Repo::downloadMetadataAsync;
+%ignore libdnf::Downloader::downloadURLAsync;
+%ignore libdnf::PackageTarget::downloadPackagesAsync;
 %feature("director") libdnf::RepoCB;
 %ignore libdnf::PackageTarget::PackageTarget(const PackageTarget & src);
 %feature("director") libdnf::PackageTargetCB;
@@ -3,6 +3,8 @@
 %include <std_shared_ptr.i>
 %include <std_string.i>
 
+%include <std_vector_ext.i>
+
 %include "catch_error.i"
 
 %{
@@ -20,6 +22,8 @@
 %shared_ptr(Cell)
 %shared_ptr(Table)
 
+%template(VectorVectorString) std::vector<std::vector<std::string>>;
+
 %include "libdnf/utils/smartcols/Table.hpp"
 %include "libdnf/utils/smartcols/Column.hpp"
 %include "libdnf/utils/smartcols/Line.hpp"
@@ -88,7 +88,9 @@ typedef libdnf::CompsPackageType CompsPackageType;
 %template() std::vector< std::string >;
 %template() std::pair<int,std::string>;
 %template() std::map<std::string,int>;
+%template() std::map<libdnf::TransactionItemAction,int64_t>;
 %template() std::map<std::string,std::string>;
+%template() std::map<std::string,std::vector<std::string> >;
 %template() std::vector<std::pair<int,std::string> >;
 
 
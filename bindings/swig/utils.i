@@ -1,4 +1,7 @@
-%module(directors="1") utils
+%module(directors="1", threads="1") utils
+
+// Wrappers keep the GIL, the Logger director takes it when libdnf logs with it released.
+%feature("nothreadallow");
 
 %begin %{
 #define SWIG_PYTHON_2_UNICODE
@@ -6,6 +9,7 @@
 
 %include <std_shared_ptr.i>
 %include <std_string.i>
+%include <std_vector.i>
 
 %include "catch_error.i"
 
@@ -15,6 +19,7 @@
     #include "libdnf/utils/logger.hpp"
     #include "libdnf/log.hpp"
     #include "libdnf/utils/utils.hpp"
+    #include "libdnf/utils/PhaseTimer.hpp"
 %}
 
 %shared_ptr(SQLite3)
@@ -38,11 +43,17 @@ typedef long pid_t;
 
 %include "libdnf/log.hpp"
 
+%ignore libdnf::PhaseTimer;
+%include "libdnf/utils/PhaseTimer.hpp"
+%template(VectorPhaseTiming) std::vector<libdnf::PhaseTiming>;
+
 typedef int mode_t;
 
 namespace libdnf { namespace filesystem {
 
 void decompress(const char * inPath, const char * outPath, mode_t outMode, const char * compressType = nullptr);
+std::string decompressWithChecksum(const char * inPath, const char * outPath, mode_t outMode,
+                                   const char * checksumType, const char * compressType = nullptr);
 
 bool checksum_check(const char * type, const char * inPath, const char * checksum_valid);
 std::string checksum_value(const char * type, const char * inPath);
@@ -49,9 +49,11 @@
 %endif
 
 %bcond_with sanitizers
+%bcond_without sdt
 
 %global _cmake_opts \\\
     -DENABLE_RHSM_SUPPORT=%{?with_rhsm:ON}%{!?with_rhsm:OFF} \\\
+    -DWITH_SDT=%{?with_sdt:ON}%{!?with_sdt:OFF} \\\
     %{nil}
 
 Name:           libdnf
@@ -80,6 +82,7 @@ BuildRequires:  pkgconfig(librhsm) >= 0.0.3
 %if %{with zchunk}
 BuildRequires:  pkgconfig(zck) >= 0.9.11
 %endif
+BuildRequires:  pkgconfig(libzstd)
 BuildRequires:  pkgconfig(sqlite3)
 BuildRequires:  pkgconfig(json-c)
 BuildRequires:  pkgconfig(cppunit)
@@ -88,6 +91,10 @@ BuildRequires:  pkgconfig(smartcols)
 BuildRequires:  gettext
 BuildRequires:  gpgme-devel
 
+%if %{with sdt}
+BuildRequires:  systemtap-sdt-devel
+%endif
+
 %if %{with sanitizers}
 BuildRequires:  libasan
 BuildRequires:  liblsan
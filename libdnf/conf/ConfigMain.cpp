@@ -182,6 +182,7 @@ class ConfigMain::Impl {
     OptionPath system_cachedir{SYSTEM_CACHEDIR};
     OptionBool cacheonly{false};
     OptionBool keepcache{false};
+    OptionPath package_store_dir{""};
     OptionString logdir{"/var/log"};
     OptionNumber<std::int32_t> log_size{1024 * 1024, strToBytes};
     OptionNumber<std::int32_t> log_rotate{4, 0};
@@ -290,6 +291,10 @@ class ConfigMain::Impl {
     OptionString user_agent{getUserAgent()};
     OptionBool countme{false};
     OptionBool protect_running_kernel{true};
+    OptionEnum<std::string> solv_cache_compression{"none", {"none", "zstd"}};
+    OptionNumber<std::int32_t> solv_cache_compression_level{3, 1, 19};
+    OptionNumber<std::uint32_t> solv_cache_compression_threads{0};
+    OptionBool solv_snapshot{false};
 
     // Repo main config
 
@@ -383,6 +388,7 @@ ConfigMain::Impl::Impl(Config & owner)
     owner.optBinds().add("system_cachedir", system_cachedir);
     owner.optBinds().add("cacheonly", cacheonly);
     owner.optBinds().add("keepcache", keepcache);
+    owner.optBinds().add("package_store_dir", package_store_dir);
     owner.optBinds().add("logdir", logdir);
     owner.optBinds().add("log_size", log_size);
     owner.optBinds().add("log_rotate", log_rotate);
@@ -455,6 +461,10 @@ ConfigMain::Impl::Impl(Config & owner)
     owner.optBinds().add("user_agent", user_agent);
     owner.optBinds().add("countme", countme);
     owner.optBinds().add("protect_running_kernel", protect_running_kernel);
+    owner.optBinds().add("solv_cache_compression", solv_cache_compression);
+    owner.optBinds().add("solv_cache_compression_level", solv_cache_compression_level);
+    owner.optBinds().add("solv_cache_compression_threads", solv_cache_compression_threads);
+    owner.optBinds().add("solv_snapshot", solv_snapshot);
 
     // Repo main config
 
@@ -542,6 +552,7 @@ OptionBool & ConfigMain::reset_nice() { return pImpl->reset_nice; }
 OptionString & ConfigMain::system_cachedir() { return pImpl->system_cachedir; }
 OptionBool & ConfigMain::cacheonly() { return pImpl->cacheonly; }
 OptionBool & ConfigMain::keepcache() { return pImpl->keepcache; }
+OptionPath & ConfigMain::package_store_dir() { return pImpl->package_store_dir; }
 OptionString & ConfigMain::logdir() { return pImpl->logdir; }
 OptionNumber<std::int32_t> & ConfigMain::log_size() { return pImpl->log_size; }
 OptionNumber<std::int32_t> & ConfigMain::log_rotate() { return pImpl->log_rotate; }
@@ -604,6 +615,10 @@ OptionBool & ConfigMain::module_obsoletes() { return pImpl->module_obsoletes; }
 OptionString & ConfigMain::user_agent() { return pImpl->user_agent; }
 OptionBool & ConfigMain::countme() { return pImpl->countme; }
 OptionBool & ConfigMain::protect_running_kernel() {return pImpl->protect_running_kernel; }
+OptionEnum<std::string> & ConfigMain::solv_cache_compression() { return pImpl->solv_cache_compression; }
+OptionNumber<std::int32_t> & ConfigMain::solv_cache_compression_level() { return pImpl->solv_cache_compression_level; }
+OptionNumber<std::uint32_t> & ConfigMain::solv_cache_compression_threads() { return pImpl->solv_cache_compression_threads; }
+OptionBool & ConfigMain::solv_snapshot() { return pImpl->solv_snapshot; }
 
 // Repo main config
 OptionNumber<std::uint32_t> & ConfigMain::retries() { return pImpl->retries; }
@@ -32,6 +32,7 @@
 #include "OptionString.hpp"
 #include "OptionStringList.hpp"
 
+#include <map>
 #include <memory>
 
 namespace libdnf {
@@ -62,6 +63,7 @@ public:
     OptionString & system_cachedir();
     OptionBool & cacheonly();
     OptionBool & keepcache();
+    OptionPath & package_store_dir();
     OptionString & logdir();
     OptionNumber<std::int32_t> & log_size();
     OptionNumber<std::int32_t> & log_rotate();
@@ -130,6 +132,11 @@ public:
     OptionString & user_agent();
     OptionBool & countme();
     OptionBool & protect_running_kernel();
+    OptionEnum<std::string> & solv_cache_compression();
+    OptionNumber<std::int32_t> & solv_cache_compression_level();
+    OptionNumber<std::uint32_t> & solv_cache_compression_threads();
+    // download the prebuilt solv file of the primary ("primary_solv" repomd record) if the repo has one
+    OptionBool & solv_snapshot();
 
     // Repo main config
     OptionNumber<std::uint32_t> & retries();
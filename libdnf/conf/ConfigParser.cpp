@@ -22,58 +22,105 @@
 #include "../utils/iniparser/iniparser.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <fstream>
 
 namespace libdnf {
 
-void ConfigParser::substitute(std::string & text,
-    const std::map<std::string, std::string> & substitutions)
+ConfigParser::SubstitutionTemplate::SubstitutionTemplate(std::string text) : text(std::move(text))
 {
-    auto start = text.find_first_of("$");
-    while (start != text.npos)
-    {
+    const auto & str = this->text;
+    auto start = str.find('$');
+    while (start != str.npos) {
         auto variable = start + 1;
-        if (variable >= text.length())
+        if (variable >= str.length())
             break;
         bool bracket;
-        if (text[variable] == '{') {
+        if (str[variable] == '{') {
             bracket = true;
-            if (++variable >= text.length())
+            if (++variable >= str.length())
                 break;
         } else
             bracket = false;
-        auto it = std::find_if_not(text.begin()+variable, text.end(),
-            [](char c){return std::isalnum(c) || c=='_';});
-        if (bracket && it == text.end())
+        auto it = std::find_if_not(str.begin() + variable, str.end(),
+            [](char c){return std::isalnum(static_cast<unsigned char>(c)) || c == '_';});
+        if (bracket && it == str.end())
             break;
-        auto pastVariable = std::distance(text.begin(), it);
+        std::size_t pastVariable = std::distance(str.begin(), it);
         if (bracket && *it != '}') {
-            start = text.find_first_of("$", pastVariable);
+            start = str.find('$', pastVariable);
             continue;
         }
-        auto subst = substitutions.find(text.substr(variable, pastVariable - variable));
-        if (subst != substitutions.end()) {
-            if (bracket)
-                ++pastVariable;
-            text.replace(start, pastVariable - start, subst->second);
-            start = text.find_first_of("$", start + subst->second.length());
-        } else {
-            start = text.find_first_of("$", pastVariable);
-        }
+        variables.push_back({start, pastVariable + (bracket ? 1 : 0), variable, pastVariable});
+        start = str.find('$', pastVariable);
+    }
+}
+
+/// Finds the substitution of text[begin, end) without building a key string.
+/// The map is ordered, so the scan stops at the first greater key.
+static const std::string * findSubstitution(const std::string & text, std::size_t begin, std::size_t end,
+    const std::map<std::string, std::string> & substitutions)
+{
+    for (const auto & subst : substitutions) {
+        auto cmp = subst.first.compare(0, subst.first.npos, text, begin, end - begin);
+        if (cmp == 0)
+            return &subst.second;
+        if (cmp > 0)
+            break;
+    }
+    return nullptr;
+}
+
+std::string ConfigParser::SubstitutionTemplate::render(
+    const std::map<std::string, std::string> & substitutions) const
+{
+    if (variables.empty() || substitutions.empty())
+        return text;
+
+    std::size_t length = text.length();
+    for (const auto & var : variables) {
+        if (auto value = findSubstitution(text, var.nameBegin, var.nameEnd, substitutions))
+            length = length - (var.end - var.begin) + value->length();
     }
+
+    std::string ret;
+    ret.reserve(length);
+    std::size_t literal = 0;
+    for (const auto & var : variables) {
+        auto value = findSubstitution(text, var.nameBegin, var.nameEnd, substitutions);
+        if (!value)
+            continue;
+        ret.append(text, literal, var.begin - literal);
+        ret.append(*value);
+        literal = var.end;
+    }
+    ret.append(text, literal, text.npos);
+    return ret;
+}
+
+void ConfigParser::substitute(std::string & text,
+    const std::map<std::string, std::string> & substitutions)
+{
+    if (text.find('$') == text.npos)
+        return;
+    text = SubstitutionTemplate(std::move(text)).render(substitutions);
 }
 
-static void read(ConfigParser & cfgParser, IniParser & parser)
+static void read(ConfigParser & cfgParser, IniParser & parser, bool keepRawItems)
 {
     IniParser::ItemType readedType;
     while ((readedType = parser.next()) != IniParser::ItemType::END_OF_INPUT) {
-        auto section = parser.getSection();
+        const auto & section = parser.getSection();
         if (readedType == IniParser::ItemType::SECTION) {
-            cfgParser.addSection(std::move(section), std::move(parser.getRawItem()));
+            cfgParser.addSection(std::string(section), std::move(parser.getRawItem()));
         }
         else if (readedType == IniParser::ItemType::KEY_VAL) {
             cfgParser.setValue(section, std::move(parser.getKey()), std::move(parser.getValue()), std::move(parser.getRawItem()));
         }
+        else if (!keepRawItems) {
+            // comments and empty lines only matter for writing the file back
+            continue;
+        }
         else if (readedType == IniParser::ItemType::COMMENT_LINE || readedType == IniParser::ItemType::EMPTY_LINE) {
             if (section.empty())
                 cfgParser.getHeader() += parser.getRawItem();
@@ -84,10 +131,15 @@ static void read(ConfigParser & cfgParser, IniParser & parser)
 }
 
 void ConfigParser::read(const std::string & filePath)
+{
+    read(filePath, true);
+}
+
+void ConfigParser::read(const std::string & filePath, bool keepRawItems)
 {
     try {
-        IniParser parser(filePath);
-        ::libdnf::read(*this, parser);
+        IniParser parser(filePath, keepRawItems);
+        ::libdnf::read(*this, parser, keepRawItems);
     } catch (const IniParser::CantOpenFile & e) {
         throw CantOpenFile(e.what());
     } catch (const IniParser::Exception & e) {
@@ -99,7 +151,7 @@ void ConfigParser::read(std::unique_ptr<std::istream> && inputStream)
 {
     try {
         IniParser parser(std::move(inputStream));
-        ::libdnf::read(*this, parser);
+        ::libdnf::read(*this, parser, true);
     } catch (const IniParser::CantOpenFile & e) {
         throw CantOpenFile(e.what());
     } catch (const IniParser::Exception & e) {
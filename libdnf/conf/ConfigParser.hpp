@@ -32,6 +32,7 @@
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace libdnf {
 
@@ -65,6 +66,36 @@ public:
         MissingOption(const std::string & what) : Exception(what) {}
     };
 
+    /**
+    * @class SubstitutionTemplate
+    *
+    * @brief A text split once into its literal parts and $var/${var} references
+    *
+    * Rendering gives the same result as substitute() on the text, without scanning it again.
+    * Useful for values rendered repeatedly with changing substitutions.
+    */
+    class SubstitutionTemplate {
+    public:
+        explicit SubstitutionTemplate(std::string text);
+        /**
+        * @brief Returns the text with the variables known to substitutions replaced, in one allocation
+        */
+        std::string render(const std::map<std::string, std::string> & substitutions) const;
+        const std::string & getText() const noexcept { return text; }
+        bool hasVariables() const noexcept { return !variables.empty(); }
+
+    private:
+        /// The reference text[begin, end) naming text[nameBegin, nameEnd), literal text in between
+        struct Variable {
+            std::size_t begin;
+            std::size_t end;
+            std::size_t nameBegin;
+            std::size_t nameEnd;
+        };
+        std::string text;
+        std::vector<Variable> variables;
+    };
+
     /**
     * @brief Substitute values in text according to the substitutions map
     *
@@ -85,6 +116,16 @@ public:
     */
     void read(const std::string & filePath);
     /**
+    * @brief Reads/parse one INI file, keeping its formatting only if keepRawItems is true
+    *
+    * Without the raw items comments and empty lines are skipped, and write() formats
+    * the items anew. Intended for files that are only read.
+    *
+    * @param filePath Name (with path) of file to read
+    * @param keepRawItems Whether to keep what write() needs to reproduce the file
+    */
+    void read(const std::string & filePath, bool keepRawItems);
+    /**
     * @brief Reads/parse from istream
     *
     * Can be called repeately for reading/merge more istreams.
@@ -210,9 +251,10 @@ inline void ConfigParser::setValue(const std::string & section, const std::strin
     auto sectionIter = data.find(section);
     if (sectionIter == data.end())
         throw MissingSection(section);
-    if (rawItem.empty())
-        rawItems.erase(section + ']' + key);
-    else
+    if (rawItem.empty()) {
+        if (!rawItems.empty())
+            rawItems.erase(section + ']' + key);
+    } else
         rawItems[section + ']' + key] = rawItem;
     sectionIter->second[key] = value;
 }
@@ -222,9 +264,10 @@ inline void ConfigParser::setValue(const std::string & section, std::string && k
     auto sectionIter = data.find(section);
     if (sectionIter == data.end())
         throw MissingSection(section);
-    if (rawItem.empty())
-        rawItems.erase(section + ']' + key);
-    else
+    if (rawItem.empty()) {
+        if (!rawItems.empty())
+            rawItems.erase(section + ']' + key);
+    } else
         rawItems[section + ']' + key] = std::move(rawItem);
     sectionIter->second[std::move(key)] = std::move(value);
 }
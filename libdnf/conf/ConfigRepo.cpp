@@ -81,6 +81,7 @@ class ConfigRepo::Impl {
     OptionChild<OptionString> user_agent{mainConfig.user_agent()};
     OptionChild<OptionBool> countme{mainConfig.countme()};
     OptionChild<OptionBool> sslverifystatus{mainConfig.sslverifystatus()};
+    OptionChild<OptionBool> solv_snapshot{mainConfig.solv_snapshot()};
 };
 
 ConfigRepo::Impl::Impl(Config & owner, ConfigMain & mainConfig)
@@ -176,6 +177,7 @@ ConfigRepo::Impl::Impl(Config & owner, ConfigMain & mainConfig)
     owner.optBinds().add("user_agent", user_agent);
     owner.optBinds().add("countme", countme);
     owner.optBinds().add("sslverifystatus", sslverifystatus);
+    owner.optBinds().add("solv_snapshot", solv_snapshot);
 }
 
 ConfigRepo::ConfigRepo(ConfigMain & mainConfig) : pImpl(new Impl(*this, mainConfig)) {}
@@ -233,5 +235,6 @@ OptionString & ConfigRepo::enabled_metadata() { return pImpl->enabled_metadata;
 OptionChild<OptionString> & ConfigRepo::user_agent() { return pImpl->user_agent; }
 OptionChild<OptionBool> & ConfigRepo::countme() { return pImpl->countme; }
 OptionChild<OptionBool> & ConfigRepo::sslverifystatus() { return pImpl->sslverifystatus; }
+OptionChild<OptionBool> & ConfigRepo::solv_snapshot() { return pImpl->solv_snapshot; }
 
 }
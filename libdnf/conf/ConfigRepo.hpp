@@ -95,6 +95,7 @@ public:
     OptionString & enabled_metadata();
     OptionChild<OptionString> & user_agent();
     OptionChild<OptionBool> & countme();
+    OptionChild<OptionBool> & solv_snapshot();
     // yum compatibility options
     OptionChild<OptionBool> & sslverifystatus();
 
@@ -23,6 +23,7 @@
 #include "bgettext/bgettext-lib.h"
 #include "tinyformat/tinyformat.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace libdnf {
@@ -102,9 +103,26 @@ const char * OptionBinds::AlreadyExists::what() const noexcept
     }
 }
 
+static bool idLess(const OptionBinds::Container::value_type & item, const std::string & id)
+{
+    return item.first < id;
+}
+
+OptionBinds::iterator OptionBinds::find(const std::string & id)
+{
+    auto item = std::lower_bound(items.begin(), items.end(), id, idLess);
+    return item != items.end() && item->first == id ? item : items.end();
+}
+
+OptionBinds::const_iterator OptionBinds::find(const std::string & id) const
+{
+    auto item = std::lower_bound(items.begin(), items.end(), id, idLess);
+    return item != items.end() && item->first == id ? item : items.end();
+}
+
 OptionBinds::Item & OptionBinds::at(const std::string & id)
 {
-    auto item = items.find(id);
+    auto item = find(id);
     if (item == items.end())
         throw OutOfRange(id);
     return item->second;
@@ -112,39 +130,35 @@ OptionBinds::Item & OptionBinds::at(const std::string & id)
 
 const OptionBinds::Item & OptionBinds::at(const std::string & id) const
 {
-    auto item = items.find(id);
+    auto item = find(id);
     if (item == items.end())
         throw OutOfRange(id);
     return item->second;
 }
 
+OptionBinds::Item & OptionBinds::insert(const std::string & id, Item && item)
+{
+    auto pos = std::lower_bound(items.begin(), items.end(), id, idLess);
+    if (pos != items.end() && pos->first == id)
+        throw AlreadyExists(id);
+    return items.emplace(pos, id, std::move(item))->second;
+}
+
 OptionBinds::Item & OptionBinds::add(const std::string & id, Option & option,
     const Item::NewStringFunc & newString, const Item::GetValueStringFunc & getValueString, bool addValue)
 {
-    auto item = items.find(id);
-    if (item != items.end())
-        throw AlreadyExists(id);
-    auto res = items.emplace(id, Item(option, newString, getValueString, addValue));
-    return res.first->second;
+    return insert(id, Item(option, newString, getValueString, addValue));
 }
 
 OptionBinds::Item & OptionBinds::add(const std::string & id, Option & option,
     Item::NewStringFunc && newString, Item::GetValueStringFunc && getValueString, bool addValue)
 {
-    auto item = items.find(id);
-    if (item != items.end())
-        throw AlreadyExists(id);
-    auto res = items.emplace(id, Item(option, std::move(newString), std::move(getValueString), addValue));
-    return res.first->second;
+    return insert(id, Item(option, std::move(newString), std::move(getValueString), addValue));
 }
 
 OptionBinds::Item & OptionBinds::add(const std::string & id, Option & option)
 {
-    auto item = items.find(id);
-    if (item != items.end())
-        throw AlreadyExists(id);
-    auto res = items.emplace(id, Item(option));
-    return res.first->second;
+    return insert(id, Item(option));
 }
 
 }
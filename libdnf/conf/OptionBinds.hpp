@@ -26,7 +26,8 @@
 #include "Option.hpp"
 
 #include <functional>
-#include <map>
+#include <utility>
+#include <vector>
 
 namespace libdnf {
 
@@ -72,7 +73,10 @@ public:
         bool addValue{false}; // hint that new value be added
     };
 
-    typedef std::map<std::string, Item> Container;
+    /// Bindings are kept in a flat vector sorted by id. Lookups are a binary search without
+    /// any per-node allocation and iteration order stays alphabetical.
+    /// References to items are invalidated by a subsequent add().
+    typedef std::vector<std::pair<std::string, Item>> Container;
     typedef Container::iterator iterator;
     typedef Container::const_iterator const_iterator;
 
@@ -91,10 +95,11 @@ public:
     iterator end() noexcept { return items.end(); }
     const_iterator end() const noexcept { return items.end(); }
     const_iterator cend() const noexcept { return items.cend(); }
-    iterator find(const std::string & id) { return items.find(id); }
-    const_iterator find(const std::string & id) const { return items.find(id); }
+    iterator find(const std::string & id);
+    const_iterator find(const std::string & id) const;
 
 private:
+    Item & insert(const std::string & id, Item && item);
     Container items;
 };
 
@@ -40,10 +40,12 @@
 #include "goal/Goal.hpp"
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 #include <unordered_set>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <rpm/rpmlib.h>
 #include <rpm/rpmmacro.h>
 #include <rpm/rpmts.h>
@@ -51,9 +53,12 @@
 #include <librepo/librepo.h>
 #ifdef RHSM_SUPPORT
 #include <rhsm/rhsm.h>
+#include <errno.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
 #include <unistd.h>
 #endif
@@ -63,6 +68,7 @@
 #include "catch-error.hpp"
 #include "log.hpp"
 #include "tinyformat/tinyformat.hpp"
+#include "dnf-goal.h"
 #include "dnf-lock.h"
 #include "dnf-package.h"
 #include "dnf-repo-loader.h"
@@ -71,6 +77,7 @@
 #include "dnf-transaction.h"
 #include "dnf-utils.h"
 #include "dnf-sack.h"
+#include "hy-iutil-private.hpp"
 #include "hy-query.h"
 #include "hy-query-private.hpp"
 #include "hy-subject.h"
@@ -78,7 +85,9 @@
 #include "dnf-repo.hpp"
 #include "goal/Goal.hpp"
 #include "plugin/plugin-private.hpp"
+#include "utils/AsyncLogger.hpp"
 #include "utils/GLibLogger.hpp"
+#include "utils/PhaseTimer.hpp"
 #include "utils/os-release.hpp"
 
 
@@ -86,6 +95,12 @@
 
 #define RELEASEVER_PROV "system-release(releasever)"
 
+/* the packages of the last dnf_context_prefetch_upgrades(), one file per line */
+#define PREFETCH_RECORD_FN "prefetched-upgrades"
+
+/* infix of the directories dnf_context_clean_cache() moves the cleaned files into */
+#define CLEAN_TRASH_INFIX ".clean-"
+
 /* data taken from https://github.com/rpm-software-management/dnf/blob/master/dnf/arch.py */
 static const struct {
     const gchar    *base;
@@ -158,13 +173,16 @@ typedef struct
     gchar            *user_agent;
     gchar            *arch;
     guint            cache_age;     /*seconds*/
+    guint            repomd_stat_max_age; /*seconds*/
     gboolean         cacheOnly{false};
     gboolean         check_disk_space;
     gboolean         check_transaction;
     gboolean         only_trusted;
     gboolean         enable_filelists;
+    gboolean         lazy_repo_setup;
     gboolean         enrollment_valid;
     gboolean         write_history;
+    gboolean         vendor_cache_hardlink;
     DnfLock         *lock;
     DnfTransaction  *transaction;
     GThread         *transaction_thread;
@@ -195,6 +213,8 @@ enum {
 };
 
 static libdnf::GLibLogger glibLogger(G_LOG_DOMAIN);
+static libdnf::AsyncLogger asyncLogger(glibLogger);
+static bool logAsync = false;
 static std::string pluginsDir = DEFAULT_PLUGINS_DIRECTORY;
 static std::unique_ptr<std::string> configFilePath;
 static std::set<std::string> pluginsEnabled;
@@ -359,7 +379,7 @@ dnf_context_init(DnfContext *context)
 {
     DnfContextPrivate *priv = GET_PRIVATE(context);
 
-    libdnf::Log::setLogger(&glibLogger);
+    libdnf::Log::setLogger(logAsync ? static_cast<libdnf::Logger *>(&asyncLogger) : &glibLogger);
 
     priv->install_root = g_strdup("/");
     priv->check_disk_space = TRUE;
@@ -1089,6 +1109,21 @@ dnf_context_get_enable_filelists (DnfContext     *context)
     return priv->enable_filelists;
 }
 
+/**
+ * dnf_context_get_lazy_repo_setup:
+ * @context: a #DnfContext instance.
+ *
+ * Returns: %TRUE if the setup of disabled repos is deferred
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_context_get_lazy_repo_setup (DnfContext     *context)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    return priv->lazy_repo_setup;
+}
+
 /**
  * dnf_context_get_cache_age:
  * @context: a #DnfContext instance.
@@ -1106,6 +1141,23 @@ dnf_context_get_cache_age(DnfContext *context)
     return priv->cache_age;
 }
 
+/**
+ * dnf_context_get_repomd_stat_max_age:
+ * @context: a #DnfContext instance.
+ *
+ * Gets the maximum solv cache age for trusting the repomd.xml stat.
+ *
+ * Returns: age in seconds, 0 if repomd.xml is always hashed
+ *
+ * Since: 0.70.0
+ **/
+guint
+dnf_context_get_repomd_stat_max_age(DnfContext *context)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    return priv->repomd_stat_max_age;
+}
+
 /**
  * dnf_context_get_installonly_pkgs:
  * @context: a #DnfContext instance.
@@ -1190,6 +1242,44 @@ dnf_context_set_config_file_path(const gchar * config_file_path)
     }
 }
 
+/**
+ * dnf_context_get_log_async:
+ *
+ * Gets whether libdnf log messages are written from a background thread.
+ *
+ * Returns: %TRUE if the messages are written asynchronously
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_context_get_log_async(void)
+{
+    return logAsync;
+}
+
+/**
+ * dnf_context_set_log_async:
+ * @log_async: %TRUE to write the log messages from a background thread
+ *
+ * Hands the libdnf log messages over to a background thread which passes
+ * them to GLib. Callers do not wait for the log handlers then, which keeps
+ * debug logging cheap. Messages of the error level are still written before
+ * the logging call returns. Disabling waits for the queued messages.
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_context_set_log_async(gboolean log_async)
+{
+    logAsync = log_async;
+    if (logAsync) {
+        libdnf::Log::setLogger(&asyncLogger);
+    } else {
+        libdnf::Log::setLogger(&glibLogger);
+        asyncLogger.flush();
+    }
+}
+
 /**
  * dnf_context_set_repos_dir:
  * @context: a #DnfContext instance.
@@ -1360,6 +1450,25 @@ dnf_context_set_vendor_cache_dir(DnfContext *context, const gchar *vendor_cache_
     priv->vendor_cache_dir = g_strdup(vendor_cache_dir);
 }
 
+/**
+ * dnf_context_set_vendor_cache_hardlink:
+ * @context: a #DnfContext instance.
+ * @vendor_cache_hardlink: %TRUE to hardlink the vendor cache files
+ *
+ * Sets if the files of the vendor cache and the vendor solve cache seed the
+ * caches as hardlinks instead of copies, e.g. for a read-only image on the same
+ * filesystem. The caches replace their files and never change them in place.
+ * Files that cannot be linked are copied.
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_context_set_vendor_cache_hardlink(DnfContext *context, gboolean vendor_cache_hardlink)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    priv->vendor_cache_hardlink = vendor_cache_hardlink;
+}
+
 /**
  * dnf_context_set_vendor_solv_dir:
  * @context: a #DnfContext instance.
@@ -1570,6 +1679,25 @@ dnf_context_set_enable_filelists (DnfContext     *context,
     priv->enable_filelists = enable_filelists;
 }
 
+/**
+ * dnf_context_set_lazy_repo_setup:
+ * @context: a #DnfContext instance.
+ * @lazy_repo_setup: %TRUE to defer the setup of disabled repos
+ *
+ * Makes the repo loader only load the configuration of the repos which
+ * are disabled; see dnf_repo_setup_lazy(). This must be done before
+ * dnf_context_setup() is called.
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_context_set_lazy_repo_setup (DnfContext     *context,
+                                 gboolean        lazy_repo_setup)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    priv->lazy_repo_setup = lazy_repo_setup;
+}
+
 /**
  * dnf_context_set_only_trusted:
  * @context: a #DnfContext instance.
@@ -1634,6 +1762,23 @@ dnf_context_set_cache_age(DnfContext *context, guint cache_age)
     priv->cache_age = cache_age;
 }
 
+/**
+ * dnf_context_set_repomd_stat_max_age:
+ * @context: a #DnfContext instance.
+ * @max_age: Maximum solv cache age in seconds, or 0
+ *
+ * Sets the maximum solv cache age for trusting the repomd.xml stat, see
+ * dnf_sack_set_repomd_stat_max_age().
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_context_set_repomd_stat_max_age(DnfContext *context, guint max_age)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    priv->repomd_stat_max_age = max_age;
+}
+
 /**
  * dnf_context_set_os_release:
  **/
@@ -1747,6 +1892,58 @@ have_existing_install(DnfContext *context)
     return g_file_test(usr_path, G_FILE_TEST_IS_DIR);
 }
 
+static DnfSackAddFlags
+dnf_context_sack_add_flags(DnfContext *context, DnfContextSetupSackFlags flags)
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    DnfSackAddFlags add_flags = DNF_SACK_ADD_FLAG_NONE;
+    if ((flags & DNF_CONTEXT_SETUP_SACK_FLAG_LOAD_UPDATEINFO) > 0)
+        add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_UPDATEINFO);
+    if (priv->enable_filelists && !((flags & DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_FILELISTS) > 0))
+        add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_FILELISTS);
+    if ((flags & DNF_CONTEXT_SETUP_SACK_FLAG_PARALLEL_LOAD) > 0)
+        add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_PARALLEL);
+    return add_flags;
+}
+
+/* Loads the rpmdb into the sack on its own thread while the remote repos are
+ * checked and their solv caches built; joined before the repos fill the pool. */
+struct SystemRepoLoad {
+    DnfSack *sack;
+    GThread *thread{nullptr};
+    gboolean ret{FALSE};
+    GError *error{nullptr};
+
+    explicit SystemRepoLoad(DnfSack *a_sack) : sack(a_sack) {}
+    ~SystemRepoLoad()
+    {
+        join(nullptr);
+        g_clear_error(&error);
+    }
+
+    gboolean join(GError **error_out)
+    {
+        if (thread == nullptr)
+            return TRUE;
+        g_thread_join(thread);
+        thread = nullptr;
+        if (!ret) {
+            g_propagate_error(error_out, error);
+            error = nullptr;
+        }
+        return ret;
+    }
+};
+
+static gpointer
+dnf_context_load_system_repo_cb(gpointer data)
+{
+    auto load = static_cast<SystemRepoLoad *>(data);
+    load->ret = dnf_sack_load_system_repo(load->sack, nullptr, DNF_SACK_LOAD_FLAG_BUILD_CACHE,
+                                          &load->error);
+    return nullptr;
+}
+
 /**
  * dnf_context_setup_sack:(skip)
  * @context: a #DnfContext instance.
@@ -1810,32 +2007,40 @@ dnf_context_setup_sack_with_flags(DnfContext               *context,
         return FALSE;
     dnf_sack_set_installonly(priv->sack, dnf_context_get_installonly_pkgs(context));
     dnf_sack_set_installonly_limit(priv->sack, dnf_context_get_installonly_limit(context));
+    dnf_sack_set_repomd_stat_max_age(priv->sack, priv->repomd_stat_max_age);
 
-    /* add installed packages */
+    /* add installed packages, overlapping the repo checks when loading in parallel */
     const gboolean skip_rpmdb = ((flags & DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_RPMDB) > 0);
+    const gboolean parallel = ((flags & DNF_CONTEXT_SETUP_SACK_FLAG_PARALLEL_LOAD) > 0);
+    SystemRepoLoad system_repo_load(priv->sack);
     if (!skip_rpmdb && have_existing_install(context)) {
-        if (!dnf_sack_load_system_repo(priv->sack,
+        if (parallel)
+            system_repo_load.thread = g_thread_try_new("rpmdb", dnf_context_load_system_repo_cb,
+                                                       &system_repo_load, nullptr);
+        if (system_repo_load.thread == nullptr &&
+            !dnf_sack_load_system_repo(priv->sack,
                                        nullptr,
-                                       DNF_SACK_LOAD_FLAG_NONE,
+                                       DNF_SACK_LOAD_FLAG_BUILD_CACHE,
                                        error))
             return FALSE;
     }
 
-    DnfSackAddFlags add_flags = DNF_SACK_ADD_FLAG_NONE;
-    if ((flags & DNF_CONTEXT_SETUP_SACK_FLAG_LOAD_UPDATEINFO) > 0)
-        add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_UPDATEINFO);
-    if (priv->enable_filelists && !((flags & DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_FILELISTS) > 0))
-        add_flags = static_cast<DnfSackAddFlags>(add_flags | DNF_SACK_ADD_FLAG_FILELISTS);
+    DnfSackAddFlags add_flags = dnf_context_sack_add_flags(context, flags);
 
     /* add remote */
-    ret = dnf_sack_add_repos(priv->sack,
-                             priv->repos,
-                             priv->cache_age,
-                             add_flags,
-                             state,
-                             error);
+    ret = dnf_sack_add_repos_full(priv->sack,
+                                  priv->repos,
+                                  priv->cache_age,
+                                  add_flags,
+                                  state,
+                                  [&system_repo_load](GError **error_load) {
+                                      return system_repo_load.join(error_load);
+                                  },
+                                  error);
     if (!ret)
         return FALSE;
+    if (!system_repo_load.join(error))
+        return FALSE;
 
     DnfSack *sack = priv->sack;
     if (sack != nullptr) {
@@ -1884,9 +2089,11 @@ dnf_context_ensure_exists(const gchar *directory, GError **error) try
 
 /**
  * dnf_utils_copy_files:
+ *
+ * Reflinks, hardlinks or copies the files, see dnf_copy_file().
  */
 static gboolean
-dnf_utils_copy_files(const gchar *src, const gchar *dest, GError **error) try
+dnf_utils_copy_files(const gchar *src, const gchar *dest, gboolean hardlink, GError **error) try
 {
     const gchar *tmp;
     gint rc;
@@ -1912,17 +2119,10 @@ dnf_utils_copy_files(const gchar *src, const gchar *dest, GError **error) try
         path_src = g_build_filename(src, tmp, NULL);
         path_dest = g_build_filename(dest, tmp, NULL);
         if (g_file_test(path_src, G_FILE_TEST_IS_DIR)) {
-            if (!dnf_utils_copy_files(path_src, path_dest, error))
+            if (!dnf_utils_copy_files(path_src, path_dest, hardlink, error))
                 return FALSE;
-        } else {
-            g_autoptr(GFile) file_src = NULL;
-            g_autoptr(GFile) file_dest = NULL;
-            file_src = g_file_new_for_path(path_src);
-            file_dest = g_file_new_for_path(path_dest);
-            if (!g_file_copy(file_src, file_dest,
-                      G_FILE_COPY_NONE,
-                      NULL, NULL, NULL,
-                      error))
+        } else if (!hardlink || link(path_src, path_dest) != 0) {
+            if (!dnf_copy_file(path_src, path_dest, error))
                 return FALSE;
         }
     }
@@ -1969,7 +2169,7 @@ dnf_context_copy_vendor_cache(DnfContext *context, GError **error) try
         if (!g_file_test(path_vendor, G_FILE_TEST_EXISTS))
             continue;
         g_debug("copying files from %s to %s", path_vendor, path);
-        if (!dnf_utils_copy_files(path_vendor, path, error))
+        if (!dnf_utils_copy_files(path_vendor, path, priv->vendor_cache_hardlink, error))
             return FALSE;
     }
 
@@ -2002,7 +2202,8 @@ dnf_context_copy_vendor_solv(DnfContext *context, GError **error) try
 
     /* copy all the files */
     g_debug("copying files from %s to %s", priv->vendor_solv_dir, priv->solv_dir);
-    if (!dnf_utils_copy_files(priv->vendor_solv_dir, priv->solv_dir, error))
+    if (!dnf_utils_copy_files(priv->vendor_solv_dir, priv->solv_dir,
+                              priv->vendor_cache_hardlink, error))
         return FALSE;
 
     return TRUE;
@@ -2177,6 +2378,7 @@ dnf_context_setup(DnfContext *context,
            GError **error) try
 {
     DnfContextPrivate *priv = GET_PRIVATE(context);
+    libdnf::PhaseTimer timer("dnf_context_setup");
     guint i;
     guint j;
     GHashTableIter hashiter;
@@ -2773,6 +2975,129 @@ dnf_context_invalidate(DnfContext *context, const gchar *message)
                                 DNF_CONTEXT_INVALIDATE_FLAG_RPMDB);
 }
 
+/* Moves what dnf_delete_files_matching() would delete into trash, numbered by moved. */
+static gboolean
+dnf_context_move_files_matching(const gchar *directory_path,
+                                const char *const *patterns,
+                                const gchar *trash,
+                                guint *moved,
+                                GError **error)
+{
+    const gchar *filename;
+    g_autoptr(GDir) dir = g_dir_open(directory_path, 0, error);
+    if (dir == NULL) {
+        g_prefix_error(error, "Cannot open directory %s: ", directory_path);
+        return FALSE;
+    }
+    while ((filename = g_dir_read_name(dir))) {
+        g_autofree gchar *src = g_build_filename(directory_path, filename, NULL);
+        gboolean matching = FALSE;
+        for (auto iter = patterns; *iter; iter++) {
+            if (g_str_has_suffix(filename, *iter)) {
+                matching = TRUE;
+                break;
+            }
+        }
+        if (matching) {
+            g_autofree gchar *name = g_strdup_printf("%u", (*moved)++);
+            g_autofree gchar *dest = g_build_filename(trash, name, NULL);
+            if (g_rename(src, dest) == 0)
+                continue;
+            if (errno != EXDEV) {
+                g_set_error(error,
+                            DNF_ERROR,
+                            DNF_ERROR_INTERNAL_ERROR,
+                            "failed to move %s: %s", src, g_strerror(errno));
+                return FALSE;
+            }
+            /* e.g. a mount point below the cache, deleted in place */
+            gboolean ret = g_file_test(src, G_FILE_TEST_IS_DIR) ?
+                dnf_remove_recursive(src, error) : dnf_ensure_file_unlinked(src, error);
+            if (!ret)
+                return FALSE;
+        } else if (g_file_test(src, G_FILE_TEST_IS_DIR)) {
+            if (!dnf_context_move_files_matching(src, patterns, trash, moved, error))
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* first error of the parallel deletion of the trash */
+struct CleanTrashResult {
+    std::mutex mutex;
+    GError *error{nullptr};
+};
+
+static void
+dnf_context_clean_trash_cb(gpointer data, gpointer user_data)
+{
+    g_autofree gchar *path = static_cast<gchar *>(data);
+    auto result = static_cast<CleanTrashResult *>(user_data);
+    GError *error_local = NULL;
+    gboolean ret;
+    if (g_file_test(path, G_FILE_TEST_IS_DIR) && !g_file_test(path, G_FILE_TEST_IS_SYMLINK))
+        ret = dnf_remove_recursive(path, &error_local);
+    else
+        ret = dnf_ensure_file_unlinked(path, &error_local);
+    if (ret)
+        return;
+    std::lock_guard<std::mutex> guard(result->mutex);
+    if (result->error == NULL)
+        result->error = error_local;
+    else
+        g_error_free(error_local);
+}
+
+/* Deletes the trash directories, their entries in parallel. */
+static gboolean
+dnf_context_remove_trash(GPtrArray *trashes, GError **error)
+{
+    CleanTrashResult result;
+    GThreadPool *pool = g_thread_pool_new(dnf_context_clean_trash_cb, &result,
+                                          g_get_num_processors(), TRUE, NULL);
+    for (guint i = 0; i < trashes->len; i++) {
+        auto trash = static_cast<const gchar *>(g_ptr_array_index(trashes, i));
+        g_autoptr(GDir) dir = g_dir_open(trash, 0, NULL);
+        const gchar *filename;
+        while (dir != NULL && (filename = g_dir_read_name(dir))) {
+            gchar *path = g_build_filename(trash, filename, NULL);
+            if (pool == NULL || !g_thread_pool_push(pool, path, NULL))
+                dnf_context_clean_trash_cb(path, &result);
+        }
+    }
+    if (pool != NULL)
+        g_thread_pool_free(pool, FALSE, TRUE);
+    if (result.error != NULL) {
+        g_propagate_error(error, result.error);
+        return FALSE;
+    }
+    for (guint i = 0; i < trashes->len; i++) {
+        auto trash = static_cast<const gchar *>(g_ptr_array_index(trashes, i));
+        if (g_remove(trash) != 0 && errno != ENOENT) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        "failed to remove %s", trash);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Adds the trash directories of interrupted cleans in directory starting with prefix. */
+static void
+dnf_context_find_trash(const gchar *directory, const gchar *prefix, GPtrArray *trashes)
+{
+    g_autoptr(GDir) dir = g_dir_open(directory, 0, NULL);
+    const gchar *filename;
+    while (dir != NULL && (filename = g_dir_read_name(dir))) {
+        if (g_str_has_prefix(filename, prefix) &&
+            g_str_has_prefix(filename + strlen(prefix), CLEAN_TRASH_INFIX))
+            g_ptr_array_add(trashes, g_build_filename(directory, filename, NULL));
+    }
+}
+
 /**
  * dnf_context_clean_cache:
  * @context: a #DnfContext instance.
@@ -2791,6 +3116,10 @@ dnf_context_invalidate(DnfContext *context, const gchar *message)
  *
  * Note: when DNF_CONTEXT_CLEAN_ALL flag is seen, the other flags will be ignored
  *
+ * The metadata lock is only held while the files are renamed aside, they are
+ * deleted in parallel afterwards. Files left behind by an interrupted clean
+ * are deleted by the next one.
+ *
  * Returns: %TRUE for success, %FALSE otherwise
  *
  * Since: 0.9.4
@@ -2801,9 +3130,11 @@ dnf_context_clean_cache(DnfContext *context,
                         GError **error) try
 {
     g_autoptr(GPtrArray) suffix_list = g_ptr_array_new();
-    const gchar* directory_location;
+    g_autoptr(GPtrArray) trashes = g_ptr_array_new_with_free_func(g_free);
+    g_autofree gchar *trash = NULL;
     gboolean ret = TRUE;
     guint lock_id = 0;
+    guint moved = 0;
 
     /* Set up the context if it hasn't been set earlier */
     if (!dnf_context_setup(context, NULL, error))
@@ -2819,11 +3150,6 @@ dnf_context_clean_cache(DnfContext *context,
         return FALSE;
     }
 
-    /* When clean all flags show up, we remove everything from cache directory */
-    if (flags & DNF_CONTEXT_CLEAN_ALL) {
-        return dnf_remove_recursive(priv->cache_dir, error);
-    }
-
     /* We acquire the metadata related lock */
     lock_id = dnf_lock_take(priv->lock,
                             DNF_LOCK_TYPE_METADATA,
@@ -2832,6 +3158,27 @@ dnf_context_clean_cache(DnfContext *context,
     if (lock_id == 0)
         return FALSE;
 
+    /* When clean all flags show up, we remove everything from cache directory,
+     * renamed aside in one step next to it */
+    if (flags & DNF_CONTEXT_CLEAN_ALL) {
+        g_autofree gchar *parent = g_path_get_dirname(priv->cache_dir);
+        g_autofree gchar *base = g_path_get_basename(priv->cache_dir);
+        dnf_context_find_trash(parent, base, trashes);
+        if (g_file_test(priv->cache_dir, G_FILE_TEST_EXISTS)) {
+            trash = g_strconcat(priv->cache_dir, CLEAN_TRASH_INFIX "XXXXXX", NULL);
+            if (g_mkdtemp(trash) == NULL || g_rename(priv->cache_dir, trash) != 0) {
+                g_set_error(error,
+                            DNF_ERROR,
+                            DNF_ERROR_INTERNAL_ERROR,
+                            "failed to move %s aside: %s", priv->cache_dir, g_strerror(errno));
+                ret = FALSE;
+                goto out;
+            }
+            g_ptr_array_add(trashes, g_steal_pointer(&trash));
+        }
+        goto out;
+    }
+
     /* After the above setup is done, we prepare file extensions based on flag types */
     if (flags & DNF_CONTEXT_CLEAN_PACKAGES)
         g_ptr_array_add(suffix_list, (char*) "packages");
@@ -2845,29 +3192,44 @@ dnf_context_clean_cache(DnfContext *context,
     /* Add a NULL terminator for future looping */
     g_ptr_array_add(suffix_list, NULL);
 
-    /* We then start looping all of the repos to perform file deletion */
+    dnf_context_find_trash(priv->cache_dir, "", trashes);
+    trash = g_build_filename(priv->cache_dir, CLEAN_TRASH_INFIX "XXXXXX", NULL);
+    if (g_mkdir_with_parents(priv->cache_dir, 0755) != 0 || g_mkdtemp(trash) == NULL) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_INTERNAL_ERROR,
+                    "failed to create %s: %s", trash, g_strerror(errno));
+        ret = FALSE;
+        goto out;
+    }
+    g_ptr_array_add(trashes, g_strdup(trash));
+
+    /* We then start looping all of the repos to move the files aside */
     for (guint counter = 0; counter < priv->repos->len; counter++) {
         auto src = static_cast<DnfRepo *>(g_ptr_array_index(priv->repos, counter));
         gboolean deleteable_repo = dnf_repo_get_kind(src) == DNF_REPO_KIND_REMOTE;
-        directory_location = dnf_repo_get_location(src);
+        const gchar *directory_location = dnf_repo_get_location(src);
 
         /* We check if the repo is qualified to be cleaned */
         if (deleteable_repo &&
             g_file_test(directory_location, G_FILE_TEST_EXISTS)) {
-            ret = dnf_delete_files_matching(directory_location,
-                                            (const char* const*) suffix_list->pdata,
-                                            error);
-            if(!ret)
+            ret = dnf_context_move_files_matching(directory_location,
+                                                  (const char* const*) suffix_list->pdata,
+                                                  trash, &moved, error);
+            if (!ret)
                 goto out;
-            }
         }
+    }
 
-    out:
-        /* release the acquired lock */
-        if (!dnf_lock_release(priv->lock, lock_id, error))
-            return FALSE;
-        return ret;
+out:
+    /* release the acquired lock, the files are gone from the cache already */
+    if (!dnf_lock_release(priv->lock, lock_id, ret ? error : NULL))
+        return FALSE;
+    if (!dnf_context_remove_trash(trashes, ret ? error : NULL))
+        return FALSE;
+    return ret;
 } CATCH_TO_GERROR(FALSE)
+
 /**
  * dnf_context_new:
  *
@@ -3113,6 +3475,250 @@ recompute_modular_filtering(DnfContext * context, DnfSack * sack, GError ** erro
     return TRUE;
 }
 
+/**
+ * dnf_context_refresh_sack:(skip)
+ * @context: a #DnfContext instance.
+ * @state: A #DnfState
+ * @flags: the #DnfContextSetupSackFlags the sack was set up with
+ * @error: A #GError or %NULL
+ *
+ * Brings a sack set up before up to date without rebuilding it, e.g. after
+ * the #DnfContext::invalidate signal of a long-lived context. When the rpmdb
+ * changed only the installed packages are reloaded, and of the remote repos
+ * only those whose metadata changed on disk, e.g. by dnf_repo_update().
+ * Modular filtering is then recomputed as dnf_context_setup_sack() does.
+ * Without a sack this is dnf_context_setup_sack_with_flags().
+ *
+ * Packages, queries and goals of the previous sack contents must not be used
+ * after anything was reloaded.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_context_refresh_sack(DnfContext               *context,
+                         DnfState                 *state,
+                         DnfContextSetupSackFlags  flags,
+                         GError                  **error) try
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+
+    if (priv->sack == nullptr)
+        return dnf_context_setup_sack_with_flags(context, state, flags, error);
+
+    const gboolean reload_rpmdb = ((flags & DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_RPMDB) == 0) &&
+                                  dnf_sack_system_repo_is_stale(priv->sack);
+    g_autoptr(GPtrArray) stale_repos = g_ptr_array_new();
+    for (guint i = 0; i < priv->repos->len; i++) {
+        auto repo = static_cast<DnfRepo *>(g_ptr_array_index(priv->repos, i));
+        if (dnf_sack_repo_is_stale(priv->sack, dnf_repo_get_repo(repo)))
+            g_ptr_array_add(stale_repos, repo);
+    }
+    if (!reload_rpmdb && stale_repos->len == 0)
+        return dnf_state_finished(state, error);
+
+    dnf_state_set_number_steps(state, stale_repos->len + (reload_rpmdb ? 1 : 0) + 1);
+    if (reload_rpmdb) {
+        g_debug("rpmdb changed, reloading installed packages");
+        if (!dnf_sack_reload_system_repo(priv->sack, DNF_SACK_LOAD_FLAG_BUILD_CACHE, error))
+            return FALSE;
+        if (!dnf_state_done(state, error))
+            return FALSE;
+    }
+
+    auto add_flags = dnf_context_sack_add_flags(context, flags);
+    for (guint i = 0; i < stale_repos->len; i++) {
+        auto repo = static_cast<DnfRepo *>(g_ptr_array_index(stale_repos, i));
+        if (!dnf_sack_reload_repo(priv->sack, repo, add_flags, error))
+            return FALSE;
+        if (!dnf_state_done(state, error))
+            return FALSE;
+    }
+
+    if (!recompute_modular_filtering(context, priv->sack, error))
+        return FALSE;
+
+    /* the goal refers to solvables that may be gone */
+    if (priv->goal != nullptr)
+        hy_goal_free(priv->goal);
+    priv->goal = hy_goal_create(priv->sack);
+    return dnf_state_done(state, error);
+} CATCH_TO_GERROR(FALSE)
+
+/* Runs the prewarming at the lowest CPU and idle I/O priority of the calling
+ * thread. With reset_nice the previous priorities are restored afterwards, so
+ * later work of a long-lived process, like a transaction, is not slowed down. */
+struct PrewarmPriority {
+    int nice{0};
+    int ioprio{-1};
+    bool restore;
+
+    PrewarmPriority() : restore(libdnf::getGlobalMainConfig().reset_nice().getValue())
+    {
+        errno = 0;
+        nice = getpriority(PRIO_PROCESS, 0);
+        if (errno != 0)
+            restore = false;
+        if (setpriority(PRIO_PROCESS, 0, 19) != 0)
+            g_debug("failed to lower the CPU priority: %s", g_strerror(errno));
+#ifdef SYS_ioprio_set
+        /* IOPRIO_WHO_PROCESS, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT */
+        ioprio = static_cast<int>(syscall(SYS_ioprio_get, 1, 0));
+        if (syscall(SYS_ioprio_set, 1, 0, 3 << 13) != 0)
+            g_debug("failed to lower the I/O priority: %s", g_strerror(errno));
+#endif
+    }
+    ~PrewarmPriority()
+    {
+        if (!restore)
+            return;
+        /* raising the nice value back needs CAP_SYS_NICE, libdnf runs as root */
+        if (setpriority(PRIO_PROCESS, 0, nice) != 0)
+            g_debug("failed to restore the CPU priority: %s", g_strerror(errno));
+#ifdef SYS_ioprio_set
+        if (ioprio >= 0)
+            syscall(SYS_ioprio_set, 1, 0, ioprio);
+#endif
+    }
+};
+
+/**
+ * dnf_context_prewarm:(skip)
+ * @context: a #DnfContext instance.
+ * @state: A #DnfState
+ * @flags: the #DnfContextSetupSackFlags later commands set up their sack with
+ * @error: A #GError or %NULL
+ *
+ * Gets the caches ready for the next command, e.g. from a timer running after
+ * metadata_timer_sync. Expired repos are refreshed, the solv caches of the
+ * repos and the rpmdb are rebuilt, the module metadata is loaded and filtered
+ * and the whatprovides index and, if enabled, the substring indexes are
+ * stored in the cache directory. A later sack set up with the same @flags
+ * then starts from the caches only.
+ *
+ * The work runs at the lowest CPU and idle I/O priority. When reset_nice is
+ * set the previous priorities are restored before returning.
+ *
+ * Like dnf_context_setup_sack() this replaces the sack of @context, packages,
+ * queries and goals of the previous one must not be used anymore.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_context_prewarm(DnfContext               *context,
+                    DnfState                 *state,
+                    DnfContextSetupSackFlags  flags,
+                    GError                  **error) try
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    PrewarmPriority priority;
+
+    if (!dnf_state_set_steps(state, error,
+                             90, /* setup sack */
+                             10, /* indexes */
+                             -1))
+        return FALSE;
+    g_clear_object(&priv->sack);
+    if (!dnf_context_setup_sack_with_flags(context, dnf_state_get_child(state), flags, error))
+        return FALSE;
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    /* both write their cache files as a side effect */
+    dnf_sack_make_provides_ready(priv->sack);
+    if (dnf_sack_get_use_substring_index(priv->sack)) {
+        for (Id keyname : {SOLVABLE_SUMMARY, SOLVABLE_DESCRIPTION, SOLVABLE_URL})
+            dnf_sack_get_substring_index(priv->sack, keyname);
+    }
+    return dnf_state_done(state, error);
+} CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_context_prefetch_upgrades:(skip)
+ * @context: a #DnfContext instance.
+ * @state: A #DnfState
+ * @error: A #GError or %NULL
+ *
+ * Downloads the packages an upgrade of all packages would install into the
+ * package cache, without changing the system, so a later transaction finds
+ * them there. The goal and the transaction of @context are not touched, the
+ * downloads obey the throttle and bandwidth options of the repos and run at
+ * low priority like dnf_context_prewarm().
+ *
+ * The downloaded files are recorded in the cache directory. Files recorded by
+ * an earlier call that the upgrade no longer needs, e.g. as the repos moved on
+ * to newer versions, are removed. A cached file whose checksum does not match
+ * the metadata any longer is downloaded again by dnf_transaction_download().
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_context_prefetch_upgrades(DnfContext *context, DnfState *state, GError **error) try
+{
+    DnfContextPrivate *priv = GET_PRIVATE(context);
+    PrewarmPriority priority;
+
+    if (!dnf_state_set_steps(state, error,
+                             10, /* setup sack */
+                             10, /* depsolve */
+                             80, /* download */
+                             -1))
+        return FALSE;
+    if (priv->sack == nullptr &&
+        !dnf_context_setup_sack(context, dnf_state_get_child(state), error))
+        return FALSE;
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    g_autoptr(DnfTransaction) transaction = dnf_transaction_new(context);
+    dnf_transaction_set_repos(transaction, priv->repos);
+    std::unique_ptr<libdnf::Goal> goal(new libdnf::Goal(priv->sack));
+    goal->upgrade();
+    if (!dnf_transaction_depsolve(transaction, goal.get(), dnf_state_get_child(state), error))
+        return FALSE;
+    if (!dnf_state_done(state, error))
+        return FALSE;
+    if (!dnf_transaction_download(transaction, dnf_state_get_child(state), error))
+        return FALSE;
+
+    /* record the new set, dropping files only the previous one needed */
+    g_autofree gchar *record_fn = g_build_filename(priv->cache_dir, PREFETCH_RECORD_FN, NULL);
+    g_autoptr(GPtrArray) packages = dnf_goal_get_packages(goal.get(),
+                                                          DNF_PACKAGE_INFO_INSTALL,
+                                                          DNF_PACKAGE_INFO_DOWNGRADE,
+                                                          DNF_PACKAGE_INFO_UPDATE,
+                                                          -1);
+    std::unordered_set<std::string> prefetched;
+    std::string record;
+    for (guint i = 0; i < packages->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(packages, i));
+        const gchar *fn = dnf_package_get_filename(pkg);
+        if (fn == nullptr || g_strcmp0(dnf_package_get_reponame(pkg), HY_CMDLINE_REPO_NAME) == 0)
+            continue;
+        if (prefetched.insert(fn).second)
+            record.append(fn).push_back('\n');
+    }
+    g_autofree gchar *previous = nullptr;
+    if (g_file_get_contents(record_fn, &previous, nullptr, nullptr)) {
+        g_auto(GStrv) lines = g_strsplit(previous, "\n", -1);
+        for (guint i = 0; lines[i] != nullptr; i++) {
+            if (lines[i][0] == '\0' || prefetched.count(lines[i]) > 0)
+                continue;
+            g_debug("pruning prefetched %s", lines[i]);
+            if (g_unlink(lines[i]) != 0 && errno != ENOENT)
+                g_debug("failed to remove %s: %s", lines[i], g_strerror(errno));
+        }
+    }
+    if (!g_file_set_contents(record_fn, record.c_str(), record.size(), error))
+        return FALSE;
+    return dnf_state_done(state, error);
+} CATCH_TO_GERROR(FALSE)
+
 /* See header docstring; you likely want dnf_context_module_reset instead. */
 gboolean
 dnf_context_reset_modules(DnfContext * context, DnfSack * sack, const char ** module_names, GError ** error) try
@@ -3881,11 +4487,11 @@ libdnf::ConfigMain & getGlobalMainConfig(bool canReadConfigFile)
         libdnf::ConfigParser parser;
         const std::string cfgPath{globalMainConfig->config_file_path().getValue()};
         try {
-            parser.read(cfgPath);
+            parser.read(cfgPath, false);
             const auto & cfgParserData = parser.getData();
             auto cfgParserDataIter = cfgParserData.find("main");
             if (cfgParserDataIter != cfgParserData.end()) {
-                auto optBinds = globalMainConfig->optBinds();
+                auto & optBinds = globalMainConfig->optBinds();
                 const auto & cfgParserMainSect = cfgParserDataIter->second;
                 for (const auto & opt : cfgParserMainSect) {
                     auto optBindsIter = optBinds.find(opt.first);
@@ -91,6 +91,8 @@ typedef enum {
  * @DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_RPMDB:       Don't load system's rpmdb
  * @DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_FILELISTS:   Don't load filelists
  * @DNF_CONTEXT_SETUP_SACK_FLAG_LOAD_UPDATEINFO:  Load updateinfo if available
+ * @DNF_CONTEXT_SETUP_SACK_FLAG_PARALLEL_LOAD:    Build missing solv caches of repos in parallel,
+ *                                                loading the rpmdb meanwhile
  *
  * The sack setup flags.
  *
@@ -101,6 +103,7 @@ typedef enum {
         DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_RPMDB      = (1 << 1),
         DNF_CONTEXT_SETUP_SACK_FLAG_SKIP_FILELISTS  = (1 << 2),
         DNF_CONTEXT_SETUP_SACK_FLAG_LOAD_UPDATEINFO = (1 << 3),
+        DNF_CONTEXT_SETUP_SACK_FLAG_PARALLEL_LOAD   = (1 << 4),
 } DnfContextSetupSackFlags;
 
 gboolean         dnf_context_globals_init               (GError **error);
@@ -113,6 +116,7 @@ const gchar     *find_base_arch                         (const char *native);
 /* getters */
 const gchar     *dnf_context_get_config_file_path       (void);
 gboolean         dnf_context_is_set_config_file_path    (void);
+gboolean         dnf_context_get_log_async              (void);
 const gchar * const *dnf_context_get_repos_dir          (DnfContext     *context);
 const gchar     *dnf_context_get_repo_dir               (DnfContext     *context);
 const gchar * const *dnf_context_get_vars_dir           (DnfContext     *context);
@@ -141,9 +145,11 @@ gboolean         dnf_context_get_only_trusted           (DnfContext     *context
 gboolean         dnf_context_get_zchunk                 (DnfContext     *context);
 gboolean         dnf_context_get_write_history          (DnfContext     *context);
 guint            dnf_context_get_cache_age              (DnfContext     *context);
+guint            dnf_context_get_repomd_stat_max_age    (DnfContext     *context);
 guint            dnf_context_get_installonly_limit      (DnfContext     *context);
 const gchar     *dnf_context_get_http_proxy             (DnfContext     *context);
 gboolean         dnf_context_get_enable_filelists       (DnfContext     *context);
+gboolean         dnf_context_get_lazy_repo_setup        (DnfContext     *context);
 GPtrArray       *dnf_context_get_repos                  (DnfContext     *context);
 #ifndef __GI_SCANNER__
 DnfRepoLoader   *dnf_context_get_repo_loader            (DnfContext     *context);
@@ -156,6 +162,7 @@ const char *     dnf_context_get_user_agent             (DnfContext     *context
 
 /* setters */
 void             dnf_context_set_config_file_path       (const gchar    *config_file_path);
+void             dnf_context_set_log_async              (gboolean        log_async);
 void             dnf_context_set_repos_dir              (DnfContext     *context,
                                                          const gchar * const *repos_dir);
 void             dnf_context_set_repo_dir               (DnfContext     *context,
@@ -176,6 +183,8 @@ void             dnf_context_set_vendor_cache_dir       (DnfContext     *context
                                                          const gchar    *vendor_cache_dir);
 void             dnf_context_set_vendor_solv_dir        (DnfContext     *context,
                                                          const gchar    *vendor_solv_dir);
+void             dnf_context_set_vendor_cache_hardlink  (DnfContext     *context,
+                                                         gboolean        vendor_cache_hardlink);
 void             dnf_context_set_lock_dir               (DnfContext     *context,
                                                          const gchar    *lock_dir);
 void             dnf_context_set_rpm_verbosity          (DnfContext     *context,
@@ -197,6 +206,8 @@ void             dnf_context_set_keep_cache             (DnfContext     *context
                                                          gboolean        keep_cache);
 void             dnf_context_set_enable_filelists       (DnfContext     *context,
                                                          gboolean        enable_filelists);
+void             dnf_context_set_lazy_repo_setup        (DnfContext     *context,
+                                                         gboolean        lazy_repo_setup);
 void             dnf_context_set_only_trusted           (DnfContext     *context,
                                                          gboolean        only_trusted);
 void             dnf_context_set_zchunk                 (DnfContext     *context,
@@ -205,6 +216,8 @@ void             dnf_context_set_write_history          (DnfContext     *context
                                                          gboolean        value);
 void             dnf_context_set_cache_age              (DnfContext     *context,
                                                          guint           cache_age);
+void             dnf_context_set_repomd_stat_max_age    (DnfContext     *context,
+                                                         guint           max_age);
 
 void             dnf_context_set_rpm_macro              (DnfContext     *context,
                                                          const gchar    *key,
@@ -227,6 +240,17 @@ gboolean         dnf_context_setup_sack_with_flags      (DnfContext      *contex
                                                          DnfState        *state,
                                                          DnfContextSetupSackFlags flags,
                                                          GError          **error);
+gboolean         dnf_context_refresh_sack               (DnfContext      *context,
+                                                         DnfState        *state,
+                                                         DnfContextSetupSackFlags flags,
+                                                         GError          **error);
+gboolean         dnf_context_prewarm                    (DnfContext      *context,
+                                                         DnfState        *state,
+                                                         DnfContextSetupSackFlags flags,
+                                                         GError          **error);
+gboolean         dnf_context_prefetch_upgrades          (DnfContext     *context,
+                                                         DnfState       *state,
+                                                         GError         **error);
 gboolean         dnf_context_commit                     (DnfContext     *context,
                                                          DnfState       *state,
                                                          GError         **error);
@@ -20,6 +20,9 @@
 
 #include <glib.h>
 
+#include <string>
+#include <vector>
+
 #include "dnf-db.h"
 #include "dnf-package.h"
 #include "transaction/Swdb.hpp"
@@ -63,10 +66,27 @@ dnf_db_ensure_origin_pkg(DnfDb *db, DnfPackage *pkg)
 void
 dnf_db_ensure_origin_pkglist(DnfDb *db, GPtrArray *pkglist)
 {
-    DnfPackage * pkg;
-    guint i;
-    for (i = 0; i < pkglist->len; i++) {
-        pkg = static_cast<DnfPackage *>(g_ptr_array_index(pkglist, i));
-        dnf_db_ensure_origin_pkg(db, pkg);
+    std::vector<DnfPackage *> packages;
+    std::vector<std::string> nevras;
+
+    for (guint i = 0; i < pkglist->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(pkglist, i));
+        if (dnf_package_get_origin(pkg) != NULL || !dnf_package_installed(pkg))
+            continue;
+        packages.push_back(pkg);
+        nevras.push_back(dnf_package_get_nevra(pkg));
+    }
+    if (packages.empty())
+        return;
+
+    /* resolve all the packages with one query */
+    auto repos = db->getRPMRepos(nevras);
+    for (size_t i = 0; i < packages.size(); i++) {
+        auto it = repos.find(nevras[i]);
+        if (it == repos.end()) {
+            g_debug("no origin for %s", dnf_package_get_package_id(packages[i]));
+        } else {
+            dnf_package_set_origin(packages[i], it->second.c_str());
+        }
     }
 }
@@ -68,6 +68,20 @@ static void set_excludes_from_weak_to_goal(HyGoal goal)
     }
 }
 
+/* enables the modules the packages to install need */
+static void
+enable_required_modules(HyGoal goal)
+{
+    auto moduleContainer = dnf_sack_get_module_container(hy_goal_get_sack(goal));
+    if (moduleContainer) {
+        auto installSet = goal->listInstalls();
+        auto modulesToEnable = requiresModuleEnablement(hy_goal_get_sack(goal), &installSet);
+        for (auto module: modulesToEnable) {
+            moduleContainer->enable(module->getName(), module->getStream());
+        }
+    }
+}
+
 /**
  * dnf_goal_depsolve:
  * @goal: a #HyGoal.
@@ -88,17 +102,8 @@ dnf_goal_depsolve(HyGoal goal, DnfGoalActions flags, GError **error) try
 
     DnfSack * sack = hy_goal_get_sack(goal);
 
-    libdnf::Query query(sack);
     const auto & protected_packages = libdnf::getGlobalMainConfig().protected_packages().getValue();
-    std::vector<const char *> cprotected_packages;
-    cprotected_packages.reserve(protected_packages.size() + 1);
-    for (const auto & package : protected_packages) {
-        cprotected_packages.push_back(package.c_str());
-    }
-    cprotected_packages.push_back(nullptr);
-    query.addFilter(HY_PKG_NAME, HY_EQ, cprotected_packages.data());
-    auto pkgset = *query.runSet();
-    goal->addProtected(pkgset);
+    goal->addProtected(*dnf_sack_get_protected_pkgs(sack, protected_packages));
 
     set_excludes_from_weak_to_goal(goal);
 
@@ -140,14 +145,56 @@ dnf_goal_depsolve(HyGoal goal, DnfGoalActions flags, GError **error) try
                             "The transaction was empty");
         return FALSE;
     }
-    auto moduleContainer = dnf_sack_get_module_container(sack);
-    if (moduleContainer) {
-        auto installSet = goal->listInstalls();
-        auto modulesToEnable = requiresModuleEnablement(sack, &installSet);
-        for (auto module: modulesToEnable) {
-            moduleContainer->enable(module->getName(), module->getStream());
-        }
+    enable_required_modules(goal);
+    return TRUE;
+} CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_goal_depsolve_with_plan:
+ * @goal: a #HyGoal.
+ * @flags: some #DnfGoalActions to enable.
+ * @plan_path: a plan file written by dnf_goal_write_plan()
+ * @error: a #GError or %NULL
+ *
+ * Takes the result of the goal from the plan file when the repos and the
+ * rpmdb loaded into the sack are those the plan was made for, otherwise, or
+ * when the file does not exist, solves the goal with dnf_goal_depsolve().
+ * Hosts in the same state running the same request can so share one solve.
+ * Set dnf_transaction_set_dont_solve_goal() before committing the goal.
+ *
+ * Returns: %TRUE if depsolve is successful.
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_goal_depsolve_with_plan(HyGoal goal, DnfGoalActions flags, const gchar *plan_path,
+                            GError **error) try
+{
+    if (g_file_test(plan_path, G_FILE_TEST_EXISTS) && goal->loadPlan(plan_path)) {
+        g_debug("using the goal plan %s", plan_path);
+        enable_required_modules(goal);
+        return TRUE;
     }
+    return dnf_goal_depsolve(goal, flags, error);
+} CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_goal_write_plan:
+ * @goal: a solved #HyGoal.
+ * @plan_path: the file to write
+ * @error: a #GError or %NULL
+ *
+ * Writes the result of the goal with the state of its sack it depends on,
+ * see dnf_goal_depsolve_with_plan().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_goal_write_plan(HyGoal goal, const gchar *plan_path, GError **error) try
+{
+    goal->writePlan(plan_path);
     return TRUE;
 } CATCH_TO_GERROR(FALSE)
 
@@ -230,6 +277,45 @@ dnf_goal_get_packages(HyGoal goal, ...)
     return array;
 }
 
+/**
+ * dnf_goal_get_packageset:
+ * @goal: a #HyGoal.
+ * @info: a #DnfPackageInfo, e.g. %DNF_PACKAGE_INFO_INSTALL
+ * @error: a #GError or %NULL
+ *
+ * Gets the packages of the solved @goal with the @info action, without
+ * creating a #DnfPackage for each of them like dnf_goal_get_packages() does.
+ * Iterate the set with dnf_packageset_iter_init().
+ *
+ * Returns: (transfer full): a #DnfPackageSet, or %NULL for an error
+ *
+ * Since: 0.70.0
+ */
+DnfPackageSet *
+dnf_goal_get_packageset(HyGoal goal, DnfPackageInfo info, GError **error) try
+{
+    switch(info) {
+    case DNF_PACKAGE_INFO_REMOVE:
+        return new libdnf::PackageSet(goal->listErasures());
+    case DNF_PACKAGE_INFO_INSTALL:
+        return new libdnf::PackageSet(goal->listInstalls());
+    case DNF_PACKAGE_INFO_OBSOLETE:
+        return new libdnf::PackageSet(goal->listObsoleted());
+    case DNF_PACKAGE_INFO_REINSTALL:
+        return new libdnf::PackageSet(goal->listReinstalls());
+    case DNF_PACKAGE_INFO_UPDATE:
+        return new libdnf::PackageSet(goal->listUpgrades());
+    case DNF_PACKAGE_INFO_DOWNGRADE:
+        return new libdnf::PackageSet(goal->listDowngrades());
+    default:
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_INTERNAL_ERROR,
+                    "no goal packages for info %i", info);
+        return NULL;
+    }
+} CATCH_TO_GERROR(NULL)
+
 /**
  * dnf_goal_add_protected:
  * @goal: a #HyGoal.
@@ -26,14 +26,25 @@
 
 #include "hy-goal.h"
 #include "hy-package.h"
+#include "dnf-package.h"
 
 G_BEGIN_DECLS
 
 gboolean         dnf_goal_depsolve                      (HyGoal          goal,
                                                          DnfGoalActions  flags,
                                                          GError          **error);
+gboolean         dnf_goal_depsolve_with_plan            (HyGoal          goal,
+                                                         DnfGoalActions  flags,
+                                                         const gchar     *plan_path,
+                                                         GError          **error);
+gboolean         dnf_goal_write_plan                    (HyGoal          goal,
+                                                         const gchar     *plan_path,
+                                                         GError          **error);
 GPtrArray       *dnf_goal_get_packages                  (HyGoal          goal,
                                                          ...);
+DnfPackageSet   *dnf_goal_get_packageset                (HyGoal          goal,
+                                                         DnfPackageInfo  info,
+                                                         GError          **error);
 void             dnf_goal_add_protected                 (HyGoal goal,
                                                          DnfPackageSet  *pset);
 void             dnf_goal_set_protected                 (HyGoal goal,
@@ -31,60 +31,44 @@
 
 
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <glib.h>
 #include <rpm/rpmlib.h>
 #include <rpm/rpmts.h>
 #include <rpm/rpmlog.h>
 #include <rpm/rpmcli.h>
 
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
 #include "catch-error.hpp"
 #include "dnf-types.h"
 #include "dnf-keyring.h"
 #include "dnf-utils.h"
 
 /**
- * dnf_keyring_add_public_key:
- * @keyring: a #rpmKeyring instance.
- * @filename: The public key filename.
- * @error: a #GError or %NULL.
- *
- * Adds a specific public key to the keyring.
+ * dnf_keyring_read_public_key:
  *
- * Returns: %TRUE for success, %FALSE otherwise
- *
- * Since: 0.1.0
+ * Reads, dearmors and parses the public key file.
  **/
-gboolean
-dnf_keyring_add_public_key(rpmKeyring keyring,
-                           const gchar *filename,
-                           GError **error) try
+static rpmPubkey
+dnf_keyring_read_public_key(const gchar *filename, GError **error)
 {
-    gboolean ret = TRUE;
-    int rc;
     gsize len;
     pgpArmor armor;
-    pgpDig dig = NULL;
     rpmPubkey pubkey = NULL;
-    rpmPubkey *subkeys = NULL;
-    int nsubkeys = 0;
     uint8_t *pkt = NULL;
     g_autofree gchar *data = NULL;
 
-    /* ignore symlinks and directories */
-    if (!g_file_test(filename, G_FILE_TEST_IS_REGULAR))
-        goto out;
-    if (g_file_test(filename, G_FILE_TEST_IS_SYMLINK))
-        goto out;
-
     /* get data */
-    ret = g_file_get_contents(filename, &data, &len, error);
-    if (!ret)
-        goto out;
+    if (!g_file_get_contents(filename, &data, &len, error))
+        return NULL;
 
     /* rip off the ASCII armor and parse it */
     armor = pgpParsePkts(data, &pkt, &len);
     if (armor < 0) {
-        ret = FALSE;
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_GPG_SIGNATURE_INVALID,
@@ -95,7 +79,6 @@ dnf_keyring_add_public_key(rpmKeyring keyring,
 
     /* make sure it's something we can add to rpm */
     if (armor != PGPARMOR_PUBKEY) {
-        ret = FALSE;
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_GPG_SIGNATURE_INVALID,
@@ -107,7 +90,6 @@ dnf_keyring_add_public_key(rpmKeyring keyring,
     /* test each one */
     pubkey = rpmPubkeyNew(pkt, len);
     if (pubkey == NULL) {
-        ret = FALSE;
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_GPG_SIGNATURE_INVALID,
@@ -115,6 +97,28 @@ dnf_keyring_add_public_key(rpmKeyring keyring,
                     filename);
         goto out;
     }
+out:
+    if (pkt != NULL)
+        free(pkt); /* yes, free() */
+    return pubkey;
+}
+
+/**
+ * dnf_keyring_add_pubkey:
+ *
+ * Adds the parsed public key of @filename and its subkeys to the keyring.
+ **/
+static gboolean
+dnf_keyring_add_pubkey(rpmKeyring keyring,
+                       rpmPubkey pubkey,
+                       rpmPubkey *subkeys,
+                       int nsubkeys,
+                       const gchar *filename,
+                       GError **error)
+{
+    gboolean ret = TRUE;
+    int rc;
+    pgpDig dig = NULL;
 
     /* does the key exist in the keyring */
     dig = rpmPubkeyDig(pubkey);
@@ -141,7 +145,6 @@ dnf_keyring_add_public_key(rpmKeyring keyring,
         goto out;
     }
 
-    subkeys = rpmGetSubkeys(pubkey, &nsubkeys);
     for (int i = 0; i < nsubkeys; i++) {
         rpmPubkey subkey = subkeys[i];
         if (rpmKeyringAddKey(keyring, subkey) < 0) {
@@ -159,21 +162,131 @@ dnf_keyring_add_public_key(rpmKeyring keyring,
     g_debug("added missing public key %s to rpmdb", filename);
     ret = TRUE;
 out:
-    if (pkt != NULL)
-        free(pkt); /* yes, free() */
-    if (pubkey != NULL)
-        rpmPubkeyFree(pubkey);
+    if (dig != NULL)
+        pgpFreeDig(dig);
+    return ret;
+}
+
+/**
+ * dnf_keyring_add_public_key:
+ * @keyring: a #rpmKeyring instance.
+ * @filename: The public key filename.
+ * @error: a #GError or %NULL.
+ *
+ * Adds a specific public key to the keyring.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.1.0
+ **/
+gboolean
+dnf_keyring_add_public_key(rpmKeyring keyring,
+                           const gchar *filename,
+                           GError **error) try
+{
+    gboolean ret;
+    rpmPubkey pubkey = NULL;
+    rpmPubkey *subkeys = NULL;
+    int nsubkeys = 0;
+
+    /* ignore symlinks and directories */
+    if (!g_file_test(filename, G_FILE_TEST_IS_REGULAR))
+        return TRUE;
+    if (g_file_test(filename, G_FILE_TEST_IS_SYMLINK))
+        return TRUE;
+
+    pubkey = dnf_keyring_read_public_key(filename, error);
+    if (pubkey == NULL)
+        return FALSE;
+    subkeys = rpmGetSubkeys(pubkey, &nsubkeys);
+    ret = dnf_keyring_add_pubkey(keyring, pubkey, subkeys, nsubkeys, filename, error);
+
+    rpmPubkeyFree(pubkey);
     if (subkeys != NULL) {
         for (int i = 0; i < nsubkeys; i++) {
           rpmPubkeyFree(subkeys[i]);
         }
         free(subkeys);
     }
-    if (dig != NULL)
-        pgpFreeDig(dig);
     return ret;
 } CATCH_TO_GERROR(FALSE)
 
+/* the parsed keys of the installed public key files, valid while the file
+ * stays the same, long running processes like PackageKit add them again for
+ * every transaction */
+struct CachedPublicKey {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    rpmPubkey pubkey;
+    rpmPubkey *subkeys;
+    int nsubkeys;
+};
+static std::mutex public_keys_mutex;
+static std::map<std::string, CachedPublicKey> public_keys;
+
+static bool
+cached_public_key_matches(const CachedPublicKey & key, const struct stat & st)
+{
+    return key.dev == st.st_dev && key.ino == st.st_ino && key.size == st.st_size &&
+           key.mtime.tv_sec == st.st_mtim.tv_sec && key.mtime.tv_nsec == st.st_mtim.tv_nsec;
+}
+
+static void
+cached_public_key_clear(CachedPublicKey & key)
+{
+    rpmPubkeyFree(key.pubkey);
+    if (key.subkeys != NULL) {
+        for (int i = 0; i < key.nsubkeys; i++)
+            rpmPubkeyFree(key.subkeys[i]);
+        free(key.subkeys);
+    }
+}
+
+/**
+ * dnf_keyring_add_cached_public_key:
+ *
+ * Adds the key of the file like dnf_keyring_add_public_key(), parsing the file
+ * only when it changed since the last call. Must be called with
+ * public_keys_mutex held.
+ **/
+static gboolean
+dnf_keyring_add_cached_public_key(rpmKeyring keyring, const gchar *filename, GError **error)
+{
+    struct stat st;
+
+    /* ignore symlinks and directories */
+    if (lstat(filename, &st) != 0 || !S_ISREG(st.st_mode))
+        return TRUE;
+
+    auto it = public_keys.find(filename);
+    if (it != public_keys.end() && !cached_public_key_matches(it->second, st)) {
+        cached_public_key_clear(it->second);
+        public_keys.erase(it);
+        it = public_keys.end();
+    }
+    if (it == public_keys.end()) {
+        CachedPublicKey key;
+        key.dev = st.st_dev;
+        key.ino = st.st_ino;
+        key.size = st.st_size;
+        key.mtime = st.st_mtim;
+        key.pubkey = dnf_keyring_read_public_key(filename, error);
+        if (key.pubkey == NULL)
+            return FALSE;
+        key.nsubkeys = 0;
+        key.subkeys = rpmGetSubkeys(key.pubkey, &key.nsubkeys);
+        it = public_keys.emplace(filename, key).first;
+    }
+    return dnf_keyring_add_pubkey(keyring,
+                                  it->second.pubkey,
+                                  it->second.subkeys,
+                                  it->second.nsubkeys,
+                                  filename,
+                                  error);
+}
+
 /**
  * dnf_keyring_add_public_keys:
  * @keyring: a #rpmKeyring instance.
@@ -181,6 +294,9 @@ out:
  *
  * Adds all installed public keys to the RPM and shared keyring.
  *
+ * The parsed keys are kept for the process, later calls only parse the key
+ * files which changed.
+ *
  * Returns: %TRUE for success, %FALSE otherwise
  *
  * Since: 0.1.0
@@ -192,6 +308,7 @@ dnf_keyring_add_public_keys(rpmKeyring keyring, GError **error) try
     gboolean ret = TRUE;
     g_autoptr(GDir) dir = NULL;
     GError *localError = NULL;
+    std::set<std::string> seen;
 
     /* search all the public key files */
     dir = g_dir_open(gpg_dir, 0, &localError);
@@ -202,6 +319,7 @@ dnf_keyring_add_public_keys(rpmKeyring keyring, GError **error) try
         g_error_free(localError);
         return TRUE;
     }
+    std::lock_guard<std::mutex> guard(public_keys_mutex);
     do {
         const gchar *filename;
         g_autofree gchar *path_tmp = NULL;
@@ -209,20 +327,42 @@ dnf_keyring_add_public_keys(rpmKeyring keyring, GError **error) try
         if (filename == NULL)
             break;
         path_tmp = g_build_filename(gpg_dir, filename, NULL);
-        ret = dnf_keyring_add_public_key(keyring, path_tmp, &localError);
+        seen.insert(path_tmp);
+        ret = dnf_keyring_add_cached_public_key(keyring, path_tmp, &localError);
         if (!ret) {
             g_warning("%s", localError->message);
             g_error_free(localError);
             localError = NULL;
         }
     } while (true);
+
+    /* forget the removed files */
+    for (auto it = public_keys.begin(); it != public_keys.end();) {
+        if (seen.count(it->first) == 0) {
+            cached_public_key_clear(it->second);
+            it = public_keys.erase(it);
+        } else {
+            ++it;
+        }
+    }
     return TRUE;
 } CATCH_TO_GERROR(FALSE)
 
+/* the rpm log callback is global, files may be checked in several threads
+ * at once, so every thread collects the messages of its own check */
+static std::mutex verify_log_mutex;
+static guint verify_log_users = 0;
+static thread_local GString *verify_log = NULL;
+static thread_local gboolean verify_log_active = FALSE;
+
 static int
 rpmcliverifysignatures_log_handler_cb(rpmlogRec rec, rpmlogCallbackData data)
 {
-    GString **string =(GString **) data;
+    GString **string = &verify_log;
+
+    /* a message from a thread not checking a file */
+    if (!verify_log_active)
+        return RPMLOG_DEFAULT;
 
     /* create string if required */
     if (*string == NULL)
@@ -259,6 +399,13 @@ dnf_keyring_check_untrusted_file(rpmKeyring keyring,
     char *path_array[2] = {path, NULL};
     g_autoptr(GString) rpm_error = NULL;
 
+    verify_log_active = TRUE;
+    {
+        std::lock_guard<std::mutex> guard(verify_log_mutex);
+        if (verify_log_users++ == 0)
+            rpmlogSetCallback(rpmcliverifysignatures_log_handler_cb, NULL);
+    }
+
     /* open the file for reading */
     fd = Fopen(filename, "r.fdio");
     if (fd == NULL) {
@@ -286,12 +433,12 @@ dnf_keyring_check_untrusted_file(rpmKeyring keyring,
         goto out;
     }
     rpmtsSetVfyLevel(ts, RPMSIG_SIGNATURE_TYPE);
-    rpmlogSetCallback(rpmcliverifysignatures_log_handler_cb, &rpm_error);
-
     // rpm doesn't provide any better API call than rpmcliVerifySignatures (which is for CLI):
     // - use path_array as input argument
     // - gather logs via callback because we don't want to print anything if check is successful
     if (rpmcliVerifySignatures(ts, (char * const*) path_array)) {
+        rpm_error = verify_log;
+        verify_log = NULL;
         g_set_error(error,
                 DNF_ERROR,
                 DNF_ERROR_GPG_SIGNATURE_INVALID,
@@ -363,7 +510,16 @@ dnf_keyring_check_untrusted_file(rpmKeyring keyring,
     g_debug("%s has been verified as trusted", filename);
     ret = TRUE;
 out:
-    rpmlogSetCallback(NULL, NULL);
+    {
+        std::lock_guard<std::mutex> guard(verify_log_mutex);
+        if (--verify_log_users == 0)
+            rpmlogSetCallback(NULL, NULL);
+    }
+    verify_log_active = FALSE;
+    if (verify_log != NULL) {
+        g_string_free(verify_log, TRUE);
+        verify_log = NULL;
+    }
 
     if (path != NULL)
         g_free(path);
@@ -29,10 +29,20 @@
  *
  * This object either works per-thread or per-system with a configured lock file.
  *
+ * Locks are exclusive unless taken with %DNF_LOCK_ACCESS_SHARED by
+ * dnf_lock_take_full(), which can also lock a named part of the type, e.g.
+ * the metadata of one repo. The shared and the named locks of processes are
+ * open file description locks, see fcntl(2).
+ *
  * See also: #DnfState
  */
 
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <gio/gio.h>
 
 #include "catch-error.hpp"
@@ -53,6 +63,10 @@ typedef struct {
     guint               refcount;
     DnfLockMode         mode;
     DnfLockType         type;
+    DnfLockAccess       access;
+    gchar              *name;       /* the locked part of the type, or NULL */
+    gint                fd;         /* holds the open file description lock, or -1 */
+    guint               parent_id;  /* the shared lock of the whole type kept by a named lock */
 } DnfLockItem;
 
 G_DEFINE_TYPE_WITH_PRIVATE(DnfLock, dnf_lock, G_TYPE_OBJECT)
@@ -67,6 +81,21 @@ static guint signals [SIGNAL_LAST] = { 0 };
 
 static gpointer dnf_lock_object = NULL;
 
+static gchar *dnf_lock_get_filename_for_type(DnfLock *lock, DnfLockType type);
+
+/**
+ * dnf_lock_item_free:
+ **/
+static void
+dnf_lock_item_free(gpointer data)
+{
+    auto item = static_cast<DnfLockItem *>(data);
+    if (item->fd >= 0)
+        close(item->fd);
+    g_free(item->name);
+    g_free(item);
+}
+
 /**
  * dnf_lock_finalize:
  **/
@@ -77,13 +106,16 @@ dnf_lock_finalize(GObject *object)
     DnfLockPrivate *priv = GET_PRIVATE(lock);
     guint i;
 
-    /* unlock if we hold the lock */
+    /* unlock if we hold the lock, freeing the items closes the lock files */
     for (i = 0; i < priv->item_array->len; i++) {
         auto item = static_cast<DnfLockItem *>(g_ptr_array_index(priv->item_array, i));
-        if (item->refcount > 0) {
-            g_warning("held lock %s at shutdown",
-                      dnf_lock_type_to_string(item->type));
-            dnf_lock_release(lock, item->id, NULL);
+        g_warning("held lock %s at shutdown",
+                  dnf_lock_type_to_string(item->type));
+        if (item->mode == DNF_LOCK_MODE_PROCESS &&
+            item->access == DNF_LOCK_ACCESS_EXCLUSIVE &&
+            item->name == NULL) {
+            g_autofree gchar *filename = dnf_lock_get_filename_for_type(lock, item->type);
+            unlink(filename);
         }
     }
     g_ptr_array_unref(priv->item_array);
@@ -99,7 +131,7 @@ static void
 dnf_lock_init(DnfLock *lock)
 {
     DnfLockPrivate *priv = GET_PRIVATE(lock);
-    priv->item_array = g_ptr_array_new_with_free_func(g_free);
+    priv->item_array = g_ptr_array_new_with_free_func(dnf_lock_item_free);
     priv->lock_dir = g_strdup("/var/run");
 }
 
@@ -162,7 +194,9 @@ dnf_lock_mode_to_string(DnfLockMode lock_mode)
 static DnfLockItem *
 dnf_lock_get_item_by_type_mode(DnfLock *lock,
                 DnfLockType type,
-                DnfLockMode mode)
+                DnfLockMode mode,
+                DnfLockAccess access,
+                const gchar *name)
 {
     DnfLockPrivate *priv = GET_PRIVATE(lock);
     guint i;
@@ -170,7 +204,35 @@ dnf_lock_get_item_by_type_mode(DnfLock *lock,
     /* search for the item that matches type */
     for (i = 0; i < priv->item_array->len; i++) {
         auto item = static_cast<DnfLockItem *>(g_ptr_array_index(priv->item_array, i));
-        if (item->type == type && item->mode == mode)
+        if (item->type == type && item->mode == mode &&
+            item->access == access && g_strcmp0(item->name, name) == 0)
+            return item;
+    }
+    return NULL;
+}
+
+/**
+ * dnf_lock_get_conflicting_item:
+ *
+ * Finds a lock of the same type and name held in this process which can not
+ * be held together with the requested one.
+ **/
+static DnfLockItem *
+dnf_lock_get_conflicting_item(DnfLock *lock,
+                              DnfLockType type,
+                              DnfLockAccess access,
+                              const gchar *name)
+{
+    DnfLockPrivate *priv = GET_PRIVATE(lock);
+    guint i;
+
+    for (i = 0; i < priv->item_array->len; i++) {
+        auto item = static_cast<DnfLockItem *>(g_ptr_array_index(priv->item_array, i));
+        if (item->type != type || g_strcmp0(item->name, name) != 0)
+            continue;
+        if (item->access == DNF_LOCK_ACCESS_EXCLUSIVE && item->owner != g_thread_self())
+            return item;
+        if (access == DNF_LOCK_ACCESS_EXCLUSIVE && item->access == DNF_LOCK_ACCESS_SHARED)
             return item;
     }
     return NULL;
@@ -198,7 +260,8 @@ dnf_lock_get_item_by_id(DnfLock *lock, guint id)
  * dnf_lock_create_item:
  **/
 static DnfLockItem *
-dnf_lock_create_item(DnfLock *lock, DnfLockType type, DnfLockMode mode)
+dnf_lock_create_item(DnfLock *lock, DnfLockType type, DnfLockMode mode,
+                     DnfLockAccess access, const gchar *name, gint fd)
 {
     DnfLockItem *item;
     DnfLockPrivate *priv = GET_PRIVATE(lock);
@@ -210,6 +273,9 @@ dnf_lock_create_item(DnfLock *lock, DnfLockType type, DnfLockMode mode)
     item->owner = g_thread_self();
     item->refcount = 1;
     item->mode = mode;
+    item->access = access;
+    item->name = g_strdup(name);
+    item->fd = fd;
     g_ptr_array_add(priv->item_array, item);
     return item;
 }
@@ -280,6 +346,85 @@ dnf_lock_get_filename_for_type(DnfLock *lock, DnfLockType type)
                            dnf_lock_type_to_string(type));
 }
 
+/**
+ * dnf_lock_get_ofd_filename:
+ *
+ * The file of the open file description locks, it is never removed as
+ * removing it would race with other processes locking it.
+ **/
+static gchar *
+dnf_lock_get_ofd_filename(DnfLock *lock, DnfLockType type, const gchar *name)
+{
+    DnfLockPrivate *priv = GET_PRIVATE(lock);
+    if (name != NULL)
+        return g_strdup_printf("%s/dnf-%s-%s.rwlock",
+                               priv->lock_dir,
+                               dnf_lock_type_to_string(type),
+                               name);
+    return g_strdup_printf("%s/dnf-%s.rwlock",
+                           priv->lock_dir,
+                           dnf_lock_type_to_string(type));
+}
+
+/**
+ * dnf_lock_take_ofd:
+ *
+ * Returns: the file descriptor holding the lock, -1 if there is nothing to
+ * lock, or -2 for an error.
+ **/
+static gint
+dnf_lock_take_ofd(DnfLock *lock,
+                  DnfLockType type,
+                  DnfLockAccess access,
+                  const gchar *name,
+                  GError **error)
+{
+    g_autofree gchar *filename = dnf_lock_get_ofd_filename(lock, type, name);
+    struct flock fl;
+    gint fd;
+
+    fd = open(filename, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 && access == DNF_LOCK_ACCESS_SHARED && errno == EACCES)
+        fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        /* readers without the permission to create the file, no
+         * exclusive lock was ever taken as that creates the file */
+        if (access == DNF_LOCK_ACCESS_SHARED && (errno == EACCES || errno == ENOENT))
+            return -1;
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_CANNOT_GET_LOCK,
+                    "failed to open lock file %s: %s",
+                    filename, strerror(errno));
+        return -2;
+    }
+
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = access == DNF_LOCK_ACCESS_SHARED ? F_RDLCK : F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    if (fcntl(fd, F_OFD_SETLK, &fl) < 0) {
+        gint errsv = errno;
+        close(fd);
+        if (errsv == EAGAIN || errsv == EACCES) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_CANNOT_GET_LOCK,
+                        "%s%s%s already locked by another process",
+                        dnf_lock_type_to_string(type),
+                        name != NULL ? ":" : "",
+                        name != NULL ? name : "");
+        } else {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_CANNOT_GET_LOCK,
+                        "failed to lock %s: %s",
+                        filename, strerror(errsv));
+        }
+        return -2;
+    }
+    return fd;
+}
+
 /**
  * dnf_lock_get_cmdline_for_pid:
  **/
@@ -355,6 +500,45 @@ dnf_lock_emit_state(DnfLock *lock)
     g_signal_emit(lock, signals [SIGNAL_STATE_CHANGED], 0, bitfield);
 }
 
+/**
+ * dnf_lock_check_pid_file:
+ *
+ * Fails if the lock file of the exclusive process lock names a running process.
+ **/
+static gboolean
+dnf_lock_check_pid_file(DnfLock *lock, DnfLockType type, DnfLockMode mode, GError **error)
+{
+    guint pid;
+    g_autofree gchar *cmdline = NULL;
+    g_autofree gchar *filename = NULL;
+    g_autofree gchar *pid_filename = NULL;
+
+    /* does lock file already exists? */
+    filename = dnf_lock_get_filename_for_type(lock, type);
+    if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+        return TRUE;
+
+    /* check the pid is still valid */
+    pid = dnf_lock_get_pid(lock, filename, error);
+    if (pid == 0)
+        return FALSE;
+
+    /* pid is not still running? */
+    pid_filename = g_strdup_printf("/proc/%i/cmdline", pid);
+    if (g_file_test(pid_filename, G_FILE_TEST_EXISTS)) {
+        cmdline = dnf_lock_get_cmdline_for_pid(pid);
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_CANNOT_GET_LOCK,
+                    "%s[%s] already locked by %s",
+                    dnf_lock_type_to_string(type),
+                    dnf_lock_mode_to_string(mode),
+                    cmdline);
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /**
  * dnf_lock_take:
  * @lock: a #DnfLock instance.
@@ -372,106 +556,194 @@ guint
 dnf_lock_take(DnfLock *lock,
               DnfLockType type,
               DnfLockMode mode,
-              GError **error) try
+              GError **error)
+{
+    return dnf_lock_take_full(lock, type, mode, DNF_LOCK_ACCESS_EXCLUSIVE, NULL, error);
+}
+
+/**
+ * dnf_lock_take_item:
+ *
+ * Takes the lock with the mutex of @lock held.
+ **/
+static guint
+dnf_lock_take_item(DnfLock *lock,
+                   DnfLockType type,
+                   DnfLockMode mode,
+                   DnfLockAccess access,
+                   const gchar *name,
+                   GError **error)
 {
     DnfLockItem *item;
-    DnfLockPrivate *priv = GET_PRIVATE(lock);
-    gboolean ret;
-    guint id = 0;
-    guint pid;
+    gint fd = -1;
     g_autoptr(GError) error_local = NULL;
-    g_autofree gchar *cmdline = NULL;
     g_autofree gchar *filename = NULL;
-    g_autofree gchar *pid_filename = NULL;
     g_autofree gchar *pid_text = NULL;
 
-    g_return_val_if_fail(DNF_IS_LOCK(lock), FALSE);
-    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
-    /* lock other threads */
-    g_mutex_lock(&priv->mutex);
-
     /* find the lock type, and ensure we find a process lock for
      * a thread lock */
-    item = dnf_lock_get_item_by_type_mode(lock, type, mode);
+    item = dnf_lock_get_item_by_type_mode(lock, type, mode, access, name);
     if (item == NULL && mode == DNF_LOCK_MODE_THREAD) {
         item = dnf_lock_get_item_by_type_mode(lock,
                                               type,
-                                              DNF_LOCK_MODE_PROCESS);
+                                              DNF_LOCK_MODE_PROCESS,
+                                              access,
+                                              name);
     }
 
-    /* create a lock file for process locks */
-    if (item == NULL && mode == DNF_LOCK_MODE_PROCESS) {
-
-        /* does lock file already exists? */
-        filename = dnf_lock_get_filename_for_type(lock, type);
-        if (g_file_test(filename, G_FILE_TEST_EXISTS)) {
-
-            /* check the pid is still valid */
-            pid = dnf_lock_get_pid(lock, filename, error);
-            if (pid == 0)
-                goto out;
+    /* shared locks are shared by all the threads */
+    if (item != NULL && access == DNF_LOCK_ACCESS_SHARED) {
+        item->refcount++;
+        dnf_lock_emit_state(lock);
+        return item->id;
+    }
 
-            /* pid is not still running? */
-            pid_filename = g_strdup_printf("/proc/%i/cmdline", pid);
-            ret = g_file_test(pid_filename, G_FILE_TEST_EXISTS);
-            if (ret) {
-                cmdline = dnf_lock_get_cmdline_for_pid(pid);
-                g_set_error(error,
-                            DNF_ERROR,
-                            DNF_ERROR_CANNOT_GET_LOCK,
-                            "%s[%s] already locked by %s",
-                            dnf_lock_type_to_string(type),
-                            dnf_lock_mode_to_string(mode),
-                            cmdline);
-                goto out;
-            }
+    /* an exclusive lock of this thread already covers the shared one */
+    if (item == NULL && access == DNF_LOCK_ACCESS_SHARED) {
+        item = dnf_lock_get_item_by_type_mode(lock, type, mode,
+                                              DNF_LOCK_ACCESS_EXCLUSIVE, name);
+        if (item == NULL && mode == DNF_LOCK_MODE_THREAD) {
+            item = dnf_lock_get_item_by_type_mode(lock, type, DNF_LOCK_MODE_PROCESS,
+                                                  DNF_LOCK_ACCESS_EXCLUSIVE, name);
         }
-
-        /* create file with our process ID */
-        pid_text = g_strdup_printf("%i", getpid());
-        if (!g_file_set_contents(filename, pid_text, -1, &error_local)) {
-            g_set_error(error,
-                        DNF_ERROR,
-                        DNF_ERROR_CANNOT_GET_LOCK,
-                        "failed to obtain lock '%s': %s",
-                        dnf_lock_type_to_string(type),
-                        error_local->message);
-            goto out;
+        if (item != NULL && item->owner == g_thread_self()) {
+            item->refcount++;
+            dnf_lock_emit_state(lock);
+            return item->id;
         }
-    }
-
-    /* create new lock */
-    if (item == NULL) {
-        item = dnf_lock_create_item(lock, type, mode);
-        id = item->id;
-        dnf_lock_emit_state(lock);
-        goto out;
+        item = NULL;
     }
 
     /* we're trying to lock something that's already locked
      * in another thread */
-    if (item->owner != g_thread_self()) {
+    if (item != NULL && item->owner != g_thread_self()) {
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_CANNOT_GET_LOCK,
                     "failed to obtain lock '%s' already taken by thread %p",
                     dnf_lock_type_to_string(type),
                     item->owner);
-        goto out;
+        return 0;
     }
 
     /* increment ref count */
-    item->refcount++;
+    if (item != NULL) {
+        item->refcount++;
 
-    /* emit the new locking bitfield */
+        /* emit the new locking bitfield */
+        dnf_lock_emit_state(lock);
+        return item->id;
+    }
+
+    /* held incompatibly in this process */
+    item = dnf_lock_get_conflicting_item(lock, type, access, name);
+    if (item != NULL) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_CANNOT_GET_LOCK,
+                    "failed to obtain lock '%s%s%s' already %s by thread %p",
+                    dnf_lock_type_to_string(type),
+                    name != NULL ? ":" : "",
+                    name != NULL ? name : "",
+                    item->access == DNF_LOCK_ACCESS_SHARED ? "shared" : "taken",
+                    item->owner);
+        return 0;
+    }
+
+    if (mode == DNF_LOCK_MODE_PROCESS) {
+        /* the exclusive lock of the whole type is also kept in the lock
+         * file with our process ID, older versions only look there */
+        if (name == NULL && !dnf_lock_check_pid_file(lock, type, mode, error))
+            return 0;
+
+        /* exclude the shared and the named locks of other processes */
+        fd = dnf_lock_take_ofd(lock, type, access, name, error);
+        if (fd == -2)
+            return 0;
+
+        /* create file with our process ID */
+        if (name == NULL && access == DNF_LOCK_ACCESS_EXCLUSIVE) {
+            filename = dnf_lock_get_filename_for_type(lock, type);
+            pid_text = g_strdup_printf("%i", getpid());
+            if (!g_file_set_contents(filename, pid_text, -1, &error_local)) {
+                g_set_error(error,
+                            DNF_ERROR,
+                            DNF_ERROR_CANNOT_GET_LOCK,
+                            "failed to obtain lock '%s': %s",
+                            dnf_lock_type_to_string(type),
+                            error_local->message);
+                if (fd >= 0)
+                    close(fd);
+                return 0;
+            }
+        }
+    }
+
+    /* create new lock */
+    item = dnf_lock_create_item(lock, type, mode, access, name, fd);
     dnf_lock_emit_state(lock);
+    return item->id;
+}
 
-    /* success */
-    id = item->id;
-out:
+/**
+ * dnf_lock_take_full:
+ * @lock: a #DnfLock instance.
+ * @type: A #DnfLockType, e.g. %DNF_LOCK_TYPE_METADATA
+ * @mode: A #DnfLockMode, e.g. %DNF_LOCK_MODE_PROCESS
+ * @access: A #DnfLockAccess, e.g. %DNF_LOCK_ACCESS_SHARED
+ * @name: (nullable): the part of @type to lock, e.g. a repo ID, or %NULL for all of it
+ * @error: A #GError, or %NULL
+ *
+ * Tries to take a lock for the packaging system like dnf_lock_take() does.
+ * Any number of shared locks can be held by the threads and processes at the
+ * same time, an exclusive lock only alone. A lock with a @name keeps the
+ * whole @type shared, so locks of different names do not block each other,
+ * but they block the exclusive lock of the whole @type.
+ *
+ * Returns: A lock ID greater than 0, or 0 for an error.
+ *
+ * Since: 0.70.0
+ **/
+guint
+dnf_lock_take_full(DnfLock *lock,
+                   DnfLockType type,
+                   DnfLockMode mode,
+                   DnfLockAccess access,
+                   const gchar *name,
+                   GError **error) try
+{
+    DnfLockPrivate *priv = GET_PRIVATE(lock);
+    guint parent_id = 0;
+    guint id;
+
+    g_return_val_if_fail(DNF_IS_LOCK(lock), FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    if (name != NULL && (name[0] == '\0' || strchr(name, '/') != NULL)) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_INTERNAL_ERROR,
+                    "invalid lock name '%s'", name);
+        return 0;
+    }
+
+    /* a named lock keeps the whole type shared */
+    if (name != NULL) {
+        parent_id = dnf_lock_take_full(lock, type, mode, DNF_LOCK_ACCESS_SHARED, NULL, error);
+        if (parent_id == 0)
+            return 0;
+    }
+
+    /* lock other threads */
+    g_mutex_lock(&priv->mutex);
+    id = dnf_lock_take_item(lock, type, mode, access, name, error);
+    if (id != 0 && parent_id != 0)
+        dnf_lock_get_item_by_id(lock, id)->parent_id = parent_id;
     /* unlock other threads */
     g_mutex_unlock(&priv->mutex);
+
+    if (id == 0 && parent_id != 0)
+        dnf_lock_release_noerror(lock, parent_id);
     return id;
 } CATCH_TO_GERROR(0)
 
@@ -493,6 +765,7 @@ dnf_lock_release(DnfLock *lock, guint id, GError **error) try
     DnfLockItem *item;
     DnfLockPrivate *priv = GET_PRIVATE(lock);
     gboolean ret = FALSE;
+    guint parent_id = 0;
 
     g_assert(DNF_IS_LOCK(lock));
     g_assert(id != 0);
@@ -511,8 +784,8 @@ dnf_lock_release(DnfLock *lock, guint id, GError **error) try
         goto out;
     }
 
-    /* not the same thread */
-    if (item->owner != g_thread_self()) {
+    /* not the same thread, shared locks are released by any of them */
+    if (item->access == DNF_LOCK_ACCESS_EXCLUSIVE && item->owner != g_thread_self()) {
         g_set_error(error,
                     DNF_ERROR,
                     DNF_ERROR_INTERNAL_ERROR,
@@ -521,12 +794,15 @@ dnf_lock_release(DnfLock *lock, guint id, GError **error) try
         goto out;
     }
 
-    /* decrement ref count */
+    /* decrement ref count, every take of a named lock took its parent */
     item->refcount--;
+    parent_id = item->parent_id;
 
     /* delete file for process locks */
     if (item->refcount == 0 &&
-        item->mode == DNF_LOCK_MODE_PROCESS) {
+        item->mode == DNF_LOCK_MODE_PROCESS &&
+        item->access == DNF_LOCK_ACCESS_EXCLUSIVE &&
+        item->name == NULL) {
         g_autoptr(GError) error_local = NULL;
         g_autofree gchar *filename = NULL;
         g_autoptr(GFile) file = NULL;
@@ -545,7 +821,7 @@ dnf_lock_release(DnfLock *lock, guint id, GError **error) try
         }
     }
 
-    /* no thread now owns this lock */
+    /* no thread now owns this lock, freeing it closes the lock file */
     if (item->refcount == 0)
         g_ptr_array_remove(priv->item_array, item);
 
@@ -557,6 +833,8 @@ dnf_lock_release(DnfLock *lock, guint id, GError **error) try
 out:
     /* unlock other threads */
     g_mutex_unlock(&priv->mutex);
+    if (ret && parent_id != 0)
+        return dnf_lock_release(lock, parent_id, error);
     return ret;
 } CATCH_TO_GERROR(FALSE)
 
@@ -77,6 +77,21 @@ typedef enum {
         DNF_LOCK_MODE_LAST
 } DnfLockMode;
 
+/**
+ * DnfLockAccess:
+ * @DNF_LOCK_ACCESS_EXCLUSIVE:                  Held by one owner only
+ * @DNF_LOCK_ACCESS_SHARED:                     Held by any number of readers, but not
+ *                                              together with an exclusive lock
+ *
+ * The lock access.
+ **/
+typedef enum {
+        DNF_LOCK_ACCESS_EXCLUSIVE,
+        DNF_LOCK_ACCESS_SHARED,
+        /*< private >*/
+        DNF_LOCK_ACCESS_LAST
+} DnfLockAccess;
+
 DnfLock         *dnf_lock_new                   (void);
 
 /* getters */
@@ -89,6 +104,12 @@ guint            dnf_lock_take                  (DnfLock        *lock,
                                                  DnfLockType     type,
                                                  DnfLockMode     mode,
                                                  GError         **error);
+guint            dnf_lock_take_full             (DnfLock        *lock,
+                                                 DnfLockType     type,
+                                                 DnfLockMode     mode,
+                                                 DnfLockAccess   access,
+                                                 const gchar    *name,
+                                                 GError         **error);
 gboolean         dnf_lock_release               (DnfLock        *lock,
                                                  guint           id,
                                                  GError         **error);
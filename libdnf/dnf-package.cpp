@@ -38,7 +38,9 @@
 #include <assert.h>
 
 #include <librepo/librepo.h>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "catch-error.hpp"
 #include "dnf-context.hpp"
@@ -61,6 +63,31 @@ typedef struct {
     DnfRepo         *repo;
 } DnfPackagePrivate;
 
+/* the freed private areas kept for reuse, the packages of a query are often
+ * freed and created again at once */
+#define DNF_PACKAGE_PRIV_POOL_MAX   4096
+G_LOCK_DEFINE_STATIC(priv_pool);
+static std::vector<DnfPackagePrivate *> priv_pool;
+
+/**
+ * dnf_package_priv_alloc:
+ **/
+static DnfPackagePrivate *
+dnf_package_priv_alloc(void)
+{
+    DnfPackagePrivate *priv = NULL;
+    G_LOCK(priv_pool);
+    if (!priv_pool.empty()) {
+        priv = priv_pool.back();
+        priv_pool.pop_back();
+    }
+    G_UNLOCK(priv_pool);
+    if (priv == NULL)
+        return g_slice_new0(DnfPackagePrivate);
+    memset(priv, 0, sizeof(*priv));
+    return priv;
+}
+
 /**
  * dnf_package_destroy_func:
  **/
@@ -72,7 +99,14 @@ dnf_package_destroy_func(void *userdata)
     g_free(priv->origin);
     g_free(priv->package_id);
     g_free(priv->checksum_str);
-    g_slice_free(DnfPackagePrivate, priv);
+    G_LOCK(priv_pool);
+    if (priv_pool.size() < DNF_PACKAGE_PRIV_POOL_MAX) {
+        priv_pool.push_back(priv);
+        priv = NULL;
+    }
+    G_UNLOCK(priv_pool);
+    if (priv != NULL)
+        g_slice_free(DnfPackagePrivate, priv);
 }
 
 /**
@@ -88,7 +122,7 @@ dnf_package_get_priv(DnfPackage *pkg)
     if (priv != NULL)
         return priv;
 
-    priv = g_slice_new0(DnfPackagePrivate);
+    priv = dnf_package_priv_alloc();
     g_object_set_data_full(G_OBJECT(pkg), "DnfPackagePrivate", priv, dnf_package_destroy_func);
     return priv;
 }
@@ -820,53 +854,11 @@ dnf_package_array_download(GPtrArray *packages,
                 DnfState *state,
                 GError **error) try
 {
-    DnfState *state_local;
-    GHashTableIter hiter;
-    gpointer key, value;
-    guint i;
-    g_autoptr(GHashTable) repo_to_packages = NULL;
-
-    /* map packages to repos */
-    repo_to_packages = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify)g_ptr_array_unref);
-    for (i = 0; i < packages->len; i++) {
-        DnfPackage *pkg = (DnfPackage*)g_ptr_array_index(packages, i);
-        DnfRepo *repo;
-        GPtrArray *repo_packages;
-
-        repo = dnf_package_get_repo(pkg);
-        if (repo == NULL) {
-            g_set_error_literal(error,
-                                DNF_ERROR,
-                                DNF_ERROR_INTERNAL_ERROR,
-                                "package repo is unset");
-            return FALSE;
-        }
-        repo_packages = (GPtrArray*)g_hash_table_lookup(repo_to_packages, repo);
-        if (repo_packages == NULL) {
-            repo_packages = g_ptr_array_new();
-            g_hash_table_insert(repo_to_packages, repo, repo_packages);
-        }
-        g_ptr_array_add(repo_packages, pkg);
-    }
-
-    /* set steps according to the number of repos we are going to download from */
-    dnf_state_set_number_steps(state, g_hash_table_size(repo_to_packages));
-
-    /* download all packages from each repo in one go */
-    g_hash_table_iter_init(&hiter, repo_to_packages);
-    while (g_hash_table_iter_next(&hiter, &key, &value)) {
-        DnfRepo *repo = (DnfRepo*)key;
-        GPtrArray *repo_packages = (GPtrArray*)value;
-
-        state_local = dnf_state_get_child(state);
-        if (!dnf_repo_download_packages(repo, repo_packages, directory, state_local, error))
-            return FALSE;
+    if (packages->len == 0)
+        return TRUE;
 
-        /* done */
-        if (!dnf_state_done(state, error))
-            return FALSE;
-    }
-    return TRUE;
+    /* download the packages of all repos in one go */
+    return dnf_repo_download_packages_multi(packages, directory, state, error);
 } CATCH_TO_GERROR(FALSE)
 
 /**
@@ -893,3 +885,118 @@ dnf_package_array_get_download_size(GPtrArray *packages)
 
     return download_size;
 }
+
+/* bytes of the rebuilt package per second, for one applydeltarpm worker */
+#define DNF_PACKAGE_DELTA_REBUILD_RATE      (20 * 1024 * 1024)
+
+/**
+ * dnf_package_array_plan_deltas:
+ * @packages: an array of packages to download.
+ * @from_evrs: (element-type utf8): the EVR installed for each of @packages,
+ *             with %NULL for packages that do not update anything.
+ * @percentage: the largest delta size as a percentage of the package size,
+ *              e.g. from the `deltarpm_percentage` option, or 0 for no deltas.
+ * @bandwidth: the observed download speed in bytes per second, or 0 if unknown.
+ * @rebuild_rate: the bytes of the rebuilt package one worker produces per
+ *                second, or 0 for the default.
+ * @n_workers: the number of deltas rebuilt at the same time, or 0 for as many
+ *             as there are processors.
+ *
+ * Chooses for which of @packages the delta is downloaded instead of the full
+ * package. Rebuilding from deltas costs CPU time, so a delta is only chosen
+ * when it shortens the whole transfer, that is the download time of all the
+ * packages and deltas, or the time the @n_workers workers rebuilding the
+ * deltas while the downloads continue need, whichever is longer. Without a
+ * @bandwidth every delta within @percentage is chosen.
+ *
+ * Returns: (transfer full) (element-type DnfPackage DnfPackageDelta):
+ *          the chosen delta of each package it is used for.
+ *
+ * Since: 0.70.0
+ */
+GHashTable *
+dnf_package_array_plan_deltas(GPtrArray *packages,
+                              GPtrArray *from_evrs,
+                              guint percentage,
+                              guint64 bandwidth,
+                              guint64 rebuild_rate,
+                              guint n_workers)
+{
+    struct Candidate {
+        DnfPackage *pkg;
+        DnfPackageDelta *delta;
+        guint64 pkg_size;
+        guint64 delta_size;
+    };
+    std::vector<Candidate> candidates;
+    GHashTable *deltas;
+    gdouble download_time = 0;
+    gdouble rebuild_time = 0;
+    gdouble longest_rebuild = 0;
+
+    g_return_val_if_fail(from_evrs->len == packages->len, NULL);
+
+    deltas = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                   g_object_unref, g_object_unref);
+    if (percentage == 0)
+        return deltas;
+    if (rebuild_rate == 0)
+        rebuild_rate = DNF_PACKAGE_DELTA_REBUILD_RATE;
+    if (n_workers == 0)
+        n_workers = MAX(g_get_num_processors(), 1);
+
+    for (guint i = 0; i < packages->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(packages, i));
+        auto from_evr = static_cast<const gchar *>(g_ptr_array_index(from_evrs, i));
+        guint64 pkg_size = dnf_package_get_downloadsize(pkg);
+
+        download_time += pkg_size;
+        if (from_evr == NULL)
+            continue;
+        DnfPackageDelta *delta = dnf_package_get_delta_from_evr(pkg, from_evr);
+        if (delta == NULL)
+            continue;
+        guint64 delta_size = dnf_packagedelta_get_downloadsize(delta);
+        if (delta_size * 100 >= pkg_size * percentage) {
+            g_object_unref(delta);
+            continue;
+        }
+        candidates.push_back({pkg, delta, pkg_size, delta_size});
+    }
+
+    /* the deltas saving the most download per rebuilt byte first */
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate & a, const Candidate & b) {
+                  return (a.pkg_size - a.delta_size) * b.pkg_size >
+                         (b.pkg_size - b.delta_size) * a.pkg_size;
+              });
+
+    /* all the times in seconds, the rebuilding of the longest delta can not
+     * be shared by the workers and is only done after its download */
+    if (bandwidth > 0)
+        download_time /= bandwidth;
+    for (auto & candidate : candidates) {
+        gboolean use = TRUE;
+        if (bandwidth > 0) {
+            gdouble cost = MAX(download_time, rebuild_time / n_workers + longest_rebuild);
+            gdouble candidate_rebuild = (gdouble) candidate.pkg_size / rebuild_rate;
+            gdouble new_download_time = download_time -
+                (gdouble) (candidate.pkg_size - candidate.delta_size) / bandwidth;
+            gdouble new_rebuild_time = rebuild_time + candidate_rebuild;
+            gdouble new_longest_rebuild = MAX(longest_rebuild, candidate_rebuild);
+            gdouble new_cost = MAX(new_download_time,
+                                   new_rebuild_time / n_workers + new_longest_rebuild);
+            use = new_cost < cost;
+            if (use) {
+                download_time = new_download_time;
+                rebuild_time = new_rebuild_time;
+                longest_rebuild = new_longest_rebuild;
+            }
+        }
+        if (use)
+            g_hash_table_insert(deltas, g_object_ref(candidate.pkg), candidate.delta);
+        else
+            g_object_unref(candidate.delta);
+    }
+    return deltas;
+}
@@ -100,6 +100,12 @@ gboolean         dnf_package_array_download             (GPtrArray      *package
                                                          DnfState       *state,
                                                          GError         **error);
 guint64          dnf_package_array_get_download_size    (GPtrArray      *packages);
+GHashTable      *dnf_package_array_plan_deltas          (GPtrArray      *packages,
+                                                         GPtrArray      *from_evrs,
+                                                         guint           percentage,
+                                                         guint64         bandwidth,
+                                                         guint64         rebuild_rate,
+                                                         guint           n_workers);
 
 G_END_DECLS
 
@@ -32,6 +32,7 @@
  */
 
 #include <strings.h>
+#include <sys/stat.h>
 
 #include <gio/gunixmounts.h>
 #include <librepo/util.h>
@@ -41,6 +42,7 @@
 #include "dnf-package.h"
 #include "dnf-repo-loader.h"
 #include "dnf-utils.h"
+#include "utils/PhaseTimer.hpp"
 
 typedef struct
 {
@@ -347,9 +349,14 @@ dnf_repo_loader_repo_parse_id(DnfRepoLoader *self,
     dnf_repo_set_filename(repo, filename);
     dnf_repo_set_id(repo, id);
 
-    /* set up the repo ready for use */
-    if (!dnf_repo_setup(repo, error))
-        return FALSE;
+    /* set up the repo ready for use, disabled ones only when needed */
+    if (dnf_context_get_lazy_repo_setup(priv->context)) {
+        if (!dnf_repo_setup_lazy(repo, error))
+            return FALSE;
+    } else {
+        if (!dnf_repo_setup(repo, error))
+            return FALSE;
+    }
 
     g_debug("added repo %s\t%s", filename, id);
     g_ptr_array_add(priv->repos, g_object_ref(repo));
@@ -357,24 +364,16 @@ dnf_repo_loader_repo_parse_id(DnfRepoLoader *self,
 }
 
 /**
- * dnf_repo_loader_repo_parse:
+ * dnf_repo_loader_repo_parse_keyfile:
  **/
 static gboolean
-dnf_repo_loader_repo_parse(DnfRepoLoader *self,
-                           const gchar *filename,
-                           GError **error)
+dnf_repo_loader_repo_parse_keyfile(DnfRepoLoader *self,
+                                   const gchar *filename,
+                                   GKeyFile *keyfile,
+                                   GError **error)
 {
-    gboolean ret = TRUE;
     guint i;
     g_auto(GStrv) groups = NULL;
-    g_autoptr(GKeyFile) keyfile = NULL;
-
-    /* load non-standard keyfile */
-    keyfile = dnf_repo_loader_load_multiline_key_file(filename, error);
-    if (keyfile == NULL) {
-        g_prefix_error(error, "Failed to load %s: ", filename);
-        return FALSE;
-    }
 
     /* save all the repos listed in the file, "main" section is skipped - repoid can't be "main" */
     groups = g_key_file_get_groups(keyfile, NULL);
@@ -382,13 +381,179 @@ dnf_repo_loader_repo_parse(DnfRepoLoader *self,
         if (strcmp(groups[i], "main") == 0) {
             continue;
         }
-        ret = dnf_repo_loader_repo_parse_id(self, groups[i], filename, keyfile, error);
-        if (!ret)
+        if (!dnf_repo_loader_repo_parse_id(self, groups[i], filename, keyfile, error))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * The repo snapshot:
+ *
+ * The keyfiles of all the .repo files and the main configuration file are
+ * kept in the cache directory as one serialized GVariant, together with the
+ * inode, mtime and size of each of them and of the repo directories. While
+ * none of these changed the keyfiles are rebuilt from it, skipping reading
+ * and joining the continuation lines of every file. The values are kept as
+ * raw keyfile values, the comments with them so that dnf_repo_commit()
+ * writes the same file.
+ */
+#define DNF_REPO_LOADER_SNAPSHOT_FN         "repos.snapshot"
+#define DNF_REPO_LOADER_SNAPSHOT_VERSION    1
+#define DNF_REPO_LOADER_SNAPSHOT_TYPE       "(ua(sttxt)a(ssa(ssa(sss))))"
+
+/**
+ * dnf_repo_loader_snapshot_add_source:
+ *
+ * Records the identity of @path; a missing path is recorded as well, so
+ * that creating it invalidates the snapshot.
+ **/
+static void
+dnf_repo_loader_snapshot_add_source(GVariantBuilder *sources, const gchar *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+        memset(&st, 0, sizeof(st));
+    g_variant_builder_add(sources, "(sttxt)", path,
+                          (guint64) st.st_dev, (guint64) st.st_ino,
+                          (gint64) st.st_mtim.tv_sec * G_USEC_PER_SEC + st.st_mtim.tv_nsec / 1000,
+                          (guint64) st.st_size);
+}
+
+/**
+ * dnf_repo_loader_snapshot_load:
+ *
+ * Returns: the files of a snapshot taken from exactly @sources, or %NULL
+ **/
+static GVariant *
+dnf_repo_loader_snapshot_load(const gchar *snapshot_fn, GVariant *sources)
+{
+    gchar *data = NULL;
+    gsize len;
+    guint32 version;
+    g_autoptr(GVariant) snapshot = NULL;
+    g_autoptr(GVariant) snapshot_sources = NULL;
+
+    if (!g_file_get_contents(snapshot_fn, &data, &len, NULL))
+        return NULL;
+    snapshot = g_variant_ref_sink(g_variant_new_from_data(G_VARIANT_TYPE(DNF_REPO_LOADER_SNAPSHOT_TYPE),
+                                                          data, len, FALSE, g_free, data));
+    g_variant_get_child(snapshot, 0, "u", &version);
+    if (version != DNF_REPO_LOADER_SNAPSHOT_VERSION)
+        return NULL;
+    snapshot_sources = g_variant_get_child_value(snapshot, 1);
+    if (!g_variant_equal(snapshot_sources, sources))
+        return NULL;
+    return g_variant_get_child_value(snapshot, 2);
+}
+
+/**
+ * dnf_repo_loader_snapshot_add_keyfile:
+ *
+ * Returns: %FALSE if the keyfile cannot be represented in the snapshot
+ **/
+static gboolean
+dnf_repo_loader_snapshot_add_keyfile(GVariantBuilder *files,
+                                     const gchar *filename,
+                                     GKeyFile *keyfile)
+{
+    GVariantBuilder groups_builder;
+    g_autofree gchar *top_comment = g_key_file_get_comment(keyfile, NULL, NULL, NULL);
+    g_auto(GStrv) groups = g_key_file_get_groups(keyfile, NULL);
+
+    if (!g_utf8_validate(filename, -1, NULL) ||
+        (top_comment != NULL && !g_utf8_validate(top_comment, -1, NULL)))
+        return FALSE;
+    g_variant_builder_init(&groups_builder, G_VARIANT_TYPE("a(ssa(sss))"));
+    for (guint i = 0; groups[i] != NULL; i++) {
+        GVariantBuilder keys_builder;
+        g_autofree gchar *group_comment = g_key_file_get_comment(keyfile, groups[i], NULL, NULL);
+        g_auto(GStrv) keys = g_key_file_get_keys(keyfile, groups[i], NULL, NULL);
+
+        /* a group without keys cannot be recreated */
+        if (keys == NULL || keys[0] == NULL ||
+            (group_comment != NULL && !g_utf8_validate(group_comment, -1, NULL))) {
+            g_variant_builder_clear(&groups_builder);
             return FALSE;
+        }
+        g_variant_builder_init(&keys_builder, G_VARIANT_TYPE("a(sss)"));
+        for (guint j = 0; keys[j] != NULL; j++) {
+            g_autofree gchar *value = g_key_file_get_value(keyfile, groups[i], keys[j], NULL);
+            g_autofree gchar *comment = g_key_file_get_comment(keyfile, groups[i], keys[j], NULL);
+            if (value == NULL || !g_utf8_validate(value, -1, NULL) ||
+                (comment != NULL && !g_utf8_validate(comment, -1, NULL))) {
+                g_variant_builder_clear(&keys_builder);
+                g_variant_builder_clear(&groups_builder);
+                return FALSE;
+            }
+            g_variant_builder_add(&keys_builder, "(sss)", keys[j], value,
+                                  comment != NULL ? comment : "");
+        }
+        g_variant_builder_add(&groups_builder, "(ssa(sss))", groups[i],
+                              group_comment != NULL ? group_comment : "", &keys_builder);
     }
+    g_variant_builder_add(files, "(ssa(ssa(sss)))", filename,
+                          top_comment != NULL ? top_comment : "", &groups_builder);
     return TRUE;
 }
 
+/**
+ * dnf_repo_loader_snapshot_get_keyfile:
+ **/
+static GKeyFile *
+dnf_repo_loader_snapshot_get_keyfile(GVariant *file, const gchar **filename)
+{
+    const gchar *top_comment;
+    const gchar *group;
+    const gchar *group_comment;
+    GVariantIter *groups;
+    GVariantIter *keys;
+    GKeyFile *keyfile = g_key_file_new();
+
+    g_variant_get(file, "(&s&sa(ssa(sss)))", filename, &top_comment, &groups);
+    while (g_variant_iter_loop(groups, "(&s&sa(sss))", &group, &group_comment, &keys)) {
+        const gchar *key;
+        const gchar *value;
+        const gchar *comment;
+        while (g_variant_iter_loop(keys, "(&s&s&s)", &key, &value, &comment)) {
+            g_key_file_set_value(keyfile, group, key, value);
+            if (comment[0] != '\0')
+                g_key_file_set_comment(keyfile, group, key, comment, NULL);
+        }
+        if (group_comment[0] != '\0')
+            g_key_file_set_comment(keyfile, group, NULL, group_comment, NULL);
+    }
+    g_variant_iter_free(groups);
+    if (top_comment[0] != '\0')
+        g_key_file_set_comment(keyfile, NULL, NULL, top_comment, NULL);
+    return keyfile;
+}
+
+/**
+ * dnf_repo_loader_repo_parse:
+ *
+ * Loads the repos of @filename, adding its keyfile to @files unless %NULL.
+ **/
+static gboolean
+dnf_repo_loader_repo_parse(DnfRepoLoader *self,
+                           const gchar *filename,
+                           GVariantBuilder *files,
+                           gboolean *snapshot_valid,
+                           GError **error)
+{
+    g_autoptr(GKeyFile) keyfile = NULL;
+
+    /* load non-standard keyfile */
+    keyfile = dnf_repo_loader_load_multiline_key_file(filename, error);
+    if (keyfile == NULL) {
+        g_prefix_error(error, "Failed to load %s: ", filename);
+        return FALSE;
+    }
+    if (*snapshot_valid && !dnf_repo_loader_snapshot_add_keyfile(files, filename, keyfile))
+        *snapshot_valid = FALSE;
+    return dnf_repo_loader_repo_parse_keyfile(self, filename, keyfile, error);
+}
+
 /**
  * dnf_repo_loader_refresh:
  */
@@ -408,33 +573,81 @@ dnf_repo_loader_refresh(DnfRepoLoader *self, GError **error)
     if (!dnf_context_setup_enrollments(priv->context, error))
         return FALSE;
 
-    /* load repos defined in main configuration */
+    /* find the files to load, in order */
+    g_autoptr(GPtrArray) filenames = g_ptr_array_new_with_free_func(g_free);
+    GVariantBuilder sources_builder;
+    g_variant_builder_init(&sources_builder, G_VARIANT_TYPE("a(sttxt)"));
+
+    /* repos defined in main configuration */
     auto cfg_file_path = dnf_context_get_config_file_path();
-    if (cfg_file_path[0] != '\0' &&
-        (dnf_context_is_set_config_file_path() || g_file_test(cfg_file_path, G_FILE_TEST_IS_REGULAR))) {
-        if (!dnf_repo_loader_repo_parse(self, cfg_file_path, error)) {
-            return FALSE;
-        }
+    if (cfg_file_path[0] != '\0') {
+        dnf_repo_loader_snapshot_add_source(&sources_builder, cfg_file_path);
+        if (dnf_context_is_set_config_file_path() || g_file_test(cfg_file_path, G_FILE_TEST_IS_REGULAR))
+            g_ptr_array_add(filenames, g_strdup(cfg_file_path));
     }
-    
+
     /* open dir */
     auto repos_dir = dnf_context_get_repos_dir(priv->context);
     for (auto item = repos_dir; *item; ++item) {
         auto repo_path = *item;
+        dnf_repo_loader_snapshot_add_source(&sources_builder, repo_path);
         g_autoptr(GDir) dir = g_dir_open(repo_path, 0, NULL);
         // existence of repos directories is not mandatory
         if (dir == NULL)
             continue;
-        
+
         /* find all the .repo files */
         while (auto file = g_dir_read_name(dir)) {
-            g_autofree gchar *path_tmp = NULL;
             if (!g_str_has_suffix(file, ".repo"))
                 continue;
-            path_tmp = g_build_filename(repo_path, file, NULL);
-            if (!dnf_repo_loader_repo_parse(self, path_tmp, error))
+            gchar *path_tmp = g_build_filename(repo_path, file, NULL);
+            dnf_repo_loader_snapshot_add_source(&sources_builder, path_tmp);
+            g_ptr_array_add(filenames, path_tmp);
+        }
+    }
+    g_autoptr(GVariant) sources = g_variant_ref_sink(g_variant_builder_end(&sources_builder));
+
+    /* none of the files changed since the snapshot */
+    const gchar *cache_dir = dnf_context_get_cache_dir(priv->context);
+    g_autofree gchar *snapshot_fn = NULL;
+    g_autoptr(GVariant) snapshot_files = NULL;
+    if (cache_dir != NULL) {
+        snapshot_fn = g_build_filename(cache_dir, DNF_REPO_LOADER_SNAPSHOT_FN, NULL);
+        snapshot_files = dnf_repo_loader_snapshot_load(snapshot_fn, sources);
+    }
+    if (snapshot_files != NULL && g_variant_n_children(snapshot_files) == filenames->len) {
+        g_debug("using repo snapshot %s", snapshot_fn);
+        for (gsize i = 0; i < g_variant_n_children(snapshot_files); i++) {
+            const gchar *filename;
+            g_autoptr(GVariant) file = g_variant_get_child_value(snapshot_files, i);
+            g_autoptr(GKeyFile) keyfile = dnf_repo_loader_snapshot_get_keyfile(file, &filename);
+            if (!dnf_repo_loader_repo_parse_keyfile(self, filename, keyfile, error))
                 return FALSE;
         }
+    } else {
+        GVariantBuilder files_builder;
+        gboolean snapshot_valid = snapshot_fn != NULL;
+        g_variant_builder_init(&files_builder, G_VARIANT_TYPE("a(ssa(ssa(sss)))"));
+        for (guint i = 0; i < filenames->len; i++) {
+            auto filename = static_cast<const gchar *>(g_ptr_array_index(filenames, i));
+            if (!dnf_repo_loader_repo_parse(self, filename, &files_builder, &snapshot_valid, error)) {
+                g_variant_builder_clear(&files_builder);
+                return FALSE;
+            }
+        }
+        if (snapshot_valid) {
+            g_autoptr(GError) error_local = NULL;
+            g_autoptr(GVariant) snapshot = g_variant_ref_sink(
+                g_variant_new("(u@a(sttxt)a(ssa(ssa(sss))))", DNF_REPO_LOADER_SNAPSHOT_VERSION,
+                              sources, &files_builder));
+            /* only costs the next run the parsing again */
+            if (!g_file_set_contents(snapshot_fn,
+                                     static_cast<const gchar *>(g_variant_get_data(snapshot)),
+                                     g_variant_get_size(snapshot), &error_local))
+                g_debug("failed to write repo snapshot: %s", error_local->message);
+        } else {
+            g_variant_builder_clear(&files_builder);
+        }
     }
 
     /* add any DVD repos */
@@ -478,6 +691,7 @@ GPtrArray *
 dnf_repo_loader_get_repos(DnfRepoLoader *self, GError **error) try
 {
     DnfRepoLoaderPrivate *priv = GET_PRIVATE(self);
+    libdnf::PhaseTimer timer("dnf_repo_loader_get_repos");
 
     g_return_val_if_fail(DNF_IS_REPO_LOADER(self), NULL);
     g_return_val_if_fail(error == NULL || *error == NULL, NULL);
@@ -40,6 +40,7 @@
 #include "hy-iutil-private.hpp"
 
 #include <strings.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <fnmatch.h>
 #include <glib/gstdio.h>
@@ -47,6 +48,8 @@
 #include <librepo/librepo.h>
 #include <rpm/rpmts.h>
 #include <librepo/yum.h>
+#include <sys/file.h>
+#include <unistd.h>
 
 #include "catch-error.hpp"
 #include "dnf-keyring.h"
@@ -84,11 +87,14 @@ typedef struct
     LrResult        *repo_result;
     LrUrlVars       *urlvars;
     bool            unit_test_mode;  /* ugly hack for unit tests */
+    bool            setup_pending;   /* set up by dnf_repo_setup_lazy() */
 } DnfRepoPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(DnfRepo, dnf_repo, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (static_cast<DnfRepoPrivate *>(dnf_repo_get_instance_private (o)))
 
+static void dnf_repo_ensure_setup(DnfRepo *repo);
+
 /**
  * dnf_repo_finalize:
  **/
@@ -175,6 +181,7 @@ const gchar *
 dnf_repo_get_location(DnfRepo *repo)
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    dnf_repo_ensure_setup(repo);
     return priv->location;
 }
 
@@ -209,6 +216,7 @@ const gchar *
 dnf_repo_get_packages(DnfRepo *repo)
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    dnf_repo_ensure_setup(repo);
     return priv->packages;
 }
 
@@ -226,6 +234,7 @@ gchar **
 dnf_repo_get_public_keys(DnfRepo *repo)
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    dnf_repo_ensure_setup(repo);
     const auto & keys = priv->repo->getConfig()->gpgkey().getValue();
     gchar **ret = g_new0(gchar *, keys.size() + 1);
     for (size_t i = 0; i < keys.size(); ++i) {
@@ -408,6 +417,7 @@ gchar **
 dnf_repo_get_exclude_packages(DnfRepo *repo)
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    dnf_repo_ensure_setup(repo);
     return priv->exclude_packages;
 }
 
@@ -667,6 +677,9 @@ dnf_repo_set_enabled(DnfRepo *repo, DnfRepoEnabled enabled)
     /* packages implies metadata */
     if (priv->enabled & DNF_REPO_ENABLED_PACKAGES)
         priv->enabled |= DNF_REPO_ENABLED_METADATA;
+
+    if (priv->enabled != DNF_REPO_ENABLED_NONE)
+        dnf_repo_ensure_setup(repo);
 }
 
 /**
@@ -950,6 +963,63 @@ dnf_repo_apply_setopts(libdnf::ConfigRepo &config, const char *repoId)
     }
 }
 
+/* Sets the librepo handle options which are not read from the keyfile. */
+static gboolean
+dnf_repo_setup_handle(DnfRepo *repo, GError **error)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    auto conf = priv->repo->getConfig();
+
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_USERAGENT, dnf_context_get_user_agent(priv->context)))
+        return FALSE;
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_REPOTYPE, LR_YUMREPO))
+        return FALSE;
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_INTERRUPTIBLE, 0L))
+        return FALSE;
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_VARSUB, priv->urlvars))
+        return FALSE;
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_GNUPGHOMEDIR, priv->keyring))
+        return FALSE;
+
+    auto sslverify = conf->sslverify().getValue();
+    /* XXX: setopt() expects a long, so we need a long on the stack */
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLVERIFYPEER, (long)sslverify))
+        return FALSE;
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLVERIFYHOST, (long)sslverify))
+        return FALSE;
+
+    auto & sslcacert = conf->sslcacert().getValue();
+    if (!sslcacert.empty()) {
+        if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLCACERT, sslcacert.c_str()))
+            return FALSE;
+    }
+
+    auto & sslclientcert = conf->sslclientcert().getValue();
+    if (!sslclientcert.empty()) {
+        if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLCLIENTCERT, sslclientcert.c_str()))
+            return FALSE;
+    }
+
+    auto & sslclientkey = conf->sslclientkey().getValue();
+    if (!sslclientkey.empty()) {
+        if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLCLIENTKEY, sslclientkey.c_str()))
+            return FALSE;
+    }
+
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLVERIFYSTATUS, conf->sslverifystatus().getValue() ? 1L : 0L))
+        return FALSE;
+
+#ifdef LRO_SUPPORTS_CACHEDIR
+    /* Set cache dir */
+    if (dnf_context_get_zchunk(priv->context)) {
+        if(!lr_handle_setopt(priv->repo_handle, error, LRO_CACHEDIR, dnf_context_get_cache_dir(priv->context)))
+           return FALSE;
+    }
+#endif
+
+    return TRUE;
+}
+
 /* Initialize (or potentially reset) repo & LrHandle from keyfile values. */
 static gboolean
 dnf_repo_set_keyfile_data(DnfRepo *repo, gboolean reloadFromGKeyFile, GError **error)
@@ -961,6 +1031,13 @@ dnf_repo_set_keyfile_data(DnfRepo *repo, gboolean reloadFromGKeyFile, GError **e
     auto repoId = priv->repo->getId().c_str();
     g_debug("setting keyfile data for %s", repoId);
 
+    /* finish the setup deferred by dnf_repo_setup_lazy() */
+    if (priv->setup_pending) {
+        if (!dnf_repo_setup_handle(repo, error))
+            return FALSE;
+        priv->setup_pending = false;
+    }
+
     auto conf = priv->repo->getConfig();
 
     // Reload repository configuration from keyfile.
@@ -1094,6 +1171,13 @@ dnf_repo_set_keyfile_data(DnfRepo *repo, gboolean reloadFromGKeyFile, GError **e
     if (!lr_handle_setopt(priv->repo_handle, error, LRO_MAXSPEED, static_cast<int64_t>(maxspeed)))
         return FALSE;
 
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_MAXPARALLELDOWNLOADS,
+                          static_cast<long>(conf->max_parallel_downloads().getValue())))
+        return FALSE;
+    if (!lr_handle_setopt(priv->repo_handle, error, LRO_MAXDOWNLOADSPERMIRROR,
+                          static_cast<long>(conf->max_downloads_per_mirror().getValue())))
+        return FALSE;
+
     long timeout = conf->timeout().getValue();
     if (timeout > 0) {
         if (!lr_handle_setopt(priv->repo_handle, error, LRO_CONNECTTIMEOUT, timeout))
@@ -1173,19 +1257,31 @@ dnf_repo_set_keyfile_data(DnfRepo *repo, gboolean reloadFromGKeyFile, GError **e
     return TRUE;
 }
 
-/**
- * dnf_repo_setup:
- * @repo: a #DnfRepo instance.
- * @error: a #GError or %NULL
- *
- * Sets up the repo ready for use.
- *
- * Returns: %TRUE for success
- *
- * Since: 0.1.0
- **/
-gboolean
-dnf_repo_setup(DnfRepo *repo, GError **error) try
+/* Completes the setup deferred by dnf_repo_setup_lazy(), if any. */
+static gboolean
+dnf_repo_setup_finish(DnfRepo *repo, GError **error)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    if (!priv->setup_pending)
+        return TRUE;
+    return dnf_repo_set_keyfile_data(repo, FALSE, error);
+}
+
+/* Like dnf_repo_setup_finish(), for the methods without an error. */
+static void
+dnf_repo_ensure_setup(DnfRepo *repo)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    g_autoptr(GError) error_local = NULL;
+
+    if (!dnf_repo_setup_finish(repo, &error_local))
+        g_warning("failed to set up repo %s: %s",
+                  priv->repo->getId().c_str(), error_local->message);
+}
+
+/* Loads the repo configuration and the enabled state. */
+static gboolean
+dnf_repo_setup_config(DnfRepo *repo, GError **error)
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
     DnfRepoEnabled enabled = DNF_REPO_ENABLED_NONE;
@@ -1212,12 +1308,6 @@ dnf_repo_setup(DnfRepo *repo, GError **error) try
                             "releasever not set");
         return FALSE;
     }
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_USERAGENT, dnf_context_get_user_agent(priv->context)))
-        return FALSE;
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_REPOTYPE, LR_YUMREPO))
-        return FALSE;
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_INTERRUPTIBLE, 0L))
-        return FALSE;
     priv->urlvars = lr_urlvars_set(priv->urlvars, "releasever", release);
     priv->urlvars = lr_urlvars_set(priv->urlvars, "basearch", basearch);
 
@@ -1229,53 +1319,12 @@ dnf_repo_setup(DnfRepo *repo, GError **error) try
     for (const auto & item : libdnf::dnf_context_get_vars(priv->context))
         priv->urlvars = lr_urlvars_set(priv->urlvars, item.first.c_str(), item.second.c_str());
 
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_VARSUB, priv->urlvars))
-        return FALSE;
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_GNUPGHOMEDIR, priv->keyring))
-        return FALSE;
-
     auto repoId = priv->repo->getId().c_str();
 
     auto conf = priv->repo->getConfig();
     dnf_repo_conf_from_gkeyfile(repo, repoId, priv->keyfile);
     dnf_repo_apply_setopts(*conf, repoId);
 
-    auto sslverify = conf->sslverify().getValue();
-    /* XXX: setopt() expects a long, so we need a long on the stack */
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLVERIFYPEER, (long)sslverify))
-        return FALSE;
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLVERIFYHOST, (long)sslverify))
-        return FALSE;
-
-    auto & sslcacert = conf->sslcacert().getValue();
-    if (!sslcacert.empty()) {
-        if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLCACERT, sslcacert.c_str()))
-            return FALSE;
-    }
-
-    auto & sslclientcert = conf->sslclientcert().getValue();
-    if (!sslclientcert.empty()) {
-        if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLCLIENTCERT, sslclientcert.c_str()))
-            return FALSE;
-    }
-
-    auto & sslclientkey = conf->sslclientkey().getValue();
-    if (!sslclientkey.empty()) {
-        if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLCLIENTKEY, sslclientkey.c_str()))
-            return FALSE;
-    }
-
-    if (!lr_handle_setopt(priv->repo_handle, error, LRO_SSLVERIFYSTATUS, conf->sslverifystatus().getValue() ? 1L : 0L))
-        return FALSE;
-
-#ifdef LRO_SUPPORTS_CACHEDIR
-    /* Set cache dir */
-    if (dnf_context_get_zchunk(priv->context)) {
-        if(!lr_handle_setopt(priv->repo_handle, error, LRO_CACHEDIR, dnf_context_get_cache_dir(priv->context)))
-           return FALSE;
-    }
-#endif
-
     if (conf->enabled().getValue())
         enabled |= DNF_REPO_ENABLED_PACKAGES;
 
@@ -1296,6 +1345,61 @@ dnf_repo_setup(DnfRepo *repo, GError **error) try
 
     dnf_repo_set_enabled(repo, enabled);
 
+    return TRUE;
+}
+
+/**
+ * dnf_repo_setup:
+ * @repo: a #DnfRepo instance.
+ * @error: a #GError or %NULL
+ *
+ * Sets up the repo ready for use.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.1.0
+ **/
+gboolean
+dnf_repo_setup(DnfRepo *repo, GError **error) try
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+
+    priv->setup_pending = false;
+    if (!dnf_repo_setup_config(repo, error))
+        return FALSE;
+    if (!dnf_repo_setup_handle(repo, error))
+        return FALSE;
+    return dnf_repo_set_keyfile_data(repo, FALSE, error);
+} CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_repo_setup_lazy:
+ * @repo: a #DnfRepo instance.
+ * @error: a #GError or %NULL
+ *
+ * Sets up the repo like dnf_repo_setup(), but for a disabled repo only
+ * the configuration and the enabled state are loaded. The librepo handle
+ * and the locations are set up once the repo is enabled or used.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_repo_setup_lazy(DnfRepo *repo, GError **error) try
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+
+    priv->setup_pending = false;
+    if (!dnf_repo_setup_config(repo, error))
+        return FALSE;
+    if (priv->enabled == DNF_REPO_ENABLED_NONE) {
+        g_debug("deferring setup of disabled repo %s", priv->repo->getId().c_str());
+        priv->setup_pending = true;
+        return TRUE;
+    }
+    if (!dnf_repo_setup_handle(repo, error))
+        return FALSE;
     return dnf_repo_set_keyfile_data(repo, FALSE, error);
 } CATCH_TO_GERROR(FALSE)
 
@@ -1541,7 +1645,8 @@ dnf_repo_check(DnfRepo *repo,
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
     g_clear_error(&priv->last_check_error);
-    if (!dnf_repo_check_internal(repo, permissible_cache_age, state,
+    if (!dnf_repo_setup_finish(repo, &priv->last_check_error) ||
+        !dnf_repo_check_internal(repo, permissible_cache_age, state,
                                  &priv->last_check_error)) {
         if (error)
             *error = g_error_copy(priv->last_check_error);
@@ -1591,6 +1696,9 @@ dnf_repo_clean(DnfRepo *repo, GError **error) try
 {
     DnfRepoPrivate *priv = GET_PRIVATE(repo);
 
+    if (!dnf_repo_setup_finish(repo, error))
+        return FALSE;
+
     /* do not clean media or local repos */
     if (priv->kind == DNF_REPO_KIND_MEDIA ||
         priv->kind == DNF_REPO_KIND_LOCAL)
@@ -1730,6 +1838,9 @@ dnf_repo_update(DnfRepo *repo,
     g_autoptr(GError) error_local = NULL;
     RepoUpdateData updatedata = { 0, };
 
+    if (!dnf_repo_setup_finish(repo, error))
+        return FALSE;
+
     /* cannot change DVD contents */
     if (priv->kind == DNF_REPO_KIND_MEDIA) {
         g_set_error_literal(error,
@@ -1768,11 +1879,13 @@ dnf_repo_update(DnfRepo *repo,
     /* countme support */
     libdnf::repoGetImpl(priv->repo)->addCountmeFlag(priv->repo_handle);
 
-    /* take lock */
-    ret = dnf_state_take_lock(state,
-                              DNF_LOCK_TYPE_METADATA,
-                              DNF_LOCK_MODE_PROCESS,
-                              error);
+    /* take lock, only of this repo so the others can refresh at the same time */
+    ret = dnf_state_take_lock_full(state,
+                                   DNF_LOCK_TYPE_METADATA,
+                                   DNF_LOCK_MODE_PROCESS,
+                                   DNF_LOCK_ACCESS_EXCLUSIVE,
+                                   priv->repo->getId().c_str(),
+                                   error);
     if (!ret)
         goto out;
 
@@ -2066,6 +2179,7 @@ typedef struct
     gchar *last_mirror_failure_message;
     guint64 downloaded;
     guint64 download_size;
+    const DnfRepoPackageDoneFunc *package_done; /* may be NULL */
 } GlobalDownloadData;
 
 typedef struct
@@ -2122,7 +2236,11 @@ package_download_end_cb(void *user_data,
                         const char *msg)
 {
     auto data = static_cast<PackageDownloadData *>(user_data);
+    GlobalDownloadData *global_data = data->global_download_data;
 
+    if (global_data->package_done != NULL &&
+        (status == LR_TRANSFER_SUCCESSFUL || status == LR_TRANSFER_ALREADYEXISTS))
+        (*global_data->package_done)(data->pkg);
     g_slice_free(PackageDownloadData, data);
 
     return LR_CB_OK;
@@ -2149,6 +2267,7 @@ LrHandle *
 dnf_repo_get_lr_handle(DnfRepo *repo)
 {
     DnfRepoPrivate *priv = GET_PRIVATE (repo);
+    dnf_repo_ensure_setup(repo);
     return priv->repo_handle;
 }
 
@@ -2193,6 +2312,421 @@ dnf_repo_download_package(DnfRepo *repo,
     return g_build_filename(directory, basename, NULL);
 } CATCH_TO_GERROR(NULL)
 
+/* largest first, so the big transfers do not end up running alone at the end */
+static gint
+package_target_cmp_size(gconstpointer a, gconstpointer b)
+{
+    auto target_a = static_cast<const LrPackageTarget *>(a);
+    auto target_b = static_cast<const LrPackageTarget *>(b);
+    if (target_a->expectedsize > target_b->expectedsize)
+        return -1;
+    if (target_a->expectedsize < target_b->expectedsize)
+        return 1;
+    return 0;
+}
+
+static gchar *
+dnf_repo_get_download_dir(DnfRepo *repo, const gchar *directory, GError **error)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+
+    /* librepo uses the GNU basename() function to find out if the
+     * output directory is fully specified as a filename, but
+     * basename needs a trailing '/' to detect it's not a filename */
+    if (directory != NULL)
+        return g_build_filename(directory, "/", NULL);
+
+    /* if nothing specified then use cachedir */
+    g_autofree gchar *directory_slash = g_build_filename(priv->packages, "/", NULL);
+    if (!g_file_test(directory_slash, G_FILE_TEST_EXISTS)) {
+        if (g_mkdir_with_parents(directory_slash, 0755) != 0) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        "Failed to create %s",
+                        directory_slash);
+            return NULL;
+        }
+    }
+    return static_cast<gchar *>(g_steal_pointer(&directory_slash));
+}
+
+static gboolean
+dnf_repo_add_package_target(DnfRepo *repo,
+                            DnfPackage *pkg,
+                            const gchar *directory_slash,
+                            DnfState *state,
+                            GlobalDownloadData *global_data,
+                            GSList **package_targets,
+                            GError **error)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    PackageDownloadData *data;
+    LrPackageTarget *target;
+    const unsigned char *checksum;
+    int checksum_type;
+    g_autofree char *checksum_str = NULL;
+    g_autofree gchar *basename = NULL;
+    g_autofree gchar *dest_path = NULL;
+
+    g_debug("downloading %s to %s",
+            dnf_package_get_location(pkg),
+            directory_slash);
+
+    data = g_slice_new0(PackageDownloadData);
+    data->pkg = pkg;
+    data->state = state;
+    data->global_download_data = global_data;
+
+    checksum = dnf_package_get_chksum(pkg, &checksum_type);
+    checksum_str = hy_chksum_str(checksum, checksum_type);
+
+    /* the target resumes a leftover download, unless it cannot be resumed */
+    if (checksum_str != NULL) {
+        basename = g_path_get_basename(dnf_package_get_location(pkg));
+        dest_path = g_build_filename(directory_slash, basename, NULL);
+        libdnf::filesystem::removeUnresumable(dest_path, hy_chksum_name(checksum_type), checksum_str,
+                                              dnf_package_get_downloadsize(pkg));
+    }
+
+    std::string encodedUrl = dnf_package_get_location(pkg);
+    if (encodedUrl.find("://") == std::string::npos) {
+        encodedUrl = libdnf::urlEncode(encodedUrl, "/");
+    }
+
+    target = lr_packagetarget_new_v2(priv->repo_handle,
+                                     encodedUrl.c_str(),
+                                     directory_slash,
+                                     dnf_repo_checksum_hy_to_lr(checksum_type),
+                                     checksum_str,
+                                     dnf_package_get_downloadsize(pkg),
+                                     dnf_package_get_baseurl(pkg),
+                                     TRUE,
+                                     package_download_update_state_cb,
+                                     data,
+                                     package_download_end_cb,
+                                     mirrorlist_failure_cb,
+                                     error);
+    if (target == NULL)
+        return FALSE;
+
+    global_data->download_size += dnf_package_get_downloadsize(pkg);
+    *package_targets = g_slist_prepend(*package_targets, target);
+    return TRUE;
+}
+
+static void
+dnf_repo_reset_progress_cb(DnfRepo *repo)
+{
+    DnfRepoPrivate *priv = GET_PRIVATE(repo);
+    if (!lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSCB, NULL))
+            g_debug("Failed to reset LRO_PROGRESSCB to NULL");
+    if (!lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSDATA, 0xdeadbeef))
+            g_debug("Failed to set LRO_PROGRESSDATA to 0xdeadbeef");
+}
+
+/* hands all the targets to a single librepo transfer loop, which keeps the
+ * connections of every repo busy within their handle limits */
+static gboolean
+dnf_repo_perform_package_targets(GSList **package_targets,
+                                 GlobalDownloadData *global_data,
+                                 GError **error)
+{
+    g_autoptr(GError) error_local = NULL;
+
+    *package_targets = g_slist_sort(*package_targets, package_target_cmp_size);
+    if (!lr_download_packages(*package_targets, LR_PACKAGEDOWNLOAD_FAILFAST, &error_local)) {
+        if (g_error_matches(error_local,
+                            LR_PACKAGE_DOWNLOADER_ERROR,
+                            LRE_ALREADYDOWNLOADED)) {
+            /* ignore */
+            return TRUE;
+        }
+        if (global_data->last_mirror_failure_message) {
+            g_autofree gchar *orig_message = error_local->message;
+            error_local->message = g_strconcat(orig_message, "; Last error: ", global_data->last_mirror_failure_message, NULL);
+        }
+        g_propagate_error(error, error_local);
+        error_local = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * The package store (the package_store_dir option) keeps one copy of every
+ * downloaded package, named by its checksum, so that cachedirs of different
+ * install roots are filled by hardlinks instead of downloads. A lock file per
+ * checksum makes concurrent processes wait for a download already running
+ * elsewhere instead of starting their own. A store copy is only used after
+ * it matches the checksum of the package.
+ */
+typedef enum {
+    PACKAGE_STORE_MISS,         /* download without the store */
+    PACKAGE_STORE_HIT,          /* linked from the store */
+    PACKAGE_STORE_OWNED,        /* download and add it to the store */
+    PACKAGE_STORE_BUSY          /* another process is downloading it */
+} PackageStoreState;
+
+typedef struct
+{
+    DnfRepo *repo;
+    DnfPackage *pkg;
+    gchar *directory_slash;
+    gchar *dest_path;
+    gchar *store_path;
+    gchar *checksum_str;
+    int checksum_type;
+    int lock_fd;
+} PackageStoreItem;
+
+static void
+package_store_item_free(PackageStoreItem *item)
+{
+    /* closing the file releases the lock */
+    if (item->lock_fd >= 0)
+        close(item->lock_fd);
+    g_free(item->directory_slash);
+    g_free(item->dest_path);
+    g_free(item->store_path);
+    g_free(item->checksum_str);
+    g_slice_free(PackageStoreItem, item);
+}
+
+static gint
+package_store_item_cmp(gconstpointer a, gconstpointer b)
+{
+    auto item_a = *static_cast<PackageStoreItem * const *>(a);
+    auto item_b = *static_cast<PackageStoreItem * const *>(b);
+    return g_strcmp0(item_a->store_path, item_b->store_path);
+}
+
+/* hardlinks when possible, copies across filesystems */
+static gboolean
+package_store_link(const gchar *src, const gchar *dest)
+{
+    if (link(src, dest) == 0)
+        return TRUE;
+    if (errno != EXDEV)
+        return FALSE;
+
+    g_autofree gchar *tmp = g_strdup_printf("%s.%i.tmp", dest, (int)getpid());
+    if (!dnf_copy_file(src, tmp, NULL) || g_rename(tmp, dest) != 0) {
+        g_unlink(tmp);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+package_store_verify(PackageStoreItem *item)
+{
+    try {
+        return libdnf::filesystem::checksum_check(hy_chksum_name(item->checksum_type),
+                                                  item->store_path, item->checksum_str);
+    } catch (const std::exception & ex) {
+        g_debug("failed to check %s: %s", item->store_path, ex.what());
+        return FALSE;
+    }
+}
+
+static gboolean
+package_store_fetch(PackageStoreItem *item)
+{
+    if (!g_file_test(item->store_path, G_FILE_TEST_EXISTS))
+        return FALSE;
+    if (!package_store_verify(item)) {
+        /* with the lock held the download replaces the bad copy */
+        if (item->lock_fd >= 0) {
+            g_warning("%s in the package store does not match %s, downloading it",
+                      item->store_path, dnf_package_get_nevra(item->pkg));
+            g_unlink(item->store_path);
+        }
+        return FALSE;
+    }
+    if (!package_store_link(item->store_path, item->dest_path))
+        return FALSE;
+    g_debug("using %s from the package store", item->dest_path);
+    return TRUE;
+}
+
+static void
+package_store_publish(PackageStoreItem *item)
+{
+    if (!package_store_link(item->dest_path, item->store_path) && errno != EEXIST)
+        g_debug("failed to add %s to the package store: %s",
+                item->dest_path, g_strerror(errno));
+}
+
+static PackageStoreState
+package_store_lookup(const gchar *store_dir,
+                     DnfRepo *repo,
+                     DnfPackage *pkg,
+                     const gchar *directory_slash,
+                     PackageStoreItem **item_out)
+{
+    const unsigned char *checksum;
+    int checksum_type;
+    gchar *checksum_str;
+    g_autofree gchar *type_dir = NULL;
+    g_autofree gchar *basename = NULL;
+    g_autofree gchar *lock_path = NULL;
+    PackageStoreItem *item;
+
+    checksum = dnf_package_get_chksum(pkg, &checksum_type);
+    if (checksum == NULL)
+        return PACKAGE_STORE_MISS;
+    type_dir = g_build_filename(store_dir, hy_chksum_name(checksum_type), NULL);
+    if (g_mkdir_with_parents(type_dir, 0755) != 0)
+        return PACKAGE_STORE_MISS;
+    checksum_str = hy_chksum_str(checksum, checksum_type);
+
+    basename = g_path_get_basename(dnf_package_get_location(pkg));
+    item = g_slice_new0(PackageStoreItem);
+    item->repo = repo;
+    item->pkg = pkg;
+    item->directory_slash = g_strdup(directory_slash);
+    item->dest_path = g_build_filename(directory_slash, basename, NULL);
+    item->store_path = g_build_filename(type_dir, checksum_str, NULL);
+    item->checksum_str = checksum_str;
+    item->checksum_type = checksum_type;
+    item->lock_fd = -1;
+
+    if (package_store_fetch(item)) {
+        package_store_item_free(item);
+        return PACKAGE_STORE_HIT;
+    }
+
+    lock_path = g_strconcat(item->store_path, ".lock", NULL);
+    item->lock_fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (item->lock_fd < 0) {
+        package_store_item_free(item);
+        return PACKAGE_STORE_MISS;
+    }
+    if (flock(item->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK) {
+            package_store_item_free(item);
+            return PACKAGE_STORE_MISS;
+        }
+        *item_out = item;
+        return PACKAGE_STORE_BUSY;
+    }
+
+    /* another download may have just finished */
+    if (package_store_fetch(item)) {
+        package_store_item_free(item);
+        return PACKAGE_STORE_HIT;
+    }
+    *item_out = item;
+    return PACKAGE_STORE_OWNED;
+}
+
+static gboolean
+dnf_repo_download_repo_packages(GHashTable *repo_to_packages,
+                                const gchar *directory,
+                                DnfState *state,
+                                const DnfRepoPackageDoneFunc *package_done,
+                                GError **error)
+{
+    gboolean ret = FALSE;
+    GSList *package_targets = NULL;
+    GlobalDownloadData global_data = { 0, };
+    GHashTableIter hiter;
+    gpointer key, value;
+    std::string store_dir;
+    global_data.package_done = package_done;
+    g_autoptr(GPtrArray) owned = g_ptr_array_new_with_free_func((GDestroyNotify)package_store_item_free);
+    g_autoptr(GPtrArray) busy = g_ptr_array_new_with_free_func((GDestroyNotify)package_store_item_free);
+
+    g_hash_table_iter_init(&hiter, repo_to_packages);
+    while (g_hash_table_iter_next(&hiter, &key, &value)) {
+        auto repo = DNF_REPO(key);
+        auto packages = static_cast<GPtrArray *>(value);
+        g_autofree gchar *directory_slash = NULL;
+
+        /* ensure we reset the values from the keyfile */
+        if (!dnf_repo_set_keyfile_data(repo, TRUE, error))
+            goto out;
+        store_dir = GET_PRIVATE(repo)->repo->getConfig()->getMainConfig().package_store_dir().getValue();
+
+        directory_slash = dnf_repo_get_download_dir(repo, directory, error);
+        if (directory_slash == NULL)
+            goto out;
+
+        for (guint i = 0; i < packages->len; i++) {
+            auto pkg = static_cast<DnfPackage *>(packages->pdata[i]);
+            PackageStoreItem *item = NULL;
+
+            if (!store_dir.empty()) {
+                switch (package_store_lookup(store_dir.c_str(), repo, pkg, directory_slash, &item)) {
+                case PACKAGE_STORE_HIT:
+                    if (package_done != NULL)
+                        (*package_done)(pkg);
+                    continue;
+                case PACKAGE_STORE_BUSY:
+                    g_ptr_array_add(busy, item);
+                    continue;
+                case PACKAGE_STORE_OWNED:
+                    g_ptr_array_add(owned, item);
+                    break;
+                case PACKAGE_STORE_MISS:
+                    break;
+                }
+            }
+            if (!dnf_repo_add_package_target(repo, pkg, directory_slash, state,
+                                             &global_data, &package_targets, error))
+                goto out;
+        }
+    }
+
+    if (package_targets != NULL &&
+        !dnf_repo_perform_package_targets(&package_targets, &global_data, error))
+        goto out;
+    for (guint i = 0; i < owned->len; i++)
+        package_store_publish(static_cast<PackageStoreItem *>(owned->pdata[i]));
+    /* let the processes waiting for these in */
+    g_ptr_array_set_size(owned, 0);
+
+    /* wait for the downloads of the other processes, the locks are taken
+     * in the order of the checksums so the waiting processes cannot deadlock */
+    g_slist_free_full(package_targets, (GDestroyNotify)lr_packagetarget_free);
+    package_targets = NULL;
+    g_ptr_array_sort(busy, package_store_item_cmp);
+    for (guint i = 0; i < busy->len; i++) {
+        auto item = static_cast<PackageStoreItem *>(busy->pdata[i]);
+        if (flock(item->lock_fd, LOCK_EX) == 0 && package_store_fetch(item)) {
+            close(item->lock_fd);
+            item->lock_fd = -1;
+            if (package_done != NULL)
+                (*package_done)(item->pkg);
+            continue;
+        }
+        /* the other download failed, do it ourselves */
+        if (!dnf_repo_add_package_target(item->repo, item->pkg, item->directory_slash, state,
+                                         &global_data, &package_targets, error))
+            goto out;
+    }
+    if (package_targets != NULL) {
+        if (!dnf_repo_perform_package_targets(&package_targets, &global_data, error))
+            goto out;
+        for (guint i = 0; i < busy->len; i++) {
+            auto item = static_cast<PackageStoreItem *>(busy->pdata[i]);
+            if (item->lock_fd >= 0)
+                package_store_publish(item);
+        }
+    }
+
+    ret = TRUE;
+out:
+    g_hash_table_iter_init(&hiter, repo_to_packages);
+    while (g_hash_table_iter_next(&hiter, &key, NULL))
+        dnf_repo_reset_progress_cb(DNF_REPO(key));
+    g_free(global_data.last_mirror_failure_message);
+    g_free(global_data.last_mirror_url);
+    g_slist_free_full(package_targets, (GDestroyNotify)lr_packagetarget_free);
+    return ret;
+}
+
 /**
  * dnf_repo_download_packages:
  * @repo: a #DnfRepo instance.
@@ -2215,111 +2749,74 @@ dnf_repo_download_packages(DnfRepo *repo,
                            DnfState *state,
                            GError **error) try
 {
-    DnfRepoPrivate *priv = GET_PRIVATE(repo);
-    gboolean ret = FALSE;
-    guint i;
-    GSList *package_targets = NULL;
-    GlobalDownloadData global_data = { 0, };
-    g_autoptr(GError) error_local = NULL;
-    g_autofree gchar *directory_slash = NULL;
+    g_autoptr(GHashTable) repo_to_packages = g_hash_table_new(NULL, NULL);
 
-    /* ensure we reset the values from the keyfile */
-    if (!dnf_repo_set_keyfile_data(repo, TRUE, error))
-        goto out;
+    g_hash_table_insert(repo_to_packages, repo, packages);
+    return dnf_repo_download_repo_packages(repo_to_packages, directory, state, NULL, error);
+} CATCH_TO_GERROR(FALSE)
 
-    /* if nothing specified then use cachedir */
-    if (directory == NULL) {
-        directory_slash = g_build_filename(priv->packages, "/", NULL);
-        if (!g_file_test(directory_slash, G_FILE_TEST_EXISTS)) {
-            if (g_mkdir_with_parents(directory_slash, 0755) != 0) {
-                g_set_error(error,
-                            DNF_ERROR,
-                            DNF_ERROR_INTERNAL_ERROR,
-                            "Failed to create %s",
-                            directory_slash);
-                goto out;
-            }
-        }
-    } else {
-        /* librepo uses the GNU basename() function to find out if the
-         * output directory is fully specified as a filename, but
-         * basename needs a trailing '/' to detect it's not a filename */
-        directory_slash = g_build_filename(directory, "/", NULL);
-    }
+/**
+ * dnf_repo_download_packages_multi:
+ * @packages: (element-type DnfPackage): an array of packages from any repos
+ * @directory: the destination directory, or %NULL for the cachedir of each repo.
+ * @state: a #DnfState.
+ * @error: a #GError or %NULL.
+ *
+ * Downloads packages from several repos in one go. Unlike calling
+ * dnf_repo_download_packages() for each repo, the transfers of all repos
+ * share one download queue ordered by package size, largest first, so a
+ * repo with a few big packages does not hold back the others.
+ * The max_parallel_downloads and max_downloads_per_mirror options of the
+ * repos still apply.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_repo_download_packages_multi(GPtrArray *packages,
+                                 const gchar *directory,
+                                 DnfState *state,
+                                 GError **error) try
+{
+    return dnf_repo_download_packages_multi_full(packages, directory, state, NULL, error);
+} CATCH_TO_GERROR(FALSE)
+
+/* like dnf_repo_download_packages_multi(), calls @package_done for every
+ * package as soon as its file is complete, before the other transfers end */
+gboolean
+dnf_repo_download_packages_multi_full(GPtrArray *packages,
+                                      const gchar *directory,
+                                      DnfState *state,
+                                      const DnfRepoPackageDoneFunc *package_done,
+                                      GError **error) try
+{
+    g_autoptr(GHashTable) repo_to_packages = NULL;
 
-    global_data.download_size = dnf_package_array_get_download_size(packages);
-    for (i = 0; i < packages->len; i++) {
+    /* map packages to repos */
+    repo_to_packages = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify)g_ptr_array_unref);
+    for (guint i = 0; i < packages->len; i++) {
         auto pkg = static_cast<DnfPackage *>(packages->pdata[i]);
-        PackageDownloadData *data;
-        LrPackageTarget *target;
-        const unsigned char *checksum;
-        int checksum_type;
-        g_autofree char *checksum_str = NULL;
-
-        g_debug("downloading %s to %s",
-                dnf_package_get_location(pkg),
-                directory_slash);
-
-        data = g_slice_new0(PackageDownloadData);
-        data->pkg = pkg;
-        data->state = state;
-        data->global_download_data = &global_data;
-
-        checksum = dnf_package_get_chksum(pkg, &checksum_type);
-        checksum_str = hy_chksum_str(checksum, checksum_type);
-
-        std::string encodedUrl = dnf_package_get_location(pkg);
-        if (encodedUrl.find("://") == std::string::npos) {
-            encodedUrl = libdnf::urlEncode(encodedUrl, "/");
+        DnfRepo *repo = dnf_package_get_repo(pkg);
+        GPtrArray *repo_packages;
+
+        if (repo == NULL) {
+            g_set_error_literal(error,
+                                DNF_ERROR,
+                                DNF_ERROR_INTERNAL_ERROR,
+                                "package repo is unset");
+            return FALSE;
         }
-
-        target = lr_packagetarget_new_v2(priv->repo_handle,
-                                         encodedUrl.c_str(),
-                                         directory_slash,
-                                         dnf_repo_checksum_hy_to_lr(checksum_type),
-                                         checksum_str,
-                                         dnf_package_get_downloadsize(pkg),
-                                         dnf_package_get_baseurl(pkg),
-                                         TRUE,
-                                         package_download_update_state_cb,
-                                         data,
-                                         package_download_end_cb,
-                                         mirrorlist_failure_cb,
-                                         error);
-        if (target == NULL)
-            goto out;
-
-        package_targets = g_slist_prepend(package_targets, target);
-    }
-
-    ret = lr_download_packages(package_targets, LR_PACKAGEDOWNLOAD_FAILFAST, &error_local);
-    if (!ret) {
-        if (g_error_matches(error_local,
-                            LR_PACKAGE_DOWNLOADER_ERROR,
-                            LRE_ALREADYDOWNLOADED)) {
-            /* ignore */
-            g_clear_error(&error_local);
-        } else {
-            if (global_data.last_mirror_failure_message) {
-                g_autofree gchar *orig_message = error_local->message;
-                error_local->message = g_strconcat(orig_message, "; Last error: ", global_data.last_mirror_failure_message, NULL);
-            }
-            g_propagate_error(error, error_local);
-            error_local = NULL;
-            goto out;
+        repo_packages = (GPtrArray*)g_hash_table_lookup(repo_to_packages, repo);
+        if (repo_packages == NULL) {
+            repo_packages = g_ptr_array_new();
+            g_hash_table_insert(repo_to_packages, repo, repo_packages);
         }
+        g_ptr_array_add(repo_packages, pkg);
     }
 
-    ret = TRUE;
-out:
-    if (!lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSCB, NULL))
-            g_debug("Failed to reset LRO_PROGRESSCB to NULL");
-    if (!lr_handle_setopt(priv->repo_handle, NULL, LRO_PROGRESSDATA, 0xdeadbeef))
-            g_debug("Failed to set LRO_PROGRESSDATA to 0xdeadbeef");
-    g_free(global_data.last_mirror_failure_message);
-    g_free(global_data.last_mirror_url);
-    g_slist_free_full(package_targets, (GDestroyNotify)lr_packagetarget_free);
-    return ret;
+    return dnf_repo_download_repo_packages(repo_to_packages, directory, state, package_done,
+                                           error);
 } CATCH_TO_GERROR(FALSE)
 
 /**
@@ -165,6 +165,8 @@ void             dnf_repo_set_metadata_expire   (DnfRepo              *repo,
                                                  guint                 metadata_expire);
 gboolean         dnf_repo_setup                 (DnfRepo              *repo,
                                                  GError              **error);
+gboolean         dnf_repo_setup_lazy            (DnfRepo              *repo,
+                                                 GError              **error);
 
 /* object methods */
 gboolean         dnf_repo_check                 (DnfRepo              *repo,
@@ -201,6 +203,10 @@ gboolean         dnf_repo_download_packages     (DnfRepo              *repo,
                                                  const gchar          *directory,
                                                  DnfState             *state,
                                                  GError              **error);
+gboolean         dnf_repo_download_packages_multi (GPtrArray          *pkgs,
+                                                 const gchar          *directory,
+                                                 DnfState             *state,
+                                                 GError              **error);
 
 HyRepo dnf_repo_get_hy_repo(DnfRepo *repo);
 #endif
@@ -23,6 +23,8 @@
 
 #include "dnf-repo.h"
 
+#include <functional>
+
 inline DnfRepoEnabled operator|(DnfRepoEnabled a, DnfRepoEnabled b)
 {
     return static_cast<DnfRepoEnabled>(static_cast<int>(a) | static_cast<int>(b));
@@ -33,5 +35,13 @@ inline DnfRepoEnabled & operator|=(DnfRepoEnabled & a, DnfRepoEnabled b)
     return a = a | b;
 }
 
+/* called on the downloading thread for every package whose file is complete */
+using DnfRepoPackageDoneFunc = std::function<void(DnfPackage *pkg)>;
+
+gboolean dnf_repo_download_packages_multi_full(GPtrArray *packages,
+                                               const gchar *directory,
+                                               DnfState *state,
+                                               const DnfRepoPackageDoneFunc *package_done,
+                                               GError **error);
 
 #endif /* __DNF_REPO_HPP */
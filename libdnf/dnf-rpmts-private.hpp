@@ -30,5 +30,15 @@ gboolean         dnf_rpmts_add_install_filename2(rpmts           ts,
                                                  gboolean        is_update,
                                                  DnfPackage     *pkg,
                                                  GError         **error);
+/* like dnf_rpmts_add_install_filename2() for a header already read with rpmReadPackageFile(),
+ * @res being its result; @hdr is not consumed */
+gboolean         dnf_rpmts_add_install_header   (rpmts           ts,
+                                                 const gchar    *filename,
+                                                 Header          hdr,
+                                                 gint            res,
+                                                 gboolean        allow_untrusted,
+                                                 gboolean        is_update,
+                                                 DnfPackage     *pkg,
+                                                 GError         **error);
 
 #endif /* __DNF_RPMTS_PRIVATE_HPP */
@@ -36,6 +36,9 @@
 #include <rpm/rpmlog.h>
 #include <rpm/rpmdb.h>
 
+#include <unordered_map>
+#include <vector>
+
 #include "catch-error.hpp"
 #include "sack/packageset.hpp"
 #include "hy-package-private.hpp"
@@ -96,14 +99,32 @@ dnf_rpmts_add_install_filename2(rpmts ts,
                                 DnfPackage * pkg,
                                 GError **error) try
 {
-    gboolean ret = TRUE;
+    gboolean ret;
     gint res;
-    Header hdr;
+    Header hdr = NULL;
     FD_t fd;
 
     /* open this */
     fd = Fopen(filename, "r.ufdio");
     res = rpmReadPackageFile(ts, fd, filename, &hdr);
+    ret = dnf_rpmts_add_install_header(ts, filename, hdr, res, allow_untrusted, is_update, pkg,
+                                       error);
+    Fclose(fd);
+    headerFree(hdr);
+    return ret;
+} CATCH_TO_GERROR(FALSE)
+
+gboolean
+dnf_rpmts_add_install_header(rpmts ts,
+                             const gchar *filename,
+                             Header hdr,
+                             gint res,
+                             gboolean allow_untrusted,
+                             gboolean is_update,
+                             DnfPackage * pkg,
+                             GError **error) try
+{
+    gboolean ret = TRUE;
 
     /* be less strict when we're allowing untrusted transactions */
     if (allow_untrusted) {
@@ -195,8 +216,6 @@ dnf_rpmts_add_install_filename2(rpmts ts,
         goto out;
     }
 out:
-    Fclose(fd);
-    headerFree(hdr);
     return ret;
 } CATCH_TO_GERROR(FALSE)
 
@@ -407,3 +426,96 @@ out:
         headerFree(hdr);
     return ret;
 } CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_rpmts_add_remove_pkgs:
+ * @ts: a #rpmts instance.
+ * @pkgs: (element-type DnfPackage): installed packages.
+ * @error: a #GError or %NULL..
+ *
+ * Adds to the transaction all the packages to be removed, reading their
+ * headers with a single rpmdb iterator.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_rpmts_add_remove_pkgs(rpmts ts, GPtrArray *pkgs, GError **error) try
+{
+    gboolean ret = TRUE;
+    gint retval;
+    Header hdr;
+    rpmdbMatchIterator iter;
+    std::vector<unsigned int> offsets;
+    std::unordered_map<unsigned int, DnfPackage *> by_offset;
+    g_autoptr(GString) rpm_error = NULL;
+
+    if (pkgs->len == 0)
+        return TRUE;
+
+    /* find packages by db-id */
+    offsets.reserve(pkgs->len);
+    for (guint i = 0; i < pkgs->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(pkgs, i));
+        unsigned int recOffset = dnf_package_get_rpmdbid(pkg);
+        if (by_offset.emplace(recOffset, pkg).second)
+            offsets.push_back(recOffset);
+    }
+    rpmlogSetCallback(dnf_rpmts_log_handler_cb, &rpm_error);
+    iter = rpmtsInitIterator(ts, RPMDBI_PACKAGES, &offsets[0], sizeof(offsets[0]));
+    rpmlogSetCallback(NULL, NULL);
+    if (iter == NULL) {
+        ret = FALSE;
+        if (rpm_error != NULL) {
+            g_set_error_literal(error,
+                                DNF_ERROR,
+                                DNF_ERROR_UNFINISHED_TRANSACTION,
+                                rpm_error->str);
+        } else {
+            g_set_error_literal(error,
+                                DNF_ERROR,
+                                DNF_ERROR_UNFINISHED_TRANSACTION,
+                                _("Fatal error, run database recovery"));
+        }
+        goto out;
+    }
+    if (offsets.size() > 1)
+        rpmdbAppendIterator(iter, &offsets[1], offsets.size() - 1);
+
+    /* remove them */
+    while ((hdr = rpmdbNextIterator(iter)) != NULL) {
+        auto it = by_offset.find(rpmdbGetIteratorOffset(iter));
+        if (it == by_offset.end())
+            continue;
+        retval = rpmtsAddEraseElement(ts, hdr, -1);
+        if (retval != 0) {
+            ret = FALSE;
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("could not add erase element %1$s(%2$i)"),
+                        dnf_package_get_name(it->second), retval);
+            goto out;
+        }
+        by_offset.erase(it);
+    }
+
+    /* any package left was not in the rpmdb */
+    for (guint i = 0; i < pkgs->len && !by_offset.empty(); i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(pkgs, i));
+        if (by_offset.count(dnf_package_get_rpmdbid(pkg)) > 0) {
+            ret = FALSE;
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_FILE_NOT_FOUND,
+                        _("failed to find package %s"),
+                        dnf_package_get_name(pkg));
+            break;
+        }
+    }
+out:
+    if (iter != NULL)
+        rpmdbFreeIterator(iter);
+    return ret;
+} CATCH_TO_GERROR(FALSE)
@@ -36,6 +36,9 @@ gboolean         dnf_rpmts_add_install_filename (rpmts           ts,
 gboolean         dnf_rpmts_add_remove_pkg       (rpmts           ts,
                                                  DnfPackage *      pkg,
                                                  GError         **error);
+gboolean         dnf_rpmts_add_remove_pkgs      (rpmts           ts,
+                                                 GPtrArray      *pkgs,
+                                                 GError         **error);
 gboolean         dnf_rpmts_look_for_problems    (rpmts           ts,
                                                  GError         **error);
 
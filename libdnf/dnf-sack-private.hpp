@@ -23,17 +23,77 @@
 
 #include <stdio.h>
 #include <solv/pool.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "dnf-sack.h"
 #include "hy-query.h"
+#include "sack/packageattrs.hpp"
 #include "sack/packageset.hpp"
 #include "sack/query.hpp"
 #include "module/ModulePackage.hpp"
 #include "module/ModulePackageContainer.hpp"
 
+namespace libdnf {
+struct AdvisoryIndex;
+class SubstringIndex;
+struct Nevra;
+
+/// The parts of an evr as split by split_evr(), see dnf_sack_get_split_evr()
+struct SplitEvr {
+    std::string version;
+    std::string release;
+    bool hasRelease;
+    /// The version has no ':' and the release no '-', so that their comparison with a value
+    /// without those characters is a plain solv_vercmp()
+    bool plainVersion;
+    bool plainRelease;
+};
+}
+
 typedef Id  (*dnf_sack_running_kernel_fn_t) (DnfSack    *sack);
 
+/**
+ * @brief Tells whether the rpmdb changed since it was loaded into the sack, always true when
+ *        the rpmdb has no cookie to compare
+ */
+bool dnf_sack_system_repo_is_stale(DnfSack *sack);
+
+/**
+ * @brief Tells whether the metadata of a repo loaded into the sack changed on disk since, false
+ *        for repos not loaded into the sack
+ *
+ * @param hrepo the current HyRepo of the repo, see dnf_repo_get_repo()
+ */
+bool dnf_sack_repo_is_stale(DnfSack *sack, HyRepo hrepo);
+
+/**
+ * @brief Hex checksum of the metadata the repo was loaded from, of the rpmdb cookie for the
+ *        system repo, empty when it is not known
+ */
+std::string dnf_sack_get_repo_checksum(DnfSack *sack, Repo *repo);
+
+/**
+ * @brief Same as dnf_sack_add_repos(), calling before_load once the repos are checked and, with
+ *        DNF_SACK_ADD_FLAG_PARALLEL, their solv caches built, right before the first repo is
+ *        loaded into the pool. Work that fills the pool itself may overlap the checks until then.
+ *
+ * @param before_load called at most once, loading fails when it returns FALSE; may be empty
+ * @return gboolean
+ */
+gboolean dnf_sack_add_repos_full(DnfSack *sack, GPtrArray *repos, guint permissible_cache_age,
+                                 DnfSackAddFlags flags, DnfState *state,
+                                 const std::function<gboolean(GError **)> & before_load,
+                                 GError **error);
+
+/* name of the whatprovides index cache file in the sack cache directory */
+#define DNF_SACK_WHATPROVIDES_CACHE_FN "@whatprovides.cache"
+/* prefix of the substring index cache files, followed by the name of the indexed key */
+#define DNF_SACK_SUBSTRING_CACHE_FN_PREFIX "@substring-"
+
 /**
  * @brief Store Map with only pkg_solvables to increase query performance
  *
@@ -59,10 +119,215 @@ int dnf_sack_get_pool_nsolvables(DnfSack *sack);
  * @return Map*
  */
 libdnf::PackageSet *dnf_sack_get_pkg_solvables(DnfSack *sack);
+/**
+ * @brief Returns the range of ids of all solvables with the given name. The index behind it is
+ *        built on the first call and owned by the sack, the range is valid until solvables
+ *        are added to the pool.
+ *
+ * @param sack p_sack:...
+ * @param name Id of the name string
+ * @return std::pair<const Id *, const Id *> begin and end of the range
+ */
+std::pair<const Id *, const Id *> dnf_sack_solvables_with_name(DnfSack *sack, Id name);
+
+/**
+ * @brief Returns the map of all solvables of the repo with the given repoid, for filtering by
+ *        repo with a single map operation. The maps of all repos are built on the first call and
+ *        owned by the sack, they are valid until solvables or repos are added or removed.
+ *        Returns nullptr for an unknown repoid.
+ */
+const Map * dnf_sack_get_repo_solvables(DnfSack *sack, Id repoid);
+
+/**
+ * @brief Returns the value of a numeric attribute for every solvable of the pool, indexed by the
+ *        solvable id, 0 for ids without a value. Each column is built from the repodata on the
+ *        first call and kept by the sack until solvables are added.
+ *
+ * @param attr an attribute of libdnf::PackageAttrType::NUMBER, otherwise std::runtime_error
+ */
+const std::vector<unsigned long long> & dnf_sack_get_num_column(DnfSack *sack,
+                                                                libdnf::PackageAttr attr);
+
+/**
+ * @brief Returns the distinct names of all solvables ordered by strcmp() of their strings, for
+ *        range scans of names with a given prefix. Rebuilt after solvables are added.
+ */
+const std::vector<Id> & dnf_sack_get_sorted_names(DnfSack *sack);
+
+/**
+ * @brief Appends to names the Ids of the solvable names equal to match, or containing it if
+ *        substr is true, both without regard to case as strcasecmp() and strcasestr() compare.
+ *        The lowercase names are kept in a single buffer until solvables are added.
+ */
+void dnf_sack_get_icase_names(DnfSack *sack, const char *match, bool substr,
+                              std::vector<Id> & names);
+
+/**
+ * @brief Returns the range of ids of all solvables with the given arch. See
+ *        dnf_sack_solvables_with_name().
+ */
+std::pair<const Id *, const Id *> dnf_sack_solvables_with_arch(DnfSack *sack, Id arch);
+
+/**
+ * @brief Returns the index of advisories used by advisory filters. It is built on the first call
+ *        and owned by the sack, the reference is valid until solvables are added to the pool.
+ */
+const libdnf::AdvisoryIndex & dnf_sack_get_advisory_index(DnfSack *sack);
+
+/**
+ * @brief Returns the trigram index of the SOLVABLE_SUMMARY, SOLVABLE_DESCRIPTION or SOLVABLE_URL
+ *        strings of all solvables, or nullptr if the key is not indexed or the index is disabled
+ *        by dnf_sack_set_use_substring_index(). The index is built or loaded from the cache
+ *        directory on the first call and kept by the sack until solvables are added.
+ */
+const libdnf::SubstringIndex * dnf_sack_get_substring_index(DnfSack *sack, Id keyname);
+
+/* all solvables in the order of a latest filter, see dnf_sack_get_latest_order() */
+struct DnfSackLatestOrder {
+    std::vector<Id> ids;
+    std::vector<Id> ranks;          /* position of each solvable id in ids, -1 if not there */
+};
+
+/**
+ * @brief Returns all solvables sorted the way HY_PKG_LATEST, HY_PKG_LATEST_PER_ARCH or
+ *        HY_PKG_LATEST_PER_ARCH_BY_PRIORITY given as keyname group them: by name, by arch for the
+ *        per arch filters, by descending repo priority for the latter, then by descending evr.
+ *        Kept by the sack until solvables are added, the order by priority also until a repo
+ *        priority changes.
+ */
+const DnfSackLatestOrder & dnf_sack_get_latest_order(DnfSack *sack, int keyname);
+
+/**
+ * @brief Returns the ids of all solvables with some obsoletes in ascending order. Built on the
+ *        first call and kept by the sack until solvables are added.
+ */
+const std::vector<Id> & dnf_sack_solvables_with_obsoletes(DnfSack *sack);
+
+/**
+ * @brief Returns the ids of the solvables with a dependency of the keyname, e.g.
+ *        SOLVABLE_REQUIRES, named name, in ascending order. The name 0 returns the solvables
+ *        with rich or other dependencies that are not just a name with an optional version
+ *        relation, these may match any name. Each keyname is indexed on its first call and
+ *        kept by the sack until solvables are added.
+ */
+std::pair<const Id *, const Id *> dnf_sack_solvables_with_dep_name(DnfSack *sack, Id keyname,
+                                                                   Id name);
+
+/**
+ * @brief Returns the ids of the solvables built from the sourcerpm, e.g. "penny-4-1.src.rpm",
+ *        or with the location, in ascending order, NULL if there are none. Either index is
+ *        built on its first call and kept by the sack until solvables are added.
+ */
+const std::vector<Id> * dnf_sack_solvables_with_sourcerpm(DnfSack *sack, const char *sourcerpm);
+const std::vector<Id> * dnf_sack_solvables_with_location(DnfSack *sack, const char *location);
+
+/**
+ * @brief what_upgrades() and what_downgrades() of an available solvable, remembered by the sack
+ *        until solvables are added. The whatprovides index has to be ready.
+ */
+Id dnf_sack_what_upgrades(DnfSack *sack, Id p);
+Id dnf_sack_what_downgrades(DnfSack *sack, Id p);
+
+/**
+ * @brief Returns the map of reldep strings to the reldep Ids they were parsed into, used by
+ *        Dependency::getReldepId(). The Ids stay valid for the whole lifetime of the sack.
+ */
+std::unordered_map<std::string, Id> & dnf_sack_get_reldep_cache(DnfSack *sack);
+
+/**
+ * @brief Nevra::parse() with the results remembered by the sack, for subjects parsed
+ *        repeatedly. The nevra is left untouched when the string doesn't match the form.
+ */
+bool dnf_sack_parse_nevra(DnfSack *sack, const char *nevraStr, HyForm form, libdnf::Nevra & nevra);
+
+/**
+ * @brief Returns the description of an advisory whose repo was loaded with
+ *        DNF_SACK_LOAD_FLAG_SLIM_UPDATEINFO. The descriptions of the repo are read from its
+ *        updateinfo metadata on the first call and kept by the repo. Returns NULL if unavailable.
+ */
+const char * dnf_sack_get_slim_advisory_description(DnfSack *sack, Id advisory);
+
+/**
+ * @brief Returns a counter increased by every change of the sack that can change query results
+ */
+guint64 dnf_sack_get_generation(DnfSack *sack);
+
+/**
+ * @brief Returns the cached result of a query with the given key or nullptr. Only used when
+ *        enabled by dnf_sack_set_use_query_cache().
+ */
+const libdnf::PackageSet *dnf_sack_query_cache_lookup(DnfSack *sack, const std::string & key);
+void dnf_sack_query_cache_store(DnfSack *sack, const std::string & key,
+                                const libdnf::PackageSet & result);
+
+/**
+ * @brief Returns a new reference to the living package object of the solvable or nullptr. Only
+ *        used when enabled by dnf_sack_set_use_package_cache().
+ */
+DnfPackage *dnf_sack_package_cache_lookup(DnfSack *sack, Id id);
+void dnf_sack_package_cache_store(DnfSack *sack, DnfPackage *pkg);
+
+/**
+ * @brief Returns the version part of the given evr as prepared by dnf_sack_freeze() or nullptr
+ *        if the sack is not frozen.
+ */
+const char *dnf_sack_get_frozen_version(DnfSack *sack, Id evr);
+
+/**
+ * @brief Returns the split form of the given evr, parsed once and kept by the sack. A frozen
+ *        sack only knows the evrs of its packages, nullptr is returned for others.
+ */
+const libdnf::SplitEvr *dnf_sack_get_split_evr(DnfSack *sack, Id evr);
+
+/**
+ * @brief Returns the packages with the given names, e.g. the protected_packages of the main
+ *        config. The result is kept until the sack changes or other names are asked for.
+ */
+const libdnf::PackageSet *dnf_sack_get_protected_pkgs(DnfSack *sack,
+                                                      const std::vector<std::string> & names);
+
+/**
+ * @brief Returns the unneeded packages stored by dnf_sack_unneeded_cache_store() for the same
+ *        user installed packages or nullptr. Changes of the sack or of the installonly settings
+ *        invalidate the stored result.
+ */
+const libdnf::PackageSet *dnf_sack_unneeded_cache_lookup(DnfSack *sack,
+                                                         const libdnf::PackageSet & userInstalled);
+void dnf_sack_unneeded_cache_store(DnfSack *sack, const libdnf::PackageSet & userInstalled,
+                                   const libdnf::PackageSet & unneeded);
+
 libdnf::ModulePackageContainer * dnf_sack_set_module_container(
     DnfSack *sack, libdnf::ModulePackageContainer * newConteiner);
 libdnf::ModulePackageContainer * dnf_sack_get_module_container(DnfSack *sack);
 void         dnf_sack_make_provides_ready   (DnfSack    *sack);
+/**
+ * @brief Load again the extensions dropped by dnf_sack_unload_repo_exts() before they are accessed
+ *
+ * @param repo the repo whose extensions are needed, nullptr for all repos
+ * @param flags DNF_SACK_LOAD_FLAG_USE_* of the needed extensions
+ */
+void         dnf_sack_reload_unloaded_exts  (DnfSack    *sack,
+                                             Repo       *repo,
+                                             int         flags);
+/**
+ * @brief Load the file lists registered by DNF_SACK_LOAD_FLAG_LAZY_FILELISTS if dep needs them
+ *
+ * The primary metadata lists only the files in bin directories, /etc and /usr/lib/sendmail,
+ * a dependency on any other path can only be resolved by the file lists.
+ */
+void         dnf_sack_load_lazy_filelists   (DnfSack    *sack,
+                                             Id          dep);
+/**
+ * @brief Update the cached dnf_sack_get_rpmdb_version() after a transaction changed the rpmdb
+ *
+ * @param cookie_before rpmdbCookie() before the transaction, the cache is dropped on a mismatch
+ * @param installed the packages the transaction installed
+ * @param erased the installed packages the transaction erased
+ */
+void         dnf_sack_update_rpmdb_version  (DnfSack    *sack,
+                                             const char *cookie_before,
+                                             GPtrArray  *installed,
+                                             GPtrArray  *erased);
 Id           dnf_sack_running_kernel        (DnfSack    *sack);
 void         dnf_sack_recompute_considered_map  (DnfSack * sack, Map ** considered, libdnf::Query::ExcludeFlags flags);
 void         dnf_sack_recompute_considered  (DnfSack    *sack);
@@ -75,6 +340,8 @@ void         dnf_sack_set_running_kernel_fn (DnfSack    *sack,
                                              dnf_sack_running_kernel_fn_t fn);
 DnfPackage  *dnf_sack_add_cmdline_package_flags   (DnfSack *sack,
                             const char *fn, const int flags);
+GPtrArray   *dnf_sack_add_cmdline_packages_flags  (DnfSack *sack,
+                            const char *const *fns, const int flags);
 std::pair<std::vector<std::vector<std::string>>, libdnf::ModulePackageContainer::ModuleErrorType> dnf_sack_filter_modules_v2(
     DnfSack *sack, libdnf::ModulePackageContainer * moduleContainer, const char ** hotfixRepos,
     const char *install_root, const char * platformModule, bool updateOnly, bool debugSolver, bool applyObsoletes);
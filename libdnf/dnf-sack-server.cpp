@@ -0,0 +1,555 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/**
+ * SECTION:dnf-sack-server
+ * @short_description: Share a loaded sack with other processes
+ * @include: libdnf.h
+ * @stability: Unstable
+ *
+ * A #DnfSackServer holds a loaded and frozen sack and answers queries and
+ * goal resolutions of #DnfSackClient<!-- -->s connected over a Unix socket,
+ * so short-lived tools do not have to load the repos and the rpmdb
+ * themselves.
+ *
+ * The protocol is line based, a request is a tab separated line:
+ *
+ *   query&lt;TAB&gt;filter...
+ *   resolve&lt;TAB&gt;job...
+ *
+ * Query filters are name=, provides=, file=, arch=, repo=, subject= and the
+ * bare installed, available, upgrades and latest. Goal jobs are
+ * "install SPEC", "upgrade [SPEC]", "erase SPEC" and "distupgrade". The
+ * server replies with a line per package:
+ *
+ *   pkg&lt;TAB&gt;id&lt;TAB&gt;action&lt;TAB&gt;nevra&lt;TAB&gt;reponame
+ *
+ * terminated by "ok" or by "error&lt;TAB&gt;code&lt;TAB&gt;message", the code being a
+ * #DnfError. The requests are served one at a time.
+ *
+ * See also: #DnfSack
+ */
+
+#include <gio/gunixsocketaddress.h>
+#include <glib/gstdio.h>
+
+#include <solv/pool.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+
+#include "catch-error.hpp"
+#include "dnf-sack-server.h"
+#include "dnf-sack-private.hpp"
+#include "dnf-types.h"
+#include "goal/Goal.hpp"
+#include "hy-util.h"
+#include "sack/packageset.hpp"
+#include "sack/query.hpp"
+#include "utils/bgettext/bgettext-lib.h"
+
+/* clients connected at the same time, further ones wait for a free worker */
+#define DNF_SACK_SERVER_MAX_CLIENTS 16
+
+struct _DnfSackServer {
+    DnfSack *sack;
+    gchar *socket_path;
+    GSocket *socket;
+    std::mutex mutex;
+};
+
+struct _DnfSackClient {
+    GSocketConnection *connection;
+    GDataInputStream *input;
+};
+
+namespace {
+
+struct ServerConnection {
+    DnfSackServer *server;
+    GSocketConnection *connection;
+    GCancellable *cancellable;
+};
+
+}
+
+static void
+reply_packages(DnfSack *sack, const libdnf::PackageSet & pset, const char *action,
+               std::string & reply)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Id id = -1;
+    while ((id = pset.next(id)) != -1) {
+        Solvable *s = pool_id2solvable(pool, id);
+        reply += "pkg\t";
+        reply += std::to_string(id);
+        reply += '\t';
+        reply += action;
+        reply += '\t';
+        reply += pool_solvable2str(pool, s);
+        reply += '\t';
+        reply += s->repo->name;
+        reply += '\n';
+    }
+}
+
+static gboolean
+query_add_filter(libdnf::Query & query, const char *filter, GError **error)
+{
+    const char *value = strchr(filter, '=');
+    std::string key = value ? std::string(filter, value - filter) : filter;
+    int ret = 0;
+    if (value)
+        ++value;
+
+    if (!value && key == "installed") {
+        query.installed();
+    } else if (!value && key == "available") {
+        query.available();
+    } else if (!value && key == "upgrades") {
+        ret = query.addFilter(HY_PKG_UPGRADES, HY_EQ, 1);
+    } else if (!value && key == "latest") {
+        ret = query.addFilter(HY_PKG_LATEST_PER_ARCH, HY_EQ, 1);
+    } else if (value && key == "name") {
+        ret = query.addFilter(HY_PKG_NAME, HY_GLOB, value);
+    } else if (value && key == "provides") {
+        ret = query.addFilter(HY_PKG_PROVIDES, HY_GLOB, value);
+    } else if (value && key == "file") {
+        ret = query.addFilter(HY_PKG_FILE, HY_GLOB, value);
+    } else if (value && key == "arch") {
+        ret = query.addFilter(HY_PKG_ARCH, HY_EQ, value);
+    } else if (value && key == "repo") {
+        ret = query.addFilter(HY_PKG_REPONAME, HY_EQ, value);
+    } else if (value && key == "subject") {
+        query.filterSubject(value, nullptr, false, true, true, true);
+    } else {
+        g_set_error(error, DNF_ERROR, DNF_ERROR_BAD_QUERY, _("unknown query filter: %s"), filter);
+        return FALSE;
+    }
+    if (ret) {
+        g_set_error(error, DNF_ERROR, ret, _("invalid query filter: %s"), filter);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+goal_add_job(DnfSack *sack, libdnf::Goal & goal, const char *job, GError **error)
+{
+    const char *spec = strchr(job, ' ');
+    std::string action = spec ? std::string(job, spec - job) : job;
+    if (spec)
+        ++spec;
+
+    if (!spec && action == "upgrade") {
+        goal.upgrade();
+        return TRUE;
+    }
+    if (!spec && action == "distupgrade") {
+        goal.distupgrade();
+        return TRUE;
+    }
+    if (!spec || (action != "install" && action != "upgrade" && action != "erase")) {
+        g_set_error(error, DNF_ERROR, DNF_ERROR_BAD_SELECTOR, _("unknown goal job: %s"), job);
+        return FALSE;
+    }
+
+    libdnf::Query query(sack);
+    if (action == "erase")
+        query.installed();
+    else
+        query.available();
+    if (!query.filterSubject(spec, nullptr, false, true, true, true).first) {
+        g_set_error(error, DNF_ERROR, DNF_ERROR_PACKAGE_NOT_FOUND, _("no package matches: %s"),
+                    spec);
+        return FALSE;
+    }
+    if (action == "install")
+        goal.install(*query.getResultPset(), false);
+    else if (action == "upgrade")
+        goal.upgrade(*query.getResultPset());
+    else
+        goal.erase(*query.getResultPset());
+    return TRUE;
+}
+
+static gboolean
+server_handle_resolve(DnfSack *sack, gchar **args, std::string & reply, GError **error) try
+{
+    libdnf::Goal goal(sack);
+    for (gchar **job = args; *job; ++job)
+        if (!goal_add_job(sack, goal, *job, error))
+            return FALSE;
+
+    if (goal.run(DNF_NONE)) {
+        std::string msg;
+        for (int i = 0; i < goal.countProblems(); ++i)
+            for (auto & rule : goal.describeProblemRules(i, true)) {
+                if (!msg.empty())
+                    msg += "; ";
+                msg += rule;
+            }
+        g_set_error(error, DNF_ERROR, DNF_ERROR_NO_SOLUTION, _("no solution: %s"), msg.c_str());
+        return FALSE;
+    }
+    reply_packages(sack, goal.listInstalls(), "install", reply);
+    reply_packages(sack, goal.listUpgrades(), "upgrade", reply);
+    reply_packages(sack, goal.listDowngrades(), "downgrade", reply);
+    reply_packages(sack, goal.listReinstalls(), "reinstall", reply);
+    reply_packages(sack, goal.listErasures(), "erase", reply);
+    reply_packages(sack, goal.listObsoleted(), "obsoleted", reply);
+    return TRUE;
+} CATCH_TO_GERROR(FALSE)
+
+static gboolean
+server_handle_request(DnfSack *sack, const gchar *line, std::string & reply, GError **error) try
+{
+    g_auto(GStrv) args = g_strsplit(line, "\t", -1);
+
+    if (g_strcmp0(args[0], "query") == 0) {
+        libdnf::Query query(sack);
+        for (gchar **filter = args + 1; *filter; ++filter)
+            if (!query_add_filter(query, *filter, error))
+                return FALSE;
+        reply_packages(sack, *query.getResultPset(), "-", reply);
+        return TRUE;
+    }
+    if (g_strcmp0(args[0], "resolve") == 0)
+        return server_handle_resolve(sack, args + 1, reply, error);
+
+    g_set_error(error, DNF_ERROR, DNF_ERROR_FAILED, _("unknown request: %s"), args[0]);
+    return FALSE;
+} CATCH_TO_GERROR(FALSE)
+
+static void
+server_serve_connection_cb(gpointer data, gpointer)
+{
+    auto conn = static_cast<ServerConnection *>(data);
+    DnfSackServer *server = conn->server;
+    GInputStream *in = g_io_stream_get_input_stream(G_IO_STREAM(conn->connection));
+    GOutputStream *out = g_io_stream_get_output_stream(G_IO_STREAM(conn->connection));
+    g_autoptr(GDataInputStream) input = g_data_input_stream_new(in);
+    g_autoptr(GError) error_local = NULL;
+
+    while (true) {
+        g_autofree gchar *line = g_data_input_stream_read_line(input, NULL, conn->cancellable,
+                                                               &error_local);
+        if (!line)
+            break;
+        std::string reply;
+        {
+            std::lock_guard<std::mutex> guard(server->mutex);
+            g_autoptr(GError) error_request = NULL;
+            if (server_handle_request(server->sack, line, reply, &error_request)) {
+                reply += "ok\n";
+            } else {
+                /* the message has to fit on the line */
+                g_strdelimit(error_request->message, "\t\n", ' ');
+                reply = "error\t" + std::to_string(error_request->code) + "\t" +
+                    error_request->message + "\n";
+            }
+        }
+        if (!g_output_stream_write_all(out, reply.data(), reply.size(), NULL, conn->cancellable,
+                                       &error_local))
+            break;
+    }
+    if (error_local && !g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_debug("sack server connection closed: %s", error_local->message);
+    g_object_unref(conn->connection);
+    if (conn->cancellable)
+        g_object_unref(conn->cancellable);
+    delete conn;
+}
+
+/**
+ * dnf_sack_server_new:
+ * @sack: a loaded #DnfSack, it must outlive the server.
+ * @socket_path: the path of the Unix socket to listen on.
+ * @error: a #GError, or %NULL.
+ *
+ * Freezes the sack, see dnf_sack_freeze(), and binds the socket. A stale
+ * socket left at @socket_path is replaced. The access to the socket is given
+ * by the permissions of the file, set by the umask of the process.
+ *
+ * Returns: (transfer full): a new #DnfSackServer, or %NULL on error
+ *
+ * Since: 0.70.0
+ */
+DnfSackServer *
+dnf_sack_server_new(DnfSack *sack, const gchar *socket_path, GError **error)
+{
+    GStatBuf st;
+    if (g_lstat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode))
+        g_unlink(socket_path);
+
+    g_autoptr(GSocket) listener = g_socket_new(G_SOCKET_FAMILY_UNIX, G_SOCKET_TYPE_STREAM,
+                                               G_SOCKET_PROTOCOL_DEFAULT, error);
+    if (!listener)
+        return NULL;
+    g_autoptr(GSocketAddress) address = g_unix_socket_address_new(socket_path);
+    if (!g_socket_bind(listener, address, FALSE, error) || !g_socket_listen(listener, error))
+        return NULL;
+
+    dnf_sack_freeze(sack);
+    auto server = new DnfSackServer;
+    server->sack = sack;
+    server->socket_path = g_strdup(socket_path);
+    server->socket = static_cast<GSocket *>(g_steal_pointer(&listener));
+    return server;
+}
+
+/**
+ * dnf_sack_server_run:
+ * @server: a #DnfSackServer instance.
+ * @cancellable: a #GCancellable to stop the server, or %NULL.
+ * @error: a #GError, or %NULL.
+ *
+ * Accepts clients and answers their requests until @cancellable is
+ * cancelled. Returns after the connected clients are disconnected.
+ *
+ * Returns: %TRUE when stopped by @cancellable
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_server_run(DnfSackServer *server, GCancellable *cancellable, GError **error)
+{
+    GThreadPool *workers = g_thread_pool_new(server_serve_connection_cb, server,
+                                             DNF_SACK_SERVER_MAX_CLIENTS, FALSE, error);
+    if (!workers)
+        return FALSE;
+
+    gboolean ret = TRUE;
+    while (true) {
+        g_autoptr(GError) error_local = NULL;
+        g_autoptr(GSocket) client_socket = g_socket_accept(server->socket, cancellable,
+                                                           &error_local);
+        if (!client_socket) {
+            if (!g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+                g_propagate_error(error, static_cast<GError *>(g_steal_pointer(&error_local)));
+                ret = FALSE;
+            }
+            break;
+        }
+        auto conn = new ServerConnection;
+        conn->server = server;
+        conn->connection = g_socket_connection_factory_create_connection(client_socket);
+        conn->cancellable = cancellable ? static_cast<GCancellable *>(g_object_ref(cancellable)) : NULL;
+        if (!g_thread_pool_push(workers, conn, &error_local)) {
+            g_warning("failed to serve a sack client: %s", error_local->message);
+            g_object_unref(conn->connection);
+            if (conn->cancellable)
+                g_object_unref(conn->cancellable);
+            delete conn;
+        }
+    }
+    g_thread_pool_free(workers, FALSE, TRUE);
+    return ret;
+}
+
+/**
+ * dnf_sack_server_free:
+ * @server: a #DnfSackServer instance.
+ *
+ * Closes the socket and removes its file.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_server_free(DnfSackServer *server)
+{
+    if (!server)
+        return;
+    g_socket_close(server->socket, NULL);
+    g_object_unref(server->socket);
+    g_unlink(server->socket_path);
+    g_free(server->socket_path);
+    delete server;
+}
+
+/**
+ * dnf_sack_client_new:
+ * @socket_path: the socket of a #DnfSackServer.
+ * @error: a #GError, or %NULL.
+ *
+ * Connects to a sack server.
+ *
+ * Returns: (transfer full): a new #DnfSackClient, or %NULL on error
+ *
+ * Since: 0.70.0
+ */
+DnfSackClient *
+dnf_sack_client_new(const gchar *socket_path, GError **error)
+{
+    g_autoptr(GSocketClient) socket_client = g_socket_client_new();
+    g_autoptr(GSocketAddress) address = g_unix_socket_address_new(socket_path);
+    GSocketConnection *connection = g_socket_client_connect(socket_client,
+                                                            G_SOCKET_CONNECTABLE(address),
+                                                            NULL, error);
+    if (!connection)
+        return NULL;
+
+    auto client = g_new0(DnfSackClient, 1);
+    client->connection = connection;
+    client->input = g_data_input_stream_new(
+        g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+    return client;
+}
+
+static DnfSackClientPackage *
+client_parse_package(const gchar *line)
+{
+    g_auto(GStrv) fields = g_strsplit(line, "\t", 5);
+    if (g_strv_length(fields) != 5)
+        return NULL;
+    auto package = g_new0(DnfSackClientPackage, 1);
+    package->id = atoi(fields[1]);
+    package->action = g_strcmp0(fields[2], "-") == 0 ? NULL : g_strdup(fields[2]);
+    package->nevra = g_strdup(fields[3]);
+    package->reponame = g_strdup(fields[4]);
+    return package;
+}
+
+static GPtrArray *
+client_request(DnfSackClient *client, const gchar *request, const gchar *const *args,
+               GError **error)
+{
+    std::string line = request;
+    for (const gchar *const *arg = args; arg && *arg; ++arg) {
+        if (strpbrk(*arg, "\t\n")) {
+            g_set_error(error, DNF_ERROR, DNF_ERROR_FAILED,
+                        _("invalid argument of the sack server: %s"), *arg);
+            return NULL;
+        }
+        line += '\t';
+        line += *arg;
+    }
+    line += '\n';
+    GOutputStream *out = g_io_stream_get_output_stream(G_IO_STREAM(client->connection));
+    if (!g_output_stream_write_all(out, line.data(), line.size(), NULL, NULL, error))
+        return NULL;
+
+    g_autoptr(GPtrArray) packages = g_ptr_array_new_with_free_func(
+        reinterpret_cast<GDestroyNotify>(dnf_sack_client_package_free));
+    while (true) {
+        g_autofree gchar *reply = g_data_input_stream_read_line(client->input, NULL, NULL, error);
+        if (!reply) {
+            if (error && !*error)
+                g_set_error_literal(error, DNF_ERROR, DNF_ERROR_FAILED,
+                                    _("the sack server closed the connection"));
+            return NULL;
+        }
+        if (g_strcmp0(reply, "ok") == 0)
+            return static_cast<GPtrArray *>(g_steal_pointer(&packages));
+        if (g_str_has_prefix(reply, "error\t")) {
+            g_auto(GStrv) fields = g_strsplit(reply, "\t", 3);
+            int code = atoi(fields[1]);
+            g_set_error_literal(error, DNF_ERROR, code ? code : DNF_ERROR_FAILED,
+                                fields[1] && fields[2] ? fields[2] : reply);
+            return NULL;
+        }
+        auto package = g_str_has_prefix(reply, "pkg\t") ? client_parse_package(reply) : NULL;
+        if (!package) {
+            g_set_error(error, DNF_ERROR, DNF_ERROR_FAILED,
+                        _("invalid reply of the sack server: %s"), reply);
+            return NULL;
+        }
+        g_ptr_array_add(packages, package);
+    }
+}
+
+/**
+ * dnf_sack_client_query:
+ * @client: a #DnfSackClient instance.
+ * @filters: (array zero-terminated=1): the filters, e.g. "name=kernel" or "latest".
+ * @error: a #GError, or %NULL.
+ *
+ * Queries the sack of the server, see #DnfSackServer for the filters.
+ *
+ * Returns: (transfer container) (element-type DnfSackClientPackage): the matching packages, or %NULL on error
+ *
+ * Since: 0.70.0
+ */
+GPtrArray *
+dnf_sack_client_query(DnfSackClient *client, const gchar *const *filters, GError **error)
+{
+    return client_request(client, "query", filters, error);
+}
+
+/**
+ * dnf_sack_client_resolve:
+ * @client: a #DnfSackClient instance.
+ * @jobs: (array zero-terminated=1): the goal jobs, e.g. "install vim" or "upgrade".
+ * @error: a #GError, or %NULL.
+ *
+ * Resolves a goal in the sack of the server, see #DnfSackServer for the jobs.
+ * Fails with %DNF_ERROR_NO_SOLUTION describing the problems.
+ *
+ * Returns: (transfer container) (element-type DnfSackClientPackage): the packages of the transaction with their actions, or %NULL on error
+ *
+ * Since: 0.70.0
+ */
+GPtrArray *
+dnf_sack_client_resolve(DnfSackClient *client, const gchar *const *jobs, GError **error)
+{
+    return client_request(client, "resolve", jobs, error);
+}
+
+/**
+ * dnf_sack_client_free:
+ * @client: a #DnfSackClient instance.
+ *
+ * Disconnects from the server.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_client_free(DnfSackClient *client)
+{
+    if (!client)
+        return;
+    g_object_unref(client->input);
+    g_io_stream_close(G_IO_STREAM(client->connection), NULL, NULL);
+    g_object_unref(client->connection);
+    g_free(client);
+}
+
+/**
+ * dnf_sack_client_package_free:
+ * @package: a #DnfSackClientPackage.
+ *
+ * Frees a package returned by the client.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_client_package_free(DnfSackClientPackage *package)
+{
+    if (!package)
+        return;
+    g_free(package->action);
+    g_free(package->nevra);
+    g_free(package->reponame);
+    g_free(package);
+}
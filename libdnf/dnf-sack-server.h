@@ -0,0 +1,74 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __DNF_SACK_SERVER_H
+#define __DNF_SACK_SERVER_H
+
+#include <gio/gio.h>
+
+#include "dnf-sack.h"
+
+G_BEGIN_DECLS
+
+typedef struct _DnfSackServer DnfSackServer;
+typedef struct _DnfSackClient DnfSackClient;
+
+/**
+ * DnfSackClientPackage:
+ * @id:                 the solvable id of the package in the sack of the server
+ * @action:             the goal action of the package, e.g. "install", %NULL for queries
+ * @nevra:              the name-epoch:version-release.arch of the package
+ * @reponame:           the name of the repo of the package
+ *
+ * A package returned by the sack server.
+ **/
+typedef struct {
+    Id                   id;
+    gchar               *action;
+    gchar               *nevra;
+    gchar               *reponame;
+} DnfSackClientPackage;
+
+DnfSackServer *dnf_sack_server_new          (DnfSack            *sack,
+                                             const gchar        *socket_path,
+                                             GError            **error);
+gboolean     dnf_sack_server_run            (DnfSackServer      *server,
+                                             GCancellable       *cancellable,
+                                             GError            **error);
+void         dnf_sack_server_free           (DnfSackServer      *server);
+
+DnfSackClient *dnf_sack_client_new          (const gchar        *socket_path,
+                                             GError            **error);
+GPtrArray   *dnf_sack_client_query          (DnfSackClient      *client,
+                                             const gchar *const *filters,
+                                             GError            **error);
+GPtrArray   *dnf_sack_client_resolve        (DnfSackClient      *client,
+                                             const gchar *const *jobs,
+                                             GError            **error);
+void         dnf_sack_client_free           (DnfSackClient      *client);
+void         dnf_sack_client_package_free   (DnfSackClientPackage *package);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(DnfSackServer, dnf_sack_server_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(DnfSackClient, dnf_sack_client_free)
+
+G_END_DECLS
+
+#endif /* __DNF_SACK_SERVER_H */
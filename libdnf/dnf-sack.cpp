@@ -34,14 +34,29 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <condition_variable>
 #include <errno.h>
+#include <fcntl.h>
 #include <functional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <set>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
 
 extern "C" {
+#include <solv/chksum.h>
 #include <solv/evr.h>
 #include <solv/pool.h>
 #include <solv/poolarch.h>
@@ -55,6 +70,9 @@ extern "C" {
 #include <solv/repo_write.h>
 #include <solv/solv_xfopen.h>
 #include <solv/solver.h>
+
+#include <rpm/rpmdb.h>
+#include <rpm/rpmts.h>
 }
 
 #include <cstring>
@@ -72,7 +90,10 @@ extern "C" {
 
 #include "utils/bgettext/bgettext-lib.h"
 
+#include "sack/advisoryindex.hpp"
+#include "sack/packageattrs.hpp"
 #include "sack/query.hpp"
+#include "sack/substringindex.hpp"
 #include "nevra.hpp"
 #include "conf/ConfigParser.hpp"
 #include "conf/OptionBool.hpp"
@@ -81,6 +102,8 @@ extern "C" {
 #include "repo/Repo-private.hpp"
 #include "repo/solvable/DependencyContainer.hpp"
 #include "utils/File.hpp"
+#include "utils/PhaseTimer.hpp"
+#include "utils/probes.hpp"
 #include "utils/utils.hpp"
 #include "log.hpp"
 #include "tinyformat/tinyformat.hpp"
@@ -89,6 +112,133 @@ extern "C" {
 #define DEFAULT_CACHE_ROOT "/var/cache/hawkey"
 #define DEFAULT_CACHE_USER "/var/tmp/hawkey"
 
+/* solvable ids grouped by the value of one Solvable member, e.g. the name */
+struct SolvableIndex {
+    std::vector<Offset> starts;     /* ids of key k are ids[starts[k]] .. ids[starts[k + 1] - 1] */
+    std::vector<Id> ids;
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+};
+
+/* distinct names of the solvables ordered by their strings, see dnf_sack_get_sorted_names() */
+struct SortedNames {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::vector<Id> names;
+};
+
+/* lowercase copies of the distinct solvable names, see dnf_sack_get_icase_names() */
+struct FoldedNames {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::string text;               /* the folded names in their order, each followed by '\0' */
+    std::vector<size_t> starts;     /* offset of each folded name in text */
+    std::vector<Id> names;          /* name Id of each folded name */
+};
+
+/* trigram indexes of solvable strings by the key, see dnf_sack_get_substring_index() */
+struct SubstringIndexes {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::unordered_map<Id, libdnf::SubstringIndex> byKey;
+};
+
+/* result of the last autoremove solve and everything it depends on besides the sack itself */
+struct UnneededCache {
+    libdnf::PackageSet userInstalled;
+    libdnf::PackageSet unneeded;
+    std::vector<Id> installonly;
+    guint installonlyLimit;
+};
+
+/* results of Nevra::parse() keyed by the form followed by the parsed string */
+typedef std::unordered_map<std::string, std::pair<bool, libdnf::Nevra>> NevraParseCache;
+#define NEVRA_PARSE_CACHE_MAX_SIZE 4096
+
+/* numbers of all solvables indexed by the solvable id, see dnf_sack_get_num_column() */
+struct NumColumns {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::vector<std::vector<unsigned long long>> byAttr; /* empty until the attr is requested */
+};
+
+/* solvables of every repo by the repoid, see dnf_sack_get_repo_solvables() */
+struct RepoSolvables {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    int nrepos;                     /* pool->nrepos at the time of creation */
+    std::vector<libdnf::PackageSet> repos;
+};
+
+/* solvables in the orders of the latest filters, see dnf_sack_get_latest_order() */
+struct LatestOrders {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    DnfSackLatestOrder orders[3];   /* HY_PKG_LATEST, _PER_ARCH and _PER_ARCH_BY_PRIORITY */
+    std::vector<int> priorities;    /* repo priorities the by priority order was sorted with */
+};
+
+/* solvables with some obsoletes, see dnf_sack_solvables_with_obsoletes() */
+struct ObsoletersIndex {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::vector<Id> ids;
+};
+
+/* solvables by the names their dependencies of one key mention, see dnf_sack_solvables_with_dep_name() */
+struct DepNameIndexes {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::unordered_map<Id, SolvableIndex> byKey;
+};
+
+/* solvables by a string composed from them, see dnf_sack_solvables_with_sourcerpm() */
+struct StringKeyIndex {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    std::unordered_map<std::string, std::vector<Id>> ids;
+};
+
+/* what_upgrades() and what_downgrades() of available solvables, see dnf_sack_what_upgrades() */
+struct UpdownTable {
+    int nsolvables;                 /* pool->nsolvables at the time of creation */
+    Repo *installed;
+    std::vector<Id> upgrades;       /* -1 until computed */
+    std::vector<Id> downgrades;
+};
+
+/* order independent sum of the installed packages, see dnf_sack_get_rpmdb_version() */
+struct RpmdbVersion {
+    std::string cookie;             /* rpmdbCookie() the sum was computed for */
+    guint count;
+    unsigned char sum[CHKSUM_BYTES];
+};
+
+/* inputs of the last setModuleExcludes() pass which are not covered by the sack generation */
+struct ModuleExcludesState {
+    const libdnf::ModulePackageContainer *container;
+    std::vector<Id> activeModules;
+    std::vector<std::string> hotfixRepos;
+    guint64 generation;             /* generation right after the module excludes were set */
+};
+
+/* Pool Ids of a module artifact NEVRA; evr and arch are 0 when unknown to the pool */
+struct ArtifactNevra {
+    Id name;
+    Id evr;
+    Id arch;
+    bool operator==(const ArtifactNevra & other) const
+    {
+        return name == other.name && evr == other.evr && arch == other.arch;
+    }
+};
+
+/* module artifacts parsed into Ids of the main pool, by the Id of the module in the module pool */
+struct ModuleArtifactIds {
+    const libdnf::ModulePackageContainer *container;
+    int nstrings;                   /* pool->ss.nstrings, unknown strings may exist now */
+    std::unordered_map<Id, std::vector<ArtifactNevra>> byModule;
+};
+
+/* solv cache files serialized in memory and written by a background thread in the queued order,
+ * see DNF_SACK_LOAD_FLAG_BACKGROUND_CACHE */
+struct CacheWriter {
+    GThreadPool *thread;
+    std::mutex mutex;
+    std::condition_variable written;
+    std::multiset<std::string> pending;     /* target file names of the queued writes */
+};
+
 typedef struct
 {
     Id                   running_kernel_id;
@@ -98,6 +248,7 @@ typedef struct
     Map                 *module_excludes;
     Map                 *module_includes;   /* To fast identify enabled modular packages */
     Map                 *pkg_solvables;     /* Map representing only solvable pkgs of query */
+    Map                 *includes_unused;   /* Solvables of repos not using includes */
     int                  pool_nsolvables;   /* Number of nsolvables for creation of pkg_solvables*/
     Pool                *pool;
     Queue                installonly;
@@ -108,10 +259,45 @@ typedef struct
     gboolean             provides_ready;
     gboolean             allow_vendor_change;
     gchar               *cache_dir;
+    gchar               *shared_cache_dir;  /* See dnf_sack_set_shared_cachedir() */
     char                *arch;
     dnf_sack_running_kernel_fn_t  running_kernel_fn;
     guint                installonly_limit;
+    guint                repomd_stat_max_age; /* seconds, 0 to always hash repomd.xml */
     libdnf::ModulePackageContainer * moduleContainer;
+    SolvableIndex       *name_index;        /* Built lazily, dropped when solvables are added */
+    SortedNames         *sorted_names;      /* Built lazily, dropped when solvables are added */
+    FoldedNames         *folded_names;      /* Built lazily, dropped when solvables are added */
+    SolvableIndex       *arch_index;
+    RepoSolvables       *repo_solvables;    /* Built lazily, dropped when solvables are added */
+    NumColumns          *num_columns;       /* Built lazily, dropped when solvables are added */
+    libdnf::AdvisoryIndex *advisory_index;  /* Built lazily, dropped when solvables are added */
+    guint64              generation;        /* Bumped whenever query results may change */
+    gboolean             use_query_cache;
+    std::unordered_map<std::string, libdnf::PackageSet> *query_cache;
+    gboolean             use_substring_index;
+    SubstringIndexes    *substring_indexes; /* Built lazily, dropped when solvables are added */
+    gboolean             frozen;            /* Lazy state prepared, see dnf_sack_freeze() */
+    gboolean             huge_pages;        /* See DNF_SACK_SETUP_FLAG_HUGE_PAGES */
+    std::unordered_map<Id, libdnf::SplitEvr> *split_evrs; /* Evr strings never change, kept for the sack lifetime */
+    libdnf::PackageSet  *protected_pkgs;    /* Packages of protected_names, dropped on changes */
+    std::vector<std::string> *protected_names;
+    UnneededCache       *unneeded_cache;    /* Dropped on changes, see dnf_sack_unneeded_cache_lookup() */
+    ModuleExcludesState *module_excludes_state; /* Dropped when module metadata is reloaded */
+    ModuleArtifactIds   *module_artifact_ids; /* Dropped when module metadata is reloaded */
+    UpdownTable         *updown_table;      /* Built lazily, dropped when solvables are added */
+    ObsoletersIndex     *obsoleters;        /* Built lazily, dropped when solvables are added */
+    DepNameIndexes      *dep_name_indexes;  /* Built lazily, dropped when solvables are added */
+    StringKeyIndex      *sourcerpm_index;   /* Built lazily, dropped when solvables are added */
+    StringKeyIndex      *location_index;    /* Built lazily, dropped when solvables are added */
+    LatestOrders        *latest_orders;     /* Built lazily, dropped when solvables are added */
+    std::unordered_map<std::string, Id> *reldep_cache; /* Pool Ids are never freed, kept for the sack lifetime */
+    NevraParseCache     *nevra_cache;       /* Independent on the sack content, see dnf_sack_parse_nevra() */
+    CacheWriter         *cache_writer;      /* Created by the first background cache write */
+    std::unordered_map<std::string, Id> *package_id_index; /* Built lazily, dropped when solvables are added */
+    gboolean             use_package_cache;
+    GHashTable          *package_cache;     /* Weak #DnfPackage wrappers by Id, created on first use */
+    RpmdbVersion        *rpmdb_version;     /* Keyed by the rpmdb cookie, see dnf_sack_get_rpmdb_version() */
 } DnfSackPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(DnfSack, dnf_sack, G_TYPE_OBJECT)
@@ -130,6 +316,12 @@ dnf_sack_finalize(GObject *object)
     Repo *repo;
     int i;
 
+    dnf_sack_set_use_package_cache(sack, FALSE);
+    if (priv->cache_writer) {
+        /* the pending cache writes are finished, they do not use the pool */
+        g_thread_pool_free(priv->cache_writer->thread, FALSE, TRUE);
+        delete priv->cache_writer;
+    }
     FOR_REPOS(i, repo) {
         auto hrepo = static_cast<HyRepo>(repo->appdata);
         if (!hrepo)
@@ -137,6 +329,7 @@ dnf_sack_finalize(GObject *object)
         libdnf::repoGetImpl(hrepo)->detachLibsolvRepo();
     }
     g_free(priv->cache_dir);
+    g_free(priv->shared_cache_dir);
     g_free(priv->arch);
     queue_free(&priv->installonly);
 
@@ -147,10 +340,36 @@ dnf_sack_finalize(GObject *object)
     free_map_fully(priv->module_includes);
     free_map_fully(pool->considered);
     free_map_fully(priv->pkg_solvables);
+    free_map_fully(priv->includes_unused);
     pool_free(priv->pool);
     if (priv->moduleContainer) {
         delete priv->moduleContainer;
     }
+    delete priv->name_index;
+    delete priv->sorted_names;
+    delete priv->folded_names;
+    delete priv->arch_index;
+    delete priv->repo_solvables;
+    delete priv->num_columns;
+    delete priv->advisory_index;
+    delete priv->query_cache;
+    delete priv->substring_indexes;
+    delete priv->split_evrs;
+    delete priv->protected_pkgs;
+    delete priv->protected_names;
+    delete priv->unneeded_cache;
+    delete priv->module_excludes_state;
+    delete priv->module_artifact_ids;
+    delete priv->reldep_cache;
+    delete priv->nevra_cache;
+    delete priv->updown_table;
+    delete priv->obsoleters;
+    delete priv->dep_name_indexes;
+    delete priv->sourcerpm_index;
+    delete priv->location_index;
+    delete priv->latest_orders;
+    delete priv->package_id_index;
+    delete priv->rpmdb_version;
 
     G_OBJECT_CLASS(dnf_sack_parent_class)->finalize(object);
 }
@@ -224,11 +443,273 @@ dnf_sack_new(void)
     return DNF_SACK(g_object_new(DNF_TYPE_SACK, NULL));
 }
 
-// Try to load cached solv file into repo otherwise return FALSE
+// Open solv file fd for reading through a read-only shared mapping of the whole file. This saves
+// the read() calls and the stdio buffer, repo_add_solv() still copies the data into the pool.
+// The returned stream owns the mapping, it is unmapped by solv_mmap_fclose(). The fd stays open.
+static FILE *
+solv_mmap_fdopen(int fd, void **addr, size_t *length)
+{
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        return NULL;
+    // repo_add_solv() reads the file from the begining to the end, the advice values are not flags
+    if (madvise(map, st.st_size, MADV_SEQUENTIAL))
+        g_debug("madvise(MADV_SEQUENTIAL) failed: %s", strerror(errno));
+    if (madvise(map, st.st_size, MADV_WILLNEED))
+        g_debug("madvise(MADV_WILLNEED) failed: %s", strerror(errno));
+    FILE *fp = fmemopen(map, st.st_size, "r");
+    if (!fp) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    *addr = map;
+    *length = st.st_size;
+    return fp;
+}
+
+static void
+solv_mmap_fclose(FILE *fp, void *addr, size_t length)
+{
+    fclose(fp);
+    munmap(addr, length);
+}
+
+static const unsigned char zstd_frame_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+#ifdef WITH_ZSTD
+// Streams of zstd compressed solv cache files, see the solv_cache_compression main config option
+
+struct ZstdReadCookie {
+    FILE *fp;
+    ZSTD_DCtx *dctx;
+    std::vector<char> in;
+    ZSTD_inBuffer input;
+};
+
+static ssize_t
+zstd_cookie_read(void *c, char *buf, size_t size)
+{
+    auto cookie = static_cast<ZstdReadCookie *>(c);
+    ZSTD_outBuffer out{buf, size, 0};
+    for (;;) {
+        size_t rc = ZSTD_decompressStream(cookie->dctx, &out, &cookie->input);
+        if (ZSTD_isError(rc)) {
+            errno = EIO;
+            return -1;
+        }
+        if (out.pos > 0)
+            return out.pos;
+        if (cookie->input.pos < cookie->input.size)
+            continue;
+        size_t n = fread(cookie->in.data(), 1, cookie->in.size(), cookie->fp);
+        if (n == 0)
+            return ferror(cookie->fp) ? -1 : 0;
+        cookie->input = {cookie->in.data(), n, 0};
+    }
+}
+
+// only rewinding is supported, try_to_use_cached_solvfile() rereads the file after the header
+static int
+zstd_cookie_seek(void *c, off64_t *offset, int whence)
+{
+    auto cookie = static_cast<ZstdReadCookie *>(c);
+    if (*offset != 0 || whence != SEEK_SET || fseek(cookie->fp, 0, SEEK_SET)) {
+        errno = ESPIPE;
+        return -1;
+    }
+    ZSTD_DCtx_reset(cookie->dctx, ZSTD_reset_session_only);
+    cookie->input = {NULL, 0, 0};
+    return 0;
+}
+
+static int
+zstd_cookie_close_read(void *c)
+{
+    auto cookie = static_cast<ZstdReadCookie *>(c);
+    int ret = fclose(cookie->fp);
+    ZSTD_freeDCtx(cookie->dctx);
+    delete cookie;
+    return ret;
+}
+
+struct ZstdWriteCookie {
+    FILE *fp;
+    ZSTD_CCtx *cctx;
+    std::vector<char> out;
+};
+
+static bool
+zstd_cookie_compress(ZstdWriteCookie *cookie, const char *buf, size_t size, ZSTD_EndDirective mode)
+{
+    ZSTD_inBuffer in{buf, size, 0};
+    size_t remaining;
+    do {
+        ZSTD_outBuffer out{cookie->out.data(), cookie->out.size(), 0};
+        remaining = ZSTD_compressStream2(cookie->cctx, &out, &in, mode);
+        if (ZSTD_isError(remaining)) {
+            errno = EIO;
+            return false;
+        }
+        if (out.pos > 0 && fwrite(cookie->out.data(), 1, out.pos, cookie->fp) != out.pos)
+            return false;
+    } while (mode == ZSTD_e_end ? remaining != 0 : in.pos < in.size);
+    return true;
+}
+
+static ssize_t
+zstd_cookie_write(void *c, const char *buf, size_t size)
+{
+    if (!zstd_cookie_compress(static_cast<ZstdWriteCookie *>(c), buf, size, ZSTD_e_continue))
+        return -1;
+    return size;
+}
+
+static int
+zstd_cookie_close_write(void *c)
+{
+    auto cookie = static_cast<ZstdWriteCookie *>(c);
+    bool ended = zstd_cookie_compress(cookie, NULL, 0, ZSTD_e_end);
+    int ret = fclose(cookie->fp);
+    ZSTD_freeCCtx(cookie->cctx);
+    delete cookie;
+    return ended ? ret : EOF;
+}
+#endif
+
+// Returns a stream reading the solv cache file opened as fp, zstd compressed files are
+// decompressed on the fly. Closing the returned stream closes fp.
+static FILE *
+solv_cache_fwrap_read(FILE *fp)
+{
+    if (!fp)
+        return NULL;
+    unsigned char magic[sizeof(zstd_frame_magic)];
+    bool compressed = fread(magic, sizeof(magic), 1, fp) == 1 &&
+        memcmp(magic, zstd_frame_magic, sizeof(magic)) == 0;
+    rewind(fp);
+    if (!compressed)
+        return fp;
+#ifdef WITH_ZSTD
+    auto cookie = new ZstdReadCookie{fp, ZSTD_createDCtx(), std::vector<char>(ZSTD_DStreamInSize()),
+                                     {NULL, 0, 0}};
+    cookie_io_functions_t io = {zstd_cookie_read, NULL, zstd_cookie_seek, zstd_cookie_close_read};
+    FILE *zfp = cookie->dctx ? fopencookie(cookie, "r", io) : NULL;
+    if (zfp)
+        return zfp;
+    ZSTD_freeDCtx(cookie->dctx);
+    delete cookie;
+#else
+    g_warning("libdnf was built without zstd support, cannot read compressed solv cache");
+#endif
+    fclose(fp);
+    errno = ENOTSUP;
+    return NULL;
+}
+
+static FILE *
+solv_cache_fopen(const char *path)
+{
+    return solv_cache_fwrap_read(fopen(path, "r"));
+}
+
+// Returns a stream writing the solv cache file opened as fp in the format selected by the
+// solv_cache_compression main config option. Closing the returned stream closes fp.
+static FILE *
+solv_cache_fwrap_write(FILE *fp)
+{
+    if (!fp)
+        return NULL;
+    auto & mainConf = libdnf::getGlobalMainConfig();
+    if (mainConf.solv_cache_compression().getValue() != "zstd")
+        return fp;
+#ifdef WITH_ZSTD
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    if (!cctx) {
+        fclose(fp);
+        errno = ENOMEM;
+        return NULL;
+    }
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+                           mainConf.solv_cache_compression_level().getValue());
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+    auto threads = mainConf.solv_cache_compression_threads().getValue();
+    if (threads > 1 && ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, threads)))
+        g_debug("zstd without multithreading support, compressing solv cache in one thread");
+    auto cookie = new ZstdWriteCookie{fp, cctx, std::vector<char>(ZSTD_CStreamOutSize())};
+    cookie_io_functions_t io = {NULL, zstd_cookie_write, NULL, zstd_cookie_close_write};
+    FILE *zfp = fopencookie(cookie, "w", io);
+    if (zfp)
+        return zfp;
+    ZSTD_freeCCtx(cctx);
+    delete cookie;
+    fclose(fp);
+    return NULL;
+#else
+    static std::once_flag warned;
+    std::call_once(warned, [] {
+        g_warning("libdnf was built without zstd support, writing uncompressed solv cache");
+    });
+    return fp;
+#endif
+}
+
+/* any process could have put a file into the shared cache directory, only the regular files of
+ * root or this user nobody else can modify are used */
+static gboolean
+shared_cache_fd_trusted(int fd, const char *fn)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return FALSE;
+    if ((st.st_uid != 0 && st.st_uid != geteuid()) || (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        g_debug("not using shared cache %s of uid %u with mode %o", fn,
+                (unsigned) st.st_uid, (unsigned) (st.st_mode & 07777));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Try to load cached solv file into repo otherwise return FALSE. A file of the shared cache
+// directory is opened only if it is not a symlink and checked on the opened fd.
 static gboolean
-try_to_use_cached_solvfile(const char *path, Repo *repo, int flags, const unsigned char *checksum, GError **err){
-    FILE *fp_cache = fopen(path, "r");
+try_to_use_cached_solvfile(const char *path, Repo *repo, int flags, const unsigned char *checksum,
+                           GError **err, bool use_mmap = false, bool shared = false){
+    void *map_addr = NULL;
+    size_t map_length = 0;
+    FILE *fp_cache = NULL;
+    int fd = open(path, O_RDONLY | O_CLOEXEC | (shared ? O_NOFOLLOW : 0));
+    if (fd >= 0 && shared && !shared_cache_fd_trusted(fd, path)) {
+        close(fd);
+        return FALSE;
+    }
+    if (fd >= 0 && use_mmap) {
+        fp_cache = solv_mmap_fdopen(fd, &map_addr, &map_length);
+        // fall back to a regular stream when the file can not be mapped
+        if (!fp_cache)
+            use_mmap = false;
+        else {
+            close(fd);
+            fd = -1;
+            fp_cache = solv_cache_fwrap_read(fp_cache);
+            if (!fp_cache)
+                munmap(map_addr, map_length);
+        }
+    }
+    if (fd >= 0 && !use_mmap) {
+        FILE *fp = fdopen(fd, "r");
+        // the stream owns the fd
+        if (fp)
+            fd = -1;
+        fp_cache = solv_cache_fwrap_read(fp);
+    }
     if (!fp_cache) {
+        int saved_errno = errno;
+        if (fd >= 0)
+            close(fd);
+        errno = saved_errno;
         // Missing cache files (ENOENT) are not an error and can even be expected in some cases
         // (such as when repo doesn't have updateinfo/prestodelta metadata).
         // Use g_debug in order not to pollute the log by default with such entries.
@@ -241,7 +722,7 @@ try_to_use_cached_solvfile(const char *path, Repo *repo, int flags, const unsign
     }
     std::unique_ptr<SolvUserdata> solv_userdata = solv_userdata_read(fp_cache);
     gboolean ret = TRUE;
-    if (solv_userdata && solv_userdata_verify(solv_userdata.get(), checksum)) {
+    if (solv_userdata && (!checksum || solv_userdata_verify(solv_userdata.get(), checksum))) {
         // after reading the header rewind to the begining
         fseek(fp_cache, 0, SEEK_SET);
         if (repo_add_solv(repo, fp_cache, flags)) {
@@ -255,7 +736,10 @@ try_to_use_cached_solvfile(const char *path, Repo *repo, int flags, const unsign
         ret = FALSE;
     }
 
-    fclose(fp_cache);
+    if (use_mmap)
+        solv_mmap_fclose(fp_cache, map_addr, map_length);
+    else
+        fclose(fp_cache);
     return ret;
 }
 
@@ -293,196 +777,923 @@ dnf_sack_get_pkg_solvables(DnfSack *sack)
     return new libdnf::PackageSet(sack, priv->pkg_solvables);
 }
 
-/**
- * dnf_sack_last_solvable: (skip)
- * @sack: a #DnfSack instance.
- *
- * Returns an ID of last solvable in sack
- *
- * Returns: an #Id
- *
- * Since: 0.7.0
- */
-Id
-dnf_sack_last_solvable(DnfSack *sack)
+/* anything that can change the result of a query has to call this */
+static void
+dnf_sack_bump_generation(DnfSack *sack)
 {
-    return dnf_sack_get_pool(sack)->nsolvables - 1;
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->generation++;
+    if (priv->query_cache)
+        priv->query_cache->clear();
+    /* writers end the frozen state, the lazy paths take over again */
+    priv->frozen = FALSE;
+    delete priv->protected_pkgs;
+    priv->protected_pkgs = NULL;
+    delete priv->unneeded_cache;
+    priv->unneeded_cache = NULL;
 }
 
-void
-dnf_sack_recompute_considered_map(DnfSack * sack, Map ** considered, libdnf::Query::ExcludeFlags flags)
+guint64
+dnf_sack_get_generation(DnfSack *sack)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    Pool *pool = dnf_sack_get_pool(sack);
-    if (!*considered) {
-        if ((static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_REGULAR_EXCLUDES) ||
-            (!priv->repo_excludes && !priv->pkg_excludes && !priv->pkg_includes))
-            && (static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_MODULAR_EXCLUDES)
-            || !priv->module_excludes)) {
-            return;
-        }
-        *considered = static_cast<Map *>(g_malloc0(sizeof(Map)));
-        map_init(*considered, pool->nsolvables);
-    } else
-        map_grow(*considered, pool->nsolvables);
-
-    // considered = (all - repo_excludes - pkg_excludes) and
-    //              (pkg_includes + all_from_repos_not_using_includes)
-    map_setall(*considered);
-    dnf_sack_make_provides_ready(sack);
-    if (!static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_MODULAR_EXCLUDES)
-        && priv->module_excludes)
-        map_subtract(*considered, priv->module_excludes);
-    if (!static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_REGULAR_EXCLUDES)) {
-        if (priv->repo_excludes)
-            map_subtract(*considered, priv->repo_excludes);
-        if (priv->pkg_excludes)
-            map_subtract(*considered, priv->pkg_excludes);
-        if (priv->pkg_includes) {
-            map_grow(priv->pkg_includes, pool->nsolvables);
-            Map pkg_includes_tmp;
-            map_init_clone(&pkg_includes_tmp, priv->pkg_includes);
+    return priv->generation;
+}
 
-            // Add all solvables from repositories which do not use "includes"
-            Id repoid;
-            Repo *repo;
-            FOR_REPOS(repoid, repo) {
-                auto hyrepo = static_cast<HyRepo>(repo->appdata);
-                if (!hyrepo->getUseIncludes()) {
-                    Id solvableid;
-                    Solvable *solvable;
-                    FOR_REPO_SOLVABLES(repo, solvableid, solvable)
-                        MAPSET(&pkg_includes_tmp, solvableid);
-                }
-            }
+/* the cache is dropped as a whole once it grows over this */
+#define QUERY_CACHE_MAX_ENTRIES 256
 
-            map_and(*considered, &pkg_includes_tmp);
-            map_free(&pkg_includes_tmp);
-        }
-    }
+const libdnf::PackageSet *
+dnf_sack_query_cache_lookup(DnfSack *sack, const std::string & key)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->use_query_cache || !priv->query_cache)
+        return nullptr;
+    auto it = priv->query_cache->find(key);
+    return it == priv->query_cache->end() ? nullptr : &it->second;
 }
 
-/**
- * dnf_sack_recompute_considered:
- * @sack: a #DnfSack instance.
- *
- * Recompute considered packages for libsolv and queries.
- *
- * Since: 0.7.0
- */
 void
-dnf_sack_recompute_considered(DnfSack *sack)
+dnf_sack_query_cache_store(DnfSack *sack, const std::string & key, const libdnf::PackageSet & result)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    Pool *pool = dnf_sack_get_pool(sack);
-    if (priv->considered_uptodate)
+    /* concurrent readers of a frozen sack may only look the cache up */
+    if (!priv->use_query_cache || priv->frozen)
         return;
-    dnf_sack_recompute_considered_map(
-        sack, &pool->considered, libdnf::Query::ExcludeFlags::APPLY_EXCLUDES);
-    priv->considered_uptodate = TRUE;
+    if (!priv->query_cache)
+        priv->query_cache = new std::unordered_map<std::string, libdnf::PackageSet>;
+    if (priv->query_cache->size() >= QUERY_CACHE_MAX_ENTRIES)
+        priv->query_cache->clear();
+    priv->query_cache->emplace(key, result);
 }
 
-static gboolean
-load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
-         const char *suffix, const char * which_filename,
-         int (*cb)(Repo *, FILE *), GError **error)
+static void
+dnf_sack_invalidate_solvable_indexes(DnfSack *sack)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    int ret = 0;
-    auto repoImpl = libdnf::repoGetImpl(hrepo);
-    Repo *repo = repoImpl->libsolvRepo;
-    const char *name = repo->name;
-    FILE *fp;
-    gboolean done = FALSE;
-
-    char *fn_cache =  dnf_sack_give_cache_fn(sack, name, suffix);
-    assert(libdnf::repoGetImpl(hrepo)->checksum);
+    dnf_sack_bump_generation(sack);
+    priv->includes_unused = free_map_fully(priv->includes_unused);
+    delete priv->name_index;
+    priv->name_index = NULL;
+    delete priv->sorted_names;
+    priv->sorted_names = NULL;
+    delete priv->folded_names;
+    priv->folded_names = NULL;
+    delete priv->arch_index;
+    priv->arch_index = NULL;
+    delete priv->repo_solvables;
+    priv->repo_solvables = NULL;
+    delete priv->num_columns;
+    priv->num_columns = NULL;
+    delete priv->advisory_index;
+    priv->advisory_index = NULL;
+    delete priv->substring_indexes;
+    priv->substring_indexes = NULL;
+    delete priv->updown_table;
+    priv->updown_table = NULL;
+    delete priv->obsoleters;
+    priv->obsoleters = NULL;
+    delete priv->dep_name_indexes;
+    priv->dep_name_indexes = NULL;
+    delete priv->sourcerpm_index;
+    priv->sourcerpm_index = NULL;
+    delete priv->location_index;
+    priv->location_index = NULL;
+    delete priv->latest_orders;
+    priv->latest_orders = NULL;
+    delete priv->package_id_index;
+    priv->package_id_index = NULL;
+}
 
-    int flags = 0;
-    /* the updateinfo is not a real extension */
-    if (which_repodata != _HY_REPODATA_UPDATEINFO)
-        flags |= REPO_EXTEND_SOLVABLES;
-    /* do not pollute the main pool with directory component ids */
-    if (which_repodata == _HY_REPODATA_FILENAMES || which_repodata == _HY_REPODATA_OTHER)
-        flags |= REPO_LOCALPOOL;
-    if (try_to_use_cached_solvfile(fn_cache, repo, flags, libdnf::repoGetImpl(hrepo)->checksum, error)) {
-        g_debug("%s: using cache file: %s", __func__, fn_cache);
-        done = TRUE;
-        repo_update_state(hrepo, which_repodata, _HY_LOADED_CACHE);
-        repo_set_repodata(hrepo, which_repodata, repo->nrepodata - 1);
-    }
-    if (error && *error) {
-        g_prefix_error(error, _("Loading extension cache %s (%d) failed: "), fn_cache, which_repodata);
-        return FALSE;
+static SolvableIndex *
+solvable_index_build(Pool *pool, Id Solvable::*key)
+{
+    auto index = new SolvableIndex;
+    index->nsolvables = pool->nsolvables;
+    Id maxkey = 0;
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (s->repo && s->*key > maxkey)
+            maxkey = s->*key;
     }
-
-    g_free(fn_cache);
-    if (done)
-        return TRUE;
-
-    auto fn = hrepo->getMetadataPath(which_filename);
-    /* nothing set */
-    if (fn.empty()) {
-        g_set_error (error,
-                     DNF_ERROR,
-                     DNF_ERROR_NO_CAPABILITY,
-                     _("no %1$s string for %2$s"),
-                     which_filename, name);
-        return FALSE;
+    index->starts.assign(maxkey + 2, 0);
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (s->repo)
+            ++index->starts[s->*key + 1];
     }
-
-    fp = solv_xfopen(fn.c_str(), "r");
-    if (fp == NULL) {
-        g_set_error (error,
-                     DNF_ERROR,
-                     DNF_ERROR_FILE_INVALID,
-                     _("failed to open: %s"), fn.c_str());
-        return FALSE;
+    for (Id k = 1; k <= maxkey + 1; ++k)
+        index->starts[k] += index->starts[k - 1];
+    index->ids.resize(index->starts.back());
+    std::vector<Offset> pos(index->starts.begin(), index->starts.end() - 1);
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (s->repo)
+            index->ids[pos[s->*key]++] = p;
     }
-    g_debug("%s: loading: %s", __func__, fn.c_str());
+    return index;
+}
 
-    int previous_last = repo->nrepodata - 1;
-    ret = cb(repo, fp);
-    fclose(fp);
-    if (ret == 0) {
-        repo_update_state(hrepo, which_repodata, _HY_LOADED_FETCH);
-        assert(previous_last == repo->nrepodata - 2); (void)previous_last;
-        repo_set_repodata(hrepo, which_repodata, repo->nrepodata - 1);
+static std::pair<const Id *, const Id *>
+solvable_index_lookup(SolvableIndex **index, Pool *pool, Id Solvable::*key, Id value)
+{
+    if (*index && (*index)->nsolvables != pool->nsolvables) {
+        delete *index;
+        *index = NULL;
     }
-    priv->provides_ready = 0;
-    return TRUE;
+    if (!*index)
+        *index = solvable_index_build(pool, key);
+    auto & starts = (*index)->starts;
+    if (value < 0 || value + 1 >= static_cast<Id>(starts.size()))
+        return {nullptr, nullptr};
+    const Id *ids = (*index)->ids.data();
+    return {ids + starts[value], ids + starts[value + 1]};
 }
 
-static int
-load_filelists_cb(Repo *repo, FILE *fp)
+std::pair<const Id *, const Id *>
+dnf_sack_solvables_with_name(DnfSack *sack, Id name)
 {
-    if (repo_add_rpmmd(repo, fp, "FL", REPO_EXTEND_SOLVABLES))
-        return DNF_ERROR_INTERNAL_ERROR;
-    return 0;
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return solvable_index_lookup(&priv->name_index, priv->pool, &Solvable::name, name);
 }
 
-static int
-load_presto_cb(Repo *repo, FILE *fp)
+const Map *
+dnf_sack_get_repo_solvables(DnfSack *sack, Id repoid)
 {
-    if (repo_add_deltainfoxml(repo, fp, 0))
-        return DNF_ERROR_INTERNAL_ERROR;
-    return 0;
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (priv->repo_solvables && (priv->repo_solvables->nsolvables != pool->nsolvables ||
+                                 priv->repo_solvables->nrepos != pool->nrepos)) {
+        delete priv->repo_solvables;
+        priv->repo_solvables = NULL;
+    }
+    if (!priv->repo_solvables) {
+        auto index = new RepoSolvables;
+        index->nsolvables = pool->nsolvables;
+        index->nrepos = pool->nrepos;
+        index->repos.reserve(pool->nrepos);
+        for (int i = 0; i < pool->nrepos; ++i)
+            index->repos.emplace_back(sack);
+        Repo *repo;
+        Solvable *s;
+        Id p;
+        int i;
+        FOR_REPOS(i, repo) {
+            Map *map = index->repos[i].getMap();
+            FOR_REPO_SOLVABLES(repo, p, s)
+                MAPSET(map, p);
+        }
+        priv->repo_solvables = index;
+    }
+    if (repoid <= 0 || repoid >= priv->repo_solvables->nrepos)
+        return nullptr;
+    return priv->repo_solvables->repos[repoid].getMap();
 }
 
-static int
-load_updateinfo_cb(Repo *repo, FILE *fp)
+const std::vector<unsigned long long> &
+dnf_sack_get_num_column(DnfSack *sack, libdnf::PackageAttr attr)
 {
-    if (repo_add_updateinfoxml(repo, fp, 0))
-        return DNF_ERROR_INTERNAL_ERROR;
-    return 0;
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (libdnf::packageAttrType(attr) != libdnf::PackageAttrType::NUMBER)
+        throw std::runtime_error("dnf_sack_get_num_column() needs a numeric attribute");
+    if (priv->num_columns && priv->num_columns->nsolvables != pool->nsolvables) {
+        delete priv->num_columns;
+        priv->num_columns = NULL;
+    }
+    if (!priv->num_columns) {
+        priv->num_columns = new NumColumns;
+        priv->num_columns->nsolvables = pool->nsolvables;
+        priv->num_columns->byAttr.resize(static_cast<size_t>(libdnf::PackageAttr::INSTALLTIME) + 1);
+    }
+    auto & column = priv->num_columns->byAttr[static_cast<size_t>(attr)];
+    if (column.empty()) {
+        repo_internalize_all_trigger(pool);
+        column.assign(pool->nsolvables, 0);
+        for (Id p = 2; p < pool->nsolvables; ++p) {
+            if (pool_id2solvable(pool, p)->repo)
+                column[p] = libdnf::packageAttrNumber(pool, p, attr);
+        }
+    }
+    return column;
 }
 
-static int
-load_other_cb(Repo *repo, FILE *fp)
+const std::vector<Id> &
+dnf_sack_get_sorted_names(DnfSack *sack)
 {
-    if (repo_add_rpmmd(repo, fp, 0, REPO_EXTEND_SOLVABLES))
-        return DNF_ERROR_INTERNAL_ERROR;
-    return 0;
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (priv->sorted_names && priv->sorted_names->nsolvables != pool->nsolvables) {
+        delete priv->sorted_names;
+        priv->sorted_names = NULL;
+    }
+    if (!priv->sorted_names) {
+        // the name index knows which names are in use
+        dnf_sack_solvables_with_name(sack, 0);
+        auto & starts = priv->name_index->starts;
+        auto sorted = new SortedNames;
+        sorted->nsolvables = pool->nsolvables;
+        for (Id name = 1; name + 1 < static_cast<Id>(starts.size()); ++name) {
+            if (starts[name] != starts[name + 1])
+                sorted->names.push_back(name);
+        }
+        std::sort(sorted->names.begin(), sorted->names.end(), [pool](Id a, Id b) {
+            return strcmp(pool_id2str(pool, a), pool_id2str(pool, b)) < 0;
+        });
+        priv->sorted_names = sorted;
+    }
+    return priv->sorted_names->names;
+}
+
+static std::string
+fold_case(const char *str)
+{
+    std::string folded(str);
+    // the same folding strcasecmp() and strcasestr() use
+    for (auto & c : folded)
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return folded;
+}
+
+static const FoldedNames &
+dnf_sack_get_folded_names(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (priv->folded_names && priv->folded_names->nsolvables != pool->nsolvables) {
+        delete priv->folded_names;
+        priv->folded_names = NULL;
+    }
+    if (!priv->folded_names) {
+        std::vector<std::pair<std::string, Id>> entries;
+        for (Id name : dnf_sack_get_sorted_names(sack))
+            entries.emplace_back(fold_case(pool_id2str(pool, name)), name);
+        std::sort(entries.begin(), entries.end());
+        auto folded = new FoldedNames;
+        folded->nsolvables = pool->nsolvables;
+        folded->starts.reserve(entries.size());
+        folded->names.reserve(entries.size());
+        for (const auto & entry : entries) {
+            folded->starts.push_back(folded->text.size());
+            folded->names.push_back(entry.second);
+            folded->text.append(entry.first).push_back('\0');
+        }
+        priv->folded_names = folded;
+    }
+    return *priv->folded_names;
+}
+
+void
+dnf_sack_get_icase_names(DnfSack *sack, const char *match, bool substr, std::vector<Id> & names)
+{
+    auto & folded = dnf_sack_get_folded_names(sack);
+    auto foldedMatch = fold_case(match);
+    const char *text = folded.text.c_str();
+    if (!substr) {
+        auto it = std::lower_bound(folded.starts.begin(), folded.starts.end(), foldedMatch,
+            [text](size_t start, const std::string & value) {
+                return strcmp(text + start, value.c_str()) < 0;
+            });
+        for (; it != folded.starts.end() && foldedMatch == text + *it; ++it)
+            names.push_back(folded.names[it - folded.starts.begin()]);
+        return;
+    }
+    if (foldedMatch.empty()) {
+        names.insert(names.end(), folded.names.begin(), folded.names.end());
+        return;
+    }
+    // one search over the whole buffer, continuing after the name of each hit
+    const char *end = text + folded.text.size();
+    const char *pos = text;
+    while (pos < end) {
+        auto hit = static_cast<const char *>(
+            memmem(pos, end - pos, foldedMatch.data(), foldedMatch.size()));
+        if (!hit)
+            break;
+        auto entry = std::upper_bound(folded.starts.begin(), folded.starts.end(),
+                                      static_cast<size_t>(hit - text)) - 1;
+        names.push_back(folded.names[entry - folded.starts.begin()]);
+        pos = text + *entry + strlen(text + *entry) + 1;
+    }
+}
+
+std::pair<const Id *, const Id *>
+dnf_sack_solvables_with_arch(DnfSack *sack, Id arch)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return solvable_index_lookup(&priv->arch_index, priv->pool, &Solvable::arch, arch);
+}
+
+const std::vector<Id> &
+dnf_sack_solvables_with_obsoletes(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (priv->obsoleters && priv->obsoleters->nsolvables != pool->nsolvables) {
+        delete priv->obsoleters;
+        priv->obsoleters = NULL;
+    }
+    if (!priv->obsoleters) {
+        auto index = new ObsoletersIndex;
+        index->nsolvables = pool->nsolvables;
+        for (Id p = 2; p < pool->nsolvables; ++p) {
+            Solvable *s = pool_id2solvable(pool, p);
+            if (s->repo && s->obsoletes && s->repo->idarraydata[s->obsoletes])
+                index->ids.push_back(p);
+        }
+        priv->obsoleters = index;
+    }
+    return priv->obsoleters->ids;
+}
+
+/* the name a dependency can only match when it has it too, 0 for rich, arch and other deps */
+static Id
+dep_plain_name(Pool *pool, Id dep)
+{
+    while (ISRELDEP(dep)) {
+        Reldep *rd = GETRELDEP(pool, dep);
+        if (rd->flags > 7)          /* not a combination of REL_GT, REL_EQ and REL_LT */
+            return 0;
+        dep = rd->name;
+    }
+    return dep;
+}
+
+static void
+dep_name_index_build(Pool *pool, Id keyname, SolvableIndex & index)
+{
+    index.nsolvables = pool->nsolvables;
+    std::vector<std::pair<Id, Id>> entries;     /* name and solvable, every pair once */
+    Queue deps;
+    queue_init(&deps);
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (!s->repo)
+            continue;
+        queue_empty(&deps);
+        solvable_lookup_idarray(s, keyname, &deps);
+        auto first = entries.size();
+        for (int i = 0; i < deps.count; ++i)
+            entries.emplace_back(dep_plain_name(pool, deps.elements[i]), p);
+        std::sort(entries.begin() + first, entries.end());
+        entries.erase(std::unique(entries.begin() + first, entries.end()), entries.end());
+    }
+    queue_free(&deps);
+    Id maxname = 0;
+    for (const auto & entry : entries)
+        maxname = std::max(maxname, entry.first);
+    index.starts.assign(maxname + 2, 0);
+    for (const auto & entry : entries)
+        ++index.starts[entry.first + 1];
+    for (Id k = 1; k <= maxname + 1; ++k)
+        index.starts[k] += index.starts[k - 1];
+    index.ids.resize(entries.size());
+    std::vector<Offset> pos(index.starts.begin(), index.starts.end() - 1);
+    for (const auto & entry : entries)
+        index.ids[pos[entry.first]++] = entry.second;
+}
+
+std::pair<const Id *, const Id *>
+dnf_sack_solvables_with_dep_name(DnfSack *sack, Id keyname, Id name)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (priv->dep_name_indexes && priv->dep_name_indexes->nsolvables != pool->nsolvables) {
+        delete priv->dep_name_indexes;
+        priv->dep_name_indexes = NULL;
+    }
+    if (!priv->dep_name_indexes) {
+        priv->dep_name_indexes = new DepNameIndexes;
+        priv->dep_name_indexes->nsolvables = pool->nsolvables;
+    }
+    auto & byKey = priv->dep_name_indexes->byKey;
+    auto it = byKey.find(keyname);
+    if (it == byKey.end()) {
+        it = byKey.emplace(keyname, SolvableIndex()).first;
+        dep_name_index_build(pool, keyname, it->second);
+    }
+    auto & starts = it->second.starts;
+    if (name < 0 || name + 1 >= static_cast<Id>(starts.size()))
+        return {nullptr, nullptr};
+    const Id *ids = it->second.ids.data();
+    return {ids + starts[name], ids + starts[name + 1]};
+}
+
+static const std::vector<Id> *
+string_key_index_lookup(StringKeyIndex **index, Pool *pool, const char *(*keyOf)(Solvable *),
+                        const char *key)
+{
+    if (*index && (*index)->nsolvables != pool->nsolvables) {
+        delete *index;
+        *index = NULL;
+    }
+    if (!*index) {
+        auto built = new StringKeyIndex;
+        built->nsolvables = pool->nsolvables;
+        for (Id p = 2; p < pool->nsolvables; ++p) {
+            Solvable *s = pool_id2solvable(pool, p);
+            if (!s->repo)
+                continue;
+            const char *value = keyOf(s);
+            if (value)
+                built->ids[value].push_back(p);
+        }
+        *index = built;
+    }
+    auto it = (*index)->ids.find(key);
+    return it == (*index)->ids.end() ? nullptr : &it->second;
+}
+
+const std::vector<Id> *
+dnf_sack_solvables_with_sourcerpm(DnfSack *sack, const char *sourcerpm)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return string_key_index_lookup(&priv->sourcerpm_index, priv->pool,
+                                   [](Solvable *s) { return solvable_lookup_sourcepkg(s); },
+                                   sourcerpm);
+}
+
+const std::vector<Id> *
+dnf_sack_solvables_with_location(DnfSack *sack, const char *location)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return string_key_index_lookup(&priv->location_index, priv->pool,
+                                   [](Solvable *s) { return solvable_get_location(s, NULL); },
+                                   location);
+}
+
+static std::vector<int>
+repo_priorities(Pool *pool)
+{
+    std::vector<int> priorities(pool->nrepos, 0);
+    Repo *repo;
+    int i;
+    FOR_REPOS(i, repo)
+        priorities[i] = repo->priority;
+    return priorities;
+}
+
+const DnfSackLatestOrder &
+dnf_sack_get_latest_order(DnfSack *sack, int keyname)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    bool byArch = keyname == HY_PKG_LATEST_PER_ARCH || keyname == HY_PKG_LATEST_PER_ARCH_BY_PRIORITY;
+    bool byPriority = keyname == HY_PKG_LATEST_PER_ARCH_BY_PRIORITY;
+    int slot = byPriority ? 2 : byArch ? 1 : 0;
+
+    if (priv->latest_orders && priv->latest_orders->nsolvables != pool->nsolvables) {
+        delete priv->latest_orders;
+        priv->latest_orders = NULL;
+    }
+    if (!priv->latest_orders) {
+        priv->latest_orders = new LatestOrders;
+        priv->latest_orders->nsolvables = pool->nsolvables;
+    }
+    auto & order = priv->latest_orders->orders[slot];
+    /* priorities may change without touching the solvables */
+    if (byPriority && !order.ids.empty()) {
+        auto priorities = repo_priorities(pool);
+        if (priorities != priv->latest_orders->priorities)
+            order.ids.clear();
+    }
+    if (!order.ids.empty())
+        return order;
+
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        if (pool_id2solvable(pool, p)->repo)
+            order.ids.push_back(p);
+    }
+    /* name, arch, higher priority first, higher evr first, then the id */
+    std::sort(order.ids.begin(), order.ids.end(), [pool, byArch, byPriority](Id a, Id b) {
+        Solvable *sa = pool_id2solvable(pool, a);
+        Solvable *sb = pool_id2solvable(pool, b);
+        if (sa->name != sb->name)
+            return sa->name < sb->name;
+        if (byArch && sa->arch != sb->arch)
+            return sa->arch < sb->arch;
+        if (byPriority && sa->repo->priority != sb->repo->priority)
+            return sa->repo->priority > sb->repo->priority;
+        int r = pool_evrcmp(pool, sa->evr, sb->evr, EVRCMP_COMPARE);
+        if (r)
+            return r > 0;
+        return a < b;
+    });
+    order.ranks.assign(pool->nsolvables, -1);
+    for (Id i = 0; i < static_cast<Id>(order.ids.size()); ++i)
+        order.ranks[order.ids[i]] = i;
+    if (byPriority)
+        priv->latest_orders->priorities = repo_priorities(pool);
+    return order;
+}
+
+static Id
+updown_table_lookup(DnfSack *sack, Id p, bool upgrades)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    auto table = priv->updown_table;
+    if (table && (table->nsolvables != pool->nsolvables || table->installed != pool->installed)) {
+        /* concurrent readers of a frozen sack may not drop it */
+        if (priv->frozen)
+            return upgrades ? what_upgrades(pool, p) : what_downgrades(pool, p);
+        delete table;
+        table = priv->updown_table = NULL;
+    }
+    if (!table) {
+        if (priv->frozen)
+            return upgrades ? what_upgrades(pool, p) : what_downgrades(pool, p);
+        table = priv->updown_table = new UpdownTable;
+        table->nsolvables = pool->nsolvables;
+        table->installed = pool->installed;
+        table->upgrades.assign(pool->nsolvables, -1);
+        table->downgrades.assign(pool->nsolvables, -1);
+    }
+    auto & known = upgrades ? table->upgrades : table->downgrades;
+    if (known[p] != -1)
+        return known[p];
+    Id what = upgrades ? what_upgrades(pool, p) : what_downgrades(pool, p);
+    if (!priv->frozen)
+        known[p] = what;
+    return what;
+}
+
+Id
+dnf_sack_what_upgrades(DnfSack *sack, Id p)
+{
+    return updown_table_lookup(sack, p, true);
+}
+
+Id
+dnf_sack_what_downgrades(DnfSack *sack, Id p)
+{
+    return updown_table_lookup(sack, p, false);
+}
+
+std::unordered_map<std::string, Id> &
+dnf_sack_get_reldep_cache(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->reldep_cache)
+        priv->reldep_cache = new std::unordered_map<std::string, Id>;
+    return *priv->reldep_cache;
+}
+
+bool
+dnf_sack_parse_nevra(DnfSack *sack, const char *nevraStr, HyForm form, libdnf::Nevra & nevra)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->nevra_cache)
+        priv->nevra_cache = new NevraParseCache;
+    std::string key(1, static_cast<char>(form));
+    key.append(nevraStr);
+    auto it = priv->nevra_cache->find(key);
+    if (it == priv->nevra_cache->end()) {
+        // the cache only serves repeated subjects, don't let unique ones grow it without limit
+        if (priv->nevra_cache->size() >= NEVRA_PARSE_CACHE_MAX_SIZE)
+            priv->nevra_cache->clear();
+        libdnf::Nevra parsed;
+        bool matched = parsed.parse(nevraStr, form);
+        it = priv->nevra_cache->emplace(std::move(key), std::make_pair(matched, std::move(parsed))).first;
+    }
+    if (it->second.first)
+        nevra = it->second.second;
+    return it->second.first;
+}
+
+const libdnf::AdvisoryIndex &
+dnf_sack_get_advisory_index(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (priv->advisory_index && priv->advisory_index->getNSolvables() != priv->pool->nsolvables) {
+        delete priv->advisory_index;
+        priv->advisory_index = NULL;
+    }
+    if (!priv->advisory_index)
+        priv->advisory_index = new libdnf::AdvisoryIndex(sack);
+    return *priv->advisory_index;
+}
+
+/**
+ * dnf_sack_last_solvable: (skip)
+ * @sack: a #DnfSack instance.
+ *
+ * Returns an ID of last solvable in sack
+ *
+ * Returns: an #Id
+ *
+ * Since: 0.7.0
+ */
+Id
+dnf_sack_last_solvable(DnfSack *sack)
+{
+    return dnf_sack_get_pool(sack)->nsolvables - 1;
+}
+
+void
+dnf_sack_recompute_considered_map(DnfSack * sack, Map ** considered, libdnf::Query::ExcludeFlags flags)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+    if (!*considered) {
+        if ((static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_REGULAR_EXCLUDES) ||
+            (!priv->repo_excludes && !priv->pkg_excludes && !priv->pkg_includes))
+            && (static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_MODULAR_EXCLUDES)
+            || !priv->module_excludes)) {
+            return;
+        }
+        *considered = static_cast<Map *>(g_malloc0(sizeof(Map)));
+        map_init(*considered, pool->nsolvables);
+    } else
+        map_grow(*considered, pool->nsolvables);
+
+    // considered = (all - repo_excludes - pkg_excludes) and
+    //              (pkg_includes + all_from_repos_not_using_includes)
+    map_setall(*considered);
+    dnf_sack_make_provides_ready(sack);
+    if (!static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_MODULAR_EXCLUDES)
+        && priv->module_excludes)
+        map_subtract(*considered, priv->module_excludes);
+    if (!static_cast<bool>(flags & libdnf::Query::ExcludeFlags::IGNORE_REGULAR_EXCLUDES)) {
+        if (priv->repo_excludes)
+            map_subtract(*considered, priv->repo_excludes);
+        if (priv->pkg_excludes)
+            map_subtract(*considered, priv->pkg_excludes);
+        if (priv->pkg_includes) {
+            map_grow(priv->pkg_includes, pool->nsolvables);
+            Map pkg_includes_tmp;
+            map_init_clone(&pkg_includes_tmp, priv->pkg_includes);
+
+            // Add all solvables from repositories which do not use "includes"
+            if (!priv->includes_unused) {
+                priv->includes_unused = static_cast<Map *>(g_malloc0(sizeof(Map)));
+                map_init(priv->includes_unused, pool->nsolvables);
+                Id repoid;
+                Repo *repo;
+                FOR_REPOS(repoid, repo) {
+                    auto hyrepo = static_cast<HyRepo>(repo->appdata);
+                    if (!hyrepo->getUseIncludes()) {
+                        Id solvableid;
+                        Solvable *solvable;
+                        FOR_REPO_SOLVABLES(repo, solvableid, solvable)
+                            MAPSET(priv->includes_unused, solvableid);
+                    }
+                }
+            }
+            map_or(&pkg_includes_tmp, priv->includes_unused);
+
+            map_and(*considered, &pkg_includes_tmp);
+            map_free(&pkg_includes_tmp);
+        }
+    }
+}
+
+/**
+ * dnf_sack_recompute_considered:
+ * @sack: a #DnfSack instance.
+ *
+ * Recompute considered packages for libsolv and queries.
+ *
+ * Since: 0.7.0
+ */
+void
+dnf_sack_recompute_considered(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+    if (priv->considered_uptodate)
+        return;
+    dnf_sack_recompute_considered_map(
+        sack, &pool->considered, libdnf::Query::ExcludeFlags::APPLY_EXCLUDES);
+    priv->considered_uptodate = TRUE;
+}
+
+struct CacheWriteJob {
+    CacheWriter *writer;
+    std::string fn;
+    char *data;                         /* from open_memstream(), released by free() */
+    size_t size;
+    std::string checksumFn;             /* written after fn if not empty */
+    unsigned char checksum[CHKSUM_BYTES];
+};
+
+static void
+cache_write_cb(gpointer data, gpointer)
+{
+    std::unique_ptr<CacheWriteJob> job(static_cast<CacheWriteJob *>(data));
+    g_autoptr(GError) error_local = NULL;
+
+    /* g_file_set_contents() writes a temporary file and renames it over fn */
+    if (!g_file_set_contents(job->fn.c_str(), job->data, job->size, &error_local))
+        g_warning("failed writing solv cache: %s", error_local->message);
+    else if (!job->checksumFn.empty())
+        g_file_set_contents(job->checksumFn.c_str(), reinterpret_cast<const gchar *>(job->checksum),
+                            CHKSUM_BYTES, NULL);
+    free(job->data);
+
+    CacheWriter *writer = job->writer;
+    std::lock_guard<std::mutex> guard(writer->mutex);
+    writer->pending.erase(writer->pending.find(job->fn));
+    writer->written.notify_all();
+}
+
+/* Queues writing the serialized solv file data to fn, taking the ownership of data. A single
+ * thread writes the files, so later writes of the same file land last. */
+static void
+queue_cache_write(DnfSack *sack, const char *fn, char *data, size_t size,
+                  const char *checksum_fn, const unsigned char *checksum)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->cache_writer) {
+        priv->cache_writer = new CacheWriter;
+        priv->cache_writer->thread = g_thread_pool_new(cache_write_cb, NULL, 1, FALSE, NULL);
+    }
+    auto job = new CacheWriteJob;
+    job->writer = priv->cache_writer;
+    job->fn = fn;
+    job->data = data;
+    job->size = size;
+    if (checksum_fn) {
+        job->checksumFn = checksum_fn;
+        memcpy(job->checksum, checksum, CHKSUM_BYTES);
+    }
+    {
+        std::lock_guard<std::mutex> guard(priv->cache_writer->mutex);
+        priv->cache_writer->pending.insert(job->fn);
+    }
+    g_debug("queued writing solv cache %s", fn);
+    g_thread_pool_push(priv->cache_writer->thread, job, NULL);
+}
+
+/* waits until the queued writes of the cache file fn are finished */
+static void
+wait_cache_write(DnfSack *sack, const char *fn)
+{
+    CacheWriter *writer = GET_PRIVATE(sack)->cache_writer;
+    if (!writer)
+        return;
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    writer->written.wait(lock, [writer, fn] { return writer->pending.count(fn) == 0; });
+}
+
+static gboolean
+load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
+         const char *suffix, const char * which_filename,
+         int (*cb)(Repo *, FILE *), GError **error)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    int ret = 0;
+    auto repoImpl = libdnf::repoGetImpl(hrepo);
+    Repo *repo = repoImpl->libsolvRepo;
+    const char *name = repo->name;
+    FILE *fp;
+    gboolean done = FALSE;
+
+    char *fn_cache =  dnf_sack_give_cache_fn(sack, name, suffix);
+    assert(libdnf::repoGetImpl(hrepo)->checksum);
+
+    int flags = 0;
+    /* the updateinfo is not a real extension */
+    if (which_repodata != _HY_REPODATA_UPDATEINFO)
+        flags |= REPO_EXTEND_SOLVABLES;
+    /* do not pollute the main pool with directory component ids */
+    if (which_repodata == _HY_REPODATA_FILENAMES || which_repodata == _HY_REPODATA_OTHER)
+        flags |= REPO_LOCALPOOL;
+    wait_cache_write(sack, fn_cache);
+    if (try_to_use_cached_solvfile(fn_cache, repo, flags, libdnf::repoGetImpl(hrepo)->checksum, error)) {
+        g_debug("%s: using cache file: %s", __func__, fn_cache);
+        done = TRUE;
+        repo_update_state(hrepo, which_repodata, _HY_LOADED_CACHE);
+        repo_set_repodata(hrepo, which_repodata, repo->nrepodata - 1);
+    }
+    if (error && *error) {
+        g_prefix_error(error, _("Loading extension cache %s (%d) failed: "), fn_cache, which_repodata);
+        return FALSE;
+    }
+
+    g_free(fn_cache);
+    if (done)
+        return TRUE;
+
+    auto fn = hrepo->getMetadataPath(which_filename);
+    /* nothing set */
+    if (fn.empty()) {
+        g_set_error (error,
+                     DNF_ERROR,
+                     DNF_ERROR_NO_CAPABILITY,
+                     _("no %1$s string for %2$s"),
+                     which_filename, name);
+        return FALSE;
+    }
+
+    fp = solv_xfopen(fn.c_str(), "r");
+    if (fp == NULL) {
+        g_set_error (error,
+                     DNF_ERROR,
+                     DNF_ERROR_FILE_INVALID,
+                     _("failed to open: %s"), fn.c_str());
+        return FALSE;
+    }
+    g_debug("%s: loading: %s", __func__, fn.c_str());
+
+    int previous_last = repo->nrepodata - 1;
+    ret = cb(repo, fp);
+    fclose(fp);
+    if (ret == 0) {
+        repo_update_state(hrepo, which_repodata, _HY_LOADED_FETCH);
+        assert(previous_last == repo->nrepodata - 2); (void)previous_last;
+        repo_set_repodata(hrepo, which_repodata, repo->nrepodata - 1);
+    }
+    priv->provides_ready = 0;
+    return TRUE;
+}
+
+static int
+load_filelists_cb(Repo *repo, FILE *fp)
+{
+    if (repo_add_rpmmd(repo, fp, "FL", REPO_EXTEND_SOLVABLES))
+        return DNF_ERROR_INTERNAL_ERROR;
+    return 0;
+}
+
+static int
+load_presto_cb(Repo *repo, FILE *fp)
+{
+    if (repo_add_deltainfoxml(repo, fp, 0))
+        return DNF_ERROR_INTERNAL_ERROR;
+    return 0;
+}
+
+static int
+load_updateinfo_cb(Repo *repo, FILE *fp)
+{
+    if (repo_add_updateinfoxml(repo, fp, 0))
+        return DNF_ERROR_INTERNAL_ERROR;
+    return 0;
+}
+
+/* same as load_updateinfo_cb, but the descriptions are dropped before the repodata is
+   internalized; dnf_sack_get_slim_advisory_description() reads them back when asked for */
+static int
+load_updateinfo_slim_cb(Repo *repo, FILE *fp)
+{
+    if (repo_add_updateinfoxml(repo, fp, REPO_NO_INTERNALIZE))
+        return DNF_ERROR_INTERNAL_ERROR;
+    Repodata *data = repo_last_repodata(repo);
+    for (Id p = data->start; p < data->end; ++p)
+        repodata_unset(data, p, SOLVABLE_DESCRIPTION);
+    repodata_internalize(data);
+    return 0;
+}
+
+const char *
+dnf_sack_get_slim_advisory_description(DnfSack *sack, Id advisory)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Solvable *s = pool_id2solvable(pool, advisory);
+    auto hrepo = static_cast<HyRepo>(s->repo->appdata);
+    if (!hrepo)
+        return NULL;
+    auto repoImpl = libdnf::repoGetImpl(hrepo);
+    if (!(repoImpl->load_flags & DNF_SACK_LOAD_FLAG_SLIM_UPDATEINFO))
+        return NULL;
+
+    auto & descriptions = repoImpl->updateinfoDescriptions;
+    if (!descriptions) {
+        descriptions.reset(new std::map<std::string, std::string>);
+        auto fn = hrepo->getMetadataPath(MD_TYPE_UPDATEINFO);
+        FILE *fp = fn.empty() ? NULL : solv_xfopen(fn.c_str(), "r");
+        if (fp) {
+            /* parse into a private pool, so the main pool keeps no trace of the texts */
+            Pool *tmpPool = pool_create();
+            Repo *tmpRepo = repo_create(tmpPool, s->repo->name);
+            if (repo_add_updateinfoxml(tmpRepo, fp, 0) == 0) {
+                Id p;
+                Solvable *tmpSolvable;
+                FOR_REPO_SOLVABLES(tmpRepo, p, tmpSolvable) {
+                    const char *description = solvable_lookup_str(tmpSolvable, SOLVABLE_DESCRIPTION);
+                    if (description)
+                        descriptions->emplace(pool_id2str(tmpPool, tmpSolvable->name), description);
+                }
+            } else {
+                g_debug("%s: failed to read descriptions from %s: %s",
+                        __func__, fn.c_str(), pool_errstr(tmpPool));
+            }
+            fclose(fp);
+            pool_free(tmpPool);
+        }
+    }
+
+    auto it = descriptions->find(pool_id2str(pool, s->name));
+    return it == descriptions->end() ? NULL : it->second.c_str();
+}
+
+static int
+load_other_cb(Repo *repo, FILE *fp)
+{
+    if (repo_add_rpmmd(repo, fp, 0, REPO_EXTEND_SOLVABLES))
+        return DNF_ERROR_INTERNAL_ERROR;
+    return 0;
 }
 
 static int
@@ -495,6 +1706,113 @@ repo_is_one_piece(Repo *repo)
     return 1;
 }
 
+/* the checksum of the primary the main solv file was created from is kept next to it */
+static char *
+give_primary_checksum_fn(DnfSack *sack, const char *reponame)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    char *fn = solv_dupjoin(priv->cache_dir, "/", reponame);
+    return solv_dupappend(fn, "-primary.chksum", NULL);
+}
+
+/* the caches in the shared cache directory are named by the checksum they were made for,
+ * NULL without a shared cache directory */
+static char *
+give_shared_cache_fn(DnfSack *sack, const unsigned char *key, const char *suffix)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->shared_cache_dir)
+        return NULL;
+    char hex[2 * CHKSUM_BYTES + 1];
+    solv_bin2hex(key, CHKSUM_BYTES, hex);
+    return g_strconcat(priv->shared_cache_dir, "/", hex, suffix, NULL);
+}
+
+/* Copies the written cache fn into the shared cache directory unless another process did it
+ * already. The copy is renamed into place, the readers never see a partial file. */
+static void
+publish_shared_cache_file(const char *fn, const char *shared_fn)
+{
+    if (access(shared_fn, F_OK) == 0)
+        return;
+    g_autofree gchar *tmp_fn = g_strdup_printf("%s.%d", shared_fn, (int) getpid());
+    g_autoptr(GError) error_local = NULL;
+    unlink(tmp_fn);
+    if (!dnf_copy_file(fn, tmp_fn, &error_local) || !mv(tmp_fn, shared_fn, &error_local) ||
+        chmod(shared_fn, 0644) != 0) {
+        g_debug("failed publishing %s as %s: %s", fn, shared_fn,
+                error_local ? error_local->message : strerror(errno));
+        unlink(tmp_fn);
+        return;
+    }
+    g_debug("published %s as %s", fn, shared_fn);
+}
+
+static gboolean
+primary_checksum(HyRepo hrepo, unsigned char *out)
+{
+    auto primary = hrepo->getMetadataPath(MD_TYPE_PRIMARY);
+    if (primary.empty())
+        return FALSE;
+    FILE *fp = fopen(primary.c_str(), "r");
+    if (!fp)
+        return FALSE;
+    checksum_fp(out, fp);
+    fclose(fp);
+    return TRUE;
+}
+
+/* TRUE if the cached main solv file was created from the current primary */
+static gboolean
+primary_unchanged(DnfSack *sack, HyRepo hrepo, const char *reponame)
+{
+    unsigned char current[CHKSUM_BYTES];
+    g_autofree char *fn = give_primary_checksum_fn(sack, reponame);
+    g_autofree gchar *stored = NULL;
+    gsize length = 0;
+    if (!g_file_get_contents(fn, &stored, &length, NULL) || length != CHKSUM_BYTES)
+        return FALSE;
+    if (!primary_checksum(hrepo, current))
+        return FALSE;
+    return checksum_cmp(current, reinterpret_cast<unsigned char *>(stored)) == 0;
+}
+
+/* Loads the prebuilt solv file of the primary published in the repomd ("primary_solv"), if
+ * it was made from the same primary by the same libsolv. The snapshot is verified by librepo
+ * against the checksum in the repomd, which is itself signed with repo_gpgcheck. */
+static gboolean
+load_solv_snapshot(HyRepo hrepo, Repo *repo)
+{
+    auto snapshot = hrepo->getMetadataPath(MD_TYPE_PRIMARY_SOLV);
+    unsigned char primary_chksum[CHKSUM_BYTES];
+    if (snapshot.empty() || !primary_checksum(hrepo, primary_chksum))
+        return FALSE;
+    // the snapshot may be compressed, the stream can not be rewound after reading the userdata
+    FILE *fp = solv_xfopen(snapshot.c_str(), "r");
+    if (!fp) {
+        g_warning("Failed to open solv snapshot %s: %s", snapshot.c_str(), strerror(errno));
+        return FALSE;
+    }
+    auto solv_userdata = solv_userdata_read(fp);
+    fclose(fp);
+    if (!solv_userdata || !solv_userdata_verify(solv_userdata.get(), primary_chksum)) {
+        g_debug("solv snapshot %s was not made from the primary or by this libsolv",
+                snapshot.c_str());
+        return FALSE;
+    }
+    fp = solv_xfopen(snapshot.c_str(), "r");
+    if (!fp)
+        return FALSE;
+    int rc = repo_add_solv(repo, fp, 0);
+    fclose(fp);
+    if (rc) {
+        g_warning("Failed to load solv snapshot %s: %s", snapshot.c_str(),
+                  pool_errstr(repo->pool));
+        return FALSE;
+    }
+    return TRUE;
+}
+
 static gboolean
 write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
 {
@@ -504,13 +1822,20 @@ write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
     const char *chksum = pool_checksum_str(dnf_sack_get_pool(sack), repoImpl->checksum);
     char *fn = dnf_sack_give_cache_fn(sack, name, NULL);
     char *tmp_fn_templ = solv_dupjoin(fn, ".XXXXXX", NULL);
-    int tmp_fd  = mkstemp(tmp_fn_templ);
+    g_autofree char *primary_chksum_fn = give_primary_checksum_fn(sack, name);
+    bool background = repoImpl->load_flags & DNF_SACK_LOAD_FLAG_BACKGROUND_CACHE;
+    char *data = NULL;
+    size_t data_size = 0;
+    int tmp_fd = background ? -1 : mkstemp(tmp_fn_templ);
     gboolean ret = TRUE;
     gint rc;
+    unsigned char primary_chksum[CHKSUM_BYTES];
 
     g_debug("caching repo: %s (0x%s)", name, chksum);
+    /* the old primary checksum must not outlive the solv file it describes */
+    unlink(primary_chksum_fn);
 
-    if (tmp_fd < 0) {
+    if (!background && tmp_fd < 0) {
         ret = FALSE;
         g_set_error (error,
                      DNF_ERROR,
@@ -519,7 +1844,8 @@ write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
                      tmp_fn_templ);
         goto done;
     } else {
-        FILE *fp = fdopen(tmp_fd, "w+");
+        FILE *fp = solv_cache_fwrap_write(background ? open_memstream(&data, &data_size)
+                                                     : fdopen(tmp_fd, "w+"));
         if (!fp) {
             ret = FALSE;
             g_set_error (error,
@@ -531,7 +1857,7 @@ write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
         }
 
         SolvUserdata solv_userdata;
-        if (solv_userdata_fill(&solv_userdata, repoImpl->checksum, error)) {
+        if (solv_userdata_fill(&solv_userdata, repoImpl->checksum, repoImpl->repomdStat, error)) {
             ret = FALSE;
             fclose(fp);
             goto done;
@@ -562,10 +1888,20 @@ write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
             goto done;
         }
     }
+    if (background) {
+        /* the parsed data stays in use, there is nothing to switch over to */
+        bool have_chksum = primary_checksum(hrepo, primary_chksum);
+        queue_cache_write(sack, fn, data, data_size, have_chksum ? primary_chksum_fn : NULL,
+                          primary_chksum);
+        data = NULL;
+        repoImpl->state_main = _HY_WRITTEN;
+        goto done;
+    }
     if (switchtosolv && repo_is_one_piece(repo)) {
         repo_empty(repo, 1);
         /* switch over to written solv file activate paging */
-        gboolean loaded = try_to_use_cached_solvfile(tmp_fn_templ, repo, 0, repoImpl->checksum, error);
+        gboolean loaded = try_to_use_cached_solvfile(tmp_fn_templ, repo, 0, repoImpl->checksum, error,
+                                                     repoImpl->load_flags & DNF_SACK_LOAD_FLAG_USE_MMAP);
         if (error && *error) {
             g_prefix_error(error, _("Failed to use newly written primary cache: %s: "), tmp_fn_templ);
             ret = FALSE;
@@ -583,10 +1919,19 @@ write_main(DnfSack *sack, HyRepo hrepo, int switchtosolv, GError **error)
     if (!ret)
         goto done;
     repoImpl->state_main = _HY_WRITTEN;
+    if (primary_checksum(hrepo, primary_chksum))
+        g_file_set_contents(primary_chksum_fn, reinterpret_cast<const gchar *>(primary_chksum),
+                            CHKSUM_BYTES, NULL);
+    /* the caches written in the background are not shared, they are not on disk yet */
+    if (char *shared_fn = give_shared_cache_fn(sack, repoImpl->checksum, ".solv")) {
+        publish_shared_cache_file(fn, shared_fn);
+        g_free(shared_fn);
+    }
 
  done:
     if (!ret && tmp_fd >= 0)
         unlink(tmp_fn_templ);
+    free(data);
     g_free(tmp_fn_templ);
     g_free(fn);
     return ret;
@@ -616,9 +1961,12 @@ write_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
     Repodata *data = repo_id2repodata(repo, repodata);
     char *fn = dnf_sack_give_cache_fn(sack, name, suffix);
     char *tmp_fn_templ = solv_dupjoin(fn, ".XXXXXX", NULL);
-    int tmp_fd = mkstemp(tmp_fn_templ);
+    bool background = repoImpl->load_flags & DNF_SACK_LOAD_FLAG_BACKGROUND_CACHE;
+    char *buf = NULL;
+    size_t buf_size = 0;
+    int tmp_fd = background ? -1 : mkstemp(tmp_fn_templ);
     gboolean success;
-    if (tmp_fd < 0) {
+    if (!background && tmp_fd < 0) {
         success = FALSE;
         g_set_error (error,
                      DNF_ERROR,
@@ -627,12 +1975,22 @@ write_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
                      tmp_fn_templ);
         goto done;
     } else {
-        FILE *fp = fdopen(tmp_fd, "w+");
+        FILE *fp = solv_cache_fwrap_write(background ? open_memstream(&buf, &buf_size)
+                                                     : fdopen(tmp_fd, "w+"));
+        if (!fp) {
+            success = FALSE;
+            g_set_error (error,
+                        DNF_ERROR,
+                        DNF_ERROR_FILE_INVALID,
+                        _("failed opening tmp file: %s"),
+                        strerror(errno));
+            goto done;
+        }
 
         g_debug("%s: storing %s to: %s", __func__, repo->name, tmp_fn_templ);
 
         SolvUserdata solv_userdata;
-        if (solv_userdata_fill(&solv_userdata, repoImpl->checksum, error)) {
+        if (solv_userdata_fill(&solv_userdata, repoImpl->checksum, NULL, error)) {
             fclose(fp);
             success = FALSE;
             goto done;
@@ -679,6 +2037,13 @@ write_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
         }
     }
 
+    if (background) {
+        queue_cache_write(sack, fn, buf, buf_size, NULL, NULL);
+        buf = NULL;
+        repo_update_state(hrepo, which_repodata, _HY_WRITTEN);
+        success = TRUE;
+        goto done;
+    }
     if (repo_is_one_piece(repo) && which_repodata != _HY_REPODATA_UPDATEINFO) {
         /* switch over to written solv file activate paging */
         int flags = REPO_USE_LOADING | REPO_EXTEND_SOLVABLES;
@@ -713,19 +2078,54 @@ write_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
  done:
     if (ret && tmp_fd >=0 )
         unlink(tmp_fn_templ);
+    free(buf);
     g_free(tmp_fn_templ);
     g_free(fn);
     return success;
 }
 
+/* Computes the checksum of the repomd.xml in @fp_repomd and its checksum_stat()
+ * into @out_stat. While the solv cache @fn_cache is younger than the repomd stat
+ * max age and was written for a repomd.xml with the same stat, the checksum
+ * recorded in it is taken without reading the file. */
+static void
+repomd_checksum(DnfSack *sack, FILE *fp_repomd, const char *fn_cache,
+                unsigned char *out, unsigned char *out_stat)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+
+    if (checksum_stat(out_stat, fp_repomd)) {
+        memset(out_stat, 0, CHKSUM_BYTES);
+    } else if (priv->repomd_stat_max_age > 0) {
+        FILE *fp_cache = fopen(fn_cache, "r");
+        if (fp_cache) {
+            struct stat st;
+            std::unique_ptr<SolvUserdata> solv_userdata;
+            if (fstat(fileno(fp_cache), &st) == 0 &&
+                time(NULL) - st.st_mtime < static_cast<time_t>(priv->repomd_stat_max_age) &&
+                (fp_cache = solv_cache_fwrap_read(fp_cache)))
+                solv_userdata = solv_userdata_read(fp_cache);
+            if (fp_cache)
+                fclose(fp_cache);
+            if (solv_userdata && checksum_cmp(solv_userdata->repomd_stat, out_stat) == 0) {
+                memcpy(out, solv_userdata->checksum, CHKSUM_BYTES);
+                return;
+            }
+        }
+    }
+    checksum_fp(out, fp_repomd);
+}
+
 static gboolean
-load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
+load_yum_repo(DnfSack *sack, HyRepo hrepo, int flags, GError **error)
 {
     auto repoImpl = libdnf::repoGetImpl(hrepo);
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     gboolean retval = TRUE;
     Pool *pool = priv->pool;
     const char *name = hrepo->getId().c_str();
+    libdnf::PhaseTimer timer("load_yum_repo", name);
+    LIBDNF_PROBE(load_repo_start, name);
     Repo *repo = repo_create(pool, name);
     const char *fn_repomd = repoImpl->repomdFn.c_str();
     char *fn_cache = dnf_sack_give_cache_fn(sack, name, NULL);
@@ -751,9 +2151,11 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
         retval = FALSE;
         goto out;
     }
-    checksum_fp(repoImpl->checksum, fp_repomd);
+    wait_cache_write(sack, fn_cache);
+    repomd_checksum(sack, fp_repomd, fn_cache, repoImpl->checksum, repoImpl->repomdStat);
 
-    if (try_to_use_cached_solvfile(fn_cache, repo, 0, repoImpl->checksum, error)) {
+    if (try_to_use_cached_solvfile(fn_cache, repo, 0, repoImpl->checksum, error,
+                                   flags & DNF_SACK_LOAD_FLAG_USE_MMAP)) {
         const char *chksum = pool_checksum_str(pool, repoImpl->checksum);
         g_debug("using cached %s (0x%s)", name, chksum);
         repoImpl->state_main = _HY_LOADED_CACHE;
@@ -765,7 +2167,85 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
         retval = FALSE;
         goto out;
     } else {
+        // another process may have cached the same repomd in the shared cache directory, it
+        // is written into the own cache directory too
+        g_autofree char *fn_shared = give_shared_cache_fn(sack, repoImpl->checksum, ".solv");
+        if (fn_shared &&
+            try_to_use_cached_solvfile(fn_shared, repo, 0, repoImpl->checksum, error,
+                                       flags & DNF_SACK_LOAD_FLAG_USE_MMAP, true)) {
+            g_debug("using shared %s for %s", fn_shared, name);
+            repoImpl->state_main = _HY_LOADED_FETCH;
+            goto out;
+        }
+        if (error && *error) {
+            g_prefix_error(error, _("While loading repository failed to use %s: "), fn_shared);
+            retval = FALSE;
+            goto out;
+        }
+
+        // only other metadata changed, the primary needs no parsing again, the solv file is
+        // rewritten with the new repomd checksum and the data of the new repomd
+        if (primary_unchanged(sack, hrepo, name) &&
+            try_to_use_cached_solvfile(fn_cache, repo, 0, NULL, error,
+                                       flags & DNF_SACK_LOAD_FLAG_USE_MMAP)) {
+            g_debug("primary of %s did not change, using %s", name, fn_cache);
+            for (Id key : {REPOSITORY_TIMESTAMP, REPOSITORY_EXPIRE, REPOSITORY_REVISION,
+                           REPOSITORY_KEYWORDS, REPOSITORY_DISTROS, REPOSITORY_UPDATES,
+                           REPOSITORY_REPOID, REPOSITORY_REPOMD})
+                repo_unset(repo, SOLVID_META, key);
+            g_debug("Loading repomd: %s", fn_repomd);
+            if (repo_add_repomdxml(repo, fp_repomd, 0)) {
+                g_set_error (error,
+                             DNF_ERROR,
+                             DNF_ERROR_INTERNAL_ERROR,
+                             _("Loading repomd has failed: %s"),
+                             pool_errstr(repo->pool));
+                retval = FALSE;
+                goto out;
+            }
+            repoImpl->state_main = _HY_LOADED_FETCH;
+            goto out;
+        }
+        if (error && *error) {
+            g_prefix_error(error, _("While loading repository failed to use %s: "), fn_cache);
+            retval = FALSE;
+            goto out;
+        }
+
         auto primary = hrepo->getMetadataPath(MD_TYPE_PRIMARY);
+        if (primary.empty() && repoImpl->streamPrimaryPending()) {
+            g_debug("Loading repomd: %s", fn_repomd);
+            if (repo_add_repomdxml(repo, fp_repomd, 0)) {
+                g_set_error (error,
+                             DNF_ERROR,
+                             DNF_ERROR_INTERNAL_ERROR,
+                             _("Loading repomd has failed: %s"),
+                             pool_errstr(repo->pool));
+                retval = FALSE;
+                goto out;
+            }
+            g_debug("Streaming primary of %s", name);
+            try {
+                if (repoImpl->streamPrimaryLoad([repo](FILE *fp) {
+                        return repo_add_rpmmd(repo, fp, 0, 0) == 0;
+                    })) {
+                    repoImpl->state_main = _HY_LOADED_FETCH;
+                    goto out;
+                }
+            } catch (const std::exception & e) {
+                g_set_error (error,
+                             DNF_ERROR,
+                             DNF_ERROR_INTERNAL_ERROR,
+                             _("Downloading primary has failed: %s"),
+                             e.what());
+                retval = FALSE;
+                goto out;
+            }
+            // the streamed data were not usable, the downloaded primary is loaded from scratch
+            repo_empty(repo, 1);
+            rewind(fp_repomd);
+            primary = hrepo->getMetadataPath(MD_TYPE_PRIMARY);
+        }
         if (primary.empty()) {
             // It could happen when repomd file has no "primary" data or they are in unsupported
             // format like zchunk
@@ -798,15 +2278,19 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
             goto out;
         }
 
-        g_debug("Loading primary: %s", primary.c_str());
-        if (repo_add_rpmmd(repo, fp_primary, 0, 0)) {
-            g_set_error (error,
-                         DNF_ERROR,
-                         DNF_ERROR_INTERNAL_ERROR,
-                         _("Loading primary has failed: %s"),
-                         pool_errstr(repo->pool));
-            retval = FALSE;
-            goto out;
+        if (load_solv_snapshot(hrepo, repo)) {
+            g_debug("Loaded primary of %s from its solv snapshot", name);
+        } else {
+            g_debug("Loading primary: %s", primary.c_str());
+            if (repo_add_rpmmd(repo, fp_primary, 0, 0)) {
+                g_set_error (error,
+                             DNF_ERROR,
+                             DNF_ERROR_INTERNAL_ERROR,
+                             _("Loading primary has failed: %s"),
+                             pool_errstr(repo->pool));
+                retval = FALSE;
+                goto out;
+            }
         }
         repoImpl->state_main = _HY_LOADED_FETCH;
     }
@@ -816,10 +2300,13 @@ out:
     if (fp_primary)
         fclose(fp_primary);
     g_free(fn_cache);
+    LIBDNF_PROBE(load_repo_end, name, static_cast<int>(repoImpl->state_main == _HY_LOADED_CACHE),
+                 retval);
 
     if (retval) {
         libdnf::repoGetImpl(hrepo)->attachLibsolvRepo(repo);
         priv->provides_ready = 0;
+        dnf_sack_invalidate_solvable_indexes(sack);
     } else
         repo_free(repo, 1);
     return retval;
@@ -842,6 +2329,49 @@ dnf_sack_set_cachedir (DnfSack *sack, const gchar *value)
     priv->cache_dir = g_strdup(value);
 }
 
+/**
+ * dnf_sack_set_shared_cachedir:
+ * @sack: a #DnfSack instance.
+ * @value: a filesystem path, e.g. "/run/libdnf", or %NULL.
+ *
+ * Sets a directory shared by the processes of the host for the solv caches
+ * of the repos, named by the checksums of their repomd.xml. A repo missing in
+ * the own cache directory is loaded from a shared solv cache made for the same
+ * repomd.xml before its primary is parsed, the solv caches this sack writes
+ * are published there for the other processes. The files are shared in the
+ * page cache by all the processes reading them. The whatprovides cache is not
+ * shared, its Ids depend on how each cache directory got its solv files.
+ *
+ * Only regular files owned by root or the current user and not writable by
+ * others are used, symlinks are not followed. The directory itself should be
+ * writable only by the trusted users.
+ * The default %NULL shares nothing.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_set_shared_cachedir(DnfSack *sack, const gchar *value)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    g_free(priv->shared_cache_dir);
+    priv->shared_cache_dir = g_strdup(value);
+}
+
+/**
+ * dnf_sack_get_shared_cachedir:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: the shared cache directory, or %NULL if none is set.
+ *
+ * Since: 0.70.0
+ */
+const gchar *
+dnf_sack_get_shared_cachedir(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->shared_cache_dir;
+}
+
 /**
  * dnf_sack_set_arch:
  * @sack: a #DnfSack instance.
@@ -935,30 +2465,188 @@ dnf_sack_get_all_arch (DnfSack *sack)
  *
  * */
 void
-dnf_sack_set_allow_vendor_change(DnfSack *sack, gboolean allow_vendor_change)
+dnf_sack_set_allow_vendor_change(DnfSack *sack, gboolean allow_vendor_change)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->allow_vendor_change = allow_vendor_change;
+    dnf_sack_bump_generation(sack);
+}
+
+/*
+ * dnf_sack_get_allow_vendor_change:
+ * @sack: a #DnfSack instance.
+ * @allow_vendor_change is a boolean.
+ *
+ * Gets the value of allow vendor change to use for
+ * SOLVER_FLAG_ALLOW_VENDORCHANGE flag
+ *
+ * Returns: True if flag set to 1, False if set to 0
+ *
+ * Since: 0.54.3
+ *
+ * */
+gboolean
+dnf_sack_get_allow_vendor_change(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->allow_vendor_change;
+}
+
+/**
+ * dnf_sack_set_use_query_cache:
+ * @sack: a #DnfSack instance.
+ * @enabled: whether to cache query results.
+ *
+ * Enables caching of query results in the sack. Applying a fresh query whose
+ * filters and exclude flags are identical to a query applied earlier returns
+ * a copy of the earlier result. The cache is emptied whenever the sack
+ * changes in a way that could change query results.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_set_use_query_cache(DnfSack *sack, gboolean enabled)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->use_query_cache = enabled;
+    if (!enabled && priv->query_cache) {
+        delete priv->query_cache;
+        priv->query_cache = NULL;
+    }
+}
+
+/**
+ * dnf_sack_get_use_query_cache:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: %TRUE if query results are cached
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_get_use_query_cache(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->use_query_cache;
+}
+
+static void
+package_cache_weak_notify(gpointer data, GObject *where_the_object_was)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(DNF_SACK(data));
+    /* the package is disposed, but not finalized yet */
+    Id id = dnf_package_get_id(DNF_PACKAGE(where_the_object_was));
+    g_hash_table_remove(priv->package_cache, GINT_TO_POINTER(id));
+}
+
+static gboolean
+package_cache_weak_unref(gpointer key, gpointer value, gpointer user_data)
+{
+    g_object_weak_unref(G_OBJECT(value), package_cache_weak_notify, user_data);
+    return TRUE;
+}
+
+/**
+ * dnf_sack_set_use_package_cache:
+ * @sack: a #DnfSack instance.
+ * @enabled: whether to share the package objects.
+ *
+ * Enables sharing of #DnfPackage objects. While a #DnfPackage of a solvable
+ * is alive, dnf_package_new() returns another reference to it instead of a
+ * new object, so the data cached in it like the package ID or the filename
+ * is computed once. The data set on the package, e.g. by
+ * dnf_package_set_action(), is shared as well.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_set_use_package_cache(DnfSack *sack, gboolean enabled)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->use_package_cache = enabled;
+    if (!enabled && priv->package_cache) {
+        g_hash_table_foreach_remove(priv->package_cache, package_cache_weak_unref, sack);
+        g_hash_table_unref(priv->package_cache);
+        priv->package_cache = NULL;
+    }
+}
+
+/**
+ * dnf_sack_get_use_package_cache:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: %TRUE if the #DnfPackage objects are shared
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_get_use_package_cache(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->use_package_cache;
+}
+
+DnfPackage *
+dnf_sack_package_cache_lookup(DnfSack *sack, Id id)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->use_package_cache || !priv->package_cache)
+        return NULL;
+    auto pkg = static_cast<DnfPackage *>(g_hash_table_lookup(priv->package_cache,
+                                                             GINT_TO_POINTER(id)));
+    return pkg ? DNF_PACKAGE(g_object_ref(pkg)) : NULL;
+}
+
+void
+dnf_sack_package_cache_store(DnfSack *sack, DnfPackage *pkg)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    priv->allow_vendor_change = allow_vendor_change;
+    if (!priv->use_package_cache)
+        return;
+    if (!priv->package_cache)
+        priv->package_cache = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_object_weak_ref(G_OBJECT(pkg), package_cache_weak_notify, sack);
+    g_hash_table_insert(priv->package_cache, GINT_TO_POINTER(dnf_package_get_id(pkg)), pkg);
 }
 
-/*
- * dnf_sack_get_allow_vendor_change:
+/**
+ * dnf_sack_set_use_substring_index:
  * @sack: a #DnfSack instance.
- * @allow_vendor_change is a boolean.
+ * @enabled: whether to index strings for substring filters.
  *
- * Gets the value of allow vendor change to use for
- * SOLVER_FLAG_ALLOW_VENDORCHANGE flag
+ * Enables trigram indexes of package summaries, descriptions and URLs. Each
+ * index is built on the first %HY_SUBSTR filter of its key with a match of at
+ * least three characters, such filters then only check the packages
+ * containing all trigrams of the match. When all repos are loaded from solv
+ * caches the indexes are stored in the cache directory and reused by later
+ * sacks with the same repos.
  *
- * Returns: True if flag set to 1, False if set to 0
+ * Since: 0.70.0
+ */
+void
+dnf_sack_set_use_substring_index(DnfSack *sack, gboolean enabled)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->use_substring_index = enabled;
+    if (!enabled && priv->substring_indexes) {
+        delete priv->substring_indexes;
+        priv->substring_indexes = NULL;
+    }
+}
+
+/**
+ * dnf_sack_get_use_substring_index:
+ * @sack: a #DnfSack instance.
  *
- * Since: 0.54.3
+ * Returns: %TRUE if substring filters use trigram indexes
  *
- * */
+ * Since: 0.70.0
+ */
 gboolean
-dnf_sack_get_allow_vendor_change(DnfSack *sack)
+dnf_sack_get_use_substring_index(DnfSack *sack)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    return priv->allow_vendor_change;
+    return priv->use_substring_index;
 }
 
 /**
@@ -1005,6 +2693,14 @@ dnf_sack_set_rootdir (DnfSack *sack, const gchar *value)
  *
  * Sets up a new package sack, the fundamental hawkey structure.
  *
+ * With %DNF_SACK_SETUP_FLAG_HUGE_PAGES the solvables, strings, dependencies,
+ * whatprovides index and dependency arrays of the pool are advised to use
+ * transparent huge pages once the provides are ready, and the whatprovides
+ * index loaded from its cache is allocated in huge page aligned memory. This
+ * only has an effect with transparent huge pages in the "madvise" or "always"
+ * mode. The maps of package sets stay in regular pages, even a million
+ * solvables only need 128 kB of a map.
+ *
  * Returns: %TRUE for success
  *
  * Since: 0.7.0
@@ -1040,6 +2736,8 @@ dnf_sack_setup(DnfSack *sack, int flags, GError **error) try
         }
     }
 
+    priv->huge_pages = (flags & DNF_SACK_SETUP_FLAG_HUGE_PAGES) != 0;
+
     /* never called dnf_sack_set_arch(), so autodetect */
     if (!priv->have_set_arch && !priv->all_arch) {
         if (!dnf_sack_set_arch (sack, NULL, error))
@@ -1107,6 +2805,129 @@ dnf_sack_get_running_kernel(DnfSack *sack)
     return dnf_package_new(sack, id);
 }
 
+/* the data field of the package_id of a package of the repo, without the origin of
+ * installed packages */
+static const char *
+package_id_repo_data(Repo *repo)
+{
+    if (strcmp(repo->name, HY_SYSTEM_REPO_NAME) == 0)
+        return "installed";
+    if (strcmp(repo->name, HY_CMDLINE_REPO_NAME) == 0)
+        return "local";
+    return repo->name;
+}
+
+/**
+ * dnf_sack_get_package_ids: (skip)
+ * @sack: a #DnfSack instance.
+ * @pset: the packages.
+ * @origins: (nullable) (element-type utf8 utf8): the origin repos of the
+ *           installed packages by NEVRA, or %NULL
+ *
+ * Gets the package-ids as used by PackageKit of all the packages in @pset,
+ * in the order of the set. They are the same as dnf_package_get_package_id()
+ * returns when the origin of each installed package was set from @origins.
+ *
+ * The array and all the strings are allocated in one block.
+ *
+ * Returns: (transfer full): a %NULL terminated array of strings, free it with
+ *          g_free() and not g_strfreev()
+ *
+ * Since: 0.70.0
+ */
+gchar **
+dnf_sack_get_package_ids(DnfSack *sack, DnfPackageSet *pset, GHashTable *origins)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    std::unordered_map<Repo *, std::string> suffixes;
+    std::deque<std::string> installed;
+    std::vector<const std::string *> tails;
+    gsize length = 0;
+    Id id;
+
+    /* the ";data" suffix of each package, shared by the packages of a repo, and
+     * the length of all the strings */
+    for (id = pset->next(-1); id != -1; id = pset->next(id)) {
+        Solvable *s = pool_id2solvable(pool, id);
+        auto suffix = suffixes.find(s->repo);
+        if (suffix == suffixes.end())
+            suffix = suffixes.emplace(s->repo,
+                                      std::string(";") + package_id_repo_data(s->repo)).first;
+        const std::string *tail = &suffix->second;
+        if (origins && s->repo == pool->installed) {
+            auto origin = static_cast<const char *>(
+                g_hash_table_lookup(origins, pool_solvable2str(pool, s)));
+            if (origin) {
+                installed.push_back(suffix->second + ":" + origin);
+                tail = &installed.back();
+            }
+        }
+        tails.push_back(tail);
+        length += strlen(pool_id2str(pool, s->name)) + strlen(pool_id2str(pool, s->evr)) +
+                  strlen(pool_id2str(pool, s->arch)) + tail->size() + 3;
+    }
+
+    auto ids = static_cast<gchar **>(g_malloc((tails.size() + 1) * sizeof(gchar *) + length));
+    auto p = reinterpret_cast<gchar *>(ids + tails.size() + 1);
+    gsize i = 0;
+    for (id = pset->next(-1); id != -1; id = pset->next(id), ++i) {
+        Solvable *s = pool_id2solvable(pool, id);
+        ids[i] = p;
+        p = g_stpcpy(p, pool_id2str(pool, s->name));
+        *p++ = ';';
+        p = g_stpcpy(p, pool_id2str(pool, s->evr));
+        *p++ = ';';
+        p = g_stpcpy(p, pool_id2str(pool, s->arch));
+        p = g_stpcpy(p, tails[i]->c_str()) + 1;
+    }
+    ids[i] = NULL;
+    return ids;
+}
+
+/**
+ * dnf_sack_get_package_by_package_id:
+ * @sack: a #DnfSack instance.
+ * @package_id: a package-id as used by PackageKit, e.g. "hal;2:0.3.4;i386;fedora"
+ *
+ * Finds the package of a package-id, e.g. as returned by
+ * dnf_package_get_package_id(). The origin of installed packages in the
+ * data field is ignored.
+ *
+ * Returns: (transfer full): a #DnfPackage, or %NULL
+ *
+ * Since: 0.70.0
+ */
+DnfPackage *
+dnf_sack_get_package_by_package_id(DnfSack *sack, const gchar *package_id)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+
+    if (!priv->package_id_index) {
+        priv->package_id_index = new std::unordered_map<std::string, Id>;
+        for (Id p = 2; p < pool->nsolvables; ++p) {
+            Solvable *s = pool_id2solvable(pool, p);
+            if (!s->repo)
+                continue;
+            std::string key(pool_id2str(pool, s->name));
+            key.append(";").append(pool_id2str(pool, s->evr));
+            key.append(";").append(pool_id2str(pool, s->arch));
+            key.append(";").append(package_id_repo_data(s->repo));
+            priv->package_id_index->emplace(std::move(key), p);
+        }
+    }
+
+    /* strip the origin appended to "installed" */
+    std::string key(package_id);
+    auto data = key.rfind(';');
+    if (data != std::string::npos && key.compare(data + 1, 10, "installed:") == 0)
+        key.resize(data + 1 + strlen("installed"));
+    auto it = priv->package_id_index->find(key);
+    if (it == priv->package_id_index->end())
+        return NULL;
+    return dnf_package_new(sack, it->second);
+}
+
 /**
  * dnf_sack_give_cache_fn:
  * @sack: a #DnfSack instance.
@@ -1234,6 +3055,41 @@ dnf_sack_get_installonly_limit(DnfSack *sack)
     return priv->installonly_limit;
 }
 
+/**
+ * dnf_sack_set_repomd_stat_max_age:
+ * @sack: a #DnfSack instance.
+ * @max_age: maximum age of a solv cache in seconds, or 0.
+ *
+ * Allows loading a repo without reading its repomd.xml when the solv cache
+ * was written less than @max_age seconds ago for a repomd.xml with the same
+ * device, inode, size and modification time. Older caches and any stat
+ * mismatch make the repomd.xml content hashed again. The default 0 always
+ * hashes repomd.xml.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_set_repomd_stat_max_age(DnfSack *sack, guint max_age)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->repomd_stat_max_age = max_age;
+}
+
+/**
+ * dnf_sack_get_repomd_stat_max_age:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: the maximum solv cache age for trusting the repomd.xml stat.
+ *
+ * Since: 0.70.0
+ */
+guint
+dnf_sack_get_repomd_stat_max_age(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->repomd_stat_max_age;
+}
+
 static Repo *
 dnf_sack_setup_cmdline_repo(DnfSack *sack)
 {
@@ -1261,6 +3117,7 @@ dnf_sack_add_cmdline_package_flags(DnfSack *sack, const char *fn, const int flag
     Repo *repo = dnf_sack_setup_cmdline_repo(sack);
     Id p;
     priv->provides_ready = 0;    /* triggers internalizing later */
+    dnf_sack_invalidate_solvable_indexes(sack);
     p = repo_add_rpm(repo, fn, flags);
     if (p == 0) {
         g_warning ("failed to read RPM: %s, skipping",
@@ -1299,6 +3156,124 @@ dnf_sack_add_cmdline_package_nochecksum(DnfSack *sack, const char *fn)
                                REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE);
 }
 
+struct CmdlineRpmsJob {
+    std::vector<const char *> fns;  /* a contiguous chunk of the files */
+    int flags;
+    char *solv;                     /* the read packages serialized by repo_write(), or NULL */
+    size_t solv_size;
+};
+
+/* reads the headers of the chunk into a pool of its own, the sack pool can not be shared */
+static void
+add_cmdline_rpms_cb(gpointer data, gpointer)
+{
+    auto job = static_cast<CmdlineRpmsJob *>(data);
+    Pool *pool = pool_create();
+    Repo *repo = repo_create(pool, HY_CMDLINE_REPO_NAME);
+    for (auto fn : job->fns) {
+        if (!repo_add_rpm(repo, fn, job->flags))
+            g_warning("failed to read RPM: %s, skipping", pool_errstr(pool));
+    }
+    repo_internalize(repo);
+    FILE *fp = open_memstream(&job->solv, &job->solv_size);
+    if (fp) {
+        int rc = repo_write(repo, fp);
+        if (fclose(fp) || rc) {
+            g_warning("failed to serialize RPMs: %s", pool_errstr(pool));
+            free(job->solv);
+            job->solv = NULL;
+        }
+    }
+    pool_free(pool);
+}
+
+GPtrArray *
+dnf_sack_add_cmdline_packages_flags(DnfSack *sack, const char *const *fns, const int flags)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    GPtrArray *packages = g_ptr_array_new_with_free_func(g_object_unref);
+    std::vector<const char *> readable;
+    for (guint i = 0; fns[i]; i++) {
+        if (is_readable_rpm(fns[i]))
+            readable.push_back(fns[i]);
+        else
+            g_warning("not a readable RPM file: %s, skipping", fns[i]);
+    }
+    if (readable.empty())
+        return packages;
+
+    /* contiguous chunks, added in order the packages keep the order of fns */
+    size_t njobs = std::min<size_t>(readable.size(), g_get_num_processors());
+    std::vector<CmdlineRpmsJob> jobs(njobs);
+    for (size_t i = 0; i < njobs; i++) {
+        auto first = readable.begin() + readable.size() * i / njobs;
+        auto last = readable.begin() + readable.size() * (i + 1) / njobs;
+        jobs[i].fns.assign(first, last);
+        jobs[i].flags = flags;
+        jobs[i].solv = NULL;
+        jobs[i].solv_size = 0;
+    }
+    g_autoptr(GError) error_local = NULL;
+    GThreadPool *thread_pool = njobs > 1 ?
+        g_thread_pool_new(add_cmdline_rpms_cb, NULL, njobs, FALSE, &error_local) : NULL;
+    if (thread_pool) {
+        for (auto & job : jobs)
+            g_thread_pool_push(thread_pool, &job, NULL);
+        g_thread_pool_free(thread_pool, FALSE, TRUE);
+    } else {
+        if (error_local)
+            g_warning("Failed to create thread pool for reading RPMs: %s", error_local->message);
+        for (auto & job : jobs)
+            add_cmdline_rpms_cb(&job, NULL);
+    }
+
+    Pool *pool = dnf_sack_get_pool(sack);
+    Repo *repo = dnf_sack_setup_cmdline_repo(sack);
+    for (auto & job : jobs) {
+        if (!job.solv)
+            continue;
+        /* repo_add_solv() appends the solvables at the end of the pool */
+        Id first = pool->nsolvables;
+        FILE *fp = fmemopen(job.solv, job.solv_size, "r");
+        if (!fp || repo_add_solv(repo, fp, 0))
+            g_warning("failed to add RPMs: %s, skipping", pool_errstr(pool));
+        else
+            for (Id p = first; p < pool->nsolvables; p++)
+                g_ptr_array_add(packages, dnf_package_new(sack, p));
+        if (fp)
+            fclose(fp);
+        free(job.solv);
+    }
+    priv->provides_ready = 0;    /* triggers internalizing later */
+    dnf_sack_invalidate_solvable_indexes(sack);
+    auto hrepo = static_cast<HyRepo>(repo->appdata);
+    libdnf::repoGetImpl(hrepo)->needs_internalizing = 1;
+    priv->considered_uptodate = FALSE;   /* triggers recompute_considered later */
+    return packages;
+}
+
+/**
+ * dnf_sack_add_cmdline_packages:
+ * @sack: a #DnfSack instance.
+ * @fns: a %NULL terminated array of filenames.
+ *
+ * Adds the given .rpm files to the command line repo, like
+ * dnf_sack_add_cmdline_package() does for one file. The headers are read and
+ * the files checksummed in parallel and the sack is invalidated only once.
+ * Files which cannot be read are skipped.
+ *
+ * Returns: (transfer full) (element-type DnfPackage): the added packages in the order of @fns
+ *
+ * Since: 0.70.0
+ */
+GPtrArray *
+dnf_sack_add_cmdline_packages(DnfSack *sack, const gchar *const *fns)
+{
+    return dnf_sack_add_cmdline_packages_flags(sack, fns,
+                               REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE|
+                               RPM_ADD_WITH_HDRID|RPM_ADD_WITH_SHA256SUM);
+}
+
 /**
  * dnf_sack_count:
  * @sack: a #DnfSack instance.
@@ -1321,8 +3296,232 @@ dnf_sack_count(DnfSack *sack)
     return cnt;
 }
 
+template<typename T>
+static guint64
+vector_bytes(const std::vector<T> & vector)
+{
+    return vector.capacity() * sizeof(T);
+}
+
+static guint64
+map_bytes(const Map *map)
+{
+    return map ? map->size : 0;
+}
+
+static guint64
+repodata_bytes(Repodata *data)
+{
+    guint64 bytes = repodata_memused(data);
+    bytes += data->nkeys * sizeof(Repokey) + data->nschemata * sizeof(Id);
+    if (data->localpool)
+        bytes += data->spool.sstrings + data->spool.nstrings * sizeof(Offset);
+    bytes += 2 * data->dirpool.ndirs * sizeof(Id);
+    return bytes;
+}
+
+/* the lazy indexes and caches of DnfSackPrivate, hashed containers are counted by their elements */
+static guint64
+sack_indexes_bytes(DnfSackPrivate *priv)
+{
+    guint64 bytes = 0;
+    for (auto index : {priv->name_index, priv->arch_index}) {
+        if (index)
+            bytes += vector_bytes(index->starts) + vector_bytes(index->ids);
+    }
+    if (priv->sorted_names)
+        bytes += vector_bytes(priv->sorted_names->names);
+    if (priv->folded_names) {
+        bytes += priv->folded_names->text.capacity() + vector_bytes(priv->folded_names->starts) +
+            vector_bytes(priv->folded_names->names);
+    }
+    if (priv->repo_solvables) {
+        for (auto & repo : priv->repo_solvables->repos)
+            bytes += map_bytes(repo.getMap());
+    }
+    if (priv->num_columns) {
+        for (auto & column : priv->num_columns->byAttr)
+            bytes += vector_bytes(column);
+    }
+    if (priv->substring_indexes) {
+        for (auto & index : priv->substring_indexes->byKey)
+            bytes += index.second.memoryUsage();
+    }
+    if (priv->updown_table)
+        bytes += vector_bytes(priv->updown_table->upgrades) + vector_bytes(priv->updown_table->downgrades);
+    if (priv->obsoleters)
+        bytes += vector_bytes(priv->obsoleters->ids);
+    if (priv->dep_name_indexes) {
+        for (auto & index : priv->dep_name_indexes->byKey)
+            bytes += vector_bytes(index.second.starts) + vector_bytes(index.second.ids);
+    }
+    for (auto index : {priv->sourcerpm_index, priv->location_index}) {
+        if (!index)
+            continue;
+        for (auto & entry : index->ids)
+            bytes += entry.first.capacity() + vector_bytes(entry.second) + sizeof(entry);
+    }
+    if (priv->latest_orders) {
+        for (auto & order : priv->latest_orders->orders)
+            bytes += vector_bytes(order.ids) + vector_bytes(order.ranks);
+    }
+    if (priv->query_cache) {
+        for (auto & entry : *priv->query_cache)
+            bytes += entry.first.capacity() + map_bytes(entry.second.getMap());
+    }
+    if (priv->split_evrs)
+        bytes += priv->split_evrs->size() * sizeof(std::pair<const Id, libdnf::SplitEvr>);
+    if (priv->reldep_cache) {
+        for (auto & entry : *priv->reldep_cache)
+            bytes += entry.first.capacity() + sizeof(entry);
+    }
+    if (priv->nevra_cache)
+        bytes += priv->nevra_cache->size() * sizeof(NevraParseCache::value_type);
+    return bytes;
+}
+
+static void
+repo_memory_stats_free(gpointer data)
+{
+    auto stats = static_cast<DnfSackRepoMemoryStats *>(data);
+    g_free(stats->name);
+    g_free(stats);
+}
+
+/**
+ * dnf_sack_get_memory_stats:
+ * @sack: a #DnfSack instance.
+ *
+ * Gets the memory used by the pool of the sack, split into the parts a long
+ * running process can act on, e.g. the repo extensions it could skip loading.
+ * The values are computed from the sizes of the allocated arrays, so they can
+ * be obtained at any time and quickly.
+ *
+ * Returns: (transfer full): a #DnfSackMemoryStats, free with dnf_sack_memory_stats_free()
+ *
+ * Since: 0.70.0
+ */
+DnfSackMemoryStats *
+dnf_sack_get_memory_stats(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    auto stats = g_new0(DnfSackMemoryStats, 1);
+
+    stats->string_space = pool->ss.sstrings + pool->ss.nstrings * sizeof(Offset);
+    if (pool->ss.stringhashtbl)
+        stats->string_space += (pool->ss.stringhashmask + 1) * sizeof(Id);
+    stats->reldeps = pool->nrels * sizeof(Reldep);
+    if (pool->whatprovides)
+        stats->whatprovides = pool->ss.nstrings * sizeof(Offset) + pool->whatprovidesdataoff * sizeof(Id);
+    if (pool->whatprovides_rel)
+        stats->whatprovides += pool->nrels * sizeof(Offset);
+    stats->solvables = pool->nsolvables * sizeof(Solvable);
+    for (auto map : {priv->pkg_excludes, priv->pkg_includes, priv->repo_excludes, priv->module_excludes,
+                     priv->module_includes, priv->pkg_solvables, priv->includes_unused, pool->considered})
+        stats->maps += map_bytes(map);
+    stats->indexes = sack_indexes_bytes(priv);
+    if (priv->moduleContainer) {
+        g_autoptr(DnfSackMemoryStats) module_stats =
+            dnf_sack_get_memory_stats(priv->moduleContainer->getModuleSack());
+        stats->module_sack = dnf_sack_memory_stats_get_total(module_stats);
+    }
+
+    stats->repos = g_ptr_array_new_with_free_func(repo_memory_stats_free);
+    Repo *repo;
+    int i;
+    FOR_REPOS(i, repo) {
+        auto repo_stats = g_new0(DnfSackRepoMemoryStats, 1);
+        repo_stats->name = g_strdup(repo->name);
+        /* the dependencies of the solvables are stored in the repo itself */
+        repo_stats->main = repo->idarraysize * sizeof(Id);
+
+        auto hrepo = static_cast<HyRepo>(repo->appdata);
+        Id filenames = hrepo ? repo_get_repodata(hrepo, _HY_REPODATA_FILENAMES) : 0;
+        Id presto = hrepo ? repo_get_repodata(hrepo, _HY_REPODATA_PRESTO) : 0;
+        Id updateinfo = hrepo ? repo_get_repodata(hrepo, _HY_REPODATA_UPDATEINFO) : 0;
+        Id other = hrepo ? repo_get_repodata(hrepo, _HY_REPODATA_OTHER) : 0;
+        Repodata *data;
+        int rdid;
+        FOR_REPODATAS(repo, rdid, data) {
+            guint64 bytes = repodata_bytes(data);
+            if (rdid == filenames)
+                repo_stats->filelists += bytes;
+            else if (rdid == presto)
+                repo_stats->presto += bytes;
+            else if (rdid == updateinfo)
+                repo_stats->updateinfo += bytes;
+            else if (rdid == other)
+                repo_stats->other += bytes;
+            else
+                repo_stats->main += bytes;
+        }
+        g_ptr_array_add(stats->repos, repo_stats);
+    }
+    return stats;
+}
+
+/**
+ * dnf_sack_memory_stats_get_total:
+ * @stats: a #DnfSackMemoryStats.
+ *
+ * Sums all the parts of the stats, including the repos and the module sack.
+ *
+ * Returns: bytes used by the sack
+ *
+ * Since: 0.70.0
+ */
+guint64
+dnf_sack_memory_stats_get_total(const DnfSackMemoryStats *stats)
+{
+    guint64 total = stats->string_space + stats->reldeps + stats->whatprovides + stats->solvables +
+        stats->maps + stats->indexes + stats->module_sack;
+    for (guint i = 0; i < stats->repos->len; ++i) {
+        auto repo = static_cast<const DnfSackRepoMemoryStats *>(g_ptr_array_index(stats->repos, i));
+        total += repo->main + repo->filelists + repo->other + repo->updateinfo + repo->presto;
+    }
+    return total;
+}
+
+/**
+ * dnf_sack_memory_stats_free:
+ * @stats: a #DnfSackMemoryStats.
+ *
+ * Frees the stats returned by dnf_sack_get_memory_stats().
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_memory_stats_free(DnfSackMemoryStats *stats)
+{
+    if (!stats)
+        return;
+    g_ptr_array_unref(stats->repos);
+    g_free(stats);
+}
+
+/**
+ * dnf_sack_exclude_from_considered:
+ *
+ * Takes solvables newly added to one of the exclude maps out of the considered
+ * map. Any exclude only ever removes solvables, so an up to date map stays up
+ * to date without being recomputed. If there is no map yet, it is left to
+ * dnf_sack_recompute_considered().
+ */
+static void
+dnf_sack_exclude_from_considered(DnfSack *sack, const Map *excluded)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+    if (priv->considered_uptodate && pool->considered)
+        map_subtract(pool->considered, excluded);
+    else
+        priv->considered_uptodate = FALSE;
+}
+
 static void
-dnf_sack_add_excludes_or_includes(DnfSack *sack, Map **dest, const DnfPackageSet *pkgset)
+dnf_sack_add_excludes_or_includes(DnfSack *sack, Map **dest, const DnfPackageSet *pkgset,
+                                  bool exclude = false)
 {
     Map *destmap = *dest;
     if (destmap == NULL) {
@@ -1334,8 +3533,13 @@ dnf_sack_add_excludes_or_includes(DnfSack *sack, Map **dest, const DnfPackageSet
 
     auto pkgmap = pkgset->getMap();
     map_or(destmap, pkgmap);
-    DnfSackPrivate *priv = GET_PRIVATE(sack);
-    priv->considered_uptodate = FALSE;
+    if (exclude) {
+        dnf_sack_exclude_from_considered(sack, pkgmap);
+    } else {
+        DnfSackPrivate *priv = GET_PRIVATE(sack);
+        priv->considered_uptodate = FALSE;
+    }
+    dnf_sack_bump_generation(sack);
 }
 
 /**
@@ -1351,7 +3555,7 @@ void
 dnf_sack_add_excludes(DnfSack *sack, const DnfPackageSet *pset)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    dnf_sack_add_excludes_or_includes(sack, &priv->pkg_excludes, pset);
+    dnf_sack_add_excludes_or_includes(sack, &priv->pkg_excludes, pset, true);
 }
 
 /**
@@ -1367,7 +3571,7 @@ void
 dnf_sack_add_module_excludes(DnfSack *sack, const DnfPackageSet *pset)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    dnf_sack_add_excludes_or_includes(sack, &priv->module_excludes, pset);
+    dnf_sack_add_excludes_or_includes(sack, &priv->module_excludes, pset, true);
 }
 
 /**
@@ -1395,6 +3599,7 @@ dnf_sack_remove_excludes_or_includes(DnfSack *sack, Map *from, const DnfPackageS
     map_subtract(from, pkgmap);
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->considered_uptodate = FALSE;
+    dnf_sack_bump_generation(sack);
 }
 
 /**
@@ -1459,6 +3664,7 @@ dnf_sack_set_excludes_or_includes(DnfSack *sack, Map **dest, const DnfPackageSet
     }
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->considered_uptodate = FALSE;
+    dnf_sack_bump_generation(sack);
 }
 
 void
@@ -1472,6 +3678,7 @@ dnf_sack_set_module_includes(DnfSack *sack, const DnfPackageSet *pset)
     priv->module_includes = static_cast<Map *>(g_malloc0(sizeof(Map)));
     auto pkgmap = pset->getMap();
     map_init_clone(priv->module_includes, pkgmap);
+    dnf_sack_bump_generation(sack);
 }
 
 /**
@@ -1655,6 +3862,8 @@ dnf_sack_set_use_includes(DnfSack *sack, const char *reponame, gboolean enabled)
         {
             hyrepo->setUseIncludes(enabled);
             priv->considered_uptodate = FALSE;
+            priv->includes_unused = free_map_fully(priv->includes_unused);
+            dnf_sack_bump_generation(sack);
         }
     } else {
         Id repoid;
@@ -1665,6 +3874,8 @@ dnf_sack_set_use_includes(DnfSack *sack, const char *reponame, gboolean enabled)
             {
                 hyrepo->setUseIncludes(enabled);
                 priv->considered_uptodate = FALSE;
+                priv->includes_unused = free_map_fully(priv->includes_unused);
+                dnf_sack_bump_generation(sack);
             }
         }
     }
@@ -1684,6 +3895,7 @@ dnf_sack_set_provides_not_ready(DnfSack *sack)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->provides_ready = FALSE;
+    dnf_sack_bump_generation(sack);
 }
 
 /**
@@ -1699,6 +3911,7 @@ dnf_sack_set_considered_to_update(DnfSack *sack)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->considered_uptodate = FALSE;
+    dnf_sack_bump_generation(sack);
 }
 
 /**
@@ -1756,16 +3969,200 @@ dnf_sack_repo_enabled(DnfSack *sack, const char *reponame, int enabled)
 
     Id p;
     Solvable *s;
-    if (repo->disabled)
-        FOR_REPO_SOLVABLES(repo, p, s)
+    if (repo->disabled) {
+        Map disabled;
+        map_init(&disabled, pool->nsolvables);
+        FOR_REPO_SOLVABLES(repo, p, s) {
             MAPSET(priv->repo_excludes, p);
-    else
+            MAPSET(&disabled, p);
+        }
+        dnf_sack_exclude_from_considered(sack, &disabled);
+        map_free(&disabled);
+    } else {
         FOR_REPO_SOLVABLES(repo, p, s)
             MAPCLR(priv->repo_excludes, p);
-    priv->considered_uptodate = FALSE;
+        priv->considered_uptodate = FALSE;
+    }
+    dnf_sack_bump_generation(sack);
     return 0;
 }
 
+/* rpmdbCookie() of the rpmdb under the pool rootdir, empty if it cannot be read */
+static std::string
+rpmdb_cookie(Pool *pool)
+{
+    rpmts ts = rpmtsCreate();
+    const char *rootdir = pool_get_rootdir(pool);
+    std::string ret;
+    if (rootdir)
+        rpmtsSetRootDir(ts, rootdir);
+    if (rpmtsOpenDB(ts, O_RDONLY) == 0) {
+        char *cookie = rpmdbCookie(rpmtsGetRdb(ts));
+        if (cookie) {
+            ret = cookie;
+            free(cookie);
+        }
+    }
+    rpmtsFree(ts);
+    return ret;
+}
+
+/* checksum of the rpmdb cookie, changes whenever the installed set does */
+static gboolean
+rpmdb_cookie_checksum(Pool *pool, unsigned char *out)
+{
+    auto cookie = rpmdb_cookie(pool);
+    if (cookie.empty())
+        return FALSE;
+    auto h = solv_chksum_create(CHKSUM_TYPE);
+    solv_chksum_add(h, CHKSUM_IDENT, strlen(CHKSUM_IDENT));
+    solv_chksum_add(h, cookie.c_str(), cookie.size());
+    solv_chksum_free(h, out);
+    return TRUE;
+}
+
+/* adds (or with subtract, removes) the digest of one package NEVRA to the 256 bit sum */
+static void
+rpmdb_version_add(RpmdbVersion *version, const char *nevra, bool subtract)
+{
+    unsigned char digest[CHKSUM_BYTES];
+    auto h = solv_chksum_create(CHKSUM_TYPE);
+    solv_chksum_add(h, nevra, strlen(nevra));
+    solv_chksum_free(h, digest);
+    unsigned carry = subtract ? 1 : 0;
+    for (int i = CHKSUM_BYTES - 1; i >= 0; --i) {
+        unsigned term = subtract ? static_cast<unsigned char>(~digest[i]) : digest[i];
+        unsigned total = version->sum[i] + term + carry;
+        version->sum[i] = total & 0xff;
+        carry = total >> 8;
+    }
+    if (subtract)
+        version->count--;
+    else
+        version->count++;
+}
+
+static std::string
+rpmdb_version_cache_fn(DnfSackPrivate *priv)
+{
+    return std::string(priv->cache_dir) + "/" + HY_SYSTEM_REPO_NAME + ".rpmdbversion";
+}
+
+/* the file holds the cookie, the count and the hex sum, one per line */
+static RpmdbVersion *
+rpmdb_version_read(DnfSackPrivate *priv, const std::string & cookie)
+{
+    g_autofree gchar *contents = NULL;
+    if (!g_file_get_contents(rpmdb_version_cache_fn(priv).c_str(), &contents, NULL, NULL))
+        return NULL;
+    g_auto(GStrv) lines = g_strsplit(contents, "\n", -1);
+    if (g_strv_length(lines) < 3 || cookie != lines[0] || strlen(lines[2]) != 2 * CHKSUM_BYTES)
+        return NULL;
+    auto version = new RpmdbVersion;
+    version->cookie = cookie;
+    version->count = static_cast<guint>(g_ascii_strtoull(lines[1], NULL, 10));
+    const char *hex = lines[2];
+    if (solv_hex2bin(&hex, version->sum, CHKSUM_BYTES) != CHKSUM_BYTES) {
+        delete version;
+        return NULL;
+    }
+    return version;
+}
+
+static void
+rpmdb_version_write(DnfSackPrivate *priv, const RpmdbVersion *version)
+{
+    char hex[2 * CHKSUM_BYTES + 1];
+    g_autofree gchar *contents = g_strdup_printf("%s\n%u\n%s\n", version->cookie.c_str(),
+                                                 version->count,
+                                                 solv_bin2hex(version->sum, CHKSUM_BYTES, hex));
+    g_autoptr(GError) error = NULL;
+    if (!g_file_set_contents(rpmdb_version_cache_fn(priv).c_str(), contents, -1, &error))
+        g_debug("failed to write the rpmdb version: %s", error->message);
+}
+
+/* the cached sum of the current rpmdb, computed from the installed solvables on a miss */
+static RpmdbVersion *
+rpmdb_version_lookup(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    auto cookie = rpmdb_cookie(pool);
+    if (priv->rpmdb_version && !cookie.empty() && priv->rpmdb_version->cookie == cookie)
+        return priv->rpmdb_version;
+    delete priv->rpmdb_version;
+    priv->rpmdb_version = cookie.empty() ? NULL : rpmdb_version_read(priv, cookie);
+    if (priv->rpmdb_version)
+        return priv->rpmdb_version;
+
+    auto version = new RpmdbVersion;
+    version->cookie = cookie;
+    version->count = 0;
+    memset(version->sum, 0, CHKSUM_BYTES);
+    if (pool->installed) {
+        Id p;
+        Solvable *s;
+        FOR_REPO_SOLVABLES(pool->installed, p, s)
+            rpmdb_version_add(version, pool_solvable2str(pool, s), false);
+    }
+    if (!cookie.empty())
+        rpmdb_version_write(priv, version);
+    priv->rpmdb_version = version;
+    return version;
+}
+
+/**
+ * dnf_sack_get_rpmdb_version:
+ * @sack: a #DnfSack instance.
+ *
+ * Gets a version of the installed package set in the "count:checksum" form,
+ * suitable for Swdb::beginTransaction() and Swdb::endTransaction(). The
+ * checksum is an order independent sum over the installed NEVRAs. It is
+ * cached next to @System.solv under the rpmdb cookie, so the installed
+ * packages are only walked when the rpmdb changed outside of libdnf.
+ *
+ * Returns: (transfer full): the rpmdb version
+ *
+ * Since: 0.70.0
+ */
+gchar *
+dnf_sack_get_rpmdb_version(DnfSack *sack)
+{
+    auto version = rpmdb_version_lookup(sack);
+    char hex[2 * CHKSUM_BYTES + 1];
+    return g_strdup_printf("%u:%s", version->count, solv_bin2hex(version->sum, CHKSUM_BYTES, hex));
+}
+
+void
+dnf_sack_update_rpmdb_version(DnfSack *sack, const char *cookie_before,
+                              GPtrArray *installed, GPtrArray *erased)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (priv->rpmdb_version == NULL || priv->rpmdb_version->cookie != cookie_before) {
+        /* without a sum of the previous rpmdb the next lookup recomputes it */
+        delete priv->rpmdb_version;
+        priv->rpmdb_version = rpmdb_version_read(priv, cookie_before);
+        if (priv->rpmdb_version == NULL)
+            return;
+    }
+    auto version = priv->rpmdb_version;
+    for (guint i = 0; i < erased->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(erased, i));
+        rpmdb_version_add(version, dnf_package_get_nevra(pkg), true);
+    }
+    for (guint i = 0; i < installed->len; i++) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(installed, i));
+        rpmdb_version_add(version, dnf_package_get_nevra(pkg), false);
+    }
+    version->cookie = rpmdb_cookie(priv->pool);
+    if (version->cookie.empty()) {
+        delete priv->rpmdb_version;
+        priv->rpmdb_version = NULL;
+        return;
+    }
+    rpmdb_version_write(priv, version);
+}
+
 /**
  * dnf_sack_load_system_repo:
  * @sack: a #DnfSack instance.
@@ -1773,7 +4170,8 @@ dnf_sack_repo_enabled(DnfSack *sack, const char *reponame, int enabled)
  * @flags: what to load into the sack, e.g. %DNF_SACK_LOAD_FLAG_USE_FILELISTS.
  * @error: a #GError or %NULL.
  *
- * Loads the rpmdb into the sack.
+ * Loads the rpmdb into the sack. A @System.solv cache written with
+ * %DNF_SACK_LOAD_FLAG_BUILD_CACHE is used as long as the rpmdb cookie matches.
  *
  * Returns: %TRUE for success
  *
@@ -1782,6 +4180,7 @@ dnf_sack_repo_enabled(DnfSack *sack, const char *reponame, int enabled)
 gboolean
 dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **error) try
 {
+    libdnf::PhaseTimer timer("dnf_sack_load_system_repo");
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     Pool *pool = dnf_sack_get_pool(sack);
     gboolean ret = TRUE;
@@ -1796,40 +4195,157 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
         hrepo = hy_repo_create(HY_SYSTEM_REPO_NAME);
     auto repoImpl = libdnf::repoGetImpl(hrepo);
 
+    const int build_cache = flags & DNF_SACK_LOAD_FLAG_BUILD_CACHE;
     repoImpl->load_flags = flags &= ~DNF_SACK_LOAD_FLAG_BUILD_CACHE;
 
     repo = repo_create(pool, HY_SYSTEM_REPO_NAME);
 
-    g_debug("fetching rpmdb");
-    int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR;
-    int rc = repo_add_rpmdb_reffp(repo, NULL, flagsrpm);
-    if (!rc) {
-        repoImpl->state_main = _HY_LOADED_FETCH;
+    /* the rpmdb cookie keys @System.solv, an unchanged rpmdb is loaded from it directly */
+    const gboolean have_cookie = rpmdb_cookie_checksum(pool, repoImpl->checksum);
+    if (!have_cookie)
+        memset(repoImpl->checksum, 0, CHKSUM_BYTES);
+    g_autofree char *cache_fn = dnf_sack_give_cache_fn(sack, HY_SYSTEM_REPO_NAME, NULL);
+    wait_cache_write(sack, cache_fn);
+    if (have_cookie && try_to_use_cached_solvfile(cache_fn, repo, 0, repoImpl->checksum, NULL)) {
+        g_debug("using cached rpmdb: %s", cache_fn);
+        repoImpl->state_main = _HY_LOADED_CACHE;
     } else {
-        repo_free(repo, 1);
-        ret = FALSE;
-        g_set_error (error,
-                     DNF_ERROR,
-                     DNF_ERROR_FILE_INVALID,
-                     _("failed loading RPMDB"));
-        goto finish;
+        g_debug("fetching rpmdb");
+        /* headers unchanged since the stale cache was written are taken from it */
+        FILE *fp_ref = solv_cache_fopen(cache_fn);
+        int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR;
+        int rc = repo_add_rpmdb_reffp(repo, fp_ref, flagsrpm);
+        if (fp_ref)
+            fclose(fp_ref);
+        if (!rc) {
+            repoImpl->state_main = _HY_LOADED_FETCH;
+        } else {
+            repo_free(repo, 1);
+            ret = FALSE;
+            g_set_error (error,
+                         DNF_ERROR,
+                         DNF_ERROR_FILE_INVALID,
+                         _("failed loading RPMDB"));
+            goto finish;
+        }
     }
 
     libdnf::repoGetImpl(hrepo)->attachLibsolvRepo(repo);
     pool_set_installed(pool, repo);
     priv->provides_ready = 0;
+    dnf_sack_invalidate_solvable_indexes(sack);
 
     repoImpl->main_nsolvables = repo->nsolvables;
     repoImpl->main_nrepodata = repo->nrepodata;
     repoImpl->main_end = repo->end;
     priv->considered_uptodate = FALSE;
 
+    if (have_cookie && build_cache && repoImpl->state_main == _HY_LOADED_FETCH) {
+        GError *error_local = NULL;
+        /* a missing cache only costs the next load a full rpmdb read */
+        if (!write_main(sack, hrepo, 0, &error_local)) {
+            g_warning("failed to cache rpmdb: %s", error_local->message);
+            g_clear_error(&error_local);
+        }
+    }
+
  finish:
     if (a_hrepo == NULL)
         hy_repo_free(hrepo);
     return ret;
 } CATCH_TO_GERROR(FALSE)
 
+/**
+ * dnf_sack_write_solv_snapshot:
+ * @sack: a #DnfSack instance.
+ * @repo: a #HyRepo with downloaded metadata.
+ * @path: the file to write.
+ * @error: a #GError, or %NULL.
+ *
+ * Writes the primary of @repo parsed into a solv file, to be published in
+ * the repomd.xml of the repo as a "primary_solv" record. Clients with the
+ * solv_snapshot option load it instead of parsing the primary XML, if it
+ * was made from the same primary by the same libsolv version. The pool of
+ * @sack is left untouched, the primary is parsed into a pool of its own.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_write_solv_snapshot(DnfSack *sack, HyRepo repo, const gchar *path, GError **error) try
+{
+    unsigned char primary_chksum[CHKSUM_BYTES];
+    auto primary = repo->getMetadataPath(MD_TYPE_PRIMARY);
+    if (!primary_checksum(repo, primary_chksum)) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_NOT_FOUND,
+                    _("repo %s has no primary metadata"),
+                    repo->getId().c_str());
+        return FALSE;
+    }
+    FILE *fp_primary = solv_xfopen(primary.c_str(), "r");
+    if (!fp_primary) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("can not read file %1$s: %2$s"),
+                    primary.c_str(), strerror(errno));
+        return FALSE;
+    }
+    // only the packages make the snapshot, the repomd data are loaded by the clients
+    std::unique_ptr<Pool, decltype(&pool_free)> pool(pool_create(), &pool_free);
+    Repo *snapshot = repo_create(pool.get(), repo->getId().c_str());
+    int rc = repo_add_rpmmd(snapshot, fp_primary, 0, 0);
+    fclose(fp_primary);
+    if (rc) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_INTERNAL_ERROR,
+                    _("Loading primary has failed: %s"),
+                    pool_errstr(pool.get()));
+        return FALSE;
+    }
+
+    SolvUserdata solv_userdata;
+    if (solv_userdata_fill(&solv_userdata, primary_chksum, NULL, error))
+        return FALSE;
+    g_autofree gchar *tmp_fn = g_strconcat(path, ".XXXXXX", NULL);
+    int tmp_fd = mkstemp(tmp_fn);
+    FILE *fp = tmp_fd >= 0 ? fdopen(tmp_fd, "w") : NULL;
+    if (!fp) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("cannot create temporary file: %s"),
+                    tmp_fn);
+        if (tmp_fd >= 0) {
+            close(tmp_fd);
+            unlink(tmp_fn);
+        }
+        return FALSE;
+    }
+    Repowriter *writer = repowriter_create(snapshot);
+    repowriter_set_userdata(writer, &solv_userdata, solv_userdata_size);
+    rc = repowriter_write(writer, fp);
+    repowriter_free(writer);
+    if (fclose(fp) || rc) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("Failed writing solv snapshot %1$s: %2$s"),
+                    tmp_fn, rc ? pool_errstr(pool.get()) : strerror(errno));
+        unlink(tmp_fn);
+        return FALSE;
+    }
+    if (!mv(tmp_fn, path, error)) {
+        unlink(tmp_fn);
+        return FALSE;
+    }
+    return TRUE;
+} CATCH_TO_GERROR(FALSE)
+
 /**
  * dnf_sack_load_repo:
  * @sack: a #DnfSack instance.
@@ -1851,7 +4367,7 @@ dnf_sack_load_repo(DnfSack *sack, HyRepo repo, int flags, GError **error) try
     GError *error_local = NULL;
     const int build_cache = flags & DNF_SACK_LOAD_FLAG_BUILD_CACHE;
     gboolean retval;
-    if (!load_yum_repo(sack, repo, error))
+    if (!load_yum_repo(sack, repo, flags, error))
         return FALSE;
     repoImpl->load_flags = flags;
     if (repoImpl->state_main == _HY_LOADED_FETCH && build_cache) {
@@ -1861,7 +4377,10 @@ dnf_sack_load_repo(DnfSack *sack, HyRepo repo, int flags, GError **error) try
     repoImpl->main_nsolvables = repoImpl->libsolvRepo->nsolvables;
     repoImpl->main_nrepodata = repoImpl->libsolvRepo->nrepodata;
     repoImpl->main_end = repoImpl->libsolvRepo->end;
-    if (flags & DNF_SACK_LOAD_FLAG_USE_FILELISTS) {
+    if (flags & DNF_SACK_LOAD_FLAG_LAZY_FILELISTS) {
+        /* loaded by the first file query, file list or file dependency outside primary */
+        repoImpl->unloaded_exts |= DNF_SACK_LOAD_FLAG_USE_FILELISTS;
+    } else if (flags & DNF_SACK_LOAD_FLAG_USE_FILELISTS) {
         retval = load_ext(sack, repo, _HY_REPODATA_FILENAMES,
                           HY_EXT_FILENAMES, MD_TYPE_FILELISTS,
                           load_filelists_cb, &error_local);
@@ -1929,9 +4448,12 @@ dnf_sack_load_repo(DnfSack *sack, HyRepo repo, int flags, GError **error) try
     /* updateinfo must come *after* all other extensions, as it is not a real
        extension, but contains a new set of packages */
     if (flags & DNF_SACK_LOAD_FLAG_USE_UPDATEINFO) {
+        /* slim updateinfo lacks the descriptions, it must not share the cache file */
+        bool slim = flags & DNF_SACK_LOAD_FLAG_SLIM_UPDATEINFO;
+        const char *updateinfo_suffix = slim ? HY_EXT_UPDATEINFO_SLIM : HY_EXT_UPDATEINFO;
         retval = load_ext(sack, repo, _HY_REPODATA_UPDATEINFO,
-                          HY_EXT_UPDATEINFO, MD_TYPE_UPDATEINFO,
-                          load_updateinfo_cb, &error_local);
+                          updateinfo_suffix, MD_TYPE_UPDATEINFO,
+                          slim ? load_updateinfo_slim_cb : load_updateinfo_cb, &error_local);
         /* allow missing files */
         if (!retval) {
             if (g_error_matches (error_local,
@@ -1945,13 +4467,212 @@ dnf_sack_load_repo(DnfSack *sack, HyRepo repo, int flags, GError **error) try
             }
         }
         if (repoImpl->state_updateinfo == _HY_LOADED_FETCH && build_cache)
-            if (!write_ext(sack, repo, _HY_REPODATA_UPDATEINFO, HY_EXT_UPDATEINFO, error))
+            if (!write_ext(sack, repo, _HY_REPODATA_UPDATEINFO, updateinfo_suffix, error))
                 return FALSE;
     }
     priv->considered_uptodate = FALSE;
     return TRUE;
 } CATCH_TO_GERROR(FALSE)
 
+/* the extensions dnf_sack_unload_repo_exts() can drop, they do not add solvables */
+static const struct {
+    int flag;
+    _hy_repo_repodata which;
+    const char *suffix;
+    const char *md_type;
+    int (*cb)(Repo *, FILE *);
+} unloadable_exts[] = {
+    {DNF_SACK_LOAD_FLAG_USE_FILELISTS, _HY_REPODATA_FILENAMES, HY_EXT_FILENAMES, MD_TYPE_FILELISTS,
+     load_filelists_cb},
+    {DNF_SACK_LOAD_FLAG_USE_OTHER, _HY_REPODATA_OTHER, HY_EXT_OTHER, MD_TYPE_OTHER, load_other_cb},
+    {DNF_SACK_LOAD_FLAG_USE_PRESTO, _HY_REPODATA_PRESTO, HY_EXT_PRESTO, MD_TYPE_PRESTODELTA,
+     load_presto_cb},
+};
+
+/**
+ * dnf_sack_unload_repo_exts:
+ * @sack: a #DnfSack instance.
+ * @repo: a #HyRepo loaded into the sack.
+ * @flags: the extensions to drop, %DNF_SACK_LOAD_FLAG_USE_FILELISTS,
+ *         %DNF_SACK_LOAD_FLAG_USE_OTHER or %DNF_SACK_LOAD_FLAG_USE_PRESTO.
+ * @error: a #GError, or %NULL.
+ *
+ * Frees the loaded repodata of the extensions to give the memory back. The
+ * extensions are loaded again, preferably from the solv cache, on the next
+ * access which needs them: a query by file, the file list, changelogs or
+ * deltas of a package of the repo, or dnf_sack_freeze(). Extensions which
+ * are not loaded are skipped. The updateinfo adds solvables, it can not be
+ * unloaded.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_unload_repo_exts(DnfSack *sack, HyRepo repo, int flags, GError **error) try
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    auto repoImpl = libdnf::repoGetImpl(repo);
+    Repo *libsolvRepo = repoImpl->libsolvRepo;
+
+    if (!libsolvRepo || libsolvRepo->pool != priv->pool) {
+        g_set_error(error, DNF_ERROR, DNF_ERROR_REPO_NOT_FOUND,
+                    _("repo %s is not loaded in the sack"), repoImpl->id.c_str());
+        return FALSE;
+    }
+    const int unloadable = DNF_SACK_LOAD_FLAG_USE_FILELISTS | DNF_SACK_LOAD_FLAG_USE_OTHER |
+        DNF_SACK_LOAD_FLAG_USE_PRESTO;
+    if (flags & ~unloadable) {
+        g_set_error_literal(error, DNF_ERROR, DNF_ERROR_NO_CAPABILITY,
+                            _("only the filelists, other and presto extensions can be unloaded"));
+        return FALSE;
+    }
+
+    repo_internalize_trigger(libsolvRepo);
+    for (const auto & ext : unloadable_exts) {
+        if (!(flags & ext.flag))
+            continue;
+        Id repodataid = repo_get_repodata(repo, ext.which);
+        if (!repodataid)
+            continue;
+        g_debug("%s: unloading %s of %s", __func__, ext.md_type, libsolvRepo->name);
+        repodata_free(repo_id2repodata(libsolvRepo, repodataid));
+        /* repodata_free() moves the following repodata one position down */
+        for (auto which : {_HY_REPODATA_FILENAMES, _HY_REPODATA_PRESTO, _HY_REPODATA_UPDATEINFO,
+                           _HY_REPODATA_OTHER}) {
+            Id id = repo_get_repodata(repo, which);
+            if (id > repodataid)
+                repo_set_repodata(repo, which, id - 1);
+        }
+        repo_set_repodata(repo, ext.which, 0);
+        repo_update_state(repo, ext.which, _HY_NEW);
+        repoImpl->unloaded_exts |= ext.flag;
+    }
+    dnf_sack_bump_generation(sack);
+    return TRUE;
+} CATCH_TO_GERROR(FALSE)
+
+void
+dnf_sack_reload_unloaded_exts(DnfSack *sack, Repo *repo, int flags)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    bool reloaded = false;
+    Repo *r;
+    int i;
+
+    FOR_REPOS(i, r) {
+        if (repo && r != repo)
+            continue;
+        auto hrepo = static_cast<HyRepo>(r->appdata);
+        if (!hrepo)
+            continue;
+        auto repoImpl = libdnf::repoGetImpl(hrepo);
+        if (!(repoImpl->unloaded_exts & flags))
+            continue;
+        for (const auto & ext : unloadable_exts) {
+            if (!(repoImpl->unloaded_exts & flags & ext.flag))
+                continue;
+            /* a failure is not retried on every access */
+            repoImpl->unloaded_exts &= ~ext.flag;
+            reloaded = true;
+            g_autoptr(GError) error_local = NULL;
+            if (!load_ext(sack, hrepo, ext.which, ext.suffix, ext.md_type, ext.cb, &error_local)) {
+                if (g_error_matches(error_local, DNF_ERROR, DNF_ERROR_NO_CAPABILITY))
+                    g_debug("no %s metadata available for %s", ext.md_type, r->name);
+                else
+                    g_warning("failed to reload %s of %s: %s", ext.md_type, r->name,
+                              error_local->message);
+                continue;
+            }
+            /* the lazy file lists are fetched for the first time here */
+            if (repo_get_state(hrepo, ext.which) == _HY_LOADED_FETCH &&
+                (repoImpl->load_flags & DNF_SACK_LOAD_FLAG_BUILD_CACHE) &&
+                !write_ext(sack, hrepo, ext.which, ext.suffix, &error_local))
+                g_warning("failed to write the %s cache of %s: %s", ext.md_type, r->name,
+                          error_local->message);
+        }
+    }
+    if (reloaded) {
+        /* new file provides and results of file queries */
+        priv->provides_ready = 0;
+        dnf_sack_bump_generation(sack);
+    }
+}
+
+/* the files createrepo puts into primary, see cr_is_primary() */
+static bool
+is_primary_file(const char *path)
+{
+    return g_str_has_prefix(path, "/etc/") || strstr(path, "bin/") ||
+        strcmp(path, "/usr/lib/sendmail") == 0;
+}
+
+/* whether dep or a part of a rich dependency is a file missing in primary */
+static bool
+dep_needs_filelists(Pool *pool, Id dep)
+{
+    while (ISRELDEP(dep)) {
+        Reldep *rd = GETRELDEP(pool, dep);
+        /* the flags above REL_LT are the rich and special dependencies */
+        if (rd->flags > 7 && dep_needs_filelists(pool, rd->evr))
+            return true;
+        dep = rd->name;
+    }
+    const char *str = pool_id2str(pool, dep);
+    return str[0] == '/' && !is_primary_file(str);
+}
+
+static bool
+lazy_filelists_pending(DnfSack *sack)
+{
+    Pool *pool = GET_PRIVATE(sack)->pool;
+    Repo *r;
+    int i;
+
+    FOR_REPOS(i, r) {
+        auto hrepo = static_cast<HyRepo>(r->appdata);
+        if (hrepo && libdnf::repoGetImpl(hrepo)->unloaded_exts & DNF_SACK_LOAD_FLAG_USE_FILELISTS)
+            return true;
+    }
+    return false;
+}
+
+void
+dnf_sack_load_lazy_filelists(DnfSack *sack, Id dep)
+{
+    if (lazy_filelists_pending(sack) && dep_needs_filelists(GET_PRIVATE(sack)->pool, dep))
+        dnf_sack_reload_unloaded_exts(sack, nullptr, DNF_SACK_LOAD_FLAG_USE_FILELISTS);
+}
+
+/* load the lazy file lists when a dependency in the pool needs them for the file provides */
+static void
+load_lazy_filelists_for_deps(DnfSack *sack)
+{
+    Pool *pool = GET_PRIVATE(sack)->pool;
+    Id p;
+
+    if (!lazy_filelists_pending(sack))
+        return;
+    for (p = 2; p < pool->nsolvables; p++) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (!s->repo)
+            continue;
+        for (Offset off : {s->requires, s->conflicts, s->obsoletes, s->recommends, s->suggests,
+                           s->supplements, s->enhances}) {
+            if (!off)
+                continue;
+            for (Id *dp = s->repo->idarraydata + off; *dp; dp++) {
+                if (dep_needs_filelists(pool, *dp)) {
+                    g_debug("%s needs the file lists", pool_dep2str(pool, *dp));
+                    dnf_sack_reload_unloaded_exts(sack, nullptr, DNF_SACK_LOAD_FLAG_USE_FILELISTS);
+                    return;
+                }
+            }
+        }
+    }
+}
+
 // internal to hawkey
 
 // return true if q1 is a superset of q2
@@ -1973,10 +4694,12 @@ is_superset(Queue *q1, Queue *q2, Map *m)
 }
 
 
-static void
+/* returns TRUE if the main cache of any repo was rewritten */
+static gboolean
 rewrite_repos(DnfSack *sack, Queue *addedfileprovides,
               Queue *addedfileprovides_inst)
 {
+    gboolean rewritten = FALSE;
     Pool *pool = dnf_sack_get_pool(sack);
     int i;
 
@@ -2021,12 +4744,404 @@ rewrite_repos(DnfSack *sack, Queue *addedfileprovides,
         repo->end = repoImpl->main_end;
         g_debug("rewriting repo: %s", repo->name);
         write_main(sack, hrepo, 0, NULL);
+        rewritten = TRUE;
         repo->nrepodata = oldnrepodata;
         repo->nsolvables = oldnsolvables;
         repo->end = oldend;
     }
-    queue_free(&fileprovidesq);
-    map_free(&providedids);
+    queue_free(&fileprovidesq);
+    map_free(&providedids);
+    return rewritten;
+}
+
+/* must not be smaller than the allocation block libsolv uses when it grows
+ * pool->whatprovides and pool->whatprovides_rel */
+#define WHATPROVIDES_BLOCK 1023
+#define WHATPROVIDESDATA_EXTRA 4096
+
+/* the transparent huge page size of x86_64 and aarch64 with 4k pages, smaller arrays are left
+ * alone as they can not use a huge page anyway */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* Asks the kernel to back the whole pages of the range by transparent huge pages, the range
+ * is collapsed later by khugepaged when already faulted in. */
+static void
+advise_huge_pages(const void *addr, size_t length)
+{
+#ifdef MADV_HUGEPAGE
+    if (!addr || length < HUGE_PAGE_SIZE)
+        return;
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = ((uintptr_t) addr + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t) addr + length) & ~(page - 1);
+    if (end > begin)
+        madvise((void *) begin, end - begin, MADV_HUGEPAGE);
+#endif
+}
+
+/* Allocation of length bytes aligned to a huge page and advised to use huge pages before any
+ * page is touched, for the arrays the sack hands over to libsolv. The memory is released by
+ * solv_free() and can be grown by solv_realloc() like any other. Returns NULL on failure. */
+static void *
+huge_page_malloc(size_t length)
+{
+    void *addr = NULL;
+    if (posix_memalign(&addr, HUGE_PAGE_SIZE, length))
+        return NULL;
+    advise_huge_pages(addr, length);
+    return addr;
+}
+
+/* The big randomly accessed arrays of the pool, see DNF_SACK_SETUP_FLAG_HUGE_PAGES */
+static void
+advise_pool_huge_pages(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->huge_pages)
+        return;
+    Pool *pool = priv->pool;
+    advise_huge_pages(pool->solvables, pool->nsolvables * sizeof(Solvable));
+    advise_huge_pages(pool->ss.stringspace, pool->ss.sstrings);
+    advise_huge_pages(pool->ss.strings, pool->ss.nstrings * sizeof(Offset));
+    advise_huge_pages(pool->rels, pool->nrels * sizeof(Reldep));
+    if (pool->whatprovides) {
+        advise_huge_pages(pool->whatprovides, pool->ss.nstrings * sizeof(Offset));
+        advise_huge_pages(pool->whatprovides_rel, pool->nrels * sizeof(Offset));
+        advise_huge_pages(pool->whatprovidesdata, pool->whatprovidesdataoff * sizeof(Id));
+    }
+    int i;
+    Repo *repo;
+    FOR_REPOS(i, repo)
+        advise_huge_pages(repo->idarraydata, repo->idarraysize * sizeof(Id));
+}
+
+static constexpr const std::array<char, 4> whatprovides_cache_magic{'\0', 'd', 'w', 'p'};
+static constexpr const uint32_t whatprovides_cache_version = 3;
+
+struct WhatprovidesCacheHeader {
+    char magic[whatprovides_cache_magic.size()];
+    uint32_t version;
+    unsigned char key[CHKSUM_BYTES];
+    uint32_t nstrings;
+    uint32_t nrels;
+    uint32_t ndata;
+}__attribute__((packed));
+
+/* the Ids depend on the order the strings and reldeps were interned in, parsing the XML
+ * interns them in another order than reading the same data from the solv files */
+static bool
+repo_loaded_from_cache(libdnf::Repo::Impl *repoImpl)
+{
+    auto cached = [](_hy_repo_state state) { return state == _HY_NEW || state == _HY_LOADED_CACHE; };
+    return repoImpl->state_main == _HY_LOADED_CACHE && cached(repoImpl->state_filelists) &&
+        cached(repoImpl->state_presto) && cached(repoImpl->state_updateinfo) &&
+        cached(repoImpl->state_other);
+}
+
+/**
+ * whatprovides_cache_key:
+ *
+ * Computes the key identifying the pool layout the whatprovides index was
+ * built for. Ids are only stable between processes that load the same cache
+ * files in the same order, so only sacks with all repos read from their solv
+ * caches have a key. It covers the checksums and load flags of
+ * all repos, the installed packages and the sizes of the string, reldep and
+ * solvable spaces. Indexes of installable solvables pass @with_considered to
+ * cover the considered map too.
+ *
+ * Returns: %FALSE if some repo was not loaded from a solv cache
+ */
+static gboolean
+whatprovides_cache_key(DnfSack *sack, unsigned char *key, gboolean with_considered)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    Repo *repo;
+    int i;
+
+    FOR_REPOS(i, repo) {
+        auto hrepo = static_cast<HyRepo>(repo->appdata);
+        if (!hrepo)
+            return FALSE;
+        auto repoImpl = libdnf::repoGetImpl(hrepo);
+        if (!repo_loaded_from_cache(repoImpl))
+            return FALSE;
+        if (repo != pool->installed && !(repoImpl->load_flags & DNF_SACK_LOAD_FLAG_BUILD_CACHE))
+            return FALSE;
+    }
+
+    Chksum *h = solv_chksum_create(REPOKEY_TYPE_SHA256);
+    FOR_REPOS(i, repo) {
+        auto repoImpl = libdnf::repoGetImpl(static_cast<HyRepo>(repo->appdata));
+        int layout[] = {repo->start, repo->end, repo->nsolvables, repo->nrepodata,
+                        repo->disabled, repo->priority, repo->subpriority,
+                        repoImpl->load_flags & ~DNF_SACK_LOAD_FLAG_USE_MMAP};
+        solv_chksum_add(h, repo->name, strlen(repo->name) + 1);
+        solv_chksum_add(h, layout, sizeof(layout));
+        if (repo != pool->installed) {
+            solv_chksum_add(h, repoImpl->checksum, CHKSUM_BYTES);
+            continue;
+        }
+        /* the rpmdb is not cached, identify it by the package headers */
+        Id p;
+        Solvable *s;
+        FOR_REPO_SOLVABLES(repo, p, s) {
+            Id nevra[] = {p, s->name, s->evr, s->arch};
+            solv_chksum_add(h, nevra, sizeof(nevra));
+            Id type = 0;
+            const unsigned char *hdrid = solvable_lookup_bin_checksum(s, SOLVABLE_HDRID, &type);
+            if (hdrid)
+                solv_chksum_add(h, hdrid, solv_chksum_len(type));
+        }
+    }
+    int sizes[] = {pool->ss.nstrings, pool->nrels, pool->nsolvables};
+    solv_chksum_add(h, sizes, sizeof(sizes));
+    if (priv->arch)
+        solv_chksum_add(h, priv->arch, strlen(priv->arch));
+    /* only installable solvables are indexed */
+    if (with_considered && pool->considered)
+        solv_chksum_add(h, pool->considered->map, pool->considered->size);
+    solv_chksum_free(h, key);
+    return TRUE;
+}
+
+static gboolean
+whatprovides_cache_load(DnfSack *sack, const char *fn, const unsigned char *key)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    FILE *fp = fopen(fn, "r");
+    if (!fp)
+        return FALSE;
+
+    WhatprovidesCacheHeader header;
+    Offset *whatprovides = NULL;
+    Id *whatprovidesdata = NULL;
+    gboolean ret = FALSE;
+
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, whatprovides_cache_magic.data(), whatprovides_cache_magic.size()) ||
+        header.version != whatprovides_cache_version ||
+        checksum_cmp(header.key, key) ||
+        header.nstrings != (uint32_t) pool->ss.nstrings ||
+        header.nrels != (uint32_t) pool->nrels ||
+        header.ndata < 2)
+        goto done;
+
+    if (GET_PRIVATE(sack)->huge_pages) {
+        /* same sizes as solv_calloc_block() and solv_malloc2() below */
+        size_t nwhatprovides = (header.nstrings + WHATPROVIDES_BLOCK) & ~WHATPROVIDES_BLOCK;
+        whatprovides = static_cast<Offset *>(huge_page_malloc(nwhatprovides * sizeof(Offset)));
+        if (whatprovides)
+            memset(whatprovides, 0, nwhatprovides * sizeof(Offset));
+        whatprovidesdata = static_cast<Id *>(
+            huge_page_malloc((header.ndata + WHATPROVIDESDATA_EXTRA) * sizeof(Id)));
+    }
+    if (!whatprovides)
+        whatprovides = static_cast<Offset *>(
+            solv_calloc_block(header.nstrings, sizeof(Offset), WHATPROVIDES_BLOCK));
+    if (!whatprovidesdata)
+        whatprovidesdata = static_cast<Id *>(
+            solv_malloc2(header.ndata + WHATPROVIDESDATA_EXTRA, sizeof(Id)));
+    if (fread(whatprovides, sizeof(Offset), header.nstrings, fp) != header.nstrings ||
+        fread(whatprovidesdata, sizeof(Id), header.ndata, fp) != header.ndata)
+        goto done;
+    for (uint32_t i = 0; i < header.nstrings; ++i)
+        if (whatprovides[i] >= header.ndata)
+            goto done;
+    for (uint32_t i = 0; i < header.ndata; ++i)
+        if (whatprovidesdata[i] < 0 || whatprovidesdata[i] >= pool->nsolvables)
+            goto done;
+
+    /* the aux arrays are private to libsolv, without them it looks the provides up in the
+     * solvables */
+    pool_freewhatprovides(pool);
+    pool->whatprovides = whatprovides;
+    pool->whatprovides_rel = static_cast<Offset *>(
+        solv_calloc_block(pool->nrels, sizeof(Offset), WHATPROVIDES_BLOCK));
+    pool->whatprovidesdata = whatprovidesdata;
+    pool->whatprovidesdataoff = header.ndata;
+    pool->whatprovidesdataleft = WHATPROVIDESDATA_EXTRA;
+    whatprovides = NULL;
+    whatprovidesdata = NULL;
+    ret = TRUE;
+
+ done:
+    solv_free(whatprovides);
+    solv_free(whatprovidesdata);
+    fclose(fp);
+    return ret;
+}
+
+static gboolean
+whatprovides_cache_write(DnfSack *sack, const char *fn, const unsigned char *key)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+
+    /* file provides may be searched lazily, resolve them before saving */
+    for (Id id = 1; id < pool->ss.nstrings; ++id)
+        if (pool_id2str(pool, id)[0] == '/')
+            pool_whatprovides(pool, id);
+
+    WhatprovidesCacheHeader header;
+    memcpy(header.magic, whatprovides_cache_magic.data(), whatprovides_cache_magic.size());
+    header.version = whatprovides_cache_version;
+    memcpy(header.key, key, CHKSUM_BYTES);
+    header.nstrings = pool->ss.nstrings;
+    header.nrels = pool->nrels;
+    header.ndata = pool->whatprovidesdataoff;
+
+    char *tmp_fn_templ = solv_dupjoin(fn, ".XXXXXX", NULL);
+    int tmp_fd = mkstemp(tmp_fn_templ);
+    FILE *fp = tmp_fd < 0 ? NULL : fdopen(tmp_fd, "w");
+    gboolean ret = fp != NULL;
+    if (ret) {
+        ret = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(pool->whatprovides, sizeof(Offset), header.nstrings, fp) == header.nstrings &&
+            fwrite(pool->whatprovidesdata, sizeof(Id), header.ndata, fp) == header.ndata;
+        ret = fclose(fp) == 0 && ret;
+    } else if (tmp_fd >= 0) {
+        close(tmp_fd);
+    }
+    g_autoptr(GError) error_local = NULL;
+    if (ret)
+        ret = mv(tmp_fn_templ, fn, &error_local);
+    if (!ret) {
+        g_debug("failed writing whatprovides cache %s: %s", fn,
+                error_local ? error_local->message : strerror(errno));
+        if (tmp_fd >= 0)
+            unlink(tmp_fn_templ);
+    }
+    g_free(tmp_fn_templ);
+    return ret;
+}
+
+static constexpr const std::array<char, 4> substring_cache_magic{'\0', 'd', 's', 'i'};
+static constexpr const uint32_t substring_cache_version = 1;
+
+struct SubstringCacheHeader {
+    char magic[substring_cache_magic.size()];
+    uint32_t version;
+    unsigned char key[CHKSUM_BYTES];
+    uint32_t nsolvables;
+}__attribute__((packed));
+
+/* name of the key in the cache file name, NULL if the key is not indexed */
+static const char *
+substring_index_key_name(Id keyname)
+{
+    switch (keyname) {
+        case SOLVABLE_SUMMARY:
+            return "summary";
+        case SOLVABLE_DESCRIPTION:
+            return "description";
+        case SOLVABLE_URL:
+            return "url";
+        default:
+            return NULL;
+    }
+}
+
+static gboolean
+substring_cache_load(DnfSack *sack, const char *fn, const unsigned char *key,
+                     libdnf::SubstringIndex & index)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    FILE *fp = fopen(fn, "r");
+    if (!fp)
+        return FALSE;
+
+    SubstringCacheHeader header;
+    gboolean ret = fread(&header, sizeof(header), 1, fp) == 1 &&
+        !memcmp(header.magic, substring_cache_magic.data(), substring_cache_magic.size()) &&
+        header.version == substring_cache_version &&
+        !checksum_cmp(header.key, key) &&
+        header.nsolvables == (uint32_t) pool->nsolvables &&
+        index.read(fp, pool->nsolvables);
+    fclose(fp);
+    return ret;
+}
+
+static void
+substring_cache_write(DnfSack *sack, const char *fn, const unsigned char *key,
+                      const libdnf::SubstringIndex & index)
+{
+    SubstringCacheHeader header;
+    memcpy(header.magic, substring_cache_magic.data(), substring_cache_magic.size());
+    header.version = substring_cache_version;
+    memcpy(header.key, key, CHKSUM_BYTES);
+    header.nsolvables = dnf_sack_get_pool(sack)->nsolvables;
+
+    char *tmp_fn_templ = solv_dupjoin(fn, ".XXXXXX", NULL);
+    int tmp_fd = mkstemp(tmp_fn_templ);
+    FILE *fp = tmp_fd < 0 ? NULL : fdopen(tmp_fd, "w");
+    gboolean ret = fp != NULL;
+    if (ret) {
+        ret = fwrite(&header, sizeof(header), 1, fp) == 1 && index.write(fp);
+        ret = fclose(fp) == 0 && ret;
+    } else if (tmp_fd >= 0) {
+        close(tmp_fd);
+    }
+    g_autoptr(GError) error_local = NULL;
+    if (ret)
+        ret = mv(tmp_fn_templ, fn, &error_local);
+    if (!ret) {
+        g_debug("failed writing substring index %s: %s", fn,
+                error_local ? error_local->message : strerror(errno));
+        if (tmp_fd >= 0)
+            unlink(tmp_fn_templ);
+    }
+    g_free(tmp_fn_templ);
+}
+
+const libdnf::SubstringIndex *
+dnf_sack_get_substring_index(DnfSack *sack, Id keyname)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    const char *name = substring_index_key_name(keyname);
+    if (!priv->use_substring_index || !name)
+        return nullptr;
+    if (priv->substring_indexes && priv->substring_indexes->nsolvables != pool->nsolvables) {
+        delete priv->substring_indexes;
+        priv->substring_indexes = NULL;
+    }
+    if (priv->substring_indexes) {
+        auto it = priv->substring_indexes->byKey.find(keyname);
+        if (it != priv->substring_indexes->byKey.end())
+            return &it->second;
+    }
+    /* concurrent readers of a frozen sack only use the indexes dnf_sack_freeze() built */
+    if (priv->frozen)
+        return nullptr;
+    if (!priv->substring_indexes) {
+        priv->substring_indexes = new SubstringIndexes;
+        priv->substring_indexes->nsolvables = pool->nsolvables;
+    }
+    auto & index = priv->substring_indexes->byKey[keyname];
+    libdnf::PhaseTimer timer("dnf_sack_get_substring_index");
+    repo_internalize_all_trigger(pool);
+
+    /* the strings don't depend on the considered map, don't let excludes change the key */
+    unsigned char key[CHKSUM_BYTES];
+    gboolean cacheable = whatprovides_cache_key(sack, key, FALSE);
+    g_autofree gchar *fn = NULL;
+    if (cacheable) {
+        fn = g_strconcat(priv->cache_dir, "/", DNF_SACK_SUBSTRING_CACHE_FN_PREFIX, name,
+                         ".cache", NULL);
+        if (substring_cache_load(sack, fn, key, index)) {
+            g_debug("using substring index cache %s", fn);
+            return &index;
+        }
+    }
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (s->repo)
+            index.add(p, solvable_lookup_str(s, keyname));
+    }
+    index.finish();
+    if (cacheable)
+        substring_cache_write(sack, fn, key, index);
+    return &index;
 }
 
 /**
@@ -2035,6 +5150,10 @@ rewrite_repos(DnfSack *sack, Queue *addedfileprovides,
  *
  * Gets the sack ready for depsolving.
  *
+ * When all repos are loaded from solv caches the computed whatprovides index
+ * is stored in the cache directory too and reused by later sacks with the
+ * same repos and the same rpmdb.
+ *
  * Since: 0.7.0
  */
 void
@@ -2044,19 +5163,253 @@ dnf_sack_make_provides_ready(DnfSack *sack)
 
     if (priv->provides_ready)
         return;
+    libdnf::PhaseTimer timer("dnf_sack_make_provides_ready");
+    LIBDNF_PROBE(make_provides_ready_start);
+    load_lazy_filelists_for_deps(sack);
     repo_internalize_all_trigger(priv->pool);
+
+    /* the installed packages get their file provides here on a cache hit too */
     Queue addedfileprovides;
     Queue addedfileprovides_inst;
     queue_init(&addedfileprovides);
     queue_init(&addedfileprovides_inst);
     pool_addfileprovides_queue(priv->pool, &addedfileprovides,
                                &addedfileprovides_inst);
-    if (addedfileprovides.count || addedfileprovides_inst.count)
-        rewrite_repos(sack, &addedfileprovides, &addedfileprovides_inst);
+
+    unsigned char key[CHKSUM_BYTES];
+    gboolean cacheable = whatprovides_cache_key(sack, key, TRUE);
+    g_autofree char *fn = solv_dupjoin(priv->cache_dir, "/", DNF_SACK_WHATPROVIDES_CACHE_FN);
+    if (cacheable && whatprovides_cache_load(sack, fn, key)) {
+        g_debug("using whatprovides cache");
+        queue_free(&addedfileprovides);
+        queue_free(&addedfileprovides_inst);
+        advise_pool_huge_pages(sack);
+        priv->provides_ready = 1;
+        LIBDNF_PROBE(make_provides_ready_end, 1);
+        return;
+    }
+    /* a rewritten repo will not match the key in the next process */
+    if ((addedfileprovides.count || addedfileprovides_inst.count) &&
+        rewrite_repos(sack, &addedfileprovides, &addedfileprovides_inst))
+        cacheable = FALSE;
     queue_free(&addedfileprovides);
     queue_free(&addedfileprovides_inst);
     pool_createwhatprovides(priv->pool);
+    if (cacheable)
+        whatprovides_cache_write(sack, fn, key);
+    advise_pool_huge_pages(sack);
     priv->provides_ready = 1;
+    LIBDNF_PROBE(make_provides_ready_end, 0);
+}
+
+/**
+ * dnf_sack_freeze:
+ * @sack: a #DnfSack instance.
+ *
+ * Prepares all state that is otherwise computed lazily on the first query:
+ * internalizes repositories, creates the provides and the providers of every
+ * known dependency, recomputes considered packages and builds the set of
+ * packages every query starts from, the name, arch, repo, dependency name,
+ * sourcerpm and location indexes, the numeric columns of range filters, the
+ * orders of the latest filters and the substring indexes when they are
+ * enabled.
+ *
+ * Afterwards the sack can be shared by threads that only read it. Applying
+ * queries built from already existing dependencies, #DnfPackageSet operations
+ * and the package getters returning a name, arch, evr, version, release,
+ * epoch, repository name, a looked up string or a number are safe to call
+ * concurrently. Getters that compose a string, like the nevra, file lists or
+ * dependency strings, use the scratch space of the pool and are not. Creating
+ * a #DnfReldep or a #HySelector adds to the pool and counts as a write.
+ *
+ * Any modification of the sack ends the frozen state, dnf_sack_freeze() has to
+ * be called again before concurrent use is resumed.
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_sack_freeze(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+
+    if (priv->frozen)
+        return;
+    /* concurrent readers must not load them */
+    dnf_sack_reload_unloaded_exts(sack, nullptr, ~0);
+    repo_internalize_all_trigger(pool);
+    dnf_sack_make_provides_ready(sack);
+    dnf_sack_recompute_considered(sack);
+    /* fills includes_unused, which queries with other exclude flags need */
+    Map *considered = NULL;
+    dnf_sack_recompute_considered_map(sack, &considered,
+                                      libdnf::Query::ExcludeFlags::IGNORE_MODULAR_EXCLUDES);
+    free_map_fully(considered);
+    /* the first query would otherwise replace the map every query starts from */
+    if (priv->pool_nsolvables == 0 || priv->pool_nsolvables != pool->nsolvables) {
+        Map pkg_solvables;
+        Id solvid;
+        map_init(&pkg_solvables, pool->nsolvables);
+        FOR_PKG_SOLVABLES(solvid)
+            MAPSET(&pkg_solvables, solvid);
+        dnf_sack_set_pkg_solvables(sack, &pkg_solvables, pool->nsolvables);
+        map_free(&pkg_solvables);
+    }
+    dnf_sack_running_kernel(sack);
+    dnf_sack_solvables_with_name(sack, 0);
+    dnf_sack_solvables_with_arch(sack, 0);
+    dnf_sack_get_repo_solvables(sack, 0);
+    for (auto attr : {libdnf::PackageAttr::EPOCH, libdnf::PackageAttr::DOWNLOADSIZE,
+                      libdnf::PackageAttr::INSTALLSIZE, libdnf::PackageAttr::BUILDTIME,
+                      libdnf::PackageAttr::INSTALLTIME})
+        dnf_sack_get_num_column(sack, attr);
+    dnf_sack_solvables_with_obsoletes(sack);
+    for (Id keyname : {SOLVABLE_REQUIRES, SOLVABLE_RECOMMENDS, SOLVABLE_SUGGESTS,
+                       SOLVABLE_SUPPLEMENTS, SOLVABLE_ENHANCES, SOLVABLE_CONFLICTS,
+                       SOLVABLE_OBSOLETES})
+        dnf_sack_solvables_with_dep_name(sack, keyname, 0);
+    dnf_sack_solvables_with_sourcerpm(sack, "");
+    dnf_sack_solvables_with_location(sack, "");
+    dnf_sack_get_latest_order(sack, HY_PKG_LATEST);
+    dnf_sack_get_latest_order(sack, HY_PKG_LATEST_PER_ARCH);
+    dnf_sack_get_latest_order(sack, HY_PKG_LATEST_PER_ARCH_BY_PRIORITY);
+    if (priv->use_substring_index) {
+        dnf_sack_get_substring_index(sack, SOLVABLE_SUMMARY);
+        dnf_sack_get_substring_index(sack, SOLVABLE_DESCRIPTION);
+        dnf_sack_get_substring_index(sack, SOLVABLE_URL);
+    }
+
+    /* providers of relations are otherwise added on the first use */
+    for (Id rid = 1; rid < pool->nrels; ++rid)
+        pool_whatprovides(pool, MAKERELDEP(rid));
+    /* pool_createwhatprovides() dropped the hashes, lookups would rebuild them */
+    pool_str2id(pool, "", 0);
+    pool_rel2id(pool, 1, 1, REL_EQ, 0);
+
+    /* split once here, pool_split_evr() would write to the pool scratch space */
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (s->repo && s->evr != ID_EMPTY)
+            dnf_sack_get_split_evr(sack, s->evr);
+    }
+    priv->frozen = TRUE;
+}
+
+/**
+ * dnf_sack_is_frozen:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: %TRUE if the sack was frozen by dnf_sack_freeze() and not modified since
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_is_frozen(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->frozen;
+}
+
+const char *
+dnf_sack_get_frozen_version(DnfSack *sack, Id evr)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->frozen)
+        return NULL;
+    auto split = dnf_sack_get_split_evr(sack, evr);
+    return split ? split->version.c_str() : NULL;
+}
+
+const libdnf::SplitEvr *
+dnf_sack_get_split_evr(DnfSack *sack, Id evr)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (priv->split_evrs) {
+        auto it = priv->split_evrs->find(evr);
+        if (it != priv->split_evrs->end())
+            return &it->second;
+    }
+    /* concurrent readers of a frozen sack may only look the cache up */
+    if (priv->frozen)
+        return NULL;
+    if (!priv->split_evrs)
+        priv->split_evrs = new std::unordered_map<Id, libdnf::SplitEvr>;
+
+    std::string buf;
+    char *e, *v, *r;
+    split_evr(pool_id2str(priv->pool, evr), buf, &e, &v, &r);
+    libdnf::SplitEvr split;
+    split.version = v;
+    split.release = r ? r : "";
+    split.hasRelease = r != NULL;
+    split.plainVersion = !strchr(v, ':');
+    split.plainRelease = !strchr(split.release.c_str(), '-');
+    return &priv->split_evrs->emplace(evr, std::move(split)).first->second;
+}
+
+const libdnf::PackageSet *
+dnf_sack_get_protected_pkgs(DnfSack *sack, const std::vector<std::string> & names)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (priv->protected_pkgs && *priv->protected_names == names)
+        return priv->protected_pkgs;
+
+    std::vector<const char *> cnames;
+    cnames.reserve(names.size() + 1);
+    for (const auto & name : names)
+        cnames.push_back(name.c_str());
+    cnames.push_back(nullptr);
+    libdnf::Query query(sack);
+    query.addFilter(HY_PKG_NAME, HY_EQ, cnames.data());
+    auto pset = new libdnf::PackageSet(*query.runSet());
+
+    delete priv->protected_pkgs;
+    priv->protected_pkgs = pset;
+    if (!priv->protected_names)
+        priv->protected_names = new std::vector<std::string>(names);
+    else
+        *priv->protected_names = names;
+    return pset;
+}
+
+static bool
+packageSetsEqual(const libdnf::PackageSet & a, const libdnf::PackageSet & b)
+{
+    auto aMap = a.getMap();
+    auto bMap = b.getMap();
+    return aMap->size == bMap->size && memcmp(aMap->map, bMap->map, aMap->size) == 0;
+}
+
+const libdnf::PackageSet *
+dnf_sack_unneeded_cache_lookup(DnfSack *sack, const libdnf::PackageSet & userInstalled)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    auto cache = priv->unneeded_cache;
+    if (!cache || cache->installonlyLimit != priv->installonly_limit)
+        return nullptr;
+    if (cache->installonly.size() != static_cast<size_t>(priv->installonly.count) ||
+        !std::equal(cache->installonly.begin(), cache->installonly.end(),
+                    priv->installonly.elements))
+        return nullptr;
+    if (!packageSetsEqual(cache->userInstalled, userInstalled))
+        return nullptr;
+    return &cache->unneeded;
+}
+
+void
+dnf_sack_unneeded_cache_store(DnfSack *sack, const libdnf::PackageSet & userInstalled,
+                              const libdnf::PackageSet & unneeded)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    /* concurrent readers of a frozen sack may only look the cache up */
+    if (priv->frozen)
+        return;
+    delete priv->unneeded_cache;
+    priv->unneeded_cache = new UnneededCache{
+        userInstalled, unneeded,
+        std::vector<Id>(priv->installonly.elements,
+                        priv->installonly.elements + priv->installonly.count),
+        priv->installonly_limit};
 }
 
 /**
@@ -2135,6 +5488,31 @@ dnf_sack_get_module_container(DnfSack *sack)
 
 /**********************************************************************/
 
+/* Resolves the include and exclude patterns in one batch, the packages of the
+ * query are indexed once for all of them. Returns whether any include matched. */
+static bool
+resolve_excludes(libdnf::Query & query, const std::vector<std::string> & includes,
+                 const std::vector<std::string> & excludes, libdnf::PackageSet & includesSet,
+                 libdnf::PackageSet & excludesSet)
+{
+    std::vector<std::string> subjects(includes);
+    subjects.insert(subjects.end(), excludes.begin(), excludes.end());
+    auto solutions = query.resolveSubjects(subjects, nullptr, false, true, false, false);
+
+    bool includesMatched = false;
+    for (std::size_t i = 0; i < solutions.size(); ++i) {
+        if (!solutions[i].matched)
+            continue;
+        if (i < includes.size()) {
+            includesSet += *solutions[i].query->runSet();
+            includesMatched = true;
+        } else {
+            excludesSet += *solutions[i].query->runSet();
+        }
+    }
+    return includesMatched;
+}
+
 static void
 process_excludes(DnfSack *sack, GPtrArray *enabled_repos)
 {
@@ -2156,146 +5534,491 @@ process_excludes(DnfSack *sack, GPtrArray *enabled_repos)
             continue;
         }
 
+        auto & includes = repo->getConfig()->includepkgs().getValue();
+        auto & excludes = repo->getConfig()->excludepkgs().getValue();
+        if (includes.empty() && excludes.empty())
+            continue;
+
         libdnf::Query repoQuery(sack);
         repoQuery.addFilter(HY_PKG_REPONAME, HY_EQ, repo->getId().c_str());
-        repoQuery.apply();
+        if (resolve_excludes(repoQuery, includes, excludes, repoIncludes, repoExcludes)) {
+            includesExist = true;
+            repo->setUseIncludes(true);
+        }
+    }
 
-        for (const auto & name : repo->getConfig()->includepkgs().getValue()) {
-            libdnf::Query query(repoQuery);
-            auto ret = query.filterSubject(name.c_str(), nullptr, false, true, false, false);
-            if (ret.first) {
-                repoIncludes += *query.runSet();
+    if (std::find(disabled.begin(), disabled.end(), "main") == disabled.end()) {
+        auto & includes = mainConf.includepkgs().getValue();
+        auto & excludes = mainConf.excludepkgs().getValue();
+        if (!includes.empty() || !excludes.empty()) {
+            libdnf::Query query(sack);
+            if (resolve_excludes(query, includes, excludes, repoIncludes, repoExcludes)) {
                 includesExist = true;
-                repo->setUseIncludes(true);
+                dnf_sack_set_use_includes(sack, nullptr, true);
             }
         }
+    }
+
+    if (includesExist) {
+        dnf_sack_add_includes(sack, &repoIncludes);
+    }
+    dnf_sack_add_excludes(sack, &repoExcludes);
+}
+
+static gboolean
+dnf_sack_check_repo(DnfRepo *repo,
+                    guint permissible_cache_age,
+                    DnfState *state,
+                    gboolean *usable,
+                    GError **error)
+{
+    GError *error_local = NULL;
 
-        for (const auto & name : repo->getConfig()->excludepkgs().getValue()) {
-            libdnf::Query query(repoQuery);
-            auto ret = query.filterSubject(name.c_str(), nullptr, false, true, false, false);
-            if (ret.first) {
-                repoExcludes += *query.runSet();
+    *usable = FALSE;
+    if (!dnf_repo_check(repo, permissible_cache_age, state, &error_local)) {
+        g_debug("failed to check, attempting update: %s",
+                error_local->message);
+        g_clear_error(&error_local);
+        dnf_state_reset(state);
+        if (!dnf_repo_update(repo,
+                             DNF_REPO_UPDATE_FLAG_FORCE,
+                             state,
+                             &error_local)) {
+            if (!dnf_repo_get_required(repo) &&
+                (g_error_matches(error_local,
+                                 DNF_ERROR,
+                                 DNF_ERROR_CANNOT_FETCH_SOURCE) ||
+                 g_error_matches(error_local,
+                                 DNF_ERROR,
+                                 DNF_ERROR_REPO_NOT_AVAILABLE))) {
+                g_warning("Skipping refresh of %s: %s",
+                          dnf_repo_get_id(repo),
+                          error_local->message);
+                g_error_free(error_local);
+                return TRUE;
             }
+            g_propagate_error(error, error_local);
+            return FALSE;
+        }
+    }
+
+    /* checking disabled the repo */
+    if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_NONE) {
+        g_debug("Skipping %s as repo no longer enabled",
+                dnf_repo_get_id(repo));
+        return TRUE;
+    }
+
+    *usable = TRUE;
+    return TRUE;
+}
+
+static int
+dnf_sack_add_flags_to_load_flags(DnfSackAddFlags flags)
+{
+    int flags_hy = DNF_SACK_LOAD_FLAG_BUILD_CACHE;
+
+    /* only load what's required */
+    if ((flags & DNF_SACK_ADD_FLAG_FILELISTS) > 0)
+        flags_hy |= DNF_SACK_LOAD_FLAG_USE_FILELISTS;
+    if ((flags & DNF_SACK_ADD_FLAG_OTHER) > 0)
+        flags_hy |= DNF_SACK_LOAD_FLAG_USE_OTHER;
+    if ((flags & DNF_SACK_ADD_FLAG_UPDATEINFO) > 0)
+        flags_hy |= DNF_SACK_LOAD_FLAG_USE_UPDATEINFO;
+    return flags_hy;
+}
+
+/**
+ * dnf_sack_add_repo:
+ */
+gboolean
+dnf_sack_add_repo(DnfSack *sack,
+                    DnfRepo *repo,
+                    guint permissible_cache_age,
+                    DnfSackAddFlags flags,
+                    DnfState *state,
+                    GError **error) try
+{
+    gboolean ret = TRUE;
+    gboolean usable;
+    DnfState *state_local;
+    int flags_hy = dnf_sack_add_flags_to_load_flags(flags);
+
+    /* set state */
+    ret = dnf_state_set_steps(state, error,
+                   5, /* check repo */
+                   95, /* load solv */
+                   -1);
+    if (!ret)
+        return FALSE;
+
+    /* check repo */
+    state_local = dnf_state_get_child(state);
+    if (!dnf_sack_check_repo(repo, permissible_cache_age, state_local, &usable, error))
+        return FALSE;
+    if (!usable)
+        return dnf_state_finished(state, error);
+
+    /* done */
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    /* load solv */
+    g_debug("Loading repo %s", dnf_repo_get_id(repo));
+    dnf_state_action_start(state, DNF_STATE_ACTION_LOADING_CACHE, NULL);
+    if (!dnf_sack_load_repo(sack, dnf_repo_get_repo(repo), flags_hy, error))
+        return FALSE;
+
+    /* done */
+    return dnf_state_done(state, error);
+} CATCH_TO_GERROR(FALSE)
+
+/* A repo whose solv cache files are (re)built on a worker thread. The worker
+ * only touches its own private pool, the shared pool of the sack is never
+ * accessed outside of the main thread. */
+struct SolvCacheJob {
+    std::string id;
+    std::string fnRepomd;
+    std::string fnPrimary;
+    std::string fnFilelists;
+    std::string fnOther;
+    std::string fnCache;
+    std::string fnCacheFilelists;
+    std::string fnCacheOther;
+    unsigned char checksum[CHKSUM_BYTES];
+    unsigned char repomdStat[CHKSUM_BYTES];
+};
+
+static gboolean
+solv_cache_is_valid(const char *path, const unsigned char *checksum)
+{
+    FILE *fp = solv_cache_fopen(path);
+    if (!fp)
+        return FALSE;
+    std::unique_ptr<SolvUserdata> solv_userdata = solv_userdata_read(fp);
+    gboolean ret = solv_userdata && solv_userdata_verify(solv_userdata.get(), checksum);
+    fclose(fp);
+    return ret;
+}
+
+// Write repo (or only the given extension repodata of it) into a solv cache file
+static gboolean
+write_solv_cache_file(Repo *repo, Repodata *ext_data, const char *fn,
+                      const unsigned char *checksum, const unsigned char *repomd_stat,
+                      GError **error)
+{
+    char *tmp_fn_templ = solv_dupjoin(fn, ".XXXXXX", NULL);
+    int tmp_fd = mkstemp(tmp_fn_templ);
+    gboolean ret = FALSE;
+    FILE *fp;
+    SolvUserdata solv_userdata;
+    Repowriter *writer;
+    int rc;
+
+    if (tmp_fd < 0) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("cannot create temporary file: %s"),
+                    tmp_fn_templ);
+        g_free(tmp_fn_templ);
+        return FALSE;
+    }
+    fp = fdopen(tmp_fd, "w+");
+    if (!fp)
+        close(tmp_fd);
+    fp = solv_cache_fwrap_write(fp);
+    if (!fp) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("failed opening tmp file: %s"),
+                    strerror(errno));
+        goto done;
+    }
+    if (solv_userdata_fill(&solv_userdata, checksum, repomd_stat, error)) {
+        fclose(fp);
+        goto done;
+    }
+
+    writer = repowriter_create(repo);
+    repowriter_set_userdata(writer, &solv_userdata, solv_userdata_size);
+    if (ext_data) {
+        repowriter_set_repodatarange(writer, ext_data->repodataid, ext_data->repodataid + 1);
+        repowriter_set_flags(writer, REPOWRITER_NO_STORAGE_SOLVABLE);
+    }
+    rc = repowriter_write(writer, fp);
+    repowriter_free(writer);
+    if (rc) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_INTERNAL_ERROR,
+                    _("While writing cache %s repowriter write failed: %i, error: %s"),
+                    tmp_fn_templ, rc, pool_errstr(repo->pool));
+        fclose(fp);
+        goto done;
+    }
+    if (fclose(fp)) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("Failed closing tmp file %s: %s"),
+                    tmp_fn_templ, strerror(errno));
+        goto done;
+    }
+    ret = mv(tmp_fn_templ, fn, error);
+
+ done:
+    if (!ret)
+        unlink(tmp_fn_templ);
+    g_free(tmp_fn_templ);
+    return ret;
+}
+
+static gboolean
+build_solv_cache_ext(SolvCacheJob *job, Repo *repo, const std::string & fn,
+                     const std::string & fn_cache, const char *language, GError **error)
+{
+    if (fn.empty() || solv_cache_is_valid(fn_cache.c_str(), job->checksum))
+        return TRUE;
+
+    FILE *fp = solv_xfopen(fn.c_str(), "r");
+    if (!fp) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("failed to open: %s"), fn.c_str());
+        return FALSE;
+    }
+    int rc = repo_add_rpmmd(repo, fp, language, REPO_EXTEND_SOLVABLES);
+    fclose(fp);
+    if (rc) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_INTERNAL_ERROR,
+                    _("Loading %s has failed: %s"),
+                    fn.c_str(), pool_errstr(repo->pool));
+        return FALSE;
+    }
+    Repodata *data = repo_id2repodata(repo, repo->nrepodata - 1);
+    return write_solv_cache_file(repo, data, fn_cache.c_str(), job->checksum, NULL, error);
+}
+
+static gboolean
+build_solv_cache(SolvCacheJob *job, Repo *repo, GError **error)
+{
+    const char *fn_cache = job->fnCache.c_str();
+    gboolean need_ext =
+        (!job->fnFilelists.empty() &&
+         !solv_cache_is_valid(job->fnCacheFilelists.c_str(), job->checksum)) ||
+        (!job->fnOther.empty() &&
+         !solv_cache_is_valid(job->fnCacheOther.c_str(), job->checksum));
+
+    if (solv_cache_is_valid(fn_cache, job->checksum)) {
+        if (!need_ext)
+            return TRUE;
+        // extensions are written relative to the solvables of the main cache
+        FILE *fp = solv_cache_fopen(fn_cache);
+        if (!fp || repo_add_solv(repo, fp, 0)) {
+            if (fp)
+                fclose(fp);
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("repo_add_solv() has failed."));
+            return FALSE;
+        }
+        fclose(fp);
+    } else {
+        FILE *fp_repomd = fopen(job->fnRepomd.c_str(), "r");
+        if (!fp_repomd) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_FILE_INVALID,
+                        _("can not read file %1$s: %2$s"),
+                        job->fnRepomd.c_str(), strerror(errno));
+            return FALSE;
+        }
+        int rc = repo_add_repomdxml(repo, fp_repomd, 0);
+        fclose(fp_repomd);
+        if (rc) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("Loading repomd has failed: %s"),
+                        pool_errstr(repo->pool));
+            return FALSE;
+        }
+        FILE *fp_primary = solv_xfopen(job->fnPrimary.c_str(), "r");
+        if (!fp_primary) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("Opening repository primary data has failed: %s"),
+                        strerror(errno));
+            return FALSE;
+        }
+        rc = repo_add_rpmmd(repo, fp_primary, 0, 0);
+        fclose(fp_primary);
+        if (rc) {
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("Loading primary has failed: %s"),
+                        pool_errstr(repo->pool));
+            return FALSE;
         }
+        if (!write_solv_cache_file(repo, NULL, fn_cache, job->checksum, job->repomdStat, error))
+            return FALSE;
     }
 
-    if (std::find(disabled.begin(), disabled.end(), "main") == disabled.end()) {
-        bool useGlobalIncludes = false;
-        for (const auto & name : mainConf.includepkgs().getValue()) {
-            libdnf::Query query(sack);
-            auto ret = query.filterSubject(name.c_str(), nullptr, false, true, false, false);
-            if (ret.first) {
-                repoIncludes += *query.runSet();
-                includesExist = true;
-                useGlobalIncludes = true;
-            }
-        }
+    if (!build_solv_cache_ext(job, repo, job->fnFilelists, job->fnCacheFilelists, "FL", error))
+        return FALSE;
+    return build_solv_cache_ext(job, repo, job->fnOther, job->fnCacheOther, NULL, error);
+}
 
-        for (const auto & name : mainConf.excludepkgs().getValue()) {
-            libdnf::Query query(sack);
-            auto ret = query.filterSubject(name.c_str(), nullptr, false, true, false, false);
-            if (ret.first) {
-                repoExcludes += *query.runSet();
-            }
+static void
+build_solv_cache_cb(gpointer data, gpointer user_data)
+{
+    auto job = static_cast<SolvCacheJob *>(data);
+    g_autoptr(GError) error_local = NULL;
+
+    Pool *pool = pool_create();
+    Repo *repo = repo_create(pool, job->id.c_str());
+    libdnf::PhaseTimer timer("build_solv_cache", job->id.c_str());
+    g_debug("building solv cache of %s", job->id.c_str());
+    if (!build_solv_cache(job, repo, &error_local)) {
+        // not fatal, the cache is rebuilt while loading the repo and the error reported there
+        g_debug("failed to build solv cache of %s: %s", job->id.c_str(), error_local->message);
+    }
+    pool_free(pool);
+}
+
+/* Parse the metadata of all repos with a missing or outdated solv cache
+ * concurrently, every repo into its own pool. The caches are then loaded into
+ * the sack one after another in the order of the repos array, so the resulting
+ * pool does not depend on the scheduling of the workers. */
+static void
+dnf_sack_build_solv_caches(DnfSack *sack, GPtrArray *repos, int flags_hy)
+{
+    std::vector<std::unique_ptr<SolvCacheJob>> jobs;
+
+    for (guint i = 0; i < repos->len; i++) {
+        auto dnfRepo = static_cast<DnfRepo *>(g_ptr_array_index(repos, i));
+        HyRepo hrepo = dnf_repo_get_repo(dnfRepo);
+        auto repoImpl = libdnf::repoGetImpl(hrepo);
+        const char *name = hrepo->getId().c_str();
+        std::unique_ptr<SolvCacheJob> job(new SolvCacheJob);
+
+        job->id = hrepo->getId();
+        job->fnRepomd = repoImpl->repomdFn;
+        job->fnPrimary = hrepo->getMetadataPath(MD_TYPE_PRIMARY);
+        if (job->fnRepomd.empty() || job->fnPrimary.empty())
+            continue;
+        FILE *fp_repomd = fopen(job->fnRepomd.c_str(), "r");
+        if (!fp_repomd)
+            continue;
+        g_autofree gchar *fn_cache = dnf_sack_give_cache_fn(sack, name, NULL);
+        job->fnCache = fn_cache;
+        repomd_checksum(sack, fp_repomd, fn_cache, job->checksum, job->repomdStat);
+        fclose(fp_repomd);
+        if (flags_hy & DNF_SACK_LOAD_FLAG_USE_FILELISTS) {
+            g_autofree gchar *fn_cache_ext = dnf_sack_give_cache_fn(sack, name, HY_EXT_FILENAMES);
+            job->fnFilelists = hrepo->getMetadataPath(MD_TYPE_FILELISTS);
+            job->fnCacheFilelists = fn_cache_ext;
         }
-        
-        if (useGlobalIncludes) {
-            dnf_sack_set_use_includes(sack, nullptr, true);
+        if (flags_hy & DNF_SACK_LOAD_FLAG_USE_OTHER) {
+            g_autofree gchar *fn_cache_ext = dnf_sack_give_cache_fn(sack, name, HY_EXT_OTHER);
+            job->fnOther = hrepo->getMetadataPath(MD_TYPE_OTHER);
+            job->fnCacheOther = fn_cache_ext;
         }
+        if (solv_cache_is_valid(job->fnCache.c_str(), job->checksum) &&
+            (job->fnFilelists.empty() ||
+             solv_cache_is_valid(job->fnCacheFilelists.c_str(), job->checksum)) &&
+            (job->fnOther.empty() ||
+             solv_cache_is_valid(job->fnCacheOther.c_str(), job->checksum)))
+            continue;
+        jobs.push_back(std::move(job));
+    }
+    if (jobs.size() < 2) {
+        // nothing to gain, the serial loading builds the cache itself
+        return;
     }
 
-    if (includesExist) {
-        dnf_sack_add_includes(sack, &repoIncludes);
+    g_autoptr(GError) error_local = NULL;
+    GThreadPool *thread_pool = g_thread_pool_new(build_solv_cache_cb, NULL,
+                                                 g_get_num_processors(), FALSE, &error_local);
+    if (!thread_pool) {
+        g_warning("Failed to create thread pool for building solv caches: %s",
+                  error_local->message);
+        return;
     }
-    dnf_sack_add_excludes(sack, &repoExcludes);
+    for (auto & job : jobs)
+        g_thread_pool_push(thread_pool, job.get(), NULL);
+    // wait for all the jobs to finish
+    g_thread_pool_free(thread_pool, FALSE, TRUE);
 }
 
-/**
- * dnf_sack_add_repo:
- */
-gboolean
-dnf_sack_add_repo(DnfSack *sack,
-                    DnfRepo *repo,
-                    guint permissible_cache_age,
-                    DnfSackAddFlags flags,
-                    DnfState *state,
-                    GError **error) try
+static gboolean
+dnf_sack_add_repos_parallel(DnfSack *sack,
+                            GPtrArray *repos,
+                            guint permissible_cache_age,
+                            DnfSackAddFlags flags,
+                            DnfState *state,
+                            GPtrArray *enabled_repos,
+                            const std::function<gboolean(GError **)> & before_load,
+                            GError **error)
 {
-    gboolean ret = TRUE;
-    GError *error_local = NULL;
     DnfState *state_local;
-    int flags_hy = DNF_SACK_LOAD_FLAG_BUILD_CACHE;
-
-    /* set state */
-    ret = dnf_state_set_steps(state, error,
-                   5, /* check repo */
-                   95, /* load solv */
-                   -1);
-    if (!ret)
+    DnfState *state_loop;
+    gboolean usable;
+    int flags_hy = dnf_sack_add_flags_to_load_flags(flags);
+
+    if (!dnf_state_set_steps(state, error,
+                             10, /* check repos */
+                             60, /* build solv caches */
+                             30, /* load solv */
+                             -1))
         return FALSE;
 
-    /* check repo */
+    /* check repos */
     state_local = dnf_state_get_child(state);
-    ret = dnf_repo_check(repo,
-                         permissible_cache_age,
-                         state_local,
-                         &error_local);
-    if (!ret) {
-        g_debug("failed to check, attempting update: %s",
-                error_local->message);
-        g_clear_error(&error_local);
-        dnf_state_reset(state_local);
-        ret = dnf_repo_update(repo,
-                              DNF_REPO_UPDATE_FLAG_FORCE,
-                              state_local,
-                              &error_local);
-        if (!ret) {
-            if (!dnf_repo_get_required(repo) &&
-                (g_error_matches(error_local,
-                                 DNF_ERROR,
-                                 DNF_ERROR_CANNOT_FETCH_SOURCE) ||
-                 g_error_matches(error_local,
-                                 DNF_ERROR,
-                                 DNF_ERROR_REPO_NOT_AVAILABLE))) {
-                g_warning("Skipping refresh of %s: %s",
-                          dnf_repo_get_id(repo),
-                          error_local->message);
-                g_error_free(error_local);
-                return dnf_state_finished(state, error);
-            }
-            g_propagate_error(error, error_local);
+    dnf_state_set_number_steps(state_local, repos->len);
+    g_autoptr(GPtrArray) checked_repos = g_ptr_array_new();
+    for (guint i = 0; i < repos->len; i++) {
+        auto repo = static_cast<DnfRepo *>(g_ptr_array_index(repos, i));
+        state_loop = dnf_state_get_child(state_local);
+        if (!dnf_sack_check_repo(repo, permissible_cache_age, state_loop, &usable, error))
+            return FALSE;
+        if (usable)
+            g_ptr_array_add(checked_repos, repo);
+        if (!dnf_state_done(state_local, error))
             return FALSE;
-        }
-    }
-
-    /* checking disabled the repo */
-    if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_NONE) {
-        g_debug("Skipping %s as repo no longer enabled",
-                dnf_repo_get_id(repo));
-        return dnf_state_finished(state, error);
     }
-
-    /* done */
     if (!dnf_state_done(state, error))
         return FALSE;
 
-    /* only load what's required */
-    if ((flags & DNF_SACK_ADD_FLAG_FILELISTS) > 0)
-        flags_hy |= DNF_SACK_LOAD_FLAG_USE_FILELISTS;
-    if ((flags & DNF_SACK_ADD_FLAG_OTHER) > 0)
-        flags_hy |= DNF_SACK_LOAD_FLAG_USE_OTHER;
-    if ((flags & DNF_SACK_ADD_FLAG_UPDATEINFO) > 0)
-        flags_hy |= DNF_SACK_LOAD_FLAG_USE_UPDATEINFO;
-
-    /* load solv */
-    g_debug("Loading repo %s", dnf_repo_get_id(repo));
-    dnf_state_action_start(state, DNF_STATE_ACTION_LOADING_CACHE, NULL);
-    if (!dnf_sack_load_repo(sack, dnf_repo_get_repo(repo), flags_hy, error))
+    /* build solv caches */
+    dnf_sack_build_solv_caches(sack, checked_repos, flags_hy);
+    if (before_load && !before_load(error))
+        return FALSE;
+    if (!dnf_state_done(state, error))
         return FALSE;
 
-    /* done */
+    /* load solv */
+    state_local = dnf_state_get_child(state);
+    dnf_state_set_number_steps(state_local, checked_repos->len);
+    for (guint i = 0; i < checked_repos->len; i++) {
+        auto repo = static_cast<DnfRepo *>(g_ptr_array_index(checked_repos, i));
+        g_debug("Loading repo %s", dnf_repo_get_id(repo));
+        if (!dnf_sack_load_repo(sack, dnf_repo_get_repo(repo), flags_hy, error))
+            return FALSE;
+        g_ptr_array_add(enabled_repos, repo);
+        if (!dnf_state_done(state_local, error))
+            return FALSE;
+    }
     return dnf_state_done(state, error);
-} CATCH_TO_GERROR(FALSE)
+}
 
 /**
  * dnf_sack_add_repos:
@@ -2308,12 +6031,26 @@ dnf_sack_add_repos(DnfSack *sack,
                      DnfState *state,
                      GError **error) try
 {
+    return dnf_sack_add_repos_full(sack, repos, permissible_cache_age, flags, state, {}, error);
+} CATCH_TO_GERROR(FALSE)
+
+gboolean
+dnf_sack_add_repos_full(DnfSack *sack,
+                        GPtrArray *repos,
+                        guint permissible_cache_age,
+                        DnfSackAddFlags flags,
+                        DnfState *state,
+                        const std::function<gboolean(GError **)> & before_load,
+                        GError **error)
+{
+    libdnf::PhaseTimer timer("dnf_sack_add_repos");
     gboolean ret;
     guint cnt = 0;
     guint i;
     DnfRepo *repo;
     DnfState *state_local;
     g_autoptr(GPtrArray) enabled_repos = g_ptr_array_new();
+    g_autoptr(GPtrArray) usable_repos = g_ptr_array_new();
 
     /* count the enabled repos */
     for (i = 0; i < repos->len; i++) {
@@ -2327,22 +6064,26 @@ dnf_sack_add_repos(DnfSack *sack,
                 continue;
         }
 
+        g_ptr_array_add(usable_repos, repo);
         cnt++;
     }
 
-    /* add each repo */
-    dnf_state_set_number_steps(state, cnt);
-    for (i = 0; i < repos->len; i++) {
-        repo = static_cast<DnfRepo *>(g_ptr_array_index(repos, i));
-        if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_NONE)
-            continue;
+    if ((flags & DNF_SACK_ADD_FLAG_PARALLEL) > 0) {
+        if (!dnf_sack_add_repos_parallel(sack, usable_repos, permissible_cache_age,
+                                         flags, state, enabled_repos, before_load, error))
+            return FALSE;
+        process_excludes(sack, enabled_repos);
+        return TRUE;
+    }
 
-        /* only allow metadata-only repos if FLAG_UNAVAILABLE is set */
-        if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_METADATA) {
-            if ((flags & DNF_SACK_ADD_FLAG_UNAVAILABLE) == 0)
-                continue;
-        }
+    /* every repo is loaded right after it is checked */
+    if (before_load && !before_load(error))
+        return FALSE;
 
+    /* add each repo */
+    dnf_state_set_number_steps(state, cnt);
+    for (i = 0; i < usable_repos->len; i++) {
+        repo = static_cast<DnfRepo *>(g_ptr_array_index(usable_repos, i));
         state_local = dnf_state_get_child(state);
         ret = dnf_sack_add_repo(sack,
                                   repo,
@@ -2364,6 +6105,147 @@ dnf_sack_add_repos(DnfSack *sack,
 
     /* success */
     return TRUE;
+}
+
+static Repo *
+dnf_sack_find_libsolv_repo(DnfSack *sack, const char *name)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Id repoid;
+    Repo *repo;
+    FOR_REPOS(repoid, repo) {
+        if (g_strcmp0(repo->name, name) == 0)
+            return repo;
+    }
+    return NULL;
+}
+
+/* Frees a repo from the pool. Its solvable ids are not reused, so that maps
+ * and packages of the sack referring to them do not silently match the
+ * solvables loaded in their place. */
+static void
+dnf_sack_drop_libsolv_repo(DnfSack *sack, Repo *repo)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    auto hrepo = static_cast<HyRepo>(repo->appdata);
+    if (hrepo)
+        libdnf::repoGetImpl(hrepo)->detachLibsolvRepo();
+    if (repo == priv->cmdline_repo)
+        priv->cmdline_repo = NULL;
+    repo_free(repo, 0);
+    priv->provides_ready = 0;
+    priv->considered_uptodate = FALSE;
+    /* the freed solvables keep pool->nsolvables, the map of all packages would still match */
+    priv->pkg_solvables = free_map_fully(priv->pkg_solvables);
+    priv->pool_nsolvables = 0;
+    dnf_sack_invalidate_solvable_indexes(sack);
+}
+
+bool
+dnf_sack_system_repo_is_stale(DnfSack *sack)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    unsigned char checksum[CHKSUM_BYTES];
+    if (pool->installed == NULL)
+        return false;
+    auto hrepo = static_cast<HyRepo>(pool->installed->appdata);
+    /* without a cookie nothing tells the rpmdb did not change */
+    if (hrepo == NULL || !rpmdb_cookie_checksum(pool, checksum))
+        return true;
+    return memcmp(checksum, libdnf::repoGetImpl(hrepo)->checksum, CHKSUM_BYTES) != 0;
+}
+
+bool
+dnf_sack_repo_is_stale(DnfSack *sack, HyRepo hrepo)
+{
+    unsigned char checksum[CHKSUM_BYTES];
+    Repo *repo = dnf_sack_find_libsolv_repo(sack, hrepo->getId().c_str());
+    if (repo == NULL || repo->appdata == NULL)
+        return false;
+    auto loaded = static_cast<HyRepo>(repo->appdata);
+    auto & repomdFn = libdnf::repoGetImpl(hrepo)->repomdFn;
+    FILE *fp = repomdFn.empty() ? NULL : fopen(repomdFn.c_str(), "r");
+    if (fp == NULL)
+        return false;
+    checksum_fp(checksum, fp);
+    fclose(fp);
+    return memcmp(checksum, libdnf::repoGetImpl(loaded)->checksum, CHKSUM_BYTES) != 0;
+}
+
+std::string
+dnf_sack_get_repo_checksum(DnfSack *sack, Repo *repo)
+{
+    static const unsigned char unknown[CHKSUM_BYTES] = {};
+    auto hrepo = static_cast<HyRepo>(repo->appdata);
+    if (hrepo == NULL)
+        return {};
+    auto checksum = libdnf::repoGetImpl(hrepo)->checksum;
+    if (memcmp(checksum, unknown, CHKSUM_BYTES) == 0)
+        return {};
+    return pool_checksum_str(dnf_sack_get_pool(sack), checksum);
+}
+
+/**
+ * dnf_sack_reload_system_repo:
+ * @sack: a #DnfSack instance.
+ * @flags: what to load into the sack, e.g. %DNF_SACK_LOAD_FLAG_BUILD_CACHE.
+ * @error: a #GError or %NULL.
+ *
+ * Replaces the rpmdb loaded into the sack with its current contents, keeping
+ * the remote repos. The main configuration excludes are applied again.
+ * #DnfPackage objects of the previous rpmdb must not be used afterwards.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_reload_system_repo(DnfSack *sack, int flags, GError **error) try
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+    g_autoptr(GPtrArray) no_repos = g_ptr_array_new();
+
+    if (pool->installed != NULL)
+        dnf_sack_drop_libsolv_repo(sack, pool->installed);
+    priv->running_kernel_id = -1;
+    if (!dnf_sack_load_system_repo(sack, NULL, flags, error))
+        return FALSE;
+    process_excludes(sack, no_repos);
+    return TRUE;
+} CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_sack_reload_repo:
+ * @sack: a #DnfSack instance.
+ * @repo: a #DnfRepo already loaded into the sack.
+ * @flags: #DnfSackAddFlags as used for loading it.
+ * @error: a #GError or %NULL.
+ *
+ * Replaces the packages of @repo in the sack with its current metadata, e.g.
+ * after dnf_repo_update(), keeping all the other repos. The excludes of the
+ * repo are applied again. #DnfPackage objects of the previous metadata must
+ * not be used afterwards.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_sack_reload_repo(DnfSack *sack, DnfRepo *repo, DnfSackAddFlags flags, GError **error) try
+{
+    HyRepo hrepo = dnf_repo_get_repo(repo);
+    g_autoptr(GPtrArray) reloaded = g_ptr_array_new();
+
+    Repo *old = dnf_sack_find_libsolv_repo(sack, hrepo->getId().c_str());
+    if (old != NULL)
+        dnf_sack_drop_libsolv_repo(sack, old);
+    g_debug("Reloading repo %s", dnf_repo_get_id(repo));
+    if (!dnf_sack_load_repo(sack, hrepo, dnf_sack_add_flags_to_load_flags(flags), error))
+        return FALSE;
+    g_ptr_array_add(reloaded, repo);
+    process_excludes(sack, reloaded);
+    return TRUE;
 } CATCH_TO_GERROR(FALSE)
 
 namespace {
@@ -2391,7 +6273,7 @@ static std::map<std::string, std::vector<std::string>> getDemodularizedRpms(
     std::map<std::string, std::vector<std::string>> ret;
     auto latest = moduleContainer.getLatestModules(allPackages, true);
     for (auto modulePackage : latest) {
-        auto demodularized = modulePackage->getDemodularizedRpms();
+        const auto & demodularized = modulePackage->getDemodularizedRpms();
         if (demodularized.empty()) {
             continue;
         }
@@ -2404,99 +6286,180 @@ static std::map<std::string, std::vector<std::string>> getDemodularizedRpms(
     return ret;
 }
 
-/// Return <includeNEVRAs>, <excludeNEVRAs>, <names>, <srcNames>, <name dependency container>
-static std::tuple<std::vector<std::string>, std::vector<std::string>, std::vector<std::string>, std::vector<std::string>, libdnf::DependencyContainer>
+struct ArtifactNevraHash {
+    std::size_t operator()(const ArtifactNevra & nevra) const
+    {
+        auto hash = static_cast<std::size_t>(nevra.name);
+        hash = hash * 31 + static_cast<std::size_t>(nevra.evr);
+        return hash * 31 + static_cast<std::size_t>(nevra.arch);
+    }
+};
+
+using ArtifactNevraSet = std::unordered_set<ArtifactNevra, ArtifactNevraHash>;
+
+/// Split "name-[epoch:]version-release.arch" the same way HY_PKG_NEVRA_STRICT does and look the parts
+/// up in the pool without creating new strings
+/// @return false if the artifact is not a well formed NEVRA
+static bool
+parseArtifactNevra(Pool * pool, const char * artifact, ArtifactNevra & nevra)
+{
+    const char * evrDelim = nullptr;
+    const char * releaseDelim = nullptr;
+    const char * archDelim = nullptr;
+    const char * end;
+
+    for (end = artifact; *end != '\0'; ++end) {
+        if (*end == '-') {
+            evrDelim = releaseDelim;
+            releaseDelim = end;
+        } else if (*end == '.') {
+            archDelim = end;
+        }
+    }
+    if (!evrDelim || evrDelim == artifact) {
+        return false;
+    }
+    auto nameLen = evrDelim - artifact;
+
+    // strip epoch "0:" like libsolv does
+    int index = 1;
+    while (evrDelim[index] == '0') {
+        if (evrDelim[++index] == ':') {
+            evrDelim += index;
+        }
+    }
+    if (releaseDelim - evrDelim <= 1 ||
+        !archDelim || archDelim <= releaseDelim + 1 || archDelim == end - 1) {
+        return false;
+    }
+    ++evrDelim;
+    ++archDelim;
+    nevra.name = pool_strn2id(pool, artifact, nameLen, 0);
+    nevra.evr = pool_strn2id(pool, evrDelim, archDelim - 1 - evrDelim, 0);
+    nevra.arch = pool_strn2id(pool, archDelim, end - archDelim, 0);
+    return true;
+}
+
+/// Artifacts of the module parsed by parseArtifactNevra(), the malformed ones are left out. The result is
+/// kept until the module metadata is reloaded or the pool gets new strings.
+static const std::vector<ArtifactNevra> &
+moduleArtifactNevras(DnfSack * sack, const libdnf::ModulePackageContainer & container,
+                     const libdnf::ModulePackage & module)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool * pool = priv->pool;
+    auto cache = priv->module_artifact_ids;
+    if (cache && (cache->container != &container || cache->nstrings != pool->ss.nstrings)) {
+        delete cache;
+        cache = priv->module_artifact_ids = NULL;
+    }
+    if (!cache) {
+        cache = priv->module_artifact_ids = new ModuleArtifactIds{&container, pool->ss.nstrings, {}};
+    }
+    auto inserted = cache->byModule.emplace(module.getId(), std::vector<ArtifactNevra>());
+    auto & nevras = inserted.first->second;
+    if (inserted.second) {
+        ArtifactNevra nevra;
+        for (const auto & rpm : module.getArtifacts()) {
+            if (parseArtifactNevra(pool, rpm.c_str(), nevra)) {
+                nevras.push_back(nevra);
+            }
+        }
+    }
+    return nevras;
+}
+
+/// Module artifacts interned into pool Ids
+struct ModuleArtifacts {
+    explicit ModuleArtifacts(DnfSack * sack) : nameDependencies(sack) {}
+
+    ArtifactNevraSet includeNEVRAs;
+    ArtifactNevraSet excludeNEVRAs;
+    std::unordered_set<Id> names;
+    std::unordered_set<Id> srcNames;
+    libdnf::DependencyContainer nameDependencies;
+};
+
+/// Collect NEVRAs of artifacts of active (include) and inactive (exclude) modules, and names of binary and
+/// source artifacts of active modules which are not demodularized
+static ModuleArtifacts
 collectNevraForInclusionExclusion(DnfSack *sack, libdnf::ModulePackageContainer &modulePackageContainer)
 {
+    Pool * pool = dnf_sack_get_pool(sack);
     auto allPackages = modulePackageContainer.getModulePackages();
     auto demodularizedNames = getDemodularizedRpms(modulePackageContainer, allPackages);
 
-    std::vector<std::string> includeNEVRAs;
-    std::vector<std::string> excludeNEVRAs;
-    std::vector<std::string> names;
-    std::vector<std::string> srcNames;
-    libdnf::DependencyContainer nameDependencies{sack};
-    libdnf::Nevra nevra;
-    // TODO: turn into std::vector<const char *> to prevent unnecessary conversion?
+    ModuleArtifacts ret(sack);
+    std::unordered_set<Id> demodularizedIds;
     for (const auto & module : allPackages) {
-        auto artifacts = module->getArtifacts();
+        const auto & artifacts = moduleArtifactNevras(sack, modulePackageContainer, *module);
         // TODO use Goal::listInstalls() to not requires filtering out Platform
-        if (modulePackageContainer.isModuleActive(module->getId())) {
-            std::string packageID{module->getNameStream()};
-            packageID.append(".");
-            packageID.append(module->getArch());
-            auto it = demodularizedNames.find(packageID);
-            if (it == demodularizedNames.end()) {
-                for (const auto &rpm : artifacts) {
-                    if (nevra.parse(rpm.c_str(), HY_FORM_NEVRA)) {
-                        auto arch = nevra.getArch();
-                        // source packages do not provide anything and must not cause excluding binary packages
-                        if (arch == "src" || arch == "nosrc") {
-                            srcNames.push_back(nevra.getName());
-                        } else {
-                            names.push_back(nevra.getName());
-                            nameDependencies.addReldep(nevra.getName().c_str());
-                        }
-                    }
+        if (!modulePackageContainer.isModuleActive(module->getId())) {
+            for (const auto & nevra : artifacts) {
+                if (nevra.name && nevra.evr && nevra.arch) {
+                    ret.excludeNEVRAs.insert(nevra);
                 }
-            } else {
-                for (const auto &rpm : artifacts) {
-                    if (nevra.parse(rpm.c_str(), HY_FORM_NEVRA)) {
-                        bool found = false;
-                        for ( auto & demodularized : it->second) {
-                            if (nevra.getName() == demodularized) {
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (found) {
-                            continue;
-                        }
-                        auto arch = nevra.getArch();
-                        // source packages do not provide anything and must not cause excluding binary packages
-                        if (arch == "src" || arch == "nosrc") {
-                            srcNames.push_back(nevra.getName());
-                        } else {
-                            names.push_back(nevra.getName());
-                            nameDependencies.addReldep(nevra.getName().c_str());
-                        }
-                    }
+            }
+            continue;
+        }
+        std::string packageID{module->getNameStream()};
+        packageID.append(".");
+        packageID.append(module->getArch());
+        demodularizedIds.clear();
+        auto it = demodularizedNames.find(packageID);
+        if (it != demodularizedNames.end()) {
+            for (const auto & demodularized : it->second) {
+                if (Id id = pool_str2id(pool, demodularized.c_str(), 0)) {
+                    demodularizedIds.insert(id);
                 }
             }
-            copy(std::begin(artifacts), std::end(artifacts), std::back_inserter(includeNEVRAs));
-        } else {
-            copy(std::begin(artifacts), std::end(artifacts), std::back_inserter(excludeNEVRAs));
+        }
+        for (const auto & nevra : artifacts) {
+            if (nevra.name && nevra.evr && nevra.arch) {
+                ret.includeNEVRAs.insert(nevra);
+            }
+            // a name unknown to the pool can match neither a package name nor a provide
+            if (!nevra.name || demodularizedIds.count(nevra.name)) {
+                continue;
+            }
+            // source packages do not provide anything and must not cause excluding binary packages
+            if (nevra.arch == ARCH_SRC || nevra.arch == ARCH_NOSRC) {
+                ret.srcNames.insert(nevra.name);
+            } else if (ret.names.insert(nevra.name).second) {
+                ret.nameDependencies.addReldep(pool_id2str(pool, nevra.name));
+            }
         }
     }
-
-    return std::make_tuple(std::move(includeNEVRAs), std::move(excludeNEVRAs), std::move(names), std::move(srcNames),
-                           std::move(nameDependencies));
+    return ret;
 }
 
 void
 setModuleExcludes(DnfSack * sack, const char ** hotfixRepos, libdnf::ModulePackageContainer & modulePackageContainer)
 {
-    dnf_sack_set_module_excludes(sack, nullptr);
-
-    auto data = collectNevraForInclusionExclusion(sack, modulePackageContainer);
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
 
-    auto & includeNEVRAs = std::get<0>(data);
-    auto & excludeNEVRAs = std::get<1>(data);
-    auto & names = std::get<2>(data);
-    auto & srcNames = std::get<3>(data);
-    auto & nameDependencies = std::get<4>(data);
+    // Module excludes depend only on the active modules, the hotfix repos and the sack content. When none
+    // of them changed since the last pass (e.g. a stream change did not alter the solve result) the
+    // excludes set then are still valid.
+    std::unique_ptr<ModuleExcludesState> state(new ModuleExcludesState{&modulePackageContainer, {}, {}, 0});
+    for (auto module : modulePackageContainer.getModulePackages()) {
+        if (modulePackageContainer.isModuleActive(module->getId())) {
+            state->activeModules.push_back(module->getId());
+        }
+    }
+    for (auto repo = hotfixRepos; repo && *repo; ++repo) {
+        state->hotfixRepos.emplace_back(*repo);
+    }
+    auto last = priv->module_excludes_state;
+    if (last && last->container == state->container && last->generation == priv->generation &&
+        last->activeModules == state->activeModules && last->hotfixRepos == state->hotfixRepos) {
+        return;
+    }
 
-    std::vector<const char *> namesCString(names.size() + 1);
-    std::vector<const char *> srcNamesCString(srcNames.size() + 1);
-    std::vector<const char *> excludeNEVRAsCString(excludeNEVRAs.size() + 1);
-    std::vector<const char *> includeNEVRAsCString(includeNEVRAs.size() + 1);
+    dnf_sack_set_module_excludes(sack, nullptr);
 
-    transform(names.begin(), names.end(), namesCString.begin(), std::mem_fn(&std::string::c_str));
-    transform(srcNames.begin(), srcNames.end(), srcNamesCString.begin(), std::mem_fn(&std::string::c_str));
-    transform(excludeNEVRAs.begin(), excludeNEVRAs.end(), excludeNEVRAsCString.begin(),
-              std::mem_fn(&std::string::c_str));
-    transform(includeNEVRAs.begin(), includeNEVRAs.end(), includeNEVRAsCString.begin(),
-              std::mem_fn(&std::string::c_str));
+    auto data = collectNevraForInclusionExclusion(sack, modulePackageContainer);
+    Pool * pool = dnf_sack_get_pool(sack);
 
     libdnf::Query keepPackages{sack};
     const char *keepRepo[] = {HY_CMDLINE_REPO_NAME, HY_SYSTEM_REPO_NAME, nullptr};
@@ -2504,35 +6467,68 @@ setModuleExcludes(DnfSack * sack, const char ** hotfixRepos, libdnf::ModulePacka
     if (hotfixRepos != nullptr) {
         keepPackages.addFilter(HY_PKG_REPONAME, HY_NEQ, hotfixRepos);
     }
+    libdnf::Query allPackages{sack};
+    auto allSet = allPackages.runSet();
+    auto keepSet = keepPackages.runSet();
+
+    // Artifacts are matched through the sack name index, so only packages sharing a name are visited
+    libdnf::PackageSet includes(sack);
+    for (const auto & nevra : data.includeNEVRAs) {
+        auto range = dnf_sack_solvables_with_name(sack, nevra.name);
+        for (auto id = range.first; id != range.second; ++id) {
+            Solvable * s = pool_id2solvable(pool, *id);
+            if (s->evr == nevra.evr && s->arch == nevra.arch && allSet->has(*id)) {
+                includes.set(*id);
+            }
+        }
+    }
 
-    libdnf::Query includeQuery{sack};
-    libdnf::Query excludeQuery{keepPackages};
-    libdnf::Query excludeProvidesQuery{keepPackages};
-    libdnf::Query excludeNamesQuery(keepPackages);
-    libdnf::Query excludeSrcNamesQuery(keepPackages);
-    includeQuery.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, includeNEVRAsCString.data());
+    libdnf::PackageSet excludes(sack);
+    for (const auto & nevra : data.excludeNEVRAs) {
+        auto range = dnf_sack_solvables_with_name(sack, nevra.name);
+        for (auto id = range.first; id != range.second; ++id) {
+            Solvable * s = pool_id2solvable(pool, *id);
+            if (s->evr == nevra.evr && s->arch == nevra.arch && keepSet->has(*id) && !includes.has(*id)) {
+                excludes.set(*id);
+            }
+        }
+    }
 
-    excludeQuery.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, excludeNEVRAsCString.data());
-    excludeQuery.queryDifference(includeQuery);
+    // Required to filtrate out source packages and packages with incompatible architectures;
+    // source packages are excluded only by names of source artifacts
+    libdnf::PackageSet excludeNames(sack);
+    for (auto name : data.names) {
+        auto range = dnf_sack_solvables_with_name(sack, name);
+        for (auto id = range.first; id != range.second; ++id) {
+            if (keepSet->has(*id) && !includes.has(*id)) {
+                excludeNames.set(*id);
+            }
+        }
+    }
+    for (auto name : data.srcNames) {
+        auto range = dnf_sack_solvables_with_name(sack, name);
+        for (auto id = range.first; id != range.second; ++id) {
+            Solvable * s = pool_id2solvable(pool, *id);
+            if ((s->arch == ARCH_SRC || s->arch == ARCH_NOSRC) && keepSet->has(*id) && !includes.has(*id)) {
+                excludeNames.set(*id);
+            }
+        }
+    }
 
     // Exclude packages by their Provides
-    excludeProvidesQuery.addFilter(HY_PKG_PROVIDES, &nameDependencies);
-    excludeProvidesQuery.queryDifference(includeQuery);
-
-    // Search for source packages with same names as included source artifacts
-    excludeSrcNamesQuery.addFilter(HY_PKG_NAME, HY_EQ, srcNamesCString.data());
-    const char * srcArchs[] = {"src", "nosrc", nullptr};
-    excludeSrcNamesQuery.addFilter(HY_PKG_ARCH, HY_EQ, srcArchs);
-
-    // Required to filtrate out source packages and packages with incompatible architectures
-    excludeNamesQuery.addFilter(HY_PKG_NAME, HY_EQ, namesCString.data());
-    excludeNamesQuery.queryUnion(excludeSrcNamesQuery);
-    excludeNamesQuery.queryDifference(includeQuery);
-
-    dnf_sack_set_module_excludes(sack, excludeQuery.getResultPset());
-    dnf_sack_add_module_excludes(sack, excludeProvidesQuery.getResultPset());
-    dnf_sack_add_module_excludes(sack, excludeNamesQuery.getResultPset());
-    dnf_sack_set_module_includes(sack, includeQuery.getResultPset());
+    libdnf::Query excludeProvidesQuery{keepPackages};
+    excludeProvidesQuery.addFilter(HY_PKG_PROVIDES, &data.nameDependencies);
+    libdnf::PackageSet excludeProvides(*excludeProvidesQuery.runSet());
+    excludeProvides -= includes;
+
+    dnf_sack_set_module_excludes(sack, &excludes);
+    dnf_sack_add_module_excludes(sack, &excludeProvides);
+    dnf_sack_add_module_excludes(sack, &excludeNames);
+    dnf_sack_set_module_includes(sack, &includes);
+
+    state->generation = priv->generation;
+    delete priv->module_excludes_state;
+    priv->module_excludes_state = state.release();
 }
 
 }
@@ -2575,11 +6571,17 @@ std::pair<std::vector<std::vector<std::string>>, libdnf::ModulePackageContainer:
     DnfSack * sack, DnfModulePackageContainer * moduleContainer, const char ** hotfixRepos,
     const char * install_root, const char * platformModule, bool updateOnly, bool debugSolver, bool applyObsoletes)
 {
+    libdnf::PhaseTimer timer("dnf_sack_filter_modules_v2");
     if (!updateOnly) {
         if (!install_root) {
             throw std::runtime_error("Installroot not provided");
         }
         DnfSackPrivate *priv = GET_PRIVATE(sack);
+        // module metadata is reloaded, ids of the previous pass do not have to match the new modules
+        delete priv->module_excludes_state;
+        priv->module_excludes_state = NULL;
+        delete priv->module_artifact_ids;
+        priv->module_artifact_ids = NULL;
         if (!moduleContainer) {
             if (priv->moduleContainer) {
                 delete priv->moduleContainer;
@@ -54,12 +54,14 @@ struct _DnfSackClass
  * DnfSackSetupFlags:
  * @DNF_SACK_SETUP_FLAG_NONE:                   No flags set
  * @DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR:         Create the cache dir if required
+ * @DNF_SACK_SETUP_FLAG_HUGE_PAGES:             Back the big arrays of the pool by transparent huge pages
  *
  * Flags to use when setting up the sack.
  **/
 typedef enum {
     DNF_SACK_SETUP_FLAG_NONE                = 0,
     DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR      = 1 << 0,
+    DNF_SACK_SETUP_FLAG_HUGE_PAGES          = 1 << 1,
     /*< private >*/
     DNF_SACK_SETUP_FLAG_LAST
 } DnfSackSetupFlags;
@@ -72,6 +74,10 @@ typedef enum {
  * @DNF_SACK_LOAD_FLAG_USE_PRESTO:              Use presto deltas metadata
  * @DNF_SACK_LOAD_FLAG_USE_UPDATEINFO:          Use updateinfo metadata
  * @DNF_SACK_LOAD_FLAG_USE_OTHER:               Use other metadata
+ * @DNF_SACK_LOAD_FLAG_USE_MMAP:                Read the main solv cache through a shared memory mapping
+ * @DNF_SACK_LOAD_FLAG_SLIM_UPDATEINFO:         Keep advisory descriptions out of the pool, load them on demand
+ * @DNF_SACK_LOAD_FLAG_LAZY_FILELISTS:          Use filelists metadata, load it on the first access needing it
+ * @DNF_SACK_LOAD_FLAG_BACKGROUND_CACHE:        Write the solv cache on a background thread, the parsed data is kept in memory
  *
  * Flags to use when loading from the sack.
  **/
@@ -82,6 +88,10 @@ typedef enum {
     DNF_SACK_LOAD_FLAG_USE_PRESTO           = 1 << 2,
     DNF_SACK_LOAD_FLAG_USE_UPDATEINFO       = 1 << 3,
     DNF_SACK_LOAD_FLAG_USE_OTHER            = 1 << 4,
+    DNF_SACK_LOAD_FLAG_USE_MMAP             = 1 << 5,
+    DNF_SACK_LOAD_FLAG_SLIM_UPDATEINFO      = 1 << 6,
+    DNF_SACK_LOAD_FLAG_LAZY_FILELISTS       = 1 << 7,
+    DNF_SACK_LOAD_FLAG_BACKGROUND_CACHE     = 1 << 8,
     /*< private >*/
     DNF_SACK_LOAD_FLAG_LAST
 } DnfSackLoadFlags;
@@ -90,6 +100,9 @@ DnfSack     *dnf_sack_new                   (void);
 
 void         dnf_sack_set_cachedir          (DnfSack        *sack,
                                              const gchar    *value);
+void         dnf_sack_set_shared_cachedir   (DnfSack        *sack,
+                                             const gchar    *value);
+const gchar *dnf_sack_get_shared_cachedir   (DnfSack        *sack);
 gboolean     dnf_sack_set_arch              (DnfSack        *sack,
                                              const gchar    *value,
                                              GError        **error);
@@ -99,6 +112,17 @@ gboolean     dnf_sack_get_all_arch          (DnfSack        *sack);
 void         dnf_sack_set_allow_vendor_change(DnfSack       *sack,
                                              gboolean       allow_vendor_change);
 gboolean     dnf_sack_get_allow_vendor_change(DnfSack       *sack);
+void         dnf_sack_set_use_query_cache   (DnfSack        *sack,
+                                             gboolean        enabled);
+gboolean     dnf_sack_get_use_query_cache   (DnfSack        *sack);
+void         dnf_sack_set_use_package_cache (DnfSack        *sack,
+                                             gboolean        enabled);
+gboolean     dnf_sack_get_use_package_cache (DnfSack        *sack);
+void         dnf_sack_set_use_substring_index(DnfSack       *sack,
+                                             gboolean       enabled);
+gboolean     dnf_sack_get_use_substring_index(DnfSack       *sack);
+void         dnf_sack_freeze                (DnfSack        *sack);
+gboolean     dnf_sack_is_frozen             (DnfSack        *sack);
 void         dnf_sack_set_rootdir           (DnfSack        *sack,
                                              const gchar    *value);
 gboolean     dnf_sack_setup                 (DnfSack        *sack,
@@ -118,11 +142,22 @@ void         dnf_sack_set_installonly       (DnfSack        *sack,
 void         dnf_sack_set_installonly_limit (DnfSack        *sack,
                                              guint           limit);
 guint        dnf_sack_get_installonly_limit (DnfSack        *sack);
+gchar       *dnf_sack_get_rpmdb_version     (DnfSack        *sack);
+void         dnf_sack_set_repomd_stat_max_age(DnfSack       *sack,
+                                             guint          max_age);
+guint        dnf_sack_get_repomd_stat_max_age(DnfSack       *sack);
 DnfPackage  *dnf_sack_add_cmdline_package   (DnfSack        *sack,
                                              const char     *fn);
 DnfPackage  *dnf_sack_add_cmdline_package_nochecksum(DnfSack *sack,
                                              const char     *fn);
+GPtrArray   *dnf_sack_add_cmdline_packages  (DnfSack        *sack,
+                                             const gchar *const *fns);
 int          dnf_sack_count                 (DnfSack        *sack);
+gchar      **dnf_sack_get_package_ids       (DnfSack        *sack,
+                                             DnfPackageSet  *pset,
+                                             GHashTable     *origins);
+DnfPackage  *dnf_sack_get_package_by_package_id(DnfSack     *sack,
+                                             const gchar    *package_id);
 void         dnf_sack_add_excludes          (DnfSack        *sack,
                                              const DnfPackageSet *pset);
 void         dnf_sack_add_module_excludes   (DnfSack        *sack,
@@ -167,11 +202,73 @@ gboolean     dnf_sack_load_repo             (DnfSack        *sack,
                                              HyRepo          hrepo,
                                              int             flags,
                                              GError        **error);
+gboolean     dnf_sack_write_solv_snapshot   (DnfSack        *sack,
+                                             HyRepo          repo,
+                                             const gchar    *path,
+                                             GError        **error);
+gboolean     dnf_sack_unload_repo_exts      (DnfSack        *sack,
+                                             HyRepo          repo,
+                                             int             flags,
+                                             GError        **error);
+gboolean     dnf_sack_reload_system_repo    (DnfSack        *sack,
+                                             int             flags,
+                                             GError        **error);
 Pool        *dnf_sack_get_pool              (DnfSack    *sack);
 
 void dnf_sack_filter_modules(DnfSack *sack, GPtrArray *repos, const char *install_root,
     const char * platformModule);
 
+/**
+ * DnfSackRepoMemoryStats:
+ * @name:       name of the repo
+ * @main:       bytes of the repodata of the primary metadata and the solvable dependencies
+ * @filelists:  bytes of the filelists extension
+ * @other:      bytes of the other (changelogs) extension
+ * @updateinfo: bytes of the updateinfo extension
+ * @presto:     bytes of the presto deltas extension
+ *
+ * Memory used by one repo of the sack.
+ **/
+typedef struct {
+    gchar       *name;
+    guint64      main;
+    guint64      filelists;
+    guint64      other;
+    guint64      updateinfo;
+    guint64      presto;
+} DnfSackRepoMemoryStats;
+
+/**
+ * DnfSackMemoryStats:
+ * @string_space:   bytes of the pool string space and its hash table
+ * @reldeps:        bytes of the reldep table
+ * @whatprovides:   bytes of the whatprovides index, 0 until the provides are ready
+ * @solvables:      bytes of the solvables
+ * @maps:           bytes of the considered, exclude and include maps
+ * @indexes:        bytes of the indexes and caches the sack keeps for queries
+ * @module_sack:    bytes of all the above in the sack of the module metadata
+ * @repos:          (element-type DnfSackRepoMemoryStats): the repos in the pool order
+ *
+ * Memory used by a sack, as allocated by libsolv and libdnf. Allocator overhead
+ * and the memory of the packages and queries held by the caller are not included.
+ **/
+typedef struct {
+    guint64      string_space;
+    guint64      reldeps;
+    guint64      whatprovides;
+    guint64      solvables;
+    guint64      maps;
+    guint64      indexes;
+    guint64      module_sack;
+    GPtrArray   *repos;
+} DnfSackMemoryStats;
+
+DnfSackMemoryStats *dnf_sack_get_memory_stats   (DnfSack            *sack);
+guint64      dnf_sack_memory_stats_get_total(const DnfSackMemoryStats *stats);
+void         dnf_sack_memory_stats_free     (DnfSackMemoryStats *stats);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(DnfSackMemoryStats, dnf_sack_memory_stats_free)
+
 
 /**********************************************************************/
 
@@ -183,6 +280,7 @@ void dnf_sack_filter_modules(DnfSack *sack, GPtrArray *repos, const char *instal
  * @DNF_SACK_ADD_FLAG_REMOTE:                   Use remote repos
  * @DNF_SACK_ADD_FLAG_UNAVAILABLE:              Add repos that are unavailable
  * @DNF_SACK_ADD_FLAG_OTHER:                    Add the other
+ * @DNF_SACK_ADD_FLAG_PARALLEL:                 Build missing solv caches of all repos in parallel
  *
  * Flags to control repo loading into the sack.
  **/
@@ -193,6 +291,7 @@ typedef enum {
         DNF_SACK_ADD_FLAG_REMOTE                = 1 << 2,
         DNF_SACK_ADD_FLAG_UNAVAILABLE           = 1 << 3,
         DNF_SACK_ADD_FLAG_OTHER                 = 1 << 4,
+        DNF_SACK_ADD_FLAG_PARALLEL              = 1 << 5,
         /*< private >*/
         DNF_SACK_ADD_FLAG_LAST
 } DnfSackAddFlags;
@@ -209,6 +308,10 @@ gboolean         dnf_sack_add_repos           (DnfSack        *sack,
                                                  DnfSackAddFlags flags,
                                                  DnfState       *state,
                                                  GError         **error);
+gboolean         dnf_sack_reload_repo         (DnfSack        *sack,
+                                                 DnfRepo      *repo,
+                                                 DnfSackAddFlags flags,
+                                                 GError         **error);
 
 G_END_DECLS
 
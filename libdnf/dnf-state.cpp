@@ -81,12 +81,26 @@
  */
 
 
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
 #include "catch-error.hpp"
 #include "dnf-state.h"
 #include "dnf-utils.h"
 
 #include "utils/bgettext/bgettext-lib.h"
 
+/* a Chrome trace-event file shared by a tree of states */
+typedef struct
+{
+    FILE            *fp;
+    GMutex           mutex;
+    gint             refcount;
+    gboolean         empty;
+    gint             pid;
+} DnfStateTrace;
+
 typedef struct
 {
     gboolean         allow_cancel;
@@ -103,6 +117,11 @@ typedef struct
     guint64          *speed_data;
     guint             current;
     guint             last_percentage;
+    guint             max_update_rate;
+    gint64            last_emit_time;
+    DnfStateTrace    *trace;
+    gint64            step_start_time;
+    gint64            action_start_time;
     guint            *step_data;
     guint             steps;
     gulong            action_child_id;
@@ -141,6 +160,111 @@ G_DEFINE_TYPE_WITH_PRIVATE(DnfState, dnf_state, G_TYPE_OBJECT)
 
 #define DNF_STATE_SPEED_SMOOTHING_ITEMS        5
 
+static DnfStateTrace *
+dnf_state_trace_ref(DnfStateTrace *trace)
+{
+    if (trace != NULL)
+        g_atomic_int_inc(&trace->refcount);
+    return trace;
+}
+
+static void
+dnf_state_trace_unref(DnfStateTrace *trace)
+{
+    if (trace == NULL || !g_atomic_int_dec_and_test(&trace->refcount))
+        return;
+    fputs("\n]\n", trace->fp);
+    fclose(trace->fp);
+    g_mutex_clear(&trace->mutex);
+    g_free(trace);
+}
+
+static void
+dnf_state_trace_append_string(GString *str, const gchar *value)
+{
+    g_string_append_c(str, '"');
+    for (const gchar *c = value != NULL ? value : ""; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\')
+            g_string_append_c(str, '\\');
+        if ((guchar) *c < 0x20)
+            g_string_append_printf(str, "\\u%04x", (guint) *c);
+        else
+            g_string_append_c(str, *c);
+    }
+    g_string_append_c(str, '"');
+}
+
+/* writes one complete ("X") event, @args is a JSON object or %NULL */
+static void
+dnf_state_trace_complete(DnfStateTrace *trace, const gchar *cat, const gchar *name,
+                         gint64 start, gint64 end, const gchar *args)
+{
+    g_autoptr(GString) event = g_string_new(NULL);
+    g_string_append(event, "{\"name\":");
+    dnf_state_trace_append_string(event, name);
+    g_string_append_printf(event,
+                           ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT
+                           ",\"dur\":%" G_GINT64_FORMAT ",\"pid\":%i,\"tid\":%i",
+                           cat, start, end - start, trace->pid, trace->pid);
+    if (args != NULL)
+        g_string_append_printf(event, ",\"args\":%s", args);
+    g_string_append_c(event, '}');
+
+    g_mutex_lock(&trace->mutex);
+    fputs(trace->empty ? "\n" : ",\n", trace->fp);
+    fputs(event->str, trace->fp);
+    trace->empty = FALSE;
+    g_mutex_unlock(&trace->mutex);
+}
+
+static const gchar *
+dnf_state_action_to_string(DnfStateAction action)
+{
+    switch (action) {
+    case DNF_STATE_ACTION_DOWNLOAD_PACKAGES:
+        return "download-packages";
+    case DNF_STATE_ACTION_DOWNLOAD_METADATA:
+        return "download-metadata";
+    case DNF_STATE_ACTION_LOADING_CACHE:
+        return "loading-cache";
+    case DNF_STATE_ACTION_TEST_COMMIT:
+        return "test-commit";
+    case DNF_STATE_ACTION_REQUEST:
+        return "request";
+    case DNF_STATE_ACTION_REMOVE:
+        return "remove";
+    case DNF_STATE_ACTION_INSTALL:
+        return "install";
+    case DNF_STATE_ACTION_UPDATE:
+        return "update";
+    case DNF_STATE_ACTION_CLEANUP:
+        return "cleanup";
+    case DNF_STATE_ACTION_OBSOLETE:
+        return "obsolete";
+    case DNF_STATE_ACTION_REINSTALL:
+        return "reinstall";
+    case DNF_STATE_ACTION_DOWNGRADE:
+        return "downgrade";
+    case DNF_STATE_ACTION_QUERY:
+        return "query";
+    default:
+        return "unknown";
+    }
+}
+
+/* closes the span of the action that is current until now */
+static void
+dnf_state_trace_action_end(DnfStatePrivate *priv)
+{
+    if (priv->trace == NULL || priv->action == DNF_STATE_ACTION_UNKNOWN)
+        return;
+    g_autoptr(GString) args = g_string_new("{\"hint\":");
+    dnf_state_trace_append_string(args, priv->action_hint);
+    g_string_append_c(args, '}');
+    dnf_state_trace_complete(priv->trace, "action", dnf_state_action_to_string(priv->action),
+                             priv->action_start_time, g_get_monotonic_time(), args->str);
+}
+
 /**
  * dnf_state_finalize:
  **/
@@ -164,6 +288,7 @@ dnf_state_finalize(GObject *object)
     g_free(priv->speed_data);
     g_ptr_array_unref(priv->lock_ids);
     g_object_unref(priv->lock);
+    dnf_state_trace_unref(priv->trace);
 
     G_OBJECT_CLASS(dnf_state_parent_class)->finalize(object);
 }
@@ -300,6 +425,39 @@ dnf_state_set_report_progress(DnfState *state, gboolean report_progress)
     priv->report_progress = report_progress;
 }
 
+/**
+ * dnf_state_set_max_update_rate:
+ * @state: A #DnfState
+ * @max_update_rate: the most percentage updates per second, or 0 for no limit
+ *
+ * Coalesces the percentage and package progress updates of @state and of
+ * the children created from it afterwards. Only the latest value within
+ * each interval is reported, and 100% always is. This is useful for
+ * callers that redraw on every signal or do not listen at all.
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_state_set_max_update_rate(DnfState *state, guint max_update_rate)
+{
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+    priv->max_update_rate = max_update_rate;
+}
+
+/* whether an update within the rate limit may be emitted now */
+static gboolean
+dnf_state_update_due(DnfStatePrivate *priv)
+{
+    if (priv->max_update_rate == 0)
+        return TRUE;
+    gint64 now = g_get_monotonic_time();
+    if (priv->last_emit_time != 0 &&
+        now - priv->last_emit_time < G_USEC_PER_SEC / priv->max_update_rate)
+        return FALSE;
+    priv->last_emit_time = now;
+    return TRUE;
+}
+
 /**
  * dnf_state_set_enable_profile:
  * @state: A #DnfState
@@ -317,6 +475,53 @@ dnf_state_set_enable_profile(DnfState *state, gboolean enable_profile)
     priv->enable_profile = enable_profile;
 }
 
+/**
+ * dnf_state_set_trace_file:
+ * @state: A #DnfState
+ * @filename: the file to write, or %NULL to stop tracing
+ * @error: A #GError or %NULL
+ *
+ * Records the steps and actions of @state and of the children created
+ * from it afterwards into @filename, as Chrome trace-event JSON that
+ * chrome://tracing and Perfetto can load. Every dnf_state_done() becomes
+ * a span named after its code location, every action a span named after
+ * the action. The timestamps are monotonic microseconds. The file is
+ * completed when the last state using it is finalized.
+ *
+ * Returns: %TRUE for success, %FALSE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_state_set_trace_file(DnfState *state, const gchar *filename, GError **error)
+{
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+    DnfStateTrace *trace = NULL;
+    FILE *fp;
+
+    if (filename != NULL) {
+        fp = fopen(filename, "w");
+        if (fp == NULL) {
+            g_set_error(error, DNF_ERROR, DNF_ERROR_FILE_INVALID,
+                        _("Failed to open trace file %1$s: %2$s"),
+                        filename, g_strerror(errno));
+            return FALSE;
+        }
+        fputc('[', fp);
+        trace = g_new0(DnfStateTrace, 1);
+        trace->fp = fp;
+        g_mutex_init(&trace->mutex);
+        trace->refcount = 1;
+        trace->empty = TRUE;
+        trace->pid = getpid();
+    }
+    dnf_state_trace_unref(priv->trace);
+    priv->trace = trace;
+    priv->step_start_time = g_get_monotonic_time();
+    priv->action_start_time = priv->step_start_time;
+    return TRUE;
+}
+
 /**
  * dnf_state_take_lock:
  * @state: A #DnfState
@@ -338,16 +543,45 @@ gboolean
 dnf_state_take_lock(DnfState *state,
                     DnfLockType lock_type,
                     DnfLockMode lock_mode,
-                    GError **error) try
+                    GError **error)
+{
+    return dnf_state_take_lock_full(state, lock_type, lock_mode,
+                                    DNF_LOCK_ACCESS_EXCLUSIVE, NULL, error);
+}
+
+/**
+ * dnf_state_take_lock_full:
+ * @state: A #DnfState
+ * @lock_type: A #DnfLockType, e.g. %DNF_LOCK_TYPE_METADATA
+ * @lock_mode: A #DnfLockMode, e.g. %DNF_LOCK_MODE_PROCESS
+ * @lock_access: A #DnfLockAccess, e.g. %DNF_LOCK_ACCESS_SHARED
+ * @lock_name: (nullable): the part of @lock_type to lock, e.g. a repo ID
+ * @error: A #GError
+ *
+ * Takes a lock like dnf_state_take_lock() does, see dnf_lock_take_full().
+ *
+ * Returns: %FALSE if the lock is fatal, %TRUE otherwise
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_state_take_lock_full(DnfState *state,
+                         DnfLockType lock_type,
+                         DnfLockMode lock_mode,
+                         DnfLockAccess lock_access,
+                         const gchar *lock_name,
+                         GError **error) try
 {
     DnfStatePrivate *priv = GET_PRIVATE(state);
     guint lock_id = 0;
 
     /* no custom handler */
-    lock_id = dnf_lock_take(priv->lock,
-                            lock_type,
-                            lock_mode,
-                            error);
+    lock_id = dnf_lock_take_full(priv->lock,
+                                 lock_type,
+                                 lock_mode,
+                                 lock_access,
+                                 lock_name,
+                                 error);
     if (lock_id == 0)
         return FALSE;
 
@@ -630,7 +864,11 @@ dnf_state_set_percentage(DnfState *state, guint percentage)
     /* save */
     priv->last_percentage = percentage;
 
-    /* emit */
+    /* emit, unless nobody listens or the last update was too recent */
+    if (!g_signal_has_handler_pending(state, signals [SIGNAL_PERCENTAGE_CHANGED], 0, FALSE))
+        return TRUE;
+    if (percentage != 100 && !dnf_state_update_due(priv))
+        return TRUE;
     g_signal_emit(state, signals [SIGNAL_PERCENTAGE_CHANGED], 0, percentage);
 
     /* success */
@@ -691,6 +929,10 @@ dnf_state_action_start(DnfState *state, DnfStateAction action, const gchar *acti
 
     /* remember for stop */
     priv->last_action = priv->action;
+    if (priv->trace != NULL) {
+        dnf_state_trace_action_end(priv);
+        priv->action_start_time = g_get_monotonic_time();
+    }
 
     /* save hint */
     g_free(priv->action_hint);
@@ -721,11 +963,17 @@ dnf_state_set_package_progress(DnfState *state,
                 DnfStateAction action,
                 guint percentage)
 {
+    DnfStatePrivate *priv = GET_PRIVATE(state);
+
     g_return_if_fail(dnf_package_get_id != NULL);
     g_return_if_fail(action != DNF_STATE_ACTION_UNKNOWN);
     g_return_if_fail(percentage <= 100);
 
     /* just emit */
+    if (!g_signal_has_handler_pending(state, signals [SIGNAL_PACKAGE_PROGRESS_CHANGED], 0, FALSE))
+        return;
+    if (percentage != 0 && percentage != 100 && !dnf_state_update_due(priv))
+        return;
     g_signal_emit(state, signals [SIGNAL_PACKAGE_PROGRESS_CHANGED], 0,
                dnf_package_get_id, action, percentage);
 }
@@ -753,6 +1001,10 @@ dnf_state_action_stop(DnfState *state)
     }
 
     /* pop and reset */
+    if (priv->trace != NULL) {
+        dnf_state_trace_action_end(priv);
+        priv->action_start_time = g_get_monotonic_time();
+    }
     priv->action = priv->last_action;
     priv->last_action = DNF_STATE_ACTION_UNKNOWN;
     if (priv->action_hint != NULL) {
@@ -907,6 +1159,8 @@ dnf_state_child_package_progress_changed_cb(DnfState *child,
                          DnfState *state)
 {
     /* just emit */
+    if (!g_signal_has_handler_pending(state, signals [SIGNAL_PACKAGE_PROGRESS_CHANGED], 0, FALSE))
+        return;
     g_signal_emit(state, signals [SIGNAL_PACKAGE_PROGRESS_CHANGED], 0,
                   dnf_package_get_id, action, progress);
 }
@@ -1072,6 +1326,12 @@ dnf_state_get_child(DnfState *state)
 
     /* set the profile state */
     dnf_state_set_enable_profile(child, priv->enable_profile);
+    dnf_state_set_max_update_rate(child, priv->max_update_rate);
+    if (priv->trace != NULL) {
+        child_priv->trace = dnf_state_trace_ref(priv->trace);
+        child_priv->step_start_time = g_get_monotonic_time();
+        child_priv->action_start_time = child_priv->step_start_time;
+    }
     return child;
 }
 
@@ -1121,6 +1381,8 @@ dnf_state_set_number_steps_real(DnfState *state, guint steps, const gchar *strlo
     /* only use the timer if profiling; it's expensive */
     if (priv->enable_profile)
         g_timer_start(priv->timer);
+    if (priv->trace != NULL)
+        priv->step_start_time = g_get_monotonic_time();
 
     /* set steps */
     priv->steps = steps;
@@ -1376,6 +1638,17 @@ dnf_state_done_real(DnfState *state, GError **error, const gchar *strloc) try
     /* another */
     priv->current++;
 
+    /* the step started with the previous one or with setting the steps */
+    if (priv->trace != NULL) {
+        gint64 now = g_get_monotonic_time();
+        g_autoptr(GString) args = g_string_new("{\"id\":");
+        dnf_state_trace_append_string(args, priv->id);
+        g_string_append_printf(args, ",\"step\":%u,\"steps\":%u}", priv->current, priv->steps);
+        dnf_state_trace_complete(priv->trace, "step", strloc, priv->step_start_time, now,
+                                 args->str);
+        priv->step_start_time = now;
+    }
+
     /* find new percentage */
     if (priv->step_data == NULL) {
         percentage = dnf_state_discrete_to_percent(priv->current,
@@ -157,11 +157,22 @@ gboolean         dnf_state_finished_real                (DnfState
 gboolean         dnf_state_reset                        (DnfState               *state);
 void             dnf_state_set_enable_profile           (DnfState               *state,
                                                          gboolean                enable_profile);
+void             dnf_state_set_max_update_rate          (DnfState               *state,
+                                                         guint                   max_update_rate);
+gboolean         dnf_state_set_trace_file               (DnfState               *state,
+                                                         const gchar            *filename,
+                                                         GError                 **error);
 #ifndef __GI_SCANNER__
 gboolean         dnf_state_take_lock                    (DnfState               *state,
                                                          DnfLockType             lock_type,
                                                          DnfLockMode             lock_mode,
                                                          GError                 **error);
+gboolean         dnf_state_take_lock_full               (DnfState               *state,
+                                                         DnfLockType             lock_type,
+                                                         DnfLockMode             lock_mode,
+                                                         DnfLockAccess           lock_access,
+                                                         const gchar            *lock_name,
+                                                         GError                 **error);
 #endif
 gboolean         dnf_state_release_locks                (DnfState               *state);
 
@@ -32,6 +32,18 @@
 #include <rpm/rpmlib.h>
 #include <rpm/rpmlog.h>
 #include <rpm/rpmts.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "catch-error.hpp"
 #include "log.hpp"
@@ -40,14 +52,18 @@
 #include "dnf-goal.h"
 #include "dnf-keyring.h"
 #include "dnf-package.h"
+#include "dnf-repo.hpp"
 #include "dnf-rpmts-private.hpp"
 #include "dnf-sack.h"
 #include "dnf-sack-private.hpp"
 #include "dnf-transaction.h"
 #include "dnf-types.h"
 #include "dnf-utils.h"
+#include "hy-package-private.hpp"
 #include "hy-query.h"
 #include "hy-util-private.hpp"
+#include "goal/Goal.hpp"
+#include "sack/packageset.hpp"
 #include "plugin/plugin-private.hpp"
 
 #include "module/ModulePackageContainer.hpp"
@@ -63,6 +79,30 @@ typedef enum {
     DNF_TRANSACTION_STEP_IGNORE
 } DnfTransactionStep;
 
+/* hash lookups over one of the package arrays, for the rpm callbacks */
+struct DnfPackageIndex {
+    std::unordered_map<std::string, DnfPackage *> by_nevra;
+    std::unordered_map<std::string, DnfPackage *> by_name;
+    std::unordered_map<std::string, std::vector<DnfPackage *>> by_basename;
+    GPtrArray *packages; /* not owned */
+};
+
+/* a downloaded package checked and read ahead of dnf_transaction_commit() */
+typedef struct {
+    rpmKeyring keyring;
+    rpmVSFlags vsflags;
+    gchar *fn;
+    GError *error; /* of the signature check */
+    gint res;      /* of rpmReadPackageFile() */
+    Header hdr;
+} PipelineJob;
+
+/* downloaded packages deleted after dnf_transaction_commit(), by directory */
+typedef struct {
+    std::map<std::string, std::vector<std::string>> files;
+    GError *error;
+} CleanupJob;
+
 typedef struct {
     rpmKeyring keyring;
     rpmts ts;
@@ -80,7 +120,15 @@ typedef struct {
     GPtrArray *remove;
     GPtrArray *remove_helper;
     GPtrArray *install;
+    DnfPackageIndex *remove_index;
+    DnfPackageIndex *remove_helper_index;
+    DnfPackageIndex *install_index;
     GPtrArray *pkgs_to_download;
+    GPtrArray *pkgs_to_install;
+    libdnf::PackageSet *pkgs_to_erase;
+    GThreadPool *pipeline_pool;
+    std::unordered_map<std::string, PipelineJob *> *pipeline_jobs;
+    GThread *cleanup_thread;
     GHashTable *erased_by_package_hash;
     guint64 flags;
     gboolean dont_solve_goal;
@@ -107,6 +155,61 @@ struct PluginHookContextTransactionData : public libdnf::PluginHookData {
     DnfState * state;
 };
 
+static void
+dnf_transaction_pipeline_cb(gpointer data, gpointer user_data)
+{
+    auto job = static_cast<PipelineJob *>(data);
+    dnf_keyring_check_untrusted_file(job->keyring, job->fn, &job->error);
+
+    /* the header is read the way dnf_rpmts_add_install_filename2() would */
+    rpmts ts = rpmtsCreate();
+    rpmtsSetKeyring(ts, job->keyring);
+    rpmtsSetVSFlags(ts, job->vsflags);
+    FD_t fd = Fopen(job->fn, "r.ufdio");
+    job->res = rpmReadPackageFile(ts, fd, job->fn, &job->hdr);
+    Fclose(fd);
+    rpmtsFree(ts);
+}
+
+/* waits for the checks still running */
+static void
+dnf_transaction_pipeline_wait(DnfTransactionPrivate *priv)
+{
+    if (priv->pipeline_pool == NULL)
+        return;
+    g_thread_pool_free(priv->pipeline_pool, FALSE, TRUE);
+    priv->pipeline_pool = NULL;
+}
+
+static void
+dnf_transaction_pipeline_clear(DnfTransactionPrivate *priv)
+{
+    dnf_transaction_pipeline_wait(priv);
+    if (priv->pipeline_jobs == NULL)
+        return;
+    for (auto & item : *priv->pipeline_jobs) {
+        auto job = item.second;
+        g_clear_error(&job->error);
+        if (job->hdr != NULL)
+            headerFree(job->hdr);
+        g_free(job->fn);
+        delete job;
+    }
+    delete priv->pipeline_jobs;
+    priv->pipeline_jobs = NULL;
+}
+
+/* finds the finished job for @fn, if the file was pipelined */
+static PipelineJob *
+dnf_transaction_pipeline_lookup(DnfTransactionPrivate *priv, const gchar *fn)
+{
+    if (priv->pipeline_jobs == NULL || fn == NULL)
+        return NULL;
+    dnf_transaction_pipeline_wait(priv);
+    auto it = priv->pipeline_jobs->find(fn);
+    return it == priv->pipeline_jobs->end() ? NULL : it->second;
+}
+
 /**
  * dnf_transaction_finalize:
  **/
@@ -116,7 +219,13 @@ dnf_transaction_finalize(GObject *object)
     DnfTransaction *transaction = DNF_TRANSACTION(object);
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
 
+    dnf_transaction_pipeline_clear(priv);
+    g_autoptr(GError) error_cleanup = NULL;
+    if (!dnf_transaction_wait_cleanup(transaction, &error_cleanup))
+        g_warning("%s", error_cleanup->message);
     g_ptr_array_unref(priv->pkgs_to_download);
+    g_ptr_array_unref(priv->pkgs_to_install);
+    delete priv->pkgs_to_erase;
     g_timer_destroy(priv->timer);
     rpmKeyringFree(priv->keyring);
     rpmtsFree(priv->ts);
@@ -131,6 +240,9 @@ dnf_transaction_finalize(GObject *object)
         g_ptr_array_unref(priv->remove);
     if (priv->remove_helper != NULL)
         g_ptr_array_unref(priv->remove_helper);
+    delete priv->install_index;
+    delete priv->remove_index;
+    delete priv->remove_helper_index;
     if (priv->erased_by_package_hash != NULL)
         g_hash_table_unref(priv->erased_by_package_hash);
     if (priv->context != NULL)
@@ -148,6 +260,7 @@ dnf_transaction_init(DnfTransaction *transaction)
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
     priv->timer = g_timer_new();
     priv->pkgs_to_download = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+    priv->pkgs_to_install = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 }
 
 /**
@@ -356,18 +469,16 @@ dnf_transaction_ensure_repo_list(DnfTransaction *transaction, GPtrArray *pkglist
     return TRUE;
 } CATCH_TO_GERROR(FALSE)
 
-gboolean
-dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, GError **error) try
+/* finds the downloaded file of the package to check */
+static const gchar *
+dnf_transaction_gpgcheck_prepare(DnfTransaction *transaction, DnfPackage *pkg, GError **error)
 {
-    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
-    GError *error_local = NULL;
-    DnfRepo *repo;
     const gchar *fn;
 
     /* ensure the filename is set */
     if (!dnf_transaction_ensure_repo(transaction, pkg, error)) {
         g_prefix_error(error, _("Failed to check untrusted: "));
-        return FALSE;
+        return NULL;
     }
 
     /* find the location of the local file */
@@ -378,45 +489,83 @@ dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, G
                     DNF_ERROR_FILE_NOT_FOUND,
                     _("Downloaded file for %s not found"),
                     dnf_package_get_name(pkg));
-        return FALSE;
+        return NULL;
     }
+    return fn;
+}
 
-    /* check file */
-    if (!dnf_keyring_check_untrusted_file(priv->keyring, fn, &error_local)) {
+/* decides about the result of dnf_keyring_check_untrusted_file(), takes @error_local */
+static gboolean
+dnf_transaction_gpgcheck_result(DnfTransaction *transaction,
+                                DnfPackage *pkg,
+                                GError *error_local,
+                                GError **error)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DnfRepo *repo;
 
-        /* probably an i/o error */
-        if (!g_error_matches(error_local, DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID)) {
-            g_propagate_error(error, error_local);
-            return FALSE;
-        }
+    if (error_local == NULL)
+        return TRUE;
 
-        /* if the repo is signed this is ALWAYS an error */
-        repo = dnf_package_get_repo(pkg);
-        if (repo != NULL && dnf_repo_get_gpgcheck(repo)) {
-            g_set_error(error,
-                        DNF_ERROR,
-                        DNF_ERROR_FILE_INVALID,
-                        _("package %1$s cannot be verified "
-                          "and repo %2$s is GPG enabled: %3$s"),
-                        dnf_package_get_nevra(pkg),
-                        dnf_repo_get_id(repo),
-                        error_local->message);
-            g_error_free(error_local);
-            return FALSE;
-        }
+    /* probably an i/o error */
+    if (!g_error_matches(error_local, DNF_ERROR, DNF_ERROR_GPG_SIGNATURE_INVALID)) {
+        g_propagate_error(error, error_local);
+        return FALSE;
+    }
 
-        /* we can only install signed packages in this mode */
-        if ((priv->flags & DNF_TRANSACTION_FLAG_ONLY_TRUSTED) > 0) {
-            g_propagate_error(error, error_local);
-            return FALSE;
-        } else {
-            g_clear_error(&error_local);
-        }
+    /* if the repo is signed this is ALWAYS an error */
+    repo = dnf_package_get_repo(pkg);
+    if (repo != NULL && dnf_repo_get_gpgcheck(repo)) {
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_FILE_INVALID,
+                    _("package %1$s cannot be verified "
+                      "and repo %2$s is GPG enabled: %3$s"),
+                    dnf_package_get_nevra(pkg),
+                    dnf_repo_get_id(repo),
+                    error_local->message);
+        g_error_free(error_local);
+        return FALSE;
     }
 
+    /* we can only install signed packages in this mode */
+    if ((priv->flags & DNF_TRANSACTION_FLAG_ONLY_TRUSTED) > 0) {
+        g_propagate_error(error, error_local);
+        return FALSE;
+    }
+    g_error_free(error_local);
     return TRUE;
+}
+
+gboolean
+dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, GError **error) try
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    GError *error_local = NULL;
+    const gchar *fn;
+
+    fn = dnf_transaction_gpgcheck_prepare(transaction, pkg, error);
+    if (fn == NULL)
+        return FALSE;
+
+    /* check file */
+    dnf_keyring_check_untrusted_file(priv->keyring, fn, &error_local);
+    return dnf_transaction_gpgcheck_result(transaction, pkg, error_local, error);
 } CATCH_TO_GERROR(FALSE)
 
+typedef struct {
+    rpmKeyring keyring;
+    const gchar *fn;
+    GError *error;
+} GpgcheckJob;
+
+static void
+dnf_transaction_gpgcheck_cb(gpointer data, gpointer user_data)
+{
+    auto job = static_cast<GpgcheckJob *>(data);
+    dnf_keyring_check_untrusted_file(job->keyring, job->fn, &job->error);
+}
+
 /**
  * dnf_transaction_check_untrusted:
  * @transaction: Transaction
@@ -424,13 +573,19 @@ dnf_transaction_gpgcheck_package(DnfTransaction *transaction, DnfPackage *pkg, G
  * @error: Error
  *
  * Verify GPG signatures for all pending packages to be changed as part
- * of @goal.
+ * of @goal. The files are checked in parallel, one thread per processor.
  */
 gboolean
 dnf_transaction_check_untrusted(DnfTransaction *transaction, HyGoal goal, GError **error) try
 {
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    gboolean ret = TRUE;
     guint i;
+    guint threads;
+    GThreadPool *pool = NULL;
+    GError *error_pool = NULL;
     g_autoptr(GPtrArray) install = NULL;
+    std::vector<GpgcheckJob> jobs;
 
     /* find a list of all the packages we might have to download */
     install = dnf_goal_get_packages(goal,
@@ -442,61 +597,139 @@ dnf_transaction_check_untrusted(DnfTransaction *transaction, HyGoal goal, GError
     if (install->len == 0)
         return TRUE;
 
-    /* find any packages in untrusted repos */
+    /* the package objects are not thread safe, look the files up first */
+    jobs.reserve(install->len);
     for (i = 0; i < install->len; i++) {
         auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, i));
-
-        if (!dnf_transaction_gpgcheck_package(transaction, pkg, error))
+        const gchar *fn = dnf_transaction_gpgcheck_prepare(transaction, pkg, error);
+        if (fn == NULL)
             return FALSE;
+        jobs.push_back({priv->keyring, fn, NULL});
     }
-    return TRUE;
+
+    /* files checked while downloading already have their result */
+    std::vector<GpgcheckJob *> pending;
+    for (auto & job : jobs) {
+        PipelineJob *prepared = dnf_transaction_pipeline_lookup(priv, job.fn);
+        if (prepared != NULL) {
+            job.error = prepared->error;
+            prepared->error = NULL;
+        } else {
+            pending.push_back(&job);
+        }
+    }
+
+    /* every check has its own rpmts, the keyring is shared read-only */
+    threads = MIN(g_get_num_processors(), pending.size());
+    if (threads > 1)
+        pool = g_thread_pool_new(dnf_transaction_gpgcheck_cb, NULL, threads, TRUE, &error_pool);
+    if (pool != NULL) {
+        for (auto job : pending)
+            g_thread_pool_push(pool, job, NULL);
+        /* wait for all the checks to finish */
+        g_thread_pool_free(pool, FALSE, TRUE);
+    } else {
+        if (error_pool != NULL) {
+            g_warning("Failed to create thread pool for checking signatures: %s",
+                      error_pool->message);
+            g_error_free(error_pool);
+        }
+        for (auto job : pending)
+            dnf_transaction_gpgcheck_cb(job, NULL);
+    }
+
+    /* report the first failure in the package order */
+    for (i = 0; i < install->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(install, i));
+        if (!ret) {
+            g_clear_error(&jobs[i].error);
+            continue;
+        }
+        ret = dnf_transaction_gpgcheck_result(transaction, pkg, jobs[i].error, error);
+    }
+    return ret;
 } CATCH_TO_GERROR(FALSE)
 
+static std::string
+dnf_package_index_nevra_key(const gchar *name, guint epoch, const gchar *version,
+                            const gchar *release, const gchar *arch)
+{
+    std::string key(name ? name : "");
+    key.append("-").append(std::to_string(epoch)).append(":");
+    key.append(version ? version : "").append("-");
+    key.append(release ? release : "").append(".");
+    key.append(arch ? arch : "");
+    return key;
+}
+
 /**
- * dnf_find_pkg_from_header:
+ * dnf_package_index_new:
+ *
+ * Indexes @array by NEVRA, name and filename basename. The first package in
+ * array order wins on duplicates, as with a linear scan.
  **/
-static DnfPackage *
-dnf_find_pkg_from_header(GPtrArray *array, Header hdr)
+static DnfPackageIndex *
+dnf_package_index_new(GPtrArray *array)
 {
-    const gchar *arch;
-    const gchar *name;
-    const gchar *release;
-    const gchar *version;
-    guint epoch;
-    guint i;
-
-    /* get details */
-    name = headerGetString(hdr, RPMTAG_NAME);
-    epoch = headerGetNumber(hdr, RPMTAG_EPOCH);
-    version = headerGetString(hdr, RPMTAG_VERSION);
-    release = headerGetString(hdr, RPMTAG_RELEASE);
-    arch = headerGetString(hdr, RPMTAG_ARCH);
-
-    /* find in array */
-    for (i = 0; i < array->len; i++) {
+    auto index = new DnfPackageIndex;
+    index->packages = array;
+    for (guint i = 0; i < array->len; i++) {
         auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
-        if (g_strcmp0(name, dnf_package_get_name(pkg)) != 0)
-            continue;
-        if (g_strcmp0(version, dnf_package_get_version(pkg)) != 0)
-            continue;
-        if (g_strcmp0(release, dnf_package_get_release(pkg)) != 0)
-            continue;
-        if (g_strcmp0(arch, dnf_package_get_arch(pkg)) != 0)
-            continue;
-        if (epoch != dnf_package_get_epoch(pkg))
-            continue;
-        return pkg;
+        const gchar *name = dnf_package_get_name(pkg);
+        index->by_nevra.emplace(dnf_package_index_nevra_key(name,
+                                                            dnf_package_get_epoch(pkg),
+                                                            dnf_package_get_version(pkg),
+                                                            dnf_package_get_release(pkg),
+                                                            dnf_package_get_arch(pkg)),
+                                pkg);
+        if (name != NULL)
+            index->by_name.emplace(name, pkg);
+        auto filename = dnf_package_get_filename(pkg);
+        if (filename != NULL) {
+            auto basename = strrchr(filename, '/');
+            index->by_basename[basename ? basename + 1 : filename].push_back(pkg);
+        }
     }
-    return NULL;
+    return index;
+}
+
+/**
+ * dnf_find_pkg_from_header:
+ **/
+static DnfPackage *
+dnf_find_pkg_from_header(const DnfPackageIndex *index, Header hdr)
+{
+    auto it = index->by_nevra.find(dnf_package_index_nevra_key(headerGetString(hdr, RPMTAG_NAME),
+                                                               headerGetNumber(hdr, RPMTAG_EPOCH),
+                                                               headerGetString(hdr, RPMTAG_VERSION),
+                                                               headerGetString(hdr, RPMTAG_RELEASE),
+                                                               headerGetString(hdr, RPMTAG_ARCH)));
+    return it == index->by_nevra.end() ? NULL : it->second;
 }
 
 /**
  * dnf_find_pkg_from_filename_suffix:
  **/
 static DnfPackage *
-dnf_find_pkg_from_filename_suffix(GPtrArray *array, const gchar *filename_suffix)
+dnf_find_pkg_from_filename_suffix(const DnfPackageIndex *index, const gchar *filename_suffix)
 {
-    /* find in array */
+    if (filename_suffix == NULL)
+        return NULL;
+
+    /* a suffix spanning a directory separator fixes the basename */
+    auto basename = strrchr(filename_suffix, '/');
+    if (basename != NULL) {
+        auto it = index->by_basename.find(basename + 1);
+        if (it == index->by_basename.end())
+            return NULL;
+        for (auto pkg : it->second)
+            if (g_str_has_suffix(dnf_package_get_filename(pkg), filename_suffix))
+                return pkg;
+        return NULL;
+    }
+
+    /* a bare suffix may cut a basename short, find in array */
+    GPtrArray *array = index->packages;
     for (guint i = 0; i < array->len; i++) {
         auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
         auto filename = dnf_package_get_filename(pkg);
@@ -512,17 +745,12 @@ dnf_find_pkg_from_filename_suffix(GPtrArray *array, const gchar *filename_suffix
  * dnf_find_pkg_from_name:
  **/
 static DnfPackage *
-dnf_find_pkg_from_name(GPtrArray *array, const gchar *pkgname)
+dnf_find_pkg_from_name(const DnfPackageIndex *index, const gchar *pkgname)
 {
-    guint i;
-
-    /* find in array */
-    for (i = 0; i < array->len; i++) {
-        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(array, i));
-        if (g_strcmp0(dnf_package_get_name(pkg), pkgname) == 0)
-            return pkg;
-    }
-    return NULL;
+    if (pkgname == NULL)
+        return NULL;
+    auto it = index->by_name.find(pkgname);
+    return it == index->by_name.end() ? NULL : it->second;
 }
 
 static void
@@ -596,7 +824,7 @@ dnf_transaction_ts_progress_cb(const void *arg,
         case RPMCALLBACK_INST_START:
 
             /* find pkg */
-            pkg = dnf_find_pkg_from_filename_suffix(priv->install, filename);
+            pkg = dnf_find_pkg_from_filename_suffix(priv->install_index, filename);
             if (pkg == NULL)
                 g_assert_not_reached();
 
@@ -625,14 +853,14 @@ dnf_transaction_ts_progress_cb(const void *arg,
         case RPMCALLBACK_UNINST_START:
 
             /* find pkg */
-            pkg = dnf_find_pkg_from_header(priv->remove, hdr);
+            pkg = dnf_find_pkg_from_header(priv->remove_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->remove, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->remove_index, filename);
             }
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_index, name);
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove_helper, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_helper_index, name);
             if (pkg == NULL) {
                 g_warning("cannot find %s in uninst-start", name);
                 priv->step = DNF_TRANSACTION_STEP_WRITING;
@@ -673,9 +901,9 @@ dnf_transaction_ts_progress_cb(const void *arg,
                 dnf_state_set_percentage(priv->child, percentage);
 
             /* update UI */
-            pkg = dnf_find_pkg_from_header(priv->install, hdr);
+            pkg = dnf_find_pkg_from_header(priv->install_index, hdr);
             if (pkg == NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->install, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->install_index, filename);
             }
             if (pkg == NULL) {
                 g_debug("cannot find %s(%s)", filename, name);
@@ -701,14 +929,14 @@ dnf_transaction_ts_progress_cb(const void *arg,
                 dnf_state_set_percentage(priv->child, percentage);
 
             /* update UI */
-            pkg = dnf_find_pkg_from_header(priv->remove, hdr);
+            pkg = dnf_find_pkg_from_header(priv->remove_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->remove, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->remove_index, filename);
             }
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_index, name);
             if (pkg == NULL && name != NULL)
-                pkg = dnf_find_pkg_from_name(priv->remove_helper, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_helper_index, name);
             if (pkg == NULL) {
                 g_warning("cannot find %s in uninst-progress", name);
                 break;
@@ -740,9 +968,9 @@ dnf_transaction_ts_progress_cb(const void *arg,
             break;
 
         case RPMCALLBACK_INST_STOP:
-            pkg = dnf_find_pkg_from_header(priv->install, hdr);
+            pkg = dnf_find_pkg_from_header(priv->install_index, hdr);
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->install, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->install_index, filename);
             }
 
             // transaction item install complete
@@ -757,18 +985,18 @@ dnf_transaction_ts_progress_cb(const void *arg,
 
         case RPMCALLBACK_UNINST_STOP:
 
-            pkg = dnf_find_pkg_from_header(priv->remove, hdr);
+            pkg = dnf_find_pkg_from_header(priv->remove_index, hdr);
             if (pkg == NULL) {
-                pkg = dnf_find_pkg_from_header(priv->remove_helper, hdr);
+                pkg = dnf_find_pkg_from_header(priv->remove_helper_index, hdr);
             }
             if (pkg == NULL && filename != NULL) {
-                pkg = dnf_find_pkg_from_filename_suffix(priv->remove, filename);
+                pkg = dnf_find_pkg_from_filename_suffix(priv->remove_index, filename);
             }
             if (pkg == NULL && name != NULL) {
-                pkg = dnf_find_pkg_from_name(priv->remove, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_index, name);
             }
             if (pkg == NULL && name != NULL) {
-                pkg = dnf_find_pkg_from_name(priv->remove_helper, name);
+                pkg = dnf_find_pkg_from_name(priv->remove_helper_index, name);
             }
 
             // transaction item remove complete
@@ -808,6 +1036,76 @@ dnf_rpm_verbosity_string_to_value(const gchar *value)
     return RPMLOG_EMERG;
 }
 
+/* unlinks the files of each directory relative to one open fd of it */
+static gboolean
+dnf_transaction_cleanup_files(CleanupJob *job, GError **error)
+{
+    for (auto & dir : job->files) {
+        int dirfd = open(dir.first.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirfd < 0) {
+            if (errno == ENOENT)
+                continue;
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("Failed to open %s: %s"),
+                        dir.first.c_str(), g_strerror(errno));
+            return FALSE;
+        }
+        for (auto & basename : dir.second) {
+            if (unlinkat(dirfd, basename.c_str(), 0) == 0 || errno == ENOENT)
+                continue;
+            g_set_error(error,
+                        DNF_ERROR,
+                        DNF_ERROR_INTERNAL_ERROR,
+                        _("Failed to delete %s/%s: %s"),
+                        dir.first.c_str(), basename.c_str(), g_strerror(errno));
+            close(dirfd);
+            return FALSE;
+        }
+        close(dirfd);
+    }
+    return TRUE;
+}
+
+static gpointer
+dnf_transaction_cleanup_thread(gpointer data)
+{
+    auto job = static_cast<CleanupJob *>(data);
+    dnf_transaction_cleanup_files(job, &job->error);
+    return job;
+}
+
+/**
+ * dnf_transaction_wait_cleanup:
+ * @transaction: a #DnfTransaction instance.
+ * @error: A #GError or %NULL
+ *
+ * Waits until the downloaded packages of the last dnf_transaction_commit()
+ * with %DNF_TRANSACTION_FLAG_BACKGROUND_CLEANUP are deleted. Does nothing
+ * if no deletion is running.
+ *
+ * Returns: %FALSE if a package could not be deleted
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_transaction_wait_cleanup(DnfTransaction *transaction, GError **error)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    if (priv->cleanup_thread == NULL)
+        return TRUE;
+    auto job = static_cast<CleanupJob *>(g_thread_join(priv->cleanup_thread));
+    priv->cleanup_thread = NULL;
+    gboolean ret = TRUE;
+    if (job->error != NULL) {
+        g_propagate_error(error, job->error);
+        ret = FALSE;
+    }
+    delete job;
+    return ret;
+}
+
 /**
  * dnf_transaction_delete_packages:
  **/
@@ -815,13 +1113,12 @@ static gboolean
 dnf_transaction_delete_packages(DnfTransaction *transaction, DnfState *state, GError **error)
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
-    DnfState *state_local;
     const gchar *cachedir;
     guint i;
 
     /* nothing to delete? */
     if (priv->install->len == 0)
-        return TRUE;
+        return dnf_state_finished(state, error);
 
     /* get the cachedir so we only delete packages in the actual
      * cache, not local-install packages */
@@ -834,26 +1131,31 @@ dnf_transaction_delete_packages(DnfTransaction *transaction, DnfState *state, GE
         return FALSE;
     }
 
-    /* delete each downloaded file */
-    state_local = dnf_state_get_child(state);
-    dnf_state_set_number_steps(state_local, priv->install->len);
+    /* group the downloaded files by the directory they are in */
+    auto job = new CleanupJob{{}, NULL};
     for (i = 0; i < priv->install->len; i++) {
         auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->install, i));
 
         /* don't delete files not in the repo */
         auto filename = dnf_package_get_filename(pkg);
-        if (g_str_has_prefix(filename, cachedir)) {
-            g_autoptr(GFile) file = NULL;
-            file = g_file_new_for_path(filename);
-            if (!g_file_delete(file, NULL, error))
-                return FALSE;
-        }
+        if (!g_str_has_prefix(filename, cachedir))
+            continue;
+        g_autofree gchar *dirname = g_path_get_dirname(filename);
+        g_autofree gchar *basename = g_path_get_basename(filename);
+        job->files[dirname].push_back(basename);
+    }
 
-        /* done */
-        if (!dnf_state_done(state_local, error))
-            return FALSE;
+    /* the caller waits for them with dnf_transaction_wait_cleanup() */
+    if (priv->flags & DNF_TRANSACTION_FLAG_BACKGROUND_CLEANUP) {
+        priv->cleanup_thread = g_thread_new("dnf-cleanup", dnf_transaction_cleanup_thread, job);
+        return dnf_state_finished(state, error);
     }
-    return TRUE;
+
+    gboolean ret = dnf_transaction_cleanup_files(job, error);
+    delete job;
+    if (!ret)
+        return FALSE;
+    return dnf_state_finished(state, error);
 }
 
 static int64_t
@@ -944,6 +1246,126 @@ dnf_transaction_check_free_space(DnfTransaction *transaction, GError **error)
     return TRUE;
 }
 
+/* free and needed space of one filesystem below the installroot */
+typedef struct {
+    std::string path; /* the first directory seen on it */
+    guint64 free_space;
+    gint64 needed;
+} DiskSpaceDevice;
+
+typedef struct {
+    std::string installroot;
+    std::unordered_map<std::string, dev_t> dir_devices;
+    std::map<dev_t, DiskSpaceDevice> devices;
+} DiskSpaceEstimate;
+
+/* the device @dir of the installroot ends up on, directories not created
+ * yet are answered by their deepest existing ancestor */
+static dev_t
+dnf_transaction_disk_space_device(DiskSpaceEstimate & estimate, const std::string & dir)
+{
+    auto it = estimate.dir_devices.find(dir);
+    if (it != estimate.dir_devices.end())
+        return it->second;
+
+    dev_t dev;
+    std::string path = estimate.installroot + dir;
+    struct stat st;
+    struct statvfs vfs;
+    if (stat(path.c_str(), &st) == 0) {
+        dev = st.st_dev;
+        if (estimate.devices.count(dev) == 0) {
+            guint64 free_space = G_MAXUINT64;
+            if (statvfs(path.c_str(), &vfs) == 0)
+                free_space = static_cast<guint64>(vfs.f_bavail) * vfs.f_frsize;
+            estimate.devices.emplace(dev, DiskSpaceDevice{path, free_space, 0});
+        }
+    } else {
+        auto slash = dir.rfind('/');
+        dev = dnf_transaction_disk_space_device(estimate,
+                                                slash == 0 || slash == std::string::npos
+                                                    ? "/" : dir.substr(0, slash));
+    }
+    estimate.dir_devices.emplace(dir, dev);
+    return dev;
+}
+
+/* splits the install size of @pkg over the filesystems by its file count */
+static void
+dnf_transaction_disk_space_add(DiskSpaceEstimate & estimate, DnfPackage *pkg, gint64 sign)
+{
+    auto size = static_cast<gint64>(dnf_package_get_installsize(pkg));
+    std::unordered_map<dev_t, guint64> files_on;
+    std::string dir;
+    guint64 nfiles = 0;
+
+    dnf_package_foreach_file(pkg, [&](const char *fn) {
+        const char *slash = strrchr(fn, '/');
+        if (slash == NULL || slash == fn)
+            dir = "/";
+        else
+            dir.assign(fn, slash - fn);
+        files_on[dnf_transaction_disk_space_device(estimate, dir)]++;
+        nfiles++;
+        return true;
+    });
+    if (nfiles == 0) {
+        estimate.devices[dnf_transaction_disk_space_device(estimate, "/")].needed += sign * size;
+        return;
+    }
+    for (auto & item : files_on)
+        estimate.devices[item.first].needed +=
+            sign * static_cast<gint64>(size * item.second / nfiles);
+}
+
+/**
+ * dnf_transaction_check_install_space:
+ *
+ * Estimates the space each filesystem of the installroot needs from the
+ * install sizes of the packages, before anything is downloaded. The file
+ * lists only weigh the sizes, rpm still does the exact accounting.
+ **/
+static gboolean
+dnf_transaction_check_install_space(DnfTransaction *transaction, GError **error)
+{
+    DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
+    DiskSpaceEstimate estimate;
+
+    if (!dnf_context_get_check_disk_space(priv->context) || priv->pkgs_to_erase == NULL)
+        return TRUE;
+    estimate.installroot = dnf_context_get_install_root(priv->context);
+    if (!estimate.installroot.empty() && estimate.installroot.back() == '/')
+        estimate.installroot.pop_back();
+
+    for (guint i = 0; i < priv->pkgs_to_install->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->pkgs_to_install, i));
+        dnf_transaction_disk_space_add(estimate, pkg, 1);
+    }
+    DnfSack *sack = priv->pkgs_to_erase->getSack();
+    Id id = -1;
+    while ((id = priv->pkgs_to_erase->next(id)) != -1) {
+        g_autoptr(DnfPackage) pkg = dnf_package_new(sack, id);
+        dnf_transaction_disk_space_add(estimate, pkg, -1);
+    }
+
+    for (auto & item : estimate.devices) {
+        const DiskSpaceDevice & device = item.second;
+        if (device.needed <= 0 || static_cast<guint64>(device.needed) <= device.free_space)
+            continue;
+        g_autofree gchar *formatted_needed_size = g_format_size(device.needed);
+        g_autofree gchar *formatted_free_size = g_format_size(device.free_space);
+        g_set_error(error,
+                    DNF_ERROR,
+                    DNF_ERROR_NO_SPACE,
+                    _("Not enough free space in %1$s: needed %2$s, available %3$s"),
+                    device.path.c_str(),
+                    formatted_needed_size,
+                    formatted_free_size);
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /**
  * dnf_transaction_download:
  * @transaction: a #DnfTransaction instance.
@@ -952,6 +1374,10 @@ dnf_transaction_check_free_space(DnfTransaction *transaction, GError **error)
  *
  * Downloads all the packages needed for a transaction.
  *
+ * With %DNF_TRANSACTION_FLAG_PIPELINE every finished package is signature
+ * checked and its header read on a worker thread while the rest download,
+ * and dnf_transaction_commit() picks up the results.
+ *
  * Returns: %TRUE for success, %FALSE otherwise
  *
  * Since: 0.1.0
@@ -961,12 +1387,45 @@ dnf_transaction_download(DnfTransaction *transaction, DnfState *state, GError **
 {
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
 
+    GError *error_pool = NULL;
+
     /* check that we have enough free space */
     if (!dnf_transaction_check_free_space(transaction, error))
         return FALSE;
+    if (!dnf_transaction_check_install_space(transaction, error))
+        return FALSE;
 
     /* just download the list */
-    return dnf_package_array_download(priv->pkgs_to_download, NULL, state, error);
+    dnf_transaction_pipeline_clear(priv);
+    if ((priv->flags & DNF_TRANSACTION_FLAG_PIPELINE) == 0 || priv->repos == NULL ||
+        priv->pkgs_to_download->len == 0)
+        return dnf_package_array_download(priv->pkgs_to_download, NULL, state, error);
+
+    /* the keys have to be in place before the first check starts */
+    if (!dnf_transaction_import_keys(transaction, error))
+        return FALSE;
+    priv->pipeline_pool = g_thread_pool_new(dnf_transaction_pipeline_cb, NULL,
+                                            g_get_num_processors(), TRUE, &error_pool);
+    if (priv->pipeline_pool == NULL) {
+        g_warning("Failed to create thread pool for checking downloads: %s",
+                  error_pool->message);
+        g_error_free(error_pool);
+        return dnf_package_array_download(priv->pkgs_to_download, NULL, state, error);
+    }
+    priv->pipeline_jobs = new std::unordered_map<std::string, PipelineJob *>;
+
+    /* every finished file is checked and read while the others download */
+    rpmVSFlags vsflags = rpmtsVSFlags(priv->ts);
+    DnfRepoPackageDoneFunc package_done = [priv, vsflags](DnfPackage *pkg) {
+        const gchar *fn = dnf_package_get_filename(pkg);
+        if (fn == NULL || priv->pipeline_jobs->count(fn) > 0)
+            return;
+        auto job = new PipelineJob{priv->keyring, vsflags, g_strdup(fn), NULL, RPMRC_FAIL, NULL};
+        priv->pipeline_jobs->emplace(fn, job);
+        g_thread_pool_push(priv->pipeline_pool, job, NULL);
+    };
+    return dnf_repo_download_packages_multi_full(priv->pkgs_to_download, NULL, state,
+                                                 &package_done, error);
 } CATCH_TO_GERROR(FALSE)
 
 /**
@@ -998,6 +1457,7 @@ dnf_transaction_depsolve(DnfTransaction *transaction, HyGoal goal, DnfState *sta
 
     /* find a list of all the packages we have to download */
     g_ptr_array_set_size(priv->pkgs_to_download, 0);
+    g_ptr_array_set_size(priv->pkgs_to_install, 0);
     packages = dnf_goal_get_packages(goal,
                                      DNF_PACKAGE_INFO_INSTALL,
                                      DNF_PACKAGE_INFO_REINSTALL,
@@ -1005,6 +1465,18 @@ dnf_transaction_depsolve(DnfTransaction *transaction, HyGoal goal, DnfState *sta
                                      DNF_PACKAGE_INFO_UPDATE,
                                      -1);
     g_debug("Goal has %u packages", packages->len);
+
+    /* remember what the transaction adds and drops for the disk space estimate */
+    delete priv->pkgs_to_erase;
+    priv->pkgs_to_erase = new libdnf::PackageSet(goal->listErasures());
+    *priv->pkgs_to_erase += goal->listObsoleted();
+    for (guint i = 0; i < packages->len; i++) {
+        auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(packages, i));
+        g_ptr_array_add(priv->pkgs_to_install, g_object_ref(pkg));
+        if (dnf_package_get_action(pkg) != DNF_STATE_ACTION_INSTALL)
+            *priv->pkgs_to_erase += goal->listObsoletedByPackage(pkg);
+    }
+
     for (guint i = 0; i < packages->len; i++) {
         auto pkg = static_cast< DnfPackage * >(g_ptr_array_index(packages, i));
 
@@ -1040,6 +1512,9 @@ dnf_transaction_reset(DnfTransaction *transaction)
     /* reset */
     priv->child = NULL;
     g_ptr_array_set_size(priv->pkgs_to_download, 0);
+    g_ptr_array_set_size(priv->pkgs_to_install, 0);
+    delete priv->pkgs_to_erase;
+    priv->pkgs_to_erase = NULL;
     rpmtsEmpty(priv->ts);
     rpmtsSetNotifyCallback(priv->ts, NULL, NULL);
 
@@ -1056,6 +1531,13 @@ dnf_transaction_reset(DnfTransaction *transaction)
         g_ptr_array_unref(priv->remove_helper);
         priv->remove_helper = NULL;
     }
+    delete priv->install_index;
+    priv->install_index = NULL;
+    delete priv->remove_index;
+    priv->remove_index = NULL;
+    delete priv->remove_helper_index;
+    priv->remove_helper_index = NULL;
+    dnf_transaction_pipeline_clear(priv);
     if (priv->erased_by_package_hash != NULL) {
         g_hash_table_unref(priv->erased_by_package_hash);
         priv->erased_by_package_hash = NULL;
@@ -1128,7 +1610,8 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     guint i;
     guint j;
     DnfState *state_local;
-    GPtrArray *all_obsoleted;
+    std::unique_ptr<libdnf::PackageSet> all_obsoleted;
+    std::vector<GPtrArray *> obsoleted_by;
     GPtrArray *pkglist;
     DnfPackage *pkg;
     DnfPackage *pkg_tmp;
@@ -1140,6 +1623,12 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     DnfSack * sack = hy_goal_get_sack(goal);
     std::unique_ptr<char, decltype(free)*> rpmdb_cookie_uptr{nullptr, free};
     std::string rpmdb_cookie;
+    std::string rpmdb_cookie_before;
+
+    /* the packages of the previous commit must be gone first */
+    ret = dnf_transaction_wait_cleanup(transaction, error);
+    if (!ret)
+        goto out;
 
     /* take lock */
     ret = dnf_state_take_lock(state, DNF_LOCK_TYPE_RPMDB, DNF_LOCK_MODE_PROCESS, error);
@@ -1221,8 +1710,13 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         filename = dnf_package_get_filename(pkg);
         allow_untrusted = (priv->flags & DNF_TRANSACTION_FLAG_ONLY_TRUSTED) == 0;
         is_update = action == DNF_STATE_ACTION_UPDATE || action == DNF_STATE_ACTION_DOWNGRADE;
-        ret = dnf_rpmts_add_install_filename2(
-            priv->ts, filename, allow_untrusted, is_update, pkg, error);
+        PipelineJob *prepared = dnf_transaction_pipeline_lookup(priv, filename);
+        if (prepared != NULL)
+            ret = dnf_rpmts_add_install_header(priv->ts, filename, prepared->hdr, prepared->res,
+                                               allow_untrusted, is_update, pkg, error);
+        else
+            ret = dnf_rpmts_add_install_filename2(
+                priv->ts, filename, allow_untrusted, is_update, pkg, error);
         if (!ret)
             goto out;
 
@@ -1245,6 +1739,8 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
             goto out;
     }
 
+    priv->install_index = dnf_package_index_new(priv->install);
+
     /* this section done */
     ret = dnf_state_done(state, error);
     if (!ret)
@@ -1253,11 +1749,11 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     /* add things to remove */
     priv->remove =
         dnf_goal_get_packages(goal, DNF_PACKAGE_INFO_OBSOLETE, DNF_PACKAGE_INFO_REMOVE, -1);
+    ret = dnf_rpmts_add_remove_pkgs(priv->ts, priv->remove, error);
+    if (!ret)
+        goto out;
     for (i = 0; i < priv->remove->len; i++) {
         pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->remove, i));
-        ret = dnf_rpmts_add_remove_pkg(priv->ts, pkg, error);
-        if (!ret)
-            goto out;
 
         /* pre-get the pkgid, as this isn't possible to get after
          * the sack is invalidated */
@@ -1268,7 +1764,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         libdnf::TransactionItemAction swdbAction = libdnf::TransactionItemAction::REMOVE;
 
         /* are the things being removed actually being upgraded */
-        pkg_tmp = dnf_find_pkg_from_name(priv->install, dnf_package_get_name(pkg));
+        pkg_tmp = dnf_find_pkg_from_name(priv->install_index, dnf_package_get_name(pkg));
         if (pkg_tmp != NULL) {
             dnf_package_set_action(pkg, DNF_STATE_ACTION_CLEANUP);
             if (dnf_package_evr_cmp(pkg, pkg_tmp)) {
@@ -1279,6 +1775,18 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         }
         _history_write_item(pkg, swdb, swdbAction);
     }
+    priv->remove_index = dnf_package_index_new(priv->remove);
+
+    /* what each update, downgrade and reinstall obsoletes, looked up once
+     * for both of the passes below */
+    obsoleted_by.assign(priv->install->len, NULL);
+    for (i = 0; i < priv->install->len; i++) {
+        pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->install, i));
+        if (dnf_package_get_action(pkg) == DNF_STATE_ACTION_UPDATE ||
+            dnf_package_get_action(pkg) == DNF_STATE_ACTION_DOWNGRADE ||
+            dnf_package_get_action(pkg) == DNF_STATE_ACTION_REINSTALL)
+            obsoleted_by[i] = hy_goal_list_obsoleted_by_package(goal, pkg);
+    }
 
     /* add anything that gets obsoleted to a helper array which is used to
      * map removed packages auto-added by rpm to actual DnfPackage's */
@@ -1289,7 +1797,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
                     dnf_package_get_action(pkg) == DNF_STATE_ACTION_DOWNGRADE;
         if (!is_update)
             continue;
-        pkglist = hy_goal_list_obsoleted_by_package(goal, pkg);
+        pkglist = obsoleted_by[i];
 
         const char *pkg_name = dnf_package_get_name(pkg);
 
@@ -1300,7 +1808,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
 
             const char *pkg_tmp_name = dnf_package_get_name(pkg_tmp);
 
-            if (dnf_find_pkg_from_name(priv->remove, pkg_tmp_name) != NULL) {
+            if (dnf_find_pkg_from_name(priv->remove_index, pkg_tmp_name) != NULL) {
                 // package is already in remove set - skip resolution
                 continue;
             }
@@ -1316,7 +1824,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
             }
 
             if (swdbAction == libdnf::TransactionItemAction::OBSOLETED
-                && dnf_find_pkg_from_name(priv->install, pkg_tmp_name) != NULL
+                && dnf_find_pkg_from_name(priv->install_index, pkg_tmp_name) != NULL
                 && g_strcmp0(pkg_name, pkg_tmp_name) != 0) {
                     // If a package is obsoleted and there's a package with the same name
                     // in the install set, skip recording the obsolete in the history db
@@ -1331,8 +1839,8 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
             // TODO SWDB add pkg_tmp replaced_by pkg
             _history_write_item(pkg_tmp, swdb, swdbAction);
         }
-        g_ptr_array_unref(pkglist);
     }
+    priv->remove_helper_index = dnf_package_index_new(priv->remove_helper);
 
     /* this section done */
     ret = dnf_state_done(state, error);
@@ -1342,26 +1850,21 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     /* map updated packages to their previous versions */
     priv->erased_by_package_hash =
         g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
-    all_obsoleted = hy_goal_list_obsoleted(goal, NULL);
+    all_obsoleted.reset(new libdnf::PackageSet(goal->listObsoleted()));
     for (i = 0; i < priv->install->len; i++) {
         pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->install, i));
-        if (dnf_package_get_action(pkg) != DNF_STATE_ACTION_UPDATE &&
-            dnf_package_get_action(pkg) != DNF_STATE_ACTION_DOWNGRADE &&
-            dnf_package_get_action(pkg) != DNF_STATE_ACTION_REINSTALL)
+        pkglist = obsoleted_by[i];
+        if (pkglist == NULL)
             continue;
-
-        pkglist = hy_goal_list_obsoleted_by_package(goal, pkg);
         for (j = 0; j < pkglist->len; j++) {
             pkg_tmp = static_cast< DnfPackage * >(g_ptr_array_index(pkglist, j));
-            if (!hy_packagelist_has(all_obsoleted, pkg_tmp)) {
+            if (!all_obsoleted->has(pkg_tmp)) {
                 g_hash_table_insert(priv->erased_by_package_hash,
                                     g_strdup(dnf_package_get_package_id(pkg)),
                                     g_object_ref(pkg_tmp));
             }
         }
-        g_ptr_array_unref(pkglist);
     }
-    g_ptr_array_unref(all_obsoleted);
 
     /* generate ordering for the transaction */
     rpmtsOrder(priv->ts);
@@ -1448,8 +1951,11 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     if (rpmdb_cookie.empty()) {
         g_critical(_("The rpmdbCookie() function did not return cookie of rpm database."));
     }
+    rpmdb_cookie_before = rpmdb_cookie;
     // FIXME get commandline
     swdb->beginTransaction(_get_current_time(), rpmdb_cookie, "", priv->uid);
+    // don't sync the history for every installed package
+    swdb->setItemStatesCheckpoint(100);
 
     /* run the transaction */
     priv->state = dnf_state_get_child(state);
@@ -1497,6 +2003,26 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     swdb->endTransaction(_get_current_time(), rpmdb_cookie, libdnf::TransactionState::DONE);
     swdb->closeTransaction();
 
+    /* a reinstall leaves the installed set as it was */
+    if (sack) {
+        g_autoptr(GPtrArray) installed = g_ptr_array_new();
+        g_autoptr(GPtrArray) erased = g_ptr_array_new();
+        for (i = 0; i < priv->install->len; i++) {
+            pkg = static_cast< DnfPackage * >(g_ptr_array_index(priv->install, i));
+            if (dnf_package_get_action(pkg) != DNF_STATE_ACTION_REINSTALL)
+                g_ptr_array_add(installed, pkg);
+        }
+        std::set<Id> erased_ids;
+        for (auto pkgs : {priv->remove, priv->remove_helper}) {
+            for (i = 0; i < pkgs->len; i++) {
+                pkg = static_cast< DnfPackage * >(g_ptr_array_index(pkgs, i));
+                if (erased_ids.insert(dnf_package_get_id(pkg)).second)
+                    g_ptr_array_add(erased, pkg);
+            }
+        }
+        dnf_sack_update_rpmdb_version(sack, rpmdb_cookie_before.c_str(), installed, erased);
+    }
+
     data.hookId = PLUGIN_HOOK_ID_CONTEXT_TRANSACTION;
     if (!dnf_context_plugin_hook(priv->context, PLUGIN_HOOK_ID_CONTEXT_TRANSACTION, &data, nullptr))
         goto out;
@@ -1530,6 +2056,9 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     /* this section done */
     ret = dnf_state_done(state, error);
 out:
+    for (auto obsoleted : obsoleted_by)
+        if (obsoleted != NULL)
+            g_ptr_array_unref(obsoleted);
     dnf_transaction_reset(transaction);
     dnf_state_release_locks(state);
     return ret;
@@ -57,6 +57,10 @@ struct _DnfTransactionClass
  * @DNF_TRANSACTION_FLAG_ALLOW_DOWNGRADE:       Allow package downrades
  * @DNF_TRANSACTION_FLAG_NODOCS:                Don't install documentation
  * @DNF_TRANSACTION_FLAG_TEST:                  Only do a transaction test
+ * @DNF_TRANSACTION_FLAG_PIPELINE:              Check and read each package while the rest
+ *                                              download, since 0.70.0
+ * @DNF_TRANSACTION_FLAG_BACKGROUND_CLEANUP:    Delete the downloaded packages in a thread
+ *                                              after the commit, since 0.70.0
  *
  * The transaction flags.
  **/
@@ -67,6 +71,8 @@ typedef enum {
         DNF_TRANSACTION_FLAG_ALLOW_DOWNGRADE    = 1 << 2,
         DNF_TRANSACTION_FLAG_NODOCS             = 1 << 3,
         DNF_TRANSACTION_FLAG_TEST               = 1 << 4,
+        DNF_TRANSACTION_FLAG_PIPELINE           = 1 << 5,
+        DNF_TRANSACTION_FLAG_BACKGROUND_CLEANUP = 1 << 6,
         /*< private >*/
         DNF_TRANSACTION_FLAG_LAST
 } DnfTransactionFlag;
@@ -111,6 +117,8 @@ gboolean         dnf_transaction_commit                 (DnfTransaction *transac
                                                          HyGoal          goal,
                                                          DnfState       *state,
                                                          GError         **error);
+gboolean         dnf_transaction_wait_cleanup           (DnfTransaction *transaction,
+                                                         GError         **error);
 gboolean         dnf_transaction_ensure_repo          (DnfTransaction *transaction,
                                                          DnfPackage *      pkg,
                                                          GError         **error);
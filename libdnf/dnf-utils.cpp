@@ -37,6 +37,7 @@
 #include "dnf-types.h"
 #include "dnf-utils.h"
 
+#include "utils/PhaseTimer.hpp"
 #include "utils/bgettext/bgettext-lib.h"
 
 /**
@@ -274,3 +275,64 @@ dnf_get_file_contents_allow_noent(const gchar            *path,
 
     return TRUE;
 } CATCH_TO_GERROR(FALSE)
+
+/**
+ * dnf_phase_timings_get_enabled:
+ *
+ * Gets whether the wall time, CPU time and RSS change of the startup phases
+ * (context setup, repo loading, module filtering, ...) are recorded. The
+ * recording is also enabled by a non empty LIBDNF_PHASE_TIMINGS environment
+ * variable.
+ *
+ * Returns: %TRUE if the phases are recorded
+ *
+ * Since: 0.70.0
+ **/
+gboolean
+dnf_phase_timings_get_enabled(void)
+{
+    return libdnf::PhaseTimings::isEnabled();
+}
+
+/**
+ * dnf_phase_timings_set_enabled:
+ * @enabled: %TRUE to record the startup phases
+ *
+ * Enables or disables the recording of the startup phases.
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_phase_timings_set_enabled(gboolean enabled)
+{
+    libdnf::PhaseTimings::setEnabled(enabled);
+}
+
+/**
+ * dnf_phase_timings_report:
+ *
+ * Formats the recorded phases as a table with one line per phase and
+ * repository, nested phases are indented.
+ *
+ * Returns: (transfer full): the report, free with g_free()
+ *
+ * Since: 0.70.0
+ **/
+gchar *
+dnf_phase_timings_report(void)
+{
+    return g_strdup(libdnf::PhaseTimings::report().c_str());
+}
+
+/**
+ * dnf_phase_timings_clear:
+ *
+ * Drops the recorded phases.
+ *
+ * Since: 0.70.0
+ **/
+void
+dnf_phase_timings_clear(void)
+{
+    libdnf::PhaseTimings::clear();
+}
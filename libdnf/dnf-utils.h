@@ -64,6 +64,10 @@ gboolean         dnf_get_file_contents_allow_noent  (const gchar            *pat
                                                      gchar                  **out_contents,
                                                      gsize                  *length,
                                                      GError                 **error);
+gboolean         dnf_phase_timings_get_enabled      (void);
+void             dnf_phase_timings_set_enabled      (gboolean                enabled);
+gchar           *dnf_phase_timings_report           (void);
+void             dnf_phase_timings_clear            (void);
 
 #ifdef __cplusplus
 }
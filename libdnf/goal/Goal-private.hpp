@@ -21,6 +21,8 @@
 #ifndef __GOAL_PRIVATE_HPP
 #define __GOAL_PRIVATE_HPP
 
+#include <map>
+
 #include "Goal.hpp"
 #include "IdQueue.hpp"
 #include "../sack/packageset.hpp"
@@ -44,19 +46,50 @@ private:
     DnfGoalActions actions{DNF_NONE};
     std::unique_ptr<PackageSet> protectedPkgs;
     bool protect_running_kernel{true};
+    bool reuseSolver{false};
+    guint64 solverGeneration{0};
+    Goal::Stats stats;
     std::unique_ptr<PackageSet> removalOfProtected;
+    // transaction steps by type, filled by the first listResults() after a solve
+    std::map<Id, PackageSet> resultsByType;
+    std::unique_ptr<PackageSet> resultsObsoleted;
+    // reasons of the steps of a plan loaded by loadPlan(), there is no solver to ask
+    std::map<Id, int> plannedReasons;
+    // listUnneeded() and listSuggested() of the current solver state, reset with the results
+    std::unique_ptr<PackageSet> unneeded;
+    std::unique_ptr<PackageSet> suggested;
+    // a re-run deciding the same packages with the same userinstalled jobs in an unchanged sack
+    // has the unneeded and suggested packages of the previous run, see sameSolverState()
+    std::unique_ptr<PackageSet> lastDecided;
+    std::vector<Id> lastUserInstalled;
+    guint64 lastGeneration{0};
+    std::unique_ptr<PackageSet> lastUnneeded;
+    std::unique_ptr<PackageSet> lastSuggested;
+    // staging range of the jobs of distupgradePreresolved(), replaced by the plain distupgrade
+    // job when they have no solution, see replacePreresolved()
+    int preresolvedBegin{-1};
+    int preresolvedEnd{-1};
 
+    void classifyResults();
+    void resetResults();
+    bool sameSolverState();
     PackageSet listResults(Id type_filter1, Id type_filter2);
+    bool replacePreresolved();
     void allowUninstallAllButProtected(Queue *job, DnfGoalActions flags);
     std::unique_ptr<IdQueue> constructJob(DnfGoalActions flags);
     bool solve(Queue *job, DnfGoalActions flags);
+    bool runSolver(Queue *job, DnfGoalActions flags);
     Solver * initSolver();
+    bool precomputeInstallonlyJobs(Queue *job, Queue *limitJobs);
     int limitInstallonlyPackages(Solver *solv, Queue *job);
     std::unique_ptr<IdQueue> conflictPkgs(unsigned i);
     std::unique_ptr<IdQueue> brokenDependencyPkgs(unsigned i);
     Id protectedRunningKernel();
     bool protectedInRemovals();
     std::string describeProtectedRemoval();
+    std::vector<Goal::ProblemRule> problemRules(unsigned i, bool protectedRemoval);
+    std::string formatProblemRule(const Goal::ProblemRule & rule, bool pkgs,
+                                  PackageSet * modularExcludes);
     std::unique_ptr<PackageSet> brokenDependencyAllPkgs(DnfPackageState pkg_type);
     int countProblems();
 };
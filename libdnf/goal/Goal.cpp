@@ -18,16 +18,27 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <map>
 #include <vector>
 #include <numeric>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
 extern "C" {
 #include <solv/evr.h>
 #include <solv/queue.h>
 #include <solv/selection.h>
 #include <solv/solver.h>
+#include <solv/solv_xfopen.h>
 #include <solv/solverdebug.h>
 #include <solv/testcase.h>
 #include <solv/transaction.h>
@@ -46,6 +57,7 @@ extern "C" {
 #include "../utils/tinyformat/tinyformat.hpp"
 #include "IdQueue.hpp"
 #include "../utils/filesystem.hpp"
+#include "../utils/probes.hpp"
 
 namespace {
 
@@ -54,6 +66,31 @@ std::string pkgSolvid2str(Pool * pool, Id source)
     return pool_solvid2str(pool, source);
 }
 
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Rich dependencies are printed in parentheses and skipped by the weak deps autodetection
+bool isRichDep(Pool * pool, Id dep)
+{
+    if (!ISRELDEP(dep)) {
+        return false;
+    }
+    switch (GETRELDEP(pool, dep)->flags) {
+        case REL_AND:
+        case REL_OR:
+        case REL_WITH:
+        case REL_WITHOUT:
+        case REL_COND:
+        case REL_UNLESS:
+        case REL_ELSE:
+            return true;
+        default:
+            return false;
+    }
+}
+
 std::string moduleSolvid2str(Pool * pool, Id source)
 {
     std::ostringstream ss;
@@ -322,6 +359,7 @@ filterFileToJob(DnfSack *sack, const Filter *f, Queue *job)
     int flags = f->getCmpType() & HY_GLOB ? SELECTION_GLOB : 0;
     if (f->getCmpType() & HY_GLOB)
         flags |= SELECTION_NOCASE;
+    dnf_sack_reload_unloaded_exts(sack, nullptr, DNF_SACK_LOAD_FLAG_USE_FILELISTS);
     if (selection_make(pool, job, file, flags | SELECTION_FILELIST) == 0)
         return NO_MATCH;
     return 0;
@@ -390,6 +428,7 @@ filterProvidesToJob(DnfSack *sack, const Filter *f, Queue *job)
     switch (f->getCmpType()) {
         case HY_EQ:
             id = matches[0].reldep;
+            dnf_sack_load_lazy_filelists(sack, id);
             queue_push2(job, SOLVER_SOLVABLE_PROVIDES, id);
             break;
         case HY_GLOB:
@@ -440,64 +479,74 @@ filterReponameToJob(DnfSack *sack, const Filter *f, Queue *job)
     return 0;
 }
 
+/* the selection of sltr without any solver action, see sltrToJob() */
+static int
+sltrToSelection(const HySelector sltr, IdQueue & job_sltr)
+{
+    DnfSack *sack = sltr->getSack();
+    int ret = filterPkgToJob(sltr->getPkgs(), job_sltr.getQueue());
+    if (ret)
+        return ret;
+    ret = filterNameToJob(sack, sltr->getFilterName(), job_sltr.getQueue());
+    if (ret)
+        return ret;
+    ret = filterFileToJob(sack, sltr->getFilterFile(), job_sltr.getQueue());
+    if (ret)
+        return ret;
+    ret = filterProvidesToJob(sack, sltr->getFilterProvides(), job_sltr.getQueue());
+    if (ret)
+        return ret;
+    ret = filterArchToJob(sack, sltr->getFilterArch(), job_sltr.getQueue());
+    if (ret)
+        return ret;
+    ret = filterEvrToJob(sack, sltr->getFilterEvr(), job_sltr.getQueue());
+    if (ret)
+        return ret;
+    return filterReponameToJob(sack, sltr->getFilterReponame(), job_sltr.getQueue());
+}
+
 /**
  * Build job queue from a Query.
  *
- * Returns an error code
+ * The selection is cached by the selector until it or the sack change, so selectors passed to
+ * the goal after Selector::matches() or repeatedly are not resolved again.
  */
 void
 sltrToJob(const HySelector sltr, Queue *job, int solver_action)
 {
     DnfSack *sack = sltr->getSack();
-    int ret = 0;
 
     int any_opt_filter = sltr->getFilterArch() || sltr->getFilterEvr()
         || sltr->getFilterReponame();
     int any_req_filter = sltr->getFilterName() || sltr->getFilterProvides()
         || sltr->getFilterFile() || sltr->getPkgs();
 
-    IdQueue job_sltr;
-
     if (!any_req_filter) {
         if (any_opt_filter) {
             // no name or provides or file in the selector is an error
             throw Goal::Error("Ill-formed Selector. No name or"
                 "provides or file in the selector.", DNF_ERROR_BAD_SELECTOR);
         }
-        goto finish;
+        return;
     }
 
     dnf_sack_recompute_considered(sack);
     dnf_sack_make_provides_ready(sack);
-    ret = filterPkgToJob(sltr->getPkgs(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-    ret = filterNameToJob(sack, sltr->getFilterName(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-    ret = filterFileToJob(sack, sltr->getFilterFile(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-    ret = filterProvidesToJob(sack, sltr->getFilterProvides(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-    ret = filterArchToJob(sack, sltr->getFilterArch(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-    ret = filterEvrToJob(sack, sltr->getFilterEvr(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-    ret = filterReponameToJob(sack, sltr->getFilterReponame(), job_sltr.getQueue());
-    if (ret)
-        goto finish;
-
-    for (int i = 0; i < job_sltr.size(); i += 2)
-         queue_push2(job, job_sltr[i] | solver_action, job_sltr[i + 1]);
-
- finish:
-    if (ret > 1) {
-        throw Goal::Error(TM_(ERROR_DICT[ret], 1), DNF_ERROR_BAD_SELECTOR);
+    auto selection = sltr->getCachedJob();
+    if (!selection) {
+        IdQueue job_sltr;
+        int ret = sltrToSelection(sltr, job_sltr);
+        if (ret > 1) {
+            throw Goal::Error(TM_(ERROR_DICT[ret], 1), DNF_ERROR_BAD_SELECTOR);
+        }
+        // NO_MATCH selects nothing
+        if (ret)
+            job_sltr.clear();
+        selection = sltr->setCachedJob(std::move(job_sltr));
     }
+
+    for (int i = 0; i < selection->size(); i += 2)
+         queue_push2(job, (*selection)[i] | solver_action, (*selection)[i + 1]);
 }
 
 #define BLOCK_SIZE 15
@@ -640,6 +689,9 @@ Goal::Impl::Impl(const Goal::Impl & goal_src)
     queue_init_clone(&staging, const_cast<Queue *>(&goal_src.staging));
 
     actions = goal_src.actions;
+    reuseSolver = goal_src.reuseSolver;
+    preresolvedBegin = goal_src.preresolvedBegin;
+    preresolvedEnd = goal_src.preresolvedEnd;
     if (goal_src.protectedPkgs) {
         protectedPkgs.reset(new PackageSet(*goal_src.protectedPkgs.get()));
     }
@@ -654,6 +706,8 @@ Goal::Impl::Impl(DnfSack *sack)
     queue_init(&staging);
 }
 
+constexpr int Goal::ProblemRule::PROTECTED_REMOVAL;
+
 Goal::Goal(DnfSack *sack) : pImpl(new Impl(sack)) {}
 
 Goal::~Goal() = default;
@@ -671,37 +725,79 @@ DnfGoalActions Goal::getActions() { return pImpl->actions; }
 
 DnfSack * Goal::getSack() { return pImpl->sack; }
 
-int
-Goal::getReason(DnfPackage *pkg)
+/// Reason of the decision about the package, @cleanDeps are the packages erased as
+/// clean dependencies
+static int
+decisionReason(Solver *solv, Id pkgID, const Map &cleanDeps)
 {
-    //solver_get_recommendations
-    if (!pImpl->solv)
-        return HY_REASON_USER;
     Id info;
-    const Id pkgID = dnf_package_get_id(pkg);
-    int reason = solver_describe_decision(pImpl->solv, pkgID, &info);
+    int reason = solver_describe_decision(solv, pkgID, &info);
 
     if ((reason == SOLVER_REASON_UNIT_RULE ||
          reason == SOLVER_REASON_RESOLVE_JOB) &&
-        (solver_ruleclass(pImpl->solv, info) == SOLVER_RULE_JOB ||
-         solver_ruleclass(pImpl->solv, info) == SOLVER_RULE_BEST))
+        (solver_ruleclass(solv, info) == SOLVER_RULE_JOB ||
+         solver_ruleclass(solv, info) == SOLVER_RULE_BEST))
         return HY_REASON_USER;
     if (reason == SOLVER_REASON_CLEANDEPS_ERASE)
         return HY_REASON_CLEAN;
     if (reason == SOLVER_REASON_WEAKDEP)
         return HY_REASON_WEAKDEP;
+    if (MAPTST(&cleanDeps, pkgID))
+        return HY_REASON_CLEAN;
+    return HY_REASON_DEP;
+}
+
+/// Map of the packages erased as clean dependencies
+static void
+cleanDepsMap(Solver *solv, Map *cleanDeps)
+{
     IdQueue cleanDepsQueue;
-    solver_get_cleandeps(pImpl->solv, cleanDepsQueue.getQueue());
+    solver_get_cleandeps(solv, cleanDepsQueue.getQueue());
+    map_init(cleanDeps, solv->pool->nsolvables);
     for (int i = 0; i < cleanDepsQueue.size(); ++i) {
-        if (cleanDepsQueue[i] == pkgID) {
-            return HY_REASON_CLEAN;
+        MAPSET(cleanDeps, cleanDepsQueue[i]);
+    }
+}
+
+int
+Goal::getReason(DnfPackage *pkg)
+{
+    //solver_get_recommendations
+    if (!pImpl->solv) {
+        auto it = pImpl->plannedReasons.find(dnf_package_get_id(pkg));
+        return it != pImpl->plannedReasons.end() ? it->second : HY_REASON_USER;
+    }
+    Map cleanDeps;
+    cleanDepsMap(pImpl->solv, &cleanDeps);
+    int reason = decisionReason(pImpl->solv, dnf_package_get_id(pkg), cleanDeps);
+    map_free(&cleanDeps);
+    return reason;
+}
+
+std::map< Id, int >
+Goal::getReasons(const PackageSet & pset)
+{
+    std::map< Id, int > reasons;
+    if (!pImpl->solv) {
+        auto & planned = pImpl->plannedReasons;
+        for (Id id = pset.next(-1); id != -1; id = pset.next(id)) {
+            auto it = planned.find(id);
+            reasons.emplace_hint(reasons.end(), id,
+                                 it != planned.end() ? it->second : HY_REASON_USER);
         }
+        return reasons;
     }
-    return HY_REASON_DEP;
+    Map cleanDeps;
+    cleanDepsMap(pImpl->solv, &cleanDeps);
+    for (Id id = pset.next(-1); id != -1; id = pset.next(id)) {
+        reasons.emplace_hint(reasons.end(), id, decisionReason(pImpl->solv, id, cleanDeps));
+    }
+    map_free(&cleanDeps);
+    return reasons;
 }
 
 void
-Goal::addProtected(PackageSet & pset)
+Goal::addProtected(const PackageSet & pset)
 {
     if (!pImpl->protectedPkgs) {
         pImpl->protectedPkgs.reset(new PackageSet(pset));
@@ -722,6 +818,18 @@ Goal::set_protect_running_kernel(bool value)
     pImpl->protect_running_kernel = value;
 }
 
+bool
+Goal::getReuseSolver() const noexcept
+{
+    return pImpl->reuseSolver;
+}
+
+void
+Goal::setReuseSolver(bool value)
+{
+    pImpl->reuseSolver = value;
+}
+
 void
 Goal::setProtected(const PackageSet & pset)
 {
@@ -754,6 +862,104 @@ Goal::distupgrade(HySelector sltr)
     sltrToJob(sltr, &pImpl->staging, SOLVER_DISTUPGRADE);
 }
 
+/* Pushes the distupgrade to pkg if it is the only sensible target of the installed package,
+ * see Goal::distupgradePreresolved(). The available packages of the name are marked in done. */
+static bool
+preresolve_distupgrade(DnfSack *sack, Id installedId, const PackageSet & available,
+                       const PackageSet & keep, PackageSet & done, Queue *job)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Solvable *installed = pool_id2solvable(pool, installedId);
+    auto range = dnf_sack_solvables_with_name(sack, installed->name);
+    Id best = 0;
+    bool tie = false;
+    for (auto it = range.first; it != range.second; ++it) {
+        Id p = *it;
+        Solvable *s = pool_id2solvable(pool, p);
+        if (s->repo == pool->installed) {
+            if (p != installedId)
+                return false;
+            continue;
+        }
+        if (!available.has(p))
+            continue;
+        if (best && s->repo->priority != pool_id2solvable(pool, best)->repo->priority)
+            return false;
+        int cmp = best ? pool_evrcmp(pool, s->evr, pool_id2solvable(pool, best)->evr, EVRCMP_COMPARE) : 1;
+        if (cmp > 0) {
+            best = p;
+            tie = false;
+        } else if (cmp == 0)
+            tie = true;
+    }
+    if (!best || tie || keep.has(installedId))
+        return false;
+    if (pool_id2solvable(pool, best)->obsoletes || dnf_sack_what_upgrades(sack, best) != installedId)
+        return false;
+    // every available package of the name has to be a candidate of this installed one
+    for (auto it = range.first; it != range.second; ++it) {
+        Solvable *s = pool_id2solvable(pool, *it);
+        if (s->repo != pool->installed && available.has(*it) && s->arch != installed->arch &&
+            s->arch != ARCH_NOARCH && installed->arch != ARCH_NOARCH)
+            return false;
+    }
+    queue_push2(job, SOLVER_SOLVABLE|SOLVER_DISTUPGRADE, best);
+    for (auto it = range.first; it != range.second; ++it)
+        if (available.has(*it))
+            done.set(*it);
+    return true;
+}
+
+void
+Goal::distupgradePreresolved()
+{
+    DnfSack * sack = pImpl->sack;
+    Pool * pool = dnf_sack_get_pool(sack);
+    Query query(sack);
+    query.available();
+    const PackageSet * available = query.runSet();
+    if (!pool->installed) {
+        distupgrade();
+        return;
+    }
+    pImpl->actions = static_cast<DnfGoalActions>(pImpl->actions | DNF_DISTUPGRADE|DNF_ALLOW_DOWNGRADE);
+    dnf_sack_make_provides_ready(sack);
+
+    // installed packages left to the solver: obsoleted by an available package or installonly
+    PackageSet keep(sack);
+    Id p, pp;
+    for (Id obsoleting : dnf_sack_solvables_with_obsoletes(sack)) {
+        Solvable *s = pool_id2solvable(pool, obsoleting);
+        if (s->repo == pool->installed || !available->has(obsoleting))
+            continue;
+        for (Id *obsp = s->repo->idarraydata + s->obsoletes; *obsp; ++obsp)
+            FOR_PROVIDES(p, pp, *obsp)
+                if (pool_id2solvable(pool, p)->repo == pool->installed)
+                    keep.set(p);
+    }
+    Queue *installonly = dnf_sack_get_installonly(sack);
+    for (int i = 0; i < installonly->count; ++i)
+        FOR_PROVIDES(p, pp, installonly->elements[i])
+            if (pool_id2solvable(pool, p)->repo == pool->installed)
+                keep.set(p);
+
+    int begin = pImpl->staging.count;
+    PackageSet done(sack);
+    Solvable *s;
+    FOR_REPO_SOLVABLES(pool->installed, p, s)
+        preresolve_distupgrade(sack, p, *available, keep, done, &pImpl->staging);
+
+    PackageSet remainder(*available);
+    remainder -= done;
+    if (!remainder.empty()) {
+        Selector selector(sack);
+        selector.set(&remainder);
+        sltrToJob(&selector, &pImpl->staging, SOLVER_DISTUPGRADE);
+    }
+    pImpl->preresolvedBegin = begin;
+    pImpl->preresolvedEnd = pImpl->staging.count;
+}
+
 void
 Goal::erase(DnfPackage *pkg, int flags)
 {
@@ -770,6 +976,25 @@ Goal::erase(HySelector sltr, int flags)
     sltrToJob(sltr, &pImpl->staging, SOLVER_ERASE|additional);
 }
 
+void
+Goal::erase(const PackageSet & pset, int flags)
+{
+    if (pset.empty())
+        return;
+    int additional = erase_flags2libsolv(flags);
+    pImpl->actions = static_cast<DnfGoalActions>(pImpl->actions | DNF_ERASE);
+    Pool *pool = dnf_sack_get_pool(pImpl->sack);
+    dnf_sack_recompute_considered(pImpl->sack);
+    dnf_sack_make_provides_ready(pImpl->sack);
+
+    IdQueue pkgs;
+    Id id = -1;
+    while ((id = pset.next(id)) != -1)
+        pkgs.pushBack(id);
+    Id what = pool_queuetowhatprovides(pool, pkgs.getQueue());
+    queue_push2(&pImpl->staging, SOLVER_SOLVABLE_ONE_OF|SOLVER_ERASE|additional, what);
+}
+
 void
 Goal::install(DnfPackage *new_pkg, bool optional)
 {
@@ -781,6 +1006,24 @@ Goal::install(DnfPackage *new_pkg, bool optional)
     packageToJob(new_pkg, &pImpl->staging, solverActions);
 }
 
+void
+Goal::install(const PackageSet & pset, bool optional)
+{
+    if (pset.empty())
+        return;
+    int solverActions = SOLVER_SOLVABLE|SOLVER_SETARCH|SOLVER_SETEVR|SOLVER_INSTALL;
+    if (optional) {
+        solverActions |= SOLVER_WEAK;
+    }
+    pImpl->actions = static_cast<DnfGoalActions>(pImpl->actions | DNF_INSTALL|DNF_ALLOW_DOWNGRADE);
+    Queue *staging = &pImpl->staging;
+    // PackageSets hold every package only once, the jobs need no deduplication
+    queue_prealloc(staging, static_cast<int>(pset.size() * 2));
+    Id id = -1;
+    while ((id = pset.next(id)) != -1)
+        queue_push2(staging, solverActions, id);
+}
+
 void
 Goal::lock(DnfPackage *pkg)
 {
@@ -824,73 +1067,97 @@ Goal::exclude_from_weak_autodetect()
     Query base_query(pImpl->sack);
     base_query.apply();
     auto * installed_pset = installed_query.getResultPset();
-    Id installed_id = -1;
+    auto * base_pset = base_query.getResultPset();
+    Pool * pool = dnf_sack_get_pool(pImpl->sack);
+    dnf_sack_make_provides_ready(pImpl->sack);
+    map_grow(pImpl->exclude_from_weak.getMap(), pool->nsolvables);
 
-    std::vector<const char *> installed_names;
-    installed_names.reserve(installed_pset->size() + 1);
+    // Dependencies are resolved directly in the whatprovides tables, each one only once
+    std::vector<bool> installed_names(pool->ss.nstrings);
+    std::unordered_set<Id> done_recommends;
+    IdQueue deps;
+    std::vector<Id> available_providers;
 
     // Iterate over installed packages to detect unmet weak deps
+    Id installed_id = -1;
     while ((installed_id = installed_pset->next(installed_id)) != -1) {
-        g_autoptr(DnfPackage) pkg = dnf_package_new(pImpl->sack, installed_id);
-        installed_names.push_back(dnf_package_get_name(pkg));
-        std::unique_ptr<libdnf::DependencyContainer> recommends(dnf_package_get_recommends(pkg));
-        for (int i = 0; i < recommends->count(); ++i) {
-            std::unique_ptr<libdnf::Dependency> dep(recommends->getPtr(i));
-            const char * dep_string = dep->toString();
-            if (dep_string[0] == '(') {
+        Solvable * s = pool_id2solvable(pool, installed_id);
+        installed_names[s->name] = true;
+        deps.clear();
+        solvable_lookup_deparray(s, SOLVABLE_RECOMMENDS, deps.getQueue(), -1);
+        for (int i = 0; i < deps.size(); ++i) {
+            Id dep = deps[i];
+            if (isRichDep(pool, dep)) {
                 continue;
             }
-            Query query(base_query);
-            const char * version = dep->getVersion();
             //  There can be installed provider in different version or upgraded packed can recommend a different version
             //  Ignore version and search only by reldep name
-            if (version && strlen(version) > 0) {
-                query.addFilter(HY_PKG_PROVIDES, HY_EQ, dep->getName());
-            } else {
-                query.addFilter(HY_PKG_PROVIDES, dep.get());
+            if (ISRELDEP(dep)) {
+                dep = GETRELDEP(pool, dep)->name;
+                if (ISRELDEP(dep)) {
+                    continue;
+                }
             }
-            // No providers of recommend => continue
-            if (query.empty()) {
+            if (!done_recommends.insert(dep).second) {
                 continue;
             }
-            Query test_installed(query);
-            test_installed.installed();
+            available_providers.clear();
+            bool provider_installed = false;
+            Id p, pp;
+            FOR_PROVIDES(p, pp, dep) {
+                if (!base_pset->has(p)) {
+                    continue;
+                }
+                if (pool->solvables[p].repo == pool->installed) {
+                    provider_installed = true;
+                    break;
+                }
+                available_providers.push_back(p);
+            }
             // when there is not installed any provider of recommend, exclude it
-            if (test_installed.empty()) {
-                add_exclude_from_weak(*query.getResultPset());
+            if (!provider_installed) {
+                for (Id provider : available_providers) {
+                    pImpl->exclude_from_weak.set(provider);
+                }
             }
         }
     }
 
     // Investigate supplements of only available packages with a different name to installed packages
-    installed_names.push_back(nullptr);
-    base_query.addFilter(HY_PKG_NAME, HY_NEQ, installed_names.data());
-    auto * available_pset = base_query.getResultPset();
-    *available_pset -= *installed_pset;
+    std::unordered_map<Id, bool> supplement_installed;
     Id available_id = -1;
-    while ((available_id = available_pset->next(available_id)) != -1) {
-        g_autoptr(DnfPackage) pkg = dnf_package_new(pImpl->sack, available_id);
-        std::unique_ptr<libdnf::DependencyContainer> supplements(dnf_package_get_supplements(pkg));
-        if (supplements->count() == 0) {
+    while ((available_id = base_pset->next(available_id)) != -1) {
+        Solvable * s = pool_id2solvable(pool, available_id);
+        if (s->repo == pool->installed || installed_names[s->name]) {
             continue;
         }
-        libdnf::DependencyContainer supplements_without_rich(getSack());
-        for (int i = 0; i < supplements->count(); ++i) {
-            std::unique_ptr<libdnf::Dependency> dep(supplements->getPtr(i));
-            const char * dep_string = dep->toString();
-            if (dep_string[0] == '(') {
+        deps.clear();
+        solvable_lookup_deparray(s, SOLVABLE_SUPPLEMENTS, deps.getQueue(), -1);
+        for (int i = 0; i < deps.size(); ++i) {
+            Id dep = deps[i];
+            if (isRichDep(pool, dep)) {
                 continue;
             }
-            supplements_without_rich.add(dep.get());
-        }
-        if (supplements_without_rich.count() == 0) {
-            continue;
-        }
-        Query query(installed_query);
-        query.addFilter(HY_PKG_PROVIDES, &supplements_without_rich);
-        // When supplemented package already installed, exclude_from_weak available package
-        if (!query.empty()) {
-            add_exclude_from_weak(pkg);
+            auto cached = supplement_installed.find(dep);
+            bool installed;
+            if (cached != supplement_installed.end()) {
+                installed = cached->second;
+            } else {
+                installed = false;
+                Id p, pp;
+                FOR_PROVIDES(p, pp, dep) {
+                    if (pool->solvables[p].repo == pool->installed) {
+                        installed = true;
+                        break;
+                    }
+                }
+                supplement_installed.emplace(dep, installed);
+            }
+            // When supplemented package already installed, exclude_from_weak available package
+            if (installed) {
+                pImpl->exclude_from_weak.set(available_id);
+                break;
+            }
         }
     }
 }
@@ -937,6 +1204,16 @@ Goal::upgrade(HySelector sltr)
     sltrToJob(sltr, &pImpl->staging, flags);
 }
 
+void
+Goal::upgrade(const PackageSet & pset)
+{
+    if (pset.empty())
+        return;
+    Selector selector(pImpl->sack);
+    selector.set(&pset);
+    upgrade(&selector);
+}
+
 void
 Goal::userInstalled(DnfPackage *pkg)
 {
@@ -967,12 +1244,106 @@ Goal::jobLength()
     return (&pImpl->staging)->count / 2;
 }
 
+/* The actions of the jobs as the methods adding them record them, see Goal::getActions(). */
+static DnfGoalActions
+jobActions(Queue *job)
+{
+    int actions = 0;
+    for (int i = 0; i < job->count; i += 2) {
+        Id how = job->elements[i];
+        switch (how & SOLVER_JOBMASK) {
+            case SOLVER_INSTALL:
+                actions |= DNF_INSTALL|DNF_ALLOW_DOWNGRADE;
+                break;
+            case SOLVER_ERASE:
+                actions |= DNF_ERASE;
+                break;
+            case SOLVER_UPDATE:
+                actions |= (how & SOLVER_SELECTMASK) == SOLVER_SOLVABLE_ALL ? DNF_UPGRADE_ALL : DNF_UPGRADE;
+                break;
+            case SOLVER_DISTUPGRADE:
+                actions |= DNF_DISTUPGRADE|DNF_ALLOW_DOWNGRADE;
+                break;
+        }
+    }
+    return static_cast<DnfGoalActions>(actions);
+}
+
+void
+Goal::truncateJobs(int length)
+{
+    if (length < 0)
+        throw Goal::Error(_("negative job length"), DNF_ERROR_INTERNAL_ERROR);
+    if (length >= jobLength())
+        return;
+    queue_truncate(&pImpl->staging, length * 2);
+    // the flags of the last run() are passed again by the next one
+    pImpl->actions = jobActions(&pImpl->staging);
+    if (pImpl->preresolvedEnd > pImpl->staging.count)
+        pImpl->preresolvedBegin = pImpl->preresolvedEnd = -1;
+}
+
 bool
 Goal::run(DnfGoalActions flags)
 {
     auto job = pImpl->constructJob(flags);
     pImpl->actions = static_cast<DnfGoalActions>(pImpl->actions | flags);
     int ret = pImpl->solve(job->getQueue(), flags);
+    if (ret && pImpl->replacePreresolved()) {
+        auto stats = pImpl->stats;
+        job = pImpl->constructJob(flags);
+        ret = pImpl->solve(job->getQueue(), flags);
+        pImpl->stats.solves += stats.solves;
+        pImpl->stats.totalMs += stats.totalMs;
+    }
+    return ret;
+}
+
+/* Replaces the jobs of distupgradePreresolved() in the staging by the plain distupgrade of all
+ * packages. Returns false if there are no such jobs. */
+bool
+Goal::Impl::replacePreresolved()
+{
+    int begin = preresolvedBegin;
+    int end = preresolvedEnd;
+    preresolvedBegin = preresolvedEnd = -1;
+    if (begin < 0)
+        return false;
+
+    IdQueue rest;
+    for (int i = end; i < staging.count; ++i)
+        rest.pushBack(staging.elements[i]);
+    queue_truncate(&staging, begin);
+    Query query(sack);
+    query.available();
+    Selector selector(sack);
+    selector.set(query.runSet());
+    sltrToJob(&selector, &staging, SOLVER_DISTUPGRADE);
+    for (int i = 0; i < rest.size(); ++i)
+        queue_push(&staging, rest[i]);
+    return true;
+}
+
+std::vector<bool>
+Goal::runMany(const std::vector<Goal *> & goals, DnfGoalActions flags)
+{
+    if (goals.empty())
+        return {};
+    DnfSack *sack = goals[0]->pImpl->sack;
+    for (auto goal : goals) {
+        if (goal->pImpl->sack != sack)
+            throw Goal::Error(_("goals of different sacks cannot be run together"),
+                              DNF_ERROR_INTERNAL_ERROR);
+    }
+    // prepare the lazily computed state of the sack once for all the goals
+    dnf_sack_freeze(sack);
+
+    // solver_solve() still appends to the whatprovides arrays of the shared pool, the goals
+    // cannot be solved concurrently
+    std::vector<bool> ret;
+    ret.reserve(goals.size());
+    for (auto goal : goals)
+        ret.push_back(goal->run(flags));
     return ret;
 }
 
@@ -982,6 +1353,47 @@ Goal::countProblems()
     return pImpl->countProblems();
 }
 
+Goal::Stats
+Goal::getStats() const
+{
+    Stats stats = pImpl->stats;
+    Solver *solv = pImpl->solv;
+    if (!solv)
+        return stats;
+    IdQueue decisions;
+    solver_get_decisionqueue(solv, decisions.getQueue());
+    stats.decisions = decisions.size();
+    // the rule table itself is private to libsolv, count the rules behind the decisions
+    // and the problems
+    std::unordered_set<Id> ruleIds;
+    for (int i = 0; i < decisions.size(); ++i) {
+        Id p = decisions[i];
+        Id info = 0;
+        solver_describe_decision(solv, p > 0 ? p : -p, &info);
+        if (info > 0)
+            ruleIds.insert(info);
+    }
+    IdQueue problemRules;
+    for (Id problem = 1; problem <= (Id)solver_problem_count(solv); ++problem) {
+        solver_findallproblemrules(solv, problem, problemRules.getQueue());
+        for (int i = 0; i < problemRules.size(); ++i)
+            ruleIds.insert(problemRules[i]);
+    }
+    for (auto rid : ruleIds) {
+        auto ruleClass = solver_ruleclass(solv, rid);
+        if (ruleClass == SOLVER_RULE_UNKNOWN)
+            continue;
+        ++stats.rules;
+        if (ruleClass == SOLVER_RULE_PKG)
+            ++stats.pkgRules;
+        else if (ruleClass == SOLVER_RULE_JOB)
+            ++stats.jobRules;
+        else if (ruleClass == SOLVER_RULE_LEARNT)
+            ++stats.learntRules;
+    }
+    return stats;
+}
+
 /**
  * Reports packages that has a conflict
  *
@@ -1036,36 +1448,28 @@ Goal::listBrokenDependencyPkgs(DnfPackageState pkg_type)
 std::vector<std::vector<std::string>> Goal::describeAllProblemRules(bool pkgs)
 {
     std::vector<std::vector<std::string>> output;
-    int count_problems = countProblems();
-    for (int i = 0; i < count_problems; i++) {
-        auto problemList = describeProblemRules(i, pkgs);
+    auto problems = getAllProblemRules();
+    if (problems.empty())
+        return output;
+    std::unique_ptr<libdnf::PackageSet> modularExcludes(dnf_sack_get_module_excludes(pImpl->sack));
+    // different rules can still give the same messages, so deduplicate once more on strings
+    std::set<std::vector<std::string>> seen;
+    for (auto & rules : problems) {
+        std::vector<std::string> problemList;
+        std::unordered_set<std::string> uniqueStrings;
+        for (auto & rule : rules) {
+            auto problem_str = pImpl->formatProblemRule(rule, pkgs, modularExcludes.get());
+            if (uniqueStrings.insert(problem_str).second) {
+                problemList.push_back(std::move(problem_str));
+            }
+        }
         if (problemList.empty()) {
             continue;
         }
-        bool unique = true;
-        for (auto & problemsSaved: output) {
-            if (problemList.size() != problemsSaved.size()) {
-                continue;
-            }
-            bool presentElement = false;
-            for (auto & problem: problemList) {
-                presentElement = false;
-                for (auto & problemSaved: problemsSaved) {
-                    if (problemSaved == problem) {
-                        presentElement = true;
-                        break;
-                    }
-                }
-                if (!presentElement) {
-                    break;
-                }
-            }
-            if (presentElement) {
-                unique = false;
-            }
-        }
-        if (unique) {
-            output.push_back(problemList);
+        auto sorted = problemList;
+        std::sort(sorted.begin(), sorted.end());
+        if (seen.insert(std::move(sorted)).second) {
+            output.push_back(std::move(problemList));
         }
     }
     return output;
@@ -1075,56 +1479,70 @@ std::vector<std::string>
 Goal::describeProblemRules(unsigned i, bool pkgs)
 {
     std::vector<std::string> output;
-    /* internal error */
-    if (i >= (unsigned) pImpl->countProblems())
-        return output;
-    // problem is not in libsolv - removal of protected packages
-    auto problem = pImpl->describeProtectedRemoval();
-    if (!problem.empty()) {
-        output.push_back(std::move(problem));
+    auto rules = getProblemRules(i);
+    if (rules.empty())
         return output;
+    std::unique_ptr<libdnf::PackageSet> modularExcludes(dnf_sack_get_module_excludes(pImpl->sack));
+    std::unordered_set<std::string> uniqueStrings;
+    for (auto & rule : rules) {
+        auto problem_str = pImpl->formatProblemRule(rule, pkgs, modularExcludes.get());
+        if (uniqueStrings.insert(problem_str).second) {
+            output.push_back(std::move(problem_str));
+        }
     }
-    auto solv = pImpl->solv;
+    return output;
+}
 
-    Id rid, source, target, dep;
-    SolverRuleinfo type;
-    int j;
-    bool unique;
+std::vector<Goal::ProblemRule>
+Goal::getProblemRules(unsigned i)
+{
+    if (i >= (unsigned) pImpl->countProblems())
+        return {};
+    return pImpl->problemRules(i, !pImpl->describeProtectedRemoval().empty());
+}
 
-    if (i >= solver_problem_count(solv))
+std::vector<std::vector<Goal::ProblemRule>>
+Goal::getAllProblemRules(unsigned maxProblems)
+{
+    std::vector<std::vector<ProblemRule>> output;
+    int count_problems = countProblems();
+    if (count_problems == 0)
         return output;
-
-    IdQueue pq;
-    IdQueue rq;
-    // this libsolv interface indexes from 1 (we do from 0), so:
-    solver_findallproblemrules(solv, i+1, pq.getQueue());
-    std::unique_ptr<libdnf::PackageSet> modularExcludes(dnf_sack_get_module_excludes(pImpl->sack));
-    for (j = 0; j < pq.size(); j++) {
-        rid = pq[j];
-        if (solver_allruleinfos(solv, rid, rq.getQueue())) {
-            for (int ir = 0; ir < rq.size(); ir+=4) {
-                type = static_cast<SolverRuleinfo>(rq[ir]);
-                source = rq[ir + 1];
-                target = rq[ir + 2];
-                dep = rq[ir + 3];
-                auto problem_str = libdnf_problemruleinfo2str(modularExcludes.get(), solv, type,
-                                                              source, target, dep, pkgs);
-                unique = true;
-                for (auto & item: output) {
-                    if (problem_str == item) {
-                        unique = false;
-                        break;
-                    }
-                }
-                if (unique) {
-                    output.push_back(problem_str);
-                }
-            }
-        }
+    // the same for all problems, evaluate only once
+    bool protectedRemoval = !pImpl->describeProtectedRemoval().empty();
+    auto ruleLess = [](const ProblemRule & a, const ProblemRule & b) {
+        return std::tie(a.type, a.source, a.target, a.dep) <
+            std::tie(b.type, b.source, b.target, b.dep);
+    };
+    std::set<std::vector<ProblemRule>,
+             std::function<bool(const std::vector<ProblemRule> &, const std::vector<ProblemRule> &)>>
+        seen([&ruleLess](const std::vector<ProblemRule> & a, const std::vector<ProblemRule> & b) {
+            return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), ruleLess);
+        });
+    for (int i = 0; i < count_problems; i++) {
+        if (maxProblems && output.size() >= maxProblems)
+            break;
+        auto rules = pImpl->problemRules(i, protectedRemoval);
+        if (rules.empty())
+            continue;
+        auto sorted = rules;
+        std::sort(sorted.begin(), sorted.end(), ruleLess);
+        if (seen.insert(std::move(sorted)).second)
+            output.push_back(std::move(rules));
     }
     return output;
 }
 
+std::string
+Goal::formatProblemRule(const ProblemRule & rule, bool pkgs)
+{
+    std::unique_ptr<libdnf::PackageSet> modularExcludes;
+    // only the not installable rule tells modular excludes apart
+    if (rule.type == SOLVER_RULE_PKG_NOT_INSTALLABLE)
+        modularExcludes.reset(dnf_sack_get_module_excludes(pImpl->sack));
+    return pImpl->formatProblemRule(rule, pkgs, modularExcludes.get());
+}
+
 /**
  * Write all the solving decisions to the hawkey logfile.
  */
@@ -1172,6 +1590,359 @@ Goal::writeDebugdata(const char *dir)
     }
 }
 
+static bool
+ruleDepHasProviders(int type)
+{
+    switch (type) {
+        case SOLVER_RULE_PKG_NOTHING_PROVIDES_DEP:
+        case SOLVER_RULE_PKG_REQUIRES:
+        case SOLVER_RULE_PKG_CONFLICTS:
+        case SOLVER_RULE_PKG_OBSOLETES:
+        case SOLVER_RULE_PKG_INSTALLED_OBSOLETES:
+        case SOLVER_RULE_PKG_IMPLICIT_OBSOLETES:
+        case SOLVER_RULE_JOB_NOTHING_PROVIDES_DEP:
+        case SOLVER_RULE_JOB_PROVIDED_BY_SYSTEM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void
+Goal::writeProblemsDebugdata(const char *dir)
+{
+    Solver *solv = pImpl->solv;
+    if (!solv) {
+        throw Goal::Error(_("no solver set"), DNF_ERROR_INTERNAL_ERROR);
+    }
+    g_autofree char *absdir = abspath(dir);
+    if (!absdir) {
+        std::string msg = tfm::format(_("failed to make %s absolute"), dir);
+        throw Goal::Error(msg, DNF_ERROR_FILE_INVALID);
+    }
+    makeDirPath(dir);
+    g_autofree gchar *fn = g_build_filename(absdir, "problems.txt.gz", NULL);
+    g_debug("writing solver problems to %s", fn);
+    FILE *fp = solv_xfopen(fn, "w");
+    if (!fp) {
+        std::string msg = tfm::format(_("failed writing debugdata to %1$s: %2$s"),
+                                      fn, strerror(errno));
+        throw Goal::Error(msg, DNF_ERROR_FILE_INVALID);
+    }
+
+    Pool *pool = solv->pool;
+    Queue *staging = &pImpl->staging;
+    for (int i = 0; i < staging->count; i += 2)
+        fprintf(fp, "job %s\n",
+                testcase_job2str(pool, staging->elements[i], staging->elements[i + 1]));
+
+    PackageSet involved(pImpl->sack);
+    auto problems = getAllProblemRules();
+    for (size_t i = 0; i < problems.size(); ++i) {
+        fprintf(fp, "problem %zu\n", i + 1);
+        for (auto & rule : problems[i]) {
+            fprintf(fp, "  %s\n", formatProblemRule(rule, true).c_str());
+            for (Id p : {rule.source, rule.target}) {
+                if (p > SYSTEMSOLVABLE && p < pool->nsolvables)
+                    involved.set(p);
+            }
+            if (rule.dep && ruleDepHasProviders(rule.type)) {
+                Id p, pp;
+                FOR_PROVIDES(p, pp, rule.dep) {
+                    involved.set(p);
+                }
+            }
+        }
+    }
+
+    const std::pair<Id, const char *> depKeys[] = {
+        {SOLVABLE_PROVIDES, "Prv"}, {SOLVABLE_REQUIRES, "Req"}, {SOLVABLE_CONFLICTS, "Con"},
+        {SOLVABLE_OBSOLETES, "Obs"}, {SOLVABLE_RECOMMENDS, "Rec"},
+        {SOLVABLE_SUPPLEMENTS, "Sup"}};
+    IdQueue deps;
+    Id id = -1;
+    while ((id = involved.next(id)) != -1) {
+        Solvable *s = pool_id2solvable(pool, id);
+        fprintf(fp, "solvable %s\n", testcase_solvid2str(pool, id));
+        for (auto & key : depKeys) {
+            solvable_lookup_deparray(s, key.first, deps.getQueue(), 0);
+            for (int i = 0; i < deps.size(); ++i)
+                fprintf(fp, "  =%s: %s\n", key.second, testcase_dep2str(pool, deps[i]));
+        }
+    }
+
+    if (fclose(fp) != 0) {
+        std::string msg = tfm::format(_("failed writing debugdata to %1$s: %2$s"),
+                                      fn, strerror(errno));
+        throw Goal::Error(msg, DNF_ERROR_FILE_INVALID);
+    }
+}
+
+static const char PLAN_HEADER[] = "libdnf-goal-plan 1";
+
+/// Checksum telling the package is the same on all the hosts, "-" if it has none
+static std::string
+planPackageChecksum(Pool *pool, Id id)
+{
+    Solvable *s = pool_id2solvable(pool, id);
+    Id type;
+    Id key = s->repo == pool->installed ? SOLVABLE_HDRID : SOLVABLE_CHECKSUM;
+    const char *chksum = solvable_lookup_checksum(s, key, &type);
+    return chksum ? chksum : "-";
+}
+
+void
+Goal::writePlan(const char *path)
+{
+    ::Transaction *trans = pImpl->trans;
+    if (!trans)
+        throw Goal::Error(_("no solution to write"), DNF_ERROR_INTERNAL_ERROR);
+    DnfSack *sack = pImpl->sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+
+    PackageSet steps(sack);
+    for (int i = 0; i < trans->steps.count; ++i)
+        steps.set(trans->steps.elements[i]);
+    auto reasons = getReasons(steps);
+
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        std::string msg = tfm::format(_("failed writing plan to %1$s: %2$s"), path,
+                                      strerror(errno));
+        throw Goal::Error(msg, DNF_ERROR_FILE_INVALID);
+    }
+    fprintf(fp, "%s\nactions %d\n", PLAN_HEADER, static_cast<int>(pImpl->actions));
+    Repo *repo;
+    int i;
+    FOR_REPOS(i, repo) {
+        auto checksum = dnf_sack_get_repo_checksum(sack, repo);
+        fprintf(fp, "repo %s %s\n", repo->name, checksum.empty() ? "-" : checksum.c_str());
+    }
+    // installed packages in the steps leave the system, the others are installed
+    for (auto & reason : reasons) {
+        Solvable *s = pool_id2solvable(pool, reason.first);
+        fprintf(fp, "step %s %d %s %s %s\n", s->repo == pool->installed ? "erase" : "install",
+                reason.second, s->repo->name, planPackageChecksum(pool, reason.first).c_str(),
+                pool_solvable2str(pool, s));
+    }
+    if (fclose(fp) != 0) {
+        std::string msg = tfm::format(_("failed writing plan to %1$s: %2$s"), path,
+                                      strerror(errno));
+        throw Goal::Error(msg, DNF_ERROR_FILE_INVALID);
+    }
+}
+
+namespace {
+
+struct PlanStep {
+    bool erase;
+    int reason;
+    std::string repo;
+    std::string checksum;
+    std::string nevra;
+};
+
+}
+
+bool
+Goal::loadPlan(const char *path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::string msg = tfm::format(_("failed reading plan from %1$s: %2$s"), path,
+                                      strerror(errno));
+        throw Goal::Error(msg, DNF_ERROR_FILE_NOT_FOUND);
+    }
+    auto malformed = [path]() {
+        return Goal::Error(tfm::format(_("malformed plan file %s"), path), DNF_ERROR_FILE_INVALID);
+    };
+    std::string line;
+    if (!std::getline(in, line) || line != PLAN_HEADER)
+        throw malformed();
+
+    DnfSack *sack = pImpl->sack;
+    dnf_sack_recompute_considered(sack);
+    dnf_sack_make_provides_ready(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+
+    // every repo of the sack must be in the plan with a known and equal checksum
+    std::map<std::string, std::pair<Repo *, std::string>> repos;
+    Repo *repo;
+    int i;
+    FOR_REPOS(i, repo) {
+        repos[repo->name] = {repo, dnf_sack_get_repo_checksum(sack, repo)};
+    }
+    std::set<std::string> plannedRepos;
+    bool matches = true;
+    int actions = 0;
+    std::vector<PlanStep> steps;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        if (kind == "actions") {
+            if (!(fields >> actions))
+                throw malformed();
+        } else if (kind == "repo") {
+            std::string name, checksum;
+            if (!(fields >> name >> checksum))
+                throw malformed();
+            auto it = repos.find(name);
+            if (it == repos.end() || it->second.second.empty() || it->second.second != checksum)
+                matches = false;
+            plannedRepos.insert(name);
+        } else if (kind == "step") {
+            PlanStep step;
+            std::string type;
+            if (!(fields >> type >> step.reason >> step.repo >> step.checksum >> step.nevra) ||
+                (type != "erase" && type != "install"))
+                throw malformed();
+            step.erase = type == "erase";
+            steps.push_back(std::move(step));
+        } else if (!kind.empty()) {
+            throw malformed();
+        }
+    }
+    if (!matches || plannedRepos.size() != repos.size()) {
+        g_debug("plan %s was made for other repos", path);
+        return false;
+    }
+
+    // the repos are the same, so are their packages, the checks only guard against a broken plan
+    std::map<std::string, std::unordered_map<std::string, Id>> nevrasByRepo;
+    std::map<Id, int> reasons;
+    IdQueue decisions;
+    for (auto & step : steps) {
+        auto it = repos.find(step.repo);
+        if (it == repos.end())
+            return false;
+        repo = it->second.first;
+        if ((repo == pool->installed) != step.erase)
+            return false;
+        auto & nevras = nevrasByRepo[step.repo];
+        if (nevras.empty()) {
+            Id p;
+            Solvable *s;
+            FOR_REPO_SOLVABLES(repo, p, s) {
+                nevras.emplace(pool_solvable2str(pool, s), p);
+            }
+        }
+        auto nevraIt = nevras.find(step.nevra);
+        if (nevraIt == nevras.end())
+            return false;
+        Id id = nevraIt->second;
+        if ((pool->considered && !MAPTST(pool->considered, id)) ||
+            planPackageChecksum(pool, id) != step.checksum) {
+            g_debug("plan %s: package %s differs", path, step.nevra.c_str());
+            return false;
+        }
+        decisions.pushBack(step.erase ? -id : id);
+        reasons[id] = step.reason;
+    }
+
+    // same as the decisions of a solver, installonly packages do not obsolete their other versions
+    Map multiversion;
+    map_init(&multiversion, pool->nsolvables);
+    Queue *installonly = dnf_sack_get_installonly(sack);
+    for (int j = 0; j < installonly->count; ++j) {
+        Id p, pp;
+        FOR_PROVIDES(p, pp, installonly->elements[j]) {
+            MAPSET(&multiversion, p);
+        }
+    }
+    ::Transaction *trans = transaction_create_decisionq(pool, decisions.getQueue(), &multiversion);
+    map_free(&multiversion);
+
+    if (pImpl->trans)
+        transaction_free(pImpl->trans);
+    pImpl->trans = trans;
+    if (pImpl->solv) {
+        solver_free(pImpl->solv);
+        pImpl->solv = nullptr;
+    }
+    pImpl->resetResults();
+    pImpl->removalOfProtected.reset();
+    pImpl->plannedReasons = std::move(reasons);
+    pImpl->stats = Goal::Stats();
+    pImpl->actions = static_cast<DnfGoalActions>(pImpl->actions | actions);
+    return true;
+}
+
+void
+Goal::Impl::classifyResults()
+{
+    resultsByType.clear();
+    resultsObsoleted.reset(new PackageSet(sack));
+    const int common_mode = SOLVER_TRANSACTION_SHOW_OBSOLETES |
+        SOLVER_TRANSACTION_CHANGE_IS_REINSTALL;
+
+    for (int i = 0; i < trans->steps.count; ++i) {
+        Id p = trans->steps.elements[i];
+
+        if (transaction_type(trans, p, common_mode) == SOLVER_TRANSACTION_OBSOLETED)
+            resultsObsoleted->set(p);
+
+        Id type = transaction_type(trans, p, common_mode |
+                                   SOLVER_TRANSACTION_SHOW_ACTIVE|
+                                   SOLVER_TRANSACTION_SHOW_ALL);
+        auto it = resultsByType.find(type);
+        if (it == resultsByType.end())
+            it = resultsByType.emplace(type, PackageSet(sack)).first;
+        it->second.set(p);
+    }
+}
+
+void
+Goal::Impl::resetResults()
+{
+    resultsByType.clear();
+    resultsObsoleted.reset();
+    unneeded.reset();
+    suggested.reset();
+}
+
+/* Compares the packages decided to be installed and the userinstalled jobs of the solver with
+ * those recorded for lastUnneeded and lastSuggested, and records the current ones on a change.
+ * Both lists depend only on them, so a re-run whose additional jobs are already satisfied can
+ * reuse them. */
+bool
+Goal::Impl::sameSolverState()
+{
+    if (!solv) {
+        throw Goal::Error(_("no solv in the goal"), DNF_ERROR_INTERNAL_ERROR);
+    }
+    auto decided = std::unique_ptr<PackageSet>(new PackageSet(sack));
+    IdQueue decisions;
+    solver_get_decisionqueue(solv, decisions.getQueue());
+    for (int i = 0; i < decisions.size(); ++i) {
+        Id p = decisions[i];
+        if (p > 0 && p != SYSTEMSOLVABLE) {
+            decided->set(p);
+        }
+    }
+    std::vector<Id> userInstalled;
+    for (int i = 0; i < solv->job.count; i += 2) {
+        if ((solv->job.elements[i] & SOLVER_JOBMASK) == SOLVER_USERINSTALLED) {
+            userInstalled.push_back(solv->job.elements[i]);
+            userInstalled.push_back(solv->job.elements[i + 1]);
+        }
+    }
+    auto generation = dnf_sack_get_generation(sack);
+    if (lastDecided && lastGeneration == generation && lastUserInstalled == userInstalled) {
+        Map *last = lastDecided->getMap();
+        Map *current = decided->getMap();
+        if (last->size == current->size && memcmp(last->map, current->map, current->size) == 0) {
+            return true;
+        }
+    }
+    lastDecided = std::move(decided);
+    lastUserInstalled = std::move(userInstalled);
+    lastGeneration = generation;
+    lastUnneeded.reset();
+    lastSuggested.reset();
+    return false;
+}
+
 PackageSet
 Goal::Impl::listResults(Id type_filter1, Id type_filter2)
 {
@@ -1186,27 +1957,21 @@ Goal::Impl::listResults(Id type_filter1, Id type_filter2)
         throw Goal::Error(_("no solution possible"), DNF_ERROR_NO_SOLUTION);
     }
 
-    PackageSet plist(sack);
-    const int common_mode = SOLVER_TRANSACTION_SHOW_OBSOLETES |
-        SOLVER_TRANSACTION_CHANGE_IS_REINSTALL;
+    if (!resultsObsoleted)
+        classifyResults();
 
-    for (int i = 0; i < trans->steps.count; ++i) {
-        Id p = trans->steps.elements[i];
-        Id type;
+    // obsoleted packages are classified without SOLVER_TRANSACTION_SHOW_ACTIVE, the only
+    // caller asking for them passes no second type
+    if (type_filter1 == SOLVER_TRANSACTION_OBSOLETED)
+        return *resultsObsoleted;
 
-        switch (type_filter1) {
-        case SOLVER_TRANSACTION_OBSOLETED:
-            type =  transaction_type(trans, p, common_mode);
-            break;
-        default:
-            type  = transaction_type(trans, p, common_mode |
-                                     SOLVER_TRANSACTION_SHOW_ACTIVE|
-                                     SOLVER_TRANSACTION_SHOW_ALL);
-            break;
-        }
-
-        if (type == type_filter1 || (type_filter2 && type == type_filter2))
-            plist.set(p);
+    PackageSet plist(sack);
+    for (Id type : {type_filter1, type_filter2}) {
+        if (!type)
+            continue;
+        auto it = resultsByType.find(type);
+        if (it != resultsByType.end())
+            plist += it->second;
     }
     return plist;
 }
@@ -1238,25 +2003,35 @@ Goal::listReinstalls()
 PackageSet
 Goal::listUnneeded()
 {
-    PackageSet pset(pImpl->sack);
-    IdQueue queue;
-    Solver *solv = pImpl->solv;
-
-    solver_get_unneeded(solv, queue.getQueue(), 0);
-    queue2pset(queue, &pset);
-    return pset;
+    if (pImpl->unneeded) {
+        return *pImpl->unneeded;
+    }
+    if (!pImpl->sameSolverState() || !pImpl->lastUnneeded) {
+        auto pset = std::unique_ptr<PackageSet>(new PackageSet(pImpl->sack));
+        IdQueue queue;
+        solver_get_unneeded(pImpl->solv, queue.getQueue(), 0);
+        queue2pset(queue, pset.get());
+        pImpl->lastUnneeded = std::move(pset);
+    }
+    pImpl->unneeded.reset(new PackageSet(*pImpl->lastUnneeded));
+    return *pImpl->unneeded;
 }
 
 PackageSet
 Goal::listSuggested()
 {
-    PackageSet pset(pImpl->sack);
-    IdQueue queue;
-    Solver *solv = pImpl->solv;
-
-    solver_get_recommendations(solv, NULL, queue.getQueue(), 0);
-    queue2pset(queue, &pset);
-    return pset;
+    if (pImpl->suggested) {
+        return *pImpl->suggested;
+    }
+    if (!pImpl->sameSolverState() || !pImpl->lastSuggested) {
+        auto pset = std::unique_ptr<PackageSet>(new PackageSet(pImpl->sack));
+        IdQueue queue;
+        solver_get_recommendations(pImpl->solv, NULL, queue.getQueue(), 0);
+        queue2pset(queue, pset.get());
+        pImpl->lastSuggested = std::move(pset);
+    }
+    pImpl->suggested.reset(new PackageSet(*pImpl->lastSuggested));
+    return *pImpl->suggested;
 }
 
 PackageSet
@@ -1386,6 +2161,12 @@ Solver *
 Goal::Impl::initSolver()
 {
     Pool *pool = dnf_sack_get_pool(sack);
+    // solver_solve() keeps the package rules of the previous run and only adds
+    // the missing ones, valid as long as nothing in the sack changed
+    auto generation = dnf_sack_get_generation(sack);
+    if (reuseSolver && solv && solverGeneration == generation)
+        return solv;
+    solverGeneration = generation;
     Solver *solvNew = solver_create(pool);
 
     if (solv)
@@ -1412,6 +2193,190 @@ Goal::Impl::initSolver()
     return solv;
 }
 
+/* Pushes the jobs keeping the limit of the newest and the running kernel packages of the
+ * installonly packages q will be installed, sorting q. Returns whether some were pushed. */
+static bool
+installonly_limit_jobs(Pool *pool, Id running_kernel, int limit, IdQueue & q, Queue *job)
+{
+    bool pushed = false;
+    struct InstallonliesSortCallback s_cb = {pool, running_kernel};
+    solv_sort(q.data(), q.size(), sizeof(q[0]), sort_packages, &s_cb);
+    IdQueue same_names;
+    while (q.size() > 0) {
+        same_name_subqueue(pool, q.getQueue(), same_names.getQueue());
+        if (same_names.size() <= limit)
+            continue;
+        pushed = true;
+        for (int j = 0; j < same_names.size(); ++j) {
+            Id id  = same_names[j];
+            Id action = SOLVER_ERASE;
+            if (j < limit)
+                action = SOLVER_INSTALL;
+            queue_push2(job, action | SOLVER_SOLVABLE, id);
+        }
+    }
+    return pushed;
+}
+
+/* The newest available solvable of the name and arch of installed, if it is newer than every
+ * installed one and it is the only one of the best priority and version, else 0. */
+static Id
+installonly_update_candidate(DnfSack *sack, Solvable *installed)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Id newest = 0;
+    Id best = 0;
+    bool tie = false;
+    auto range = dnf_sack_solvables_with_name(sack, installed->name);
+    for (auto id = range.first; id != range.second; ++id) {
+        Solvable *s = pool_id2solvable(pool, *id);
+        if (s->arch != installed->arch)
+            continue;
+        if (s->repo == pool->installed) {
+            if (!newest || pool_evrcmp(pool, s->evr, pool_id2solvable(pool, newest)->evr,
+                                       EVRCMP_COMPARE) > 0)
+                newest = *id;
+            continue;
+        }
+        if (pool->considered && !MAPTST(pool->considered, *id))
+            continue;
+        if (!best) {
+            best = *id;
+            continue;
+        }
+        Solvable *b = pool_id2solvable(pool, best);
+        int cmp = s->repo->priority - b->repo->priority;
+        if (!cmp)
+            cmp = pool_evrcmp(pool, s->evr, b->evr, EVRCMP_COMPARE);
+        if (cmp > 0) {
+            best = *id;
+            tie = false;
+        } else if (!cmp)
+            tie = true;
+    }
+    if (!best || tie)
+        return 0;
+    if (pool_evrcmp(pool, pool_id2solvable(pool, best)->evr,
+                    pool_id2solvable(pool, newest)->evr, EVRCMP_COMPARE) <= 0)
+        return 0;
+    return best;
+}
+
+/**
+* @brief Computes the jobs limitInstallonlyPackages() would add after the first solve from the
+* installed packages and the installonly packages the job installs: explicitly requested
+* solvables and, for an upgrade of all packages, the newest version of each installed name and
+* arch. Returns false when the job may let the solver decide on installonly packages in other
+* ways, e.g. by erasing them or by a selection of several of them; the limit is then applied
+* after the solve only.
+*/
+bool
+Goal::Impl::precomputeInstallonlyJobs(Queue *job, Queue *limitJobs)
+{
+    int limit = static_cast<int>(dnf_sack_get_installonly_limit(sack));
+    if (!limit)
+        return false;
+
+    Queue *onlies = dnf_sack_get_installonly(sack);
+    Pool *pool = dnf_sack_get_pool(sack);
+    if (!pool->installed || !onlies->count)
+        return false;
+    PackageSet installonly(sack);
+    for (int i = 0; i < onlies->count; ++i) {
+        Id p, pp;
+        FOR_PKG_PROVIDES(p, pp, onlies->elements[i])
+            installonly.set(p);
+    }
+
+    PackageSet installing(sack);
+    IdQueue selection, matches;
+    for (int i = 0; i < job->count; i += 2) {
+        Id how = job->elements[i];
+        Id what = job->elements[i + 1];
+        Id action = how & SOLVER_JOBMASK;
+        if (action == SOLVER_MULTIVERSION || action == SOLVER_EXCLUDEFROMWEAK ||
+            action == SOLVER_USERINSTALLED || action == SOLVER_FAVOR ||
+            action == SOLVER_DISFAVOR || action == SOLVER_LOCK)
+            continue;
+        if (action != SOLVER_INSTALL && action != SOLVER_UPDATE && action != SOLVER_ALLOWUNINSTALL)
+            return false;
+        if (action == SOLVER_UPDATE && (how & SOLVER_SELECTMASK) == SOLVER_SOLVABLE_ALL) {
+            Id p;
+            Solvable *s;
+            FOR_REPO_SOLVABLES(pool->installed, p, s) {
+                if (!installonly.has(p))
+                    continue;
+                Id candidate = installonly_update_candidate(sack, s);
+                if (candidate)
+                    installing.set(candidate);
+            }
+            continue;
+        }
+        selection.clear();
+        selection.pushBack(how, what);
+        matches.clear();
+        selection_solvables(pool, selection.getQueue(), matches.getQueue());
+        int ninstallonly = 0;
+        Id match = 0;
+        for (int j = 0; j < matches.size(); ++j) {
+            if (installonly.has(matches[j])) {
+                ++ninstallonly;
+                match = matches[j];
+            }
+        }
+        if (!ninstallonly)
+            continue;
+        // only an exact install of a not yet installed package is predictable
+        if (action != SOLVER_INSTALL || matches.size() != 1 ||
+            pool_id2solvable(pool, match)->repo == pool->installed)
+            return false;
+        installing.set(match);
+    }
+    if (installing.empty())
+        return false;
+
+    Id running_kernel = dnf_sack_running_kernel(sack);
+    bool pushed = false;
+    for (int i = 0; i < onlies->count; ++i) {
+        Id p, pp;
+        IdQueue q;
+        bool installs = false;
+        FOR_PKG_PROVIDES(p, pp, onlies->elements[i]) {
+            if (installing.has(p))
+                installs = true;
+            else if (pool_id2solvable(pool, p)->repo != pool->installed)
+                continue;
+            q.pushBack(p);
+        }
+        if (installs && q.size() > limit &&
+            installonly_limit_jobs(pool, running_kernel, limit, q, limitJobs))
+            pushed = true;
+    }
+    if (!pushed)
+        return false;
+
+    // like the second solve, allow erasing the packages depending on an erased one
+    IdQueue erased;
+    for (int i = 0; i < limitJobs->count; i += 2) {
+        if ((limitJobs->elements[i] & SOLVER_JOBMASK) == SOLVER_ERASE)
+            erased.pushBack(limitJobs->elements[i + 1]);
+    }
+    Id protected_kernel = protectedRunningKernel();
+    Id p;
+    Solvable *s;
+    FOR_REPO_SOLVABLES(pool->installed, p, s) {
+        if (p == protected_kernel || (protectedPkgs && protectedPkgs->has(p)))
+            continue;
+        for (int i = 0; i < erased.size(); ++i) {
+            if (can_depend_on(pool, s, erased[i])) {
+                queue_push2(limitJobs, SOLVER_ALLOWUNINSTALL | SOLVER_SOLVABLE, p);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
 int
 Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
 {
@@ -1420,6 +2385,7 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
 
     Queue *onlies = dnf_sack_get_installonly(sack);
     Pool *pool = dnf_sack_get_pool(sack);
+    int limit = static_cast<int>(dnf_sack_get_installonly_limit(sack));
     int reresolve = 0;
 
     for (int i = 0; i < onlies->count; ++i) {
@@ -1429,7 +2395,7 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
         FOR_PKG_PROVIDES(p, pp, onlies->elements[i])
             if (solver_get_decisionlevel(solv, p) > 0)
                 q.pushBack(p);
-        if (q.size() <= (int) dnf_sack_get_installonly_limit(sack)) {
+        if (q.size() <= limit) {
             continue;
         }
         for (int k = 0; k < q.size(); ++k) {
@@ -1444,22 +2410,8 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
             continue;
         }
 
-        struct InstallonliesSortCallback s_cb = {pool, dnf_sack_running_kernel(sack)};
-        solv_sort(q.data(), q.size(), sizeof(q[0]), sort_packages, &s_cb);
-        IdQueue same_names;
-        while (q.size() > 0) {
-            same_name_subqueue(pool, q.getQueue(), same_names.getQueue());
-            if (same_names.size() <= (int) dnf_sack_get_installonly_limit(sack))
-                continue;
+        if (installonly_limit_jobs(pool, dnf_sack_running_kernel(sack), limit, q, job))
             reresolve = 1;
-            for (int j = 0; j < same_names.size(); ++j) {
-                Id id  = same_names[j];
-                Id action = SOLVER_ERASE;
-                if (j < (int) dnf_sack_get_installonly_limit(sack))
-                    action = SOLVER_INSTALL;
-                queue_push2(job, action | SOLVER_SOLVABLE, id);
-            }
-        }
     }
     return reresolve;
 }
@@ -1467,14 +2419,33 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
 bool
 Goal::Impl::solve(Queue *job, DnfGoalActions flags)
 {
+    stats = Goal::Stats();
+    stats.jobs = job->count / 2;
+    LIBDNF_PROBE(goal_solve_start, stats.jobs);
+    auto start = std::chrono::steady_clock::now();
+    bool ret = runSolver(job, flags);
+    stats.totalMs = elapsedMs(start);
+    LIBDNF_PROBE(goal_solve_end, static_cast<int>(ret), stats.solves);
+    return ret;
+}
+
+bool
+Goal::Impl::runSolver(Queue *job, DnfGoalActions flags)
+{
+    auto start = std::chrono::steady_clock::now();
     /* apply the excludes */
     dnf_sack_recompute_considered(sack);
+    stats.recomputeConsideredMs = elapsedMs(start);
 
+    start = std::chrono::steady_clock::now();
     dnf_sack_make_provides_ready(sack);
+    stats.makeProvidesReadyMs = elapsedMs(start);
     if (trans) {
         transaction_free(trans);
         trans = NULL;
     }
+    resetResults();
+    plannedReasons.clear();
 
     Solver *solv = initSolver();
 
@@ -1485,24 +2456,48 @@ Goal::Impl::solve(Queue *job, DnfGoalActions flags)
         }
     }
 
-    if (DNF_IGNORE_WEAK_DEPS & flags)
-        solver_set_flag(solv, SOLVER_FLAG_IGNORE_RECOMMENDED, 1);
-
-    if (DNF_ALLOW_DOWNGRADE & actions)
-        solver_set_flag(solv, SOLVER_FLAG_ALLOW_DOWNGRADE, 1);
-
-    if (solver_solve(solv, job))
+    // set both ways, a reused solver keeps the flags of the previous run
+    solver_set_flag(solv, SOLVER_FLAG_IGNORE_RECOMMENDED, DNF_IGNORE_WEAK_DEPS & flags ? 1 : 0);
+    solver_set_flag(solv, SOLVER_FLAG_ALLOW_DOWNGRADE, DNF_ALLOW_DOWNGRADE & actions ? 1 : 0);
+
+    // the installonly limit goes into the first solve when it is predictable
+    start = std::chrono::steady_clock::now();
+    const int njobs = job->count;
+    IdQueue limitJobs;
+    const bool precomputed = precomputeInstallonlyJobs(job, limitJobs.getQueue());
+    for (int i = 0; i < limitJobs.size(); ++i)
+        queue_push(job, limitJobs[i]);
+    stats.installonlyMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    ++stats.solves;
+    int problems = solver_solve(solv, job);
+    if (problems && precomputed) {
+        // e.g. the predicted package is not installable, leave the limit to the pass after the solve
+        queue_truncate(job, njobs);
+        ++stats.solves;
+        problems = solver_solve(solv, job);
+    }
+    stats.solveMs = elapsedMs(start);
+    if (problems)
         return true;
     // either allow solutions callback or installonlies, both at the same time
     // are not supported
+    start = std::chrono::steady_clock::now();
     if (limitInstallonlyPackages(solv, job)) {
         // allow erasing non-installonly packages that depend on a kernel about
         // to be erased
         allowUninstallAllButProtected(job, DNF_ALLOW_UNINSTALL);
-        if (solver_solve(solv, job))
-            return true;
+        ++stats.solves;
+        problems = solver_solve(solv, job);
     }
+    stats.installonlyMs += elapsedMs(start);
+    if (problems)
+        return true;
+
+    start = std::chrono::steady_clock::now();
     trans = solver_create_transaction(solv);
+    stats.createTransactionMs = elapsedMs(start);
 
     if (protectedInRemovals())
         return true;
@@ -1543,6 +2538,9 @@ Goal::Impl::conflictPkgs(unsigned i)
 int
 Goal::Impl::countProblems()
 {
+    // a loaded plan is a solution
+    if (!solv && trans)
+        return 0;
     assert(solv);
     size_t protectedSize = removalOfProtected ? removalOfProtected->size() : 0;
     return solver_problem_count(solv) + MIN(1, protectedSize);
@@ -1615,30 +2613,23 @@ Goal::Impl::protectedRunningKernel()
 bool
 Goal::Impl::protectedInRemovals()
 {
-    guint i = 0;
-    bool ret = false;
     if ((!protectedPkgs || !protectedPkgs->size()) && !protect_running_kernel)
         return false;
     auto pkgRemoveList = listResults(SOLVER_TRANSACTION_ERASE, 0);
     auto pkgObsoleteList = listResults(SOLVER_TRANSACTION_OBSOLETED, 0);
-    map_or(pkgRemoveList.getMap(), pkgObsoleteList.getMap());
+    pkgRemoveList += pkgObsoleteList;
 
-    removalOfProtected.reset(new PackageSet(pkgRemoveList));
-    Id id = -1;
     Id protected_kernel = protectedRunningKernel();
-    while(true) {
-        id = removalOfProtected->next(id);
-        if (id == -1)
-            break;
-
-        if (protectedPkgs->has(id) || id == protected_kernel) {
-            ret = true;
-            i++;
-        } else {
-            removalOfProtected->remove(id);
-        }
+    bool kernelRemoved = protected_kernel > 0 && pkgRemoveList.has(protected_kernel);
+    if (protectedPkgs) {
+        pkgRemoveList /= *protectedPkgs;
+    } else {
+        pkgRemoveList.clear();
     }
-    return ret;
+    if (kernelRemoved)
+        pkgRemoveList.set(protected_kernel);
+    removalOfProtected.reset(new PackageSet(std::move(pkgRemoveList)));
+    return !removalOfProtected->empty();
 }
 
 /**
@@ -1665,14 +2656,20 @@ Goal::Impl::describeProtectedRemoval()
                 std::string(names[0]), [](std::string a, std::string b) { return a + ", " + b; });
     }
     auto pset = brokenDependencyAllPkgs(DNF_PACKAGE_STATE_INSTALLED);
-    Id id = -1;
     Id protected_kernel = protectedRunningKernel();
+    bool kernelBroken = protected_kernel > 0 && pset->has(protected_kernel);
+    if (protectedPkgs) {
+        *pset /= *protectedPkgs;
+    } else {
+        pset->clear();
+    }
+    if (kernelBroken)
+        pset->set(protected_kernel);
+    Id id = -1;
     std::vector<const char *> names;
     while((id = pset->next(id)) != -1) {
-        if (protectedPkgs->has(id) || id == protected_kernel) {
-            Solvable * s = pool_id2solvable(pool, id);
-            names.push_back(pool_id2str(pool, s->name));
-        }
+        Solvable * s = pool_id2solvable(pool, id);
+        names.push_back(pool_id2str(pool, s->name));
     }
     if (names.empty())
         return {};
@@ -1680,4 +2677,45 @@ Goal::Impl::describeProtectedRemoval()
                            [](std::string a, std::string b) { return a + ", " + b; });
 }
 
+std::vector<Goal::ProblemRule>
+Goal::Impl::problemRules(unsigned i, bool protectedRemoval)
+{
+    std::vector<Goal::ProblemRule> output;
+    /* internal error */
+    if (i >= (unsigned) countProblems())
+        return output;
+    // problem is not in libsolv - removal of protected packages
+    if (protectedRemoval) {
+        output.push_back({Goal::ProblemRule::PROTECTED_REMOVAL, 0, 0, 0});
+        return output;
+    }
+    if (i >= solver_problem_count(solv))
+        return output;
+
+    IdQueue pq;
+    IdQueue rq;
+    // this libsolv interface indexes from 1 (we do from 0), so:
+    solver_findallproblemrules(solv, i+1, pq.getQueue());
+    for (int j = 0; j < pq.size(); j++) {
+        if (!solver_allruleinfos(solv, pq[j], rq.getQueue()))
+            continue;
+        for (int ir = 0; ir < rq.size(); ir += 4) {
+            Goal::ProblemRule rule{rq[ir], rq[ir + 1], rq[ir + 2], rq[ir + 3]};
+            if (std::find(output.begin(), output.end(), rule) == output.end())
+                output.push_back(rule);
+        }
+    }
+    return output;
+}
+
+std::string
+Goal::Impl::formatProblemRule(const Goal::ProblemRule & rule, bool pkgs,
+                              PackageSet * modularExcludes)
+{
+    if (rule.type == Goal::ProblemRule::PROTECTED_REMOVAL)
+        return describeProtectedRemoval();
+    return libdnf_problemruleinfo2str(modularExcludes, solv, static_cast<SolverRuleinfo>(rule.type),
+                                      rule.source, rule.target, rule.dep, pkgs);
+}
+
 }
@@ -21,10 +21,13 @@
 #ifndef __GOAL_HPP
 #define __GOAL_HPP
 
+#include <map>
 #include <memory>
 #include <stdexcept>
 #include <vector>
 
+#include <solv/pooltypes.h>
+
 #include "../dnf-types.h"
 #include "../error.hpp"
 #include "../hy-goal.h"
@@ -42,6 +45,45 @@ public:
         int errCode;
     };
 
+    /**
+    * @brief Timings in milliseconds and counts of the last run(). Rule creation happens inside
+    * solver_solve() and is part of solveMs. The rule counts cover the rules behind the decisions
+    * and the problems, not every rule the solver created.
+    */
+    struct Stats {
+        double recomputeConsideredMs{0};
+        double makeProvidesReadyMs{0};
+        double solveMs{0};
+        double installonlyMs{0};        // limiting installonly packages including the re-solve
+        double createTransactionMs{0};
+        double totalMs{0};
+        int jobs{0};
+        int solves{0};
+        int decisions{0};
+        int rules{0};
+        int pkgRules{0};
+        int jobRules{0};
+        int learntRules{0};
+    };
+
+    /**
+    * @brief Unformatted rule of a solving problem. The type is a SolverRuleinfo value, or
+    * PROTECTED_REMOVAL for the removal of protected packages that is detected by libdnf itself.
+    */
+    struct ProblemRule {
+        static constexpr int PROTECTED_REMOVAL = -1;
+
+        int type;
+        Id source;
+        Id target;
+        Id dep;
+
+        bool operator==(const ProblemRule & other) const noexcept {
+            return type == other.type && source == other.source && target == other.target &&
+                dep == other.dep;
+        }
+    };
+
     Goal(DnfSack *sack);
     Goal(const Goal & goal_src);
     Goal(Goal && goal_src) = delete;
@@ -49,14 +91,27 @@ public:
 
     DnfGoalActions getActions();
     int getReason(DnfPackage *pkg);
+    /**
+    * @brief Returns the reasons of the packages like getReason() does, by their ids. The clean
+    * dependencies of the solution are resolved only once for all of them.
+    */
+    std::map< Id, int > getReasons(const PackageSet & pset);
     DnfSack * getSack();
 
-    void addProtected(PackageSet & pset);
+    void addProtected(const PackageSet & pset);
     void setProtected(const PackageSet & pset);
 
     bool get_protect_running_kernel() const noexcept;
     void set_protect_running_kernel(bool value);
 
+    /**
+    * @brief Keep the solver between runs. libsolv then only extends the package rules of the
+    * previous run instead of creating them again, which makes repeated runs with slightly
+    * different jobs cheap. The solver is created anew whenever the sack changed in between.
+    */
+    bool getReuseSolver() const noexcept;
+    void setReuseSolver(bool value);
+
     void distupgrade();
     void distupgrade(DnfPackage *new_pkg);
 
@@ -64,6 +119,17 @@ public:
     * @brief If selector ill formed, it rises std::runtime_error()
     */
     void distupgrade(HySelector);
+
+    /**
+    * @brief Same as distupgrade() for all packages, but the installed packages whose only
+    * sensible target is the newest available package of the same name are upgraded to it
+    * directly. That applies to a package which is the only installed one of its name, is not
+    * installonly nor obsoleted, and whose available versions come from repos of one priority
+    * with a unique newest version that upgrades it and obsoletes nothing. The solver then only
+    * has to choose for the remaining packages (renames, obsoletes, downgrades, ...). If the
+    * preresolved jobs have no solution, run() solves again with the plain distupgrade().
+    */
+    void distupgradePreresolved();
     void erase(DnfPackage *pkg, int flags = 0);
 
     /**
@@ -73,7 +139,18 @@ public:
     * @param flags p_flags:...
     */
     void erase(HySelector sltr, int flags);
+
+    /**
+    * @brief Erase all packages of the set with a single job
+    */
+    void erase(const PackageSet & pset, int flags = 0);
     void install(DnfPackage *new_pkg, bool optional);
+
+    /**
+    * @brief Install every package of the set, same as calling install(DnfPackage *) for each of
+    * them but without creating a whatprovides entry per package
+    */
+    void install(const PackageSet & pset, bool optional);
     void lock(DnfPackage *new_pkg);
     void favor(DnfPackage *new_pkg);
     void add_exclude_from_weak(const DnfPackageSet & pset);
@@ -105,6 +182,12 @@ public:
     * installed and available packages of the foo must be in selector plus obsoletes of foo.
     */
     void upgrade(HySelector sltr);
+
+    /**
+    * @brief Upgrade to the packages of the set in a single job, like upgrade(HySelector) with
+    * a selector of these packages
+    */
+    void upgrade(const PackageSet & pset);
     void userInstalled(DnfPackage *pkg);
     void userInstalled(PackageSet & pset);
 
@@ -113,9 +196,29 @@ public:
 
     int jobLength();
 
+    /**
+    * @brief Drops the jobs added after the first 'length' ones, see jobLength(). Together with
+    * setReuseSolver() it allows trying variants of a base request.
+    */
+    void truncateJobs(int length);
+
     /* resolving the goal */
     bool run(DnfGoalActions flags);
 
+    /**
+    * @brief Runs independent goals of one sack one after another. The sack is frozen once
+    * before the first goal, see dnf_sack_freeze(), so the goals do not recompute its lazily
+    * prepared state. The goals share the libsolv pool and are not solved concurrently.
+    * Results and problems are read from the individual goals afterwards.
+    *
+    * @param goals goals sharing the same sack
+    * @param flags flags passed to every run()
+    * @return std::vector<bool> values returned by run() of the goals, true means a problem
+    */
+    static std::vector<bool> runMany(const std::vector<Goal *> & goals, DnfGoalActions flags);
+
+    Stats getStats() const;
+
     /* problems */
     int countProblems();
 
@@ -133,14 +236,63 @@ public:
     * @return char**
     */
     std::vector<std::string> describeProblemRules(unsigned i, bool pkgs);
+
+    /**
+    * @brief Rules of problem 'i' without duplicates, nothing is formatted
+    */
+    std::vector<ProblemRule> getProblemRules(unsigned i);
+
+    /**
+    * @brief Rules of all problems, problems made of the same rules are listed only once
+    *
+    * @param maxProblems stop after this number of unique problems, 0 means no limit
+    */
+    std::vector<std::vector<ProblemRule>> getAllProblemRules(unsigned maxProblems = 0);
+
+    /**
+    * @brief Message of a single rule as used by describeProblemRules()
+    *
+    * @param pkgs if true packages problem messages, othewise module messages are used
+    */
+    std::string formatProblemRule(const ProblemRule & rule, bool pkgs);
     int logDecisions();
     void writeDebugdata(const char *dir);
 
+    /**
+    * @brief Writes a gzip compressed report of the failed solve to dir/problems.txt.gz. Unlike
+    * writeDebugdata() it does not dump the whole pool, only the jobs, the problems and the
+    * solvables involved in their rules together with their dependencies.
+    */
+    void writeProblemsDebugdata(const char *dir);
+
+    /**
+    * @brief Writes the result of the last successful run() to a plan file: the transaction steps
+    * with the checksums of their packages and their reasons, and the checksums of all the repos
+    * loaded into the sack, the rpmdb cookie included. Goals on hosts in the same state can load
+    * it with loadPlan() instead of solving.
+    */
+    void writePlan(const char *path);
+
+    /**
+    * @brief Loads a plan written by writePlan() in place of run(). Nothing is solved, the results
+    * and reasons are those of the plan. If the repos of the sack, their checksums or the packages
+    * of the steps differ from the plan, false is returned without changing the goal and run() is
+    * to be used instead. The configuration of the solving (jobs, excludes, installonly packages,
+    * ...) is not recorded, the plan must be made with the same. listUnneeded() and
+    * listSuggested() need a solved goal.
+    */
+    bool loadPlan(const char *path);
+
     /* result processing */
     PackageSet listErasures();
     PackageSet listInstalls();
     PackageSet listObsoleted();
     PackageSet listReinstalls();
+    /**
+    * @brief The unneeded and the suggested packages of the last run(). Both are computed once per
+    * solve, and a re-run whose decisions and userinstalled jobs did not change in an unchanged sack
+    * (e.g. additional jobs that are already satisfied) gives the previous results without computing.
+    */
     PackageSet listUnneeded();
     PackageSet listSuggested();
     PackageSet listUpgrades();
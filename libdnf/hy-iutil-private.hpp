@@ -25,6 +25,7 @@
 #include "hy-types.h"
 #include "sack/packageset.hpp"
 #include <array>
+#include <string>
 #include <utility>
 
 // Use 8 bytes for libsolv version (API: solv_toolversion)
@@ -33,19 +34,24 @@ static constexpr const size_t solv_userdata_solv_toolversion_size{8};
 static constexpr const std::array<char, 4> solv_userdata_magic{'\0', 'd', 'n', 'f'};
 static constexpr const std::array<char, 4> solv_userdata_dnf_version{'\0', '1', '.', '0'};
 
-static constexpr const int solv_userdata_size = solv_userdata_solv_toolversion_size + \
+// Userdata written before the repomd stat was recorded, still accepted when reading
+static constexpr const int solv_userdata_size_without_stat = solv_userdata_solv_toolversion_size + \
                                                    solv_userdata_magic.size() + \
                                                    solv_userdata_dnf_version.size() + \
                                                    CHKSUM_BYTES;
+static constexpr const int solv_userdata_size = solv_userdata_size_without_stat + CHKSUM_BYTES;
 
 struct SolvUserdata {
     char dnf_magic[solv_userdata_magic.size()];
     char dnf_version[solv_userdata_dnf_version.size()];
     char libsolv_version[solv_userdata_solv_toolversion_size];
     unsigned char checksum[CHKSUM_BYTES];
+    // checksum_stat() of the repomd.xml the checksum was computed from, zeroed if unknown
+    unsigned char repomd_stat[CHKSUM_BYTES];
 }__attribute__((packed)); ;
 
-int solv_userdata_fill(SolvUserdata *solv_userdata, const unsigned char *checksum, GError** error);
+int solv_userdata_fill(SolvUserdata *solv_userdata, const unsigned char *checksum,
+                       const unsigned char *repomd_stat, GError** error);
 std::unique_ptr<SolvUserdata> solv_userdata_read(FILE *fp);
 int solv_userdata_verify(const SolvUserdata *solv_userdata, const unsigned char *checksum);
 
@@ -66,6 +72,9 @@ gboolean mv(const char *old_path, const char *new_path, GError **error);
 gboolean dnf_remove_recursive_v2(const gchar *path, GError **error);
 gboolean dnf_copy_file(const std::string & srcPath, const std::string & dstPath, GError ** error);
 gboolean dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, GError ** error);
+/* hardlinks the files where possible, they must only be replaced but never changed in place */
+gboolean dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, bool hardlink,
+                            GError ** error);
 gboolean dnf_move_recursive(const gchar *src_dir, const gchar *dst_dir, GError **error);
 char *this_username(void);
 
@@ -85,6 +94,7 @@ int is_package(const Pool *pool, const Solvable *s);
 /* package version utils */
 unsigned long pool_get_epoch(Pool *pool, const char *evr);
 void pool_split_evr(Pool *pool, const char *evr, char **epoch, char **version, char **release);
+void split_evr(const char *evr, std::string & buf, char **epoch, char **version, char **release);
 
 /* reldep utils */
 int parse_reldep_str(const char *nevra, char **name, char **evr, int *cmp_type);
@@ -25,13 +25,16 @@
 #ifdef __APPLE__
 #include <limits.h>
 #else
+#include <linux/fs.h>
 #include <linux/limits.h>
+#include <sys/sendfile.h>
 #endif
 #include <pwd.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
@@ -174,7 +177,8 @@ get_padded_solv_toolversion()
 }
 
 int
-solv_userdata_fill(SolvUserdata *solv_userdata, const unsigned char *checksum, GError** error)
+solv_userdata_fill(SolvUserdata *solv_userdata, const unsigned char *checksum,
+                   const unsigned char *repomd_stat, GError** error)
 {
     if (strlen(solv_toolversion) > solv_userdata_solv_toolversion_size) {
         g_set_error(error, DNF_ERROR, DNF_ERROR_INTERNAL_ERROR,
@@ -195,6 +199,12 @@ solv_userdata_fill(SolvUserdata *solv_userdata, const unsigned char *checksum, G
     // copy checksum
     memcpy(solv_userdata->checksum, checksum, CHKSUM_BYTES);
 
+    // copy repomd stat
+    if (repomd_stat)
+        memcpy(solv_userdata->repomd_stat, repomd_stat, CHKSUM_BYTES);
+    else
+        memset(solv_userdata->repomd_stat, 0, CHKSUM_BYTES);
+
     return 0;
 }
 
@@ -209,20 +219,26 @@ solv_userdata_read(FILE *fp)
     }
 
     int ret_code = solv_read_userdata(fp, &dnf_solvfile_userdata_read, &dnf_solvfile_userdata_len_read);
-    // The userdata layout has to match our struct exactly so we can just cast the memory
-    // allocated by libsolv
-    std::unique_ptr<SolvUserdata> uniq_userdata(reinterpret_cast<SolvUserdata *>(dnf_solvfile_userdata_read));
     if(ret_code) {
+        solv_free(dnf_solvfile_userdata_read);
         g_warning("Failed to read solv userdata: solv_read_userdata returned: %i", ret_code);
         return nullptr;
     }
 
-    if (dnf_solvfile_userdata_len_read != solv_userdata_size) {
+    if (dnf_solvfile_userdata_len_read != solv_userdata_size &&
+        dnf_solvfile_userdata_len_read != solv_userdata_size_without_stat) {
+        solv_free(dnf_solvfile_userdata_read);
         g_warning("Solv userdata length mismatch, read: %i vs expected: %i",
                   dnf_solvfile_userdata_len_read, solv_userdata_size);
         return nullptr;
     }
 
+    // The userdata layout has to match the beginning of our struct, older files
+    // without the repomd stat get it zeroed
+    std::unique_ptr<SolvUserdata> uniq_userdata(new SolvUserdata());
+    memcpy(uniq_userdata.get(), dnf_solvfile_userdata_read, dnf_solvfile_userdata_len_read);
+    solv_free(dnf_solvfile_userdata_read);
+
     return uniq_userdata;
 }
 
@@ -438,9 +454,77 @@ dnf_remove_recursive_v2(const gchar *path, GError **error) try
         return dnf_ensure_file_unlinked(path, error);
 } CATCH_TO_GERROR(FALSE)
 
+/* Copies the data of a regular file without a round trip through user space: as a reflink
+ * sharing the extents where the filesystem supports it, else by copy_file_range() and
+ * sendfile(). Returns FALSE if the data has to be copied otherwise. */
+static gboolean
+copy_file_data(int fdSrc, int fdDst, off_t size)
+{
+#ifdef FICLONE
+    if (ioctl(fdDst, FICLONE, fdSrc) == 0)
+        return TRUE;
+#endif
+    off_t done = 0;
+#ifdef __linux__
+    /* both continue from the file offsets, the rest is copied by the next way */
+    while (done < size) {
+        auto n = copy_file_range(fdSrc, NULL, fdDst, NULL, size - done, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += n;
+    }
+    while (done < size) {
+        auto n = sendfile(fdDst, fdSrc, NULL, size - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += n;
+    }
+#endif
+    return done == size;
+}
+
+static gboolean
+copy_file_fast(const std::string & srcPath, const std::string & dstPath)
+{
+    struct stat info;
+    if (lstat(srcPath.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+        return FALSE;
+    int fdSrc = open(srcPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fdSrc == -1)
+        return FALSE;
+    int fdDst = open(dstPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, info.st_mode & 07777);
+    if (fdDst == -1) {
+        close(fdSrc);
+        return FALSE;
+    }
+    gboolean ret = copy_file_data(fdSrc, fdDst, info.st_size);
+    if (ret) {
+        /* the metadata G_FILE_COPY_ALL_METADATA keeps, the owner only when permitted */
+        if (fchown(fdDst, info.st_uid, info.st_gid) != 0)
+            g_debug("cannot keep the owner of %s: %s", dstPath.c_str(), strerror(errno));
+        fchmod(fdDst, info.st_mode & 07777);
+#ifdef __linux__
+        struct timespec times[2] = {info.st_atim, info.st_mtim};
+        futimens(fdDst, times);
+#endif
+    }
+    close(fdSrc);
+    if (close(fdDst) != 0)
+        ret = FALSE;
+    if (!ret)
+        unlink(dstPath.c_str());
+    return ret;
+}
+
 gboolean
 dnf_copy_file(const std::string & srcPath, const std::string & dstPath, GError ** error) try
 {
+    if (copy_file_fast(srcPath, dstPath))
+        return TRUE;
     g_autoptr(GFile) src = g_file_new_for_path(srcPath.c_str());
     g_autoptr(GFile) dest = g_file_new_for_path(dstPath.c_str());
     return g_file_copy(src, dest,
@@ -449,7 +533,8 @@ dnf_copy_file(const std::string & srcPath, const std::string & dstPath, GError *
 } CATCH_TO_GERROR(FALSE)
 
 gboolean
-dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, GError ** error) try
+dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, bool hardlink,
+                   GError ** error) try
 {
     struct stat info;
     if (!stat(srcPath.c_str(), &info)) {
@@ -471,7 +556,7 @@ dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, GEr
                         continue;
                     std::string srcItem = srcPath + "/" + name;
                     std::string dstItem = dstPath + "/" + name;
-                    ret = dnf_copy_recursive(srcItem, dstItem, error);
+                    ret = dnf_copy_recursive(srcItem, dstItem, hardlink, error);
                     if (!ret)
                         break;
                 }
@@ -487,6 +572,9 @@ dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, GEr
                 return FALSE;
             }
         } else {
+            /* falls back to a copy e.g. across filesystems */
+            if (hardlink && S_ISREG(info.st_mode) && link(srcPath.c_str(), dstPath.c_str()) == 0)
+                return TRUE;
             return dnf_copy_file(srcPath, dstPath, error);
         }
     } else {
@@ -500,6 +588,12 @@ dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, GEr
     }
 } CATCH_TO_GERROR(FALSE)
 
+gboolean
+dnf_copy_recursive(const std::string & srcPath, const std::string & dstPath, GError ** error)
+{
+    return dnf_copy_recursive(srcPath, dstPath, false, error);
+}
+
 /**
  * dnf_move_recursive:
  * @src_dir: A source directory path
@@ -724,14 +818,19 @@ what_downgrades(Pool *pool, Id pkg)
 unsigned long
 pool_get_epoch(Pool *pool, const char *evr)
 {
-    char *e, *v, *r, *endptr;
+    char *endptr;
     unsigned long epoch = 0;
+    const char *c;
 
-    pool_split_evr(pool, evr, &e, &v, &r);
-    if (e) {
-        long int converted = strtol(e, &endptr, 10);
+    /* parsed in place, the pool temp space is not safe for concurrent readers */
+    if (*evr == '\0')
+        return 0;
+    for (c = evr + 1; *c != ':' && *c != '-' && *c != '\0'; ++c)
+        ;
+    if (*c == ':') {
+        long int converted = strtol(evr, &endptr, 10);
         assert(converted > 0);
-        assert(*endptr == '\0');
+        assert(endptr == c);
         epoch = converted;
     }
 
@@ -746,11 +845,9 @@ pool_get_epoch(Pool *pool, const char *evr)
  * to store the split pieces, or this would call strdup (which is more expensive
  * than the pool temp space).
  */
-void
-pool_split_evr(Pool *pool, const char *evr_c, char **epoch, char **version,
-                   char **release)
+static void
+split_evr_in_place(char *evr, char **epoch, char **version, char **release)
 {
-    char *evr = pool_tmpdup(pool, evr_c);
     char *e, *v, *r;
 
     for (e = evr + 1; *e != ':' && *e != '-' && *e != '\0'; ++e)
@@ -779,6 +876,25 @@ pool_split_evr(Pool *pool, const char *evr_c, char **epoch, char **version,
     *release = r;
 }
 
+void
+pool_split_evr(Pool *pool, const char *evr_c, char **epoch, char **version,
+                   char **release)
+{
+    split_evr_in_place(pool_tmpdup(pool, evr_c), epoch, version, release);
+}
+
+/**
+ * Split evr into its components like pool_split_evr() does, using 'buf' as
+ * the storage instead of the pool temp space. The results point into 'buf'.
+ */
+void
+split_evr(const char *evr_c, std::string & buf, char **epoch, char **version,
+          char **release)
+{
+    buf.assign(evr_c);
+    split_evr_in_place(&buf[0], epoch, version, release);
+}
+
 const char *
 id2nevra(Pool *pool, Id id)
 {
@@ -793,7 +909,7 @@ packageSet2GPtrArray(libdnf::PackageSet * pset)
     if (!pset) {
         return NULL;
     }
-    GPtrArray *plist = hy_packagelist_create();
+    GPtrArray *plist = g_ptr_array_new_full(pset->size(), g_object_unref);
 
     DnfSack * sack = pset->getSack();
 
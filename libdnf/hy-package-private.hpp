@@ -22,6 +22,8 @@
 #ifndef __HY_PACKAGE_INTERNAL_H
 #define __HY_PACKAGE_INTERNAL_H
 
+#include <ctime>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -33,4 +35,21 @@ Pool        *dnf_package_get_pool       (DnfPackage *pkg);
 DnfSack     *dnf_package_get_sack       (DnfPackage *pkg);
 std::vector<libdnf::Changelog>   dnf_package_get_changelogs (DnfPackage *pkg);
 
+/**
+ * @brief Calls callback with the changelog entries of the package, newest first, without copying
+ *        the strings. They are only valid during the call. Returning false stops the iteration.
+ * @param limit Visit at most limit newest entries, 0 for all
+ * @param since Skip entries older than the timestamp, 0 for all
+ * @return Number of entries passed to callback
+ */
+std::size_t dnf_package_foreach_changelog(DnfPackage *pkg, std::size_t limit, time_t since,
+    const std::function<bool(time_t, const char *, const char *)> & callback);
+
+/**
+ * @brief Calls callback with the path of every file of the package without copying them.
+ *        The path is only valid during the call. Returning false from callback stops the iteration.
+ * @return Number of files passed to callback
+ */
+std::size_t dnf_package_foreach_file(DnfPackage *pkg, const std::function<bool(const char *)> & callback);
+
 #endif // __HY_PACKAGE_INTERNAL_H
@@ -34,6 +34,8 @@
 #include <algorithm>
 #include <ctime>
 #include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
 #include <solv/evr.h>
 #include <solv/pool.h>
 #include <solv/repo.h>
@@ -46,6 +48,7 @@
 #include "hy-package-private.hpp"
 #include "hy-repo-private.hpp"
 #include "repo/solvable/DependencyContainer.hpp"
+#include "sack/advisoryindex.hpp"
 #include "sack/advisorymodule.hpp"
 
 #define BLOCK_SIZE 31
@@ -91,7 +94,8 @@ dnf_package_class_init(DnfPackageClass *klass)
 /**
  * dnf_package_new:
  *
- * Creates a new #DnfPackage.
+ * Creates a new #DnfPackage, or returns the living one of the solvable when
+ * enabled by dnf_sack_set_use_package_cache().
  *
  * Returns:(transfer full): a #DnfPackage
  *
@@ -100,10 +104,14 @@ dnf_package_class_init(DnfPackageClass *klass)
 DnfPackage *
 dnf_package_new(DnfSack *sack, Id id)
 {
-    auto pkg = DNF_PACKAGE(g_object_new(DNF_TYPE_PACKAGE, NULL));
+    auto pkg = dnf_sack_package_cache_lookup(sack, id);
+    if (pkg)
+        return pkg;
+    pkg = DNF_PACKAGE(g_object_new(DNF_TYPE_PACKAGE, NULL));
     auto priv = GET_PRIVATE(pkg);
     priv->sack = sack;
     priv->id = id;
+    dnf_sack_package_cache_store(sack, pkg);
     return pkg;
 }
 
@@ -379,7 +387,11 @@ dnf_package_get_sourcerpm(DnfPackage *pkg)
 const char *
 dnf_package_get_version(DnfPackage *pkg)
 {
+    DnfPackagePrivate *priv = GET_PRIVATE(pkg);
     char *e, *v, *r;
+    const char *version = dnf_sack_get_frozen_version(priv->sack, get_solvable(pkg)->evr);
+    if (version)
+        return version;
     pool_split_evr(dnf_package_get_pool(pkg), dnf_package_get_evr(pkg), &e, &v, &r);
     return v;
 }
@@ -397,9 +409,10 @@ dnf_package_get_version(DnfPackage *pkg)
 const char *
 dnf_package_get_release(DnfPackage *pkg)
 {
-    char *e, *v, *r;
-    pool_split_evr(dnf_package_get_pool(pkg), dnf_package_get_evr(pkg), &e, &v, &r);
-    return r;
+    /* the release is the tail of the evr, found without the pool temp space */
+    const char *evr = dnf_package_get_evr(pkg);
+    const char *dash = *evr ? strchr(evr + 1, '-') : NULL;
+    return dash ? dash + 1 : NULL;
 }
 
 /**
@@ -977,22 +990,38 @@ dnf_package_get_regular_requires(DnfPackage *pkg)
  */
 gchar **
 dnf_package_get_files(DnfPackage *pkg)
+{
+    GPtrArray *ret = g_ptr_array_new();
+    dnf_package_foreach_file(pkg, [ret](const char *file) {
+        g_ptr_array_add(ret, g_strdup(file));
+        return true;
+    });
+    g_ptr_array_add(ret, NULL);
+    return (gchar**)g_ptr_array_free (ret, FALSE);
+}
+
+std::size_t
+dnf_package_foreach_file(DnfPackage *pkg, const std::function<bool(const char *)> & callback)
 {
     DnfPackagePrivate *priv = GET_PRIVATE(pkg);
     Pool *pool = dnf_package_get_pool(pkg);
     Solvable *s = get_solvable(pkg);
     Dataiterator di;
-    GPtrArray *ret = g_ptr_array_new();
+    std::size_t count = 0;
 
+    dnf_sack_reload_unloaded_exts(priv->sack, s->repo, DNF_SACK_LOAD_FLAG_USE_FILELISTS);
+    // only internalizes data that is still being added (e.g. command line packages),
+    // file lists read from a solv extension are paged in for this solvable alone
     repo_internalize_trigger(s->repo);
     dataiterator_init(&di, pool, s->repo, priv->id, SOLVABLE_FILELIST, NULL,
                       SEARCH_FILES | SEARCH_COMPLETE_FILELIST);
     while (dataiterator_step(&di)) {
-        g_ptr_array_add(ret, g_strdup(di.kv.str));
+        ++count;
+        if (!callback(di.kv.str))
+            break;
     }
     dataiterator_free(&di);
-    g_ptr_array_add(ret, NULL);
-    return (gchar**)g_ptr_array_free (ret, FALSE);
+    return count;
 }
 
 /**
@@ -1007,26 +1036,49 @@ dnf_package_get_files(DnfPackage *pkg)
  */
 std::vector<libdnf::Changelog>
 dnf_package_get_changelogs(DnfPackage *pkg)
+{
+    std::vector<libdnf::Changelog> changelogslist;
+    dnf_package_foreach_changelog(pkg, 0, 0,
+        [&changelogslist](time_t timestamp, const char *author, const char *text) {
+            changelogslist.emplace_back(timestamp, author, text);
+            return true;
+        });
+    return changelogslist;
+}
+
+std::size_t
+dnf_package_foreach_changelog(DnfPackage *pkg, std::size_t limit, time_t since,
+                              const std::function<bool(time_t, const char *, const char *)> & callback)
 {
     DnfPackagePrivate *priv = GET_PRIVATE(pkg);
     Pool *pool = dnf_package_get_pool(pkg);
     Solvable *s = get_solvable(pkg);
     Dataiterator di;
-    std::vector<libdnf::Changelog> changelogslist;
+    // entries are stored oldest first, remember positions to visit them newest first
+    std::vector<Datapos> entries;
 
+    dnf_sack_reload_unloaded_exts(priv->sack, s->repo, DNF_SACK_LOAD_FLAG_USE_OTHER);
     dataiterator_init(&di, pool, s->repo, priv->id, SOLVABLE_CHANGELOG_AUTHOR, NULL, 0);
     dataiterator_prepend_keyname(&di, SOLVABLE_CHANGELOG);
     while (dataiterator_step(&di)) {
         dataiterator_setpos_parent(&di);
-        std::string author(pool_lookup_str(pool, SOLVID_POS, SOLVABLE_CHANGELOG_AUTHOR));
-        std::string text(pool_lookup_str(pool, SOLVID_POS, SOLVABLE_CHANGELOG_TEXT));
-        changelogslist.emplace_back(
-            static_cast<time_t>(pool_lookup_num(pool, SOLVID_POS, SOLVABLE_CHANGELOG_TIME, 0)),
-            std::move(author), std::move(text));
+        if (since && static_cast<time_t>(pool_lookup_num(pool, SOLVID_POS, SOLVABLE_CHANGELOG_TIME, 0)) < since)
+            continue;
+        entries.push_back(pool->pos);
     }
     dataiterator_free(&di);
-    std::reverse(changelogslist.begin(), changelogslist.end());
-    return changelogslist;
+
+    std::size_t count = 0;
+    for (auto it = entries.rbegin(); it != entries.rend() && (!limit || count < limit); ++it) {
+        pool->pos = *it;
+        auto timestamp = static_cast<time_t>(pool_lookup_num(pool, SOLVID_POS, SOLVABLE_CHANGELOG_TIME, 0));
+        const char *author = pool_lookup_str(pool, SOLVID_POS, SOLVABLE_CHANGELOG_AUTHOR);
+        const char *text = pool_lookup_str(pool, SOLVID_POS, SOLVABLE_CHANGELOG_TEXT);
+        ++count;
+        if (!callback(timestamp, author ? author : "", text ? text : ""))
+            break;
+    }
+    return count;
 }
 
 /**
@@ -1106,6 +1158,37 @@ dnf_package_get_advisories(DnfPackage *pkg, int cmp_type)
     return advisorylist;
 }
 
+/**
+ * dnf_package_get_advisories_for_set:
+ * @pset: a #DnfPackageSet instance.
+ * @cmp_type: the relation of the advisory packages to the packages, e.g. %HY_GT
+ *
+ * Gets the advisories of all packages in the set, the same lists
+ * dnf_package_get_advisories() returns for each of them, in a single pass
+ * over the advisories. Packages without advisories are not in the table.
+ *
+ * Returns: (transfer container) (element-type gint GPtrArray): a table
+ * mapping package ids to lists of #DnfAdvisory
+ *
+ * Since: 0.70.0
+ */
+GHashTable *
+dnf_package_get_advisories_for_set(DnfPackageSet *pset, int cmp_type)
+{
+    DnfSack *sack = pset->getSack();
+    GHashTable *advisories = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                                   (GDestroyNotify) g_ptr_array_unref);
+    std::unordered_map<Id, std::vector<Id>> found;
+    dnf_sack_get_advisory_index(sack).getPackagesAdvisories(sack, *pset, cmp_type, found);
+    for (auto & item : found) {
+        GPtrArray *advisorylist = g_ptr_array_new_with_free_func((GDestroyNotify) dnf_advisory_free);
+        for (Id advisory : item.second)
+            g_ptr_array_add(advisorylist, dnf_advisory_new(sack, advisory));
+        g_hash_table_insert(advisories, GINT_TO_POINTER(item.first), advisorylist);
+    }
+    return advisories;
+}
+
 /**
  * dnf_package_get_delta_from_evr:
  * @pkg: a #DnfPackage instance.
@@ -1126,6 +1209,7 @@ dnf_package_get_delta_from_evr(DnfPackage *pkg, const char *from_evr)
     Dataiterator di;
     const char *name = dnf_package_get_name(pkg);
 
+    dnf_sack_reload_unloaded_exts(dnf_package_get_sack(pkg), s->repo, DNF_SACK_LOAD_FLAG_USE_PRESTO);
     dataiterator_init(&di, pool, s->repo, SOLVID_META, DELTA_PACKAGE_NAME, name,
                       SEARCH_STRING);
     dataiterator_prepend_keyname(&di, REPOSITORY_DELTAINFO);
@@ -97,6 +97,7 @@ DnfReldepList *dnf_package_get_prereq_ignoreinst(DnfPackage *pkg);
 DnfReldepList *dnf_package_get_regular_requires(DnfPackage *pkg);
 char       **dnf_package_get_files      (DnfPackage *pkg);
 GPtrArray   *dnf_package_get_advisories (DnfPackage *pkg, int cmp_type);
+GHashTable  *dnf_package_get_advisories_for_set(DnfPackageSet *pset, int cmp_type);
 
 DnfPackageDelta *dnf_package_get_delta_from_evr(DnfPackage *pkg, const char *from_evr);
 
@@ -154,3 +154,96 @@ dnf_packageset_free(DnfPackageSet *pset)
 {
     delete pset;
 }
+
+/**
+ * dnf_packageset_iter_init:
+ * @iter: an uninitialized #DnfPackageSetIter
+ * @pset: a #DnfPackageSet instance.
+ *
+ * Initializes @iter before the first package of @pset. The set must not be
+ * changed while iterating.
+ *
+ * |[
+ * DnfPackageSetIter iter;
+ * dnf_packageset_iter_init(&iter, pset);
+ * while (dnf_packageset_iter_next(&iter))
+ *     g_print("%s\n", dnf_packageset_iter_get_nevra(&iter));
+ * ]|
+ *
+ * Since: 0.70.0
+ */
+void
+dnf_packageset_iter_init(DnfPackageSetIter *iter, DnfPackageSet *pset)
+{
+    iter->pset = pset;
+    iter->id = -1;
+}
+
+/**
+ * dnf_packageset_iter_next:
+ * @iter: a #DnfPackageSetIter
+ *
+ * Moves @iter to the next package of the set.
+ *
+ * Returns: %FALSE if there are no more packages, @iter must be initialized
+ *          again before the next use
+ *
+ * Since: 0.70.0
+ */
+gboolean
+dnf_packageset_iter_next(DnfPackageSetIter *iter)
+{
+    iter->id = iter->pset->next(iter->id);
+    return iter->id != -1;
+}
+
+/**
+ * dnf_packageset_iter_get_name:
+ * @iter: a #DnfPackageSetIter
+ *
+ * Gets the name of the current package.
+ *
+ * Returns: (transfer none): a string
+ *
+ * Since: 0.70.0
+ */
+const char *
+dnf_packageset_iter_get_name(DnfPackageSetIter *iter)
+{
+    Pool *pool = dnf_sack_get_pool(iter->pset->getSack());
+    return pool_id2str(pool, pool_id2solvable(pool, iter->id)->name);
+}
+
+/**
+ * dnf_packageset_iter_get_nevra:
+ * @iter: a #DnfPackageSetIter
+ *
+ * Gets the NEVRA of the current package like dnf_package_get_nevra() does.
+ *
+ * Returns: (transfer none): a string, valid until the next call
+ *
+ * Since: 0.70.0
+ */
+const char *
+dnf_packageset_iter_get_nevra(DnfPackageSetIter *iter)
+{
+    Pool *pool = dnf_sack_get_pool(iter->pset->getSack());
+    return pool_solvid2str(pool, iter->id);
+}
+
+/**
+ * dnf_packageset_iter_get_package:
+ * @iter: a #DnfPackageSetIter
+ *
+ * Creates the #DnfPackage of the current package, for the callers needing
+ * more than the handle provides.
+ *
+ * Returns: (transfer full): a #DnfPackage
+ *
+ * Since: 0.70.0
+ */
+DnfPackage *
+dnf_packageset_iter_get_package(DnfPackageSetIter *iter)
+{
+    return dnf_package_new(iter->pset->getSack(), iter->id);
+}
@@ -40,6 +40,26 @@ int                  dnf_packageset_has         (DnfPackageSet *pset, DnfPackage
 DnfPackageSet       *dnf_packageset_from_bitmap (DnfSack *sack, Map *m);
 Map             *dnf_packageset_get_map        (DnfPackageSet *pset);
 
+/**
+ * DnfPackageSetIter:
+ * @pset: the iterated set
+ * @id: the solvable id of the current package, or -1
+ *
+ * A stack allocated handle of the packages in a #DnfPackageSet, which needs
+ * no #DnfPackage to be created for reading the name or NEVRA of a package.
+ **/
+typedef struct {
+    DnfPackageSet       *pset;
+    Id                   id;
+} DnfPackageSetIter;
+
+void                 dnf_packageset_iter_init       (DnfPackageSetIter *iter,
+                                                     DnfPackageSet *pset);
+gboolean             dnf_packageset_iter_next       (DnfPackageSetIter *iter);
+const char          *dnf_packageset_iter_get_name   (DnfPackageSetIter *iter);
+const char          *dnf_packageset_iter_get_nevra  (DnfPackageSetIter *iter);
+DnfPackage          *dnf_packageset_iter_get_package (DnfPackageSetIter *iter);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(DnfPackageSet, dnf_packageset_free)
 
 #ifdef __cplusplus
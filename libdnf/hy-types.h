@@ -53,6 +53,7 @@ typedef int (*hy_solution_callback)(HyGoal goal, void *callback_data);
 #define LIBDNF_MODULE_FAIL_SAFE_REPO_NAME "@modulefailsafe"
 #define HY_EXT_FILENAMES "-filenames"
 #define HY_EXT_UPDATEINFO "-updateinfo"
+#define HY_EXT_UPDATEINFO_SLIM "-updateinfo-slim"
 #define HY_EXT_PRESTO "-presto"
 #define HY_EXT_OTHER "-other"
 
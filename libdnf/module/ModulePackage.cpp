@@ -128,6 +128,15 @@ ModulePackage::ModulePackage(const ModulePackage & mpkg)
     if (mdStream != nullptr) {
         g_object_ref(mdStream);
     }
+    if (mpkg.artifacts) {
+        artifacts.reset(new std::vector<std::string>(*mpkg.artifacts));
+    }
+    if (mpkg.demodularizedRpms) {
+        demodularizedRpms.reset(new std::vector<std::string>(*mpkg.demodularizedRpms));
+    }
+    if (mpkg.profiles) {
+        profiles.reset(new std::vector<ModuleProfile>(*mpkg.profiles));
+    }
 }
 
 ModulePackage & ModulePackage::operator=(const ModulePackage & mpkg)
@@ -143,6 +152,9 @@ ModulePackage & ModulePackage::operator=(const ModulePackage & mpkg)
         moduleSack = mpkg.moduleSack;
         repoID = mpkg.repoID;
         id = mpkg.id;
+        artifacts.reset();
+        demodularizedRpms.reset();
+        profiles.reset();
     }
     return *this;
 }
@@ -405,17 +417,19 @@ std::string ModulePackage::getDescription() const
  *
  * @return std::vector<std::string>
  */
-std::vector<std::string> ModulePackage::getArtifacts() const
+const std::vector<std::string> & ModulePackage::getArtifacts() const
 {
-    std::vector<std::string> result_rpms;
-    char ** rpms = modulemd_module_stream_v2_get_rpm_artifacts_as_strv((ModulemdModuleStreamV2 *) mdStream);
+    if (!artifacts) {
+        artifacts.reset(new std::vector<std::string>);
+        char ** rpms = modulemd_module_stream_v2_get_rpm_artifacts_as_strv((ModulemdModuleStreamV2 *) mdStream);
 
-    for (char **iter = rpms; iter && *iter; iter++) {
-        result_rpms.emplace_back(std::string(*iter));
-    }
+        for (char **iter = rpms; iter && *iter; iter++) {
+            artifacts->emplace_back(*iter);
+        }
 
-    g_strfreev(rpms);
-    return result_rpms;
+        g_strfreev(rpms);
+    }
+    return *artifacts;
 }
 
 /**
@@ -423,17 +437,19 @@ std::vector<std::string> ModulePackage::getArtifacts() const
  *
  * @return std::vector<std::string>
  */
-std::vector<std::string> ModulePackage::getDemodularizedRpms() const
+const std::vector<std::string> & ModulePackage::getDemodularizedRpms() const
 {
-    std::vector<std::string> result_rpms;
-    char ** rpms = modulemd_module_stream_v2_get_demodularized_rpms((ModulemdModuleStreamV2 *) mdStream);
+    if (!demodularizedRpms) {
+        demodularizedRpms.reset(new std::vector<std::string>);
+        char ** rpms = modulemd_module_stream_v2_get_demodularized_rpms((ModulemdModuleStreamV2 *) mdStream);
 
-    for (char **iter = rpms; iter && *iter; iter++) {
-        result_rpms.emplace_back(std::string(*iter));
-    }
+        for (char **iter = rpms; iter && *iter; iter++) {
+            demodularizedRpms->emplace_back(*iter);
+        }
 
-    g_strfreev(rpms);
-    return result_rpms;
+        g_strfreev(rpms);
+    }
+    return *demodularizedRpms;
 }
 
 std::vector<ModuleProfile>
@@ -498,17 +514,19 @@ ModulePackage::getDefaultProfile() const
  *
  * @return std::vector<ModuleProfile>
  */
-std::vector<ModuleProfile> ModulePackage::getProfiles() const
+const std::vector<ModuleProfile> & ModulePackage::getProfiles() const
 {
-    std::vector<ModuleProfile> result_profiles;
-    char ** profiles = modulemd_module_stream_v2_get_profile_names_as_strv((ModulemdModuleStreamV2 *) mdStream);
+    if (!profiles) {
+        profiles.reset(new std::vector<ModuleProfile>);
+        char ** names = modulemd_module_stream_v2_get_profile_names_as_strv((ModulemdModuleStreamV2 *) mdStream);
 
-    for (char **iter = profiles; iter && *iter; iter++) {
-        result_profiles.push_back(ModuleProfile(modulemd_module_stream_v2_get_profile((ModulemdModuleStreamV2 *) mdStream, *iter)));
-    }
+        for (char **iter = names; iter && *iter; iter++) {
+            profiles->push_back(ModuleProfile(modulemd_module_stream_v2_get_profile((ModulemdModuleStreamV2 *) mdStream, *iter)));
+        }
 
-    g_strfreev(profiles);
-    return result_profiles;
+        g_strfreev(names);
+    }
+    return *profiles;
 }
 
 /**
@@ -58,10 +58,11 @@ public:
     std::string getSummary() const;
     std::string getDescription() const;
 
-    std::vector<std::string> getArtifacts() const;
+    /// Artifacts are read from the metadata on the first call and kept by the package
+    const std::vector<std::string> & getArtifacts() const;
 
     /// Return sorted list of RPM names that are demodularized.
-    std::vector<std::string> getDemodularizedRpms() const;
+    const std::vector<std::string> & getDemodularizedRpms() const;
 
     bool operator==(const ModulePackage &r) const;
     /**
@@ -70,7 +71,7 @@ public:
     * @return std::vector<ModuleProfile>
     */
     std::vector<ModuleProfile> getProfiles(const std::string &name) const;
-    std::vector<ModuleProfile> getProfiles() const;
+    const std::vector<ModuleProfile> & getProfiles() const;
     ModuleProfile getDefaultProfile() const;
 
     std::vector<ModuleDependencies> getModuleDependencies() const;
@@ -117,6 +118,11 @@ private:
 
     ModulemdModuleStream * mdStream;
 
+    /// Lazily filled copies of data which are requested repeatedly from the same package
+    mutable std::unique_ptr<std::vector<std::string>> artifacts;
+    mutable std::unique_ptr<std::vector<std::string>> demodularizedRpms;
+    mutable std::unique_ptr<std::vector<ModuleProfile>> profiles;
+
     // TODO: remove after inheriting from Package
     DnfSack * moduleSack;
     std::string repoID;
@@ -19,8 +19,11 @@
  */
 
 #include <algorithm>
+#include <exception>
+#include <fnmatch.h>
 #include <set>
 #include <sstream>
+#include <unordered_map>
 
 extern "C" {
 #include <solv/poolarch.h>
@@ -31,9 +34,11 @@ extern "C" {
 #include "libdnf/utils/filesystem.hpp"
 #include "libdnf/utils/utils.hpp"
 #include "libdnf/utils/File.hpp"
+#include "libdnf/utils/probes.hpp"
 #include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/hy-query.h"
 #include "libdnf/hy-types.h"
+#include "libdnf/hy-util-private.hpp"
 #include <functional>
 #include <../sack/query.hpp>
 #include "../log.hpp"
@@ -187,10 +192,15 @@ public:
     ~Impl();
     std::pair<std::vector<std::vector<std::string>>, ModulePackageContainer::ModuleErrorType> moduleSolve(
         const std::vector<ModulePackage *> & modules, bool debugSolver);
+    std::pair<std::vector<std::vector<std::string>>, ModulePackageContainer::ModuleErrorType>
+    moduleSolveUncached(const std::vector<ModulePackage *> & modules, bool debugSolver);
     bool insert(const std::string &moduleName, const char *path);
     std::vector<ModulePackage *> getLatestActiveEnabledModules();
     /// Required to call after all modules v3 are in metadata
     void addVersion2Modules();
+    void addModules(ModulemdModuleIndex * index, const std::string & repoID);
+    /// Return ids of modules with given name (all names when empty) sorted by id
+    std::vector<Id> getIndexedModules(const std::string & name);
 
 private:
     friend struct ModulePackageContainer;
@@ -214,6 +224,31 @@ private:
     std::map<std::string, std::string> moduleDefaults;
     std::vector<std::tuple<LibsolvRepo *, ModulemdModuleStream *, std::string>> modulesV2;
 
+    /// Inputs and outcome of the last moduleSolve(), reused while the request, the module sack
+    /// content and its considered map stay the same
+    struct SolveCache {
+        std::vector<std::pair<Id, bool>> request;
+        int nsolvables;
+        bool hasConsidered;
+        std::vector<unsigned char> considered;
+        std::vector<std::vector<std::string>> problems;
+        ModulePackageContainer::ModuleErrorType problemType;
+        std::unique_ptr<PackageSet> activated;
+    };
+    std::unique_ptr<SolveCache> solveCache;
+
+    /// name -> stream -> ids of modules, rebuilt on demand when modules were added
+    std::map<std::string, std::map<std::string, std::vector<Id>>> moduleIndex;
+    std::size_t moduleIndexSize{0};
+
+    /// artifact NEVRA (without zero epoch) -> ids of active modules, built by requiresModuleEnablement()
+    /// and dropped by every moduleSolve()
+    std::unique_ptr<std::unordered_map<std::string, std::vector<Id>>> activeArtifacts;
+    /// "name\0stream\0context" -> whether a matching module is active, dropped by every moduleSolve() and
+    /// when modules were added
+    std::unordered_map<std::string, bool> activeStreams;
+    std::size_t activeStreamsSize{0};
+
     bool isEnabled(const std::string &name, const std::string &stream);
 };
 
@@ -329,23 +364,36 @@ ModulePackageContainer::add(DnfSack * sack)
     LibsolvRepo * r;
     Id id;
 
+    std::vector<std::string> repoNames;
+    std::vector<std::string> yamlContents;
     FOR_REPOS(id, r) {
         HyRepo hyRepo = static_cast<HyRepo>(r->appdata);
         auto modules_fn = hyRepo->getMetadataPath(MD_TYPE_MODULES);
         if (modules_fn.empty()) {
             continue;
         }
-        std::string yamlContent = getFileContent(modules_fn);
-        auto repoName = hyRepo->getId();
-        add(yamlContent, repoName);
-        // update defaults from repo
-        try {
-            pImpl->moduleMetadata.addMetadataFromString(yamlContent, 0);
-        } catch (const ModulePackageContainer::ResolveException & exception) {
-            throw ModulePackageContainer::ConflictException(
-                tfm::format(_("Conflicting defaults with repo '%s': %s"), repoName,
-                            exception.what()));
+        yamlContents.push_back(getFileContent(modules_fn));
+        repoNames.push_back(hyRepo->getId());
+    }
+
+    // documents are parsed in parallel, modules and defaults are added in the order of repos
+    auto indexes = ModuleMetadata::parseMetadata(yamlContents);
+    std::exception_ptr error;
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+        if (!error) {
+            try {
+                // the parsed index is shared by the repo modules and the defaults
+                pImpl->addModules(indexes[i], repoNames[i]);
+                // update defaults from repo
+                pImpl->moduleMetadata.addMetadataFromIndex(indexes[i], 0);
+            } catch (...) {
+                error = std::current_exception();
+            }
         }
+        g_object_unref(indexes[i]);
+    }
+    if (error) {
+        std::rethrow_exception(error);
     }
 }
 
@@ -354,9 +402,13 @@ void ModulePackageContainer::addDefaultsFromDisk()
     g_autofree gchar * dirPath = g_build_filename(
             pImpl->installRoot.c_str(), "/etc/dnf/modules.defaults.d/", NULL);
 
+    std::vector<std::string> yamlContents;
     for (const auto &file : filesystem::getDirContent(dirPath)) {
-        std::string yamlContent = getFileContent(file);
-        pImpl->moduleMetadata.addMetadataFromString(yamlContent, 1000);
+        yamlContents.push_back(getFileContent(file));
+    }
+    for (auto index : ModuleMetadata::parseMetadata(yamlContents)) {
+        pImpl->moduleMetadata.addMetadataFromIndex(index, 1000);
+        g_object_unref(index);
     }
 }
 
@@ -369,10 +421,17 @@ void ModulePackageContainer::moduleDefaultsResolve()
 void
 ModulePackageContainer::add(const std::string &fileContent, const std::string & repoID)
 {
-    Pool * pool = dnf_sack_get_pool(pImpl->moduleSack);
+    g_autoptr(ModulemdModuleIndex) index = ModuleMetadata::parseMetadata(fileContent);
+    pImpl->addModules(index, repoID);
+}
+
+void
+ModulePackageContainer::Impl::addModules(ModulemdModuleIndex * index, const std::string & repoID)
+{
+    Pool * pool = dnf_sack_get_pool(moduleSack);
 
     ModuleMetadata md;
-    md.addMetadataFromString(fileContent, 0);
+    md.addMetadataFromIndex(index, 0);
     md.resolveAddedMetadata();
 
     LibsolvRepo * r;
@@ -380,13 +439,13 @@ ModulePackageContainer::add(const std::string &fileContent, const std::string &
 
     FOR_REPOS(id, r) {
         if (strcmp(r->name, "available") == 0) {
-            g_autofree gchar * path = g_build_filename(pImpl->installRoot.c_str(),
+            g_autofree gchar * path = g_build_filename(installRoot.c_str(),
                                                       "/etc/dnf/modules.d", NULL);
-            auto packages = md.getAllModulePackages(pImpl->moduleSack, r, repoID, pImpl->modulesV2);
+            auto packages = md.getAllModulePackages(moduleSack, r, repoID, modulesV2);
             for(auto const& modulePackagePtr: packages) {
                 std::unique_ptr<ModulePackage> modulePackage(modulePackagePtr);
-                pImpl->modules.insert(std::make_pair(modulePackage->getId(), std::move(modulePackage)));
-                pImpl->persistor->insert(modulePackagePtr->getName(), path);
+                modules.insert(std::make_pair(modulePackage->getId(), std::move(modulePackage)));
+                persistor->insert(modulePackagePtr->getName(), path);
             }
 
             return;
@@ -432,11 +491,35 @@ bool ModulePackageContainer::empty() const noexcept
     return pImpl->modules.empty();
 }
 
+DnfSack * ModulePackageContainer::getModuleSack() const noexcept
+{
+    return pImpl->moduleSack;
+}
+
 ModulePackage * ModulePackageContainer::getModulePackage(Id id)
 {
     return pImpl->modules.at(id).get();
 }
 
+/// Drop zero epoch from "name-0:version-release.arch" to match the NEVRA of a solvable
+static std::string
+stripZeroEpoch(const std::string & nevra)
+{
+    auto releaseDelim = nevra.rfind('-');
+    if (releaseDelim == std::string::npos || releaseDelim == 0) {
+        return nevra;
+    }
+    auto evrDelim = nevra.rfind('-', releaseDelim - 1);
+    if (evrDelim == std::string::npos) {
+        return nevra;
+    }
+    auto epochEnd = nevra.find_first_not_of('0', evrDelim + 1);
+    if (epochEnd == evrDelim + 1 || epochEnd == std::string::npos || nevra[epochEnd] != ':') {
+        return nevra;
+    }
+    return nevra.substr(0, evrDelim + 1) + nevra.substr(epochEnd + 1);
+}
+
 std::vector<ModulePackage *>
 ModulePackageContainer::requiresModuleEnablement(const PackageSet & packages)
 {
@@ -444,32 +527,36 @@ ModulePackageContainer::requiresModuleEnablement(const PackageSet & packages)
     if (!activatedModules) {
         return {};
     }
+    if (!pImpl->activeArtifacts) {
+        pImpl->activeArtifacts.reset(new std::unordered_map<std::string, std::vector<Id>>);
+        Id moduleId = -1;
+        while ((moduleId = activatedModules->next(moduleId)) != -1) {
+            for (const auto & artifact : getModulePackage(moduleId)->getArtifacts()) {
+                (*pImpl->activeArtifacts)[stripZeroEpoch(artifact)].push_back(moduleId);
+            }
+        }
+    }
+
+    // one lookup per package, modules are reported in the order of their ids
+    Pool * pool = dnf_sack_get_pool(packages.getSack());
+    std::set<Id> hits;
+    Id id = -1;
+    while ((id = packages.next(id)) != -1) {
+        auto it = pImpl->activeArtifacts->find(pool_solvable2str(pool, pool_id2solvable(pool, id)));
+        if (it != pImpl->activeArtifacts->end()) {
+            hits.insert(it->second.begin(), it->second.end());
+        }
+    }
     std::vector<ModulePackage *> output;
-    Query baseQuery(packages.getSack());
-    baseQuery.addFilter(HY_PKG, HY_EQ, &packages);
-    baseQuery.apply();
-    Query testQuery(baseQuery);
-    Id moduleId = -1;
-    while ((moduleId = activatedModules->next(moduleId)) != -1) {
+    for (auto moduleId : hits) {
         auto module = getModulePackage(moduleId);
-        if (isEnabled(module)) {
-            continue;
-        }
-        auto includeNEVRAs = module->getArtifacts();
-        std::vector<const char *> includeNEVRAsCString(includeNEVRAs.size() + 1);
-        transform(includeNEVRAs.begin(), includeNEVRAs.end(), includeNEVRAsCString.begin(),
-                  std::mem_fn(&std::string::c_str));
-        testQuery.queryUnion(baseQuery);
-        testQuery.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, includeNEVRAsCString.data());
-        if (testQuery.empty()) {
-            continue;
+        if (!isEnabled(module)) {
+            output.push_back(module);
         }
-        output.push_back(module);
     }
     return output;
 }
 
-
 /**
  * @brief Is a ModulePackage part of an enabled stream?
  *
@@ -676,6 +763,8 @@ std::pair<std::vector<std::vector<std::string>>, ModulePackageContainer::ModuleE
 ModulePackageContainer::Impl::moduleSolve(const std::vector<ModulePackage *> & modules,
     bool debugSolver)
 {
+    activeArtifacts.reset();
+    activeStreams.clear();
     if (modules.empty()) {
         activatedModules.reset();
         return std::make_pair(std::vector<std::vector<std::string>>(),
@@ -683,6 +772,52 @@ ModulePackageContainer::Impl::moduleSolve(const std::vector<ModulePackage *> & m
     }
     dnf_sack_recompute_considered(moduleSack);
     dnf_sack_make_provides_ready(moduleSack);
+
+    // The solve result depends only on the requested streams (and whether they are optional
+    // defaults), on the solvables in the module sack and on which of them are considered.
+    // When none of that changed since the last call the cascade below would reach the same
+    // outcome, so the stored one is returned instead.
+    std::unique_ptr<SolveCache> cache(new SolveCache);
+    cache->request.reserve(modules.size());
+    for (const auto &module : modules) {
+        bool optional = persistor->getState(module->getName()) == ModuleState::DEFAULT;
+        cache->request.emplace_back(module->getId(), optional);
+    }
+    Pool * pool = dnf_sack_get_pool(moduleSack);
+    cache->nsolvables = pool->nsolvables;
+    cache->hasConsidered = pool->considered != nullptr;
+    if (pool->considered) {
+        cache->considered.assign(pool->considered->map, pool->considered->map + pool->considered->size);
+    }
+    if (!debugSolver && solveCache && solveCache->request == cache->request &&
+        solveCache->nsolvables == cache->nsolvables &&
+        solveCache->hasConsidered == cache->hasConsidered &&
+        solveCache->considered == cache->considered) {
+        if (solveCache->activated) {
+            activatedModules.reset(new PackageSet(*solveCache->activated));
+        } else {
+            activatedModules.reset();
+        }
+        return std::make_pair(solveCache->problems, solveCache->problemType);
+    }
+    solveCache.reset();
+
+    auto result = moduleSolveUncached(modules, debugSolver);
+    // Excludes added while resolving conflicts change the considered map, so the next call is
+    // compared against the state the solve started from; it will simply miss the cache then.
+    cache->problems = result.first;
+    cache->problemType = result.second;
+    if (activatedModules) {
+        cache->activated.reset(new PackageSet(*activatedModules));
+    }
+    solveCache = std::move(cache);
+    return result;
+}
+
+std::pair<std::vector<std::vector<std::string>>, ModulePackageContainer::ModuleErrorType>
+ModulePackageContainer::Impl::moduleSolveUncached(const std::vector<ModulePackage *> & modules,
+    bool debugSolver)
+{
     Goal goal(moduleSack);
     Goal goalWeak(moduleSack);
     for (const auto &module : modules) {
@@ -765,33 +900,89 @@ ModulePackageContainer::query(std::string subject)
     return result;
 }
 
+std::vector<Id>
+ModulePackageContainer::Impl::getIndexedModules(const std::string & name)
+{
+    if (moduleIndexSize != modules.size()) {
+        moduleIndex.clear();
+        for (const auto & item : modules) {
+            auto & module = item.second;
+            moduleIndex[module->getName()][module->getStream()].push_back(item.first);
+        }
+        moduleIndexSize = modules.size();
+    }
+    std::vector<Id> ids;
+    auto collect = [&ids](const std::map<std::string, std::vector<Id>> & streams) {
+        for (const auto & stream : streams) {
+            ids.insert(ids.end(), stream.second.begin(), stream.second.end());
+        }
+    };
+    if (name.empty()) {
+        for (const auto & streams : moduleIndex) {
+            collect(streams.second);
+        }
+    } else {
+        auto it = moduleIndex.find(name);
+        if (it != moduleIndex.end()) {
+            collect(it->second);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+/// Match like HY_GLOB, plain string comparison when the pattern has no wildcards
+static bool
+matchModuleAttribute(const std::string & pattern, bool glob, const char * value)
+{
+    if (!value) {
+        return false;
+    }
+    if (glob) {
+        return fnmatch(pattern.c_str(), value, 0) == 0;
+    }
+    return pattern == value;
+}
+
 std::vector<ModulePackage *>
 ModulePackageContainer::query(std::string name, std::string stream, std::string version,
     std::string context, std::string arch)
 {
     pImpl->addVersion2Modules();
-    // Alternatively a search using module provides could be performed
     std::vector<ModulePackage *> result;
-    Query query(pImpl->moduleSack, Query::ExcludeFlags::IGNORE_EXCLUDES);
-    // platform modules are installed and not in modules std::Map.
-    query.available();
-    if (!name.empty() || !stream.empty()) {
-        std::ostringstream ss;
-        ss << stringFormater(name) << ":" << stringFormater(stream);
-        query.addFilter(HY_PKG_DESCRIPTION, HY_GLOB, ss.str().c_str());
-    }
-    if (!context.empty()) {
-        query.addFilter(HY_PKG_SUMMARY, HY_GLOB, context.c_str());
-    }
-    if (!arch.empty()) {
-        query.addFilter(HY_PKG_ARCH, HY_GLOB, arch.c_str());
-    }
-    if (!version.empty()) {
-        query.addFilter(HY_PKG_VERSION, HY_GLOB, version.c_str());
+    Pool * pool = dnf_sack_get_pool(pImpl->moduleSack);
+    // modules are looked up in the name index; globbing is done only for attributes with wildcards
+    bool globName = hy_is_glob_pattern(name.c_str());
+    std::string nameStream;
+    if (globName || !stream.empty()) {
+        nameStream = stringFormater(name) + ":" + stringFormater(stream);
     }
-    auto pset = query.runSet();
-    Id moduleId = -1;
-    while ((moduleId = pset->next(moduleId)) != -1) {
+    bool globNameStream = !nameStream.empty() && hy_is_glob_pattern(nameStream.c_str());
+    bool globContext = hy_is_glob_pattern(context.c_str());
+    bool globArch = hy_is_glob_pattern(arch.c_str());
+    bool globVersion = hy_is_glob_pattern(version.c_str());
+
+    // platform modules are installed and not in modules std::Map.
+    for (auto moduleId : pImpl->getIndexedModules(globName ? std::string() : name)) {
+        Solvable * solvable = pool_id2solvable(pool, moduleId);
+        if (pool->installed && solvable->repo == pool->installed) {
+            continue;
+        }
+        if (!nameStream.empty() && !matchModuleAttribute(
+                nameStream, globNameStream, solvable_lookup_str(solvable, SOLVABLE_DESCRIPTION))) {
+            continue;
+        }
+        if (!context.empty() && !matchModuleAttribute(
+                context, globContext, solvable_lookup_str(solvable, SOLVABLE_SUMMARY))) {
+            continue;
+        }
+        if (!arch.empty() && !matchModuleAttribute(arch, globArch, pool_id2str(pool, solvable->arch))) {
+            continue;
+        }
+        if (!version.empty() && (solvable->evr == ID_EMPTY ||
+                !matchModuleAttribute(version, globVersion, pool_id2str(pool, solvable->evr)))) {
+            continue;
+        }
         result.push_back(pImpl->modules.at(moduleId).get());
     }
     return result;
@@ -998,21 +1189,33 @@ ModulePackageContainer::getReport()
     return report;
 }
 
+/// Attributes of a module used to group it in getLatestModulesPerRepo(), read once per module
+struct LatestPerRepoKey {
+    ModulePackage * package;
+    const std::string * repoID;
+    const char * name;
+    const char * stream;
+    const char * arch;
+    long long version;
+};
+
 static bool
-modulePackageLatestPerRepoSorter(DnfSack * sack, const ModulePackage * first, const ModulePackage * second)
+modulePackageLatestPerRepoSorter(DnfSack * sack, const LatestPerRepoKey & first, const LatestPerRepoKey & second)
 {
-    if (first->getRepoID() != second->getRepoID())
-        return first->getRepoID() < second->getRepoID();
-    int cmp = g_strcmp0(first->getNameCStr(), second->getNameCStr());
-    if (cmp != 0)
-        return cmp < 0;
-    cmp = dnf_sack_evr_cmp(sack, first->getStreamCStr(), second->getStreamCStr());
+    if (*first.repoID != *second.repoID)
+        return *first.repoID < *second.repoID;
+    int cmp = g_strcmp0(first.name, second.name);
     if (cmp != 0)
         return cmp < 0;
-    cmp = g_strcmp0(first->getArchCStr(), second->getArchCStr());
+    if (g_strcmp0(first.stream, second.stream) != 0) {
+        cmp = dnf_sack_evr_cmp(sack, first.stream, second.stream);
+        if (cmp != 0)
+            return cmp < 0;
+    }
+    cmp = g_strcmp0(first.arch, second.arch);
     if (cmp != 0)
         return cmp < 0;
-    return first->getVersionNum() > second->getVersionNum();
+    return first.version > second.version;
 }
 
 std::vector<std::vector<std::vector<ModulePackage *>>>
@@ -1052,51 +1255,34 @@ ModulePackageContainer::getLatestModulesPerRepo(ModuleState moduleFilter,
         return {};
     }
 
-    std::vector<std::vector<std::vector<ModulePackage *>>> output;
+    std::vector<LatestPerRepoKey> keys;
+    keys.reserve(modulePackages.size());
+    for (auto package : modulePackages) {
+        keys.push_back({package, &package->getRepoID(), package->getNameCStr(), package->getStreamCStr(),
+                        package->getArchCStr(), package->getVersionNum()});
+    }
     auto sack = pImpl->moduleSack;
-    std::sort(modulePackages.begin(), modulePackages.end(),
-              [sack](const ModulePackage * first, const ModulePackage * second)
+    std::sort(keys.begin(), keys.end(),
+              [sack](const LatestPerRepoKey & first, const LatestPerRepoKey & second)
               {return modulePackageLatestPerRepoSorter(sack, first, second);});
-    auto vectorSize = modulePackages.size();
-
-    auto & packageFirst = modulePackages[0];
-    output.push_back(
-        std::vector<std::vector<ModulePackage *>>{std::vector<ModulePackage *> {packageFirst}});
-    int repoIndex = 0;
-    int nameStreamArchIndex = 0;
-    auto repoID = packageFirst->getRepoID();
-    auto name = packageFirst->getNameCStr();
-    auto stream = packageFirst->getStreamCStr();
-    auto arch = packageFirst->getArchCStr();
-    auto version = packageFirst->getVersionNum();
-
-    for (unsigned int index = 1; index < vectorSize; ++index) {
-        auto & package = modulePackages[index];
-        if (repoID != package->getRepoID()) {
-            repoID = package->getRepoID();
-            name = package->getNameCStr();
-            stream = package->getStreamCStr();
-            arch = package->getArchCStr();
-            version = package->getVersionNum();
-            output.push_back(std::vector<std::vector<ModulePackage *>>{std::vector<ModulePackage *> {package}});
-            ++repoIndex;
-            nameStreamArchIndex = 0;
-            continue;
-        }
-        if (g_strcmp0(package->getNameCStr(), name) != 0 ||
-            g_strcmp0(package->getStreamCStr(), stream) != 0 ||
-            g_strcmp0(package->getArchCStr(), arch) != 0) {
-            name = package->getNameCStr();
-            stream = package->getStreamCStr();
-            arch = package->getArchCStr();
-            version = package->getVersionNum();
-            output[repoIndex].push_back(std::vector<ModulePackage *> {package});
-            ++nameStreamArchIndex;
+
+    std::vector<std::vector<std::vector<ModulePackage *>>> output;
+    const LatestPerRepoKey * group = nullptr;
+    for (const auto & key : keys) {
+        bool newRepo = !group || *group->repoID != *key.repoID;
+        if (!newRepo && g_strcmp0(key.name, group->name) == 0 && g_strcmp0(key.stream, group->stream) == 0 &&
+            g_strcmp0(key.arch, group->arch) == 0) {
+            // keys are sorted by version, so only packages with the first (latest) version are kept
+            if (key.version == group->version) {
+                output.back().back().push_back(key.package);
+            }
             continue;
         }
-        if (version == package->getVersionNum()) {
-            output[repoIndex][nameStreamArchIndex].push_back(package);
+        if (newRepo) {
+            output.emplace_back();
         }
+        output.back().emplace_back(1, key.package);
+        group = &key;
     }
     return output;
 }
@@ -1163,7 +1349,9 @@ ModulePackageContainer::resolveActiveModulePackages(bool debugSolver)
         }
     }
     dnf_sack_add_excludes(pImpl->moduleSack, &excludes);
+    LIBDNF_PROBE(module_solve_start, static_cast<int>(packages.size()));
     auto problems = pImpl->moduleSolve(packages, debugSolver);
+    LIBDNF_PROBE(module_solve_end, static_cast<int>(problems.first.size()));
     return problems;
 }
 
@@ -1175,6 +1363,33 @@ bool ModulePackageContainer::isModuleActive(Id id)
     return false;
 }
 
+bool ModulePackageContainer::isModuleActive(const std::string & name, const std::string & stream,
+    const std::string & context)
+{
+    if (pImpl->activeStreamsSize != pImpl->modules.size()) {
+        pImpl->activeStreams.clear();
+        pImpl->activeStreamsSize = pImpl->modules.size();
+    }
+    std::string key;
+    key.reserve(name.size() + stream.size() + context.size() + 2);
+    key.append(name).push_back('\0');
+    key.append(stream).push_back('\0');
+    key.append(context);
+    auto it = pImpl->activeStreams.find(key);
+    if (it != pImpl->activeStreams.end()) {
+        return it->second;
+    }
+    bool active = false;
+    for (auto module : query(name, stream, {}, context, {})) {
+        if (isModuleActive(module)) {
+            active = true;
+            break;
+        }
+    }
+    pImpl->activeStreams.emplace(std::move(key), active);
+    return active;
+}
+
 bool ModulePackageContainer::isModuleActive(const ModulePackage * modulePackage)
 {
     if (pImpl->activatedModules) {
@@ -1683,35 +1898,75 @@ void ModulePackageContainer::loadFailSafeData()
     auto fileNames = getYamlFilenames(pImpl->persistDir.c_str());
     auto begin = fileNames.begin();
     auto end = fileNames.end();
+    // files of all missing streams are read first and parsed in one parallel batch
+    std::vector<std::pair<std::string, std::string>> streams;
+    std::vector<bool> streamLoaded;
+    std::vector<std::string> files;
+    std::vector<std::size_t> fileStreams;
+    std::vector<std::string> yamlContents;
     for (auto & pair: enabledStreams) {
         if (!pair.second.second) {
             // load from disk
             std::ostringstream ss;
             ss << pair.first << ":" << pair.second.first << ":";
-            bool loaded = false;
+            streams.emplace_back(pair.first, pair.second.first);
+            streamLoaded.push_back(false);
             auto searchPrefix = ss.str();
             auto low = std::lower_bound(begin, end, searchPrefix, stringStartWithLowerComparator);
             for (; low != end && string::startsWith((*low), searchPrefix); ++low) {
                 g_autofree gchar * file = g_build_filename(
                     pImpl->persistDir.c_str(), low->c_str(), NULL);
                 try {
-                    auto yamlContent = getFileContent(file);
-                    add(yamlContent, LIBDNF_MODULE_FAIL_SAFE_REPO_NAME);
-                    loaded = true;
+                    yamlContents.push_back(getFileContent(file));
+                    files.push_back(file);
+                    fileStreams.push_back(streams.size() - 1);
                 } catch (const std::exception &) {
                     auto logger(Log::getLogger());
                     logger->debug(tfm::format(
                         _("Unable to load modular Fail-Safe data at '%s'"), file));
                 }
             }
-            if (!loaded) {
-                auto logger(Log::getLogger());
-                logger->debug(tfm::format(
-                            _("Unable to load modular Fail-Safe data for module '%s:%s'"),
-                                          pair.first, pair.second.first));
+        }
+    }
+    std::vector<ModulemdModuleIndex *> indexes;
+    try {
+        indexes = ModuleMetadata::parseMetadata(yamlContents);
+    } catch (const std::exception &) {
+        // some file is broken, parse them one by one to load the others
+        for (auto & yamlContent : yamlContents) {
+            try {
+                indexes.push_back(ModuleMetadata::parseMetadata(yamlContent));
+            } catch (const std::exception &) {
+                indexes.push_back(nullptr);
             }
         }
     }
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+        bool loaded = false;
+        if (indexes[i]) {
+            try {
+                pImpl->addModules(indexes[i], LIBDNF_MODULE_FAIL_SAFE_REPO_NAME);
+                loaded = true;
+            } catch (const std::exception &) {
+            }
+            g_object_unref(indexes[i]);
+        }
+        if (loaded) {
+            streamLoaded[fileStreams[i]] = true;
+        } else {
+            auto logger(Log::getLogger());
+            logger->debug(tfm::format(
+                _("Unable to load modular Fail-Safe data at '%s'"), files[i]));
+        }
+    }
+    for (std::size_t i = 0; i < streams.size(); ++i) {
+        if (!streamLoaded[i]) {
+            auto logger(Log::getLogger());
+            logger->debug(tfm::format(
+                        _("Unable to load modular Fail-Safe data for module '%s:%s'"),
+                                      streams[i].first, streams[i].second));
+        }
+    }
 }
 
 std::vector<ModulePackage *> ModulePackageContainer::Impl::getLatestActiveEnabledModules()
@@ -127,6 +127,11 @@ public:
      */
     bool empty() const noexcept;
 
+    /**
+    * @brief Return the sack holding the module packages, it is owned by the container
+    */
+    DnfSack * getModuleSack() const noexcept;
+
     /**
     * @brief Can throw std::out_of_range exception
     */
@@ -296,6 +301,11 @@ public:
     std::pair<std::vector<std::vector<std::string>>, ModulePackageContainer::ModuleErrorType> resolveActiveModulePackages(bool debugSolver);
     bool isModuleActive(Id id);
     bool isModuleActive(const ModulePackage * modulePackage);
+    /**
+    * @brief Return true when any module matched by query(name, stream, "", context, "") is active. The answer
+    * is remembered until modules are added or resolved again.
+    */
+    bool isModuleActive(const std::string & name, const std::string & stream, const std::string & context);
     void loadFailSafeData();
     void updateFailSafeData();
     void applyObsoletes();
@@ -20,6 +20,8 @@
 
 #include "ModuleMetadata.hpp"
 
+#include <algorithm>
+
 #include "../ModulePackageContainer.hpp"
 
 #include "bgettext/bgettext-lib.h"
@@ -74,7 +76,34 @@ ModuleMetadata::~ModuleMetadata()
 
 void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priority)
 {
-    GError *error = NULL;
+    ModulemdModuleIndex * mi = parseMetadata(yaml);
+    addMetadataFromIndex(mi, priority);
+    g_object_unref(mi);
+}
+
+namespace {
+
+struct ParseJob {
+    const std::string * yaml;
+    ModulemdModuleIndex * index;
+    GPtrArray * failures;
+    GError * error;
+    gboolean success;
+};
+
+void parseJobCb(gpointer data, gpointer)
+{
+    auto job = static_cast<ParseJob *>(data);
+    job->index = modulemd_module_index_new();
+    job->success = modulemd_module_index_update_from_string(
+        job->index, job->yaml->c_str(), FALSE, &job->failures, &job->error);
+}
+
+}
+
+ModulemdModuleIndex * ModuleMetadata::parseMetadata(const std::string & yaml)
+{
+    g_autoptr(GError) error = NULL;
     g_autoptr(GPtrArray) failures = NULL;
 
     ModulemdModuleIndex * mi = modulemd_module_index_new();
@@ -82,9 +111,69 @@ void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priorit
     if(!success){
         ModuleMetadata::reportFailures(failures);
     }
-    if (error)
+    if (error) {
+        g_object_unref(mi);
         throw ModulePackageContainer::ResolveException( tfm::format(_("Failed to update from string: %s"), error->message));
+    }
+    return mi;
+}
 
+std::vector<ModulemdModuleIndex *> ModuleMetadata::parseMetadata(const std::vector<std::string> & yamls)
+{
+    std::vector<ParseJob> jobs;
+    jobs.reserve(yamls.size());
+    for (const auto & yaml : yamls) {
+        jobs.push_back({&yaml, nullptr, nullptr, nullptr, false});
+    }
+
+    // documents are independent, only the merge has to keep the priority order
+    auto threads = std::min(static_cast<std::size_t>(g_get_num_processors()), jobs.size());
+    GError * error = NULL;
+    GThreadPool * pool = threads > 1 ?
+        g_thread_pool_new(parseJobCb, NULL, static_cast<gint>(threads), TRUE, &error) : NULL;
+    if (pool) {
+        for (auto & job : jobs) {
+            g_thread_pool_push(pool, &job, NULL);
+        }
+        g_thread_pool_free(pool, FALSE, TRUE);
+    } else {
+        g_clear_error(&error);
+        for (auto & job : jobs) {
+            parseJobCb(&job, NULL);
+        }
+    }
+
+    // failures are reported and errors thrown from the calling thread, in the order of documents
+    std::vector<ModulemdModuleIndex *> indexes;
+    indexes.reserve(jobs.size());
+    std::string errorMessage;
+    for (auto & job : jobs) {
+        if (job.failures) {
+            if (!job.success) {
+                ModuleMetadata::reportFailures(job.failures);
+            }
+            g_ptr_array_unref(job.failures);
+        }
+        if (job.error) {
+            if (errorMessage.empty()) {
+                errorMessage = job.error->message;
+            }
+            g_error_free(job.error);
+        }
+        indexes.push_back(job.index);
+    }
+    if (!errorMessage.empty()) {
+        for (auto index : indexes) {
+            g_object_unref(index);
+        }
+        throw ModulePackageContainer::ResolveException(
+            tfm::format(_("Failed to update from string: %s"), errorMessage));
+    }
+    return indexes;
+}
+
+void ModuleMetadata::addMetadataFromIndex(ModulemdModuleIndex * mi, int priority)
+{
     if (!moduleMerger){
         moduleMerger = modulemd_module_index_merger_new();
         if (resultingModuleIndex){
@@ -95,7 +184,6 @@ void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priorit
     }
 
     modulemd_module_index_merger_associate_index(moduleMerger, mi, priority);
-    g_object_unref(mi);
 }
 
 void ModuleMetadata::resolveAddedMetadata()
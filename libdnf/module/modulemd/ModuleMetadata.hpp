@@ -35,6 +35,13 @@ public:
     ModuleMetadata & operator=(const ModuleMetadata & m);
     ~ModuleMetadata();
     void addMetadataFromString(const std::string & yaml, int priority);
+    /// Parse yaml into a module index, the caller owns the returned reference
+    static ModulemdModuleIndex * parseMetadata(const std::string & yaml);
+    /// Parse several yaml documents in parallel, returned indexes are in the order of yamls and owned
+    /// by the caller
+    static std::vector<ModulemdModuleIndex *> parseMetadata(const std::vector<std::string> & yamls);
+    /// Add an already parsed index, it can be shared by several ModuleMetadata objects
+    void addMetadataFromIndex(ModulemdModuleIndex * index, int priority);
     void resolveAddedMetadata();
     std::vector<ModulePackage *> getAllModulePackages(DnfSack * moduleSack, LibsolvRepo * repo, const std::string & repoID, std::vector<std::tuple<LibsolvRepo *, ModulemdModuleStream *, std::string>> & modulesV2);
     std::map<std::string, std::string> getDefaultStreams();
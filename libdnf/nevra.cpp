@@ -22,38 +22,104 @@
 #include "hy-nevra.h"
 #include "dnf-sack.h"
 
-#include "regex/regex.hpp"
+#include <cstdlib>
+#include <cstring>
 
 namespace libdnf {
 
-#define PKG_NAME "([^:(/=<> ]+)"
-#define PKG_EPOCH "(([0-9]+):)?"
-#define PKG_VERSION "([^-:(/=<> ]+)"
-#define PKG_RELEASE PKG_VERSION
-#define PKG_ARCH "([^-:.(/=<> ]+)"
+// Characters not allowed in the individual parts, ':' may only follow the epoch
+static const char NAME_FORBIDDEN[] = ":(/=<> ";
+static const char VERSION_FORBIDDEN[] = "-:(/=<> ";
+static const char ARCH_FORBIDDEN[] = "-:.(/=<> ";
 
-static const Regex NEVRA_FORM_REGEX[]{
-    Regex("^" PKG_NAME "-" PKG_EPOCH PKG_VERSION "-" PKG_RELEASE "\\." PKG_ARCH "$", REG_EXTENDED),
-    Regex("^" PKG_NAME "-" PKG_EPOCH PKG_VERSION "-" PKG_RELEASE          "()"  "$", REG_EXTENDED),
-    Regex("^" PKG_NAME "-" PKG_EPOCH PKG_VERSION        "()"              "()"  "$", REG_EXTENDED),
-    Regex("^" PKG_NAME      "()()"      "()"            "()"     "\\." PKG_ARCH "$", REG_EXTENDED),
-    Regex("^" PKG_NAME      "()()"      "()"            "()"              "()"  "$", REG_EXTENDED)
-};
+/// Returns true if [begin, end) is not empty and contains none of the forbidden characters.
+static bool
+isValidPart(const char * begin, const char * end, const char * forbidden)
+{
+    if (begin == end)
+        return false;
+    for (auto it = begin; it != end; ++it) {
+        if (std::strchr(forbidden, *it))
+            return false;
+    }
+    return true;
+}
+
+/// Returns the last occurrence of `c` in [begin, end) or nullptr.
+static const char *
+findLast(const char * begin, const char * end, char c)
+{
+    while (end != begin) {
+        if (*--end == c)
+            return end;
+    }
+    return nullptr;
+}
 
+/**
+* @brief Splits the string right-to-left. The version, release and arch can't contain the
+* delimiter preceding them, so every delimiter is the last one left. It accepts exactly
+* the strings accepted by the patterns
+*   ^NAME-(EPOCH:)?VERSION-RELEASE\.ARCH$ and their shorter forms.
+*/
 bool Nevra::parse(const char * nevraStr, HyForm form)
 {
-    enum { NAME = 1, EPOCH = 3, VERSION = 4, RELEASE = 5, ARCH = 6, _LAST_ };
-    auto matchResult = NEVRA_FORM_REGEX[form - 1].match(nevraStr, false, _LAST_);
-    if (!matchResult.isMatched() || matchResult.getMatchedLen(NAME) == 0)
+    if (form < HY_FORM_NEVRA || form > HY_FORM_NAME)
         return false;
-    name = matchResult.getMatchedString(NAME);
-    if (matchResult.getMatchedLen(EPOCH) > 0)
-        epoch = atoi(matchResult.getMatchedString(EPOCH).c_str());
-    else
-        epoch = EPOCH_NOT_SET;
-    version = matchResult.getMatchedString(VERSION);
-    release = matchResult.getMatchedString(RELEASE);
-    arch = matchResult.getMatchedString(ARCH);
+    bool hasArch = form == HY_FORM_NEVRA || form == HY_FORM_NA;
+    bool hasRelease = form == HY_FORM_NEVRA || form == HY_FORM_NEVR;
+    bool hasVersion = hasRelease || form == HY_FORM_NEV;
+
+    const char * end = nevraStr + std::strlen(nevraStr);
+    const char * archBegin = end;
+    const char * archEnd = end;
+    if (hasArch) {
+        auto delim = findLast(nevraStr, end, '.');
+        if (!delim || !isValidPart(delim + 1, end, ARCH_FORBIDDEN))
+            return false;
+        archBegin = delim + 1;
+        end = delim;
+    }
+    const char * releaseBegin = end;
+    const char * releaseEnd = end;
+    if (hasRelease) {
+        auto delim = findLast(nevraStr, end, '-');
+        if (!delim || !isValidPart(delim + 1, end, VERSION_FORBIDDEN))
+            return false;
+        releaseBegin = delim + 1;
+        end = delim;
+    }
+    const char * epochEnd = nullptr;
+    const char * versionBegin = end;
+    const char * versionEnd = end;
+    if (hasVersion) {
+        auto delim = findLast(nevraStr, end, '-');
+        if (!delim)
+            return false;
+        versionBegin = delim + 1;
+        auto colon = static_cast<const char *>(std::memchr(versionBegin, ':', end - versionBegin));
+        if (colon) {
+            if (colon == versionBegin)
+                return false;
+            for (auto it = versionBegin; it != colon; ++it) {
+                if (*it < '0' || *it > '9')
+                    return false;
+            }
+            epochEnd = colon;
+            versionBegin = colon + 1;
+        }
+        if (!isValidPart(versionBegin, end, VERSION_FORBIDDEN))
+            return false;
+        end = delim;
+    }
+    if (!isValidPart(nevraStr, end, NAME_FORBIDDEN))
+        return false;
+
+    name.assign(nevraStr, end);
+    epoch = epochEnd ? std::atoi(end + 1) : EPOCH_NOT_SET;
+    version.assign(versionBegin, versionEnd);
+    release.assign(releaseBegin, releaseEnd);
+    arch.assign(archBegin, archEnd);
     return true;
 }
 
@@ -26,48 +26,142 @@
 
 #include "libdnf/utils/utils.hpp"
 
-#include <regex/regex.hpp>
+#include <cstring>
 
 namespace libdnf {
 
-#define MODULE_NAME "([" GLOB ASCII_LETTERS DIGITS MODULE_SPECIAL "]+)"
-#define MODULE_STREAM MODULE_NAME
-#define MODULE_VERSION "([" GLOB DIGITS "-]+)"
-#define MODULE_CONTEXT MODULE_NAME
-#define MODULE_ARCH MODULE_NAME
-#define MODULE_PROFILE MODULE_NAME
-
-static const Regex NSVCAP_FORM_REGEX[]{
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT "::?" MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT "::?" MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"           "::"  MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"           "::"  MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"           "::"  MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"           "::"  MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT       "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"                 "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT       "()"        "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"                 "()"        "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"                 "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"                 "()"        "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"           "::"  MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"           "::"  MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"                 "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"                 "()"        "\\/?" "()"           "$", REG_EXTENDED)
+static const char MODULE_NAME_CHARS[] = GLOB ASCII_LETTERS DIGITS MODULE_SPECIAL;
+static const char MODULE_VERSION_CHARS[] = GLOB DIGITS "-";
+
+/// Which parts a form consists of, in the order of HyModuleForm
+struct NsvcapLayout {
+    bool stream;
+    bool version;
+    bool context;
+    bool arch;
+    bool profile;
+};
+
+static const NsvcapLayout NSVCAP_FORM_LAYOUT[]{
+    {true,  true,  true,  true,  true},     // HY_MODULE_FORM_NSVCAP
+    {true,  true,  true,  true,  false},    // HY_MODULE_FORM_NSVCA
+    {true,  true,  false, true,  true},     // HY_MODULE_FORM_NSVAP
+    {true,  true,  false, true,  false},    // HY_MODULE_FORM_NSVA
+    {true,  false, false, true,  true},     // HY_MODULE_FORM_NSAP
+    {true,  false, false, true,  false},    // HY_MODULE_FORM_NSA
+    {true,  true,  true,  false, true},     // HY_MODULE_FORM_NSVCP
+    {true,  true,  false, false, true},     // HY_MODULE_FORM_NSVP
+    {true,  true,  true,  false, false},    // HY_MODULE_FORM_NSVC
+    {true,  true,  false, false, false},    // HY_MODULE_FORM_NSV
+    {true,  false, false, false, true},     // HY_MODULE_FORM_NSP
+    {true,  false, false, false, false},    // HY_MODULE_FORM_NS
+    {false, false, false, true,  true},     // HY_MODULE_FORM_NAP
+    {false, false, false, true,  false},    // HY_MODULE_FORM_NA
+    {false, false, false, false, true},     // HY_MODULE_FORM_NP
+    {false, false, false, false, false}     // HY_MODULE_FORM_N
+};
+
+namespace {
+
+struct Part {
+    const char * begin;
+    const char * end;
+
+    bool empty() const noexcept { return begin == end; }
+    std::string str() const { return std::string(begin, end); }
+
+    /// Returns true if the part is not empty and contains only the given characters
+    bool consistsOf(const char * chars) const noexcept
+    {
+        if (empty())
+            return false;
+        for (auto it = begin; it != end; ++it) {
+            if (!std::strchr(chars, *it))
+                return false;
+        }
+        return true;
+    }
 };
 
+}
+
+/**
+* @brief No part can contain ':' or '/', so the string is split on them and the parts are
+* assigned according to the layout of the form. An arch is preceded by "::", or by one or two
+* colons after a context. A form without profile allows a trailing '/'.
+*/
 bool Nsvcap::parse(const char *nsvcapStr, HyModuleForm form)
 {
-    enum { NAME = 1, STREAM = 2, VERSION = 3, CONTEXT = 4, ARCH = 5, PROFILE = 6, _LAST_ };
-    auto matchResult = NSVCAP_FORM_REGEX[form - 1].match(nsvcapStr, false, _LAST_);
-    if (!matchResult.isMatched() || matchResult.getMatchedLen(NAME) == 0)
+    if (form < HY_MODULE_FORM_NSVCAP || form > HY_MODULE_FORM_N)
+        return false;
+    const auto & layout = NSVCAP_FORM_LAYOUT[form - 1];
+
+    // at most name:stream:version:context::arch
+    enum { MAX_PARTS = 6 };
+    Part parts[MAX_PARTS];
+    std::size_t partsCount = 0;
+    Part profilePart{nullptr, nullptr};
+    const char * begin = nsvcapStr;
+    for (const char * it = nsvcapStr;; ++it) {
+        if (*it == ':' || *it == '/' || *it == '\0') {
+            if (partsCount == MAX_PARTS)
+                return false;
+            parts[partsCount++] = {begin, it};
+            if (*it == '/') {
+                profilePart.begin = it + 1;
+                profilePart.end = profilePart.begin + std::strlen(profilePart.begin);
+                break;
+            }
+            if (*it == '\0')
+                break;
+            begin = it + 1;
+        }
+    }
+    if (layout.profile ? !profilePart.consistsOf(MODULE_NAME_CHARS) : !profilePart.empty())
         return false;
-    name = matchResult.getMatchedString(NAME);
-    version = matchResult.getMatchedString(VERSION);
-    stream = matchResult.getMatchedString(STREAM);
-    context = matchResult.getMatchedString(CONTEXT);
-    arch = matchResult.getMatchedString(ARCH);
-    profile = matchResult.getMatchedString(PROFILE);
+
+    std::size_t idx = 0;
+    auto next = [&]() -> const Part * { return idx < partsCount ? &parts[idx++] : nullptr; };
+    const Part * namePart = next();
+    if (!namePart || !namePart->consistsOf(MODULE_NAME_CHARS))
+        return false;
+    const Part * streamPart = nullptr;
+    if (layout.stream) {
+        streamPart = next();
+        if (!streamPart || !streamPart->consistsOf(MODULE_NAME_CHARS))
+            return false;
+    }
+    const Part * versionPart = nullptr;
+    if (layout.version) {
+        versionPart = next();
+        if (!versionPart || !versionPart->consistsOf(MODULE_VERSION_CHARS))
+            return false;
+    }
+    const Part * contextPart = nullptr;
+    if (layout.context) {
+        contextPart = next();
+        if (!contextPart || !contextPart->consistsOf(MODULE_NAME_CHARS))
+            return false;
+    }
+    const Part * archPart = nullptr;
+    if (layout.arch) {
+        archPart = next();
+        if (archPart && archPart->empty())
+            archPart = next();
+        else if (!layout.context)
+            return false;
+        if (!archPart || !archPart->consistsOf(MODULE_NAME_CHARS))
+            return false;
+    }
+    if (idx != partsCount)
+        return false;
+
+    name = namePart->str();
+    stream = streamPart ? streamPart->str() : std::string();
+    version = versionPart ? versionPart->str() : std::string();
+    context = contextPart ? contextPart->str() : std::string();
+    arch = archPart ? archPart->str() : std::string();
+    profile = profilePart.begin ? profilePart.str() : std::string();
     return true;
 }
 
@@ -64,6 +64,7 @@ public:
     decltype(&pluginInitHandle) initHandle;
     decltype(&pluginFreeHandle) freeHandle;
     decltype(&pluginHook) hook;
+    PluginHookMask hookMask;
 };
 
 class Plugins {
@@ -85,6 +86,8 @@ private:
         PluginHandle * handle;
     };
     std::vector<PluginWithData> pluginsWithData;
+    // indexes into pluginsWithData of the initialized plugins, one list per known hook id
+    std::vector<std::vector<size_t>> hookSubscribers;
 };
 
 inline size_t Plugins::count() const
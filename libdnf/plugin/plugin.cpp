@@ -35,6 +35,8 @@
 
 #define PLUGIN_API_VERSION 1
 
+static constexpr size_t HOOK_ID_COUNT = PLUGIN_HOOK_ID_CONTEXT_PRE_REPOS_RELOAD - PLUGIN_HOOK_ID_CONTEXT_PRE_CONF + 1;
+
 namespace libdnf {
 
 Library::Library(const char * path)
@@ -78,6 +80,8 @@ Plugin::Plugin(const char * path) : Library(path)
         const char * errMsg = dlerror();
         throw std::runtime_error(tfm::format(_("Can't obtain address of symbol \"%s\": %s"), "pluginHook", errMsg));
     }
+    auto getHookMask = reinterpret_cast<decltype(&pluginGetHookMask)>(dlsym(handle, "pluginGetHookMask"));
+    hookMask = getHookMask ? getHookMask() : PLUGIN_HOOK_MASK_ALL;
 }
 
 void Plugins::loadPlugin(const std::string & path)
@@ -124,7 +128,9 @@ void Plugins::loadPlugins(std::string dirPath)
 
 bool Plugins::init(PluginMode mode, PluginInitData * initData)
 {
-    for (auto & pluginWithData : pluginsWithData) {
+    hookSubscribers.assign(HOOK_ID_COUNT, {});
+    for (size_t idx = 0; idx < pluginsWithData.size(); ++idx) {
+        auto & pluginWithData = pluginsWithData[idx];
         if (!pluginWithData.enabled) {
             continue;
         }
@@ -132,6 +138,12 @@ bool Plugins::init(PluginMode mode, PluginInitData * initData)
         if (!pluginWithData.handle) {
             return false;
         }
+        auto hookMask = pluginWithData.plugin->hookMask;
+        for (size_t hookIdx = 0; hookIdx < HOOK_ID_COUNT; ++hookIdx) {
+            if (hookMask & (1u << hookIdx)) {
+                hookSubscribers[hookIdx].push_back(idx);
+            }
+        }
     }
     return true;
 }
@@ -147,7 +159,22 @@ void Plugins::free()
 
 bool Plugins::hook(PluginHookId id, PluginHookData * hookData, DnfPluginError * error)
 {
-    for (auto & pluginWithData : pluginsWithData) {
+    auto hookIdx = static_cast<size_t>(id - PLUGIN_HOOK_ID_CONTEXT_PRE_CONF);
+    if (id < PLUGIN_HOOK_ID_CONTEXT_PRE_CONF || hookIdx >= hookSubscribers.size()) {
+        // unknown hook, only plugins without a hook mask may handle it
+        for (auto & pluginWithData : pluginsWithData) {
+            if (!pluginWithData.enabled || !pluginWithData.handle ||
+                pluginWithData.plugin->hookMask != PLUGIN_HOOK_MASK_ALL) {
+                continue;
+            }
+            if (!pluginWithData.plugin->hook(pluginWithData.handle, id, hookData, error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    for (auto idx : hookSubscribers[hookIdx]) {
+        auto & pluginWithData = pluginsWithData[idx];
         if (!pluginWithData.enabled || !pluginWithData.handle) {
             continue;
         }
@@ -41,6 +41,11 @@ typedef enum {
     PLUGIN_HOOK_ID_CONTEXT_PRE_REPOS_RELOAD
 } PluginHookId;
 
+// Set of hooks a plugin handles, a bitwise OR of PLUGIN_HOOK_MASK() values.
+typedef unsigned int PluginHookMask;
+#define PLUGIN_HOOK_MASK(id) (1u << ((id) - PLUGIN_HOOK_ID_CONTEXT_PRE_CONF))
+#define PLUGIN_HOOK_MASK_ALL (~0u)
+
 #ifdef __cplusplus
 namespace libdnf {
     struct PluginError;
@@ -78,6 +83,9 @@ const PluginInfo * pluginGetInfo(void);
 PluginHandle * pluginInitHandle(int version, PluginMode mode, DnfPluginInitData * initData);
 void pluginFreeHandle(PluginHandle * handle);
 int pluginHook(PluginHandle * handle, PluginHookId id, DnfPluginHookData * data, DnfPluginError * error);
+// Optional. pluginHook() is called only with the hooks from the returned mask.
+// A plugin which does not implement it receives all the hooks.
+PluginHookMask pluginGetHookMask(void);
 
 #ifdef __cplusplus
 }
@@ -21,22 +21,29 @@
 #include "DependencySplitter.hpp"
 #include "../dnf-sack.h"
 #include "../log.hpp"
-#include "../utils/regex/regex.hpp"
 
 #include "bgettext/bgettext-lib.h"
 #include "tinyformat/tinyformat.hpp"
 
 namespace libdnf {
 
-static const Regex RELDEP_REGEX = 
-    Regex("^(\\S*)\\s*(<=|>=|<|>|=|==)?\\s*(\\S*)$", REG_EXTENDED);
+// the same characters POSIX \s matches in the C locale
+static inline bool
+isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline bool
+isCmpChar(char c)
+{
+    return c == '<' || c == '>' || c == '=';
+}
 
 static bool
-getCmpFlags(int *cmp_type, std::string matchCmpType)
+getCmpFlags(int *cmp_type, const char * match_start, int subexpr_len)
 {
     auto logger(Log::getLogger());
-    int subexpr_len = matchCmpType.size();
-    auto match_start = matchCmpType.c_str();
     if (subexpr_len == 2) {
         if (strncmp(match_start, "<=", 2) == 0) {
             *cmp_type |= HY_LT;
@@ -69,19 +76,41 @@ getCmpFlags(int *cmp_type, std::string matchCmpType)
     return true;
 }
 
+/* Hand-written equivalent of matching "^(\S*)\s*(<=|>=|<|>|=|==)?\s*(\S*)$" with POSIX
+ * leftmost-longest rules: the name is the longest non-space prefix, the comparison operator
+ * the longest one the rest starts with. */
 bool
 DependencySplitter::parse(const char * reldepStr)
 {
-    enum { NAME = 1, CMP_TYPE = 2, EVR = 3, _LAST_ };
-    auto matchResult = RELDEP_REGEX.match(reldepStr, false, _LAST_);
-    if (!matchResult.isMatched() || matchResult.getMatchedLen(NAME) == 0) {
+    const char * p = reldepStr;
+    while (*p && !isSpace(*p))
+        ++p;
+    if (p == reldepStr)
         return false;
+    const char * nameEnd = p;
+    while (isSpace(*p))
+        ++p;
+
+    const char * cmpStart = p;
+    int cmpTypeLen = 0;
+    if (isCmpChar(p[0])) {
+        // "<=", ">=" and "==" win over their one character prefixes
+        cmpTypeLen = p[1] == '=' ? 2 : 1;
+        p += cmpTypeLen;
+        while (isSpace(*p))
+            ++p;
     }
-    name = matchResult.getMatchedString(NAME);
-    evr = matchResult.getMatchedString(EVR);
+
+    const char * evrStart = p;
+    while (*p && !isSpace(*p))
+        ++p;
+    if (*p)
+        return false;
+    int evrLen = p - evrStart;
+
+    name.assign(reldepStr, nameEnd - reldepStr);
+    evr.assign(evrStart, evrLen);
     cmpType = 0;
-    int evrLen = matchResult.getMatchedLen(EVR);
-    int cmpTypeLen = matchResult.getMatchedLen(CMP_TYPE);
     if (cmpTypeLen < 1) {
         if (evrLen > 0) {
             // name contains the space char, e.g. filename like "hello world.jpg"
@@ -93,7 +122,7 @@ DependencySplitter::parse(const char * reldepStr)
     if (evrLen < 1)
         return false;
 
-    return getCmpFlags(&cmpType, matchResult.getMatchedString(CMP_TYPE));
+    return getCmpFlags(&cmpType, cmpStart, cmpTypeLen);
 }
 
 }
@@ -42,6 +42,7 @@
 #include <solv/util.h>
 
 #include <cctype>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <set>
@@ -59,6 +60,8 @@
 /* "other" in this context is not a generic "any other metadata", but real metadata type named "other"
  * containing changelogs for packages */
 #define MD_TYPE_OTHER "other"
+/* solv file of the primary prebuilt by dnf_sack_write_solv_snapshot() */
+#define MD_TYPE_PRIMARY_SOLV "primary_solv"
 
 enum _hy_repo_state {
     _HY_NEW,
@@ -126,7 +129,24 @@ public:
     void setHttpHeaders(const char * headers[]);
     const char * const * getHttpHeaders() const;
     const std::string & getMetadataPath(const std::string &metadataType) const;
-
+    /// True if load() left out the primary for streamPrimaryLoad()
+    bool streamPrimaryPending() const;
+    /**
+    * @brief Downloads the primary left out by load() and passes it to parse() while it arrives.
+    * The primary is verified against its checksum in repomd.xml once the download finished. If
+    * the stream fails or does not match, the primary is downloaded again and verified.
+    *
+    * @param parse parses the decompressed primary, returns false on a parsing error
+    * @return bool true if parse() succeeded on the verified data, otherwise what parse() added
+    * is to be discarded and the primary read from getMetadataPath()
+    */
+    bool streamPrimaryLoad(const std::function<bool(FILE *)> & parse);
+
+    std::vector<const char *> downloadList(bool withPrimary) const;
+    // The parsed repomd of the cachedir, kept until repomd.xml or the loaded metadata change
+    std::string getCacheStateKey() const;
+    bool loadCacheState();
+    void writeCacheState();
     std::unique_ptr<LrHandle> lrHandleInitBase();
     std::unique_ptr<LrHandle> lrHandleInitLocal();
     std::unique_ptr<LrHandle> lrHandleInitRemote(const char *destdir);
@@ -154,15 +174,31 @@ public:
     std::vector<std::string> content_tags;
     std::vector<std::pair<std::string, std::string>> distro_tags;
     std::vector<std::pair<std::string, std::string>> metadata_locations;
-    unsigned char checksum[CHKSUM_BYTES];
+    unsigned char checksum[CHKSUM_BYTES]{};
+    unsigned char repomdStat[CHKSUM_BYTES]{}; // checksum_stat() of repomd.xml at the time of checksum
     bool useIncludes{false};
     bool loadMetadataOther;
+    bool streamPrimary{false};
+    // the primary record of repomd.xml while the primary waits for streamPrimaryLoad()
+    std::string streamPrimaryHref;
+    std::string streamPrimaryChecksumType;
+    std::string streamPrimaryChecksum;
     std::map<std::string, std::string> substitutions;
 
     std::unique_ptr<RepoCB> callbacks;
     std::string repoFilePath;
     LrHandle * getCachedHandle();
 
+    // Observed performance of a mirror, kept across runs in the cachedir
+    struct MirrorScore {
+        double throughput{0}; // bytes per second, 0 if unknown
+        int failures{0}; // failures since the last successful transfer
+        int64_t lastFailure{0};
+    };
+    void recordMirrorSuccess(const char * url, double throughput);
+    void recordMirrorFailure(const char * url);
+    void saveMirrorScores();
+
     SyncStrategy syncStrategy;
     std::map<std::string, std::string> metadataPaths;
 
@@ -180,6 +216,10 @@ public:
     Id updateinfo_repodata{0};
     Id other_repodata{0};
     int load_flags{0};
+    /* DNF_SACK_LOAD_FLAG_USE_* of the extensions dropped by dnf_sack_unload_repo_exts() */
+    int unloaded_exts{0};
+    /* advisory name -> description, parsed on demand for repos loaded with slim updateinfo */
+    std::unique_ptr<std::map<std::string, std::string>> updateinfoDescriptions;
     /* the following three elements are needed for repo rewriting */
     int main_nsolvables{0};
     int main_nrepodata{0};
@@ -198,6 +238,9 @@ private:
     void resetMetadataExpired();
     std::vector<Key> retrieve(const std::string & url);
     void importRepoKeys();
+    void loadMirrorScores();
+    void applyMirrorScores(LrHandle * h);
+    std::string findMirror(const char * url) const;
 
     static int progressCB(void * data, double totalToDownload, double downloaded);
     static void fastestMirrorCB(void * data, LrFastestMirrorStages stage, void *ptr);
@@ -205,6 +248,9 @@ private:
 
     bool expired;
     std::unique_ptr<LrHandle> handle;
+    std::map<std::string, MirrorScore> mirrorScores;
+    bool mirrorScoresLoaded{false};
+    bool mirrorScoresChanged{false};
     std::unique_ptr<char*[], std::function<void(char **)>> httpHeaders{nullptr, [](char ** ptr)
     {
         for (auto item = ptr; *item; ++item)
@@ -36,6 +36,7 @@
 #include "libdnf/utils/File.hpp"
 #include "libdnf/utils/utils.hpp"
 #include "libdnf/utils/os-release.hpp"
+#include "libdnf/utils/probes.hpp"
 #include "libdnf/utils/url-encode.hpp"
 
 #include "bgettext/bgettext-lib.h"
@@ -53,20 +54,28 @@
 
 #include <solv/chksum.h>
 #include <solv/repo.h>
+#include <solv/solv_xfopen.h>
 #include <solv/util.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cctype>
 #include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <system_error>
+#include <thread>
 #include <type_traits>
 
 #include <stdio.h>
@@ -189,6 +198,78 @@ static constexpr struct {
     {"any", LR_AUTH_ANY}
 };
 
+namespace {
+
+// Parsed repomd of the local cache, see Repo::Impl::loadCacheState()
+const char * const CACHE_STATE_FN = "repostate.bin";
+const int64_t CACHE_STATE_VERSION = 1;
+
+// Mirror scoreboard, see Repo::Impl::applyMirrorScores()
+const char * const MIRROR_SCORES_FN = "mirrorscores";
+
+class CacheStateWriter {
+public:
+    void putNumber(int64_t value)
+    {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    void putString(const std::string & value)
+    {
+        putNumber(value.size());
+        buffer.append(value);
+    }
+    const std::string & getBuffer() const noexcept { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+class CacheStateReader {
+public:
+    CacheStateReader(const char * data, size_t size) : data(data), size(size) {}
+    bool getNumber(int64_t & value)
+    {
+        if (size - pos < sizeof(value))
+            return false;
+        memcpy(&value, data + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+    bool getString(std::string & value)
+    {
+        int64_t length;
+        if (!getNumber(length) || length < 0 || static_cast<uint64_t>(length) > size - pos)
+            return false;
+        value.assign(data + pos, length);
+        pos += length;
+        return true;
+    }
+    bool getPair(std::pair<std::string, std::string> & value)
+    {
+        return getString(value.first) && getString(value.second);
+    }
+    bool atEnd() const noexcept { return pos == size; }
+
+private:
+    const char * data;
+    size_t size;
+    size_t pos{0};
+};
+
+// identifies the file content the state was created from without reading it
+bool statFile(const std::string & path, int64_t & size, int64_t & mtimeSec, int64_t & mtimeNsec)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    size = st.st_size;
+    mtimeSec = st.st_mtim.tv_sec;
+    mtimeNsec = st.st_mtim.tv_nsec;
+    return true;
+}
+
+}
+
 bool Repo::Impl::endsWith(const std::string &str, const std::string &ending) const {
     if (str.length() >= ending.length())
         return (str.compare(str.length() - ending.length(), ending.length(), ending) == 0);
@@ -215,6 +296,8 @@ const std::string & Repo::Impl::getMetadataPath(const std::string &metadataType)
 
 int Repo::Impl::progressCB(void * data, double totalToDownload, double downloaded)
 {
+    LIBDNF_PROBE(repo_download_progress, static_cast<long>(totalToDownload),
+                 static_cast<long>(downloaded));
     if (!data)
         return 0;
     auto cbObject = static_cast<RepoCB *>(data);
@@ -249,6 +332,7 @@ void Repo::Impl::fastestMirrorCB(void * data, LrFastestMirrorStages stage, void
 
 int Repo::Impl::mirrorFailureCB(void * data, const char * msg, const char * url, const char * metadata)
 {
+    LIBDNF_PROBE(repo_mirror_failure, url, metadata);
     if (!data)
         return 0;
     auto cbObject = static_cast<RepoCB *>(data);
@@ -379,12 +463,116 @@ std::string Repo::getLocalBaseurl() const
 }
 
 bool Repo::load() { return pImpl->load(); }
+
+namespace {
+
+// librepo transfers block the thread they run on, this bounds the threads of the *Async() calls
+constexpr int ASYNC_MAX_THREADS = 32;
+
+void asyncTaskCb(gpointer data, gpointer)
+{
+    std::unique_ptr<std::function<void()>> task(static_cast<std::function<void()> *>(data));
+    (*task)();
+}
+
+template <typename T>
+std::future<T> runAsync(std::function<T()> func)
+{
+    static GThreadPool * pool = [] {
+        // gpgme has to be initialized before its contexts are created in several threads
+        gpgme_check_version(nullptr);
+        // a shared pool, its creation can not fail
+        return g_thread_pool_new(asyncTaskCb, NULL, ASYNC_MAX_THREADS, FALSE, NULL);
+    }();
+    auto task = std::make_shared<std::packaged_task<T()>>(std::move(func));
+    auto future = task->get_future();
+    g_thread_pool_push(pool, new std::function<void()>([task] { (*task)(); }), NULL);
+    return future;
+}
+
+struct RepoLoadJob {
+    Repo * repo;
+    bool ret;
+    std::exception_ptr error;
+};
+
+void repoLoadCb(gpointer data, gpointer)
+{
+    auto job = static_cast<RepoLoadJob *>(data);
+    try {
+        job->ret = job->repo->load();
+    } catch (...) {
+        job->error = std::current_exception();
+    }
+}
+
+}
+
+std::vector<bool> Repo::loadMany(const std::vector<Repo *> & repos,
+                                 std::vector<std::exception_ptr> * errors)
+{
+    if (repos.empty())
+        return {};
+    std::vector<RepoLoadJob> jobs;
+    jobs.reserve(repos.size());
+    for (auto repo : repos)
+        jobs.push_back({repo, false, nullptr});
+
+    unsigned threads = repos[0]->pImpl->conf->getMainConfig().max_parallel_downloads().getValue();
+    if (threads > jobs.size())
+        threads = jobs.size();
+    // gpgme has to be initialized before its contexts are created in several threads
+    gpgme_check_version(nullptr);
+    GError * error = NULL;
+    GThreadPool * pool = threads > 1 ?
+        g_thread_pool_new(repoLoadCb, NULL, threads, TRUE, &error) : NULL;
+    if (pool) {
+        for (auto & job : jobs)
+            g_thread_pool_push(pool, &job, NULL);
+        // wait for all the repos to finish
+        g_thread_pool_free(pool, FALSE, TRUE);
+    } else {
+        if (error) {
+            g_warning("Failed to create thread pool for loading repos: %s", error->message);
+            g_error_free(error);
+        }
+        for (auto & job : jobs)
+            repoLoadCb(&job, NULL);
+    }
+
+    std::vector<bool> ret;
+    ret.reserve(jobs.size());
+    if (errors) {
+        errors->clear();
+        errors->reserve(jobs.size());
+    }
+    for (auto & job : jobs) {
+        if (errors)
+            errors->push_back(job.error);
+        else if (job.error)
+            std::rethrow_exception(job.error);
+        ret.push_back(job.ret);
+    }
+    return ret;
+}
+std::future<bool> Repo::loadAsync()
+{
+    return runAsync<bool>([this] { return load(); });
+}
+
 bool Repo::loadCache(bool throwExcept, bool ignoreMissing) { return pImpl->loadCache(throwExcept, ignoreMissing); }
 void Repo::downloadMetadata(const std::string & destdir) { pImpl->downloadMetadata(destdir); }
+
+std::future<void> Repo::downloadMetadataAsync(const std::string & destdir)
+{
+    return runAsync<void>([this, destdir] { downloadMetadata(destdir); });
+}
 bool Repo::getUseIncludes() const { return pImpl->useIncludes; }
 void Repo::setUseIncludes(bool enabled) { pImpl->useIncludes = enabled; }
 bool Repo::getLoadMetadataOther() const { return pImpl->loadMetadataOther; }
 void Repo::setLoadMetadataOther(bool value) { pImpl->loadMetadataOther = value; }
+bool Repo::getStreamPrimary() const { return pImpl->streamPrimary; }
+void Repo::setStreamPrimary(bool value) { pImpl->streamPrimary = value; }
 int Repo::getCost() const { return pImpl->conf->cost().getValue(); }
 int Repo::getPriority() const { return pImpl->conf->priority().getValue(); }
 std::string Repo::getCompsFn() {
@@ -436,11 +624,12 @@ std::string Repo::getMetadataContent(const std::string &metadataType)
     return content;
 }
 
-std::unique_ptr<LrHandle> Repo::Impl::lrHandleInitBase()
+std::vector<const char *> Repo::Impl::downloadList(bool withPrimary) const
 {
-    std::unique_ptr<LrHandle> h(lr_handle_init());
-    std::vector<const char *> dlist = {MD_TYPE_PRIMARY, MD_TYPE_FILELISTS, MD_TYPE_PRESTODELTA,
+    std::vector<const char *> dlist = {MD_TYPE_FILELISTS, MD_TYPE_PRESTODELTA,
         MD_TYPE_GROUP_GZ, MD_TYPE_UPDATEINFO};
+    if (withPrimary)
+        dlist.insert(dlist.begin(), MD_TYPE_PRIMARY);
 
 #ifdef MODULEMD
     dlist.push_back(MD_TYPE_MODULES);
@@ -448,10 +637,20 @@ std::unique_ptr<LrHandle> Repo::Impl::lrHandleInitBase()
     if (loadMetadataOther) {
         dlist.push_back(MD_TYPE_OTHER);
     }
+    if (conf->solv_snapshot().getValue()) {
+        dlist.push_back(MD_TYPE_PRIMARY_SOLV);
+    }
     for (auto &item : additionalMetadata) {
         dlist.push_back(item.c_str());
     }
     dlist.push_back(NULL);
+    return dlist;
+}
+
+std::unique_ptr<LrHandle> Repo::Impl::lrHandleInitBase()
+{
+    std::unique_ptr<LrHandle> h(lr_handle_init());
+    auto dlist = downloadList(true);
     handleSetOpt(h.get(), LRO_PRESERVETIME, static_cast<long>(preserveRemoteTime));
     handleSetOpt(h.get(), LRO_REPOTYPE, LR_YUMREPO);
     handleSetOpt(h.get(), LRO_USERAGENT, conf->user_agent().getValue().c_str());
@@ -759,13 +958,58 @@ static std::vector<Key> rawkey2infos(int fd) {
         do {
             readed = gpgme_data_read(sink, buf, sizeof(buf));
             if (readed > 0)
-                keyInfo.rawKey.insert(keyInfo.rawKey.end(), buf, buf + sizeof(buf));
+                keyInfo.rawKey.insert(keyInfo.rawKey.end(), buf, buf + readed);
         } while (readed == sizeof(buf));
     }
     return keyInfos;
 }
 
-static std::vector<std::string> keyidsFromPubring(const std::string & gpgDir)
+// Parsing a key needs a gpg engine with a temporary home directory, which is slow. The parsed
+// keys are kept for the life of the process by the content of the key files, which are
+// downloaded again on every import, so changed keys are always noticed.
+static std::mutex keyCacheMutex;
+static std::map<std::string, std::vector<Key>> keyInfosByContent;
+
+static std::vector<Key> cachedRawkey2infos(int fd)
+{
+    std::string content;
+    char buf[4096];
+    ssize_t readed;
+    while ((readed = read(fd, buf, sizeof(buf))) > 0)
+        content.append(buf, readed);
+    {
+        std::lock_guard<std::mutex> guard(keyCacheMutex);
+        auto it = keyInfosByContent.find(content);
+        if (it != keyInfosByContent.end())
+            return it->second;
+    }
+    lseek(fd, 0, SEEK_SET);
+    auto keyInfos = rawkey2infos(fd);
+    std::lock_guard<std::mutex> guard(keyCacheMutex);
+    keyInfosByContent.emplace(std::move(content), keyInfos);
+    return keyInfos;
+}
+
+// The key ids in the pubring directories, valid while its keyring files stay the same
+struct PubringKeyids {
+    std::string signature;
+    std::vector<std::string> keyids;
+};
+static std::map<std::string, PubringKeyids> pubringKeyids;
+
+static std::string pubringSignature(const std::string & gpgDir)
+{
+    std::string signature;
+    for (const char * name : {"pubring.kbx", "pubring.gpg"}) {
+        struct stat sb;
+        if (stat((gpgDir + "/" + name).c_str(), &sb) == 0)
+            signature += tfm::format("%s:%d:%d.%d;", name, sb.st_size,
+                                     sb.st_mtim.tv_sec, sb.st_mtim.tv_nsec);
+    }
+    return signature;
+}
+
+static std::vector<std::string> listPubringKeyids(const std::string & gpgDir)
 {
     auto logger(Log::getLogger());
     gpg_error_t gpgErr;
@@ -815,6 +1059,21 @@ static std::vector<std::string> keyidsFromPubring(const std::string & gpgDir)
     return keyids;
 }
 
+static std::vector<std::string> keyidsFromPubring(const std::string & gpgDir)
+{
+    auto signature = pubringSignature(gpgDir);
+    {
+        std::lock_guard<std::mutex> guard(keyCacheMutex);
+        auto it = pubringKeyids.find(gpgDir);
+        if (it != pubringKeyids.end() && it->second.signature == signature)
+            return it->second.keyids;
+    }
+    auto keyids = listPubringKeyids(gpgDir);
+    std::lock_guard<std::mutex> guard(keyCacheMutex);
+    pubringKeyids[gpgDir] = {signature, keyids};
+    return keyids;
+}
+
 // download key from URL
 std::vector<Key> Repo::Impl::retrieve(const std::string & url)
 {
@@ -839,8 +1098,8 @@ std::vector<Key> Repo::Impl::retrieve(const std::string & url)
         auto msg = tfm::format(_("Failed to retrieve GPG key for repo '%s': %s"), id, e.what());
         throw RepoError(msg);
     }
-    lseek(fd, SEEK_SET, 0);
-    auto keyInfos = rawkey2infos(fd);
+    lseek(fd, 0, SEEK_SET);
+    auto keyInfos = cachedRawkey2infos(fd);
     for (auto & key : keyInfos)
         key.url = url;
     return keyInfos;
@@ -885,6 +1144,8 @@ void Repo::Impl::importRepoKeys()
     auto gpgDir = getCachedir() + "/pubring";
     auto knownKeys = keyidsFromPubring(gpgDir);
     ensure_socket_dir_exists();
+    // one context imports all the keys into the pubring
+    std::unique_ptr<std::remove_pointer<gpgme_ctx_t>::type> context;
     for (const auto & gpgkeyUrl : conf->gpgkey().getValue()) {
         auto keyInfos = retrieve(gpgkeyUrl);
         for (auto & keyInfo : keyInfos) {
@@ -909,19 +1170,22 @@ void Repo::Impl::importRepoKeys()
                 }
             }
 
-            gpgme_ctx_t ctx;
-            gpgme_new(&ctx);
-            std::unique_ptr<std::remove_pointer<gpgme_ctx_t>::type> context(ctx);
-
-            // set GPG home dir
-            auto gpgErr = gpgme_ctx_set_engine_info(ctx, GPGME_PROTOCOL_OpenPGP, NULL, gpgDir.c_str());
-            if (gpgErr != GPG_ERR_NO_ERROR) {
-                auto msg = tfm::format(_("%s: gpgme_ctx_set_engine_info(): %s"), __func__, gpgme_strerror(gpgErr));
-                logger->debug(msg);
-                throw LrException(LRE_GPGERROR, msg);
+            if (!context) {
+                gpgme_ctx_t ctx;
+                gpgme_new(&ctx);
+                context.reset(ctx);
+
+                // set GPG home dir
+                auto gpgErr = gpgme_ctx_set_engine_info(ctx, GPGME_PROTOCOL_OpenPGP, NULL, gpgDir.c_str());
+                if (gpgErr != GPG_ERR_NO_ERROR) {
+                    auto msg = tfm::format(_("%s: gpgme_ctx_set_engine_info(): %s"), __func__, gpgme_strerror(gpgErr));
+                    logger->debug(msg);
+                    throw LrException(LRE_GPGERROR, msg);
+                }
             }
 
-            gpgImportKey(ctx, keyInfo.rawKey);
+            gpgImportKey(context.get(), keyInfo.rawKey);
+            knownKeys.push_back(keyInfo.getId());
 
             logger->debug(tfm::format(_("repo %s: imported key 0x%s."), id, keyInfo.getId()));
         }
@@ -988,8 +1252,163 @@ std::unique_ptr<LrResult> Repo::Impl::lrHandlePerform(LrHandle * handle, const s
     return result;
 }
 
+std::string Repo::Impl::getCacheStateKey() const
+{
+    std::string key = conf->repo_gpgcheck().getValue() ? "gpg" : "";
+    if (loadMetadataOther)
+        key += ",other";
+    if (conf->solv_snapshot().getValue())
+        key += ",solv";
+    for (auto & item : additionalMetadata) {
+        key += ',';
+        key += item;
+    }
+    return key;
+}
+
+bool Repo::Impl::loadCacheState()
+{
+    auto fn = getCachedir() + "/" + METADATA_RELATIVE_DIR + "/" + CACHE_STATE_FN;
+    g_autofree gchar * content = nullptr;
+    gsize length = 0;
+    if (!g_file_get_contents(fn.c_str(), &content, &length, nullptr))
+        return false;
+
+    CacheStateReader reader(content, length);
+    int64_t version, size, mtimeSec, mtimeNsec, count, number;
+    std::string key, repomd;
+    if (!reader.getNumber(version) || version != CACHE_STATE_VERSION)
+        return false;
+    if (!reader.getString(key) || key != getCacheStateKey())
+        return false;
+    if (!reader.getString(repomd) || !reader.getNumber(size) || !reader.getNumber(mtimeSec) ||
+        !reader.getNumber(mtimeNsec))
+        return false;
+    int64_t curSize, curMtimeSec, curMtimeNsec;
+    // the repomd changed since the state was written
+    if (!statFile(repomd, curSize, curMtimeSec, curMtimeNsec) || curSize != size ||
+        curMtimeSec != mtimeSec || curMtimeNsec != mtimeNsec)
+        return false;
+
+    std::map<std::string, std::string> paths;
+    if (!reader.getNumber(count))
+        return false;
+    for (int64_t i = 0; i < count; ++i) {
+        std::pair<std::string, std::string> item;
+        if (!reader.getPair(item) || access(item.second.c_str(), F_OK) != 0)
+            return false;
+        paths.insert(std::move(item));
+    }
+    std::vector<std::string> contentTags;
+    if (!reader.getNumber(count))
+        return false;
+    for (int64_t i = 0; i < count; ++i) {
+        std::string item;
+        if (!reader.getString(item))
+            return false;
+        contentTags.push_back(std::move(item));
+    }
+    std::vector<std::pair<std::string, std::string>> distroTags;
+    std::vector<std::pair<std::string, std::string>> locations;
+    for (auto list : {&distroTags, &locations}) {
+        if (!reader.getNumber(count))
+            return false;
+        for (int64_t i = 0; i < count; ++i) {
+            std::pair<std::string, std::string> item;
+            if (!reader.getPair(item))
+                return false;
+            list->push_back(std::move(item));
+        }
+    }
+    std::string rev;
+    std::vector<std::string> mirrorList;
+    if (!reader.getString(rev) || !reader.getNumber(number) || !reader.getNumber(count))
+        return false;
+    for (int64_t i = 0; i < count; ++i) {
+        std::string item;
+        if (!reader.getString(item))
+            return false;
+        mirrorList.push_back(std::move(item));
+    }
+    if (!reader.atEnd())
+        return false;
+
+    repomdFn = std::move(repomd);
+    metadataPaths = std::move(paths);
+    content_tags = std::move(contentTags);
+    distro_tags = std::move(distroTags);
+    metadata_locations = std::move(locations);
+    revision = std::move(rev);
+    maxTimestamp = number;
+    g_strfreev(mirrors);
+    mirrors = nullptr;
+    if (!mirrorList.empty()) {
+        mirrors = g_new0(char *, mirrorList.size() + 1);
+        for (size_t i = 0; i < mirrorList.size(); ++i)
+            mirrors[i] = g_strdup(mirrorList[i].c_str());
+    }
+    return true;
+}
+
+void Repo::Impl::writeCacheState()
+{
+    int64_t size, mtimeSec, mtimeNsec;
+    if (!statFile(repomdFn, size, mtimeSec, mtimeNsec))
+        return;
+
+    CacheStateWriter writer;
+    writer.putNumber(CACHE_STATE_VERSION);
+    writer.putString(getCacheStateKey());
+    writer.putString(repomdFn);
+    writer.putNumber(size);
+    writer.putNumber(mtimeSec);
+    writer.putNumber(mtimeNsec);
+    writer.putNumber(metadataPaths.size());
+    for (auto & item : metadataPaths) {
+        writer.putString(item.first);
+        writer.putString(item.second);
+    }
+    writer.putNumber(content_tags.size());
+    for (auto & item : content_tags)
+        writer.putString(item);
+    for (auto list : {&distro_tags, &metadata_locations}) {
+        writer.putNumber(list->size());
+        for (auto & item : *list) {
+            writer.putString(item.first);
+            writer.putString(item.second);
+        }
+    }
+    writer.putString(revision);
+    writer.putNumber(maxTimestamp);
+    int64_t count = 0;
+    while (mirrors && mirrors[count])
+        ++count;
+    writer.putNumber(count);
+    for (int64_t i = 0; i < count; ++i)
+        writer.putString(mirrors[i]);
+
+    // it lives in the repodata directory, fetch() removes it together with the old metadata
+    auto fn = getCachedir() + "/" + METADATA_RELATIVE_DIR + "/" + CACHE_STATE_FN;
+    GError * error = nullptr;
+    auto & buffer = writer.getBuffer();
+    if (!g_file_set_contents(fn.c_str(), buffer.data(), buffer.size(), &error)) {
+        auto logger(Log::getLogger());
+        logger->debug(tfm::format("Cannot write repo state %s: %s", fn, error->message));
+        g_error_free(error);
+    }
+}
+
 bool Repo::Impl::loadCache(bool throwExcept, bool ignoreMissing)
 {
+    // unexpired repos are loaded without librepo, see writeCacheState()
+    if (loadCacheState()) {
+        // Load timestamp unless explicitly expired
+        if (timestamp != 0) {
+            timestamp = mtime(getMetadataPath(MD_TYPE_PRIMARY).c_str());
+        }
+        return true;
+    }
+
     std::unique_ptr<LrHandle> h(lrHandleInitLocal());
     std::unique_ptr<LrResult> r;
 
@@ -1051,6 +1470,18 @@ bool Repo::Impl::loadCache(bool throwExcept, bool ignoreMissing)
         }
     }
 
+    // the primary left out of the download by load() is streamed when the sack loads the repo
+    streamPrimaryHref.clear();
+    if (streamPrimary && getMetadataPath(MD_TYPE_PRIMARY).empty()) {
+        if (auto rec = lr_yum_repomd_get_record(yum_repomd, MD_TYPE_PRIMARY)) {
+            if (rec->location_href && rec->checksum_type && rec->checksum) {
+                streamPrimaryHref = rec->location_href;
+                streamPrimaryChecksumType = rec->checksum_type;
+                streamPrimaryChecksum = rec->checksum;
+            }
+        }
+    }
+
     if (auto cRevision = yum_repomd->revision) {
         revision = cRevision;
     }
@@ -1062,6 +1493,9 @@ bool Repo::Impl::loadCache(bool throwExcept, bool ignoreMissing)
     }
     g_strfreev(this->mirrors);
     this->mirrors = mirrors;
+    // with missing files ignored the result is not a complete cache
+    if (!ignoreMissing && !streamPrimaryPending())
+        writeCacheState();
     return true;
 }
 
@@ -1361,9 +1795,15 @@ bool Repo::Impl::load()
 
         logger->debug(tfm::format(_("repo: downloading from remote: %s"), id));
         const auto cacheDir = getCachedir();
-        fetch(cacheDir, lrHandleInitRemote(nullptr));
+        auto h = lrHandleInitRemote(nullptr);
+        if (streamPrimary) {
+            // the primary is downloaded by streamPrimaryLoad() while the sack parses it
+            auto dlist = downloadList(false);
+            handleSetOpt(h.get(), LRO_YUMDLIST, dlist.data());
+        }
+        fetch(cacheDir, std::move(h));
         timestamp = -1;
-        loadCache(true);
+        loadCache(true, streamPrimary);
         fresh = true;
     } catch (const LrExceptionWithSourceUrl & e) {
         auto msg = tfm::format(_("Failed to download metadata for repo '%s': %s"), id, e.what());
@@ -1471,6 +1911,128 @@ void Repo::Impl::downloadUrl(const char * url, int fd)
         throw LrExceptionWithSourceUrl(err->code, err->message, url);
 }
 
+bool Repo::Impl::streamPrimaryPending() const
+{
+    return !streamPrimaryHref.empty() && getMetadataPath(MD_TYPE_PRIMARY).empty();
+}
+
+bool Repo::Impl::streamPrimaryLoad(const std::function<bool(FILE *)> & parse)
+{
+    auto logger(Log::getLogger());
+    auto path = getCachedir() + "/" + streamPrimaryHref;
+    auto tmpPath = path + ".XXXXXX";
+    int fd = mkstemp(&tmpPath.front());
+    if (fd == -1) {
+        const char * errTxt = strerror(errno);
+        throw RepoError(tfm::format(_("Cannot create temporary file \"%s\": %s"), tmpPath, errTxt));
+    }
+    Finalizer tmpRemover([&tmpPath](){ unlink(tmpPath.c_str()); });
+
+    bool parsed = false;
+    bool verified = false;
+    auto chksumType = solv_chksum_str2type(streamPrimaryChecksumType.c_str());
+    int pipeFds[2];
+    if (chksumType && pipe(pipeFds) == 0) {
+        // librepo writes the file, a second reader follows its end and hands the arrived
+        // bytes over to the parser through the pipe
+        std::atomic<bool> downloaded{false};
+        std::exception_ptr downloadError;
+        std::thread downloader([&] {
+            try {
+                downloadUrl(streamPrimaryHref.c_str(), fd);
+            } catch (...) {
+                downloadError = std::current_exception();
+            }
+            downloaded = true;
+        });
+        auto chksum = solv_chksum_create(chksumType);
+        std::thread follower([&] {
+            int readFd = open(tmpPath.c_str(), O_RDONLY);
+            char buf[65536];
+            while (readFd != -1) {
+                bool finished = downloaded;
+                auto len = read(readFd, buf, sizeof(buf));
+                if (len < 0 && errno == EINTR)
+                    continue;
+                if (len < 0 || (len == 0 && finished))
+                    break;
+                if (len == 0) {
+                    g_usleep(10000);
+                    continue;
+                }
+                solv_chksum_add(chksum, buf, len);
+                ssize_t done = 0;
+                while (done < len) {
+                    auto written = write(pipeFds[1], buf + done, len - done);
+                    if (written > 0)
+                        done += written;
+                    else if (errno != EINTR)
+                        break;
+                }
+                if (done < len)
+                    break;
+            }
+            if (readFd != -1)
+                close(readFd);
+            close(pipeFds[1]);
+        });
+
+        // the name gives the compression, the duplicate is closed by fclose()
+        int parseFd = dup(pipeFds[0]);
+        if (FILE * fp = parseFd == -1 ? nullptr : solv_xfopen_fd(streamPrimaryHref.c_str(), parseFd, "r")) {
+            parsed = parse(fp);
+            fclose(fp);
+        } else if (parseFd != -1) {
+            close(parseFd);
+        }
+        // the follower must not write into a pipe without a reader
+        char buf[65536];
+        ssize_t len;
+        do
+            len = read(pipeFds[0], buf, sizeof(buf));
+        while (len > 0 || (len < 0 && errno == EINTR));
+        close(pipeFds[0]);
+        downloader.join();
+        follower.join();
+
+        int digestLen;
+        auto digest = solv_chksum_get(chksum, &digestLen);
+        std::string hex(digestLen * 2, '\0');
+        solv_bin2hex(digest, digestLen, &hex.front());
+        solv_chksum_free(chksum, nullptr);
+        verified = !downloadError && hex == streamPrimaryChecksum;
+        if (!verified)
+            logger->debug(tfm::format(_("Streamed primary of '%s' is not valid, downloading it again"), id));
+    }
+    if (!verified) {
+        if (ftruncate(fd, 0) == -1 || lseek(fd, 0, SEEK_SET) == -1) {
+            const char * errTxt = strerror(errno);
+            close(fd);
+            throw RepoError(tfm::format(_("Cannot truncate file \"%s\": %s"), tmpPath, errTxt));
+        }
+        try {
+            downloadUrl(streamPrimaryHref.c_str(), fd);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+    }
+    close(fd);
+    if (!verified && !filesystem::checksum_check(streamPrimaryChecksumType.c_str(), tmpPath.c_str(),
+                                     streamPrimaryChecksum.c_str()))
+        throw RepoError(tfm::format(_("Primary of repo '%s' does not match its checksum"), id));
+    if (rename(tmpPath.c_str(), path.c_str()) == -1) {
+        const char * errTxt = strerror(errno);
+        throw RepoError(tfm::format(_("Cannot rename file \"%s\" to \"%s\": %s"),
+                                    tmpPath, path, errTxt));
+    }
+    metadataPaths[MD_TYPE_PRIMARY] = path;
+    if (timestamp != 0)
+        timestamp = mtime(path.c_str());
+    writeCacheState();
+    return parsed && verified;
+}
+
 void Repo::Impl::setHttpHeaders(const char * headers[])
 {
     if (!headers) {
@@ -1514,12 +2076,134 @@ void Repo::Impl::resetMetadataExpired()
    Note that destdir is None, and the handle is cached.*/
 LrHandle * Repo::Impl::getCachedHandle()
 {
-    if (!handle)
+    if (!handle) {
         handle = lrHandleInitRemote(nullptr);
+        applyMirrorScores(handle.get());
+    }
     handleSetOpt(handle.get(), LRO_HTTPHEADER, httpHeaders.get());
     return handle.get();
 }
 
+void Repo::Impl::loadMirrorScores()
+{
+    if (mirrorScoresLoaded)
+        return;
+    mirrorScoresLoaded = true;
+    std::ifstream file(getCachedir() + "/" + MIRROR_SCORES_FN);
+    MirrorScore score;
+    std::string url;
+    while (file >> score.throughput >> score.failures >> score.lastFailure >> url)
+        mirrorScores[url] = score;
+}
+
+void Repo::Impl::saveMirrorScores()
+{
+    if (!mirrorScoresChanged)
+        return;
+    mirrorScoresChanged = false;
+
+    std::ostringstream content;
+    for (const auto & item : mirrorScores)
+        content << item.second.throughput << ' ' << item.second.failures << ' '
+                << item.second.lastFailure << ' ' << item.first << '\n';
+    auto fn = getCachedir() + "/" + MIRROR_SCORES_FN;
+    auto data = content.str();
+    GError * error = nullptr;
+    if (!g_file_set_contents(fn.c_str(), data.data(), data.size(), &error)) {
+        auto logger(Log::getLogger());
+        logger->debug(tfm::format("Cannot write mirror scores %s: %s", fn, error->message));
+        g_error_free(error);
+    }
+}
+
+std::string Repo::Impl::findMirror(const char * url) const
+{
+    std::string found;
+    if (!url)
+        return found;
+    for (auto mirror = mirrors; mirror && *mirror; ++mirror) {
+        auto len = strlen(*mirror);
+        if (len > found.size() && strncmp(url, *mirror, len) == 0)
+            found = *mirror;
+    }
+    return found;
+}
+
+void Repo::Impl::recordMirrorSuccess(const char * url, double throughput)
+{
+    auto mirror = findMirror(url);
+    if (mirror.empty())
+        return;
+    loadMirrorScores();
+    auto & score = mirrorScores[mirror];
+    // moving average, a single slow transfer does not bury a good mirror
+    score.throughput = score.throughput > 0 ? 0.7 * score.throughput + 0.3 * throughput : throughput;
+    score.failures = 0;
+    mirrorScoresChanged = true;
+}
+
+void Repo::Impl::recordMirrorFailure(const char * url)
+{
+    auto mirror = findMirror(url);
+    if (mirror.empty())
+        return;
+    loadMirrorScores();
+    auto & score = mirrorScores[mirror];
+    ++score.failures;
+    score.lastFailure = time(nullptr);
+    mirrorScoresChanged = true;
+}
+
+/**
+* @brief Order the mirrors of the handle by their recorded performance.
+*
+* Mirrors that recently failed are backed off exponentially, up to a day, the others are
+* ordered by throughput with unknown mirrors in the middle. The ranked list replaces the
+* mirrorlist and the fastest mirror probe, so no requests are made to rank them.
+*/
+void Repo::Impl::applyMirrorScores(LrHandle * h)
+{
+    // nothing to choose from
+    if (!mirrors || !mirrors[0] || !mirrors[1])
+        return;
+    loadMirrorScores();
+    if (mirrorScores.empty())
+        return;
+
+    struct RankedMirror {
+        int group;
+        double throughput;
+        const char * url;
+    };
+    std::vector<RankedMirror> ranked;
+    auto now = time(nullptr);
+    for (auto mirror = mirrors; *mirror; ++mirror) {
+        auto it = mirrorScores.find(*mirror);
+        if (it == mirrorScores.end()) {
+            ranked.push_back({1, 0, *mirror});
+            continue;
+        }
+        auto & score = it->second;
+        int64_t backoff = std::min<int64_t>(int64_t{60} << std::min(score.failures, 10), 24 * 3600);
+        if (score.failures > 0 && now - score.lastFailure < backoff)
+            ranked.push_back({2, 0, *mirror});
+        else
+            ranked.push_back({score.throughput > 0 ? 0 : 1, score.throughput, *mirror});
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RankedMirror & a, const RankedMirror & b) {
+        return a.group != b.group ? a.group < b.group : a.throughput > b.throughput;
+    });
+
+    std::vector<const char *> urls;
+    for (const auto & item : ranked)
+        urls.push_back(item.url);
+    urls.push_back(nullptr);
+    handleSetOpt(h, LRO_METALINKURL, static_cast<const char *>(nullptr));
+    handleSetOpt(h, LRO_MIRRORLISTURL, static_cast<const char *>(nullptr));
+    handleSetOpt(h, LRO_FASTESTMIRROR, 0L);
+    handleSetOpt(h, LRO_URLS, urls.data());
+}
+
 void Repo::Impl::attachLibsolvRepo(LibsolvRepo * libsolvRepo)
 {
     std::lock_guard<std::mutex> guard(attachLibsolvMutex);
@@ -1696,34 +2380,62 @@ private:
     static int endCB(void * data, LrTransferStatus status, const char * msg);
     static int progressCB(void * data, double totalToDownload, double downloaded);
     static int mirrorFailureCB(void * data, const char * msg, const char * url);
+    void recordTransfer();
 
     std::unique_ptr<LrHandle> lrHandle;
+    // the mirror scoreboard of the repo, if the target belongs to one
+    Repo::Impl * repoImpl{nullptr};
+    bool transferStarted{false};
+    std::chrono::steady_clock::time_point transferStart;
 
 };
 
 
+void PackageTarget::Impl::recordTransfer()
+{
+    auto target = lrPkgTarget.get();
+    if (!repoImpl || !transferStarted || !target || !target->usedmirror || target->expectedsize <= 0)
+        return;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - transferStart;
+    // too short to tell anything about the mirror
+    if (elapsed.count() < 0.1)
+        return;
+    repoImpl->recordMirrorSuccess(target->usedmirror, target->expectedsize / elapsed.count());
+}
+
 int PackageTarget::Impl::endCB(void * data, LrTransferStatus status, const char * msg)
 {
-    if (!data)
+    auto impl = static_cast<Impl *>(data);
+    LIBDNF_PROBE(package_download_end, static_cast<int>(status), msg);
+    if (status == LR_TRANSFER_SUCCESSFUL)
+        impl->recordTransfer();
+    if (!impl->callbacks)
         return 0;
-    auto cbObject = static_cast<PackageTargetCB *>(data);
-    return cbObject->end(static_cast<PackageTargetCB::TransferStatus>(status), msg);
+    return impl->callbacks->end(static_cast<PackageTargetCB::TransferStatus>(status), msg);
 }
 
 int PackageTarget::Impl::progressCB(void * data, double totalToDownload, double downloaded)
 {
-    if (!data)
+    LIBDNF_PROBE(package_download_progress, static_cast<long>(totalToDownload),
+                 static_cast<long>(downloaded));
+    auto impl = static_cast<Impl *>(data);
+    if (!impl->transferStarted) {
+        impl->transferStarted = true;
+        impl->transferStart = std::chrono::steady_clock::now();
+    }
+    if (!impl->callbacks)
         return 0;
-    auto cbObject = static_cast<PackageTargetCB *>(data);
-    return cbObject->progress(totalToDownload, downloaded);
+    return impl->callbacks->progress(totalToDownload, downloaded);
 }
 
 int PackageTarget::Impl::mirrorFailureCB(void * data, const char * msg, const char * url)
 {
-    if (!data)
+    auto impl = static_cast<Impl *>(data);
+    if (impl->repoImpl)
+        impl->repoImpl->recordMirrorFailure(url);
+    if (!impl->callbacks)
         return 0;
-    auto cbObject = static_cast<PackageTargetCB *>(data);
-    return cbObject->mirrorFailure(msg, url);
+    return impl->callbacks->mirrorFailure(msg, url);
 }
 
 
@@ -1761,6 +2473,10 @@ void PackageTarget::downloadPackages(std::vector<PackageTarget *> & targets, boo
     lr_download_packages(list, flags, &errP);
     std::unique_ptr<GError> err(errP);
 
+    for (auto target : targets)
+        if (target->pImpl->repoImpl)
+            target->pImpl->repoImpl->saveMirrorScores();
+
     if (err)
         throwException(std::move(err));
 }
@@ -1771,7 +2487,7 @@ PackageTarget::Impl::~Impl() {}
 PackageTarget::Impl::Impl(Repo * repo, const char * relativeUrl, const char * dest, int chksType,
                           const char * chksum, int64_t expectedSize, const char * baseUrl, bool resume,
                           int64_t byteRangeStart, int64_t byteRangeEnd, PackageTargetCB * callbacks)
-: callbacks(callbacks)
+: callbacks(callbacks), repoImpl(repo->pImpl.get())
 {
     init(repo->pImpl->getCachedHandle(), relativeUrl, dest, chksType, chksum, expectedSize,
          baseUrl, resume, byteRangeStart, byteRangeEnd);
@@ -1801,6 +2517,17 @@ void PackageTarget::Impl::init(LrHandle * handle, const char * relativeUrl, cons
         throw Exception(msg);
     }
 
+    // librepo continues a leftover file from its end, unless it cannot be resumed
+    if (resume && chksum && dest) {
+        std::string path = dest;
+        if (g_file_test(dest, G_FILE_TEST_IS_DIR)) {
+            g_autofree gchar * basename = g_path_get_basename(relativeUrl);
+            path = path + "/" + basename;
+        }
+        filesystem::removeUnresumable(path.c_str(), lr_checksum_type_to_str(lrChksType), chksum,
+                                      expectedSize);
+    }
+
     GError * errP{nullptr};
 
     std::string encodedUrl = relativeUrl;
@@ -1809,7 +2536,7 @@ void PackageTarget::Impl::init(LrHandle * handle, const char * relativeUrl, cons
     }
 
     lrPkgTarget.reset(lr_packagetarget_new_v3(handle, encodedUrl.c_str(), dest, lrChksType, chksum,
-                                              expectedSize, baseUrl, resume, progressCB, callbacks, endCB,
+                                              expectedSize, baseUrl, resume, progressCB, this, endCB,
                                               mirrorFailureCB, byteRangeStart, byteRangeEnd, &errP));
     std::unique_ptr<GError> err(errP);
 
@@ -1858,6 +2585,17 @@ void Downloader::downloadURL(ConfigMain * cfg, const char * url, int fd)
         throwException(std::move(err));
 }
 
+std::future<void> Downloader::downloadURLAsync(ConfigMain * cfg, const std::string & url, int fd)
+{
+    return runAsync<void>([cfg, url, fd] { downloadURL(cfg, url.c_str(), fd); });
+}
+
+std::future<void> PackageTarget::downloadPackagesAsync(const std::vector<PackageTarget *> & targets,
+                                                       bool failFast)
+{
+    return runAsync<void>([targets, failFast]() mutable { downloadPackages(targets, failFast); });
+}
+
 // ============ librepo logging ===========
 
 #define LR_LOGDOMAIN "librepo"
@@ -1910,7 +2648,9 @@ static void librepoLogCB(G_GNUC_UNUSED const gchar *log_domain, GLogLevelFlags l
                          const char *msg, gpointer user_data) noexcept
 {
     auto logger(Log::getLogger());
-    logger->write(Logger::LOG_SOURCE_LIBREPO, lrLogLevelFlagToLevel(log_level), msg);
+    auto level = lrLogLevelFlagToLevel(log_level);
+    if (logger->isEnabled(level))
+        logger->write(Logger::LOG_SOURCE_LIBREPO, level, msg);
 }
 
 long LibrepoLog::addHandler(const std::string & filePath, bool debug)
@@ -2039,6 +2779,25 @@ repo_update_state(HyRepo repo, enum _hy_repo_repodata which,
     return;
 }
 
+enum _hy_repo_state
+repo_get_state(HyRepo repo, enum _hy_repo_repodata which)
+{
+    auto repoImpl = libdnf::repoGetImpl(repo);
+    switch (which) {
+    case _HY_REPODATA_FILENAMES:
+        return repoImpl->state_filelists;
+    case _HY_REPODATA_PRESTO:
+        return repoImpl->state_presto;
+    case _HY_REPODATA_UPDATEINFO:
+        return repoImpl->state_updateinfo;
+    case _HY_REPODATA_OTHER:
+        return repoImpl->state_other;
+    default:
+        assert(0);
+    }
+    return _HY_NEW;
+}
+
 Id
 repo_get_repodata(HyRepo repo, enum _hy_repo_repodata which)
 {
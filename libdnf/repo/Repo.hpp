@@ -27,8 +27,11 @@
 #include "../error.hpp"
 #include "../hy-types.h"
 
+#include <exception>
+#include <future>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace libdnf {
 
@@ -167,12 +170,41 @@ public:
     * @return true if fresh metadata were downloaded, false otherwise.
     */
     bool load();
+
+    /**
+    * @brief Calls load() of all the repos concurrently, at most max_parallel_downloads of the
+    * main config at a time. Repo callbacks are then called from the worker threads.
+    *
+    * @param errors If given, it receives the exception of every failed repo (or nullptr) and
+    * nothing is thrown. Otherwise the first failure is rethrown once all the repos finished.
+    * @return values returned by load() of the repos, false for the failed ones
+    */
+    static std::vector<bool> loadMany(const std::vector<Repo *> & repos,
+                                      std::vector<std::exception_ptr> * errors = nullptr);
+    /**
+    * @brief Calls load() on a worker thread shared by all the asynchronous repo and download
+    * calls, at most 32 of them run at a time. The repo must not be used or destroyed before
+    * the future is ready. Repo callbacks are then called from the worker thread.
+    *
+    * @return future of the load() value, it rethrows the exception of a failed load()
+    */
+    std::future<bool> loadAsync();
     bool loadCache(bool throwExcept, bool ignoreMissing=false);
     void downloadMetadata(const std::string & destdir);
+    /// Calls downloadMetadata() on a worker thread, like loadAsync()
+    std::future<void> downloadMetadataAsync(const std::string & destdir);
     bool getUseIncludes() const;
     void setUseIncludes(bool enabled);
     bool getLoadMetadataOther() const;
     void setLoadMetadataOther(bool value);
+    /**
+    * @brief With streaming enabled, load() downloading fresh metadata leaves out the primary.
+    * The sack downloads it while loading the repo and parses it as the data arrive. The primary
+    * is verified against repomd.xml before the solv cache of the repo is written. Disabled by
+    * default.
+    */
+    bool getStreamPrimary() const;
+    void setStreamPrimary(bool value);
     int getCost() const;
     int getPriority() const;
     std::string getCompsFn();  // this is temporarily made public for DNF compatibility
@@ -320,6 +352,9 @@ private:
 struct Downloader {
 public:
     static void downloadURL(ConfigMain * cfg, const char * url, int fd);
+    /// Calls downloadURL() on a worker thread, like Repo::loadAsync(). cfg and fd must stay
+    /// valid until the future is ready.
+    static std::future<void> downloadURLAsync(ConfigMain * cfg, const std::string & url, int fd);
 };
 
 /**
@@ -365,7 +400,15 @@ public:
     };
 
     static ChecksumType checksumType(const std::string & name);
+    /**
+    * @brief Downloads the targets in one librepo transfer loop, the targets of a transaction
+    * should be passed in one call rather than per repo.
+    */
     static void downloadPackages(std::vector<PackageTarget *> & targets, bool failFast);
+    /// Calls downloadPackages() on a worker thread, like Repo::loadAsync(). The targets must
+    /// stay alive until the future is ready.
+    static std::future<void> downloadPackagesAsync(const std::vector<PackageTarget *> & targets,
+                                                   bool failFast);
 
     PackageTarget(Repo * repo, const char * relativeUrl, const char * dest, int chksType,
                   const char * chksum, int64_t expectedSize, const char * baseUrl, bool resume,
@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include "Dependency.hpp"
 #include "libdnf/utils/utils.hpp"
+#include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/repo/DependencySplitter.hpp"
 
 /* workaround, libsolv lacks 'extern "C"' in its header file */
@@ -93,20 +94,27 @@ Dependency::getReldepId(DnfSack *sack, const char *name, const char *version, in
 Id
 Dependency::getReldepId(DnfSack *sack, const char * reldepStr)
 {
+    auto & cache = dnf_sack_get_reldep_cache(sack);
+    auto cached = cache.find(reldepStr);
+    if (cached != cache.end())
+        return cached->second;
+
+    Id id;
     if (reldepStr[0] == '(') {
         /* Rich dependency */
         Pool *pool = dnf_sack_get_pool (sack);
-        Id id = pool_parserpmrichdep(pool, reldepStr);
+        id = pool_parserpmrichdep(pool, reldepStr);
         if (!id)
             throw std::runtime_error("Cannot parse a dependency string");
-        return id;
     } else {
         DependencySplitter depSplitter;
         if(!depSplitter.parse(reldepStr))
             throw std::runtime_error("Cannot parse a dependency string");
-        return getReldepId(sack, depSplitter.getNameCStr(), depSplitter.getEVRCStr(),
-                           depSplitter.getCmpType());
+        id = getReldepId(sack, depSplitter.getNameCStr(), depSplitter.getEVRCStr(),
+                         depSplitter.getCmpType());
     }
+    cache.emplace(reldepStr, id);
+    return id;
 }
 
 }
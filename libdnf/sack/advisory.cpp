@@ -87,7 +87,10 @@ Advisory::operator==(const Advisory & other) const
 const char *
 Advisory::getDescription() const
 {
-    return pool_lookup_str(dnf_sack_get_pool(sack), advisory, SOLVABLE_DESCRIPTION);
+    const char *description = pool_lookup_str(dnf_sack_get_pool(sack), advisory, SOLVABLE_DESCRIPTION);
+    if (!description)
+        description = dnf_sack_get_slim_advisory_description(sack, advisory);
+    return description;
 }
 
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <solv/evr.h>
+#include <solv/repo.h>
+
+#include "advisory.hpp"
+#include "advisoryindex.hpp"
+#include "advisorymodule.hpp"
+#include "../dnf-advisory-private.hpp"
+#include "../dnf-sack-private.hpp"
+#include "../hy-types.h"
+
+namespace libdnf {
+
+AdvisoryIndex::AdvisoryIndex(DnfSack * sack)
+{
+    Pool * pool = dnf_sack_get_pool(sack);
+    nsolvables = pool->nsolvables;
+
+    // the same advisories filters used to visit, i.e. those with some package collection
+    std::vector<Id> ids;
+    Dataiterator di;
+    dataiterator_init(&di, pool, 0, 0, 0, 0, 0);
+    dataiterator_prepend_keyname(&di, UPDATE_COLLECTION);
+    while (dataiterator_step(&di)) {
+        dataiterator_setpos_parent(&di);
+        ids.push_back(di.solvid);
+        dataiterator_skip_solvable(&di);
+    }
+    dataiterator_free(&di);
+
+    advisories.reserve(ids.size());
+    Dataiterator diInner;
+    for (auto advisoryId : ids) {
+        auto position = advisories.size();
+        advisories.push_back({advisoryId, {}});
+        auto & entry = advisories.back();
+
+        Advisory advisory(sack, advisoryId);
+        add(Key::NAME, advisory.getName(), position);
+        add(Key::TYPE, pool_lookup_str(pool, advisoryId, SOLVABLE_PATCHCATEGORY), position);
+        add(Key::SEVERITY, advisory.getSeverity(), position);
+
+        dataiterator_init(&di, pool, 0, advisoryId, UPDATE_REFERENCE, 0, 0);
+        while (dataiterator_step(&di)) {
+            dataiterator_setpos(&di);
+            auto type = pool_lookup_str(pool, SOLVID_POS, UPDATE_REFERENCE_TYPE);
+            auto refId = pool_lookup_str(pool, SOLVID_POS, UPDATE_REFERENCE_ID);
+            if (type && strcmp(type, "bugzilla") == 0) {
+                add(Key::BUG, refId, position);
+            } else if (type && strcmp(type, "cve") == 0) {
+                add(Key::CVE, refId, position);
+            }
+        }
+        dataiterator_free(&di);
+
+        dataiterator_init(&di, pool, 0, advisoryId, UPDATE_COLLECTIONLIST, 0, 0);
+        while (dataiterator_step(&di)) {
+            entry.collections.emplace_back();
+            auto & collection = entry.collections.back();
+
+            dataiterator_setpos(&di);
+            dataiterator_init(&diInner, pool, 0, SOLVID_POS, UPDATE_MODULE, 0, 0);
+            while (dataiterator_step(&diInner)) {
+                dataiterator_setpos(&diInner);
+                collection.modules.push_back({
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_MODULE_NAME),
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_MODULE_STREAM),
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_MODULE_VERSION),
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_MODULE_CONTEXT),
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_MODULE_ARCH)});
+            }
+            dataiterator_free(&diInner);
+
+            dataiterator_setpos(&di);
+            dataiterator_init(&diInner, pool, 0, SOLVID_POS, UPDATE_COLLECTION, 0, 0);
+            while (dataiterator_step(&diInner)) {
+                dataiterator_setpos(&diInner);
+                collection.packages.push_back({
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_NAME),
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_EVR),
+                    pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_ARCH)});
+            }
+            dataiterator_free(&diInner);
+        }
+        dataiterator_free(&di);
+    }
+}
+
+void
+AdvisoryIndex::add(Key key, const char * value, std::size_t position)
+{
+    if (!value) {
+        return;
+    }
+    auto & positions = keys[static_cast<int>(key)][value];
+    // an advisory can reference the same bug or CVE more than once
+    if (positions.empty() || positions.back() != position) {
+        positions.push_back(position);
+    }
+}
+
+const std::vector<std::size_t> *
+AdvisoryIndex::lookup(Key key, const char * value) const
+{
+    auto & index = keys[static_cast<int>(key)];
+    auto it = index.find(value);
+    return it == index.end() ? nullptr : &it->second;
+}
+
+bool
+AdvisoryIndex::isApplicable(DnfSack * sack, Id advisory, const Collection & collection)
+{
+    if (collection.modules.empty()) {
+        return true;
+    }
+    for (auto & module : collection.modules) {
+        AdvisoryModule moduleAdvisory(sack, advisory, module.name, module.stream,
+                                      module.version, module.context, module.arch);
+        if (moduleAdvisory.isApplicable()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+AdvisoryIndex::getApplicablePackages(DnfSack * sack, std::size_t position,
+                                     std::vector<AdvisoryPkg> & pkglist) const
+{
+    auto & entry = advisories[position];
+    for (auto & collection : entry.collections) {
+        if (!isApplicable(sack, entry.advisory, collection)) {
+            continue;
+        }
+        for (auto & package : collection.packages) {
+            pkglist.emplace_back(sack, entry.advisory, package.name, package.evr, package.arch, nullptr);
+        }
+    }
+}
+
+
+void
+AdvisoryIndex::getPackagesAdvisories(DnfSack * sack, const PackageSet & pset, int cmpType,
+                                     std::unordered_map<Id, std::vector<Id>> & result) const
+{
+    Pool * pool = dnf_sack_get_pool(sack);
+    std::unordered_map<Id, std::vector<Id>> packagesByName;
+    for (Id id = pset.next(-1); id != -1; id = pset.next(id)) {
+        packagesByName[pool_id2solvable(pool, id)->name].push_back(id);
+    }
+    if (packagesByName.empty()) {
+        return;
+    }
+
+    for (auto & entry : advisories) {
+        for (auto & collection : entry.collections) {
+            // module applicability is costly, resolve it only once a package of the collection matches
+            int applicable = -1;
+            for (auto & package : collection.packages) {
+                if (!package.evr) {
+                    continue;
+                }
+                auto candidates = packagesByName.find(package.name);
+                if (candidates == packagesByName.end()) {
+                    continue;
+                }
+                for (Id id : candidates->second) {
+                    Solvable * s = pool_id2solvable(pool, id);
+                    if (s->arch != package.arch) {
+                        continue;
+                    }
+                    auto found = result.find(id);
+                    if (found != result.end() && found->second.back() == entry.advisory) {
+                        continue;
+                    }
+                    int cmp = pool_evrcmp(pool, package.evr, s->evr, EVRCMP_COMPARE);
+                    if (!((cmp > 0 && (cmpType & HY_GT)) ||
+                          (cmp < 0 && (cmpType & HY_LT)) ||
+                          (cmp == 0 && (cmpType & HY_EQ)))) {
+                        continue;
+                    }
+                    if (applicable < 0) {
+                        applicable = isApplicable(sack, entry.advisory, collection);
+                    }
+                    if (!applicable) {
+                        break;
+                    }
+                    result[id].push_back(entry.advisory);
+                }
+                if (applicable == 0) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+}
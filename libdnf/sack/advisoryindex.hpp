@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __ADVISORY_INDEX_HPP
+#define __ADVISORY_INDEX_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <solv/pooltypes.h>
+
+#include "../dnf-types.h"
+#include "advisorypkg.hpp"
+#include "packageset.hpp"
+
+namespace libdnf {
+
+/**
+ * @brief Attributes of all advisories in the pool used by advisory filters, indexed by the strings
+ * the filters match. Built by dnf_sack_get_advisory_index() and valid until solvables are added.
+ */
+struct AdvisoryIndex {
+public:
+    enum class Key { NAME, BUG, CVE, TYPE, SEVERITY };
+
+    explicit AdvisoryIndex(DnfSack * sack);
+
+    /// Number of solvables in the pool at the time of creation
+    int getNSolvables() const noexcept { return nsolvables; }
+
+    /// Return positions of advisories with the given value of key, see getApplicablePackages()
+    const std::vector<std::size_t> * lookup(Key key, const char * value) const;
+
+    /// Append packages of collections applicable to the current module state, like
+    /// Advisory::getApplicablePackages() without filenames
+    void getApplicablePackages(DnfSack * sack, std::size_t position, std::vector<AdvisoryPkg> & pkglist) const;
+
+    /// Collect for every package of pset the advisories dnf_package_get_advisories() would return,
+    /// in one pass over the package collections. Packages without advisories are not added.
+    void getPackagesAdvisories(DnfSack * sack, const PackageSet & pset, int cmpType,
+                               std::unordered_map<Id, std::vector<Id>> & result) const;
+
+private:
+    struct ModuleEntry {
+        Id name;
+        Id stream;
+        Id version;
+        Id context;
+        Id arch;
+    };
+    struct PackageEntry {
+        Id name;
+        Id evr;
+        Id arch;
+    };
+    struct Collection {
+        std::vector<ModuleEntry> modules;
+        std::vector<PackageEntry> packages;
+    };
+    struct Entry {
+        Id advisory;
+        std::vector<Collection> collections;
+    };
+
+    void add(Key key, const char * value, std::size_t position);
+    static bool isApplicable(DnfSack * sack, Id advisory, const Collection & collection);
+
+    int nsolvables;
+    std::vector<Entry> advisories;
+    std::unordered_map<std::string, std::vector<std::size_t>> keys[5];
+};
+
+}
+
+#endif /* __ADVISORY_INDEX_HPP */
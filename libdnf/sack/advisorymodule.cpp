@@ -80,13 +80,7 @@ AdvisoryModule::isApplicable() const {
         return false;
     }
 
-    for (auto & module : moduleContainer->query(getName(), getStream(), {}, getContext(), {})) {
-        if (moduleContainer->isModuleActive(module)) {
-            return true;
-        }
-    }
-
-    return false;
+    return moduleContainer->isModuleActive(getName(), getStream(), getContext());
 }
 
 Advisory * AdvisoryModule::getAdvisory() const
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include <solv/knownid.h>
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/solvable.h>
+
+#include "packageattrs.hpp"
+#include "../dnf-sack.h"
+#include "../hy-iutil-private.hpp"
+#include "../error.hpp"
+#include "../utils/tinyformat/tinyformat.hpp"
+
+namespace libdnf {
+
+constexpr std::string::size_type PackageAttrColumn::NO_VALUE;
+
+PackageAttrType
+packageAttrType(PackageAttr attr)
+{
+    switch (attr) {
+        case PackageAttr::NAME:
+        case PackageAttr::ARCH:
+        case PackageAttr::EVR:
+            return PackageAttrType::ID;
+        case PackageAttr::EPOCH:
+        case PackageAttr::DOWNLOADSIZE:
+        case PackageAttr::INSTALLSIZE:
+        case PackageAttr::BUILDTIME:
+        case PackageAttr::INSTALLTIME:
+            return PackageAttrType::NUMBER;
+        default:
+            return PackageAttrType::STRING;
+    }
+}
+
+static const std::pair<const char *, PackageAttr> PACKAGE_ATTR_NAMES[] = {
+    {"name", PackageAttr::NAME},
+    {"arch", PackageAttr::ARCH},
+    {"evr", PackageAttr::EVR},
+    {"version", PackageAttr::VERSION},
+    {"release", PackageAttr::RELEASE},
+    {"reponame", PackageAttr::REPONAME},
+    {"summary", PackageAttr::SUMMARY},
+    {"url", PackageAttr::URL},
+    {"license", PackageAttr::LICENSE},
+    {"sourcerpm", PackageAttr::SOURCERPM},
+    {"location", PackageAttr::LOCATION},
+    {"epoch", PackageAttr::EPOCH},
+    {"downloadsize", PackageAttr::DOWNLOADSIZE},
+    {"installsize", PackageAttr::INSTALLSIZE},
+    {"buildtime", PackageAttr::BUILDTIME},
+    {"installtime", PackageAttr::INSTALLTIME},
+};
+
+bool
+packageAttrFromName(const char * name, PackageAttr & attr)
+{
+    for (const auto & item : PACKAGE_ATTR_NAMES) {
+        if (strcmp(item.first, name) == 0) {
+            attr = item.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *
+PackageAttrColumn::getString(size_t row) const
+{
+    auto offset = offsets[row];
+    if (offset == NO_VALUE)
+        return nullptr;
+    return buffer.c_str() + offset;
+}
+
+static Id
+lookupId(const Solvable * s, PackageAttr attr)
+{
+    switch (attr) {
+        case PackageAttr::NAME:
+            return s->name;
+        case PackageAttr::ARCH:
+            return s->arch;
+        default:
+            return s->evr;
+    }
+}
+
+static unsigned long long
+lookupNumber(Pool * pool, Solvable * s, PackageAttr attr)
+{
+    switch (attr) {
+        case PackageAttr::EPOCH:
+            return pool_get_epoch(pool, pool_id2str(pool, s->evr));
+        case PackageAttr::DOWNLOADSIZE:
+            return solvable_lookup_num(s, SOLVABLE_DOWNLOADSIZE, 0);
+        case PackageAttr::INSTALLSIZE:
+            return solvable_lookup_num(s, SOLVABLE_INSTALLSIZE, 0);
+        case PackageAttr::BUILDTIME:
+            return solvable_lookup_num(s, SOLVABLE_BUILDTIME, 0);
+        default:
+            return solvable_lookup_num(s, SOLVABLE_INSTALLTIME, 0);
+    }
+}
+
+unsigned long long
+packageAttrNumber(Pool * pool, Id id, PackageAttr attr)
+{
+    return lookupNumber(pool, pool_id2solvable(pool, id), attr);
+}
+
+static const char *
+lookupString(Pool * pool, Solvable * s, PackageAttr attr, std::string & evrBuf)
+{
+    char *e, *v, *r;
+    switch (attr) {
+        case PackageAttr::VERSION:
+            split_evr(pool_id2str(pool, s->evr), evrBuf, &e, &v, &r);
+            return v;
+        case PackageAttr::RELEASE:
+            split_evr(pool_id2str(pool, s->evr), evrBuf, &e, &v, &r);
+            return r;
+        case PackageAttr::REPONAME:
+            return s->repo->name;
+        case PackageAttr::SUMMARY:
+            return solvable_lookup_str(s, SOLVABLE_SUMMARY);
+        case PackageAttr::URL:
+            return solvable_lookup_str(s, SOLVABLE_URL);
+        case PackageAttr::LICENSE:
+            return solvable_lookup_str(s, SOLVABLE_LICENSE);
+        case PackageAttr::SOURCERPM:
+            return solvable_lookup_sourcepkg(s);
+        default:
+            return solvable_get_location(s, NULL);
+    }
+}
+
+PackageAttrs::PackageAttrs(const PackageSet & pset, const std::vector<PackageAttr> & attrs)
+{
+    Pool * pool = dnf_sack_get_pool(pset.getSack());
+    auto count = pset.size();
+    bool needsRepodata = false;
+
+    ids.reserve(count);
+    columns.resize(attrs.size());
+    for (size_t i = 0; i < attrs.size(); ++i) {
+        auto & column = columns[i];
+        column.attr = attrs[i];
+        switch (packageAttrType(column.attr)) {
+            case PackageAttrType::ID:
+                column.ids.reserve(count);
+                break;
+            case PackageAttrType::NUMBER:
+                column.numbers.reserve(count);
+                needsRepodata = needsRepodata || column.attr != PackageAttr::EPOCH;
+                break;
+            case PackageAttrType::STRING:
+                column.offsets.reserve(count);
+                needsRepodata = true;
+                break;
+        }
+    }
+
+    Repo * lastRepo = nullptr;
+    std::string evrBuf;
+    Id id = -1;
+    while ((id = pset.next(id)) != -1) {
+        Solvable * s = pool_id2solvable(pool, id);
+        if (needsRepodata && s->repo != lastRepo) {
+            repo_internalize_trigger(s->repo);
+            lastRepo = s->repo;
+        }
+        ids.push_back(id);
+        for (auto & column : columns) {
+            switch (packageAttrType(column.attr)) {
+                case PackageAttrType::ID:
+                    column.ids.push_back(lookupId(s, column.attr));
+                    break;
+                case PackageAttrType::NUMBER:
+                    column.numbers.push_back(lookupNumber(pool, s, column.attr));
+                    break;
+                case PackageAttrType::STRING: {
+                    const char * str = lookupString(pool, s, column.attr, evrBuf);
+                    if (!str) {
+                        column.offsets.push_back(PackageAttrColumn::NO_VALUE);
+                        break;
+                    }
+                    column.offsets.push_back(column.buffer.size());
+                    column.buffer.append(str);
+                    column.buffer.push_back('\0');
+                    break;
+                }
+            }
+        }
+    }
+}
+
+PackageFormat::PackageFormat(const std::string & queryformat)
+{
+    std::string literal;
+    for (size_t i = 0; i < queryformat.size(); ++i) {
+        char c = queryformat[i];
+        if (c == '\\' && i + 1 < queryformat.size() &&
+            (queryformat[i + 1] == 'n' || queryformat[i + 1] == 't')) {
+            literal.push_back(queryformat[++i] == 'n' ? '\n' : '\t');
+            continue;
+        }
+        if (c != '%') {
+            literal.push_back(c);
+            continue;
+        }
+        if (i + 1 < queryformat.size() && queryformat[i + 1] == '%') {
+            literal.push_back('%');
+            ++i;
+            continue;
+        }
+        // %[-][width]{tag}
+        size_t pos = i + 1;
+        if (pos < queryformat.size() && queryformat[pos] == '-')
+            ++pos;
+        size_t width = 0;
+        while (pos < queryformat.size() && queryformat[pos] >= '0' && queryformat[pos] <= '9')
+            width = width * 10 + (queryformat[pos++] - '0');
+        auto end = queryformat.find('}', pos);
+        if (pos >= queryformat.size() || queryformat[pos] != '{' || end == std::string::npos) {
+            literal.push_back(c);
+            continue;
+        }
+        auto tag = queryformat.substr(pos + 1, end - pos - 1);
+        PackageAttr attr;
+        if (!packageAttrFromName(tag.c_str(), attr))
+            throw Error(tfm::format("Unknown queryformat tag: %s", tag));
+        parts.push_back({std::move(literal), false, attr, 0});
+        literal.clear();
+        parts.push_back({std::string(), true, attr, width});
+        needsRepodata = needsRepodata ||
+            (packageAttrType(attr) != PackageAttrType::ID && attr != PackageAttr::EPOCH);
+        i = end;
+    }
+    parts.push_back({std::move(literal), false, PackageAttr::NAME, 0});
+}
+
+void
+PackageFormat::formatSolvable(Pool * pool, Solvable * s, std::string & out,
+                              std::string & evrBuf) const
+{
+    for (const auto & part : parts) {
+        if (!part.isTag) {
+            out.append(part.literal);
+            continue;
+        }
+        auto start = out.size();
+        switch (packageAttrType(part.attr)) {
+            case PackageAttrType::ID:
+                out.append(pool_id2str(pool, lookupId(s, part.attr)));
+                break;
+            case PackageAttrType::NUMBER:
+                out.append(std::to_string(lookupNumber(pool, s, part.attr)));
+                break;
+            case PackageAttrType::STRING: {
+                const char * str = lookupString(pool, s, part.attr, evrBuf);
+                if (str)
+                    out.append(str);
+                break;
+            }
+        }
+        if (out.size() - start < part.width)
+            out.append(part.width - (out.size() - start), ' ');
+    }
+}
+
+void
+PackageFormat::format(Pool * pool, Id id, std::string & out) const
+{
+    Solvable * s = pool_id2solvable(pool, id);
+    if (needsRepodata)
+        repo_internalize_trigger(s->repo);
+    std::string evrBuf;
+    formatSolvable(pool, s, out, evrBuf);
+}
+
+static void
+writeAll(int fd, const std::string & buffer)
+{
+    const char * data = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0) {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw Error(tfm::format("Writing the queryformat output failed: %s", strerror(errno)));
+        }
+        data += written;
+        left -= written;
+    }
+}
+
+size_t
+PackageFormat::write(const PackageSet & pset, int fd, size_t chunkSize) const
+{
+    Pool * pool = dnf_sack_get_pool(pset.getSack());
+    std::string buffer;
+    buffer.reserve(chunkSize + 1024);
+    std::string evrBuf;
+    Repo * lastRepo = nullptr;
+    size_t count = 0;
+    Id id = -1;
+    while ((id = pset.next(id)) != -1) {
+        Solvable * s = pool_id2solvable(pool, id);
+        if (needsRepodata && s->repo != lastRepo) {
+            repo_internalize_trigger(s->repo);
+            lastRepo = s->repo;
+        }
+        formatSolvable(pool, s, buffer, evrBuf);
+        ++count;
+        if (buffer.size() >= chunkSize) {
+            writeAll(fd, buffer);
+            buffer.clear();
+        }
+    }
+    writeAll(fd, buffer);
+    return count;
+}
+
+}
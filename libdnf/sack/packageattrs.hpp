@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __PACKAGE_ATTRS_HPP
+#define __PACKAGE_ATTRS_HPP
+
+#include <string>
+#include <vector>
+
+#include <solv/pooltypes.h>
+
+#include "packageset.hpp"
+
+namespace libdnf {
+
+enum class PackageAttr {
+    // string Ids from the pool
+    NAME,
+    ARCH,
+    EVR,
+    // strings
+    VERSION,
+    RELEASE,
+    REPONAME,
+    SUMMARY,
+    URL,
+    LICENSE,
+    SOURCERPM,
+    LOCATION,
+    // numbers
+    EPOCH,
+    DOWNLOADSIZE,
+    INSTALLSIZE,
+    BUILDTIME,
+    INSTALLTIME
+};
+
+enum class PackageAttrType { ID, STRING, NUMBER };
+
+PackageAttrType packageAttrType(PackageAttr attr);
+
+/**
+* @brief Sets attr to the attribute of the lowercase name, e.g. "name" or "installsize", returns
+* false if there is none
+*/
+bool packageAttrFromName(const char * name, PackageAttr & attr);
+
+/**
+* @brief Returns the value of a PackageAttrType::NUMBER attribute of the solvable, 0 if it has none
+*/
+unsigned long long packageAttrNumber(Pool * pool, Id id, PackageAttr attr);
+
+/**
+* @brief One attribute of all packages of a PackageAttrs table, stored contiguously.
+*
+* Only the vector matching the attribute type is filled. Strings are copied into a single buffer
+* because the pool only guarantees the lifetime of looked up strings until the next lookup.
+*/
+struct PackageAttrColumn {
+    PackageAttr attr;
+    std::vector<Id> ids;
+    std::vector<unsigned long long> numbers;
+    std::vector<std::string::size_type> offsets;
+    std::string buffer;
+
+    /**
+    * @brief Returns the string of the given row or nullptr if the package has no such value
+    */
+    const char * getString(size_t row) const;
+
+    static constexpr std::string::size_type NO_VALUE = std::string::npos;
+};
+
+/**
+* @brief Extracts attributes of a whole PackageSet in one pass over its solvables.
+*
+* Row i of every column belongs to getPackageIds()[i]. The attributes are read directly from the
+* pool, avoiding a DnfPackage object per package.
+*/
+class PackageAttrs {
+public:
+    PackageAttrs(const PackageSet & pset, const std::vector<PackageAttr> & attrs);
+
+    size_t size() const noexcept { return ids.size(); }
+    const std::vector<Id> & getPackageIds() const noexcept { return ids; }
+    const std::vector<PackageAttrColumn> & getColumns() const noexcept { return columns; }
+    /// Allows moving the column data out of the table
+    std::vector<PackageAttrColumn> & getColumns() noexcept { return columns; }
+
+private:
+    std::vector<Id> ids;
+    std::vector<PackageAttrColumn> columns;
+};
+
+/**
+* @brief A queryformat of repoquery, e.g. "%{name}-%{evr}.%{arch}\n", rendered directly from the
+* pool.
+*
+* The tags are the names of packageAttrFromName(), optionally with a width the value is padded to
+* on the right, e.g. "%-20{name}". "%%" is a percent sign, "\n" and "\t" spelled with a backslash
+* are a newline and a tab like in dnf.
+*/
+class PackageFormat {
+public:
+    /// @throws libdnf::Error for an unknown tag
+    explicit PackageFormat(const std::string & queryformat);
+
+    /// Appends the rendered package to out
+    void format(Pool * pool, Id id, std::string & out) const;
+
+    /**
+    * @brief Writes the packages of pset in the id order to fd, in chunks of about chunkSize
+    * bytes, so the output starts right away and the memory does not grow with the set.
+    *
+    * @return size_t the number of written packages
+    * @throws libdnf::Error when writing fails
+    */
+    size_t write(const PackageSet & pset, int fd, size_t chunkSize = 64 * 1024) const;
+
+private:
+    struct Part {
+        std::string literal;
+        bool isTag;
+        PackageAttr attr;
+        size_t width;
+    };
+    std::vector<Part> parts;
+    bool needsRepodata{false};
+
+    void formatSolvable(Pool * pool, Solvable * s, std::string & out, std::string & evrBuf) const;
+};
+
+}
+
+#endif /* __PACKAGE_ATTRS_HPP */
@@ -19,13 +19,125 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "packageset.hpp"
 #include "../dnf-sack.h"
 #include "../hy-util-private.hpp"
 
+// The bitmap kernels below work on 64 bit words. On x86_64 the binary also carries AVX2 (and
+// POPCNT) clones of them, the matching one is selected at load time. Other architectures get
+// the plain word loop, which the compiler vectorizes for the baseline SIMD (e.g. NEON).
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define BITMAP_KERNEL __attribute__((target_clones("avx2", "default")))
+#define POPCOUNT_KERNEL __attribute__((target_clones("popcnt", "default")))
+#endif
+#endif
+#ifndef BITMAP_KERNEL
+#define BITMAP_KERNEL
+#define POPCOUNT_KERNEL
+#endif
+
 namespace libdnf {
 
+namespace {
+
+// Returns 8 bytes of the map as a word with the bit of the lowest id in bit 0
+inline uint64_t
+loadWord(const unsigned char *map, size_t size)
+{
+    uint64_t word = 0;
+    memcpy(&word, map, size < 8 ? size : 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+BITMAP_KERNEL void
+bitmapAnd(unsigned char *target, const unsigned char *source, size_t size)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t t, s;
+        memcpy(&t, target + i, 8);
+        memcpy(&s, source + i, 8);
+        t &= s;
+        memcpy(target + i, &t, 8);
+    }
+    for (; i < size; ++i)
+        target[i] &= source[i];
+}
+
+BITMAP_KERNEL void
+bitmapOr(unsigned char *target, const unsigned char *source, size_t size)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t t, s;
+        memcpy(&t, target + i, 8);
+        memcpy(&s, source + i, 8);
+        t |= s;
+        memcpy(target + i, &t, 8);
+    }
+    for (; i < size; ++i)
+        target[i] |= source[i];
+}
+
+BITMAP_KERNEL void
+bitmapAndNot(unsigned char *target, const unsigned char *source, size_t size)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t t, s;
+        memcpy(&t, target + i, 8);
+        memcpy(&s, source + i, 8);
+        t &= ~s;
+        memcpy(target + i, &t, 8);
+    }
+    for (; i < size; ++i)
+        target[i] &= ~source[i];
+}
+
+POPCOUNT_KERNEL size_t
+bitmapCount(const unsigned char *map, size_t size)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < size; i += 8)
+        count += __builtin_popcountll(loadWord(map + i, size - i));
+    return count;
+}
+
+// The same semantics as libsolv's map_and(), map_or() and map_subtract() for maps of different size
+void
+mapAnd(Map *target, const Map *source)
+{
+    if (target->size <= source->size) {
+        bitmapAnd(target->map, source->map, target->size);
+        return;
+    }
+    bitmapAnd(target->map, source->map, source->size);
+    memset(target->map + source->size, 0, target->size - source->size);
+}
+
+void
+mapOr(Map *target, const Map *source)
+{
+    if (target->size < source->size)
+        map_grow(target, source->size << 3);
+    bitmapOr(target->map, source->map, source->size);
+}
+
+void
+mapSubtract(Map *target, const Map *source)
+{
+    bitmapAndNot(target->map, source->map, target->size < source->size ? target->size : source->size);
+}
+
+}
+
 class PackageSet::Impl {
 public:
     Impl(DnfSack* sack);
@@ -63,29 +175,19 @@ PackageSet::Impl::~Impl() { map_free(&map); }
 Id
 PackageSet::operator [](unsigned int index) const
 {
-    const unsigned char *ti = pImpl->map.map;
-    const unsigned char *end = ti + pImpl->map.size;
-    unsigned int enabled;
-    Id id;
-
-    while (ti < end) {
-        enabled = _BitCountLookup[*ti];
+    const unsigned char *map = pImpl->map.map;
+    size_t size = pImpl->map.size;
 
-        if (index >= enabled ){
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word = loadWord(map + i, size - i);
+        unsigned int enabled = __builtin_popcountll(word);
+        if (index >= enabled) {
             index -= enabled;
-            ti++;
             continue;
         }
-        id = (ti - pImpl->map.map) << 3;
-
-        index++;
-        for (unsigned char byte = *ti; index; byte >>= 1) {
-            if ((byte & 0x01))
-                index--;
-            if (index)
-                id++;
-        }
-        return id;
+        for (; index; --index)
+            word &= word - 1;
+        return (i << 3) + __builtin_ctzll(word);
     }
     return -1;
 }
@@ -93,42 +195,42 @@ PackageSet::operator [](unsigned int index) const
 PackageSet &
 PackageSet::operator +=(const PackageSet & other)
 {
-    map_or(&pImpl->map, &other.pImpl->map);
+    mapOr(&pImpl->map, &other.pImpl->map);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator -=(const PackageSet & other)
 {
-    map_subtract(&pImpl->map, &other.pImpl->map);
+    mapSubtract(&pImpl->map, &other.pImpl->map);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator /=(const PackageSet & other)
 {
-    map_and(&pImpl->map, &other.pImpl->map);
+    mapAnd(&pImpl->map, &other.pImpl->map);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator +=(const Map * other)
 {
-    map_or(&pImpl->map, const_cast<Map *>(other));
+    mapOr(&pImpl->map, other);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator -=(const Map * other)
 {
-    map_subtract(&pImpl->map, const_cast<Map *>(other));
+    mapSubtract(&pImpl->map, other);
     return *this;
 }
 
 PackageSet &
 PackageSet::operator /=(const Map * other)
 {
-    map_and(&pImpl->map, const_cast<Map *>(other));
+    mapAnd(&pImpl->map, other);
     return *this;
 }
 
@@ -139,13 +241,13 @@ PackageSet::clear()
 }
 
 bool
-PackageSet::empty()
+PackageSet::empty() const
 {
-    const unsigned char *res = pImpl->map.map;
-    const unsigned char *end = res + pImpl->map.size;
+    const unsigned char *map = pImpl->map.map;
+    size_t size = pImpl->map.size;
 
-    while (res < end) {
-        if (*res++)
+    for (size_t i = 0; i < size; i += 8) {
+        if (loadWord(map + i, size - i))
             return false;
     }
     return true;
@@ -159,38 +261,27 @@ bool PackageSet::has(Id id) const { return MAPTST(&pImpl->map, id); }
 void PackageSet::remove(Id id) { MAPCLR(&pImpl->map, id); }
 Map *PackageSet::getMap() const { return &pImpl->map; }
 DnfSack *PackageSet::getSack() const { return pImpl->sack; }
-size_t PackageSet::size() const { return map_count(&pImpl->map); }
+size_t PackageSet::size() const { return bitmapCount(pImpl->map.map, pImpl->map.size); }
 
 Id PackageSet::next(Id previous) const
 {
-    const unsigned char *ti = pImpl->map.map;
-    const unsigned char *end = ti + pImpl->map.size;
-    Id id;
+    const unsigned char *map = pImpl->map.map;
+    size_t size = pImpl->map.size;
+    size_t first = previous < 0 ? 0 : static_cast<size_t>(previous) + 1;
 
-    if (previous >= 0) {
-        ti += previous >> 3;
-        unsigned char byte = *ti; // byte with the previous match
-        byte >>= (previous & 7) + 1; // shift away all previous 1 bits
-
-        for (id = previous + 1; byte; byte >>= 1, id++)
-            if (byte & 0x01)
-                return id;
-        ti++;
+    // start at the word containing the first candidate and mask off the lower bits
+    size_t i = (first >> 3) & ~static_cast<size_t>(7);
+    if (i >= size)
+        return -1;
+    uint64_t word = loadWord(map + i, size - i) & (~0ULL << (first - (i << 3)));
+    while (true) {
+        if (word)
+            return (i << 3) + __builtin_ctzll(word);
+        i += 8;
+        if (i >= size)
+            return -1;
+        word = loadWord(map + i, size - i);
     }
-
-    while (ti < end) {
-
-        if (!*ti){
-            ti++;
-            continue;
-        }
-        id = (ti - pImpl->map.map) << 3;
-        for (unsigned char byte = *ti; 1; byte >>= 1, id++) {
-            if (byte & 0x01)
-                return id;
-        }
-    }
-    return -1;
 }
 
 }
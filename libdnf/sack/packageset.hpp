@@ -44,7 +44,7 @@ public:
     PackageSet & operator -=(const Map * other);
     PackageSet & operator /=(const Map * other);
     void clear();
-    bool empty();
+    bool empty() const;
     void set(DnfPackage *pkg);
     void set(Id id);
     bool has(DnfPackage *pkg) const;
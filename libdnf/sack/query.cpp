@@ -22,7 +22,10 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <fnmatch.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 extern "C" {
@@ -44,11 +47,15 @@ extern "C" {
 #include "../goal/IdQueue.hpp"
 #include "../goal/Goal-private.hpp"
 #include "advisory.hpp"
+#include "advisoryindex.hpp"
 #include "advisorypkg.hpp"
 #include "packageset.hpp"
+#include "substringindex.hpp"
 
 #include "libdnf/repo/solvable/Dependency.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
+#include "libdnf/utils/GlobMatcher.hpp"
+#include "libdnf/utils/probes.hpp"
 
 
 namespace std {
@@ -181,14 +188,6 @@ nameArchCompareLowerSolvable(const NevraID &first, const Solvable &s)
     return first.arch < s.arch;
 }
 
-static bool
-NameArchSolvableComparator(const Solvable * first, const Solvable * second)
-{
-    if (first->name != second->name)
-        return first->name < second->name;
-    return first->arch < second->arch;
-}
-
 static bool
 NameSolvableComparator(const Solvable * first, const Solvable * second)
 {
@@ -505,61 +504,36 @@ pool_solvable_epoch_optional_2str(Pool *pool, const Solvable *s, gboolean with_e
     return output_string;
 }
 
-static int
-filter_latest_sortcmp(const void *ap, const void *bp, void *dp)
+/**
+* @brief Append the packages of pset ordered like the latest filter keyname groups them, see
+* dnf_sack_get_latest_order(). The sack keeps the order of all solvables, a large pset is
+* picked from it and a small one sorted by the positions in it.
+*/
+static void
+latestOrdered(DnfSack * sack, int keyname, const PackageSet & pset, IdQueue & ordered)
 {
-    auto pool = static_cast<Pool *>(dp);
-    Solvable *sa = pool->solvables + *(Id *)ap;
-    Solvable *sb = pool->solvables + *(Id *)bp;
-    int r;
-    r = sa->name - sb->name;
-    if (r)
-        return r;
-    r = pool_evrcmp(pool, sb->evr, sa->evr, EVRCMP_COMPARE);
-    if (r)
-        return r;
-    return *(Id *)ap - *(Id *)bp;
-}
-
-static int
-filter_latest_sortcmp_byarch(const void *ap, const void *bp, void *dp)
-{
-    auto pool = static_cast<Pool *>(dp);
-    Solvable *sa = pool->solvables + *(Id *)ap;
-    Solvable *sb = pool->solvables + *(Id *)bp;
-    int r;
-    r = sa->name - sb->name;
-    if (r)
-        return r;
-    r = sa->arch - sb->arch;
-    if (r)
-        return r;
-    r = pool_evrcmp(pool, sb->evr, sa->evr, EVRCMP_COMPARE);
-    if (r)
-        return r;
-    return *(Id *)ap - *(Id *)bp;
-}
-
-static int
-filter_latest_sortcmp_byarch_bypriority(const void *ap, const void *bp, void *dp)
-{
-    auto pool = static_cast<Pool *>(dp);
-    Solvable *sa = pool->solvables + *(Id *)ap;
-    Solvable *sb = pool->solvables + *(Id *)bp;
-    int r;
-    r = sa->name - sb->name;
-    if (r)
-        return r;
-    r = sa->arch - sb->arch;
-    if (r)
-        return r;
-    r = sb->repo->priority - sa->repo->priority;
-    if (r)
-        return r;
-    r = pool_evrcmp(pool, sb->evr, sa->evr, EVRCMP_COMPARE);
-    if (r)
-        return r;
-    return *(Id *)ap - *(Id *)bp;
+    auto & order = dnf_sack_get_latest_order(sack, keyname);
+    auto count = pset.size();
+    if (count < order.ids.size() / 16) {
+        std::vector<Id> ids;
+        ids.reserve(count);
+        Id id = -1;
+        while ((id = pset.next(id)) != -1) {
+            if (order.ranks[id] >= 0)
+                ids.push_back(id);
+        }
+        std::sort(ids.begin(), ids.end(), [&order](Id a, Id b) {
+            return order.ranks[a] < order.ranks[b];
+        });
+        for (Id id : ids)
+            ordered.pushBack(id);
+        return;
+    }
+    auto map = pset.getMap();
+    for (Id id : order.ids) {
+        if (MAPTST(map, id))
+            ordered.pushBack(id);
+    }
 }
 
 /**
@@ -567,22 +541,22 @@ filter_latest_sortcmp_byarch_bypriority(const void *ap, const void *bp, void *dp
 *
 * @param pool: Package pool
 * @param m: Map of query results complying the filter
-* @param samename: Queue containing the block
+* @param samename: IdQueue containing the block
 * @param start_block: Start of the block
 * @param stop_block: End of the block
 * @param latest: Number of first packages in the block to add into the map.
 *                If negative, it's number of first packages in the block to exclude.
 */
 static void
-add_latest_to_map(const Pool *pool, Map *m, Queue *samename,
+add_latest_to_map(const Pool *pool, Map *m, const IdQueue & samename,
                   int start_block, int stop_block, int latest)
 {
     Solvable *solv_element, *solv_previous_element;
     int version_counter = 0;
-    solv_previous_element = pool->solvables + samename->elements[start_block];
+    solv_previous_element = pool->solvables + samename[start_block];
     Id id_previous_evr = solv_previous_element->evr;
     for (int pos = start_block; pos < stop_block; ++pos) {
-        Id id_element = samename->elements[pos];
+        Id id_element = samename[pos];
         solv_element = pool->solvables + id_element;
         Id id_current_evr = solv_element->evr;
         if (id_previous_evr != id_current_evr) {
@@ -603,13 +577,13 @@ add_latest_to_map(const Pool *pool, Map *m, Queue *samename,
 }
 
 static void
-add_duplicates_to_map(Pool *pool, Map *res, IdQueue & samename, int start_block, int stop_block)
+add_duplicates_to_map(Pool *pool, Map *res, const std::vector<Id> & samename)
 {
     Solvable *s_first, *s_second;
-    for (int pos = start_block; pos < stop_block; ++pos) {
+    for (std::size_t pos = 0; pos < samename.size(); ++pos) {
         Id id_first = samename[pos];
         s_first = pool->solvables + id_first;
-        for (int pos2 = pos + 1; pos2 < stop_block; ++pos2) {
+        for (std::size_t pos2 = pos + 1; pos2 < samename.size(); ++pos2) {
             Id id_second = samename[pos2];
             s_second = pool->solvables + id_second;
             if ((s_first->evr == s_second->evr) && (s_first->arch != s_second->arch)) {
@@ -657,19 +631,16 @@ SolvableCompareAdvisoryPkgNameArch(const Solvable * s, const AdvisoryPkg & first
     return first.getArch() > s->arch;
 }
 
-static char *
-copyFilterChar(const char * match, int keyname)
+/// Length a string match is stored with, file paths lose their trailing '/'
+static size_t
+filterStrLength(const char * match, int keyname)
 {
     if (!match)
         throw std::runtime_error("Query can not accept NULL for STR match");
     size_t len = strlen(match);
-    char * matchNew = new char[len + 1];
-    if (keyname == HY_PKG_FILE && len > 1 && match[--len] == '/') {
-        strncpy(matchNew, match, len);
-        matchNew[len] = '\0';
-        return matchNew;
-    }
-    return strcpy(matchNew, match);
+    if (keyname == HY_PKG_FILE && len > 1 && match[len - 1] == '/')
+        --len;
+    return len;
 }
 
 class Filter::Impl {
@@ -681,7 +652,33 @@ private:
     int keyname;
     int matchType;
     std::vector<_Match> matches;
+    /// all string matches in one allocation, each followed by '\0'
+    std::unique_ptr<char[]> strings;
+    void setStrMatches(const char * const * strs, size_t nmatches);
 };
+
+void
+Filter::Impl::setStrMatches(const char * const * strs, size_t nmatches)
+{
+    std::vector<size_t> lengths(nmatches);
+    size_t total = 0;
+    for (size_t i = 0; i < nmatches; ++i) {
+        lengths[i] = filterStrLength(strs[i], keyname);
+        total += lengths[i] + 1;
+    }
+    strings.reset(new char[total]);
+    matches.reserve(nmatches);
+    char * pos = strings.get();
+    for (size_t i = 0; i < nmatches; ++i) {
+        memcpy(pos, strs[i], lengths[i]);
+        pos[lengths[i]] = '\0';
+        _Match match_in;
+        match_in.str = pos;
+        matches.push_back(match_in);
+        pos += lengths[i] + 1;
+    }
+}
+
 Filter::Filter(int keyname, int cmp_type, int match) : pImpl(new Impl)
 {
     pImpl->keyname = keyname;
@@ -739,40 +736,24 @@ Filter::Filter(int keyname, int cmp_type, const char *match) : pImpl(new Impl)
     pImpl->keyname = keyname;
     pImpl->cmpType = cmp_type;
     pImpl->matchType = _HY_STR;
-    _Match match_in;
-    match_in.str = copyFilterChar(match, keyname);
-    pImpl->matches.push_back(match_in);
+    pImpl->setStrMatches(&match, 1);
 }
 Filter::Filter(int keyname, int cmp_type, const char **matches) : pImpl(new Impl)
 {
     pImpl->keyname = keyname;
     pImpl->cmpType = cmp_type;
     pImpl->matchType = _HY_STR;
-    const unsigned nmatches = g_strv_length((gchar**)matches);
-    pImpl->matches.reserve(nmatches);
-    for (unsigned int i = 0; i < nmatches; ++i) {
-        _Match match_in;
-        match_in.str = copyFilterChar(matches[i], keyname);
-        pImpl->matches.push_back(match_in);
-    }
+    pImpl->setStrMatches(matches, g_strv_length((gchar**)matches));
 }
 
 Filter::~Filter() = default;
 
 Filter::Impl::~Impl()
 {
-    for (auto & match : matches) {
-        switch (matchType) {
-            case _HY_PKG:
-                delete match.pset;
-                break;
-            case _HY_STR:
-                delete[] match.str;
-                break;
-            default:
-                break;
-        }
-    }
+    if (matchType != _HY_PKG)
+        return;
+    for (auto & match : matches)
+        delete match.pset;
 };
 
 int Filter::getKeyname() const noexcept { return pImpl->keyname; }
@@ -791,9 +772,13 @@ private:
     bool applied{0};
     DnfSack *sack;
     Query::ExcludeFlags flags;
-    std::unique_ptr<PackageSet> result;
+    // shared between copies of a query until one of them modifies it, see mutableResult()
+    std::shared_ptr<PackageSet> result;
     std::vector<Filter> filters;
+    bool analyze{false};
+    std::vector<FilterStats> analysis;
     void apply();
+    PackageSet * mutableResult();
     Map *considered_cached = nullptr;
 
     /**
@@ -849,12 +834,10 @@ Query::Impl::Impl(const Query::Impl & src)
 : applied(src.applied)
 , sack(src.sack)
 , flags(src.flags)
+, result(src.result)
 , filters(src.filters)
-{
-    if (src.result) {
-        result.reset(new PackageSet(*src.result.get()));
-    }
-}
+, analyze(src.analyze)
+{}
 
 Query::Impl &
 Query::Impl::operator=(const Query::Impl & src)
@@ -863,14 +846,21 @@ Query::Impl::operator=(const Query::Impl & src)
     sack = src.sack;
     flags = src.flags;
     filters = src.filters;
-    if (src.result) {
-        result.reset(new PackageSet(*src.result.get()));
-    } else {
-        result.reset();
-    }
+    result = src.result;
+    analyze = src.analyze;
     return *this;
 }
 
+/// Returns the result for modification, it is copied first when another query shares it.
+PackageSet *
+Query::Impl::mutableResult()
+{
+    if (result && result.use_count() > 1) {
+        result = std::make_shared<PackageSet>(*result);
+    }
+    return result.get();
+}
+
 Query::Query(const Query & query_src) : pImpl(new Impl(*query_src.pImpl)) {}
 Query::Query(DnfSack *sack, Query::ExcludeFlags flags) : pImpl(new Impl(sack, flags)) {}
 Query::~Query() = default;
@@ -881,7 +871,7 @@ Map *
 Query::getResult() noexcept
 {
     if (pImpl->result)
-        return pImpl->result->getMap();
+        return pImpl->mutableResult()->getMap();
     else
         return nullptr;
 }
@@ -890,7 +880,7 @@ const Map * Query::getResult() const noexcept { return pImpl->result->getMap();
 PackageSet * Query::getResultPset()
 {
     pImpl->apply();
-    return pImpl->result.get();
+    return pImpl->mutableResult();
 }
 bool Query::getApplied() const noexcept { return pImpl->applied; }
 DnfSack * Query::getSack() { return pImpl->sack; }
@@ -1113,90 +1103,47 @@ Query::Impl::filterNevraStrict(int cmpType, const char **matches)
     }
     if (compareSet.empty()) {
         if (!(cmpType & HY_NOT))
-            map_empty(result->getMap());
+            map_empty(mutableResult()->getMap());
         return;
     }
     Map nevraResult;
     map_init(&nevraResult, pool->nsolvables);
 
-    //  if cmpType == HY_EQ or cmpType == (HY_EQ | HY_NOT) -> performance optimization
-    if (createEVRId) {
-        if (compareSet.size() > 1) {
-            std::sort(compareSet.begin(), compareSet.end(), nevraIDSorter);
-
-            Id id = -1;
-            while (true) {
-                id = result->next(id);
-                if (id == -1)
-                    break;
-                Solvable* s = pool_id2solvable(pool, id);
-                auto low = std::lower_bound(compareSet.begin(), compareSet.end(), *s,
-                                            nevraCompareLowerSolvable);
-                if (low != compareSet.end() && low->name == s->name && low->arch == s->arch
-                    && low->evr == s->evr) {
-                    MAPSET(&nevraResult, id);
-                }
-            }
-        } else {
-            NevraID & nevraId = compareSet[0];
-            Id id = -1;
-            while (true) {
-                id = result->next(id);
-                if (id == -1)
-                    break;
-                Solvable* s = pool_id2solvable(pool, id);
-                if (nevraId.name == s->name && nevraId.arch == s->arch && nevraId.evr == s->evr) {
-                    MAPSET(&nevraResult, id);
-                }
-            }
-        }
-    } else {
-        if (compareSet.size() > 1) {
-            std::sort(compareSet.begin(), compareSet.end(), nevraNameArchKey);
-
-            Id id = -1;
-            while (true) {
-                id = result->next(id);
-                if (id == -1)
-                    break;
-                Solvable* s = pool_id2solvable(pool, id);
-                auto low = std::lower_bound(compareSet.begin(), compareSet.end(), *s,
-                                            nameArchCompareLowerSolvable);
-                while (low != compareSet.end() && low->name == s->name && low->arch == s->arch) {
-                    int cmp = pool_evrcmp_str(
-                        pool, pool_id2str(pool, s->evr), low->evr_str.c_str(), EVRCMP_COMPARE);
-
-                    if ((cmp > 0 && cmpType & HY_GT) || (cmp < 0 && cmpType & HY_LT)
-                        || (cmp == 0 && cmpType & HY_EQ)) {
-                        MAPSET(&nevraResult, id);
-                        break;
-                    }
-                    ++low;
-                }
+    // candidates come from the name index, the solvables of each name are visited once
+    std::sort(compareSet.begin(), compareSet.end(), createEVRId ? nevraIDSorter : nevraNameArchKey);
+    for (auto group = compareSet.begin(); group != compareSet.end();) {
+        const Id name = group->name;
+        auto groupEnd = std::find_if(group, compareSet.end(),
+                                     [name](const NevraID & nevraId) { return nevraId.name != name; });
+        auto range = dnf_sack_solvables_with_name(sack, name);
+        for (auto id = range.first; id != range.second; ++id) {
+            if (!result->has(*id))
+                continue;
+            Solvable* s = pool_id2solvable(pool, *id);
+            //  if cmpType == HY_EQ or cmpType == (HY_EQ | HY_NOT) -> performance optimization
+            if (createEVRId) {
+                auto low = std::lower_bound(group, groupEnd, *s, nevraCompareLowerSolvable);
+                if (low != groupEnd && low->arch == s->arch && low->evr == s->evr)
+                    MAPSET(&nevraResult, *id);
+                continue;
             }
-        } else {
-            auto & nevraId = compareSet[0];
-            Id id = -1;
-            while (true) {
-                id = result->next(id);
-                if (id == -1)
+            auto low = std::lower_bound(group, groupEnd, *s, nameArchCompareLowerSolvable);
+            for (; low != groupEnd && low->arch == s->arch; ++low) {
+                int cmp = pool_evrcmp_str(
+                    pool, pool_id2str(pool, s->evr), low->evr_str.c_str(), EVRCMP_COMPARE);
+                if ((cmp > 0 && cmpType & HY_GT) || (cmp < 0 && cmpType & HY_LT)
+                    || (cmp == 0 && cmpType & HY_EQ)) {
+                    MAPSET(&nevraResult, *id);
                     break;
-                Solvable* s = pool_id2solvable(pool, id);
-                if (nevraId.name == s->name && nevraId.arch == s->arch) {
-                    int cmp = pool_evrcmp_str(
-                        pool, pool_id2str(pool, s->evr), nevraId.evr_str.c_str(), EVRCMP_COMPARE);
-                    if ((cmp > 0 && cmpType & HY_GT) || (cmp < 0 && cmpType & HY_LT) ||
-                        (cmp == 0 && cmpType & HY_EQ)) {
-                        MAPSET(&nevraResult, id);
-                    }
                 }
             }
         }
+        group = groupEnd;
     }
     if (cmpType & HY_NOT)
-        map_subtract(result->getMap(), &nevraResult);
+        map_subtract(mutableResult()->getMap(), &nevraResult);
     else
-        map_and(result->getMap(), &nevraResult);
+        map_and(mutableResult()->getMap(), &nevraResult);
     map_free(&nevraResult);
 }
 
@@ -1245,31 +1192,77 @@ Query::Impl::filterDepSolvable(const Filter & f, Map * m)
     dnf_sack_make_provides_ready(sack);
     Pool * pool = dnf_sack_get_pool(sack);
     Id rco_key = reldep_keyname2id(f.getKeyname());
-
-    IdQueue out;
-
     const auto filter_pset = f.getMatches()[0].pset;
+    const Map * targets = filter_pset->getMap();
+    auto resultPset = result.get();
+
+    // names of everything the targets provide, only deps of these names or rich deps can match
+    std::vector<Id> names{0};
+    Queue deps;
+    queue_init(&deps);
     Id id = -1;
     while ((id = filter_pset->next(id)) != -1) {
-        out.clear();
-
-        // queue_push2 because we are creating a selection, which contains pairs
-        // of <flags, Id>, SOLVER_SOOLVABLE_ALL is a special flag which includes
-        // all packages from specified pool, Id is ignored.
-        out.pushBack(SOLVER_SOLVABLE_ALL, 0);
-
-        int flags = 0;
-        flags |= SELECTION_FILTER | SELECTION_WITH_ALL;
-        selection_make_matchsolvable(pool, out.getQueue(), id, flags, rco_key, 0);
+        queue_empty(&deps);
+        solvable_lookup_idarray(pool_id2solvable(pool, id), SOLVABLE_PROVIDES, &deps);
+        for (int i = 0; i < deps.count; ++i) {
+            Id name = deps.elements[i];
+            while (ISRELDEP(name))
+                name = GETRELDEP(pool, name)->name;
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    // whether some target provides the dep, each dep is looked up in whatprovides only once
+    std::unordered_map<Id, bool> providedByTarget;
+    auto isProvided = [&](Id dep) {
+        auto it = providedByTarget.find(dep);
+        if (it != providedByTarget.end())
+            return it->second;
+        bool provided = false;
+        Id p, pp;
+        FOR_PROVIDES(p, pp, dep) {
+            if (MAPTST(targets, p)) {
+                provided = true;
+                break;
+            }
+        }
+        providedByTarget.emplace(dep, provided);
+        return provided;
+    };
 
-        // Queue from selection_make_matchsolvable is a selection, which means
-        // it conntains pairs <flags, Id>, flags refers to how was the Id
-        // matched, that is not important here, so skip it and iterate just
-        // over the Ids.
-        for (int j = 1; j < out.size(); j += 2) {
-            MAPSET(m, out[j]);
+    for (Id name : names) {
+        auto range = dnf_sack_solvables_with_dep_name(sack, rco_key, name);
+        for (auto candidate = range.first; candidate != range.second; ++candidate) {
+            if (MAPTST(m, *candidate) || !resultPset->has(*candidate))
+                continue;
+            queue_empty(&deps);
+            solvable_lookup_idarray(pool_id2solvable(pool, *candidate), rco_key, &deps);
+            for (int i = 0; i < deps.count; ++i) {
+                Id dep = deps.elements[i];
+                if (dep == SOLVABLE_PREREQMARKER || dep == SOLVABLE_FILEMARKER)
+                    continue;
+                if (isProvided(dep)) {
+                    MAPSET(m, *candidate);
+                    break;
+                }
+            }
         }
     }
+    queue_free(&deps);
+}
+
+static bool
+solvable_has_matching_dep(Pool *pool, Id id, Id keyname, Id reldep, Queue *deps)
+{
+    queue_empty(deps);
+    solvable_lookup_idarray(pool_id2solvable(pool, id), keyname, deps);
+    for (int j = 0; j < deps->count; ++j) {
+        if (pool_match_dep(pool, reldep, deps->elements[j]))
+            return true;
+    }
+    return false;
 }
 
 void
@@ -1283,24 +1276,30 @@ Query::Impl::filterRcoReldep(const Filter & f, Map *m)
     auto resultPset = result.get();
 
     queue_init(&rco);
-    Id resultId = -1;
-    while ((resultId = resultPset->next(resultId)) != -1) {
-        Solvable *s = pool_id2solvable(pool, resultId );
-        for (auto match : f.getMatches()) {
-            Id reldepFilterId = match.reldep;
-
-            queue_empty(&rco);
-            solvable_lookup_idarray(s, rco_key, &rco);
-            for (int j = 0; j < rco.count; ++j) {
-                Id reldepIdFromSolvable = rco.elements[j];
-
-                if (pool_match_dep(pool, reldepFilterId, reldepIdFromSolvable )) {
-                    MAPSET(m, resultId );
-                    goto nextId;
-                }
+    for (auto match : f.getMatches()) {
+        Id reldepFilterId = match.reldep;
+        Id name = reldepFilterId;
+        while (ISRELDEP(name) && GETRELDEP(pool, name)->flags <= 7)
+            name = GETRELDEP(pool, name)->name;
+        if (ISRELDEP(name)) {
+            // a rich or arch filter, its name tells nothing about the matching deps
+            Id resultId = -1;
+            while ((resultId = resultPset->next(resultId)) != -1) {
+                if (!MAPTST(m, resultId) &&
+                    solvable_has_matching_dep(pool, resultId, rco_key, reldepFilterId, &rco))
+                    MAPSET(m, resultId);
+            }
+            continue;
+        }
+        // only solvables with a dep of the name or a rich dep can match
+        for (Id depName : {name, 0}) {
+            auto range = dnf_sack_solvables_with_dep_name(sack, rco_key, depName);
+            for (auto id = range.first; id != range.second; ++id) {
+                if (!MAPTST(m, *id) && resultPset->has(*id) &&
+                    solvable_has_matching_dep(pool, *id, rco_key, reldepFilterId, &rco))
+                    MAPSET(m, *id);
             }
         }
-        nextId:;
     }
     queue_free(&rco);
 }
@@ -1313,49 +1312,64 @@ Query::Impl::filterName(const Filter & f, Map *m)
     auto resultPset = result.get();
 
     if ((cmpType & HY_EQ) && !(cmpType & HY_ICASE)) {
-        Id match_name_id = 0;
-        if (f.getMatches().size() < 3) {
-            for (auto match_union : f.getMatches()) {
-                const char *match = match_union.str;
-                match_name_id = pool_str2id(pool, match, 0);
-                if (match_name_id == 0)
-                    continue;
-                Id id = -1;
-                while (true) {
-                    id = resultPset->next(id);
-                    if (id == -1)
-                        break;
-                    Solvable *s = pool_id2solvable(pool, id);
-                    if (match_name_id == s->name)
-                        MAPSET(m, id);
-                    continue;
-                }
-            }
-            return;
-        }
-        std::vector<Id> names;
+        // m is intersected with result afterwards, all solvables of the name can be set
         for (auto match_union : f.getMatches()) {
-            const char *match = match_union.str;
-            match_name_id = pool_str2id(pool, match, 0);
+            Id match_name_id = pool_str2id(pool, match_union.str, 0);
             if (match_name_id == 0)
                 continue;
-            names.push_back(match_name_id);
+            auto range = dnf_sack_solvables_with_name(sack, match_name_id);
+            for (auto id = range.first; id != range.second; ++id)
+                MAPSET(m, *id);
         }
-        std::sort(names.begin(), names.end());
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            Solvable* s = pool_id2solvable(pool, id);
-            auto low = std::lower_bound(names.begin(), names.end(), s->name);
-            if (low != names.end() && (*low) == s->name) {
-                MAPSET(m, id);
+        return;
+    }
+
+    if ((cmpType & HY_ICASE) && (cmpType & (HY_SUBSTR | HY_EQ))) {
+        // looked up in the case folded names, m is intersected with result afterwards
+        std::vector<Id> names;
+        for (auto match_union : f.getMatches()) {
+            names.clear();
+            dnf_sack_get_icase_names(sack, match_union.str, cmpType & HY_SUBSTR, names);
+            for (Id name : names) {
+                auto range = dnf_sack_solvables_with_name(sack, name);
+                for (auto id = range.first; id != range.second; ++id)
+                    MAPSET(m, *id);
             }
         }
         return;
     }
-    
+
+    if ((cmpType & HY_GLOB) && !(cmpType & HY_ICASE)) {
+        for (auto match_union : f.getMatches()) {
+            GlobMatcher matcher(match_union.str);
+            const auto & prefix = matcher.getPrefix();
+            if (prefix.empty()) {
+                for (Id id = resultPset->next(-1); id != -1; id = resultPset->next(id)) {
+                    if (matcher.match(pool_id2str(pool, pool_id2solvable(pool, id)->name)))
+                        MAPSET(m, id);
+                }
+                continue;
+            }
+            // each name is matched once, only names starting with the prefix are looked at
+            auto & names = dnf_sack_get_sorted_names(sack);
+            auto it = std::lower_bound(names.begin(), names.end(), prefix,
+                [pool](Id name, const std::string & value) {
+                    return strcmp(pool_id2str(pool, name), value.c_str()) < 0;
+                });
+            for (; it != names.end(); ++it) {
+                const char *name = pool_id2str(pool, *it);
+                if (strncmp(name, prefix.c_str(), prefix.size()) != 0)
+                    break;
+                if (!matcher.match(name))
+                    continue;
+                auto range = dnf_sack_solvables_with_name(sack, *it);
+                for (auto id = range.first; id != range.second; ++id)
+                    MAPSET(m, *id);
+            }
+        }
+        return;
+    }
+
     for (auto match_union : f.getMatches()) {
         const char *match = match_union.str;
         Id id = -1;
@@ -1367,16 +1381,6 @@ Query::Impl::filterName(const Filter & f, Map *m)
             Solvable *s = pool_id2solvable(pool, id);
             if (cmpType & HY_ICASE) {
                 const char *name = pool_id2str(pool, s->name);
-                if (cmpType & HY_SUBSTR) {
-                    if (strcasestr(name, match) != NULL)
-                        MAPSET(m, id);
-                    continue;
-                }
-                if (cmpType & HY_EQ) {
-                    if (strcasecmp(name, match) == 0)
-                        MAPSET(m, id);
-                    continue;
-                }
                 if (cmpType & HY_GLOB) {
                     if (fnmatch(match, name, FNM_CASEFOLD) == 0)
                         MAPSET(m, id);
@@ -1386,11 +1390,6 @@ Query::Impl::filterName(const Filter & f, Map *m)
             }
 
             const char *name = pool_id2str(pool, s->name);
-            if (cmpType & HY_GLOB) {
-                if (fnmatch(match, name, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
             if (cmpType & HY_SUBSTR) {
                 if (strstr(name, match) != NULL)
                     MAPSET(m, id);
@@ -1441,16 +1440,22 @@ Query::Impl::filterEvr(const Filter & f, Map *m)
     for (auto match : f.getMatches()) {
         Id match_evr = pool_str2id(pool, match.str, 1);
 
+        // packages share evrs, compare each of them only once
+        std::unordered_map<Id, bool> matchesByEvr;
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
             if (id == -1)
                 break;
             Solvable *s = pool_id2solvable(pool, id);
-            int cmp = pool_evrcmp(pool, s->evr, match_evr, EVRCMP_COMPARE);
-
-            if ((cmp > 0 && cmp_type & HY_GT) || (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
+            auto known = matchesByEvr.find(s->evr);
+            if (known == matchesByEvr.end()) {
+                int cmp = pool_evrcmp(pool, s->evr, match_evr, EVRCMP_COMPARE);
+                bool matches = (cmp > 0 && cmp_type & HY_GT) || (cmp < 0 && cmp_type & HY_LT) ||
+                               (cmp == 0 && cmp_type & HY_EQ);
+                known = matchesByEvr.emplace(s->evr, matches).first;
+            }
+            if (known->second) {
                 MAPSET(m, id);
             }
         }
@@ -1471,6 +1476,7 @@ Query::Impl::filterNevra(const Filter & f, Map *m)
             continue;
 
         gboolean present_epoch = strchr(nevra_pattern, ':') != NULL;
+        GlobMatcher matcher(nevra_pattern, fn_flags);
 
         Id id = -1;
         while (true) {
@@ -1488,7 +1494,7 @@ Query::Impl::filterNevra(const Filter & f, Map *m)
                     if (strcmp(nevra_pattern, nevra) == 0)
                         MAPSET(m, id);
                 }
-            } else if (fnmatch(nevra_pattern, nevra, fn_flags) == 0) {
+            } else if (matcher.match(nevra)) {
                 MAPSET(m, id);
             }
         }
@@ -1504,8 +1510,15 @@ Query::Impl::filterVersion(const Filter & f, Map *m)
 
     for (auto match_in : f.getMatches()) {
         const char *match = match_in.str;
+        const char *match_end = match + strlen(match);
         char *filter_vr = solv_dupjoin(match, "-0", NULL);
+        GlobMatcher matcher(match);
+        // comparing "version-0" strings is comparing the versions unless ':' or '-' interfere
+        bool plain_match = !strpbrk(match, ":-");
 
+        // own buffers instead of the pool temp space, see dnf_sack_freeze()
+        std::string evrBuf;
+        std::string vr;
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
@@ -1515,18 +1528,26 @@ Query::Impl::filterVersion(const Filter & f, Map *m)
             Solvable *s = pool_id2solvable(pool, id);
             if (s->evr == ID_EMPTY)
                 continue;
-            const char *evr = pool_id2str(pool, s->evr);
-
-            pool_split_evr(pool, evr, &e, &v, &r);
+            auto split = dnf_sack_get_split_evr(sack, s->evr);
+            if (split) {
+                v = const_cast<char *>(split->version.c_str());
+            } else {
+                split_evr(pool_id2str(pool, s->evr), evrBuf, &e, &v, &r);
+            }
 
             if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, v, 0) == 0)
+                if (matcher.match(v))
                     MAPSET(m, id);
                 continue;
             }
 
-            char *vr = pool_tmpjoin(pool, v, "-0", NULL);
-            int cmp = pool_evrcmp_str(pool, vr, filter_vr, EVRCMP_COMPARE);
+            int cmp;
+            if (split && plain_match && split->plainVersion) {
+                cmp = solv_vercmp(v, v + split->version.size(), match, match_end);
+            } else {
+                vr.assign(v).append("-0");
+                cmp = pool_evrcmp_str(pool, vr.c_str(), filter_vr, EVRCMP_COMPARE);
+            }
             if ((cmp > 0 && cmp_type & HY_GT) ||
                 (cmp < 0 && cmp_type & HY_LT) ||
                 (cmp == 0 && cmp_type & HY_EQ)) {
@@ -1546,8 +1567,15 @@ Query::Impl::filterRelease(const Filter & f, Map *m)
 
     for (auto match_in : f.getMatches()) {
         const char *match = match_in.str;
+        const char *match_end = match + strlen(match);
         char *filter_vr = solv_dupjoin("0-", match, NULL);
+        GlobMatcher matcher(match);
+        // comparing "0-release" strings is comparing the releases unless '-' interferes
+        bool plain_match = !strchr(match, '-');
 
+        // own buffers instead of the pool temp space, see dnf_sack_freeze()
+        std::string evrBuf;
+        std::string vr;
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
@@ -1557,19 +1585,27 @@ Query::Impl::filterRelease(const Filter & f, Map *m)
             Solvable *s = pool_id2solvable(pool, id);
             if (s->evr == ID_EMPTY)
                 continue;
-            const char *evr = pool_id2str(pool, s->evr);
-
-            pool_split_evr(pool, evr, &e, &v, &r);
+            auto split = dnf_sack_get_split_evr(sack, s->evr);
+            if (split) {
+                r = split->hasRelease ? const_cast<char *>(split->release.c_str()) : NULL;
+            } else {
+                split_evr(pool_id2str(pool, s->evr), evrBuf, &e, &v, &r);
+            }
 
             if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, r, 0) == 0)
+                if (matcher.match(r))
                     MAPSET(m, id);
                 continue;
             }
 
-            char *vr = pool_tmpjoin(pool, "0-", r, NULL);
-
-            int cmp = pool_evrcmp_str(pool, vr, filter_vr, EVRCMP_COMPARE);
+            int cmp;
+            if (split && plain_match && split->plainRelease) {
+                cmp = solv_vercmp(split->release.c_str(),
+                                  split->release.c_str() + split->release.size(), match, match_end);
+            } else {
+                vr.assign("0-").append(r ? r : "");
+                cmp = pool_evrcmp_str(pool, vr.c_str(), filter_vr, EVRCMP_COMPARE);
+            }
 
             if ((cmp > 0 && cmp_type & HY_GT) ||
                 (cmp < 0 && cmp_type & HY_LT) ||
@@ -1595,22 +1631,22 @@ Query::Impl::filterArch(const Filter & f, Map *m)
             match_arch_id = pool_str2id(pool, match, 0);
             if (match_arch_id == 0)
                 continue;
+            auto range = dnf_sack_solvables_with_arch(sack, match_arch_id);
+            for (auto id = range.first; id != range.second; ++id)
+                MAPSET(m, *id);
+            continue;
         }
 
+        GlobMatcher matcher(match);
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
             if (id == -1)
                 break;
             Solvable *s = pool_id2solvable(pool, id);
-            if (cmp_type & HY_EQ) {
-                if (match_arch_id == s->arch)
-                    MAPSET(m, id);
-                continue;
-            }
             const char *arch = pool_id2str(pool, s->arch);
             if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, arch, 0) == 0)
+                if (matcher.match(arch))
                     MAPSET(m, id);
                 continue;
             }
@@ -1621,30 +1657,15 @@ Query::Impl::filterArch(const Filter & f, Map *m)
 void
 Query::Impl::filterSourcerpm(const Filter & f, Map *m)
 {
-    Pool *pool = dnf_sack_get_pool(sack);
     auto resultPset = result.get();
 
     for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
-
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            Solvable *s = pool_id2solvable(pool, id);
-
-            const char *name = solvable_lookup_str(s, SOLVABLE_SOURCENAME);
-            if (name == NULL)
-                name = pool_id2str(pool, s->name);
-            if (!g_str_has_prefix(match, name)) // early check
-                continue;
-
-            DnfPackage *pkg = dnf_package_new(sack, id);
-            const char *srcrpm = dnf_package_get_sourcerpm(pkg);
-            if (srcrpm && !strcmp(match, srcrpm))
+        auto ids = dnf_sack_solvables_with_sourcerpm(sack, match_in.str);
+        if (!ids)
+            continue;
+        for (Id id : *ids) {
+            if (resultPset->has(id))
                 MAPSET(m, id);
-            g_object_unref(pkg);
         }
     }
 }
@@ -1661,14 +1682,11 @@ Query::Impl::filterObsoletes(const Filter & f, Map *m)
     assert(f.getMatches().size() == 1);
     target = dnf_packageset_get_map(f.getMatches()[0].pset);
     dnf_sack_make_provides_ready(sack);
-    Id id = -1;
-    while (true) {
-        id = resultPset->next(id);
-        if (id == -1)
-            break;
+
+    auto visit = [&](Id id) {
         Solvable *s = pool_id2solvable(pool, id);
         if (!s->repo)
-            continue;
+            return;
         for (Id *r_id = s->repo->idarraydata + s->obsoletes; *r_id; ++r_id) {
             Id r, rr;
 
@@ -1683,6 +1701,20 @@ Query::Impl::filterObsoletes(const Filter & f, Map *m)
                 break;
             }
         }
+    };
+
+    // only few packages obsolete anything, walk them unless the result is even smaller
+    auto & obsoleters = dnf_sack_solvables_with_obsoletes(sack);
+    if (obsoleters.size() < resultPset->size()) {
+        auto resultMap = resultPset->getMap();
+        for (Id id : obsoleters) {
+            if (MAPTST(resultMap, id))
+                visit(id);
+        }
+    } else {
+        Id id = -1;
+        while ((id = resultPset->next(id)) != -1)
+            visit(id);
     }
 }
 
@@ -1718,30 +1750,40 @@ Query::Impl::filterObsoletesByPriority(const Filter & f, Map *m)
     assert(f.getMatches().size() == 1);
     target = dnf_packageset_get_map(f.getMatches()[0].pset);
     dnf_sack_make_provides_ready(sack);
-    std::vector<Solvable *> obsoleteCandidates;
-    obsoleteCandidates.reserve(resultPset->size());
+
+    // installed candidates and those from the best priority repo of their name are considered
+    std::unordered_map<Id, int> namePriorities;
     Id id = -1;
     while ((id = resultPset->next(id)) != -1) {
         Solvable *candidate = pool_id2solvable(pool, id);
-        obsoleteCandidates.push_back(candidate);
+        auto inserted = namePriorities.emplace(candidate->name, candidate->repo->priority);
+        if (!inserted.second && inserted.first->second < candidate->repo->priority)
+            inserted.first->second = candidate->repo->priority;
     }
-    if (obsoleteCandidates.empty()) {
+    if (namePriorities.empty()) {
         return;
     }
-    std::sort(obsoleteCandidates.begin(), obsoleteCandidates.end(), NamePrioritySolvableKey);
-    Id name = 0;
-    int priority = 0;
-    for (auto * candidate: obsoleteCandidates) {
-        if (candidate->repo == pool->installed) {
+
+    auto visit = [&](Id candidateId) {
+        Solvable *candidate = pool_id2solvable(pool, candidateId);
+        if (candidate->repo == pool->installed ||
+            namePriorities[candidate->name] == candidate->repo->priority) {
             obsoletesByPriority(pool, candidate, m, target, obsprovides);
         }
-        if (name != candidate->name) {
-            name = candidate->name;
-            priority = candidate->repo->priority;
-            obsoletesByPriority(pool, candidate, m, target, obsprovides);
-        } else if (priority == candidate->repo->priority) {
-            obsoletesByPriority(pool, candidate, m, target, obsprovides);
+    };
+
+    // candidates without obsoletes cannot match, walk only those with some when it is cheaper
+    auto & obsoleters = dnf_sack_solvables_with_obsoletes(sack);
+    if (obsoleters.size() < resultPset->size()) {
+        auto resultMap = resultPset->getMap();
+        for (Id obsoleter : obsoleters) {
+            if (MAPTST(resultMap, obsoleter))
+                visit(obsoleter);
         }
+    } else {
+        id = -1;
+        while ((id = resultPset->next(id)) != -1)
+            visit(id);
     }
 }
 
@@ -1751,6 +1793,8 @@ Query::Impl::filterProvidesReldep(const Filter & f, Map *m)
     Pool *pool = dnf_sack_get_pool(sack);
     Id p, pp;
 
+    for (auto match_in : f.getMatches())
+        dnf_sack_load_lazy_filelists(sack, match_in.reldep);
     dnf_sack_make_provides_ready(sack);
     for (auto match_in : f.getMatches()) {
         Id r_id = match_in.reldep;
@@ -1763,57 +1807,34 @@ void
 Query::Impl::filterReponame(const Filter & f, Map *m)
 {
     Pool *pool = dnf_sack_get_pool(sack);
-    Solvable *s;
     LibsolvRepo *r;
     Id id;
-    bool ourids[pool->nrepos];
-    auto resultPset = result.get();
 
-    for (id = 0; id < pool->nrepos; ++id)
-        ourids[id] = false;
+    int comparison = f.getCmpType() & ~HY_COMPARISON_FLAG_MASK;
+    if (comparison != HY_EQ)
+        assert(0);
+    // m is only intersected with or subtracted from the result, whole repos can go into it
     FOR_REPOS(id, r) {
         for (auto match_in : f.getMatches()) {
             if (!strcmp(r->name, match_in.str)) {
-                ourids[id] = true;
+                map_or(m, dnf_sack_get_repo_solvables(sack, id));
                 break;
             }
         }
     }
-
-    id = -1;
-    int comparison = f.getCmpType() & ~HY_COMPARISON_FLAG_MASK;
-    if (comparison != HY_EQ)
-        assert(0);
-    while (true) {
-        id = resultPset->next(id);
-        if (id == -1)
-            break;
-        s = pool_id2solvable(pool, id);
-        if (s->repo && ourids[s->repo->repoid])
-            MAPSET(m, id);
-    }
 }
 
 void
 Query::Impl::filterLocation(const Filter & f, Map *m)
 {
-    Pool *pool = dnf_sack_get_pool(sack);
     auto resultPset = result.get();
 
     for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
-
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            Solvable *s = pool_id2solvable(pool, id);
-
-            const char *location = solvable_get_location(s, NULL);
-            if (location == NULL)
-                continue;
-            if (!strcmp(match, location))
+        auto ids = dnf_sack_solvables_with_location(sack, match_in.str);
+        if (!ids)
+            continue;
+        for (Id id : *ids) {
+            if (resultPset->has(id))
                 MAPSET(m, id);
         }
     }
@@ -1836,46 +1857,42 @@ Query::Impl::filterAdvisory(const Filter & f, Map *m, int keyname)
     Pool *pool = dnf_sack_get_pool(sack);
     std::vector<AdvisoryPkg> pkgs;
     std::vector<AdvisoryPkg> pkgsSecondRun;
-    Dataiterator di;
-    bool eq;
     auto resultPset = result.get();
 
-    // iterate over advisories
-    dataiterator_init(&di, pool, 0, 0, 0, 0, 0);
-    dataiterator_prepend_keyname(&di, UPDATE_COLLECTION);
-    while (dataiterator_step(&di)) {
-        dataiterator_setpos_parent(&di);
-        Advisory advisory(sack, di.solvid);
+    AdvisoryIndex::Key key;
+    switch(keyname) {
+        case HY_PKG_ADVISORY:
+            key = AdvisoryIndex::Key::NAME;
+            break;
+        case HY_PKG_ADVISORY_BUG:
+            key = AdvisoryIndex::Key::BUG;
+            break;
+        case HY_PKG_ADVISORY_CVE:
+            key = AdvisoryIndex::Key::CVE;
+            break;
+        case HY_PKG_ADVISORY_TYPE:
+            key = AdvisoryIndex::Key::TYPE;
+            break;
+        case HY_PKG_ADVISORY_SEVERITY:
+            key = AdvisoryIndex::Key::SEVERITY;
+            break;
+        default:
+            return;
+    }
 
-        for (auto match_in : f.getMatches()) {
-            const char *match = match_in.str;
-            switch(keyname) {
-                case HY_PKG_ADVISORY:
-                    eq = advisory.matchName(match);
-                    break;
-                case HY_PKG_ADVISORY_BUG:
-                    eq = advisory.matchBug(match);
-                    break;
-                case HY_PKG_ADVISORY_CVE:
-                    eq = advisory.matchCVE(match);
-                    break;
-                case HY_PKG_ADVISORY_TYPE:
-                    eq = advisory.matchKind(match);
-                    break;
-                case HY_PKG_ADVISORY_SEVERITY:
-                    eq = advisory.matchSeverity(match);
-                    break;
-                default:
-                    eq = false;
-            }
-            if (eq) {
-                advisory.getApplicablePackages(pkgs, false);
-                break;
-            }
+    // look the matching advisories up in the index, each of them is used once
+    auto & advisoryIndex = dnf_sack_get_advisory_index(sack);
+    std::vector<std::size_t> matched;
+    for (auto match_in : f.getMatches()) {
+        if (auto positions = advisoryIndex.lookup(key, match_in.str)) {
+            matched.insert(matched.end(), positions->begin(), positions->end());
         }
-        dataiterator_skip_solvable(&di);
     }
-    dataiterator_free(&di);
+    std::sort(matched.begin(), matched.end());
+    matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+    for (auto position : matched) {
+        advisoryIndex.getApplicablePackages(sack, position, pkgs);
+    }
     std::sort(pkgs.begin(), pkgs.end(), advisoryPkgSort);
 
     int cmp_type = f.getCmpType();
@@ -2030,31 +2047,13 @@ Query::Impl::filterLatest(const Filter & f, Map *m)
     Pool *pool = dnf_sack_get_pool(sack);
     auto resultPset = result.get();
 
+    IdQueue samename;
+    latestOrdered(sack, keyname, *resultPset, samename);
+
     for (auto match_in : f.getMatches()) {
         int latest = match_in.num;
         if (latest == 0)
             continue;
-        Queue samename;
-
-        queue_init(&samename);
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            queue_push(&samename, id);
-        }
-
-        if (keyname == HY_PKG_LATEST_PER_ARCH) {
-            solv_sort(samename.elements, samename.count, sizeof(Id),
-                      filter_latest_sortcmp_byarch, pool);
-        } else if (keyname == HY_PKG_LATEST_PER_ARCH_BY_PRIORITY) {
-            solv_sort(samename.elements, samename.count, sizeof(Id),
-                      filter_latest_sortcmp_byarch_bypriority, pool);
-        } else {
-            solv_sort(samename.elements, samename.count, sizeof(Id),
-                      filter_latest_sortcmp, pool);
-        }
 
         // Create blocks per name, arch and repo priority
         // But call add_latest_to_map only for the block with highest priority
@@ -2062,8 +2061,8 @@ Query::Impl::filterLatest(const Filter & f, Map *m)
         bool make_block = 1;
         int start_block = -1;
         int i;
-        for (i = 0; i < samename.count; ++i) {
-            Id p = samename.elements[i];
+        for (i = 0; i < samename.size(); ++i) {
+            Id p = samename[i];
             considered = pool->solvables + p;
             if (!highest ||
                 highest->name != considered->name ||
@@ -2076,7 +2075,7 @@ Query::Impl::filterLatest(const Filter & f, Map *m)
                     continue;
                 }
                 if (make_block) {
-                    add_latest_to_map(pool, m, &samename, start_block, i, latest);
+                    add_latest_to_map(pool, m, samename, start_block, i, latest);
                 }
                 else {
                     make_block = 1;
@@ -2086,14 +2085,13 @@ Query::Impl::filterLatest(const Filter & f, Map *m)
             } else if (keyname == HY_PKG_LATEST_PER_ARCH_BY_PRIORITY &&
                 highest->repo->priority != considered->repo->priority &&
                 make_block) {
-                add_latest_to_map(pool, m, &samename, start_block, i, latest);
+                add_latest_to_map(pool, m, samename, start_block, i, latest);
                 make_block = 0;
             }
         }
         if (start_block != -1 && make_block) { // Add last block to the map
-            add_latest_to_map(pool, m, &samename, start_block, i, latest);
+            add_latest_to_map(pool, m, samename, start_block, i, latest);
         }
-        queue_free(&samename);
     }
 }
 
@@ -2122,9 +2120,9 @@ Query::Impl::filterUpdown(const Filter & f, Map *m)
             if (s->repo == pool->installed)
                 continue;
             if (f.getKeyname() == HY_PKG_DOWNGRADES) {
-                if (what_downgrades(pool, id) > 0)
+                if (dnf_sack_what_downgrades(sack, id) > 0)
                     MAPSET(m, id);
-            } else if (what_upgrades(pool, id) > 0)
+            } else if (dnf_sack_what_upgrades(sack, id) > 0)
                 MAPSET(m, id);
         }
     }
@@ -2165,12 +2163,12 @@ Query::Impl::filterUpdownByPriority(const Filter & f, Map *m)
                 name = candidate->name;
                 priority = candidate->repo->priority;
                 id = pool_solvable2id(pool, candidate);
-                if (what_upgrades(pool, id) > 0) {
+                if (dnf_sack_what_upgrades(sack, id) > 0) {
                     MAPSET(m, id);
                 }
             } else if (priority == candidate->repo->priority) {
                 id = pool_solvable2id(pool, candidate);
-                if (what_upgrades(pool, id) > 0) {
+                if (dnf_sack_what_upgrades(sack, id) > 0) {
                     MAPSET(m, id);
                 }
             }
@@ -2208,14 +2206,18 @@ Query::Impl::filterUpdownAble(const Filter  &f, Map *m)
             if (s->repo == pool->installed)
                 continue;
 
-            what = (f.getKeyname() == HY_PKG_DOWNGRADABLE) ? what_downgrades(pool, p) :
-                what_upgrades(pool, p);
+            what = (f.getKeyname() == HY_PKG_DOWNGRADABLE) ? dnf_sack_what_downgrades(sack, p) :
+                dnf_sack_what_upgrades(sack, p);
             if (what != 0 && map_tst(resultMap, what))
                 map_set(m, what);
         }
     }
 }
 
+// filterDataiterator() iterates the whole pool once the result has 1/DATAITERATOR_POOL_RATIO of
+// the solvables, the iterator setup per solvable then costs more than visiting the others
+static constexpr size_t DATAITERATOR_POOL_RATIO = 8;
+
 void
 Query::Impl::filterDataiterator(const Filter & f, Map *m)
 {
@@ -2226,9 +2228,40 @@ Query::Impl::filterDataiterator(const Filter & f, Map *m)
     auto resultPset = result.get();
 
     assert(f.getMatchType() == _HY_STR);
+    if (f.getKeyname() == HY_PKG_FILE)
+        dnf_sack_reload_unloaded_exts(sack, nullptr, DNF_SACK_LOAD_FLAG_USE_FILELISTS);
+
+    const SubstringIndex *index = nullptr;
+    if ((f.getCmpType() & ~HY_COMPARISON_FLAG_MASK) == HY_SUBSTR)
+        index = dnf_sack_get_substring_index(sack, keyname);
+    bool icase = f.getCmpType() & HY_ICASE;
+    std::vector<Id> candidates;
 
     for (auto match_in : f.getMatches()) {
         const char *match = match_in.str;
+        // the same strstr() and strcasestr() SEARCH_SUBSTRING does, on the candidates only
+        if (index && index->lookup(match, candidates)) {
+            for (Id id : candidates) {
+                if (!resultPset->has(id))
+                    continue;
+                const char *str = solvable_lookup_str(pool_id2solvable(pool, id), keyname);
+                if (str && (icase ? strcasestr(str, match) : strstr(str, match)))
+                    MAPSET(m, id);
+            }
+            continue;
+        }
+        // one iterator over the whole pool instead of setting one up for each solvable, unless
+        // only a small part of the pool is queried
+        if (resultPset->size() * DATAITERATOR_POOL_RATIO >= static_cast<size_t>(pool->nsolvables)) {
+            dataiterator_init(&di, pool, 0, 0, keyname, match, flags);
+            while (dataiterator_step(&di)) {
+                if (resultPset->has(di.solvid))
+                    MAPSET(m, di.solvid);
+                dataiterator_skip_solvable(&di);
+            }
+            dataiterator_free(&di);
+            continue;
+        }
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
@@ -2248,8 +2281,6 @@ int
 Query::Impl::filterUnneededOrSafeToRemove(const Swdb &swdb, bool debug_solver, bool safeToRemove)
 {
     apply();
-    Goal goal(sack);
-    Pool *pool = dnf_sack_get_pool(sack);
     Query installed(sack);
     installed.installed();
     auto userInstalled = installed.getResultPset();
@@ -2258,6 +2289,16 @@ Query::Impl::filterUnneededOrSafeToRemove(const Swdb &swdb, bool debug_solver, b
     if (safeToRemove) {
         *userInstalled -= *result;
     }
+    // the solve only depends on the sack and the user installed packages
+    if (!debug_solver) {
+        auto cached = dnf_sack_unneeded_cache_lookup(sack, *userInstalled);
+        if (cached) {
+            *mutableResult() /= *cached;
+            return 0;
+        }
+    }
+
+    Goal goal(sack);
     goal.userInstalled(*userInstalled);
 
     int ret1 = goal.run(DNF_NONE);
@@ -2276,14 +2317,13 @@ Query::Impl::filterUnneededOrSafeToRemove(const Swdb &swdb, bool debug_solver, b
     Solver *solv = goal.pImpl->solv;
 
     solver_get_unneeded(solv, que.getQueue(), 0);
-    Map resultInternal;
-    map_init(&resultInternal, pool->nsolvables);
+    PackageSet unneeded(sack);
 
     for (int i = 0; i < que.size(); ++i) {
-        MAPSET(&resultInternal, que[i]);
+        unneeded.set(que[i]);
     }
-    map_and(result->getMap(), &resultInternal);
-    map_free(&resultInternal);
+    dnf_sack_unneeded_cache_store(sack, *userInstalled, unneeded);
+    *mutableResult() /= unneeded;
     return 0;
 }
 
@@ -2301,6 +2341,167 @@ bool Query::Impl::isGlob(const std::vector<const char *> &matches) const
 void
 Query::apply() { pImpl->apply(); }
 
+/**
+* @brief Returns true if the packages matched by the filter are not decided per package, but depend
+* on the other packages in the query result (latest, upgrades, ...). The order of such filters
+* relative to the others matters.
+*/
+static bool
+filterDependsOnResult(const Filter & f)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG_ADVISORY:
+        case HY_PKG_ADVISORY_BUG:
+        case HY_PKG_ADVISORY_CVE:
+        case HY_PKG_ADVISORY_SEVERITY:
+        case HY_PKG_ADVISORY_TYPE:
+        case HY_PKG_LATEST:
+        case HY_PKG_LATEST_PER_ARCH:
+        case HY_PKG_LATEST_PER_ARCH_BY_PRIORITY:
+        case HY_PKG_DOWNGRADABLE:
+        case HY_PKG_UPGRADABLE:
+        case HY_PKG_DOWNGRADES:
+        case HY_PKG_UPGRADES:
+        case HY_PKG_UPGRADES_BY_PRIORITY:
+        case HY_PKG_OBSOLETES_BY_PRIORITY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+* @brief Rough cost of applying the filter, filters looked up in the sack indexes are the cheapest,
+* filters that walk the repodata of every package in the result the most expensive.
+*/
+static int
+filterCost(const Filter & f)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG_ALL:
+        case HY_PKG_EMPTY:
+            return 0;
+        case HY_PKG:
+        case HY_PKG_PROVIDES:
+            return 1;
+        case HY_PKG_NAME:
+        case HY_PKG_ARCH:
+            if ((f.getCmpType() & HY_EQ) && !(f.getCmpType() & (HY_ICASE | HY_GLOB | HY_SUBSTR)))
+                return 1;
+            return 2;
+        case HY_PKG_EPOCH:
+        case HY_PKG_EVR:
+        case HY_PKG_NEVRA:
+        case HY_PKG_VERSION:
+        case HY_PKG_RELEASE:
+        case HY_PKG_REPONAME:
+            return 2;
+        case HY_PKG_SOURCERPM:
+        case HY_PKG_LOCATION:
+        case HY_PKG_OBSOLETES:
+        case HY_PKG_CONFLICTS:
+        case HY_PKG_ENHANCES:
+        case HY_PKG_RECOMMENDS:
+        case HY_PKG_REQUIRES:
+        case HY_PKG_SUGGESTS:
+        case HY_PKG_SUPPLEMENTS:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+/**
+* @brief Reorders the filters so that within every run of filters not depending on the query
+* result the cheap ones go first and shrink the result for the expensive ones. The intersection
+* (or difference in case of HY_NOT) of such filters does not depend on their order.
+*/
+static void
+planFilters(std::vector<Filter> & filters)
+{
+    auto begin = filters.begin();
+    while (begin != filters.end()) {
+        auto end = std::find_if(begin, filters.end(), filterDependsOnResult);
+        std::stable_sort(begin, end, [](const Filter & a, const Filter & b) {
+            return filterCost(a) < filterCost(b);
+        });
+        if (end == filters.end())
+            break;
+        begin = end + 1;
+    }
+}
+
+/**
+* @brief Returns a key which is equal for two fresh queries iff they have the same exclude flags
+* and filters. Used for looking up query results cached in the sack.
+*/
+static std::string
+queryCacheKey(Query::ExcludeFlags flags, const std::vector<Filter> & filters)
+{
+    std::string key;
+    auto append = [&key](const void * data, size_t size) {
+        key.append(static_cast<const char *>(data), size);
+    };
+    auto flagsValue = static_cast<int>(flags);
+    append(&flagsValue, sizeof(flagsValue));
+    for (const auto & f : filters) {
+        int header[] = {f.getKeyname(), f.getCmpType(), f.getMatchType(),
+                        static_cast<int>(f.getMatches().size())};
+        append(header, sizeof(header));
+        for (const auto & match : f.getMatches()) {
+            switch (f.getMatchType()) {
+                case _HY_NUM:
+                    append(&match.num, sizeof(match.num));
+                    break;
+                case _HY_RELDEP:
+                    append(&match.reldep, sizeof(match.reldep));
+                    break;
+                case _HY_STR:
+                    key.append(match.str, strlen(match.str) + 1);
+                    break;
+                case _HY_PKG: {
+                    auto map = match.pset->getMap();
+                    append(&map->size, sizeof(map->size));
+                    append(map->map, map->size);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+    return key;
+}
+
+static FilterStats
+filterStats(const Filter & f)
+{
+    return {f.getKeyname(), f.getCmpType(), f.getMatchType(), f.getMatches().size(), false, 0, 0, 0};
+}
+
+std::vector<FilterStats>
+Query::explain() const
+{
+    auto filters = pImpl->filters;
+    planFilters(filters);
+    std::vector<FilterStats> pipeline;
+    for (const auto & f : filters)
+        pipeline.push_back(filterStats(f));
+    return pipeline;
+}
+
+void
+Query::setAnalyze(bool analyze) noexcept
+{
+    pImpl->analyze = analyze;
+}
+
+const std::vector<FilterStats> &
+Query::getAnalysis() const noexcept
+{
+    return pImpl->analysis;
+}
+
 void
 Query::Impl::apply()
 {
@@ -2309,12 +2510,41 @@ Query::Impl::apply()
 
     Pool *pool = dnf_sack_get_pool(sack);
     repo_internalize_all_trigger(pool);
+    if (analyze)
+        analysis.clear();
+    LIBDNF_PROBE(query_apply_start, static_cast<int>(filters.size()));
+    std::string cacheKey;
+    if (!result && dnf_sack_get_use_query_cache(sack)) {
+        cacheKey = queryCacheKey(flags, filters);
+        if (auto cached = dnf_sack_query_cache_lookup(sack, cacheKey)) {
+            result.reset(new PackageSet(*cached));
+            applied = true;
+            filters.clear();
+            LIBDNF_PROBE(query_apply_end, 1);
+            return;
+        }
+    }
     Map m;
     if (!result)
         initResult();
     map_init(&m, pool->nsolvables);
     assert(m.size == result->getMap()->size);
+    planFilters(filters);
+    if (analyze) {
+        for (const auto & f : filters)
+            analysis.push_back(filterStats(f));
+    }
+    auto stats = analysis.begin();
     for (auto f : filters) {
+        // no filter can add packages back
+        if (result->empty())
+            break;
+        std::chrono::steady_clock::time_point start;
+        if (analyze) {
+            stats->inputSize = result->size();
+            start = std::chrono::steady_clock::now();
+        }
+        LIBDNF_PROBE(query_filter_start, f.getKeyname(), f.getCmpType());
         map_empty(&m);
         switch (f.getKeyname()) {
             case HY_PKG:
@@ -2408,14 +2638,25 @@ Query::Impl::apply()
                 filterDataiterator(f, &m);
         }
         if (f.getCmpType() & HY_NOT)
-            map_subtract(result->getMap(), &m);
+            *mutableResult() -= &m;
         else
-            map_and(result->getMap(), &m);
+            *mutableResult() /= &m;
+        LIBDNF_PROBE(query_filter_end, f.getKeyname(), f.getCmpType());
+        if (analyze) {
+            stats->executed = true;
+            stats->outputSize = result->size();
+            stats->elapsed =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ++stats;
+        }
     }
     map_free(&m);
+    if (!cacheKey.empty())
+        dnf_sack_query_cache_store(sack, cacheKey, *result);
 
     applied = true;
     filters.clear();
+    LIBDNF_PROBE(query_apply_end, 0);
 }
 
 GPtrArray *
@@ -2444,7 +2685,7 @@ Query::queryUnion(Query & other)
 {
     apply();
     other.apply();
-    *(pImpl->result.get()) += *(other.pImpl->result.get());
+    *pImpl->mutableResult() += *other.pImpl->result;
 }
 
 void
@@ -2452,7 +2693,7 @@ Query::queryIntersection(Query & other)
 {
     apply();
     other.apply();
-    *(pImpl->result.get()) /= *(other.pImpl->result.get());
+    *pImpl->mutableResult() /= *other.pImpl->result;
 }
 
 void
@@ -2460,7 +2701,7 @@ Query::queryDifference(Query & other)
 {
     apply();
     other.apply();
-    *(pImpl->result.get()) -= *(other.pImpl->result.get());
+    *pImpl->mutableResult() -= *other.pImpl->result;
 }
 
 bool
@@ -2477,9 +2718,10 @@ Query::filterExtras()
 
     Pool * pool = dnf_sack_get_pool(pImpl->sack);
 
-    auto resultMap = pImpl->result->getMap();
     Query query_installed(*this);
     query_installed.installed();
+    // the copy above shares the result, it must not see the changes below
+    auto resultMap = pImpl->mutableResult()->getMap();
     MAPZERO(resultMap);
     if (query_installed.size() == 0) {
         return;
@@ -2490,25 +2732,18 @@ Query::filterExtras()
     Query query_available(pImpl->sack, Query::ExcludeFlags::IGNORE_REGULAR_EXCLUDES);
     query_available.available();
 
+    // the name index of the sack groups the candidates, no sorting needed
     auto resultAvailable = query_available.pImpl->result.get();
-    Id id_available = -1;
-
-    // make vector of available solvables
-    std::vector<Solvable *> namesArch;
-    namesArch.reserve(resultAvailable->size());
-    while ((id_available = resultAvailable->next(id_available)) != -1) {
-        namesArch.push_back(pool_id2solvable(pool, id_available));
-    }
-    std::sort(namesArch.begin(), namesArch.end(), NameArchSolvableComparator);
-    Id id_installed = -1;
     auto resultInstalled = query_installed.pImpl->result.get();
-
+    Id id_installed = -1;
     while ((id_installed = resultInstalled->next(id_installed)) != -1) {
         Solvable * s_installed = pool_id2solvable(pool, id_installed);
-        auto low = std::lower_bound(namesArch.begin(), namesArch.end(), s_installed,
-                                    NameArchSolvableComparator);
-        if (low == namesArch.end() || (*low)->name != s_installed->name ||
-            (*low)->arch != s_installed->arch) {
+        auto range = dnf_sack_solvables_with_name(pImpl->sack, s_installed->name);
+        auto match = std::find_if(range.first, range.second, [&](Id id_available) {
+            return pool_id2solvable(pool, id_available)->arch == s_installed->arch &&
+                resultAvailable->has(id_available);
+        });
+        if (match == range.second) {
             MAPSET(resultMap, id_installed);
         }
     }
@@ -2518,57 +2753,168 @@ void
 Query::filterRecent(const long unsigned int recent_limit)
 {
     apply();
-    auto resultPset = pImpl->result.get();
-    auto resultMap = pImpl->result->getMap();
+    auto resultPset = pImpl->mutableResult();
+    auto resultMap = resultPset->getMap();
+    const unsigned long long * buildtimes =
+        dnf_sack_get_num_column(pImpl->sack, PackageAttr::BUILDTIME).data();
 
     Id id = -1;
-    while (true) {
-        id = resultPset->next(id);
-        if (id == -1)
-                break;
-        DnfPackage *pkg = dnf_package_new(pImpl->sack, id);
-        guint64 build_time = dnf_package_get_buildtime(pkg);
-        g_object_unref(pkg);
-        if (build_time <= recent_limit) {
+    while ((id = resultPset->next(id)) != -1) {
+        if (buildtimes[id] <= recent_limit)
+            MAPCLR(resultMap, id);
+    }
+}
+
+void
+Query::filterNumRange(PackageAttr attr, unsigned long long min, unsigned long long max)
+{
+    apply();
+    auto resultPset = pImpl->mutableResult();
+    auto resultMap = resultPset->getMap();
+    const unsigned long long * values = dnf_sack_get_num_column(pImpl->sack, attr).data();
+
+    Id id = -1;
+    while ((id = resultPset->next(id)) != -1) {
+        if (values[id] < min || values[id] > max)
             MAPCLR(resultMap, id);
+    }
+}
+
+int
+Query::addDependencyClosure(int keyname, bool reverse, int depth, const PackageSet * universe)
+{
+    switch (keyname) {
+        case HY_PKG_CONFLICTS:
+        case HY_PKG_ENHANCES:
+        case HY_PKG_OBSOLETES:
+        case HY_PKG_REQUIRES:
+        case HY_PKG_RECOMMENDS:
+        case HY_PKG_SUGGESTS:
+        case HY_PKG_SUPPLEMENTS:
+            break;
+        default:
+            return DNF_ERROR_BAD_QUERY;
+    }
+    apply();
+    DnfSack *sack = pImpl->sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    Id depKey = reldep_keyname2id(keyname);
+    std::unique_ptr<Query> universeQuery;
+    if (!universe) {
+        universeQuery.reset(new Query(sack, pImpl->flags));
+        universe = universeQuery->runSet();
+    }
+    dnf_sack_make_provides_ready(sack);
+
+    auto resultPset = pImpl->mutableResult();
+    Map *closure = resultPset->getMap();
+    std::vector<Id> frontier;
+    Id id = -1;
+    while ((id = resultPset->next(id)) != -1)
+        frontier.push_back(id);
+
+    std::vector<Id> next;
+    std::vector<Id> names;
+    Map targets;
+    map_init(&targets, reverse ? pool->nsolvables : 0);
+    Queue deps;
+    queue_init(&deps);
+    for (int level = 0; !frontier.empty() && (depth < 0 || level < depth); ++level) {
+        next.clear();
+        if (!reverse) {
+            for (Id pkg : frontier) {
+                queue_empty(&deps);
+                solvable_lookup_idarray(pool_id2solvable(pool, pkg), depKey, &deps);
+                for (int i = 0; i < deps.count; ++i) {
+                    Id dep = deps.elements[i];
+                    if (dep == SOLVABLE_PREREQMARKER || dep == SOLVABLE_FILEMARKER)
+                        continue;
+                    Id p, pp;
+                    FOR_PROVIDES(p, pp, dep) {
+                        if (!MAPTST(closure, p) && universe->has(p)) {
+                            MAPSET(closure, p);
+                            next.push_back(p);
+                        }
+                    }
+                }
+            }
+        } else {
+            // same as filterDepSolvable(), only deps named like a provide of the level or rich
+            // deps can be provided by it
+            map_empty(&targets);
+            names.assign(1, 0);
+            for (Id pkg : frontier) {
+                MAPSET(&targets, pkg);
+                queue_empty(&deps);
+                solvable_lookup_idarray(pool_id2solvable(pool, pkg), SOLVABLE_PROVIDES, &deps);
+                for (int i = 0; i < deps.count; ++i) {
+                    Id name = deps.elements[i];
+                    while (ISRELDEP(name))
+                        name = GETRELDEP(pool, name)->name;
+                    names.push_back(name);
+                }
+            }
+            std::sort(names.begin(), names.end());
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+            for (Id name : names) {
+                auto range = dnf_sack_solvables_with_dep_name(sack, depKey, name);
+                for (auto candidate = range.first; candidate != range.second; ++candidate) {
+                    if (MAPTST(closure, *candidate) || !universe->has(*candidate))
+                        continue;
+                    queue_empty(&deps);
+                    solvable_lookup_idarray(pool_id2solvable(pool, *candidate), depKey, &deps);
+                    bool provided = false;
+                    for (int i = 0; i < deps.count && !provided; ++i) {
+                        Id dep = deps.elements[i];
+                        if (dep == SOLVABLE_PREREQMARKER || dep == SOLVABLE_FILEMARKER)
+                            continue;
+                        Id p, pp;
+                        FOR_PROVIDES(p, pp, dep) {
+                            if (MAPTST(&targets, p)) {
+                                provided = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (provided) {
+                        MAPSET(closure, *candidate);
+                        next.push_back(*candidate);
+                    }
+                }
+            }
         }
+        frontier.swap(next);
     }
+    queue_free(&deps);
+    map_free(&targets);
+    return 0;
 }
 
 void
 Query::filterDuplicated()
 {
-    IdQueue samename;
     Pool *pool = dnf_sack_get_pool(pImpl->sack);
 
     installed();
 
-    auto resultMap = pImpl->result->getMap();
-    hy_query_to_name_ordered_queue(this, &samename);
-
-    Solvable *considered, *highest = 0;
-    int start_block = -1;
-    int i;
+    // the copy keeps the installed packages while the result is rebuilt
+    PackageSet installedPkgs(*pImpl->result);
+    auto resultMap = pImpl->mutableResult()->getMap();
     MAPZERO(resultMap);
-    for (i = 0; i < samename.size(); ++i) {
-        Id p = samename[i];
-        considered = pool->solvables + p;
-        if (!highest || highest->name != considered->name) {
-            /* start of a new block */
-            if (start_block == -1) {
-                highest = considered;
-                start_block = i;
-                continue;
-            }
-            if (start_block != i - 1) {
-                add_duplicates_to_map(pool, resultMap, samename, start_block, i);
-            }
-            highest = considered;
-            start_block = i;
+
+    std::vector<Id> samename;
+    Id id = -1;
+    while ((id = installedPkgs.next(id)) != -1) {
+        // every name is handled once, at its installed package with the lowest id
+        auto range = dnf_sack_solvables_with_name(pImpl->sack, pool_id2solvable(pool, id)->name);
+        samename.clear();
+        for (auto it = range.first; it != range.second; ++it) {
+            if (installedPkgs.has(*it))
+                samename.push_back(*it);
+        }
+        if (samename.size() > 1 && samename.front() == id) {
+            add_duplicates_to_map(pool, resultMap, samename);
         }
-    }
-    if (start_block != -1) {
-        add_duplicates_to_map(pool, resultMap, samename, start_block, i);
     }
 }
 
@@ -2629,18 +2975,24 @@ Query::getAdvisoryPkgs(int cmpType, std::vector<AdvisoryPkg> & advisoryPkgs)
 
 std::set<std::string> Query::getStringsFromProvide(const char * patternProvide)
 {
-    DnfSack * sack = getSack();
+    Pool * pool = dnf_sack_get_pool(getSack());
     auto queryResult = runSet();
-    Id pkgId = -1;
     size_t lenPatternProvide = strlen(patternProvide);
     std::set<std::string> result;
+    // provide names shared by packages are compared once
+    std::unordered_set<Id> checkedNames;
+    Id pkgId = -1;
     while ((pkgId = queryResult->next(pkgId)) != -1) {
-        std::unique_ptr<DnfPackage> pkg(dnf_package_new(sack, pkgId));
-        std::unique_ptr<DnfReldepList> provides(dnf_package_get_provides(pkg.get()));
-        auto count = provides->count();
-        for (int index = 0; index < count; ++index) {
-            Dependency provide(sack, provides->getId(index));
-            auto provideName = provide.getName();
+        Solvable * s = pool_id2solvable(pool, pkgId);
+        if (!s->provides)
+            continue;
+        for (Id * provide = s->repo->idarraydata + s->provides; *provide; ++provide) {
+            Id nameId = *provide;
+            while (ISRELDEP(nameId))
+                nameId = GETRELDEP(pool, nameId)->name;
+            if (!checkedNames.insert(nameId).second)
+                continue;
+            auto provideName = pool_id2str(pool, nameId);
             size_t lenProvide = strlen(provideName);
             if (lenProvide > lenPatternProvide + 2
                 && strncmp(patternProvide, provideName, lenPatternProvide) == 0
@@ -2667,30 +3019,12 @@ Query::installed()
     apply();
     Pool * pool = dnf_sack_get_pool(pImpl->sack);
     auto * installed_repo = pool->installed;
-    auto queryResult = pImpl->result.get();
+    auto queryResult = pImpl->mutableResult();
     if (installed_repo == nullptr) {
         queryResult->clear();
         return;
     }
-    Map filterResult;
-    map_init(&filterResult, pool->nsolvables);
-    Id pkgId = installed_repo->start;
-    if (!queryResult->has(pkgId)) {
-        pkgId = queryResult->next(pkgId);
-    }
-    for (; pkgId != -1; pkgId = queryResult->next(pkgId)) {
-        Solvable * solvable = pool_id2solvable(pool, pkgId);
-        if (solvable->repo == installed_repo) {
-            MAPSET(&filterResult, pkgId);
-            continue;
-        }
-        if (pkgId < installed_repo->end) {
-            continue;
-        }
-        break;
-    }
-    map_and(queryResult->getMap(), &filterResult);
-    map_free(&filterResult);
+    *queryResult /= dnf_sack_get_repo_solvables(pImpl->sack, installed_repo->repoid);
 }
 
 void
@@ -2702,22 +3036,7 @@ Query::available()
     if (installed_repo == nullptr) {
         return;
     }
-    auto queryResult = pImpl->result.get();
-    Id pkgId = installed_repo->start;
-    if (!queryResult->has(pkgId)) {
-        pkgId = queryResult->next(pkgId);
-    }
-    for (; pkgId != -1; pkgId = queryResult->next(pkgId)) {
-        Solvable * solvable = pool_id2solvable(pool, pkgId);
-        if (solvable->repo == installed_repo) {
-            queryResult->remove(pkgId);
-            continue;
-        }
-        if (pkgId < installed_repo->end) {
-            continue;
-        }
-        break;
-    }
+    *pImpl->mutableResult() -= dnf_sack_get_repo_solvables(pImpl->sack, installed_repo->repoid);
 }
 
 std::pair<bool, std::unique_ptr<Nevra>>
@@ -2731,7 +3050,7 @@ Query::filterSubject(const char * subject, HyForm * forms, bool icase, bool with
         Nevra nevraObj;
         const HyForm * tryForms = !forms ? HY_FORMS_MOST_SPEC : forms;
         for (std::size_t i = 0; tryForms[i] != _HY_FORM_STOP_; ++i) {
-            if (nevraObj.parse(subject, tryForms[i])) {
+            if (dnf_sack_parse_nevra(pImpl->sack, subject, tryForms[i], nevraObj)) {
                 addFilter(&nevraObj, icase);
                 if (!empty()) {
                     return {true, std::unique_ptr<Nevra>(new Nevra(std::move(nevraObj)))};
@@ -2768,34 +3087,152 @@ Query::filterSubject(const char * subject, HyForm * forms, bool icase, bool with
     return {false, std::unique_ptr<Nevra>()};
 }
 
-void
-hy_query_to_name_ordered_queue(HyQuery query, IdQueue * samename)
+std::vector<Query::SubjectSolution>
+Query::resolveSubjects(const std::vector<std::string> & subjects, HyForm * forms, bool icase,
+    bool with_nevra, bool with_provides, bool with_filenames)
 {
-    hy_query_apply(query);
-    Pool *pool = dnf_sack_get_pool(query->getSack());
+    apply();
+    Pool *pool = dnf_sack_get_pool(pImpl->sack);
+    const HyForm * tryForms = !forms ? HY_FORMS_MOST_SPEC : forms;
+
+    // the packages of this query by name, shared by all subjects
+    std::unordered_map<Id, std::vector<Id>> byName;
+    if (with_nevra && !icase) {
+        for (Id id = pImpl->result->next(-1); id != -1; id = pImpl->result->next(id))
+            byName[pool_id2solvable(pool, id)->name].push_back(id);
+    }
+    // the names of byName in the string order, built for the first glob subject
+    std::vector<Id> sortedNames;
+    auto namesStartingWith = [&](const std::string & prefix) {
+        if (sortedNames.empty()) {
+            sortedNames.reserve(byName.size());
+            for (const auto & name : byName)
+                sortedNames.push_back(name.first);
+            std::sort(sortedNames.begin(), sortedNames.end(), [pool](Id a, Id b) {
+                return strcmp(pool_id2str(pool, a), pool_id2str(pool, b)) < 0;
+            });
+        }
+        return std::lower_bound(sortedNames.begin(), sortedNames.end(), prefix,
+            [pool](Id name, const std::string & value) {
+                return strcmp(pool_id2str(pool, name), value.c_str()) < 0;
+            });
+    };
+    auto addName = [&](Id name, PackageSet & matches) {
+        auto byNameIt = byName.find(name);
+        if (byNameIt != byName.end())
+            for (Id id : byNameIt->second)
+                matches.set(id);
+    };
+    // the packages whose name matches the name pattern of a form, like the name filter
+    auto addNameMatches = [&](const std::string & pattern, PackageSet & matches) {
+        if (pattern.empty() || pattern == "*") {
+            matches += *pImpl->result;
+            return;
+        }
+        if (!hy_is_glob_pattern(pattern.c_str())) {
+            addName(pool_str2id(pool, pattern.c_str(), 0), matches);
+            return;
+        }
+        GlobMatcher matcher(pattern.c_str());
+        const auto & prefix = matcher.getPrefix();
+        for (auto it = namesStartingWith(prefix); it != sortedNames.end(); ++it) {
+            const char *name = pool_id2str(pool, *it);
+            if (strncmp(name, prefix.c_str(), prefix.size()) != 0)
+                break;
+            if (matcher.match(name))
+                addName(*it, matches);
+        }
+    };
+
+    std::vector<SubjectSolution> solutions(subjects.size());
+    for (std::size_t idx = 0; idx < subjects.size(); ++idx) {
+        const char * subject = subjects[idx].c_str();
+        auto & solution = solutions[idx];
+        solution.query.reset(new Query(*this));
+
+        if (!with_nevra || icase) {
+            auto ret = solution.query->filterSubject(subject, forms, icase, with_nevra,
+                                                     with_provides, with_filenames);
+            solution.matched = ret.first;
+            solution.nevra = std::move(ret.second);
+            continue;
+        }
 
-    const auto result = query->getResult();
-    for (int i = 1; i < pool->nsolvables; ++i)
-        if (MAPTST(result, i))
-            samename->pushBack(i);
+        bool glob = hy_is_glob_pattern(subject);
+        PackageSet matches(pImpl->sack);
+        Nevra nevraObj;
+        for (std::size_t i = 0; tryForms[i] != _HY_FORM_STOP_; ++i) {
+            if (!dnf_sack_parse_nevra(pImpl->sack, subject, tryForms[i], nevraObj))
+                continue;
+            addNameMatches(nevraObj.getName(), matches);
+            if (matches.empty())
+                continue;
+            if (!nevraObj.hasJustName()) {
+                // the remaining parts are compared by the filters, on the few candidates only
+                Query candidates(*this);
+                candidates.addFilter(HY_PKG, HY_EQ, &matches);
+                candidates.addFilter(&nevraObj, false);
+                matches /= *candidates.runSet();
+            }
+            if (!matches.empty()) {
+                solution.nevra.reset(new Nevra(std::move(nevraObj)));
+                break;
+            }
+        }
+        if (matches.empty() && !forms && glob) {
+            // a HY_PKG_NEVRA glob, the nevra starts with the name, so the name either starts
+            // with the literal prefix of the subject or is a part of it
+            GlobMatcher matcher(subject);
+            const auto & prefix = matcher.getPrefix();
+            PackageSet candidates(pImpl->sack);
+            for (auto it = namesStartingWith(prefix); it != sortedNames.end(); ++it) {
+                if (strncmp(pool_id2str(pool, *it), prefix.c_str(), prefix.size()) != 0)
+                    break;
+                addName(*it, candidates);
+            }
+            for (std::size_t len = 1; len < prefix.size(); ++len)
+                addName(pool_strn2id(pool, prefix.c_str(), len, 0), candidates);
+            if (!candidates.empty()) {
+                Query nevraQuery(*this);
+                nevraQuery.addFilter(HY_PKG, HY_EQ, &candidates);
+                nevraQuery.addFilter(HY_PKG_NEVRA, HY_GLOB, subject);
+                matches += *nevraQuery.runSet();
+            }
+        } else if (matches.empty() && !forms && !strpbrk(subject, "(/=<> ")) {
+            // an exact HY_PKG_NEVRA match, the name ends at one of the dashes of the subject
+            gboolean presentEpoch = strchr(subject, ':') != NULL;
+            for (auto dash = strchr(subject, '-'); dash; dash = strchr(dash + 1, '-')) {
+                auto byNameIt = byName.find(pool_strn2id(pool, subject, dash - subject, 0));
+                if (byNameIt == byName.end())
+                    continue;
+                for (Id id : byNameIt->second) {
+                    auto s = pool_id2solvable(pool, id);
+                    if (strcmp(pool_solvable_epoch_optional_2str(pool, s, presentEpoch), subject) == 0)
+                        matches.set(id);
+                }
+            }
+        }
+        if (!matches.empty()) {
+            solution.query->addFilter(HY_PKG, HY_EQ, &matches);
+            solution.matched = true;
+            continue;
+        }
+        solution.matched = solution.query->filterSubject(subject, forms, icase, false,
+                                                         with_provides, with_filenames).first;
+    }
+    return solutions;
+}
 
-    solv_sort(samename->data(), samename->size(), sizeof(Id), filter_latest_sortcmp,
-        pool);
+void
+hy_query_to_name_ordered_queue(HyQuery query, IdQueue * samename)
+{
+    latestOrdered(query->getSack(), HY_PKG_LATEST, *query->getResultPset(), *samename);
 }
 
 void
 hy_query_to_name_arch_ordered_queue(HyQuery query, IdQueue * samename)
 {
-    hy_query_apply(query);
-    Pool *pool = dnf_sack_get_pool(query->getSack());
-
-    const auto result = query->getResult();
-    for (int i = 1; i < pool->nsolvables; ++i)
-        if (MAPTST(result, i))
-            samename->pushBack(i);
-
-    solv_sort(samename->data(), samename->size(), sizeof(Id),
-        filter_latest_sortcmp_byarch, pool);
+    latestOrdered(query->getSack(), HY_PKG_LATEST_PER_ARCH, *query->getResultPset(), *samename);
 }
 
 }
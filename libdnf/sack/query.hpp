@@ -32,6 +32,7 @@
 #include "../transaction/Swdb.hpp"
 #include "../dnf-types.h"
 #include "advisorypkg.hpp"
+#include "packageattrs.hpp"
 
 #include <set>
 #include <utility>
@@ -65,6 +66,21 @@ private:
     std::shared_ptr<Impl> pImpl;
 };
 
+/// One filter of the pipeline run by Query::apply(), see Query::explain() and Query::setAnalyze()
+struct FilterStats {
+    int keyname;
+    int cmpType;
+    int matchType;
+    size_t nmatches;
+    /// false when the filter was skipped because the result was already empty
+    bool executed;
+    /// number of packages in the result before and after the filter
+    size_t inputSize;
+    size_t outputSize;
+    /// in seconds
+    double elapsed;
+};
+
 /**
 * @brief Provides package filtering
 * addFilter() can return DNF_ERROR_BAD_QUERY in case if cmp_type or keyname is incompatible with provided data type
@@ -125,6 +141,24 @@ public:
     int addFilter(HyNevra nevra, bool icase);
     void apply();
 
+    /**
+    * @brief Returns the filters not applied yet in the order apply() would run them. Only the
+    *        keyname, cmpType, matchType and nmatches are set.
+    */
+    std::vector<FilterStats> explain() const;
+
+    /**
+    * @brief With analyze set, apply() records its filters like explain() together with their
+    *        result sizes and elapsed times, see getAnalysis(). Kept by copies of the query.
+    */
+    void setAnalyze(bool analyze) noexcept;
+
+    /**
+    * @brief Returns what the last apply() recorded with analyze set. The list is empty when the
+    *        result was taken from the query cache of the sack.
+    */
+    const std::vector<FilterStats> & getAnalysis() const noexcept;
+
     /**
     * @brief Applies Query and returns DnfPackages in GPtrArray
     *
@@ -135,6 +169,9 @@ public:
     /**
     * @brief Applies Query and returns result in DnfPackageSet
     *
+    * Copies of a query share the result until one of them modifies it. The returned set is
+    * therefore only guaranteed to reflect the query until the query is modified again.
+    *
     * @return DnfPackageSet*
     */
     const DnfPackageSet * runSet();
@@ -175,6 +212,28 @@ public:
      */
     void filterExtras();
     void filterRecent(const long unsigned int recent_limit);
+    /**
+     * @brief Applies all filters and keep only packages whose attr is within [min, max]. Packages
+     * without the value count as 0.
+     *
+     * @param attr an attribute of PackageAttrType::NUMBER, e.g. PackageAttr::BUILDTIME
+     */
+    void filterNumRange(PackageAttr attr, unsigned long long min, unsigned long long max);
+    /**
+     * @brief Applies all filters and adds the packages reachable from the result through the
+     * dependencies of keyname in one pass, without intermediate queries. Forward, the packages
+     * providing a dependency of a package are added, e.g. "repoquery --requires --resolve
+     * --recursive". In reverse, the packages with a dependency provided by a package are added,
+     * e.g. "repoquery --whatrequires --recursive".
+     *
+     * @param keyname a dependency, e.g. HY_PKG_REQUIRES
+     * @param reverse follow the reverse dependencies
+     * @param depth the number of levels to follow, negative for no limit
+     * @param universe the packages that may be added, nullptr for those of a query without filters
+     * @return int 0 or DNF_ERROR_BAD_QUERY for keyname not being a dependency
+     */
+    int addDependencyClosure(int keyname, bool reverse, int depth = -1,
+                             const PackageSet * universe = nullptr);
     void filterDuplicated();
     int filterUnneeded(const Swdb &swdb, bool debug_solver);
     int filterSafeToRemove(const Swdb &swdb, bool debug_solver);
@@ -215,6 +274,26 @@ public:
     */
     std::pair<bool, std::unique_ptr<Nevra>> filterSubject(const char * subject, HyForm * forms,
         bool icase, bool with_nevra, bool with_provides, bool with_filenames);
+
+    /// Result of a single subject of resolveSubjects()
+    struct SubjectSolution {
+        /// This query filtered to the packages matching the subject
+        std::unique_ptr<Query> query;
+        /// The form of the subject that matched, see filterSubject()
+        std::unique_ptr<Nevra> nevra;
+        bool matched{false};
+    };
+
+    /**
+    * @brief Resolves many subjects at once, giving for each of them the same result as
+    * filterSubject() on a copy of this query. The packages are indexed by name in a single pass,
+    * subjects without glob characters are then matched by name and nevra through the index.
+    * Provides, file provides and glob patterns are filtered per subject.
+    *
+    * @return std::vector<SubjectSolution> The solutions in the order of the subjects
+    */
+    std::vector<SubjectSolution> resolveSubjects(const std::vector<std::string> & subjects,
+        HyForm * forms, bool icase, bool with_nevra, bool with_provides, bool with_filenames);
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -67,6 +67,14 @@ public:
     Id pkgs{0};
     std::unique_ptr<Filter> filterProvides;
     std::unique_ptr<Filter> filterReponame;
+    /**
+    * @brief The job of sltrToJob() and the solvables it selects, both valid only while the sack
+    * is at jobGeneration. Shared by matches() and the goal, which build the same job.
+    */
+    std::unique_ptr<IdQueue> job;
+    std::unique_ptr<IdQueue> solvables;
+    guint64 jobGeneration{0};
+    void dropJob() { job.reset(); solvables.reset(); }
 private:
     friend struct Selector;
     std::vector<_Match> matches;
@@ -92,9 +100,27 @@ Id Selector::getPkgs() const { return pImpl->pkgs; }
 const Filter *Selector::getFilterProvides() const { return pImpl->filterProvides.get(); }
 const Filter *Selector::getFilterReponame() const { return pImpl->filterReponame.get(); }
 
+const IdQueue *
+Selector::getCachedJob()
+{
+    if (pImpl->job && pImpl->jobGeneration != dnf_sack_get_generation(pImpl->sack))
+        pImpl->dropJob();
+    return pImpl->job.get();
+}
+
+const IdQueue *
+Selector::setCachedJob(IdQueue && job)
+{
+    pImpl->solvables.reset();
+    pImpl->job.reset(new IdQueue(std::move(job)));
+    pImpl->jobGeneration = dnf_sack_get_generation(pImpl->sack);
+    return pImpl->job.get();
+}
+
 int
 Selector::set(const DnfPackageSet *pset)
 {
+    pImpl->dropJob();
     if (pImpl->filterName || pImpl->filterProvides || pImpl->filterFile) {
         return DNF_ERROR_BAD_SELECTOR;
     }
@@ -118,6 +144,7 @@ Selector::set(int keyname, int cmp_type, const char *match)
 {
     if (!valid_setting(keyname, cmp_type))
         return DNF_ERROR_BAD_SELECTOR;
+    pImpl->dropJob();
 
     switch (keyname) {
         case HY_PKG_ARCH:
@@ -166,20 +193,18 @@ Selector::matches()
 {
     DnfSack *sack = pImpl->sack;
     Pool *pool = dnf_sack_get_pool(sack);
-    Queue job, solvables;
-
-    queue_init(&job);
-    sltrToJob(this, &job, 0);
+    IdQueue job;
 
-    queue_init(&solvables);
-    selection_solvables(pool, &job, &solvables);
+    // validates the cached job, or builds a new one and drops the solvables of the old one
+    sltrToJob(this, job.getQueue(), 0);
+    if (!pImpl->solvables) {
+        pImpl->solvables.reset(new IdQueue);
+        selection_solvables(pool, job.getQueue(), pImpl->solvables->getQueue());
+    }
 
     GPtrArray *plist = hy_packagelist_create();
-    for (int i = 0; i < solvables.count; i++)
-        g_ptr_array_add(plist, dnf_package_new(sack, solvables.elements[i]));
-
-    queue_free(&solvables);
-    queue_free(&job);
+    for (int i = 0; i < pImpl->solvables->size(); i++)
+        g_ptr_array_add(plist, dnf_package_new(sack, (*pImpl->solvables)[i]));
     return plist;
 }
 
@@ -24,6 +24,7 @@
 #include <memory>
 
 #include "../hy-selector.h"
+#include "../goal/IdQueue.hpp"
 #include "query.hpp"
 
 namespace libdnf {
@@ -44,6 +45,13 @@ public:
     int set(const DnfPackageSet * pset);
     int set(int keyname, int cmp_type, const char *match);
     GPtrArray * matches();
+
+    /**
+    * @brief Returns the selection job built by sltrToJob() without any solver action, or nullptr
+    * if there is none. The job is dropped when the selector or the sack change.
+    */
+    const IdQueue * getCachedJob();
+    const IdQueue * setCachedJob(IdQueue && job);
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
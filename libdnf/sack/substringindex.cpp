@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <ctype.h>
+
+#include <algorithm>
+
+#include "substringindex.hpp"
+
+namespace libdnf {
+
+static inline uint32_t
+foldChar(char c)
+{
+    // the same folding strcasestr() uses
+    return static_cast<unsigned char>(tolower(static_cast<unsigned char>(c)));
+}
+
+/// Fill result with the distinct trigrams of the folded text in ascending order
+static void
+collectTrigrams(const char * text, std::vector<uint32_t> & result)
+{
+    result.clear();
+    if (!text || !text[0] || !text[1])
+        return;
+    uint32_t trigram = foldChar(text[0]) << 8 | foldChar(text[1]);
+    for (const char * pos = text + 2; *pos; ++pos) {
+        trigram = (trigram << 8 | foldChar(*pos)) & 0xffffff;
+        result.push_back(trigram);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void
+SubstringIndex::add(Id id, const char * text)
+{
+    std::vector<uint32_t> textTrigrams;
+    collectTrigrams(text, textTrigrams);
+    for (auto trigram : textTrigrams)
+        pending.push_back(static_cast<uint64_t>(trigram) << 32 | static_cast<uint32_t>(id));
+}
+
+void
+SubstringIndex::finish()
+{
+    // ordered by the trigram and then by the id, every list comes out sorted
+    std::sort(pending.begin(), pending.end());
+    trigrams.clear();
+    starts.clear();
+    ids.clear();
+    ids.reserve(pending.size());
+    for (auto entry : pending) {
+        auto trigram = static_cast<uint32_t>(entry >> 32);
+        if (trigrams.empty() || trigrams.back() != trigram) {
+            trigrams.push_back(trigram);
+            starts.push_back(ids.size());
+        }
+        ids.push_back(static_cast<Id>(entry & 0xffffffff));
+    }
+    starts.push_back(ids.size());
+    std::vector<uint64_t>().swap(pending);
+}
+
+bool
+SubstringIndex::lookup(const char * match, std::vector<Id> & candidates) const
+{
+    std::vector<uint32_t> matchTrigrams;
+    collectTrigrams(match, matchTrigrams);
+    if (matchTrigrams.empty())
+        return false;
+
+    // start with the shortest list, the result can only shrink
+    std::vector<std::pair<const Id *, const Id *>> lists;
+    for (auto trigram : matchTrigrams) {
+        auto it = std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+        if (it == trigrams.end() || *it != trigram) {
+            candidates.clear();
+            return true;
+        }
+        auto pos = it - trigrams.begin();
+        lists.emplace_back(ids.data() + starts[pos], ids.data() + starts[pos + 1]);
+    }
+    std::sort(lists.begin(), lists.end(),
+        [](const std::pair<const Id *, const Id *> & a, const std::pair<const Id *, const Id *> & b) {
+            return a.second - a.first < b.second - b.first;
+        });
+    candidates.assign(lists[0].first, lists[0].second);
+    for (std::size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        auto first = lists[i].first;
+        auto last = lists[i].second;
+        auto out = candidates.begin();
+        for (auto id : candidates) {
+            first = std::lower_bound(first, last, id);
+            if (first == last)
+                break;
+            if (*first == id)
+                *out++ = id;
+        }
+        candidates.erase(out, candidates.end());
+    }
+    return true;
+}
+
+bool
+SubstringIndex::write(FILE * fp) const
+{
+    uint32_t sizes[] = {static_cast<uint32_t>(trigrams.size()), static_cast<uint32_t>(ids.size())};
+    return fwrite(sizes, sizeof(sizes), 1, fp) == 1 &&
+        fwrite(trigrams.data(), sizeof(uint32_t), trigrams.size(), fp) == trigrams.size() &&
+        fwrite(starts.data(), sizeof(uint32_t), starts.size(), fp) == starts.size() &&
+        fwrite(ids.data(), sizeof(Id), ids.size(), fp) == ids.size();
+}
+
+bool
+SubstringIndex::read(FILE * fp, Id nsolvables)
+{
+    pending.clear();
+    uint32_t sizes[2];
+    bool ok = fread(sizes, sizeof(sizes), 1, fp) == 1 && sizes[0] <= sizes[1];
+    if (ok) {
+        trigrams.resize(sizes[0]);
+        starts.resize(sizes[0] + 1);
+        ids.resize(sizes[1]);
+        ok = fread(trigrams.data(), sizeof(uint32_t), trigrams.size(), fp) == trigrams.size() &&
+            fread(starts.data(), sizeof(uint32_t), starts.size(), fp) == starts.size() &&
+            fread(ids.data(), sizeof(Id), ids.size(), fp) == ids.size();
+    }
+    // lookup() relies on sorted trigrams, nondecreasing starts and valid ids
+    if (ok)
+        ok = starts.front() == 0 && starts.back() == sizes[1];
+    for (std::size_t i = 0; ok && i < trigrams.size(); ++i)
+        ok = starts[i] < starts[i + 1] && (i == 0 || trigrams[i - 1] < trigrams[i]);
+    for (std::size_t i = 0; ok && i < ids.size(); ++i)
+        ok = ids[i] > 0 && ids[i] < nsolvables;
+    if (!ok) {
+        trigrams.clear();
+        starts.assign(1, 0);
+        ids.clear();
+    }
+    return ok;
+}
+
+std::size_t
+SubstringIndex::memoryUsage() const
+{
+    return pending.capacity() * sizeof(pending[0]) + trigrams.capacity() * sizeof(trigrams[0]) +
+        starts.capacity() * sizeof(starts[0]) + ids.capacity() * sizeof(ids[0]);
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __SUBSTRING_INDEX_HPP
+#define __SUBSTRING_INDEX_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include <solv/pooltypes.h>
+
+namespace libdnf {
+
+/**
+ * @brief Trigram index of one string per solvable for substring searches. Every string is folded
+ * to lower case the way strcasestr() compares and each distinct trigram of it points to the
+ * solvable. A substring occurs only in strings containing all of its trigrams, so the lookup
+ * intersects their lists and leaves candidates which still have to be verified.
+ */
+class SubstringIndex {
+public:
+    /// Shorter matches have no trigram to look up
+    static constexpr std::size_t MIN_MATCH_LENGTH = 3;
+
+    /// Index text as the string of solvable id, each id at most once
+    void add(Id id, const char * text);
+
+    /// Sort the trigrams of the added strings, required before lookup() and write()
+    void finish();
+
+    /// Fill candidates with the ascending ids of solvables which may contain match in any case.
+    /// Returns false without touching candidates if match is shorter than MIN_MATCH_LENGTH.
+    bool lookup(const char * match, std::vector<Id> & candidates) const;
+
+    /// Store the finished index to fp, returns false on a write error
+    bool write(FILE * fp) const;
+
+    /// Replace the index with one stored by write(), ids are checked to be below nsolvables.
+    /// Returns false if the data is truncated or inconsistent, the index is empty then.
+    bool read(FILE * fp, Id nsolvables);
+
+    /// Bytes allocated by the index
+    std::size_t memoryUsage() const;
+
+private:
+    std::vector<uint64_t> pending;      // (trigram << 32 | id) of the added strings
+    std::vector<uint32_t> trigrams;     // distinct trigrams in ascending order
+    std::vector<uint32_t> starts;       // ids of trigrams[i] are ids[starts[i]] .. ids[starts[i + 1] - 1]
+    std::vector<Id> ids;
+};
+
+}
+
+#endif /* __SUBSTRING_INDEX_HPP */
@@ -41,9 +41,9 @@ Item::dbInsert()
         "  item "
         "VALUES "
         "  (null, ?)";
-    SQLite3::Statement query(*conn.get(), sql);
-    query.bindv(static_cast< int >(itemType));
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(static_cast< int >(itemType));
+    query->step();
     setId(conn->lastInsertRowID());
 }
 
@@ -42,17 +42,12 @@ MergedTransaction::MergedTransaction(TransactionPtr trans)
 void
 MergedTransaction::merge(TransactionPtr trans)
 {
-    bool inserted = false;
-    for (auto it = transactions.begin(); it < transactions.end(); ++it) {
-        if ((*it)->getId() > trans->getId()) {
-            transactions.insert(it, trans);
-            inserted = true;
-            break;
-        }
-    }
-    if (!inserted) {
-        transactions.push_back(trans);
-    }
+    auto it = std::upper_bound(
+        transactions.begin(),
+        transactions.end(),
+        trans,
+        [](const TransactionPtr &lhs, const TransactionPtr &rhs) { return lhs->getId() < rhs->getId(); });
+    transactions.insert(it, trans);
 }
 
 /**
@@ -173,20 +168,24 @@ MergedTransaction::getConsoleOutput()
 }
 
 
-static bool transaction_item_sort_function(const std::shared_ptr<TransactionItemBase> lhs, const std::shared_ptr<TransactionItemBase> rhs) {
-    if (lhs->isForwardAction() && rhs->isForwardAction()) {
-        return false;
-    }
-    if (lhs->isBackwardAction() && rhs->isBackwardAction()) {
-        return false;
-    }
-    if (lhs->isBackwardAction()) {
-        return true;
+static std::string
+getItemIdentifier(ItemPtr item)
+{
+    auto itemType = item->getItemType();
+    std::string name;
+    if (itemType == ItemType::RPM) {
+        auto rpm = std::dynamic_pointer_cast< RPMItem >(item);
+        name = rpm->getName() + "." + rpm->getArch();
+    } else if (itemType == ItemType::GROUP) {
+        auto group = std::dynamic_pointer_cast< CompsGroupItem >(item);
+        name = group->getGroupId();
+    } else if (itemType == ItemType::ENVIRONMENT) {
+        auto env = std::dynamic_pointer_cast< CompsEnvironmentItem >(item);
+        name = env->getEnvironmentId();
     }
-    return false;
+    return name;
 }
 
-
 /**
  * Get list of transaction items involved in the merged transaction
  * Actions are merged using following rules:
@@ -219,9 +218,11 @@ MergedTransaction::getItems()
     // iterate over transaction
     for (auto t : transactions) {
         auto transItems = t->getItems();
-        // sort transaction items by their action type - forward/backward
+        // put backward actions before the forward ones
         // this fixes behavior of the merging algorithm in several edge cases
-        std::sort(transItems.begin(), transItems.end(), transaction_item_sort_function);
+        std::stable_partition(transItems.begin(), transItems.end(), [](const TransactionItemPtr &item) {
+            return item->isBackwardAction();
+        });
         // iterate over transaction items
         for (auto transItem : transItems) {
             // get item and its type
@@ -230,33 +231,47 @@ MergedTransaction::getItems()
         }
     }
 
+    // order the result by the item identifiers, sorted only once at the end
+    std::vector< std::pair< std::string, const ItemPair * > > sorted;
+    sorted.reserve(itemPairMap.pairs.size());
+    for (const auto &itemPair : itemPairMap.pairs) {
+        if (itemPair.first != nullptr) {
+            sorted.emplace_back(getItemIdentifier(itemPair.first->getItem()), &itemPair);
+        }
+    }
+    std::stable_sort(sorted.begin(),
+                     sorted.end(),
+                     [](const std::pair< std::string, const ItemPair * > &lhs,
+                        const std::pair< std::string, const ItemPair * > &rhs) {
+                         return lhs.first < rhs.first;
+                     });
+
     std::vector< TransactionItemBasePtr > items;
-    for (const auto &row : itemPairMap) {
-        ItemPair itemPair = row.second;
-        items.push_back(itemPair.first);
-        if (itemPair.second != nullptr) {
-            items.push_back(itemPair.second);
+    for (const auto &row : sorted) {
+        items.push_back(row.second->first);
+        if (row.second->second != nullptr) {
+            items.push_back(row.second->second);
         }
     }
     return items;
 }
 
-static std::string
-getItemIdentifier(ItemPtr item)
+MergedTransaction::ItemKey
+MergedTransaction::getItemKey(const ItemPtr &item)
 {
+    static const std::string empty;
     auto itemType = item->getItemType();
-    std::string name;
     if (itemType == ItemType::RPM) {
-        auto rpm = std::dynamic_pointer_cast< RPMItem >(item);
-        name = rpm->getName() + "." + rpm->getArch();
+        auto rpm = std::static_pointer_cast< RPMItem >(item);
+        return {itemType, &rpm->getName(), &rpm->getArch()};
     } else if (itemType == ItemType::GROUP) {
-        auto group = std::dynamic_pointer_cast< CompsGroupItem >(item);
-        name = group->getGroupId();
+        auto group = std::static_pointer_cast< CompsGroupItem >(item);
+        return {itemType, &group->getGroupId(), nullptr};
     } else if (itemType == ItemType::ENVIRONMENT) {
-        auto env = std::dynamic_pointer_cast< CompsEnvironmentItem >(item);
-        name = env->getEnvironmentId();
+        auto env = std::static_pointer_cast< CompsEnvironmentItem >(item);
+        return {itemType, &env->getEnvironmentId(), nullptr};
     }
-    return name;
+    return {itemType, &empty, nullptr};
 }
 
 /**
@@ -388,16 +403,24 @@ MergedTransaction::resolveAltered(ItemPair &previousItemPair, TransactionItemBas
 void
 MergedTransaction::mergeItem(ItemPairMap &itemPairMap, TransactionItemBasePtr mTransItem)
 {
-    // get item identifier
-    std::string name = getItemIdentifier(mTransItem->getItem());
-
-    auto previous = itemPairMap.find(name);
-    if (previous == itemPairMap.end()) {
-        itemPairMap[name] = ItemPair(mTransItem, nullptr);
+    auto item = mTransItem->getItem();
+    auto key = getItemKey(item);
+
+    auto previous = itemPairMap.index.find(key);
+    if (previous == itemPairMap.index.end()) {
+        // intern the key, the item is kept to own its strings
+        itemPairMap.index.emplace(key, itemPairMap.pairs.size());
+        itemPairMap.pairs.emplace_back(mTransItem, nullptr);
+        itemPairMap.keyItems.push_back(item);
         return;
     }
 
-    ItemPair &previousItemPair = previous->second;
+    ItemPair &previousItemPair = itemPairMap.pairs[previous->second];
+    if (previousItemPair.first == nullptr) {
+        // the item was dropped by one of the previous transactions
+        previousItemPair = ItemPair(mTransItem, nullptr);
+        return;
+    }
 
     auto firstState = previousItemPair.first->getAction();
     auto newState = mTransItem->getAction();
@@ -412,7 +435,7 @@ MergedTransaction::mergeItem(ItemPairMap &itemPairMap, TransactionItemBasePtr mT
             if (newState == TransactionItemAction::REMOVE ||
                 newState == TransactionItemAction::OBSOLETED) {
                 // Install -> Remove = (nothing)
-                itemPairMap.erase(name);
+                previousItemPair = ItemPair();
                 break;
             } else if (mTransItem->isBackwardAction()) {
                 break;
@@ -25,6 +25,7 @@
 #include <set>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace libdnf {
@@ -73,8 +74,41 @@ protected:
         TransactionItemBasePtr second = nullptr;
     };
 
-    typedef std::map< std::string, ItemPair > ItemPairMap;
+    // identifies an item by (type, name, arch) without copying the strings;
+    // they are owned by the item the key was taken from
+    struct ItemKey {
+        ItemType type;
+        const std::string *name;
+        const std::string *arch;
 
+        bool operator==(const ItemKey &other) const
+        {
+            return type == other.type && *name == *other.name &&
+                   (arch == other.arch || (arch && other.arch && *arch == *other.arch));
+        }
+    };
+
+    struct ItemKeyHash {
+        std::size_t operator()(const ItemKey &key) const
+        {
+            std::hash< std::string > hash;
+            std::size_t result = hash(*key.name) ^ static_cast< std::size_t >(key.type);
+            if (key.arch) {
+                result ^= hash(*key.arch) * 31;
+            }
+            return result;
+        }
+    };
+
+    // item pairs stored by the index the item key was interned to
+    struct ItemPairMap {
+        std::unordered_map< ItemKey, std::size_t, ItemKeyHash > index;
+        std::vector< ItemPair > pairs;
+        // items owning the strings of the keys
+        std::vector< ItemPtr > keyItems;
+    };
+
+    static ItemKey getItemKey(const ItemPtr &item);
     void mergeItem(ItemPairMap &itemPairMap, TransactionItemBasePtr transItem);
     void resolveRPMDifference(ItemPair &previousItemPair, TransactionItemBasePtr mTransItem);
     void resolveErase(ItemPair &previousItemPair, TransactionItemBasePtr mTransItem);
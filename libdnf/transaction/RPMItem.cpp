@@ -64,16 +64,16 @@ RPMItem::dbSelect(int64_t pk)
         "  rpm "
         "WHERE "
         "  item_id = ?";
-    SQLite3::Statement query(*conn.get(), sql);
-    query.bindv(pk);
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(pk);
+    query->step();
 
     setId(pk);
-    setName(query.get< std::string >(0));
-    setEpoch(query.get< int >(1));
-    setVersion(query.get< std::string >(2));
-    setRelease(query.get< std::string >(3));
-    setArch(query.get< std::string >(4));
+    setName(query->get< std::string >(0));
+    setEpoch(query->get< int >(1));
+    setVersion(query->get< std::string >(2));
+    setRelease(query->get< std::string >(3));
+    setArch(query->get< std::string >(4));
 }
 
 void
@@ -87,9 +87,9 @@ RPMItem::dbInsert()
         "  rpm "
         "VALUES "
         "  (?, ?, ?, ?, ?, ?)";
-    SQLite3::Statement query(*conn.get(), sql);
-    query.bindv(getId(), getName(), getEpoch(), getVersion(), getRelease(), getArch());
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(getId(), getName(), getEpoch(), getVersion(), getRelease(), getArch());
+    query->step();
 }
 
 static TransactionItemPtr
@@ -141,15 +141,100 @@ RPMItem::getTransactionItems(SQLite3Ptr conn, int64_t transaction_id)
         "  ti.trans_id = ? "
         "  AND ti.repo_id = r.id "
         "  AND ti.item_id = i.item_id";
-    SQLite3::Query query(*conn.get(), sql);
-    query.bindv(transaction_id);
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(transaction_id);
 
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        result.push_back(transactionItemFromQuery(conn, query, transaction_id));
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
+        result.push_back(transactionItemFromQuery(conn, *query, transaction_id));
     }
     return result;
 }
 
+RPMItemColumns
+RPMItem::getTransactionItemColumns(SQLite3Ptr conn, int64_t transaction_id)
+{
+    RPMItemColumns result(conn, transaction_id);
+
+    const char *sql =
+        "SELECT "
+        // trans_item
+        "  ti.id, "
+        "  ti.action, "
+        "  ti.reason, "
+        "  ti.state, "
+        // repo
+        "  r.repoid, "
+        // rpm
+        "  i.item_id, "
+        "  i.name, "
+        "  i.epoch, "
+        "  i.version, "
+        "  i.release, "
+        "  i.arch "
+        "FROM "
+        "  trans_item ti, "
+        "  repo r, "
+        "  rpm i "
+        "WHERE "
+        "  ti.trans_id = ? "
+        "  AND ti.repo_id = r.id "
+        "  AND ti.item_id = i.item_id";
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(transaction_id);
+
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
+        result.ids.push_back(query->get< int64_t >(0));
+        result.actions.push_back(static_cast< TransactionItemAction >(query->get< int >(1)));
+        result.reasons.push_back(static_cast< TransactionItemReason >(query->get< int >(2)));
+        result.states.push_back(static_cast< TransactionItemState >(query->get< int >(3)));
+        result.repoids.push_back(result.intern(query->get< std::string >(4)));
+        result.itemIds.push_back(query->get< int64_t >(5));
+        result.names.push_back(query->get< std::string >(6));
+        result.epochs.push_back(query->get< int >(7));
+        result.versions.push_back(query->get< std::string >(8));
+        result.releases.push_back(query->get< std::string >(9));
+        result.arches.push_back(result.intern(query->get< std::string >(10)));
+    }
+    return result;
+}
+
+uint32_t
+RPMItemColumns::intern(const std::string &value)
+{
+    auto inserted = stringIndex.emplace(value, static_cast< uint32_t >(strings.size()));
+    if (inserted.second)
+        strings.push_back(value);
+    return inserted.first->second;
+}
+
+std::string
+RPMItemColumns::getNEVRA(std::size_t row) const
+{
+    auto epoch = getEpoch(row);
+    auto evr = epoch > 0 ? std::to_string(epoch) + ":" + getVersion(row) : getVersion(row);
+    return getName(row) + "-" + evr + "-" + getRelease(row) + "." + getArch(row);
+}
+
+TransactionItemPtr
+RPMItemColumns::getTransactionItem(std::size_t row) const
+{
+    auto trans_item = std::make_shared< TransactionItem >(conn, transactionId);
+    auto item = std::make_shared< RPMItem >(conn);
+    trans_item->setItem(item);
+    trans_item->setId(getId(row));
+    trans_item->setAction(getAction(row));
+    trans_item->setReason(getReason(row));
+    trans_item->setRepoid(getRepoid(row));
+    trans_item->setState(getState(row));
+    item->setId(getItemId(row));
+    item->setName(getName(row));
+    item->setEpoch(getEpoch(row));
+    item->setVersion(getVersion(row));
+    item->setRelease(getRelease(row));
+    item->setArch(getArch(row));
+    return trans_item;
+}
+
 std::string
 RPMItem::getNEVRA() const
 {
@@ -181,13 +266,13 @@ RPMItem::dbSelectOrInsert()
         "  AND release = ? "
         "  AND arch = ?";
 
-    SQLite3::Statement query(*conn.get(), sql);
+    auto query = conn->getCachedQuery(sql);
 
-    query.bindv(getName(), getEpoch(), getVersion(), getRelease(), getArch());
-    SQLite3::Statement::StepResult result = query.step();
+    query->bindv(getName(), getEpoch(), getVersion(), getRelease(), getArch());
+    SQLite3::Statement::StepResult result = query->step();
 
     if (result == SQLite3::Statement::StepResult::ROW) {
-        setId(query.get< int >(0));
+        setId(query->get< int >(0));
     } else {
         // insert and get the ID back
         dbInsert();
@@ -237,14 +322,14 @@ RPMItem::getTransactionItem(SQLite3Ptr conn, const std::string &nevra)
            ti.id DESC
         LIMIT 1
     )**";
-    SQLite3::Query query(*conn, sql);
-    query.bindv(nevraObject.getName(),
-                nevraObject.getEpoch(),
-                nevraObject.getVersion(),
-                nevraObject.getRelease(),
-                nevraObject.getArch());
-    if (query.step() == SQLite3::Statement::StepResult::ROW) {
-        return transactionItemFromQuery(conn, query, query.get< int64_t >("trans_id"));
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(nevraObject.getName(),
+                 nevraObject.getEpoch(),
+                 nevraObject.getVersion(),
+                 nevraObject.getRelease(),
+                 nevraObject.getArch());
+    if (query->step() == SQLite3::Statement::StepResult::ROW) {
+        return transactionItemFromQuery(conn, *query, query->get< int64_t >("trans_id"));
     }
     return nullptr;
 }
@@ -288,19 +373,19 @@ RPMItem::resolveTransactionItemReason(SQLite3Ptr conn,
     )**");
 
     if (arch != "") {
-        SQLite3::Query query(*conn, sql);
+        auto query = conn->getCachedQuery(sql);
         if (maxTransactionId >= 0) {
-            query.bindv(name, arch, maxTransactionId);
+            query->bindv(name, arch, maxTransactionId);
         } else {
-            query.bindv(name, arch);
+            query->bindv(name, arch);
         }
 
-        if (query.step() == SQLite3::Statement::StepResult::ROW) {
-            auto action = static_cast< TransactionItemAction >(query.get< int64_t >("action"));
+        if (query->step() == SQLite3::Statement::StepResult::ROW) {
+            auto action = static_cast< TransactionItemAction >(query->get< int64_t >("action"));
             if (action == TransactionItemAction::REMOVE) {
                 return TransactionItemReason::UNKNOWN;
             }
-            auto reason = static_cast< TransactionItemReason >(query.get< int64_t >("reason"));
+            auto reason = static_cast< TransactionItemReason >(query->get< int64_t >("reason"));
             return reason;
         }
     } else {
@@ -313,22 +398,22 @@ RPMItem::resolveTransactionItemReason(SQLite3Ptr conn,
                 name = ?
         )**";
 
-        SQLite3::Query arch_query(*conn, arch_sql);
-        arch_query.bindv(name);
+        auto arch_query = conn->getCachedQuery(arch_sql);
+        arch_query->bindv(name);
 
         TransactionItemReason result = TransactionItemReason::UNKNOWN;
 
-        while (arch_query.step() == SQLite3::Statement::StepResult::ROW) {
-            auto rpm_arch = arch_query.get< std::string >("arch");
+        while (arch_query->step() == SQLite3::Statement::StepResult::ROW) {
+            auto rpm_arch = arch_query->get< std::string >("arch");
 
-            SQLite3::Query query(*conn, sql);
-            query.bindv(name, rpm_arch);
-            while (query.step() == SQLite3::Statement::StepResult::ROW) {
-                auto action = static_cast< TransactionItemAction >(query.get< int64_t >("action"));
+            auto query = conn->getCachedQuery(sql);
+            query->bindv(name, rpm_arch);
+            while (query->step() == SQLite3::Statement::StepResult::ROW) {
+                auto action = static_cast< TransactionItemAction >(query->get< int64_t >("action"));
                 if (action == TransactionItemAction::REMOVE) {
                     continue;
                 }
-                auto reason = static_cast< TransactionItemReason >(query.get< int64_t >("reason"));
+                auto reason = static_cast< TransactionItemReason >(query->get< int64_t >("reason"));
                 if (reason > result) {
                     result = reason;
                 }
@@ -339,6 +424,47 @@ RPMItem::resolveTransactionItemReason(SQLite3Ptr conn,
     return TransactionItemReason::UNKNOWN;
 }
 
+std::unordered_map< std::string, TransactionItemReason >
+RPMItem::resolveTransactionItemReasons(SQLite3Ptr conn)
+{
+    // The bare columns of an aggregate query with MAX() come from the row with the maximum,
+    // so this returns the same item resolveTransactionItemReason() finds for each package.
+    const char *sql = R"**(
+        SELECT
+            i.name as name,
+            i.arch as arch,
+            ti.action as action,
+            ti.reason as reason,
+            MAX(ti.trans_id) as trans_id
+        FROM
+            trans_item ti
+        JOIN
+            trans t ON ti.trans_id = t.id
+        JOIN
+            rpm i USING (item_id)
+        WHERE
+            t.state = 1
+            /* see comment in TransactionItem.hpp - TransactionItemAction */
+            AND ti.action not in (3, 5, 7, 10)
+        GROUP BY
+            i.name,
+            i.arch
+    )**";
+
+    std::unordered_map< std::string, TransactionItemReason > result;
+    SQLite3::Query query(*conn, sql);
+    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        auto action = static_cast< TransactionItemAction >(query.get< int64_t >("action"));
+        if (action == TransactionItemAction::REMOVE) {
+            continue;
+        }
+        auto key = query.get< std::string >("name") + "." + query.get< std::string >("arch");
+        result.emplace(std::move(key),
+                       static_cast< TransactionItemReason >(query.get< int64_t >("reason")));
+    }
+    return result;
+}
+
 /**
  * Compare RPM packages
  * This method doesn't care about compare package names
@@ -374,11 +500,27 @@ RPMItem::operator<(const RPMItem &other) const
     return false;
 }
 
+// Every name matching the glob is >= lower and, unless upper is empty, < upper.
+static void
+globNameRange(const std::string &pattern, std::string &lower, std::string &upper)
+{
+    lower = pattern.substr(0, pattern.find_first_of("*?["));
+    upper = lower;
+    // the smallest string greater than all the strings starting with the prefix
+    while (!upper.empty() && static_cast< unsigned char >(upper.back()) == 0xff) {
+        upper.pop_back();
+    }
+    if (!upper.empty()) {
+        upper.back() = static_cast< char >(static_cast< unsigned char >(upper.back()) + 1);
+    }
+}
+
 std::vector< int64_t >
 RPMItem::searchTransactions(SQLite3Ptr conn, const std::vector< std::string > &patterns)
 {
     std::vector< int64_t > result;
 
+    // an exact pattern matches any part of the NEVRA
     const char *sql = R"**(
         SELECT DISTINCT
             t.id
@@ -400,11 +542,58 @@ RPMItem::searchTransactions(SQLite3Ptr conn, const std::vector< std::string > &p
         ORDER BY
            trans_id DESC
     )**";
-    SQLite3::Query query(*conn, sql);
-    for (auto pattern : patterns) {
-        query.bindv(pattern, pattern, pattern, pattern, pattern);
-        while (query.step() == SQLite3::Statement::StepResult::ROW) {
-            result.push_back(query.get< int64_t >("id"));
+
+    // a glob matches the name; the range turns its literal prefix into a scan of the rpm_name index
+    const char *glob_sql = R"**(
+        SELECT DISTINCT
+            t.id
+        FROM
+            rpm i
+        JOIN
+            trans_item ti USING (item_id)
+        JOIN
+            trans t ON t.id = ti.trans_id
+        WHERE
+            t.state = 1
+            AND i.name >= ?
+            AND i.name < ?
+            AND i.name GLOB ?
+    )**";
+
+    const char *glob_unbounded_sql = R"**(
+        SELECT DISTINCT
+            t.id
+        FROM
+            rpm i
+        JOIN
+            trans_item ti USING (item_id)
+        JOIN
+            trans t ON t.id = ti.trans_id
+        WHERE
+            t.state = 1
+            AND i.name >= ?
+            AND i.name GLOB ?
+    )**";
+
+    for (const auto &pattern : patterns) {
+        SQLite3::CachedQueryPtr query;
+        if (pattern.find_first_of("*?[") == std::string::npos) {
+            query = conn->getCachedQuery(sql);
+            query->bindv(pattern, pattern, pattern, pattern, pattern);
+        } else {
+            std::string lower;
+            std::string upper;
+            globNameRange(pattern, lower, upper);
+            if (upper.empty()) {
+                query = conn->getCachedQuery(glob_unbounded_sql);
+                query->bindv(lower, pattern);
+            } else {
+                query = conn->getCachedQuery(glob_sql);
+                query->bindv(lower, upper, pattern);
+            }
+        }
+        while (query->step() == SQLite3::Statement::StepResult::ROW) {
+            result.push_back(query->get< int64_t >("id"));
         }
     }
     std::sort(result.begin(), result.end());
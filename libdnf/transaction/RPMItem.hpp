@@ -22,10 +22,13 @@
 #define LIBDNF_TRANSACTION_RPMITEM_HPP
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace libdnf {
 class RPMItem;
+class RPMItemColumns;
 typedef std::shared_ptr< RPMItem > RPMItemPtr;
 }
 
@@ -65,10 +68,16 @@ public:
     static std::vector< int64_t > searchTransactions(SQLite3Ptr conn, const std::vector< std::string > &patterns);
     static std::vector< TransactionItemPtr > getTransactionItems(SQLite3Ptr conn,
                                                                  int64_t transaction_id);
+    // The same items as getTransactionItems(), read into columns without creating objects.
+    static RPMItemColumns getTransactionItemColumns(SQLite3Ptr conn, int64_t transaction_id);
     static TransactionItemReason resolveTransactionItemReason(SQLite3Ptr conn,
                                                               const std::string &name,
                                                               const std::string &arch,
                                                               int64_t maxTransactionId);
+    // Latest reasons of all the packages in the history, keyed by "name.arch".
+    // Packages whose latest transaction item is a removal are not included.
+    static std::unordered_map< std::string, TransactionItemReason >
+    resolveTransactionItemReasons(SQLite3Ptr conn);
 
     bool operator<(const RPMItem &other) const;
 
@@ -85,6 +94,53 @@ protected:
     void dbSelectOrInsert();
 };
 
+/**
+ * The rpm items of a transaction stored column by column, for history listings which
+ * would otherwise create a TransactionItem and an RPMItem per row. Repoids and arches
+ * are shared by the rows having the same value. getTransactionItem() creates the
+ * objects of a single row when they are needed.
+ */
+class RPMItemColumns {
+public:
+    std::size_t size() const noexcept { return ids.size(); }
+
+    int64_t getId(std::size_t row) const { return ids.at(row); }
+    TransactionItemAction getAction(std::size_t row) const { return actions.at(row); }
+    TransactionItemReason getReason(std::size_t row) const { return reasons.at(row); }
+    TransactionItemState getState(std::size_t row) const { return states.at(row); }
+    const std::string &getRepoid(std::size_t row) const { return strings[repoids.at(row)]; }
+    int64_t getItemId(std::size_t row) const { return itemIds.at(row); }
+    const std::string &getName(std::size_t row) const { return names.at(row); }
+    int32_t getEpoch(std::size_t row) const { return epochs.at(row); }
+    const std::string &getVersion(std::size_t row) const { return versions.at(row); }
+    const std::string &getRelease(std::size_t row) const { return releases.at(row); }
+    const std::string &getArch(std::size_t row) const { return strings[arches.at(row)]; }
+    std::string getNEVRA(std::size_t row) const;
+
+    TransactionItemPtr getTransactionItem(std::size_t row) const;
+
+protected:
+    friend class RPMItem;
+    RPMItemColumns(SQLite3Ptr conn, int64_t transactionId) : conn{conn}, transactionId{transactionId} {}
+    uint32_t intern(const std::string &value);
+
+    SQLite3Ptr conn;
+    int64_t transactionId;
+    std::vector< int64_t > ids;
+    std::vector< TransactionItemAction > actions;
+    std::vector< TransactionItemReason > reasons;
+    std::vector< TransactionItemState > states;
+    std::vector< uint32_t > repoids;
+    std::vector< int64_t > itemIds;
+    std::vector< std::string > names;
+    std::vector< int32_t > epochs;
+    std::vector< std::string > versions;
+    std::vector< std::string > releases;
+    std::vector< uint32_t > arches;
+    std::vector< std::string > strings;
+    std::unordered_map< std::string, uint32_t > stringIndex;
+};
+
 } // namespace libdnf
 
 #endif // LIBDNF_TRANSACTION_RPMITEM_HPP
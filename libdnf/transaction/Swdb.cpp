@@ -18,7 +18,12 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
+#include <fnmatch.h>
+#include <limits>
+#include <set>
 #include <solv/bitmap.h>
 #include <solv/solvable.h>
 
@@ -31,6 +36,7 @@
 #include "../log.hpp"
 #include "../utils/bgettext/bgettext-lib.h"
 #include "../utils/filesystem.hpp"
+#include "../utils/probes.hpp"
 #include "../utils/sqlite3/Sqlite3.hpp"
 #include "../utils/tinyformat/tinyformat.hpp"
 
@@ -55,6 +61,11 @@ Swdb::Swdb(SQLite3Ptr conn, bool autoClose)
 }
 
 Swdb::Swdb(const std::string &path)
+  : Swdb(path, SQLite3::Options())
+{
+}
+
+Swdb::Swdb(const std::string &path, const SQLite3::Options &options)
   : conn(nullptr)
   , autoClose(true)
 {
@@ -62,7 +73,7 @@ Swdb::Swdb(const std::string &path)
 
     if (path == ":memory:") {
         // connect to an in-memory database as requested
-        conn = std::make_shared<SQLite3>(path);
+        conn = std::make_shared<SQLite3>(path, options);
         Transformer::createDatabase(conn);
         return;
     }
@@ -82,11 +93,31 @@ Swdb::Swdb(const std::string &path)
         return;
     }
 
+    if (options.readOnly) {
+        if (path_exists) {
+            try {
+                conn = std::make_shared<SQLite3>(path, options);
+                auto schemaVersion = Transformer::getSchemaVersion(conn);
+                if (schemaVersion == Transformer::getVersion()) {
+                    return;
+                }
+                logger->error(tfm::format(
+                    "History database schema %s needs a migration, using in-memory database instead",
+                    schemaVersion));
+            } catch (std::exception & ex) {
+                logger->error(tfm::format("History database is not readable, using in-memory database instead: %s", ex.what()));
+            }
+        }
+        conn = std::make_shared<SQLite3>(":memory:");
+        Transformer::createDatabase(conn);
+        return;
+    }
+
     if (path_exists) {
         if (geteuid() == 0) {
             // database exists, running under root
             try {
-                conn = std::make_shared<SQLite3>(path);
+                conn = std::make_shared<SQLite3>(path, options);
                 // execute an update to detect if the database is writable
                 conn->exec("BEGIN; UPDATE config SET value='test' WHERE key='test'; ROLLBACK;");
             } catch (SQLite3::Error & ex) {
@@ -97,7 +128,7 @@ Swdb::Swdb(const std::string &path)
         } else {
             // database exists, running under unprivileged user
             try {
-                conn = std::make_shared<SQLite3>(path);
+                conn = std::make_shared<SQLite3>(path, options);
                 // execute a select to detect if the database is readable
                 conn->exec("SELECT * FROM config WHERE key='test'");
             } catch (SQLite3::Error & ex) {
@@ -117,7 +148,7 @@ Swdb::Swdb(const std::string &path)
             try {
                 Transformer transformer(path.substr(0, found), path);
                 transformer.transform();
-                conn = std::make_shared<SQLite3>(path);
+                conn = std::make_shared<SQLite3>(path, options);
             } catch (SQLite3::Error & ex) {
                 // root must have the database writable -> log and re-throw the exception
                 logger->error(tfm::format("History database cannot be created: %s", ex.what()));
@@ -127,7 +158,7 @@ Swdb::Swdb(const std::string &path)
             try {
                 // database doesn't exist, running under unprivileged user
                 // connect to a new database and initialize it; old data is not migrated
-                conn = std::make_shared<SQLite3>(path);
+                conn = std::make_shared<SQLite3>(path, options);
                 Transformer::createDatabase(conn);
             } catch (SQLite3::Error & ex) {
                 // unpriviledged user may have insufficient permissions to create the database -> in-memory fallback
@@ -149,6 +180,7 @@ Swdb::resetDatabase()
     }
     conn->open();
     Transformer::createDatabase(conn);
+    historyCache = HistoryCache();
 }
 
 void
@@ -194,6 +226,7 @@ Swdb::beginTransaction(int64_t dtBegin,
     transactionInProgress->setUserId(userId);
     transactionInProgress->setComment(comment);
     transactionInProgress->begin();
+    LIBDNF_PROBE(swdb_transaction_begin, static_cast<long>(transactionInProgress->getId()));
 
     // save rpm items to map to resolve RPM callbacks
     for (auto item : transactionInProgress->getItems()) {
@@ -216,7 +249,14 @@ Swdb::endTransaction(int64_t dtEnd, std::string rpmdbVersionEnd, TransactionStat
     }
     transactionInProgress->setDtEnd(dtEnd);
     transactionInProgress->setRpmdbVersionEnd(rpmdbVersionEnd);
+    // finish() saves the states of all the items
+    LIBDNF_PROBE(swdb_transaction_end_start, static_cast<long>(transactionInProgress->getId()),
+                 static_cast<int>(state));
+    pendingItemStates.clear();
     transactionInProgress->finish(state);
+    LIBDNF_PROBE(swdb_transaction_end_done, static_cast<long>(transactionInProgress->getId()));
+    // the items of the transaction count in the history now
+    historyCache = HistoryCache();
     return transactionInProgress->getId();
 }
 
@@ -227,8 +267,10 @@ Swdb::closeTransaction()
         throw std::logic_error(_("Not in progress"));
     }
     int64_t result = transactionInProgress->getId();
+    flushItemStates();
     transactionInProgress = std::unique_ptr< swdb_private::Transaction >(nullptr);
     itemsInProgress.clear();
+    historyCache = HistoryCache();
     return result;
 }
 
@@ -255,7 +297,30 @@ Swdb::setItemDone(const std::string &nevra)
     }
     auto item = itemsInProgress[nevra];
     item->setState(TransactionItemState::DONE);
-    item->saveState();
+    if (itemStatesCheckpoint == 0) {
+        item->saveState();
+        return;
+    }
+    pendingItemStates.push_back(item);
+    if (pendingItemStates.size() >= itemStatesCheckpoint) {
+        flushItemStates();
+    }
+}
+
+void
+Swdb::flushItemStates()
+{
+    if (pendingItemStates.empty()) {
+        return;
+    }
+    LIBDNF_PROBE(swdb_flush_item_states_start, static_cast<long>(pendingItemStates.size()));
+    SQLite3::Transaction sqlTransaction(*conn);
+    for (auto &item : pendingItemStates) {
+        item->saveState();
+    }
+    sqlTransaction.commit();
+    pendingItemStates.clear();
+    LIBDNF_PROBE(swdb_flush_item_states_end);
 }
 
 TransactionItemReason
@@ -278,11 +343,58 @@ Swdb::resolveRPMTransactionItemReason(const std::string &name,
         }
     }
 
+    // the latest reason of a single arch is served from the cache
+    if (maxTransactionId < 0 && !arch.empty()) {
+        auto &reasons = getCachedReasons();
+        auto it = reasons.find(name + "." + arch);
+        return it == reasons.end() ? TransactionItemReason::UNKNOWN : it->second;
+    }
+
     return RPMItem::resolveTransactionItemReason(conn, name, arch, maxTransactionId);
 }
 
-const std::string
-Swdb::getRPMRepo(const std::string &nevra)
+void
+Swdb::refreshHistoryCache() const
+{
+    int64_t dataVersion = -1;
+    int64_t lastTransactionId = -1;
+    {
+        auto query = conn->getCachedQuery("PRAGMA data_version");
+        if (query->step() == SQLite3::Statement::StepResult::ROW) {
+            dataVersion = query->get< int64_t >(0);
+        }
+    }
+    {
+        auto query = conn->getCachedQuery("SELECT MAX(id) FROM trans");
+        if (query->step() == SQLite3::Statement::StepResult::ROW) {
+            lastTransactionId = query->get< int64_t >(0);
+        }
+    }
+    if (dataVersion != historyCache.dataVersion ||
+        lastTransactionId != historyCache.lastTransactionId) {
+        historyCache = HistoryCache();
+        historyCache.dataVersion = dataVersion;
+        historyCache.lastTransactionId = lastTransactionId;
+    }
+}
+
+const std::unordered_map< std::string, TransactionItemReason > &
+Swdb::getCachedReasons() const
+{
+    refreshHistoryCache();
+    if (!historyCache.reasonsLoaded) {
+        historyCache.reasons = RPMItem::resolveTransactionItemReasons(conn);
+        historyCache.reasonsLoaded = true;
+    }
+    return historyCache.reasons;
+}
+
+/**
+ * Parses the NEVRA into the key of the cached repos, with the epoch 0 when it is not given.
+ * Returns an empty string when the NEVRA does not parse.
+ */
+static std::string
+rpmRepoKey(const std::string &nevra)
 {
     Nevra nevraObject;
     if (!nevraObject.parse(nevra.c_str(), HY_FORM_NEVRA)) {
@@ -293,6 +405,65 @@ Swdb::getRPMRepo(const std::string &nevra)
     if (nevraObject.getEpoch() < 0) {
         nevraObject.setEpoch(0);
     }
+    return nevraObject.getName() + "-" + nevraObject.getEvr() + "." + nevraObject.getArch();
+}
+
+void
+Swdb::loadRPMRepos() const
+{
+    // the latest item of each nevra wins, as in getRPMRepo()
+    const char *sql = R"**(
+        SELECT
+            rpm.name,
+            rpm.epoch,
+            rpm.version,
+            rpm.release,
+            rpm.arch,
+            repo.repoid
+        FROM
+            trans_item ti
+        JOIN
+            rpm USING (item_id)
+        JOIN
+            repo ON ti.repo_id == repo.id
+        WHERE
+            ti.action not in (3, 5, 7, 10)
+        ORDER BY
+            ti.id ASC
+    )**";
+    SQLite3::Query query(*conn, sql);
+    historyCache.repos.clear();
+    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        auto key = query.get< std::string >(0) + "-" + std::to_string(query.get< int >(1)) + ":" +
+                   query.get< std::string >(2) + "-" + query.get< std::string >(3) + "." +
+                   query.get< std::string >(4);
+        historyCache.repos[key] = query.get< std::string >(5);
+    }
+    historyCache.reposLoaded = true;
+}
+
+const std::string
+Swdb::getRPMRepo(const std::string &nevra)
+{
+    refreshHistoryCache();
+
+    auto key = rpmRepoKey(nevra);
+    if (key.empty()) {
+        return "";
+    }
+    auto cached = historyCache.repos.find(key);
+    if (cached != historyCache.repos.end()) {
+        return cached->second;
+    }
+    if (historyCache.reposLoaded) {
+        return "";
+    }
+
+    Nevra nevraObject;
+    nevraObject.parse(nevra.c_str(), HY_FORM_NEVRA);
+    if (nevraObject.getEpoch() < 0) {
+        nevraObject.setEpoch(0);
+    }
 
     const char *sql = R"**(
         SELECT
@@ -315,17 +486,36 @@ Swdb::getRPMRepo(const std::string &nevra)
         LIMIT 1;
     )**";
     // TODO: where trans.done != 0
-    SQLite3::Query query(*conn, sql);
-    query.bindv(nevraObject.getName(),
-                nevraObject.getEpoch(),
-                nevraObject.getVersion(),
-                nevraObject.getRelease(),
-                nevraObject.getArch());
-    if (query.step() == SQLite3::Statement::StepResult::ROW) {
-        auto repoid = query.get< std::string >("repoid");
-        return repoid;
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(nevraObject.getName(),
+                 nevraObject.getEpoch(),
+                 nevraObject.getVersion(),
+                 nevraObject.getRelease(),
+                 nevraObject.getArch());
+    std::string repoid;
+    if (query->step() == SQLite3::Statement::StepResult::ROW) {
+        repoid = query->get< std::string >("repoid");
     }
-    return "";
+    historyCache.repos.emplace(key, repoid);
+    return repoid;
+}
+
+std::map< std::string, std::string >
+Swdb::getRPMRepos(const std::vector< std::string > &nevras)
+{
+    refreshHistoryCache();
+    if (!historyCache.reposLoaded) {
+        loadRPMRepos();
+    }
+
+    std::map< std::string, std::string > result;
+    for (const auto &nevra : nevras) {
+        auto cached = historyCache.repos.find(rpmRepoKey(nevra));
+        if (cached != historyCache.repos.end() && !cached->second.empty()) {
+            result.emplace(nevra, cached->second);
+        }
+    }
+    return result;
 }
 
 TransactionItemPtr
@@ -360,18 +550,55 @@ Swdb::listTransactions()
 {
     const char *sql = R"**(
         SELECT
-            id
+            *
         FROM
             trans
         ORDER BY
             id
     )**";
-    SQLite3::Statement query(*conn, sql);
+    SQLite3::Query query(*conn, sql);
     std::vector< TransactionPtr > result;
     while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        auto transId = query.get< int64_t >(0);
-        auto transaction = std::make_shared< Transaction >(conn, transId);
-        result.push_back(transaction);
+        result.push_back(TransactionPtr(new Transaction(conn, query)));
+    }
+    return result;
+}
+
+std::vector< TransactionPtr >
+Swdb::listTransactions(int64_t cursor, std::size_t limit, bool newestFirst)
+{
+    const char *sql = R"**(
+        SELECT
+            *
+        FROM
+            trans
+        WHERE
+            id > ?
+        ORDER BY
+            id
+        LIMIT ?
+    )**";
+    const char *sqlNewestFirst = R"**(
+        SELECT
+            *
+        FROM
+            trans
+        WHERE
+            id < ?
+        ORDER BY
+            id DESC
+        LIMIT ?
+    )**";
+    if (newestFirst && cursor <= 0) {
+        // start with the last transaction
+        cursor = std::numeric_limits< int64_t >::max();
+    }
+    auto query = conn->getCachedQuery(newestFirst ? sqlNewestFirst : sql);
+    // LIMIT -1 means no limit
+    query->bindv(cursor, limit == 0 ? int64_t(-1) : static_cast< int64_t >(limit));
+    std::vector< TransactionPtr > result;
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
+        result.push_back(TransactionPtr(new Transaction(conn, *query)));
     }
     return result;
 }
@@ -401,82 +628,198 @@ Swdb::getCompsGroupItem(const std::string &groupid)
     return CompsGroupItem::getTransactionItem(conn, groupid);
 }
 
+// lowercase ASCII like the case insensitive LIKE of SQLite
+static std::string
+compsIndexKey(const std::string &value)
+{
+    std::string key(value);
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+        return c < 0x80 ? std::tolower(c) : c;
+    });
+    return key;
+}
+
+void
+Swdb::CompsIndex::add(std::string id, std::string name, std::string translatedName)
+{
+    auto index = entries.size();
+    for (auto value : {&id, &name, &translatedName}) {
+        auto &indexes = exact[compsIndexKey(*value)];
+        if (indexes.empty() || indexes.back() != index) {
+            indexes.push_back(index);
+        }
+    }
+    entries.push_back({std::move(id), std::move(name), std::move(translatedName)});
+}
+
+/// Returns the distinct ids with the id, name or translated name matching the LIKE pattern
+/// in which '*' is an alias of '%'
+std::vector< std::string >
+Swdb::CompsIndex::match(const std::string &pattern) const
+{
+    std::vector< std::string > result;
+    std::set< std::string > seen;
+    auto addEntry = [&](const Entry &entry) {
+        if (seen.insert(entry.id).second) {
+            result.push_back(entry.id);
+        }
+    };
+
+    if (pattern.find_first_of("*%_") == std::string::npos) {
+        auto it = exact.find(compsIndexKey(pattern));
+        if (it != exact.end()) {
+            for (auto index : it->second) {
+                addEntry(entries[index]);
+            }
+        }
+        return result;
+    }
+
+    std::string glob;
+    for (auto c : pattern) {
+        if (c == '*' || c == '%') {
+            glob += '*';
+        } else if (c == '_') {
+            glob += '?';
+        } else {
+            if (c == '?' || c == '[' || c == ']' || c == '\\') {
+                glob += '\\';
+            }
+            glob += c;
+        }
+    }
+    for (const auto &entry : entries) {
+        if (fnmatch(glob.c_str(), entry.id.c_str(), FNM_CASEFOLD) == 0 ||
+            fnmatch(glob.c_str(), entry.name.c_str(), FNM_CASEFOLD) == 0 ||
+            fnmatch(glob.c_str(), entry.translatedName.c_str(), FNM_CASEFOLD) == 0) {
+            addEntry(entry);
+        }
+    }
+    return result;
+}
+
+void
+Swdb::loadCompsIndexes() const
+{
+    refreshHistoryCache();
+    if (historyCache.compsLoaded) {
+        return;
+    }
+    {
+        SQLite3::Query query(*conn, "SELECT groupid, name, translated_name FROM comps_group ORDER BY item_id");
+        while (query.step() == SQLite3::Statement::StepResult::ROW) {
+            historyCache.groups.add(query.get< std::string >("groupid"),
+                                    query.get< std::string >("name"),
+                                    query.get< std::string >("translated_name"));
+        }
+    }
+    {
+        SQLite3::Query query(*conn, "SELECT environmentid, name, translated_name FROM comps_environment ORDER BY item_id");
+        while (query.step() == SQLite3::Statement::StepResult::ROW) {
+            historyCache.environments.add(query.get< std::string >("environmentid"),
+                                          query.get< std::string >("name"),
+                                          query.get< std::string >("translated_name"));
+        }
+    }
+    historyCache.compsLoaded = true;
+}
+
 std::vector< TransactionItemPtr >
 Swdb::getCompsGroupItemsByPattern(const std::string &pattern)
 {
-    return CompsGroupItem::getTransactionItemsByPattern(conn, pattern);
+    loadCompsIndexes();
+    // HACK: create a private connection to avoid undefined behavior
+    // after forking process in Anaconda
+    auto itemsConn = conn;
+    if (itemsConn->getPath() != ":memory:") {
+        itemsConn = std::make_shared< SQLite3 >(itemsConn->getPath());
+    }
+    std::vector< TransactionItemPtr > result;
+    for (const auto &groupid : historyCache.groups.match(pattern)) {
+        auto trans_item = CompsGroupItem::getTransactionItem(itemsConn, groupid);
+        if (trans_item) {
+            result.push_back(trans_item);
+        }
+    }
+    return result;
 }
 
 std::vector< std::string >
 Swdb::getPackageCompsGroups(const std::string &packageName)
 {
-    const char *sql_all_groups = R"**(
-        SELECT DISTINCT
-            g.groupid
-        FROM
-            comps_group g
-        JOIN
-            comps_group_package p ON p.group_id = g.item_id
-        WHERE
-            p.name = ?
-            AND p.installed = 1
-        ORDER BY
-            g.groupid
-    )**";
+    auto groups = getPackagesCompsGroups({packageName});
+    return groups[packageName];
+}
 
-    const char *sql_trans_items = R"**(
+std::map< std::string, std::vector< std::string > >
+Swdb::getPackagesCompsGroups(const std::vector< std::string > &packageNames)
+{
+    // the groups with an installed package of the name, unless the last finished transaction
+    // item of the group is its removal or the group item has no installed package at all
+    const char *sql_packages_groups = R"**(
+        WITH candidate AS (
+            SELECT DISTINCT
+                p.name,
+                g.groupid
+            FROM
+                comps_group g
+            JOIN
+                comps_group_package p ON p.group_id = g.item_id
+            WHERE
+                p.name IN (%s)
+                AND p.installed = 1
+        ), latest AS (
+            SELECT
+                i.groupid,
+                i.item_id,
+                ti.action,
+                ROW_NUMBER() OVER (PARTITION BY i.groupid ORDER BY ti.trans_id DESC) AS position
+            FROM
+                trans_item ti
+            JOIN
+                comps_group i USING (item_id)
+            JOIN
+                trans t ON ti.trans_id = t.id
+            WHERE
+                t.state = 1
+                AND ti.action not in (3, 5, 7)
+                AND i.groupid IN (SELECT groupid FROM candidate)
+        )
         SELECT
-            ti.action as action,
-            ti.reason as reason,
-            i.item_id as group_id
+            c.name,
+            c.groupid
         FROM
-            trans_item ti
+            candidate c
         JOIN
-            comps_group i USING (item_id)
-        JOIN
-            trans t ON ti.trans_id = t.id
+            latest l ON l.groupid = c.groupid AND l.position = 1
         WHERE
-            t.state = 1
-            AND ti.action not in (3, 5, 7)
-            AND i.groupid = ?
+            l.action != ?
+            AND EXISTS (
+                SELECT 1 FROM comps_group_package p WHERE p.group_id = l.item_id AND p.installed = 1
+            )
         ORDER BY
-            ti.trans_id DESC
-        LIMIT 1
-    )**";
-
-    const char *sql_group_package = R"**(
-        SELECT
-            p.name
-        FROM
-            comps_group_package p
-        WHERE
-            p.group_id = ?
-            AND p.installed = 1
+            c.name,
+            c.groupid
     )**";
 
-    std::vector< std::string > result;
+    // stay well below SQLITE_MAX_VARIABLE_NUMBER
+    const size_t maxNamesPerQuery = 500;
 
-    // list all relevant groups
-    SQLite3::Query query_all_groups(*conn, sql_all_groups);
-    query_all_groups.bindv(packageName);
-
-    while (query_all_groups.step() == SQLite3::Statement::StepResult::ROW) {
-        auto groupid = query_all_groups.get< std::string >("groupid");
-        SQLite3::Query query_trans_items(*conn, sql_trans_items);
-        query_trans_items.bindv(groupid);
-        if (query_trans_items.step() == SQLite3::Statement::StepResult::ROW) {
-            auto action =
-                static_cast< TransactionItemAction >(query_trans_items.get< int64_t >("action"));
-            // if the last record is group removal, skip
-            if (action == TransactionItemAction::REMOVE) {
-                continue;
-            }
-            auto groupId = query_trans_items.get< int64_t >("group_id");
-            SQLite3::Query query_group_package(*conn, sql_group_package);
-            query_group_package.bindv(groupId);
-            if (query_group_package.step() == SQLite3::Statement::StepResult::ROW) {
-                result.push_back(groupid);
-            }
+    std::map< std::string, std::vector< std::string > > result;
+    for (size_t first = 0; first < packageNames.size(); first += maxNamesPerQuery) {
+        size_t count = std::min(maxNamesPerQuery, packageNames.size() - first);
+        std::string placeholders("?");
+        for (size_t i = 1; i < count; ++i) {
+            placeholders += ", ?";
+        }
+        SQLite3::Query query(*conn, tfm::format(sql_packages_groups, placeholders));
+        int pos = 1;
+        for (size_t i = first; i < first + count; ++i) {
+            query.bind(pos++, packageNames[i]);
+        }
+        query.bind(pos, static_cast< int >(TransactionItemAction::REMOVE));
+        while (query.step() == SQLite3::Statement::StepResult::ROW) {
+            result[query.get< std::string >("name")].push_back(query.get< std::string >("groupid"));
         }
     }
     return result;
@@ -485,74 +828,55 @@ Swdb::getPackageCompsGroups(const std::string &packageName)
 std::vector< std::string >
 Swdb::getCompsGroupEnvironments(const std::string &groupId)
 {
-    const char *sql_all_environments = R"**(
-        SELECT DISTINCT
-            e.environmentid
-        FROM
-            comps_environment e
-        JOIN
-            comps_environment_group g ON g.environment_id = e.item_id
-        WHERE
-            g.groupid = ?
-            AND g.installed = 1
-        ORDER BY
-            e.environmentid
-    )**";
-
-    const char *sql_trans_items = R"**(
+    // the environments with the installed group, unless the last finished transaction item of
+    // the environment is its removal or the environment item has no installed group at all
+    const char *sql_group_environments = R"**(
+        WITH candidate AS (
+            SELECT DISTINCT
+                e.environmentid
+            FROM
+                comps_environment e
+            JOIN
+                comps_environment_group g ON g.environment_id = e.item_id
+            WHERE
+                g.groupid = ?
+                AND g.installed = 1
+        ), latest AS (
+            SELECT
+                i.environmentid,
+                i.item_id,
+                ti.action,
+                ROW_NUMBER() OVER (PARTITION BY i.environmentid ORDER BY ti.trans_id DESC) AS position
+            FROM
+                trans_item ti
+            JOIN
+                comps_environment i USING (item_id)
+            JOIN
+                trans t ON ti.trans_id = t.id
+            WHERE
+                t.state = 1
+                AND ti.action not in (3, 5, 7)
+                AND i.environmentid IN (SELECT environmentid FROM candidate)
+        )
         SELECT
-            ti.action as action,
-            ti.reason as reason,
-            i.item_id as environment_id
+            l.environmentid
         FROM
-            trans_item ti
-        JOIN
-            comps_environment i USING (item_id)
-        JOIN
-            trans t ON ti.trans_id = t.id
+            latest l
         WHERE
-            t.state = 1
-            AND ti.action not in (3, 5, 7)
-            AND i.environmentid = ?
+            l.position = 1
+            AND l.action != ?
+            AND EXISTS (
+                SELECT 1 FROM comps_environment_group g WHERE g.environment_id = l.item_id AND g.installed = 1
+            )
         ORDER BY
-            ti.trans_id DESC
-        LIMIT 1
-    )**";
-
-    const char *sql_environment_group = R"**(
-        SELECT
-            g.groupid
-        FROM
-            comps_environment_group g
-        WHERE
-            g.environment_id = ?
-            AND g.installed = 1
+            l.environmentid
     )**";
 
     std::vector< std::string > result;
-
-    // list all relevant groups
-    SQLite3::Query query_all_environments(*conn, sql_all_environments);
-    query_all_environments.bindv(groupId);
-
-    while (query_all_environments.step() == SQLite3::Statement::StepResult::ROW) {
-        auto envid = query_all_environments.get< std::string >("environmentid");
-        SQLite3::Query query_trans_items(*conn, sql_trans_items);
-        query_trans_items.bindv(envid);
-        if (query_trans_items.step() == SQLite3::Statement::StepResult::ROW) {
-            auto action =
-                static_cast< TransactionItemAction >(query_trans_items.get< int64_t >("action"));
-            // if the last record is group removal, skip
-            if (action == TransactionItemAction::REMOVE) {
-                continue;
-            }
-            auto envId = query_trans_items.get< int64_t >("environment_id");
-            SQLite3::Query query_environment_group(*conn, sql_environment_group);
-            query_environment_group.bindv(envId);
-            if (query_environment_group.step() == SQLite3::Statement::StepResult::ROW) {
-                result.push_back(envid);
-            }
-        }
+    SQLite3::Query query(*conn, sql_group_environments);
+    query.bindv(groupId, static_cast< int >(TransactionItemAction::REMOVE));
+    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        result.push_back(query.get< std::string >("environmentid"));
     }
     return result;
 }
@@ -566,7 +890,21 @@ Swdb::getCompsEnvironmentItem(const std::string &envid)
 std::vector< TransactionItemPtr >
 Swdb::getCompsEnvironmentItemsByPattern(const std::string &pattern)
 {
-    return CompsEnvironmentItem::getTransactionItemsByPattern(conn, pattern);
+    loadCompsIndexes();
+    // HACK: create a private connection to avoid undefined behavior
+    // after forking process in Anaconda
+    auto itemsConn = conn;
+    if (itemsConn->getPath() != ":memory:") {
+        itemsConn = std::make_shared< SQLite3 >(itemsConn->getPath());
+    }
+    std::vector< TransactionItemPtr > result;
+    for (const auto &envid : historyCache.environments.match(pattern)) {
+        auto trans_item = CompsEnvironmentItem::getTransactionItem(itemsConn, envid);
+        if (trans_item) {
+            result.push_back(trans_item);
+        }
+    }
+    return result;
 }
 
 RPMItemPtr
@@ -597,18 +935,24 @@ Swdb::filterUserinstalled(PackageSet & installed) const
 {
     Pool * pool = dnf_sack_get_pool(installed.getSack());
 
+    // one query for the whole history instead of one per package
+    auto &reasons = getCachedReasons();
+    std::string key;
+
     // iterate over solvables
     Id id = -1;
     while ((id = installed.next(id)) != -1) {
 
         Solvable *s = pool_id2solvable(pool, id);
-        const char *name = pool_id2str(pool, s->name);
-        const char *arch = pool_id2str(pool, s->arch);
+        key.assign(pool_id2str(pool, s->name)).append(1, '.').append(pool_id2str(pool, s->arch));
 
-        auto reason = RPMItem::resolveTransactionItemReason(conn, name, arch, -1);
+        auto it = reasons.find(key);
+        if (it == reasons.end()) {
+            continue;
+        }
         // if not dep or weak, than consider it user installed
-        if (reason == TransactionItemReason::DEPENDENCY ||
-            reason == TransactionItemReason::WEAK_DEPENDENCY) {
+        if (it->second == TransactionItemReason::DEPENDENCY ||
+            it->second == TransactionItemReason::WEAK_DEPENDENCY) {
             installed.remove(id);
         }
     }
@@ -25,6 +25,7 @@
 #include <memory>
 #include <solv/pooltypes.h>
 #include <sys/stat.h>
+#include <unordered_map>
 #include <vector>
 
 namespace libdnf {
@@ -48,6 +49,16 @@ struct Swdb {
 public:
     explicit Swdb(SQLite3Ptr conn);
     explicit Swdb(const std::string &path);
+
+    /**
+    * @brief Open the history database with the given connection options
+    *
+    * With options.readOnly the database is opened without the write probe and, when its schema
+    * is current, without a schema migration, so it can be read while another process writes
+    * to it. A database which is missing, unreadable or needs a migration is replaced
+    * by an empty in-memory one.
+    */
+    Swdb(const std::string &path, const SQLite3::Options &options);
     ~Swdb();
 
     SQLite3Ptr getConn() { return conn; }
@@ -77,6 +88,17 @@ public:
     std::vector< TransactionPtr >
     listTransactions(); // std::vector<long long> transactionIds);
 
+    /**
+    * @brief List a page of the history
+    *
+    * Returns at most limit transactions (0 means no limit) following the one with id cursor,
+    * ordered by id; pass the id of the last returned transaction to get the next page.
+    * With newestFirst the order is reversed and a cursor <= 0 starts at the last transaction.
+    * Only the transaction headers are read, the items are loaded by Transaction::getItems().
+    */
+    std::vector< TransactionPtr >
+    listTransactions(int64_t cursor, std::size_t limit, bool newestFirst = false);
+
     TransactionPtr getCurrent() { return std::dynamic_pointer_cast<Transaction>(transactionInProgress); }
 
     // TransactionItems
@@ -89,6 +111,16 @@ public:
     // TODO: remove; TransactionItem states are saved on transaction save
     void setItemDone(const std::string &nevra);
 
+    /**
+    * @brief Coalesce the state updates of setItemDone()
+    *
+    * With a non-zero count the states are kept in memory and written in one SQLite
+    * transaction once count of them are pending, and when the transaction ends.
+    * The default 0 writes every state right away.
+    */
+    void setItemStatesCheckpoint(std::size_t count) { itemStatesCheckpoint = count; }
+    void flushItemStates();
+
     // Item: constructors
     RPMItemPtr createRPMItem();
     CompsGroupItemPtr createCompsGroupItem();
@@ -99,6 +131,12 @@ public:
                                                           const std::string &arch,
                                                           int64_t maxTransactionId);
     const std::string getRPMRepo(const std::string &nevra);
+
+    /**
+    * @brief Returns the repoids of the given NEVRAs, loaded for all the packages in the history
+    * with one query. NEVRAs with no repo in the history are not in the result.
+    */
+    std::map< std::string, std::string > getRPMRepos(const std::vector< std::string > &nevras);
     TransactionItemPtr getRPMTransactionItem(const std::string &nevra);
     std::vector< int64_t > searchTransactionsByRPM(const std::vector< std::string > &patterns);
 
@@ -106,6 +144,8 @@ public:
     TransactionItemPtr getCompsGroupItem(const std::string &groupid);
     std::vector< TransactionItemPtr > getCompsGroupItemsByPattern(const std::string &pattern);
     std::vector< std::string > getPackageCompsGroups(const std::string &packageName);
+    std::map< std::string, std::vector< std::string > >
+    getPackagesCompsGroups(const std::vector< std::string > &packageNames);
 
     // Item: CompsEnvironment
     TransactionItemPtr getCompsEnvironmentItem(const std::string &envid);
@@ -131,6 +171,47 @@ protected:
     std::map< std::string, TransactionItemPtr > itemsInProgress;
 
 private:
+    std::size_t itemStatesCheckpoint{0};
+    std::vector< TransactionItemPtr > pendingItemStates;
+
+    // The ids, names and translated names of the comps groups or environments for
+    // the pattern searches
+    struct CompsIndex {
+        struct Entry {
+            std::string id;
+            std::string name;
+            std::string translatedName;
+        };
+        std::vector< Entry > entries;
+        // entries by the lowercase id, name and translated name
+        std::unordered_map< std::string, std::vector< std::size_t > > exact;
+
+        void add(std::string id, std::string name, std::string translatedName);
+        std::vector< std::string > match(const std::string &pattern) const;
+    };
+
+    // Results resolved from the history. They are valid while the highest transaction id and
+    // the data_version of the database stay the same, the latter changes with writes done
+    // by other connections.
+    struct HistoryCache {
+        int64_t dataVersion{-1};
+        int64_t lastTransactionId{-1};
+        bool reasonsLoaded{false};
+        // latest reasons by "name.arch"
+        std::unordered_map< std::string, TransactionItemReason > reasons;
+        // repoids by nevra with the epoch, e.g. "bash-0:4.4.12-5.fc26.x86_64"
+        bool reposLoaded{false};
+        std::unordered_map< std::string, std::string > repos;
+        bool compsLoaded{false};
+        CompsIndex groups;
+        CompsIndex environments;
+    };
+    mutable HistoryCache historyCache;
+
+    void refreshHistoryCache() const;
+    const std::unordered_map< std::string, TransactionItemReason > & getCachedReasons() const;
+    void loadCompsIndexes() const;
+    void loadRPMRepos() const;
 };
 
 } // namespace libdnf
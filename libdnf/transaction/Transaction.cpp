@@ -24,6 +24,10 @@
 #include "RPMItem.hpp"
 #include "TransactionItem.hpp"
 
+#include <gio/gio.h>
+
+#include <stdexcept>
+
 namespace libdnf {
 
 Transaction::Transaction(SQLite3Ptr conn, int64_t pk)
@@ -37,6 +41,12 @@ Transaction::Transaction(SQLite3Ptr conn)
 {
 }
 
+Transaction::Transaction(SQLite3Ptr conn, SQLite3::Query &query)
+  : conn{conn}
+{
+    dbLoad(query);
+}
+
 bool
 Transaction::operator==(const Transaction &other) const
 {
@@ -75,6 +85,7 @@ Transaction::dbSelect(int64_t pk)
 {
     const char *sql =
         "SELECT "
+        "  id, "
         "  dt_begin, "
         "  dt_end, "
         "  rpmdb_version_begin, "
@@ -92,7 +103,15 @@ Transaction::dbSelect(int64_t pk)
     query.bindv(pk);
     query.step();
 
+    dbLoad(query);
+    // keep the requested id even if there is no such transaction
     id = pk;
+}
+
+void
+Transaction::dbLoad(SQLite3::Query &query)
+{
+    id = query.get< int64_t >("id");
     dtBegin = query.get< int >("dt_begin");
     dtEnd = query.get< int >("dt_end");
     rpmdbVersionBegin = query.get< std::string >("rpmdb_version_begin");
@@ -124,6 +143,44 @@ Transaction::getItems()
     return result;
 }
 
+/**
+ * Count the transaction items of each action, the items themselves are not loaded.
+ * \return number of the items keyed by their action, actions without items are missing
+ */
+std::map< TransactionItemAction, int64_t >
+Transaction::getItemCounts() const
+{
+    const char *sql = R"**(
+        SELECT
+            action,
+            COUNT(*)
+        FROM
+            trans_item
+        WHERE
+            trans_id = ?
+        GROUP BY
+            action
+    )**";
+
+    std::map< TransactionItemAction, int64_t > counts;
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(getId());
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
+        counts[static_cast< TransactionItemAction >(query->get< int >(0))] =
+            query->get< int64_t >(1);
+    }
+    return counts;
+}
+
+/**
+ * Load the rpm items of the transaction into columns, see RPMItemColumns.
+ */
+RPMItemColumns
+Transaction::getRPMItemColumns() const
+{
+    return RPMItem::getTransactionItemColumns(conn, getId());
+}
+
 /**
  * Load list of software performed with for current transaction from the database.
  * Transaction has to be saved in advance, otherwise empty list will be returned.
@@ -153,6 +210,98 @@ Transaction::getSoftwarePerformedWith() const
     return software;
 }
 
+static std::vector< unsigned char >
+convertData(GConverter *converter, const unsigned char *data, std::size_t size)
+{
+    std::vector< unsigned char > result;
+    unsigned char buffer[16384];
+    GConverterResult status;
+    do {
+        gsize bytesRead = 0;
+        gsize bytesWritten = 0;
+        g_autoptr(GError) error = nullptr;
+        status = g_converter_convert(converter,
+                                     data,
+                                     size,
+                                     buffer,
+                                     sizeof(buffer),
+                                     G_CONVERTER_INPUT_AT_END,
+                                     &bytesRead,
+                                     &bytesWritten,
+                                     &error);
+        if (status == G_CONVERTER_ERROR) {
+            throw std::runtime_error(std::string("Console output conversion failed: ") +
+                                     error->message);
+        }
+        data += bytesRead;
+        size -= bytesRead;
+        result.insert(result.end(), buffer, buffer + bytesWritten);
+    } while (status != G_CONVERTER_FINISHED);
+    return result;
+}
+
+static void
+appendUint32(std::string &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast< char >((value >> (8 * i)) & 0xff));
+    }
+}
+
+static uint32_t
+readUint32(const unsigned char *data)
+{
+    return static_cast< uint32_t >(data[0]) | static_cast< uint32_t >(data[1]) << 8 |
+           static_cast< uint32_t >(data[2]) << 16 | static_cast< uint32_t >(data[3]) << 24;
+}
+
+/**
+ * Serialize console output lines into a zlib compressed block.
+ * Each line is stored as little endian 32 bit file descriptor and length followed by the text.
+ * \param lines file descriptor and text of the lines
+ * \return compressed block
+ */
+std::vector< unsigned char >
+Transaction::packConsoleOutput(const ConsoleOutput &lines)
+{
+    std::string plain;
+    for (const auto &line : lines) {
+        appendUint32(plain, static_cast< uint32_t >(line.first));
+        appendUint32(plain, static_cast< uint32_t >(line.second.size()));
+        plain += line.second;
+    }
+    g_autoptr(GZlibCompressor) compressor = g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB, -1);
+    return convertData(G_CONVERTER(compressor),
+                       reinterpret_cast< const unsigned char * >(plain.data()),
+                       plain.size());
+}
+
+/**
+ * Append the lines stored in a block created by packConsoleOutput()
+ * \param data compressed block
+ * \param size size of the block
+ * \param lines lines are appended here
+ */
+void
+Transaction::unpackConsoleOutput(const void *data, std::size_t size, ConsoleOutput &lines)
+{
+    g_autoptr(GZlibDecompressor) decompressor = g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+    auto plain = convertData(
+        G_CONVERTER(decompressor), static_cast< const unsigned char * >(data), size);
+    std::size_t pos = 0;
+    while (pos + 8 <= plain.size()) {
+        auto fileDescriptor = static_cast< int >(readUint32(&plain[pos]));
+        auto length = readUint32(&plain[pos + 4]);
+        pos += 8;
+        if (length > plain.size() - pos) {
+            throw std::runtime_error("Console output block is truncated");
+        }
+        lines.emplace_back(fileDescriptor,
+                           std::string(reinterpret_cast< const char * >(&plain[pos]), length));
+        pos += length;
+    }
+}
+
 std::vector< std::pair< int, std::string > >
 Transaction::getConsoleOutput() const
 {
@@ -175,6 +324,24 @@ Transaction::getConsoleOutput() const
         auto line = query.get< std::string >("line");
         result.push_back(std::make_pair(fileDescriptor, line));
     }
+
+    // the blocks are decompressed only when the output is requested
+    const char *blockSql = R"**(
+        SELECT
+            data
+        FROM
+            console_output_block
+        WHERE
+            trans_id = ?
+        ORDER BY
+            id
+    )**";
+    SQLite3::Query blockQuery(*conn, blockSql);
+    blockQuery.bindv(getId());
+    while (blockQuery.step() == SQLite3::Statement::StepResult::ROW) {
+        auto block = blockQuery.get< SQLite3::Blob >(0);
+        unpackConsoleOutput(block.data, block.size, result);
+    }
     return result;
 }
 
@@ -21,13 +21,17 @@
 #ifndef LIBDNF_TRANSACTION_TRANSACTION_HPP
 #define LIBDNF_TRANSACTION_TRANSACTION_HPP
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "../utils/sqlite3/Sqlite3.hpp"
 
 namespace libdnf {
+class RPMItemColumns;
 class Transaction;
 typedef std::shared_ptr< Transaction > TransactionPtr;
 }
@@ -59,15 +63,27 @@ public:
     const std::string &getComment() const noexcept { return comment; }
 
     virtual std::vector< TransactionItemPtr > getItems();
+    // Number of the items of each action, for summaries which need no other item data.
+    std::map< TransactionItemAction, int64_t > getItemCounts() const;
+    RPMItemColumns getRPMItemColumns() const;
     const std::set< std::shared_ptr< RPMItem > > getSoftwarePerformedWith() const;
     std::vector< std::pair< int, std::string > > getConsoleOutput() const;
 
 protected:
     explicit Transaction(SQLite3Ptr conn);
+    // load from the current row of a query selecting the columns of the trans table
+    Transaction(SQLite3Ptr conn, SQLite3::Query &query);
     void dbSelect(int64_t transaction_id);
+    void dbLoad(SQLite3::Query &query);
+
+    // console output lines are stored as compressed blocks
+    typedef std::vector< std::pair< int, std::string > > ConsoleOutput;
+    static std::vector< unsigned char > packConsoleOutput(const ConsoleOutput &lines);
+    static void unpackConsoleOutput(const void *data, std::size_t size, ConsoleOutput &lines);
     std::set< std::shared_ptr< RPMItem > > softwarePerformedWith;
 
     friend class TransactionItem;
+    friend struct Swdb;
     SQLite3Ptr conn;
 
     int64_t id = 0;
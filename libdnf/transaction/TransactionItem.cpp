@@ -162,14 +162,14 @@ TransactionItem::dbInsert()
     )**";
 
     // save the transaction item
-    SQLite3::Statement query(*(conn.get()), sql);
-    query.bindv(trans->getId(),
-                getItem()->getId(),
-                swdb_private::Repo::getCached(conn, getRepoid())->getId(),
-                static_cast< int >(getAction()),
-                static_cast< int >(getReason()),
-                static_cast< int >(getState()));
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(trans->getId(),
+                 getItem()->getId(),
+                 swdb_private::Repo::getCached(conn, getRepoid())->getId(),
+                 static_cast< int >(getAction()),
+                 static_cast< int >(getReason()),
+                 static_cast< int >(getState()));
+    query->step();
     setId(conn->lastInsertRowID());
 }
 
@@ -180,15 +180,15 @@ TransactionItem::saveReplacedBy()
         return;
     }
     const char *sql = "INSERT OR REPLACE INTO item_replaced_by VALUES (?, ?)";
-    SQLite3::Statement replacedByQuery(*(conn.get()), sql);
+    auto replacedByQuery = conn->getCachedQuery(sql);
     bool first = true;
     for (const auto &newItem : replacedBy) {
         if (!first) {
             // reset the prepared statement, so it can be executed again
-            replacedByQuery.reset();
+            replacedByQuery->reset();
         }
-        replacedByQuery.bindv(getId(), newItem->getId());
-        replacedByQuery.step();
+        replacedByQuery->bindv(getId(), newItem->getId());
+        replacedByQuery->step();
         first = false;
     }
 }
@@ -205,9 +205,9 @@ TransactionItem::saveState()
           id = ?
     )**";
 
-    SQLite3::Statement query(*conn, sql);
-    query.bindv(static_cast< int >(getState()), getId());
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(static_cast< int >(getState()), getId());
+    query->step();
 }
 
 void
@@ -231,15 +231,15 @@ TransactionItem::dbUpdate()
           id = ?
     )**";
 
-    SQLite3::Statement query(*(conn.get()), sql);
-    query.bindv(trans->getId(),
-                getItem()->getId(),
-                swdb_private::Repo::getCached(trans->conn, getRepoid())->getId(),
-                static_cast< int >(getAction()),
-                static_cast< int >(getReason()),
-                static_cast< int >(getState()),
-                getId());
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(trans->getId(),
+                 getItem()->getId(),
+                 swdb_private::Repo::getCached(trans->conn, getRepoid())->getId(),
+                 static_cast< int >(getAction()),
+                 static_cast< int >(getReason()),
+                 static_cast< int >(getState()),
+                 getId());
+    query->step();
 }
 
 uint32_t
@@ -53,6 +53,14 @@ static const char * const sql_migrate_tables_1_2 =
 #include "sql/migrate_tables_1_2.sql"
     ;
 
+static const char * const sql_migrate_tables_1_3 =
+#include "sql/migrate_tables_1_3.sql"
+    ;
+
+static const char * const sql_migrate_tables_1_4 =
+#include "sql/migrate_tables_1_4.sql"
+    ;
+
 void
 Transformer::createDatabase(SQLite3Ptr conn)
 {
@@ -63,18 +71,28 @@ Transformer::createDatabase(SQLite3Ptr conn)
 void
 Transformer::migrateSchema(SQLite3Ptr conn)
 {
-    // read schema version
-    SQLite3::Query query(*conn, "select value from config where key = 'version';");
-    if (query.step() == SQLite3::Statement::StepResult::ROW){
-        auto schemaVersion = query.get<std::string>("value");
-
-        if (schemaVersion == "1.1") {
-            conn->exec(sql_migrate_tables_1_2);
-        }
+    auto schemaVersion = getSchemaVersion(conn);
+    if (schemaVersion == "1.1") {
+        conn->exec(sql_migrate_tables_1_2);
+        schemaVersion = "1.2";
     }
-    else {
+    if (schemaVersion == "1.2") {
+        conn->exec(sql_migrate_tables_1_3);
+        schemaVersion = "1.3";
+    }
+    if (schemaVersion == "1.3") {
+        conn->exec(sql_migrate_tables_1_4);
+    }
+}
+
+std::string
+Transformer::getSchemaVersion(SQLite3Ptr conn)
+{
+    SQLite3::Query query(*conn, "select value from config where key = 'version';");
+    if (query.step() != SQLite3::Statement::StepResult::ROW) {
         throw Exception(_("Database Corrupted: no row 'version' in table 'config'"));
     }
+    return query.get<std::string>("value");
 }
 
 /**
@@ -216,6 +234,12 @@ Transformer::transformTrans(SQLite3Ptr swdb, SQLite3Ptr history)
             yumdb_key='releasever'
     )**";
 
+    // all the history is written in a single database transaction
+    SQLite3::Transaction sqlTransaction(*swdb);
+
+    // read the yumdb attributes of all the packages at once
+    loadYumdbData(history);
+
     // get release version for all the transactions
     std::map< int64_t, std::string > releasever;
     SQLite3::Query releasever_query(*history.get(), releasever_sql);
@@ -254,6 +278,7 @@ Transformer::transformTrans(SQLite3Ptr swdb, SQLite3Ptr history)
 
         trans->finish(state);
     }
+    sqlTransaction.commit();
 }
 
 static void
@@ -292,12 +317,12 @@ Transformer::transformTransWith(SQLite3Ptr swdb,
     )**";
 
     // transform stdout
-    SQLite3::Query query(*history.get(), sql);
-    query.bindv(trans->getId());
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+    auto query = history->getCachedQuery(sql);
+    query->bindv(trans->getId());
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
         // create RPM item object
         auto rpm = std::make_shared< RPMItem >(swdb);
-        fillRPMItem(rpm, query);
+        fillRPMItem(rpm, *query);
         trans->addSoftwarePerformedWith(rpm);
     }
 }
@@ -321,10 +346,10 @@ Transformer::transformOutput(SQLite3Ptr history, std::shared_ptr< TransformerTra
     )**";
 
     // transform stdout
-    SQLite3::Query query(*history.get(), sql);
-    query.bindv(trans->getId());
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
-        trans->addConsoleOutputLine(1, query.get< std::string >("line"));
+    auto query = history->getCachedQuery(sql);
+    query->bindv(trans->getId());
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
+        trans->addConsoleOutputLine(1, query->get< std::string >("line"));
     }
 
     sql = R"**(
@@ -339,36 +364,40 @@ Transformer::transformOutput(SQLite3Ptr history, std::shared_ptr< TransformerTra
     )**";
 
     // transform stderr
-    SQLite3::Query errorQuery(*history.get(), sql);
-    errorQuery.bindv(trans->getId());
-    while (errorQuery.step() == SQLite3::Statement::StepResult::ROW) {
-        trans->addConsoleOutputLine(2, errorQuery.get< std::string >("msg"));
+    auto errorQuery = history->getCachedQuery(sql);
+    errorQuery->bindv(trans->getId());
+    while (errorQuery->step() == SQLite3::Statement::StepResult::ROW) {
+        trans->addConsoleOutputLine(2, errorQuery->get< std::string >("msg"));
     }
 }
 
-static void
-getYumdbData(int64_t itemId, SQLite3Ptr history, TransactionItemReason &reason, std::string &repoid)
+/**
+ * Load reason and repoid of all the packages from the yumdb
+ * \param history pointer to history database SQLite3 object
+ */
+void
+Transformer::loadYumdbData(SQLite3Ptr history)
 {
     const char *sql = R"**(
         SELECT
+            pkgtupid as id,
             yumdb_key as key,
             yumdb_val as value
         FROM
             pkg_yumdb
         WHERE
-            pkgtupid=?
-            and key IN ('reason', 'from_repo')
+            key IN ('reason', 'from_repo')
     )**";
 
-    // load reason and repoid data from yumdb
+    yumdbData.clear();
     SQLite3::Query query(*history.get(), sql);
-    query.bindv(itemId);
     while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        auto &data = yumdbData[query.get< int64_t >("id")];
         std::string key = query.get< std::string >("key");
         if (key == "reason") {
-            reason = Transformer::getReason(query.get< std::string >("value"));
+            data.reason = Transformer::getReason(query.get< std::string >("value"));
         } else if (key == "from_repo") {
-            repoid = query.get< std::string >("value");
+            data.repoid = query.get< std::string >("value");
         }
     }
 }
@@ -402,8 +431,8 @@ Transformer::transformRPMItems(SQLite3Ptr swdb,
             t.tid=?
     )**";
 
-    SQLite3::Query query(*history.get(), pkg_sql);
-    query.bindv(trans->getId());
+    auto query = history->getCachedQuery(pkg_sql);
+    query->bindv(trans->getId());
 
     TransactionItemPtr last = nullptr;
 
@@ -418,14 +447,14 @@ Transformer::transformRPMItems(SQLite3Ptr swdb,
     std::map< int64_t, TransactionItemPtr > obsoletedItems;
 
     // iterate over transaction packages in the history database
-    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+    while (query->step() == SQLite3::Statement::StepResult::ROW) {
 
         // create RPM item object
         auto rpm = std::make_shared< RPMItem >(swdb);
-        fillRPMItem(rpm, query);
+        fillRPMItem(rpm, *query);
 
         // get item state/action
-        std::string stateString = query.get< std::string >("state");
+        std::string stateString = query->get< std::string >("state");
         TransactionItemAction action = actions.at(stateString);
 
         // `Obsoleting` record is duplicated with previous record (with different action)
@@ -444,11 +473,15 @@ Transformer::transformRPMItems(SQLite3Ptr swdb,
             // load reason and from_repo
             TransactionItemReason reason = TransactionItemReason::UNKNOWN;
             std::string repoid;
-            getYumdbData(query.get< int64_t >("id"), history, reason, repoid);
+            auto yumdb = yumdbData.find(query->get< int64_t >("id"));
+            if (yumdb != yumdbData.end()) {
+                reason = yumdb->second.reason;
+                repoid = yumdb->second.repoid;
+            }
 
             // add TransactionItem object
             transItem = trans->addItem(rpm, repoid, action, reason);
-            transItem->setState(query.get< std::string >("done") == "TRUE" ? TransactionItemState::DONE : TransactionItemState::ERROR);
+            transItem->setState(query->get< std::string >("done") == "TRUE" ? TransactionItemState::DONE : TransactionItemState::ERROR);
         } else {
             // item has been obsoleted - we just need to update the action
             transItem = pastObsoleted->second;
@@ -23,6 +23,7 @@
 
 #include <json.h>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "../utils/sqlite3/Sqlite3.hpp"
@@ -58,9 +59,10 @@ public:
 
     static void createDatabase(SQLite3Ptr conn);
     static void migrateSchema(SQLite3Ptr conn);
+    static std::string getSchemaVersion(SQLite3Ptr conn);
 
     static TransactionItemReason getReason(const std::string &reason);
-    static const char *getVersion() noexcept { return "1.2"; }
+    static const char *getVersion() noexcept { return "1.4"; }
 
 protected:
     void transformTrans(SQLite3Ptr swdb, SQLite3Ptr history);
@@ -82,7 +84,16 @@ private:
     std::shared_ptr<CompsEnvironmentItem> processEnvironment(SQLite3Ptr swdb,
                                                              const char *envId,
                                                              struct json_object *env);
+    void loadYumdbData(SQLite3Ptr history);
     std::string historyPath();
+
+    // reason and repoid of the packages in the yumdb, by pkgtupid
+    struct YumdbData {
+        TransactionItemReason reason = TransactionItemReason::UNKNOWN;
+        std::string repoid;
+    };
+    std::unordered_map< int64_t, YumdbData > yumdbData;
+
     const std::string inputDir;
     const std::string outputFile;
     const std::string transformFile;
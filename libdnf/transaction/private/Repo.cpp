@@ -45,9 +45,9 @@ Repo::dbInsert()
         "  repo "
         "VALUES "
         "  (null, ?)";
-    SQLite3::Statement query(*conn.get(), sql);
-    query.bindv(getRepoId());
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(getRepoId());
+    query->step();
     setId(conn->lastInsertRowID());
 }
 
@@ -81,12 +81,12 @@ Repo::dbSelectOrInsert()
         "WHERE "
         "  repoid = ? ";
 
-    SQLite3::Statement query(*conn.get(), sql);
-    query.bindv(getRepoId());
-    SQLite3::Statement::StepResult result = query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(getRepoId());
+    SQLite3::Statement::StepResult result = query->step();
 
     if (result == SQLite3::Statement::StepResult::ROW) {
-        setId(query.get< int >(0));
+        setId(query->get< int >(0));
     } else {
         // insert and get the ID back
         dbInsert();
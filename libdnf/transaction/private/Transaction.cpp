@@ -40,16 +40,24 @@ swdb_private::Transaction::begin()
     if (id != 0) {
         throw std::runtime_error(_("Transaction has already began!"));
     }
+    // the transaction and all its items are written at once
+    SQLite3::Transaction sqlTransaction(*conn);
     dbInsert();
     saveItems();
+    sqlTransaction.commit();
 }
 
 void
 swdb_private::Transaction::finish(TransactionState state)
 {
     // save states to the database before checking for UNKNOWN state
-    for (auto i : getItems()) {
-        i->saveState();
+    {
+        SQLite3::Transaction sqlTransaction(*conn);
+        for (auto i : getItems()) {
+            i->saveState();
+        }
+        flushConsoleOutput();
+        sqlTransaction.commit();
     }
 
     for (auto i : getItems()) {
@@ -243,19 +251,34 @@ swdb_private::Transaction::addConsoleOutputLine(int fileDescriptor, const std::s
         throw std::runtime_error(_("Can't add console output to unsaved transaction"));
     }
 
+    // lines are buffered and written as a compressed block
+    consoleOutput.emplace_back(fileDescriptor, line);
+    consoleOutputSize += line.size();
+    if (consoleOutputSize >= consoleOutputBlockSize) {
+        flushConsoleOutput();
+    }
+}
+
+void
+swdb_private::Transaction::flushConsoleOutput()
+{
+    if (consoleOutput.empty()) {
+        return;
+    }
     const char *sql = R"**(
         INSERT INTO
-            console_output (
+            console_output_block (
                 trans_id,
-                file_descriptor,
-                line
+                data
             )
         VALUES
-            (?, ?, ?);
+            (?, ?);
     )**";
-    SQLite3::Statement query(*conn, sql);
-    query.bindv(getId(), fileDescriptor, line);
-    query.step();
+    auto query = conn->getCachedQuery(sql);
+    query->bindv(getId(), packConsoleOutput(consoleOutput));
+    query->step();
+    consoleOutput.clear();
+    consoleOutputSize = 0;
 }
 
 } // namespace libdnf
@@ -61,6 +61,12 @@ protected:
     void saveItems();
     std::vector< TransactionItemPtr > items;
 
+    // console output is stored as one compressed block per this many bytes of lines
+    static constexpr std::size_t consoleOutputBlockSize = 1 << 20;
+    void flushConsoleOutput();
+    ConsoleOutput consoleOutput;
+    std::size_t consoleOutputSize = 0;
+
     void dbInsert();
     void dbUpdate();
 };
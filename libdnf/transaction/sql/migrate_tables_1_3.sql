@@ -0,0 +1,9 @@
+R"**(
+BEGIN TRANSACTION;
+    CREATE INDEX IF NOT EXISTS trans_item_item_id_trans_id ON trans_item(item_id, trans_id);
+    DROP INDEX IF EXISTS trans_item_item_id;
+    UPDATE config
+        SET value = '1.3'
+        WHERE key = 'version';
+COMMIT;
+)**"
@@ -0,0 +1,13 @@
+R"**(
+BEGIN TRANSACTION;
+    CREATE TABLE console_output_block (
+        id INTEGER PRIMARY KEY,
+        trans_id INTEGER REFERENCES trans(id),
+        data BLOB NOT NULL                      /* zlib compressed console_output lines */
+    );
+    CREATE INDEX console_output_block_trans_id ON console_output_block(trans_id);
+    UPDATE config
+        SET value = '1.4'
+        WHERE key = 'version';
+COMMIT;
+)**"
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <AsyncLogger.hpp>
+
+#include <system_error>
+
+namespace libdnf {
+
+constexpr std::size_t AsyncLogger::DEFAULT_CAPACITY;
+
+AsyncLogger::AsyncLogger(Logger & target, std::size_t capacity)
+: target(target), ring(capacity > 0 ? capacity : 1) {}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!writer)
+            return;
+        if (writerPid != getpid()) {
+            // The writer thread does not exist in a forked child, it cannot be joined there.
+            writer.release();
+            return;
+        }
+        stopping = true;
+    }
+    notEmpty.notify_one();
+    writer->join();
+}
+
+bool AsyncLogger::startWriter()
+{
+    if (writer)
+        return true;
+    try {
+        writer.reset(new std::thread(&AsyncLogger::run, this));
+    } catch (const std::system_error &) {
+        return false;
+    }
+    writerPid = getpid();
+    return true;
+}
+
+void AsyncLogger::write(int source, time_t time, pid_t pid, Level level, const std::string & message)
+{
+    // In a forked child the mutex may be left locked by the writer thread of the parent.
+    auto owner = writerPid.load();
+    if (owner != 0 && owner != getpid()) {
+        target.write(source, time, pid, level, message);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!startWriter()) {
+        lock.unlock();
+        target.write(source, time, pid, level, message);
+        return;
+    }
+    notFull.wait(lock, [this] { return count < ring.size(); });
+    auto & record = ring[(head + count) % ring.size()];
+    record.source = source;
+    record.time = time;
+    record.pid = pid;
+    record.level = level;
+    record.message.assign(message);
+    ++count;
+    notEmpty.notify_one();
+
+    if (level <= Level::ERROR)
+        drained.wait(lock, [this] { return count == 0 && !writing; });
+}
+
+void AsyncLogger::flush()
+{
+    auto owner = writerPid.load();
+    if (owner == 0 || owner != getpid())
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return count == 0 && !writing; });
+}
+
+void AsyncLogger::run()
+{
+    Record record;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        notEmpty.wait(lock, [this] { return count > 0 || stopping; });
+        if (count == 0)
+            return;
+        std::swap(record, ring[head]);
+        head = (head + 1) % ring.size();
+        --count;
+        writing = true;
+        lock.unlock();
+        notFull.notify_one();
+
+        try {
+            target.write(record.source, record.time, record.pid, record.level, record.message);
+        } catch (...) {
+            // there is nobody to report the failure to on this thread
+        }
+
+        lock.lock();
+        writing = false;
+        if (count == 0)
+            drained.notify_all();
+    }
+}
+
+}
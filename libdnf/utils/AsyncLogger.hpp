@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _ASYNC_LOGGER_HPP_
+#define _ASYNC_LOGGER_HPP_
+
+#include <logger.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libdnf {
+
+/// Logger that hands the messages over to a background thread which writes them to the target
+/// logger. The messages are kept in a fixed size ring buffer, a writer waits only when it is full.
+/// Messages of ERROR and CRITICAL level are written before the call returns.
+class AsyncLogger : public Logger {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+
+    explicit AsyncLogger(Logger & target, std::size_t capacity = DEFAULT_CAPACITY);
+    AsyncLogger(const AsyncLogger &) = delete;
+    AsyncLogger & operator=(const AsyncLogger &) = delete;
+    ~AsyncLogger() override;
+
+    void write(int source, time_t time, pid_t pid, Level level, const std::string & message) override;
+
+    /// Waits until all the queued messages are written to the target logger.
+    void flush();
+
+private:
+    struct Record {
+        int source;
+        time_t time;
+        pid_t pid;
+        Level level;
+        std::string message;
+    };
+
+    void run();
+    bool startWriter();
+
+    Logger & target;
+    std::vector<Record> ring;
+    std::size_t head{0};
+    std::size_t count{0};
+    bool writing{false};
+    bool stopping{false};
+    std::atomic<pid_t> writerPid{0};
+    std::unique_ptr<std::thread> writer;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::condition_variable drained;
+};
+
+}
+
+#endif // _ASYNC_LOGGER_HPP_
@@ -1,6 +1,5 @@
 #include "CompressedFile.hpp"
 #include <utility>
-#include <sstream>
 
 extern "C" {
 #   include <solv/solv_xfopen.h>
@@ -36,21 +35,24 @@ std::string CompressedFile::getContent()
         throw NotOpenedException(filePath);
     }
 
-    constexpr size_t bufferSize = 4096;
-    char buffer[bufferSize];
-    std::ostringstream ss;
+    // Decompress straight into the result, growing it by large blocks
+    constexpr size_t blockSize = 256 * 1024;
+    std::string content;
+    size_t used = 0;
     size_t bytesRead;
 
     do {
+        content.resize(used + blockSize);
         try {
-            bytesRead = read(buffer, bufferSize);
+            bytesRead = read(&content[used], blockSize);
         } catch (const ReadError & e) {
             throw ReadError(std::string(e.what()) + " Likely the archive is damaged.");
         }
-        ss.write(buffer, bytesRead);
-    } while (bytesRead == bufferSize);
+        used += bytesRead;
+    } while (bytesRead == blockSize);
+    content.resize(used);
 
-    return ss.str();
+    return content;
 }
 
 }
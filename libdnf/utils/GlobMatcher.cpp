@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "GlobMatcher.hpp"
+
+#include <cstring>
+#include <fnmatch.h>
+
+namespace libdnf {
+
+/// Returns the end of the bracket expression starting at `begin` or nullptr if it is not closed,
+/// in which case fnmatch() takes the '[' literally.
+static const char *
+bracketEnd(const char * begin)
+{
+    const char * it = begin + 1;
+    if (*it == '!' || *it == '^')
+        ++it;
+    // a ']' right after the opening is part of the set
+    if (*it == ']')
+        ++it;
+    for (; *it; ++it) {
+        if (*it == ']')
+            return it + 1;
+        if (*it == '\\' && it[1]) {
+            ++it;
+        } else if (*it == '[' && (it[1] == ':' || it[1] == '=' || it[1] == '.')) {
+            // [:class:], [=equiv=] and [.coll.] may contain ']'
+            const char delim[]{it[1], ']', '\0'};
+            auto classEnd = std::strstr(it + 2, delim);
+            if (!classEnd)
+                return nullptr;
+            it = classEnd + 1;
+        }
+    }
+    return nullptr;
+}
+
+GlobMatcher::GlobMatcher(const char * pattern, int flags)
+: pattern(pattern), flags(flags)
+{
+    // case folding depends on the locale, only fnmatch() knows what matches
+    if (flags & FNM_CASEFOLD)
+        return;
+
+    // split into literal runs, remembering whether a run follows and is followed by a '*'
+    std::string run;
+    bool atStart = true;
+    bool afterStar = false;
+    auto endRun = [&](bool beforeStar) {
+        if (atStart)
+            prefix = run;
+        else if (afterStar && beforeStar && run.size() > infix.size())
+            infix = run;
+        run.clear();
+        atStart = false;
+    };
+    for (const char * it = pattern; *it; ++it) {
+        switch (*it) {
+            case '*':
+                endRun(true);
+                afterStar = true;
+                continue;
+            case '?':
+                endRun(false);
+                afterStar = false;
+                continue;
+            case '[': {
+                auto end = bracketEnd(it);
+                if (!end)
+                    break;
+                endRun(false);
+                afterStar = false;
+                it = end - 1;
+                continue;
+            }
+            case '\\':
+                if (!it[1])
+                    break;
+                run.push_back(*++it);
+                continue;
+            default:
+                run.push_back(*it);
+                continue;
+        }
+        // a part fnmatch() interprets differently, keep only what precedes it
+        if (atStart)
+            prefix = run;
+        return;
+    }
+    if (atStart)
+        // no special character at all
+        prefix = run;
+    else
+        suffix = run;
+}
+
+bool
+GlobMatcher::match(const char * str) const
+{
+    if (!prefix.empty() && std::strncmp(str, prefix.c_str(), prefix.size()) != 0)
+        return false;
+    if (!suffix.empty()) {
+        auto len = std::strlen(str);
+        if (len < prefix.size() + suffix.size() ||
+            std::memcmp(str + len - suffix.size(), suffix.data(), suffix.size()) != 0)
+            return false;
+    }
+    if (!infix.empty() && !std::strstr(str + prefix.size(), infix.c_str()))
+        return false;
+    return fnmatch(pattern.c_str(), str, flags) == 0;
+}
+
+}
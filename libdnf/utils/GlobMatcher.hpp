@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _LIBDNF_GLOB_MATCHER_HPP_
+#define _LIBDNF_GLOB_MATCHER_HPP_
+
+#include <string>
+
+namespace libdnf {
+
+/// fnmatch() of one pattern against many strings. The literal prefix, suffix and the longest
+/// literal part between two '*' of the pattern are extracted once, strings missing any of them
+/// are rejected without calling fnmatch().
+class GlobMatcher {
+public:
+    /// @param flags fnmatch() flags, FNM_CASEFOLD disables the literal checks
+    explicit GlobMatcher(const char * pattern, int flags = 0);
+
+    bool match(const char * str) const;
+
+    /// The characters every matching string starts with, empty with FNM_CASEFOLD
+    const std::string & getPrefix() const noexcept { return prefix; }
+
+private:
+    std::string pattern;
+    int flags;
+    std::string prefix;
+    std::string suffix;
+    std::string infix;
+};
+
+}
+
+#endif
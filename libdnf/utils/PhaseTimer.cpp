@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <PhaseTimer.hpp>
+
+#include "tinyformat/tinyformat.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include <time.h>
+#include <unistd.h>
+
+namespace libdnf {
+
+static std::atomic<bool> & enabledFlag()
+{
+    static std::atomic<bool> enabled{[] {
+        auto env = getenv("LIBDNF_PHASE_TIMINGS");
+        return env && *env;
+    }()};
+    return enabled;
+}
+
+static std::mutex timingsMutex;
+static std::vector<PhaseTiming> timings;
+static thread_local int currentDepth = 0;
+
+static double clockSeconds(clockid_t clock)
+{
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0)
+        return 0.0;
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+/// Returns the resident set size of the process in KiB, 0 if it is unknown.
+static long residentSize()
+{
+    auto statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+    long size, resident;
+    auto items = fscanf(statm, "%ld %ld", &size, &resident);
+    fclose(statm);
+    if (items != 2)
+        return 0;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+bool PhaseTimings::isEnabled() noexcept
+{
+    return enabledFlag().load(std::memory_order_relaxed);
+}
+
+void PhaseTimings::setEnabled(bool enabled) noexcept
+{
+    enabledFlag() = enabled;
+}
+
+std::vector<PhaseTiming> PhaseTimings::get()
+{
+    std::lock_guard<std::mutex> guard(timingsMutex);
+    return timings;
+}
+
+void PhaseTimings::clear()
+{
+    std::lock_guard<std::mutex> guard(timingsMutex);
+    timings.clear();
+}
+
+std::string PhaseTimings::report()
+{
+    std::string out = tfm::format("%-40s %-20s %10s %10s %10s\n", "phase", "repo", "wall [ms]", "cpu [ms]", "rss [KiB]");
+    for (const auto & timing : get()) {
+        out += tfm::format("%-40s %-20s %10.1f %10.1f %+10ld\n",
+            std::string(2 * timing.depth, ' ') + timing.phase, timing.repoId,
+            timing.wallTime * 1000, timing.cpuTime * 1000, timing.rssDelta);
+    }
+    return out;
+}
+
+PhaseTimer::PhaseTimer(const char * phase, const char * repoId)
+: active(PhaseTimings::isEnabled()), phase(phase), repoId(repoId)
+{
+    if (!active)
+        return;
+    depth = currentDepth++;
+    rssStart = residentSize();
+    cpuStart = clockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    wallStart = clockSeconds(CLOCK_MONOTONIC);
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (!active)
+        return;
+    auto wallEnd = clockSeconds(CLOCK_MONOTONIC);
+    auto cpuEnd = clockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    auto rssEnd = residentSize();
+    --currentDepth;
+    try {
+        std::lock_guard<std::mutex> guard(timingsMutex);
+        timings.push_back({phase, repoId ? repoId : "", depth, wallEnd - wallStart, cpuEnd - cpuStart,
+                           rssEnd - rssStart});
+    } catch (...) {
+        // losing a measurement is not worth terminating for
+    }
+}
+
+}
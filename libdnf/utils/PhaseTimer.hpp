@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _LIBDNF_PHASE_TIMER_HPP_
+#define _LIBDNF_PHASE_TIMER_HPP_
+
+#include <string>
+#include <vector>
+
+namespace libdnf {
+
+/// Resources spent by one finished phase of the libdnf startup.
+struct PhaseTiming {
+    std::string phase;
+    /// id of the repository the phase worked on, empty for global phases
+    std::string repoId;
+    /// number of phases running around this one when it started
+    int depth;
+    double wallTime;
+    double cpuTime;
+    /// change of the resident set size in KiB
+    long rssDelta;
+};
+
+/// Collection of the phase timings. It is disabled unless the LIBDNF_PHASE_TIMINGS environment
+/// variable is set to a non empty value or setEnabled(true) is called.
+class PhaseTimings {
+public:
+    static bool isEnabled() noexcept;
+    static void setEnabled(bool enabled) noexcept;
+    /// Returns the recorded phases in the order they finished.
+    static std::vector<PhaseTiming> get();
+    static void clear();
+    /// Formats the recorded phases as a table, nested phases are indented.
+    static std::string report();
+};
+
+/// Measures the scope it lives in as a phase, does nothing while the collection is disabled.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(const char * phase, const char * repoId = nullptr);
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer & operator=(const PhaseTimer &) = delete;
+    ~PhaseTimer();
+
+private:
+    bool active;
+    const char * phase;
+    const char * repoId;
+    int depth;
+    double wallStart;
+    double cpuStart;
+    long rssStart;
+};
+
+}
+
+#endif // _LIBDNF_PHASE_TIMER_HPP_
@@ -24,18 +24,31 @@
 #ifdef LIBDNF_UNSTABLE_API
 
 #include <cstddef>
+#include <functional>
 #include <iterator>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace libdnf {
 
-template<typename Key, typename T, class KeyEqual = std::equal_to<Key>>
+/**
+* @class PreserveOrderMap
+*
+* @brief Map which keeps items in the order of insertion
+*
+* Items are stored in a vector. Maps with at least INDEX_MIN_SIZE items also keep a hash index
+* of the positions of the keys, so lookups stay O(1) in big maps (e.g. sections of big .repo
+* files). Small maps are searched linearly. Erasing an item rebuilds the index.
+*/
+template<typename Key, typename T, class KeyEqual = std::equal_to<Key>, class Hash = std::hash<Key>>
 class PreserveOrderMap {
 public:
     typedef Key key_type;
     typedef T mapped_type;
     typedef KeyEqual key_equal;
+    typedef Hash hasher;
     typedef std::pair<const Key, T> value_type;
     typedef std::vector<std::pair<Key, T>> container_type;
     typedef typename container_type::size_type size_type;
@@ -91,91 +104,123 @@ public:
     const_reverse_iterator rend() const noexcept { return const_reverse_iterator(items.rend()); }
     const_reverse_iterator crend() const noexcept { return const_reverse_iterator(items.crend()); }
 
-    void clear() noexcept { items.clear(); }
+    void clear() noexcept { items.clear(); index.clear(); }
 
     std::pair<iterator, bool> insert(const value_type & value)
     {
-        auto it = find(value.first);
-        if (it == end()) {
-            it = iterator(items.insert(it.ci, value));
-            return {it, true};
+        auto pos = findPos(value.first);
+        if (pos == items.size()) {
+            append(value);
+            return {iterator(items.begin() + pos), true};
         } else {
-            return {it, false};
+            return {iterator(items.begin() + pos), false};
         }
     }
 
-    iterator erase(const_iterator pos) { return iterator(items.erase(pos.ci)); }
-    iterator erase(const_iterator first, const_iterator last) { return iterator(items.erase(first.ci, last.ci)); }
+    iterator erase(const_iterator pos)
+    {
+        auto it = items.erase(pos.ci);
+        auto offset = it - items.begin();
+        reindex();
+        return iterator(items.begin() + offset);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        auto it = items.erase(first.ci, last.ci);
+        auto offset = it - items.begin();
+        reindex();
+        return iterator(items.begin() + offset);
+    }
 
     size_type erase(const Key & key)
     {
-        auto it = find(key);
-        if (it == end())
+        auto pos = findPos(key);
+        if (pos == items.size())
             return 0;
-        items.erase(it.ci);
+        items.erase(items.begin() + pos);
+        reindex();
         return 1;
     }
 
     size_type count(const Key & key) const
     {
-        return find(key) != end() ? 1 : 0;
+        return findPos(key) != items.size() ? 1 : 0;
     }
 
-    iterator find(const Key & key)
-    {
-        auto it = begin();
-        while (it != end() && !KeyEqual()(it->first, key))
-            ++it;
-        return it;
-    }
+    iterator find(const Key & key) { return iterator(items.begin() + findPos(key)); }
 
-    const_iterator find(const Key & key) const
-    {
-        auto it = cbegin();
-        while (it != cend() && !KeyEqual()(it->first, key))
-            ++it;
-        return it;
-    }
+    const_iterator find(const Key & key) const { return const_iterator(items.cbegin() + findPos(key)); }
 
     T & operator[](const Key & key) {
-        for (auto & item : items) {
-            if (KeyEqual()(item.first, key))
-                return item.second;
-        }
-        items.push_back({key, {}});
-        return items.back().second;
+        auto pos = findPos(key);
+        if (pos == items.size())
+            append({key, {}});
+        return items[pos].second;
     }
 
     T & operator[](Key && key)
     {
-        for (auto & item : items) {
-            if (KeyEqual()(item.first, key))
-                return item.second;
-        }
-        items.push_back({std::move(key), {}});
-        return items.back().second;
+        auto pos = findPos(key);
+        if (pos == items.size())
+            append({std::move(key), {}});
+        return items[pos].second;
     }
 
     T & at(const Key & key)
     {
-        for (auto & item : items) {
-            if (KeyEqual()(item.first, key))
-                return item.second;
-        }
-        throw std::out_of_range("PreserveOrderMap::at");
+        auto pos = findPos(key);
+        if (pos == items.size())
+            throw std::out_of_range("PreserveOrderMap::at");
+        return items[pos].second;
     }
 
     const T & at(const Key & key) const
     {
-        for (auto & item : items) {
-            if (KeyEqual()(item.first, key))
-                return item.second;
-        }
-        throw std::out_of_range("PreserveOrderMap::at");
+        auto pos = findPos(key);
+        if (pos == items.size())
+            throw std::out_of_range("PreserveOrderMap::at");
+        return items[pos].second;
     }
 
 private:
+    static constexpr size_type INDEX_MIN_SIZE = 16;
+
+    /// Returns the position of the key in items, or items.size() if it is not there.
+    size_type findPos(const Key & key) const
+    {
+        if (!index.empty()) {
+            auto it = index.find(key);
+            return it != index.end() ? it->second : items.size();
+        }
+        size_type pos = 0;
+        while (pos < items.size() && !KeyEqual()(items[pos].first, key))
+            ++pos;
+        return pos;
+    }
+
+    void append(std::pair<Key, T> item)
+    {
+        items.push_back(std::move(item));
+        if (!index.empty())
+            index.emplace(items.back().first, items.size() - 1);
+        else if (items.size() >= INDEX_MIN_SIZE)
+            reindex();
+    }
+
+    void reindex()
+    {
+        index.clear();
+        if (items.size() < INDEX_MIN_SIZE)
+            return;
+        index.reserve(items.size());
+        for (size_type pos = 0; pos < items.size(); ++pos)
+            index.emplace(items[pos].first, pos);
+    }
+
     container_type items;
+    /// Positions of the keys in items, empty for maps smaller than INDEX_MIN_SIZE
+    std::unordered_map<Key, size_type, Hash, KeyEqual> index;
 };
 
 }
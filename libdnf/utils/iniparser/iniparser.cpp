@@ -20,6 +20,8 @@
 
 #include "iniparser.hpp"
 
+#include <iterator>
+
 constexpr char DELIMITER = '\n';
 
 const char * IniParser::CantOpenFile::what() const noexcept
@@ -62,24 +64,34 @@ const char * IniParser::MissingEqual::what() const noexcept
     return "IniParser: Missing '='";
 }
 
-IniParser::IniParser(const std::string & filePath)
-: is(new std::ifstream(filePath))
+IniParser::IniParser(const std::string & filePath, bool keepRawItems)
+: keepRawItems(keepRawItems)
 {
-    if (!(*is))
+    std::ifstream ifs(filePath, std::ios::in | std::ios::binary);
+    if (!ifs)
         throw CantOpenFile();
-    is->exceptions(std::ifstream::badbit);
-    lineNumber = 0;
-    lineReady = false;
+    ifs.exceptions(std::ifstream::badbit);
+    ifs.seekg(0, std::ios::end);
+    auto size = ifs.tellg();
+    if (size > 0) {
+        buffer.resize(static_cast<std::size_t>(size));
+        ifs.seekg(0, std::ios::beg);
+        ifs.read(&buffer[0], size);
+        buffer.resize(static_cast<std::size_t>(ifs.gcount()));
+    } else if (size < 0) {
+        // not seekable, e.g. a pipe
+        ifs.clear();
+        buffer.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
 }
 
-IniParser::IniParser(std::unique_ptr<std::istream> && inputStream)
-: is(std::move(inputStream))
+IniParser::IniParser(std::unique_ptr<std::istream> && inputStream, bool keepRawItems)
+: keepRawItems(keepRawItems)
 {
-    if (!(*is))
+    if (!(*inputStream))
         throw CantOpenFile();
-    is->exceptions(std::ifstream::badbit);
-    lineNumber = 0;
-    lineReady = false;
+    inputStream->exceptions(std::ifstream::badbit);
+    buffer.assign(std::istreambuf_iterator<char>(*inputStream), std::istreambuf_iterator<char>());
 }
 
 void IniParser::trimValue() noexcept {
@@ -94,53 +106,114 @@ void IniParser::trimValue() noexcept {
     }
 }
 
+// Same as std::getline() on the buffer: the last line is empty and at end of input
+// when the input ends with the delimiter.
+void IniParser::readLine() noexcept
+{
+    lineBegin = bufferPos;
+    auto delim = buffer.find(DELIMITER, bufferPos);
+    if (delim == buffer.npos) {
+        lineLength = buffer.length() - bufferPos;
+        bufferPos = buffer.length();
+        eof = true;
+    } else {
+        lineLength = delim - bufferPos;
+        bufferPos = delim + 1;
+    }
+}
+
+void IniParser::appendRawLine()
+{
+    if (keepRawItems) {
+        rawItem.append(buffer, lineBegin, lineLength);
+        rawItem += DELIMITER;
+    }
+}
+
+static bool isOneOf(char ch, const char * chars) noexcept
+{
+    for (; *chars; ++chars)
+        if (*chars == ch)
+            return true;
+    return false;
+}
+
+static std::size_t findFirstNotOf(const char * line, std::size_t length, const char * chars,
+                                  std::size_t from) noexcept
+{
+    for (auto idx = from; idx < length; ++idx)
+        if (!isOneOf(line[idx], chars))
+            return idx;
+    return std::string::npos;
+}
+
+static std::size_t findLastNotOf(const char * line, std::size_t length, const char * chars) noexcept
+{
+    for (auto idx = length; idx-- > 0;)
+        if (!isOneOf(line[idx], chars))
+            return idx;
+    return std::string::npos;
+}
+
+static std::size_t findChar(const char * line, std::size_t length, char ch, std::size_t from) noexcept
+{
+    for (auto idx = from; idx < length; ++idx)
+        if (line[idx] == ch)
+            return idx;
+    return std::string::npos;
+}
+
 IniParser::ItemType IniParser::next()
 {
     bool previousLineWithKeyVal = false;
     rawItem.clear();
-    while (lineReady || !is->eof()) {
+    while (lineReady || !eof) {
         if (!lineReady) {
-            std::getline(*is, line, DELIMITER);
+            readLine();
             ++lineNumber;
             lineReady = true;
         }
 
         // remove UTF-8 BOM
-        if (lineNumber == 1 && line.length() >= 3 &&
-            static_cast<unsigned char>(line[0]) == 0xEF &&
-            static_cast<unsigned char>(line[1]) == 0xBB &&
-            static_cast<unsigned char>(line[2]) == 0xBF)
-            line.erase(0, 3);
+        if (lineNumber == 1 && lineBegin == 0 && lineLength >= 3 &&
+            static_cast<unsigned char>(buffer[0]) == 0xEF &&
+            static_cast<unsigned char>(buffer[1]) == 0xBB &&
+            static_cast<unsigned char>(buffer[2]) == 0xBF) {
+            lineBegin += 3;
+            lineLength -= 3;
+        }
 
-        if (line.length() == 0 || line[0] == '#' || line[0] == ';') {// do not support [rR][eE][mM] comment
+        const char * line = buffer.data() + lineBegin;
+        if (lineLength == 0 || line[0] == '#' || line[0] == ';') {// do not support [rR][eE][mM] comment
             if (previousLineWithKeyVal) {
                 trimValue();
                 return ItemType::KEY_VAL;
             }
-            if (line.length() == 0) {
-                if (is->eof())
+            if (lineLength == 0) {
+                if (eof)
                     return ItemType::END_OF_INPUT;
                 lineReady = false;
-                rawItem = DELIMITER;
+                if (keepRawItems)
+                    rawItem = DELIMITER;
                 return ItemType::EMPTY_LINE;
             }
-            rawItem = line + DELIMITER;
+            appendRawLine();
             lineReady = false;
             return ItemType::COMMENT_LINE;
         }
-        auto start = line.find_first_not_of(" \t\r");
+        auto start = findFirstNotOf(line, lineLength, " \t\r", 0);
         if (start == std::string::npos) {
             if (previousLineWithKeyVal) {
                 value += DELIMITER;
-                rawItem += line + DELIMITER;
+                appendRawLine();
                 lineReady = false;
                 continue;
             }
-            rawItem = line + DELIMITER;
+            appendRawLine();
             lineReady = false;
             return ItemType::EMPTY_LINE;
         }
-        auto end = line.find_last_not_of(" \t\r");
+        auto end = findLastNotOf(line, lineLength, " \t\r");
 
         if (previousLineWithKeyVal && (start == 0 || line[start] == '[')) {
             trimValue();
@@ -148,8 +221,8 @@ IniParser::ItemType IniParser::next()
         }
 
         if (line[start] == '[') {
-            auto endSectPos = line.find("]", ++start);
-            if (endSectPos == line.npos)
+            auto endSectPos = findChar(line, lineLength, ']', ++start);
+            if (endSectPos == std::string::npos)
                 throw MissingBracket(lineNumber);
             else if (endSectPos == start)
                 throw EmptySectionName(lineNumber);
@@ -161,8 +234,8 @@ IniParser::ItemType IniParser::next()
                 if (ch != ' ' && ch != '\t' && ch != '\r')
                     throw TextAfterSection(lineNumber);
             }
-            this->section = line.substr(start, endSectPos - start);
-            rawItem = line + DELIMITER;
+            section.assign(line + start, endSectPos - start);
+            appendRawLine();
             lineReady = false;
             return ItemType::SECTION;
         }
@@ -173,24 +246,27 @@ IniParser::ItemType IniParser::next()
         if (start > 0) {
             if (!previousLineWithKeyVal)
                 throw IllegalContinuationLine(lineNumber);
-            value += DELIMITER + line.substr(start, end - start + 1);
-            rawItem += line + DELIMITER;
+            value += DELIMITER;
+            value.append(line + start, end - start + 1);
+            appendRawLine();
             lineReady = false;
         } else {
             if (line[start] == '=')
                 throw MissingKey(lineNumber);
-            auto eqlpos = line.find_first_of("=");
+            auto eqlpos = findChar(line, lineLength, '=', 0);
             if (eqlpos == std::string::npos)
                 throw MissingEqual(lineNumber);
-            auto endkeypos = line.find_last_not_of(" \t", eqlpos - 1);
-            auto valuepos = line.find_first_not_of(" \t", eqlpos + 1);
-            key = line.substr(start, endkeypos - start + 1);
-            if (valuepos != line.npos)
-                value = line.substr(valuepos, end - valuepos + 1);
+            auto endkeypos = findLastNotOf(line, eqlpos, " \t");
+            auto valuepos = findFirstNotOf(line, lineLength, " \t", eqlpos + 1);
+            key.assign(line + start, endkeypos - start + 1);
+            // like substr(), a value position past the end takes the rest of the line
+            if (valuepos != std::string::npos)
+                value.assign(line + valuepos,
+                             valuepos <= end + 1 ? end + 1 - valuepos : lineLength - valuepos);
             else
                 value.clear();
             previousLineWithKeyVal = true;
-            rawItem = line + DELIMITER;
+            appendRawLine();
             lineReady = false;
         }
     }
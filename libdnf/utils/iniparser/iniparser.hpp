@@ -83,8 +83,14 @@ public:
         END_OF_INPUT
     };
 
-    IniParser(const std::string & filePath);
-    IniParser(std::unique_ptr<std::istream> && inputStream);
+    /**
+    * @brief Reads the whole input into one buffer, lines are scanned in place
+    *
+    * @param keepRawItems Whether getRawItem() returns the original text of each item, which is
+    *                     only needed to write the input back
+    */
+    IniParser(const std::string & filePath, bool keepRawItems = true);
+    IniParser(std::unique_ptr<std::istream> && inputStream, bool keepRawItems = true);
     /**
     * @brief Parse one item from input file
     *
@@ -101,19 +107,27 @@ public:
     std::string & getValue() noexcept;
     const std::string & getRawItem() const noexcept;
     std::string & getRawItem() noexcept;
-    const std::string & getLine() const noexcept;
+    std::string getLine() const;
     void clearLine() noexcept;
     void trimValue() noexcept;
 
 private:
-    std::unique_ptr<std::istream> is;
-    int lineNumber;
+    void readLine() noexcept;
+    void appendRawLine();
+
+    std::string buffer;
+    std::size_t bufferPos{0};
+    bool eof{false};
+    bool keepRawItems;
+    int lineNumber{0};
     std::string section;
     std::string key;
     std::string value;
     std::string rawItem;
-    std::string line;
-    bool lineReady;
+    /// The current line is buffer[lineBegin, lineBegin + lineLength), without the delimiter
+    std::size_t lineBegin{0};
+    std::size_t lineLength{0};
+    bool lineReady{false};
 };
 
 inline const std::string & IniParser::getSection() const noexcept { return section; }
@@ -123,7 +137,7 @@ inline const std::string & IniParser::getValue() const noexcept { return value;
 inline std::string & IniParser::getValue() noexcept { return value; }
 inline const std::string & IniParser::getRawItem() const noexcept { return rawItem; }
 inline std::string & IniParser::getRawItem() noexcept { return rawItem; }
-inline const std::string & IniParser::getLine() const noexcept { return line; }
-inline void IniParser::clearLine() noexcept { line.clear(); }
+inline std::string IniParser::getLine() const { return buffer.substr(lineBegin, lineLength); }
+inline void IniParser::clearLine() noexcept { lineLength = 0; }
 
 #endif
@@ -36,6 +36,12 @@ public:
 
     enum Source {LOG_SOURCE_LIBDNF = 0, LOG_SOURCE_LIBREPO = 1};
 
+    /// Messages less severe than maxLevel are dropped by the helpers below before they reach
+    /// write(). Callers building an expensive message can test isEnabled() first.
+    void setMaxLevel(Level level) noexcept { maxLevel = level; }
+    Level getMaxLevel() const noexcept { return maxLevel; }
+    bool isEnabled(Level level) const noexcept { return level <= maxLevel || level > Level::TRACE; }
+
     void critical(const std::string & message) { write(Level::CRITICAL, message); }
     void error(const std::string & message) { write(Level::ERROR, message); }
     void warning(const std::string & message) { write(Level::WARNING, message); }
@@ -44,22 +50,31 @@ public:
     void debug(const std::string & message) { write(Level::DEBUG, message); }
     void trace(const std::string & message) { write(Level::TRACE, message); }
 
-    void critical(int source, const std::string & message) { write(source, Level::CRITICAL, message); }
-    void error(int source, const std::string & message) { write(source, Level::ERROR, message); }
-    void warning(int source, const std::string & message) { write(source, Level::WARNING, message); }
-    void notice(int source, const std::string & message) { write(source, Level::NOTICE, message); }
-    void info(int source, const std::string & message) { write(source, Level::INFO, message); }
-    void debug(int source, const std::string & message) { write(source, Level::DEBUG, message); }
-    void trace(int source, const std::string & message) { write(source, Level::TRACE, message); }
+    void critical(int source, const std::string & message) { writeEnabled(source, Level::CRITICAL, message); }
+    void error(int source, const std::string & message) { writeEnabled(source, Level::ERROR, message); }
+    void warning(int source, const std::string & message) { writeEnabled(source, Level::WARNING, message); }
+    void notice(int source, const std::string & message) { writeEnabled(source, Level::NOTICE, message); }
+    void info(int source, const std::string & message) { writeEnabled(source, Level::INFO, message); }
+    void debug(int source, const std::string & message) { writeEnabled(source, Level::DEBUG, message); }
+    void trace(int source, const std::string & message) { writeEnabled(source, Level::TRACE, message); }
 
-    void write(Level level, const std::string & message) { write(LOG_SOURCE_LIBDNF, level, message); }
-    void write(time_t time, pid_t pid, Level level, const std::string & message) { write(LOG_SOURCE_LIBDNF, time, pid, level, message); }
+    void write(Level level, const std::string & message) { writeEnabled(LOG_SOURCE_LIBDNF, level, message); }
+    void write(time_t time, pid_t pid, Level level, const std::string & message) {
+        if (isEnabled(level))
+            write(LOG_SOURCE_LIBDNF, time, pid, level, message);
+    }
 
     virtual void write(int source, Level level, const std::string & message);
     virtual void write(int source, time_t time, pid_t pid, Level level, const std::string & message) = 0;
     virtual ~Logger() = default;
 
 private:
+    void writeEnabled(int source, Level level, const std::string & message) {
+        if (isEnabled(level))
+            write(source, level, message);
+    }
+
+    Level maxLevel{Level::TRACE};
     static constexpr const char * levelCStr[]{"CRITICAL", "ERROR", "WARNING", "NOTICE", "INFO", "DEBUG", "TRACE"};
 };
 
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _LIBDNF_PROBES_HPP_
+#define _LIBDNF_PROBES_HPP_
+
+/// LIBDNF_PROBE(name, args...) marks the USDT probe "libdnf:name" for bpftrace or SystemTap,
+/// e.g. usdt:/usr/lib64/libdnf.so.2:libdnf:load_repo_end. A probe is a single nop until a
+/// tracer attaches to it, the arguments are still evaluated, so only values at hand are
+/// passed. Without WITH_SDT the probes compile to nothing.
+///
+/// load_repo_start(const char * repoId)
+/// load_repo_end(const char * repoId, int cacheHit, int ok)
+/// make_provides_ready_start()
+/// make_provides_ready_end(int cacheHit)
+/// query_apply_start(int nfilters)
+/// query_apply_end(int cacheHit)
+/// query_filter_start(int keyname, int cmpType)
+/// query_filter_end(int keyname, int cmpType)
+/// goal_solve_start(int njobs)
+/// goal_solve_end(int problems, int solves)
+/// module_solve_start(int nmodules)
+/// module_solve_end(int nproblems)
+/// repo_download_progress(long total, long downloaded)
+/// repo_mirror_failure(const char * url, const char * metadata)
+/// package_download_progress(long total, long downloaded)
+/// package_download_end(int status, const char * msg)
+/// swdb_transaction_begin(long id)
+/// swdb_transaction_end_start(long id, int state)
+/// swdb_transaction_end_done(long id)
+/// swdb_flush_item_states_start(long nitems)
+/// swdb_flush_item_states_end()
+
+#ifdef WITH_SDT
+#include <sys/sdt.h>
+#define LIBDNF_PROBE(...) STAP_PROBEV(libdnf, __VA_ARGS__)
+#else
+#define LIBDNF_PROBE(...) do {} while (0)
+#endif
+
+#endif // _LIBDNF_PROBES_HPP_
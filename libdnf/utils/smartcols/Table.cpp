@@ -20,6 +20,10 @@
 
 #include "Table.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+
 Table::Table()
     : table(scols_new_table())
 {
@@ -123,6 +127,94 @@ void Table::removeLines()
     scols_table_remove_lines(table);
 }
 
+static size_t rowCount(const std::vector<std::vector<std::string>> &columnValues)
+{
+    size_t rows = 0;
+    for (const auto &values : columnValues)
+        rows = std::max(rows, values.size());
+    return rows;
+}
+
+/// Returns the number of terminal cells the text needs, invalid bytes take one cell each.
+static size_t displayWidth(const char *text)
+{
+    std::mbstate_t state{};
+    size_t remaining = strlen(text);
+    size_t width = 0;
+    wchar_t wc;
+    while (remaining > 0) {
+        auto len = std::mbrtowc(&wc, text, remaining, &state);
+        if (len == static_cast<size_t>(-1) || len == static_cast<size_t>(-2)) {
+            state = std::mbstate_t{};
+            len = 1;
+            ++width;
+        } else if (len == 0) {
+            break;
+        } else {
+            auto charWidth = wcwidth(wc);
+            if (charWidth > 0)
+                width += charWidth;
+        }
+        text += len;
+        remaining -= len;
+    }
+    return width;
+}
+
+void Table::addLines(const std::vector<std::vector<std::string>> &columnValues)
+{
+    addLines(columnValues, 0, rowCount(columnValues));
+}
+
+void Table::addLines(const std::vector<std::vector<std::string>> &columnValues, size_t begin, size_t end)
+{
+    auto ncols = std::min(columnValues.size(), getNumberOfColumns());
+    for (auto row = begin; row < end; ++row) {
+        auto line = scols_table_new_line(table, nullptr);
+        if (!line)
+            throw std::runtime_error("Could not create line");
+        for (size_t col = 0; col < ncols; ++col) {
+            if (row < columnValues[col].size())
+                scols_line_set_data(line, col, columnValues[col][row].c_str());
+        }
+    }
+}
+
+void Table::printLines(const std::vector<std::vector<std::string>> &columnValues, size_t chunkSize)
+{
+    auto rows = rowCount(columnValues);
+    if (chunkSize == 0 || isJson())
+        chunkSize = std::max(rows, size_t(1));
+
+    // Fix the width of every column to its widest value, so the width is the same in every chunk
+    std::vector<std::pair<struct libscols_column *, double>> widthHints;
+    auto iter = scols_new_iter(SCOLS_ITER_FORWARD);
+    struct libscols_column *column;
+    for (size_t col = 0; scols_table_next_column(table, iter, &column) == 0; ++col) {
+        size_t width = 1;
+        if (auto header = scols_cell_get_data(scols_column_get_header(column)))
+            width = std::max(width, displayWidth(header));
+        if (col < columnValues.size()) {
+            for (const auto &value : columnValues[col])
+                width = std::max(width, displayWidth(value.c_str()));
+        }
+        widthHints.emplace_back(column, scols_column_get_whint(column));
+        scols_column_set_whint(column, width);
+    }
+    scols_free_iter(iter);
+
+    auto noheadings = isNoheadings();
+    for (size_t begin = 0; begin < rows || begin == 0; begin += chunkSize) {
+        addLines(columnValues, begin, std::min(begin + chunkSize, rows));
+        scols_print_table(table);
+        scols_table_remove_lines(table);
+        enableNoheadings(true);
+    }
+    enableNoheadings(noheadings);
+    for (const auto &hint : widthHints)
+        scols_column_set_whint(hint.first, hint.second);
+}
+
 std::string Table::toString()
 {
     char *data;
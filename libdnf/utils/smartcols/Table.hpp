@@ -104,6 +104,12 @@ public:
     std::shared_ptr<Line> newLine();
     std::shared_ptr<Line> newLine(const std::shared_ptr<Line> &parent);
     std::shared_ptr<Line> nextLine(std::vector<std::shared_ptr<Line>>::iterator &iterator) { return *(iterator++); }
+    /**
+    * @brief Adds one line per row of the column arrays, columnValues[column][row]
+    *
+    * The lines are created directly in the table without Line wrappers, getLine() does not return them.
+    */
+    void addLines(const std::vector<std::vector<std::string>> &columnValues);
 
     void reduceTermwidth(size_t reduce) { scols_table_reduce_termwidth(table, reduce); }
 
@@ -113,10 +119,22 @@ public:
     void print() { tinyformat::printf("%s\n", toString()); }
     void print(const std::shared_ptr<Line> &start, const std::shared_ptr<Line> &end) { tinyformat::printf("%s\n", toString(start, end)); }
 
+    /**
+    * @brief Prints rows given as column arrays, columnValues[column][row], to the table stream
+    *
+    * Only chunkSize rows are turned into table lines at a time. Every chunk is printed and removed
+    * before the next one is added, so big listings never have all their lines in the table.
+    * Column widths are computed from all the values first to keep the chunks aligned. The table
+    * should have no lines. JSON output is printed in one chunk.
+    */
+    void printLines(const std::vector<std::vector<std::string>> &columnValues, size_t chunkSize = 1024);
+
     std::string toString();
     std::string toString(const std::shared_ptr<Line> &start, const std::shared_ptr<Line> &end);
 
 private:
+    void addLines(const std::vector<std::vector<std::string>> &columnValues, size_t begin, size_t end);
+
     struct libscols_table *table;
 
     std::vector<std::shared_ptr<Line>> lines;
@@ -25,25 +25,39 @@ void
 SQLite3::open()
 {
     if (db == nullptr) {
-        auto result = sqlite3_open(path.c_str(), &db);
+        int flags = options.readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+        auto result = sqlite3_open_v2(path.c_str(), &db, flags, nullptr);
         if (result != SQLITE_OK) {
-            throw Error(*this, result, "Open failed");
+            // the handle is allocated even if the open fails; keep it for the error message
+            Error error(*this, result, "Open failed");
+            sqlite3_close(db);
+            db = nullptr;
+            throw error;
         }
 
         // the busy timeout must be set before executing *any* statements
         // because even setting PRAGMAs can fail with "database is locked" error
-        sqlite3_busy_timeout(db, 10000);
+        sqlite3_busy_timeout(db, options.busyTimeout);
+
+        if (options.mmapSize > 0) {
+            exec(("PRAGMA mmap_size = " + std::to_string(options.mmapSize) + ";").c_str());
+        }
 
 #if SQLITE_VERSION_NUMBER >= 3022000
         int enabled = 1;
         sqlite3_file_control(db, "main", SQLITE_FCNTL_PERSIST_WAL, &enabled);
-        if (sqlite3_db_readonly(db, "main") == 1)
+        if (options.readOnly || sqlite3_db_readonly(db, "main") == 1)
             exec("PRAGMA locking_mode = NORMAL; PRAGMA foreign_keys = ON;");
-        else
+        else if (options.wal)
             exec("PRAGMA locking_mode = NORMAL; PRAGMA journal_mode = WAL; PRAGMA foreign_keys = ON;");
+        else
+            exec("PRAGMA locking_mode = NORMAL; PRAGMA journal_mode = TRUNCATE; PRAGMA foreign_keys = ON;");
 #else
         // Journal mode WAL in readonly mode is supported from sqlite version 3.22.0
-        exec("PRAGMA locking_mode = NORMAL; PRAGMA journal_mode = TRUNCATE; PRAGMA foreign_keys = ON;");
+        if (options.readOnly)
+            exec("PRAGMA locking_mode = NORMAL; PRAGMA foreign_keys = ON;");
+        else
+            exec("PRAGMA locking_mode = NORMAL; PRAGMA journal_mode = TRUNCATE; PRAGMA foreign_keys = ON;");
 #endif
     }
 }
@@ -53,6 +67,7 @@ SQLite3::close()
 {
     if (db == nullptr)
         return;
+    clearStatementCache();
     auto result = sqlite3_close(db);
     if (result == SQLITE_BUSY) {
         sqlite3_stmt *res;
@@ -67,6 +82,47 @@ SQLite3::close()
     db = nullptr;
 }
 
+SQLite3::CachedQueryPtr
+SQLite3::getCachedQuery(const std::string &sql)
+{
+    auto it = statementCacheIndex.find(sql);
+    if (it == statementCacheIndex.end()) {
+        return CachedQueryPtr(new Query(*this, sql), CachedQueryDeleter(this, sql));
+    }
+    // the statement stays out of the cache until the caller is done with it
+    auto query = std::move(it->second->second);
+    statementCache.erase(it->second);
+    statementCacheIndex.erase(it);
+    return CachedQueryPtr(query.release(), CachedQueryDeleter(this, sql));
+}
+
+void
+SQLite3::returnCachedQuery(const std::string &sql, Query *query)
+{
+    std::unique_ptr< Query > owned(query);
+    if (db == nullptr || statementCacheIndex.count(sql) > 0) {
+        // the connection was closed or a statement with the same SQL is cached already
+        return;
+    }
+    // release the locks held by an unfinished query right away
+    owned->reset();
+    owned->clearBindings();
+    owned->freeExpandedSql();
+    statementCache.emplace_front(sql, std::move(owned));
+    statementCacheIndex[sql] = statementCache.begin();
+    if (statementCache.size() > statementCacheSize) {
+        statementCacheIndex.erase(statementCache.back().first);
+        statementCache.pop_back();
+    }
+}
+
+void
+SQLite3::clearStatementCache()
+{
+    statementCacheIndex.clear();
+    statementCache.clear();
+}
+
 void
 SQLite3::backup(const std::string &outputFile)
 {
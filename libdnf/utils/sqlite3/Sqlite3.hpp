@@ -28,10 +28,13 @@
 #include <sqlite3.h>
 
 #include <cstdint>
+#include <list>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class SQLite3 {
@@ -215,7 +218,11 @@ public:
 #endif
         }
 
-        void freeExpandedSql() { sqlite3_free(expandSql); }
+        void freeExpandedSql()
+        {
+            sqlite3_free(expandSql);
+            expandSql = nullptr;
+        }
 
         /**
          * Reset prepared query to its initial state, ready to be re-executed.
@@ -324,6 +331,56 @@ public:
         std::map< std::string, int > colsName2idx;
     };
 
+    /**
+     * Returns a query taken from the statement cache back to the cache when it goes out of scope.
+     */
+    class CachedQueryDeleter {
+    public:
+        CachedQueryDeleter() = default;
+        CachedQueryDeleter(SQLite3 *db, std::string sql)
+          : db(db)
+          , sql(std::move(sql))
+        {}
+
+        void operator()(Query *query) { db->returnCachedQuery(sql, query); }
+
+    private:
+        SQLite3 *db{nullptr};
+        std::string sql;
+    };
+
+    typedef std::unique_ptr< Query, CachedQueryDeleter > CachedQueryPtr;
+
+    /**
+     * Get a prepared query from the per-connection statement cache, keyed by the SQL text.
+     * The query is reset and its bindings are cleared, so it behaves like a newly prepared one.
+     * While the returned pointer is alive the query is owned by the caller; a nested call with
+     * the same SQL prepares another statement. Least recently used statements are finalized
+     * when more than statementCacheSize of them are cached.
+     */
+    CachedQueryPtr getCachedQuery(const std::string &sql);
+
+    /**
+     * Finalize all the cached statements.
+     */
+    void clearStatementCache();
+
+    static constexpr std::size_t statementCacheSize = 32;
+
+    /**
+     * Settings applied each time the connection is opened.
+     */
+    struct Options {
+        // open the database read-only; nothing is written on open, not even the journal mode
+        bool readOnly{false};
+        // use write-ahead logging so readers are not blocked by a writer (sqlite >= 3.22)
+        bool wal{true};
+        // how long to wait for a lock, in milliseconds
+        int busyTimeout{10000};
+        // maximum number of bytes of the database to access through mmap(), 0 disables it
+        int64_t mmapSize{0};
+    };
+
     SQLite3(const SQLite3 &) = delete;
     SQLite3 &operator=(const SQLite3 &) = delete;
 
@@ -334,9 +391,18 @@ public:
         open();
     }
 
+    SQLite3(const std::string &dbPath, const Options &options)
+      : path{dbPath}
+      , options{options}
+      , db{nullptr}
+    {
+        open();
+    }
+
     ~SQLite3() { close(); }
 
     const std::string &getPath() const { return path; }
+    const Options &getOptions() const { return options; }
 
     void open();
     void close();
@@ -350,6 +416,43 @@ public:
         }
     }
 
+    /**
+     * Groups the statements executed during its lifetime into one SQLite transaction,
+     * so they are written with a single sync. Unless commit() is called the changes are
+     * rolled back. Implemented with a savepoint, so it can be nested.
+     */
+    class Transaction {
+    public:
+        explicit Transaction(SQLite3 &db)
+          : db(db)
+        {
+            db.exec("SAVEPOINT libdnf_transaction");
+        }
+
+        Transaction(const Transaction &) = delete;
+        Transaction &operator=(const Transaction &) = delete;
+
+        void commit()
+        {
+            db.exec("RELEASE libdnf_transaction");
+            committed = true;
+        }
+
+        ~Transaction()
+        {
+            if (!committed) {
+                try {
+                    db.exec("ROLLBACK TO libdnf_transaction; RELEASE libdnf_transaction");
+                } catch (...) {
+                }
+            }
+        }
+
+    private:
+        SQLite3 &db;
+        bool committed{false};
+    };
+
     int changes() { return sqlite3_changes(db); }
 
     int64_t lastInsertRowID() { return sqlite3_last_insert_rowid(db); }
@@ -360,9 +463,16 @@ public:
     void restore(const std::string &inputFile);
 
 protected:
+    void returnCachedQuery(const std::string &sql, Query *query);
+
     std::string path;
+    Options options;
 
     sqlite3 *db;
+
+    // the most recently used statements are at the front
+    std::list< std::pair< std::string, std::unique_ptr< Query > > > statementCache;
+    std::unordered_map< std::string, decltype(statementCache)::iterator > statementCacheIndex;
 };
 
 typedef std::shared_ptr< SQLite3 > SQLite3Ptr;
@@ -9,10 +9,14 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 
 extern "C" {
+#include <solv/chksum.h>
 #include <solv/solv_xfopen.h>
+#include <solv/util.h>
 };
 
 #include <errno.h>
@@ -259,11 +263,134 @@ std::vector<std::string> getDirContent(const std::string &dirPath)
     return content;
 }
 
-void decompress(const char * inPath, const char * outPath, mode_t outMode, const char * compressType)
+namespace {
+
+// Large blocks cut the number of syscalls and calls into the decompressor
+constexpr size_t IO_BLOCK_SIZE = 256 * 1024;
+constexpr size_t IO_BLOCK_ALIGN = 4096;
+// Inputs of at least this size are read and decompressed on a separate thread
+constexpr off_t PIPELINE_MIN_SIZE = 1024 * 1024;
+constexpr int PIPELINE_BLOCKS = 4;
+
+struct FreeDeleter {
+    void operator()(void * ptr) const { free(ptr); }
+};
+
+typedef std::unique_ptr<char, FreeDeleter> IoBuffer;
+typedef std::function<bool(const char * data, size_t length)> BlockConsumer;
+
+struct IoBlock {
+    IoBuffer data;
+    size_t length{0};
+};
+
+struct DecompressPipeline {
+    FILE * inFile;
+    GAsyncQueue * freeBlocks;
+    GAsyncQueue * fullBlocks;
+    gint stop{0};
+    bool eof{false};
+};
+
+}
+
+static IoBuffer allocIoBuffer()
+{
+    void * ptr;
+    if (posix_memalign(&ptr, IO_BLOCK_ALIGN, IO_BLOCK_SIZE) != 0)
+        throw std::bad_alloc();
+    return IoBuffer(static_cast<char *>(ptr));
+}
+
+/// Passes the decompressed stream to consume() block by block.
+/// Returns false on a read error, stops early without error once consume() returns false.
+static bool readBlocks(FILE * inFile, const BlockConsumer & consume)
+{
+    auto buffer = allocIoBuffer();
+    size_t length;
+    do {
+        length = fread(buffer.get(), 1, IO_BLOCK_SIZE, inFile);
+        if (length > 0 && !consume(buffer.get(), length))
+            return true;
+    } while (length == IO_BLOCK_SIZE);
+    return feof(inFile) != 0;
+}
+
+static gpointer pipelineReader(gpointer data)
+{
+    auto pipeline = static_cast<DecompressPipeline *>(data);
+    while (true) {
+        auto block = static_cast<IoBlock *>(g_async_queue_pop(pipeline->freeBlocks));
+        if (g_atomic_int_get(&pipeline->stop)) {
+            block->length = 0;
+            pipeline->eof = true;
+        } else {
+            block->length = fread(block->data.get(), 1, IO_BLOCK_SIZE, pipeline->inFile);
+            if (block->length < IO_BLOCK_SIZE)
+                pipeline->eof = feof(pipeline->inFile) != 0;
+        }
+        // a short block is the last one, the consumer stops waiting for more
+        auto last = block->length < IO_BLOCK_SIZE;
+        g_async_queue_push(pipeline->fullBlocks, block);
+        if (last)
+            return nullptr;
+    }
+}
+
+/// Same as readBlocks(), but the decompression of the next blocks runs on a reader thread
+/// while consume() processes the current one.
+static bool readBlocksPipelined(FILE * inFile, const BlockConsumer & consume)
+{
+    std::vector<IoBlock> blocks(PIPELINE_BLOCKS);
+    for (auto & block : blocks)
+        block.data = allocIoBuffer();
+
+    DecompressPipeline pipeline;
+    pipeline.inFile = inFile;
+    pipeline.freeBlocks = g_async_queue_new();
+    pipeline.fullBlocks = g_async_queue_new();
+    for (auto & block : blocks)
+        g_async_queue_push(pipeline.freeBlocks, &block);
+
+    auto reader = g_thread_try_new("libdnf-decompress", pipelineReader, &pipeline, nullptr);
+    if (!reader) {
+        g_async_queue_unref(pipeline.freeBlocks);
+        g_async_queue_unref(pipeline.fullBlocks);
+        return readBlocks(inFile, consume);
+    }
+
+    bool stopped = false;
+    while (true) {
+        auto block = static_cast<IoBlock *>(g_async_queue_pop(pipeline.fullBlocks));
+        if (!stopped && block->length > 0 && !consume(block->data.get(), block->length)) {
+            stopped = true;
+            g_atomic_int_set(&pipeline.stop, 1);
+        }
+        if (block->length < IO_BLOCK_SIZE)
+            break;
+        g_async_queue_push(pipeline.freeBlocks, block);
+    }
+    g_thread_join(reader);
+    g_async_queue_unref(pipeline.freeBlocks);
+    g_async_queue_unref(pipeline.fullBlocks);
+    return pipeline.eof;
+}
+
+static std::string decompressFile(const char * inPath, const char * outPath, mode_t outMode,
+                                  const char * compressType, const char * checksumType)
 {
+    Id checksumId = 0;
+    if (checksumType) {
+        checksumId = solv_chksum_str2type(checksumType);
+        if (!checksumId)
+            throw libdnf::Error(tfm::format("Unknown checksum type %s", checksumType));
+    }
     auto inFd = open(inPath, O_RDONLY);
     if (inFd == -1)
         throw std::runtime_error(tfm::format("Error opening %s: %s", inPath, strerror(errno)));
+    posix_fadvise(inFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    struct stat inStat;
+    bool pipelined = fstat(inFd, &inStat) == 0 && inStat.st_size >= PIPELINE_MIN_SIZE;
     if (!compressType)
         compressType = inPath;
     auto inFile = solv_xfopen_fd(compressType, inFd, "r");
@@ -277,28 +404,57 @@ void decompress(const char * inPath, const char * outPath, mode_t outMode, const
         fclose(inFile);
         throw std::runtime_error(tfm::format("Error opening %s: %s", outPath, strerror(err)));
     }
-    char buf[4096];
-    while (auto readBytes = fread(buf, 1, sizeof(buf), inFile)) {
-        auto writtenBytes = write(outFd, buf, readBytes);
-        if (writtenBytes == -1) {
-            int err = errno;
-            close(outFd);
-            fclose(inFile);
-            throw std::runtime_error(tfm::format("Error writing to %s: %s", outPath, strerror(err)));
-        }
-        if (writtenBytes != static_cast<int>(readBytes)) {
-            close(outFd);
-            fclose(inFile);
-            throw std::runtime_error(tfm::format("Unknown error while writing to %s", outPath));
+    auto chksum = checksumId ? solv_chksum_create(checksumId) : nullptr;
+
+    std::string writeError;
+    auto consume = [&](const char * data, size_t length) -> bool {
+        if (chksum)
+            solv_chksum_add(chksum, data, static_cast<int>(length));
+        while (length > 0) {
+            auto writtenBytes = write(outFd, data, length);
+            if (writtenBytes == -1) {
+                if (errno == EINTR)
+                    continue;
+                writeError = tfm::format("Error writing to %s: %s", outPath, strerror(errno));
+                return false;
+            }
+            if (writtenBytes == 0) {
+                writeError = tfm::format("Unknown error while writing to %s", outPath);
+                return false;
+            }
+            data += writtenBytes;
+            length -= static_cast<size_t>(writtenBytes);
         }
-    }
-    if (!feof(inFile)) {
-        close(outFd);
-        fclose(inFile);
-        throw std::runtime_error(tfm::format("Unknown error while reading %s", inPath));
-    }
+        return true;
+    };
+    auto readOk = pipelined ? readBlocksPipelined(inFile, consume) : readBlocks(inFile, consume);
+
     close(outFd);
     fclose(inFile);
+    std::string checksum;
+    if (chksum) {
+        int length;
+        auto bin = solv_chksum_get(chksum, &length);
+        std::vector<char> hex(2 * length + 1);
+        checksum = solv_bin2hex(bin, length, hex.data());
+        solv_chksum_free(chksum, nullptr);
+    }
+    if (!writeError.empty())
+        throw std::runtime_error(writeError);
+    if (!readOk)
+        throw std::runtime_error(tfm::format("Unknown error while reading %s", inPath));
+    return checksum;
+}
+
+void decompress(const char * inPath, const char * outPath, mode_t outMode, const char * compressType)
+{
+    decompressFile(inPath, outPath, outMode, compressType, nullptr);
+}
+
+std::string decompressWithChecksum(const char * inPath, const char * outPath, mode_t outMode,
+                                   const char * checksumType, const char * compressType)
+{
+    return decompressFile(inPath, outPath, outMode, compressType, checksumType);
 }
 
 static void checksum(const char * type, const char * inPath, const char * checksum_valid, bool * valid_out, gchar ** calculated_out)
@@ -314,6 +470,7 @@ static void checksum(const char * type, const char * inPath, const char * checks
 
     if (inFd == -1)
         throw libdnf::Error(tfm::format("Error opening %s: %s", inPath, strerror(errno)));
+    posix_fadvise(inFd, 0, 0, POSIX_FADV_SEQUENTIAL);
 
     auto ret = lr_checksum_fd_compare(lr_type,
                       inFd,
@@ -350,6 +507,20 @@ std::string checksum_value(const char * type, const char * inPath)
     return out;
 }
 
+void removeUnresumable(const char * path, const char * type, const char * valid_checksum, int64_t expectedSize)
+{
+    struct stat buf;
+    if (expectedSize <= 0 || stat(path, &buf) != 0 || !S_ISREG(buf.st_mode) || buf.st_size < expectedSize)
+        return;
+    try {
+        if (checksum_check(type, path, valid_checksum))
+            return;
+    } catch (const libdnf::Error &) {
+        return;
+    }
+    unlink(path);
+}
+
 }
 
 namespace numeric {
@@ -10,6 +10,7 @@
 #include "libdnf/sack/advisory.hpp"
 #include "libdnf/dnf-utils.h"
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
@@ -69,6 +70,22 @@ std::vector<std::string> getDirContent(const std::string &dirPath);
 */
 void decompress(const char * inPath, const char * outPath, mode_t outMode, const char * compressType = nullptr);
 
+/**
+* @brief Decompress file and checksum the decompressed data in the same pass.
+*
+* Large inputs are read and decompressed on a separate thread while the previous block
+* is being checksummed and written.
+*
+* @param inPath Path to input (compressed) file
+* @param outPath Path to output (decompressed) file
+* @param outMode Mode of created (output) file
+* @param checksumType Checksum type ("sha1", "sha256" etc). Raises libdnf::Error if invalid.
+* @param compressType Type of compression (".bz2", ".gz", ...), nullptr - detect from inPath filename. Defaults to nullptr.
+* @return hexadecimal encoded checksum of the decompressed data
+*/
+std::string decompressWithChecksum(const char * inPath, const char * outPath, mode_t outMode,
+                                   const char * checksumType, const char * compressType = nullptr);
+
 /**
 * @brief checksum file and return if matching.
 *
@@ -84,6 +101,19 @@ bool checksum_check(const char * type, const char * inPath, const char * valid_c
 * @param inPath Path to input file
 */
 std::string checksum_value(const char * type, const char * inPath);
+/**
+* @brief Remove a leftover download that cannot be resumed.
+*
+* A shorter file is kept, the download continues from its end. A file of at least
+* the expected size which does not match the checksum is removed, resuming it
+* would request an empty range.
+*
+* @param path Path to the downloaded file
+* @param type Checksum type ("sha", "sha1", "sha256" etc).
+* @param valid_checksum hexadecimal encoded checksum string.
+* @param expectedSize Size of the complete file, the file is kept if not positive.
+*/
+void removeUnresumable(const char * path, const char * type, const char * valid_checksum, int64_t expectedSize);
 }
 
 namespace numeric {
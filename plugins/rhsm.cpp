@@ -164,3 +164,8 @@ int pluginHook(PluginHandle * handle, PluginHookId id, DnfPluginHookData * hookD
     }
     return 1;
 }
+
+PluginHookMask pluginGetHookMask(void)
+{
+    return PLUGIN_HOOK_MASK(PLUGIN_HOOK_ID_CONTEXT_PRE_REPOS_RELOAD);
+}
@@ -52,9 +52,11 @@ __all__ = [
     # functions
     'chksum_name', 'chksum_type', 'split_nevra', 'convert_hawkey_reason',
     # classes
-    'Goal', 'NEVRA', 'NSVCAP', 'Package', 'Query', 'Repo', 'Sack', 'Selector', 'Subject']
+    'Goal', 'NEVRA', 'NSVCAP', 'Package', 'PackageSequence', 'Query', 'Repo', 'Sack', 'Selector',
+    'Subject']
 
 NEVRA = _hawkey.NEVRA
+PackageSequence = _hawkey.PackageSequence
 Query = _hawkey.Query
 Selector = _hawkey.Selector
 
@@ -32,6 +32,7 @@
 #include "hy-goal-private.hpp"
 #include "iutil-py.hpp"
 #include "package-py.hpp"
+#include "packagesequence-py.hpp"
 #include "selector-py.hpp"
 #include "sack-py.hpp"
 #include "query-py.hpp"
@@ -218,8 +219,16 @@ goal_init(_GoalObject *self, PyObject *args, PyObject *kwds) try
 /* object methods */
 
 static PyObject *
-distupgrade_all(_GoalObject *self, PyObject *unused) try
+distupgrade_all(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
+    const char *kwlist[] = {"preresolve", NULL};
+    int preresolve = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i", (char**) kwlist, &preresolve))
+        return NULL;
+    if (preresolve) {
+        self->goal->distupgradePreresolved();
+        Py_RETURN_NONE;
+    }
     int ret = hy_goal_distupgrade_all(self->goal);
     return op_ret2exc(ret);
 } CATCH_TO_PYTHON
@@ -255,6 +264,23 @@ set_protect_running_kernel(_GoalObject *self, PyObject * value, void * closure)
     return 0;
 } CATCH_TO_PYTHON_INT
 
+static PyObject *
+get_reuse_solver(_GoalObject *self, void * unused) try
+{
+    return PyBool_FromLong(self->goal->getReuseSolver());
+} CATCH_TO_PYTHON
+
+static int
+set_reuse_solver(_GoalObject *self, PyObject * value, void * closure) try
+{
+    if(!PyBool_Check(value)) {
+        PyErr_SetString(PyExc_TypeError, "Only Bool Type accepted");
+        return -1;
+    }
+    self->goal->setReuseSolver(PyObject_IsTrue(value));
+    return 0;
+} CATCH_TO_PYTHON_INT
+
 static PyObject *
 erase(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
@@ -364,6 +390,16 @@ req_length(_GoalObject *self, PyObject *unused) try
     return PyLong_FromLong(hy_goal_req_length(self->goal));
 } CATCH_TO_PYTHON
 
+static PyObject *
+req_truncate(_GoalObject *self, PyObject *length) try
+{
+    long c_length = PyLong_AsLong(length);
+    if (PyErr_Occurred())
+        return NULL;
+    self->goal->truncateJobs(c_length);
+    Py_RETURN_NONE;
+} CATCH_TO_PYTHON
+
 static PyObject *
 add_protected(_GoalObject *self, PyObject *seq) try
 {
@@ -409,7 +445,11 @@ run(_GoalObject *self, PyObject *args, PyObject *kwds) try
     if (!args_run_parse(args, kwds, &flags, NULL))
         return NULL;
 
-    int ret = hy_goal_run_flags(self->goal, static_cast<DnfGoalActions>(flags));
+    int ret;
+    {
+        PycompReleaseGIL releaseGIL;
+        ret = hy_goal_run_flags(self->goal, static_cast<DnfGoalActions>(flags));
+    }
     if (!ret)
         Py_RETURN_TRUE;
     Py_RETURN_FALSE;
@@ -421,6 +461,26 @@ count_problems(_GoalObject *self, PyObject *unused) try
     return PyLong_FromLong(hy_goal_count_problems(self->goal));
 } CATCH_TO_PYTHON
 
+static PyObject *
+get_stats(_GoalObject *self, PyObject *unused) try
+{
+    auto stats = self->goal->getStats();
+    return Py_BuildValue("{s:d,s:d,s:d,s:d,s:d,s:d,s:i,s:i,s:i,s:i,s:i,s:i,s:i}",
+        "recompute_considered_ms", stats.recomputeConsideredMs,
+        "make_provides_ready_ms", stats.makeProvidesReadyMs,
+        "solve_ms", stats.solveMs,
+        "installonly_ms", stats.installonlyMs,
+        "create_transaction_ms", stats.createTransactionMs,
+        "total_ms", stats.totalMs,
+        "jobs", stats.jobs,
+        "solves", stats.solves,
+        "decisions", stats.decisions,
+        "rules", stats.rules,
+        "pkg_rules", stats.pkgRules,
+        "job_rules", stats.jobRules,
+        "learnt_rules", stats.learntRules);
+} CATCH_TO_PYTHON
+
 /**
  * Reports problems described in strings.
  *
@@ -495,7 +555,11 @@ write_debugdata(_GoalObject *self, PyObject *dir_str) try
     if (!dir.getCString())
         return NULL;
 
-    gboolean ret = hy_goal_write_debugdata(self->goal, dir.getCString(), &error);
+    gboolean ret;
+    {
+        PycompReleaseGIL releaseGIL;
+        ret = hy_goal_write_debugdata(self->goal, dir.getCString(), &error);
+    }
     if (!ret) {
         op_error2exc(error);
         return NULL;
@@ -503,24 +567,37 @@ write_debugdata(_GoalObject *self, PyObject *dir_str) try
     Py_RETURN_NONE;
 } CATCH_TO_PYTHON
 
+/* sets the exception for an error of listing the goal results, false for other errors */
+static bool
+list_error2exc(int code)
+{
+    switch (code) {
+    case DNF_ERROR_INTERNAL_ERROR:
+        PyErr_SetString(HyExc_Value, "Goal has not been run yet.");
+        return true;
+    case DNF_ERROR_NO_SOLUTION:
+        PyErr_SetString(HyExc_Runtime, "Goal could not find a solution.");
+        return true;
+    default:
+        return false;
+    }
+}
+
 static PyObject *
 list_generic(_GoalObject *self, GPtrArray *(*func)(HyGoal, GError **))
 {
     g_autoptr(GError) error = NULL;
-    GPtrArray *plist = func(self->goal, &error);
+    GPtrArray *plist;
+    {
+        // listing the unneeded packages runs the solver
+        PycompReleaseGIL releaseGIL;
+        plist = func(self->goal, &error);
+    }
     PyObject *list;
 
     if (!plist) {
-        switch (error->code) {
-        case DNF_ERROR_INTERNAL_ERROR:
-            PyErr_SetString(HyExc_Value, "Goal has not been run yet.");
-            break;
-        case DNF_ERROR_NO_SOLUTION:
-            PyErr_SetString(HyExc_Runtime, "Goal could not find a solution.");
-            break;
-        default:
+        if (!list_error2exc(error->code))
             assert(0);
-        }
         return NULL;
     }
     list = packagelist_to_pylist(plist, self->sack);
@@ -528,52 +605,106 @@ list_generic(_GoalObject *self, GPtrArray *(*func)(HyGoal, GError **))
     return list;
 }
 
+/* the result of method as a PackageSequence, the Package objects are created on access */
 static PyObject *
-list_erasures(_GoalObject *self, PyObject *unused) try
+list_sequence(_GoalObject *self, libdnf::PackageSet (libdnf::Goal::*method)())
 {
-    return list_generic(self, hy_goal_list_erasures);
+    std::unique_ptr<libdnf::PackageSet> pset;
+    try {
+        PycompReleaseGIL releaseGIL;
+        pset.reset(new libdnf::PackageSet((self->goal->*method)()));
+    } catch (const libdnf::Goal::Error & e) {
+        if (!list_error2exc(e.getErrCode()))
+            throw;
+        return NULL;
+    }
+    return packageSequenceFromPackageSet(pset.get(), self->sack);
+}
+
+/* list_generic(), or list_sequence() with lazy=True */
+static PyObject *
+list_lazy(_GoalObject *self, PyObject *args, PyObject *kwds,
+          GPtrArray *(*func)(HyGoal, GError **), libdnf::PackageSet (libdnf::Goal::*method)())
+{
+    const char *kwlist[] = {"lazy", NULL};
+    PyObject *lazy = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", (char **)kwlist, &lazy))
+        return NULL;
+    if (lazy && PyObject_IsTrue(lazy))
+        return list_sequence(self, method);
+    return list_generic(self, func);
+}
+
+static PyObject *
+list_erasures(_GoalObject *self, PyObject *args, PyObject *kwds) try
+{
+    return list_lazy(self, args, kwds, hy_goal_list_erasures, &libdnf::Goal::listErasures);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_installs(_GoalObject *self, PyObject *unused) try
+list_installs(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_installs);
+    return list_lazy(self, args, kwds, hy_goal_list_installs, &libdnf::Goal::listInstalls);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_obsoleted(_GoalObject *self, PyObject *unused) try
+list_obsoleted(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_obsoleted);
+    return list_lazy(self, args, kwds, hy_goal_list_obsoleted, &libdnf::Goal::listObsoleted);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_reinstalls(_GoalObject *self, PyObject *unused) try
+list_reinstalls(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_reinstalls);
+    return list_lazy(self, args, kwds, hy_goal_list_reinstalls, &libdnf::Goal::listReinstalls);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_unneeded(_GoalObject *self, PyObject *unused) try
+list_unneeded(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_unneeded);
+    return list_lazy(self, args, kwds, hy_goal_list_unneeded, &libdnf::Goal::listUnneeded);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_suggested(_GoalObject *self, PyObject *unused) try
+list_suggested(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_suggested);
+    return list_lazy(self, args, kwds, hy_goal_list_suggested, &libdnf::Goal::listSuggested);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_downgrades(_GoalObject *self, PyObject *unused) try
+list_downgrades(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_downgrades);
+    return list_lazy(self, args, kwds, hy_goal_list_downgrades, &libdnf::Goal::listDowngrades);
 } CATCH_TO_PYTHON
 
 static PyObject *
-list_upgrades(_GoalObject *self, PyObject *unused) try
+list_upgrades(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
-    return list_generic(self, hy_goal_list_upgrades);
+    return list_lazy(self, args, kwds, hy_goal_list_upgrades, &libdnf::Goal::listUpgrades);
+} CATCH_TO_PYTHON
+
+/* all the transaction steps at once, by the names of their list_*() methods */
+static PyObject *
+list_results(_GoalObject *self, PyObject *unused) try
+{
+    const std::pair<const char *, libdnf::PackageSet (libdnf::Goal::*)()> results[] = {
+        {"erasures", &libdnf::Goal::listErasures},
+        {"installs", &libdnf::Goal::listInstalls},
+        {"obsoleted", &libdnf::Goal::listObsoleted},
+        {"reinstalls", &libdnf::Goal::listReinstalls},
+        {"downgrades", &libdnf::Goal::listDowngrades},
+        {"upgrades", &libdnf::Goal::listUpgrades},
+    };
+    UniquePtrPyObject dict(PyDict_New());
+    if (!dict)
+        return NULL;
+    for (const auto & result : results) {
+        UniquePtrPyObject sequence(list_sequence(self, result.second));
+        if (!sequence || PyDict_SetItemString(dict.get(), result.first, sequence.get()) == -1)
+            return NULL;
+    }
+    return dict.release();
 } CATCH_TO_PYTHON
 
 static PyObject *
@@ -600,6 +731,29 @@ get_reason(_GoalObject *self, PyObject *pkg) try
     return PyLong_FromLong(reason);
 } CATCH_TO_PYTHON
 
+static PyObject *
+get_reasons(_GoalObject *self, PyObject *seq) try
+{
+    HyGoal goal = self->goal;
+    UniquePtrPyObject fastSeq(PySequence_Fast(seq, "Expected a sequence."));
+    if (!fastSeq)
+        return NULL;
+    auto pset = pyseq_to_packageset(fastSeq.get(), hy_goal_get_sack(goal));
+    if (!pset)
+        return NULL;
+    auto reasons = goal->getReasons(*pset);
+
+    const unsigned count = PySequence_Size(fastSeq.get());
+    UniquePtrPyObject list(PyList_New(count));
+    if (!list)
+        return NULL;
+    for (unsigned i = 0; i < count; ++i) {
+        DnfPackage *cpkg = packageFromPyObject(PySequence_Fast_GET_ITEM(fastSeq.get(), i));
+        PyList_SET_ITEM(list.get(), i, PyLong_FromLong(reasons.at(dnf_package_get_id(cpkg))));
+    }
+    return list.release();
+} CATCH_TO_PYTHON
+
 static PyObject *
 goalToPyObject(HyGoal goal, PyObject *sack)
 {
@@ -627,7 +781,8 @@ static struct PyMethodDef goal_methods[] = {
     {"add_exclude_from_weak", (PyCFunction)add_exclude_from_weak, METH_O, NULL},
     {"reset_exclude_from_weak", (PyCFunction)reset_exclude_from_weak, METH_NOARGS, NULL},
     {"exclude_from_weak_autodetect", (PyCFunction)exclude_from_weak_autodetect, METH_NOARGS, NULL},
-    {"distupgrade_all",        (PyCFunction)distupgrade_all,        METH_NOARGS,        NULL},
+    {"distupgrade_all",        (PyCFunction)distupgrade_all,
+     METH_VARARGS | METH_KEYWORDS, NULL},
     {"distupgrade",                (PyCFunction)distupgrade,
      METH_VARARGS | METH_KEYWORDS, NULL},
     {"erase",                (PyCFunction)erase,
@@ -646,25 +801,29 @@ static struct PyMethodDef goal_methods[] = {
     // use goal.actions | hawkey.ERASE instead
     {"req_has_erase",        (PyCFunction)req_has_erase,        METH_NOARGS,        NULL},
     {"req_length",        (PyCFunction)req_length,        METH_NOARGS,        NULL},
+    {"req_truncate",        (PyCFunction)req_truncate,        METH_O,        NULL},
     {"run",                (PyCFunction)run,
      METH_VARARGS | METH_KEYWORDS, NULL},
     {"count_problems",        (PyCFunction)count_problems,        METH_NOARGS,        NULL},
+    {"get_stats",        (PyCFunction)get_stats,        METH_NOARGS,        NULL},
     {"problem_conflicts",(PyCFunction)problem_conflicts,        METH_VARARGS | METH_KEYWORDS,                NULL},
     {"problem_broken_dependency",(PyCFunction)problem_broken_dependency,        METH_VARARGS | METH_KEYWORDS,                NULL},
     {"problem_rules", (PyCFunction)problem_rules,        METH_NOARGS,                NULL},
     {"log_decisions",   (PyCFunction)log_decisions,        METH_NOARGS,        NULL},
     {"write_debugdata", (PyCFunction)write_debugdata,        METH_O,                NULL},
-    {"list_erasures",        (PyCFunction)list_erasures,        METH_NOARGS,        NULL},
-    {"list_installs",        (PyCFunction)list_installs,        METH_NOARGS,        NULL},
-    {"list_obsoleted",        (PyCFunction)list_obsoleted,        METH_NOARGS,        NULL},
-    {"list_reinstalls",        (PyCFunction)list_reinstalls,        METH_NOARGS,        NULL},
-    {"list_unneeded",        (PyCFunction)list_unneeded,        METH_NOARGS,        NULL},
-    {"list_suggested",       (PyCFunction)list_suggested,       METH_NOARGS,        NULL},
-    {"list_downgrades",        (PyCFunction)list_downgrades,        METH_NOARGS,        NULL},
-    {"list_upgrades",        (PyCFunction)list_upgrades,        METH_NOARGS,        NULL},
+    {"list_erasures",        (PyCFunction)list_erasures,        METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_installs",        (PyCFunction)list_installs,        METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_obsoleted",        (PyCFunction)list_obsoleted,        METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_reinstalls",        (PyCFunction)list_reinstalls,        METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_unneeded",        (PyCFunction)list_unneeded,        METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_suggested",       (PyCFunction)list_suggested,       METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_downgrades",        (PyCFunction)list_downgrades,        METH_VARARGS | METH_KEYWORDS,        NULL},
+    {"list_results",         (PyCFunction)list_results,         METH_NOARGS,        NULL},
+    {"list_upgrades",        (PyCFunction)list_upgrades,        METH_VARARGS | METH_KEYWORDS,        NULL},
     {"obsoleted_by_package",(PyCFunction)obsoleted_by_package,
      METH_O, NULL},
     {"get_reason",        (PyCFunction)get_reason,        METH_O,                NULL},
+    {"get_reasons",       (PyCFunction)get_reasons,       METH_O,                NULL},
     {NULL}                      /* sentinel */
 };
 
@@ -677,6 +836,7 @@ static PyGetSetDef goal_getsetters[] = {
     {(char*)"actions",        (getter)get_actions, NULL, NULL, NULL},
     {(char*)"protect_running_kernel", (getter)get_protect_running_kernel,
         (setter)set_protect_running_kernel, NULL, NULL},
+    {(char*)"reuse_solver", (getter)get_reuse_solver, (setter)set_reuse_solver, NULL, NULL},
     {NULL}                /* sentinel */
 };
 
@@ -43,8 +43,10 @@
 #include "goal-py.hpp"
 #include "nevra-py.hpp"
 #include "nsvcap-py.hpp"
+#include "numbercolumn-py.hpp"
 #include "package-py.hpp"
 #include "packagedelta-py.hpp"
+#include "packagesequence-py.hpp"
 #include "query-py.hpp"
 #include "reldep-py.hpp"
 #include "repo-py.hpp"
@@ -180,6 +182,18 @@ PYCOMP_MOD_INIT(_hawkey)
         return PYCOMP_MOD_ERROR_VAL;
     Py_INCREF(&packageDelta_Type);
     PyModule_AddObject(m, "PackageDelta", (PyObject *)&packageDelta_Type);
+    /* _hawkey.NumberColumn */
+    if (PyType_Ready(&numberColumn_Type) < 0)
+        return PYCOMP_MOD_ERROR_VAL;
+    Py_INCREF(&numberColumn_Type);
+    PyModule_AddObject(m, "NumberColumn", (PyObject *)&numberColumn_Type);
+    /* _hawkey.PackageSequence */
+    if (PyType_Ready(&packageSequence_Type) < 0)
+        return PYCOMP_MOD_ERROR_VAL;
+    if (PyType_Ready(&packageSequenceIter_Type) < 0)
+        return PYCOMP_MOD_ERROR_VAL;
+    Py_INCREF(&packageSequence_Type);
+    PyModule_AddObject(m, "PackageSequence", (PyObject *)&packageSequence_Type);
     /* _hawkey.Query */
     if (PyType_Ready(&query_Type) < 0)
         return PYCOMP_MOD_ERROR_VAL;
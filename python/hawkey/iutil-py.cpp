@@ -131,30 +131,40 @@ advisoryRefVectorToPylist(const std::vector<libdnf::AdvisoryRef> & advisoryRefs,
     return list.release();
 }
 
+PyObject *
+changelog_to_pydict(time_t itemts, const char * author, const char * text)
+{
+    PyDateTime_IMPORT;
+
+    UniquePtrPyObject d(PyDict_New());
+    if (!d)
+        return NULL;
+    UniquePtrPyObject pyAuthor(PyUnicode_FromString(author));
+    if (PyDict_SetItemString(d.get(), "author", pyAuthor.get()) == -1)
+        return NULL;
+    UniquePtrPyObject description(PyUnicode_FromString(text));
+    if (PyDict_SetItemString(d.get(), "text", description.get()) == -1)
+        return NULL;
+    struct tm ts;
+    ts = *localtime(&itemts);
+    UniquePtrPyObject timestamp(PyDate_FromDate(ts.tm_year+1900, ts.tm_mon+1, ts.tm_mday));
+    if (PyDict_SetItemString(d.get(), "timestamp", timestamp.get()) == -1)
+        return NULL;
+    return d.release();
+}
+
 PyObject *
 changelogslist_to_pylist(const std::vector<libdnf::Changelog> & changelogslist)
 {
     UniquePtrPyObject list(PyList_New(0));
     if (!list)
         return NULL;
-    PyDateTime_IMPORT;
 
     for (auto & citem: changelogslist) {
-        UniquePtrPyObject d(PyDict_New());
+        UniquePtrPyObject d(changelog_to_pydict(citem.getTimestamp(), citem.getAuthor().c_str(),
+                                                citem.getText().c_str()));
         if (!d)
             return NULL;
-        UniquePtrPyObject author(PyUnicode_FromString(citem.getAuthor().c_str()));
-        if (PyDict_SetItemString(d.get(), "author", author.get()) == -1)
-            return NULL;
-        UniquePtrPyObject description(PyUnicode_FromString(citem.getText().c_str()));
-        if (PyDict_SetItemString(d.get(), "text", description.get()) == -1)
-            return NULL;
-        time_t itemts=citem.getTimestamp();
-        struct tm ts;
-        ts = *localtime(&itemts);
-        UniquePtrPyObject timestamp(PyDate_FromDate(ts.tm_year+1900, ts.tm_mon+1, ts.tm_mday));
-        if (PyDict_SetItemString(d.get(), "timestamp", timestamp.get()) == -1)
-            return NULL;
         if (PyList_Append(list.get(), d.get()) == -1)
             return NULL;
     }
@@ -66,6 +66,7 @@ PyObject *advisorylist_to_pylist(const GPtrArray *advisorylist, PyObject *sack);
 PyObject *advisoryPkgVectorToPylist(const std::vector<libdnf::AdvisoryPkg> & advisorypkgs);
 PyObject *advisoryRefVectorToPylist(const std::vector<libdnf::AdvisoryRef> & advisoryRefs,
                                     PyObject *sack);
+PyObject *changelog_to_pydict(time_t timestamp, const char * author, const char * text);
 PyObject *changelogslist_to_pylist(const std::vector<libdnf::Changelog> & changelogslist);
 PyObject *packagelist_to_pylist(GPtrArray *plist, PyObject *sack);
 PyObject * packageset_to_pylist(const DnfPackageSet * pset, PyObject * sack);
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// pyhawkey
+#include "exception-py.hpp"
+#include "numbercolumn-py.hpp"
+
+#include "pycomp.hpp"
+
+#include <memory>
+
+typedef struct {
+    PyObject_HEAD
+    std::vector<unsigned long long> *numbers;
+    // shapes and strides of the exported buffer, the byte ones serve requests without format
+    Py_ssize_t length;
+    Py_ssize_t itemsize;
+    Py_ssize_t byteLength;
+    Py_ssize_t byteStride;
+} _NumberColumnObject;
+
+static_assert(sizeof(unsigned long long) == 8, "the buffer format expects 64-bit numbers");
+
+PyObject *
+numberColumnFromVector(std::vector<unsigned long long> &&numbers) try
+{
+    std::unique_ptr<std::vector<unsigned long long>> owned(
+        new std::vector<unsigned long long>(std::move(numbers)));
+    _NumberColumnObject *self = PyObject_New(_NumberColumnObject, &numberColumn_Type);
+    if (!self)
+        return NULL;
+    self->length = owned->size();
+    self->itemsize = sizeof(unsigned long long);
+    self->byteLength = self->length * self->itemsize;
+    self->byteStride = 1;
+    self->numbers = owned.release();
+    return (PyObject *)self;
+} CATCH_TO_PYTHON
+
+/* functions on the type */
+
+static void
+numberColumn_dealloc(_NumberColumnObject *self)
+{
+    delete self->numbers;
+    Py_TYPE(self)->tp_free(self);
+}
+
+static Py_ssize_t
+numberColumn_len(_NumberColumnObject *self)
+{
+    return self->length;
+}
+
+static PyObject *
+numberColumn_item(_NumberColumnObject *self, Py_ssize_t index)
+{
+    if (index < 0 || index >= self->length) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
+        return NULL;
+    }
+    return PyLong_FromUnsignedLongLong((*self->numbers)[index]);
+}
+
+static PySequenceMethods numberColumn_sequence = {
+    (lenfunc)numberColumn_len,              /* sq_length */
+    0,                                      /* sq_concat */
+    0,                                      /* sq_repeat */
+    (ssizeargfunc)numberColumn_item,        /* sq_item */
+};
+
+#if PY_MAJOR_VERSION >= 3
+static int
+numberColumn_getbuffer(_NumberColumnObject *self, Py_buffer *view, int flags)
+{
+    static unsigned long long empty;
+
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "NumberColumn is read-only");
+        view->obj = NULL;
+        return -1;
+    }
+    view->obj = (PyObject *)self;
+    Py_INCREF(self);
+    view->buf = self->numbers->empty() ? &empty : self->numbers->data();
+    view->len = self->byteLength;
+    view->readonly = 1;
+    view->ndim = 1;
+    if (flags & PyBUF_FORMAT) {
+        // values are sizes, times and epochs, all of them fit the signed type
+        view->format = (char *)"q";
+        view->itemsize = self->itemsize;
+        view->shape = (flags & PyBUF_ND) ? &self->length : NULL;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->itemsize : NULL;
+    } else {
+        view->format = NULL;
+        view->itemsize = 1;
+        view->shape = (flags & PyBUF_ND) ? &self->byteLength : NULL;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->byteStride : NULL;
+    }
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs numberColumn_buffer = {
+    (getbufferproc)numberColumn_getbuffer,  /* bf_getbuffer */
+    0,                                      /* bf_releasebuffer */
+};
+#endif
+
+/* type */
+
+PyTypeObject numberColumn_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_hawkey.NumberColumn",           /*tp_name*/
+    sizeof(_NumberColumnObject),      /*tp_basicsize*/
+    0,                                /*tp_itemsize*/
+    (destructor) numberColumn_dealloc, /*tp_dealloc*/
+    0,                                /*tp_print*/
+    0,                                /*tp_getattr*/
+    0,                                /*tp_setattr*/
+    0,                                /*tp_compare*/
+    0,                                /*tp_repr*/
+    0,                                /*tp_as_number*/
+    &numberColumn_sequence,           /*tp_as_sequence*/
+    0,                                /*tp_as_mapping*/
+    0,                                /*tp_hash */
+    0,                                /*tp_call*/
+    0,                                /*tp_str*/
+    0,                                /*tp_getattro*/
+    0,                                /*tp_setattro*/
+#if PY_MAJOR_VERSION >= 3
+    &numberColumn_buffer,             /*tp_as_buffer*/
+#else
+    0,                                /*tp_as_buffer*/
+#endif
+    Py_TPFLAGS_DEFAULT,               /*tp_flags*/
+    "Column of package numbers",      /* tp_doc */
+};
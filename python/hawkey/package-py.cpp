@@ -221,20 +221,6 @@ get_str(_PackageObject *self, void *closure) try
     return PyUnicode_FromString(cstr);
 } CATCH_TO_PYTHON
 
-static PyObject *
-get_str_array(_PackageObject *self, void *closure) try
-{
-    gchar ** (*func)(DnfPackage*);
-    gchar ** strv;
-
-    func = (gchar **(*)(DnfPackage*))closure;
-    strv = func(self->package);
-    PyObject *list = strlist_to_pylist((const char **)strv);
-    g_strfreev(strv);
-
-    return list;
-} CATCH_TO_PYTHON
-
 static PyObject *
 get_chksum(_PackageObject *self, void *closure) try
 {
@@ -260,10 +246,45 @@ get_chksum(_PackageObject *self, void *closure) try
     return res;
 } CATCH_TO_PYTHON
 
+static PyObject *
+get_files(_PackageObject *self, void *closure) try
+{
+    UniquePtrPyObject list(PyList_New(0));
+    if (!list)
+        return NULL;
+    dnf_package_foreach_file(self->package, [&list](const char *file) {
+        UniquePtrPyObject str(PyString_FromString(file));
+        if (!str || PyList_Append(list.get(), str.get()) == -1) {
+            list.reset();
+            return false;
+        }
+        return true;
+    });
+    return list.release();
+} CATCH_TO_PYTHON
+
+static PyObject *
+changelogs_to_pylist(DnfPackage *pkg, std::size_t limit, time_t since)
+{
+    UniquePtrPyObject list(PyList_New(0));
+    if (!list)
+        return NULL;
+    dnf_package_foreach_changelog(pkg, limit, since,
+        [&list](time_t timestamp, const char *author, const char *text) {
+            UniquePtrPyObject d(changelog_to_pydict(timestamp, author, text));
+            if (!d || PyList_Append(list.get(), d.get()) == -1) {
+                list.reset();
+                return false;
+            }
+            return true;
+        });
+    return list.release();
+}
+
 static PyObject *
 get_changelogs(_PackageObject *self, void *closure) try
 {
-    return changelogslist_to_pylist(dnf_package_get_changelogs(self->package));
+    return changelogs_to_pylist(self->package, 0, 0);
 } CATCH_TO_PYTHON
 
 static PyObject *
@@ -289,8 +310,7 @@ get_local_baseurl(_PackageObject *self) try
 static PyGetSetDef package_getsetters[] = {
     {(char*)"baseurl",        (getter)get_str, NULL, NULL,
      (void *)dnf_package_get_baseurl},
-    {(char*)"files",        (getter)get_str_array, NULL, NULL,
-     (void *)dnf_package_get_files},
+    {(char*)"files",        (getter)get_files, NULL, NULL, NULL},
     {(char*)"changelogs", (getter)get_changelogs, NULL, NULL, NULL},
     {(char*)"hdr_end", (getter)get_num, NULL, NULL, (void *)dnf_package_get_hdr_end},
     {(char*)"location",  (getter)get_str, NULL, NULL,
@@ -408,10 +428,24 @@ get_advisories(_PackageObject *self, PyObject *args) try
 } CATCH_TO_PYTHON
 
 
+static PyObject *
+get_changelogs_limited(_PackageObject *self, PyObject *args, PyObject *kwds) try
+{
+    const char *kwlist[] = {"limit", "since", NULL};
+    unsigned int limit = 0;
+    long long since = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|IL", (char**) kwlist, &limit, &since))
+        return NULL;
+
+    return changelogs_to_pylist(self->package, limit, static_cast<time_t>(since));
+} CATCH_TO_PYTHON
+
 static struct PyMethodDef package_methods[] = {
     {"evr_cmp", (PyCFunction)evr_cmp, METH_O, NULL},
     {"get_delta_from_evr", (PyCFunction)get_delta_from_evr, METH_O, NULL},
     {"get_advisories", (PyCFunction)get_advisories, METH_VARARGS, NULL},
+    {"get_changelogs", (PyCFunction)get_changelogs_limited, METH_VARARGS | METH_KEYWORDS, NULL},
     {"_is_in_active_module", (PyCFunction)is_in_active_module, METH_NOARGS, NULL},
     {"get_local_baseurl", (PyCFunction)get_local_baseurl, METH_NOARGS, NULL},
     {NULL}                      /* sentinel */
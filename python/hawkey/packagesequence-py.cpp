@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// hawkey
+#include "sack/packageset.hpp"
+
+// pyhawkey
+#include "exception-py.hpp"
+#include "iutil-py.hpp"
+#include "packagesequence-py.hpp"
+#include "sack-py.hpp"
+
+#include "pycomp.hpp"
+
+#include <memory>
+#include <vector>
+
+typedef struct {
+    PyObject_HEAD
+    libdnf::PackageSet *pset;
+    // ids in the set order, filled on the first access by index
+    std::vector<Id> *ids;
+    PyObject *sack;
+    // shapes and strides of the exported buffer of the ids, see packageSequence_getbuffer()
+    Py_ssize_t length;
+    Py_ssize_t itemsize;
+    Py_ssize_t byteLength;
+    Py_ssize_t byteStride;
+} _PackageSequenceObject;
+
+static_assert(sizeof(Id) == 4, "the buffer format expects 32-bit ids");
+
+typedef struct {
+    PyObject_HEAD
+    _PackageSequenceObject *sequence;
+    Id last;
+} _PackageSequenceIterObject;
+
+PyObject *
+packageSequenceFromPackageSet(const DnfPackageSet *pset, PyObject *sack) try
+{
+    std::unique_ptr<libdnf::PackageSet> copy(new libdnf::PackageSet(*pset));
+    _PackageSequenceObject *self = PyObject_New(_PackageSequenceObject, &packageSequence_Type);
+    if (!self)
+        return NULL;
+    self->pset = copy.release();
+    self->ids = NULL;
+    self->sack = sack;
+    Py_INCREF(sack);
+    return (PyObject *)self;
+} CATCH_TO_PYTHON
+
+static const std::vector<Id> &
+sequence_ids(_PackageSequenceObject *self)
+{
+    if (!self->ids) {
+        std::unique_ptr<std::vector<Id>> ids(new std::vector<Id>);
+        ids->reserve(self->pset->size());
+        for (Id id = self->pset->next(-1); id != -1; id = self->pset->next(id))
+            ids->push_back(id);
+        self->ids = ids.release();
+    }
+    return *self->ids;
+}
+
+/* functions on the type */
+
+static void
+packageSequence_dealloc(_PackageSequenceObject *self)
+{
+    delete self->pset;
+    delete self->ids;
+    Py_XDECREF(self->sack);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static Py_ssize_t
+packageSequence_len(_PackageSequenceObject *self) try
+{
+    return self->pset->size();
+} CATCH_TO_PYTHON_INT
+
+static PyObject *
+packageSequence_item(_PackageSequenceObject *self, Py_ssize_t index) try
+{
+    auto & ids = sequence_ids(self);
+    if (index < 0)
+        index += ids.size();
+    if (index < 0 || static_cast<size_t>(index) >= ids.size()) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
+        return NULL;
+    }
+    return new_package(self->sack, ids[index]);
+} CATCH_TO_PYTHON
+
+static PyObject *
+packageSequence_subscript(_PackageSequenceObject *self, PyObject *key) try
+{
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred())
+            return NULL;
+        return packageSequence_item(self, index);
+    }
+    if (!PySlice_Check(key)) {
+        PyErr_SetString(PyExc_TypeError, "list indices must be integers or slices");
+        return NULL;
+    }
+
+    auto & ids = sequence_ids(self);
+    Py_ssize_t start, stop, step, length;
+#if PY_MAJOR_VERSION < 3
+    if (PySlice_GetIndicesEx((PySliceObject *)key, ids.size(), &start, &stop, &step, &length) < 0)
+#else
+    if (PySlice_GetIndicesEx(key, ids.size(), &start, &stop, &step, &length) < 0)
+#endif
+        return NULL;
+    UniquePtrPyObject list(PyList_New(length));
+    if (!list)
+        return NULL;
+    for (Py_ssize_t i = 0, index = start; i < length; ++i, index += step) {
+        PyObject *package = new_package(self->sack, ids[index]);
+        if (!package)
+            return NULL;
+        PyList_SET_ITEM(list.get(), i, package);
+    }
+    return list.release();
+} CATCH_TO_PYTHON
+
+static PyObject *
+packageSequence_iter(_PackageSequenceObject *self)
+{
+    _PackageSequenceIterObject *iter = PyObject_New(_PackageSequenceIterObject, &packageSequenceIter_Type);
+    if (!iter)
+        return NULL;
+    Py_INCREF(self);
+    iter->sequence = self;
+    iter->last = -1;
+    return (PyObject *)iter;
+}
+
+static PySequenceMethods packageSequence_sequence = {
+    (lenfunc)packageSequence_len,           /* sq_length */
+    0,                                      /* sq_concat */
+    0,                                      /* sq_repeat */
+    (ssizeargfunc)packageSequence_item,     /* sq_item */
+};
+
+static PyMappingMethods packageSequence_mapping = {
+    (lenfunc)packageSequence_len,           /* mp_length */
+    (binaryfunc)packageSequence_subscript,  /* mp_subscript */
+    0,                                      /* mp_ass_subscript */
+};
+
+#if PY_MAJOR_VERSION >= 3
+/* the package ids in the sequence order as 32-bit integers; the ids never change once they are
+ * listed, so the buffer stays valid as long as the sequence, which keeps the sack alive */
+static int
+packageSequence_getbuffer(_PackageSequenceObject *self, Py_buffer *view, int flags) try
+{
+    static Id empty;
+
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "PackageSequence is read-only");
+        view->obj = NULL;
+        return -1;
+    }
+    auto & ids = sequence_ids(self);
+    self->length = ids.size();
+    self->itemsize = sizeof(Id);
+    self->byteLength = self->length * self->itemsize;
+    self->byteStride = 1;
+    view->obj = (PyObject *)self;
+    Py_INCREF(self);
+    view->buf = ids.empty() ? &empty : const_cast<Id *>(ids.data());
+    view->len = self->byteLength;
+    view->readonly = 1;
+    view->ndim = 1;
+    if (flags & PyBUF_FORMAT) {
+        view->format = (char *)"i";
+        view->itemsize = self->itemsize;
+        view->shape = (flags & PyBUF_ND) ? &self->length : NULL;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->itemsize : NULL;
+    } else {
+        view->format = NULL;
+        view->itemsize = 1;
+        view->shape = (flags & PyBUF_ND) ? &self->byteLength : NULL;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->byteStride : NULL;
+    }
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+} CATCH_TO_PYTHON_INT
+
+static PyBufferProcs packageSequence_buffer = {
+    (getbufferproc)packageSequence_getbuffer, /* bf_getbuffer */
+    0,                                      /* bf_releasebuffer */
+};
+#endif
+
+/* iterator */
+
+static void
+packageSequenceIter_dealloc(_PackageSequenceIterObject *self)
+{
+    Py_XDECREF(self->sequence);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyObject *
+packageSequenceIter_next(_PackageSequenceIterObject *self) try
+{
+    if (self->last == -2)
+        return NULL;
+    self->last = self->sequence->pset->next(self->last);
+    if (self->last == -1) {
+        // exhausted, stays exhausted
+        self->last = -2;
+        return NULL;
+    }
+    return new_package(self->sequence->sack, self->last);
+} CATCH_TO_PYTHON
+
+/* type */
+
+PyTypeObject packageSequence_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_hawkey.PackageSequence",        /*tp_name*/
+    sizeof(_PackageSequenceObject),   /*tp_basicsize*/
+    0,                                /*tp_itemsize*/
+    (destructor) packageSequence_dealloc, /*tp_dealloc*/
+    0,                                /*tp_print*/
+    0,                                /*tp_getattr*/
+    0,                                /*tp_setattr*/
+    0,                                /*tp_compare*/
+    0,                                /*tp_repr*/
+    0,                                /*tp_as_number*/
+    &packageSequence_sequence,        /*tp_as_sequence*/
+    &packageSequence_mapping,         /*tp_as_mapping*/
+    0,                                /*tp_hash */
+    0,                                /*tp_call*/
+    0,                                /*tp_str*/
+    0,                                /*tp_getattro*/
+    0,                                /*tp_setattro*/
+#if PY_MAJOR_VERSION >= 3
+    &packageSequence_buffer,          /*tp_as_buffer*/
+#else
+    0,                                /*tp_as_buffer*/
+#endif
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_ITER, /*tp_flags*/
+    "Sequence of packages created on access", /* tp_doc */
+    0,                                /* tp_traverse */
+    0,                                /* tp_clear */
+    0,                                /* tp_richcompare */
+    0,                                /* tp_weaklistoffset */
+    (getiterfunc)packageSequence_iter, /* tp_iter */
+    0,                                /* tp_iternext */
+    0,                                /* tp_methods */
+    0,                                /* tp_members */
+    0,                                /* tp_getset */
+    0,                                /* tp_base */
+    0,                                /* tp_dict */
+    0,                                /* tp_descr_get */
+    0,                                /* tp_descr_set */
+    0,                                /* tp_dictoffset */
+    0,                                /* tp_init */
+    0,                                /* tp_alloc */
+    0,                                /* tp_new */
+    0,                                /* tp_free */
+    0,                                /* tp_is_gc */
+};
+
+PyTypeObject packageSequenceIter_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_hawkey.PackageSequenceIterator", /*tp_name*/
+    sizeof(_PackageSequenceIterObject), /*tp_basicsize*/
+    0,                                /*tp_itemsize*/
+    (destructor) packageSequenceIter_dealloc, /*tp_dealloc*/
+    0,                                /*tp_print*/
+    0,                                /*tp_getattr*/
+    0,                                /*tp_setattr*/
+    0,                                /*tp_compare*/
+    0,                                /*tp_repr*/
+    0,                                /*tp_as_number*/
+    0,                                /*tp_as_sequence*/
+    0,                                /*tp_as_mapping*/
+    0,                                /*tp_hash */
+    0,                                /*tp_call*/
+    0,                                /*tp_str*/
+    0,                                /*tp_getattro*/
+    0,                                /*tp_setattro*/
+    0,                                /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_ITER, /*tp_flags*/
+    "PackageSequence iterator",       /* tp_doc */
+    0,                                /* tp_traverse */
+    0,                                /* tp_clear */
+    0,                                /* tp_richcompare */
+    0,                                /* tp_weaklistoffset */
+    PyObject_SelfIter,                /* tp_iter */
+    (iternextfunc)packageSequenceIter_next, /* tp_iternext */
+};
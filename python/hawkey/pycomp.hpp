@@ -72,6 +72,21 @@ private:
     std::string cppString;
 };
 
+/**
+* @brief Releases the GIL for its lifetime so other Python threads run during long libdnf calls.
+*        The GIL is taken back also when an exception leaves the scope. No Python object may be
+*        touched meanwhile.
+*/
+class PycompReleaseGIL {
+public:
+    PycompReleaseGIL() : threadState(PyEval_SaveThread()) {}
+    ~PycompReleaseGIL() { PyEval_RestoreThread(threadState); }
+    PycompReleaseGIL(const PycompReleaseGIL &) = delete;
+    PycompReleaseGIL & operator=(const PycompReleaseGIL &) = delete;
+private:
+    PyThreadState * threadState;
+};
+
 PYCOMP_MOD_INIT(_hawkey);
 
 #endif // PYCOMP_H
@@ -37,17 +37,22 @@
 #include "exception-py.hpp"
 #include "hawkey-pysys.hpp"
 #include "iutil-py.hpp"
+#include "numbercolumn-py.hpp"
 #include "package-py.hpp"
+#include "packagesequence-py.hpp"
 #include "query-py.hpp"
 #include "reldep-py.hpp"
 #include "sack-py.hpp"
 #include "pycomp.hpp"
 #include "sack/advisorypkg.hpp"
+#include "sack/packageattrs.hpp"
 #include "sack/packageset.hpp"
 #include "sack/selector.hpp"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
+#include <map>
 
 typedef struct {
     PyObject_HEAD
@@ -645,23 +650,81 @@ add_upgrades_filter(_QueryObject *self, PyObject *unused) try
 
 
 static PyObject *
-run(_QueryObject *self, PyObject *unused) try
+run(_QueryObject *self, PyObject *args, PyObject *kwds) try
 {
-    PyObject *list;
+    const char *kwlist[] = {"lazy", NULL};
+    PyObject *lazy = NULL;
 
-    const DnfPackageSet * pset = self->query->runSet();
-    list = packageset_to_pylist(pset, self->sack);
-    return list;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", (char **)kwlist, &lazy))
+        return NULL;
+
+    const DnfPackageSet * pset;
+    {
+        PycompReleaseGIL releaseGIL;
+        pset = self->query->runSet();
+    }
+    if (lazy && PyObject_IsTrue(lazy))
+        return packageSequenceFromPackageSet(pset, self->sack);
+    return packageset_to_pylist(pset, self->sack);
 } CATCH_TO_PYTHON
 
 static PyObject *
 apply(PyObject *self, PyObject *unused) try
 {
-    ((_QueryObject *) self)->query->apply();
+    {
+        PycompReleaseGIL releaseGIL;
+        ((_QueryObject *) self)->query->apply();
+    }
     Py_INCREF(self);
     return self;
 } CATCH_TO_PYTHON
 
+static PyObject *
+filterStatsToPyDict(const libdnf::FilterStats & stats, bool analyzed)
+{
+    if (analyzed)
+        return Py_BuildValue("{s:i,s:i,s:n,s:O,s:n,s:n,s:d}", "keyname", stats.keyname,
+                             "cmp_type", stats.cmpType,
+                             "nmatches", static_cast<Py_ssize_t>(stats.nmatches),
+                             "executed", stats.executed ? Py_True : Py_False,
+                             "input", static_cast<Py_ssize_t>(stats.inputSize),
+                             "output", static_cast<Py_ssize_t>(stats.outputSize),
+                             "elapsed", stats.elapsed);
+    return Py_BuildValue("{s:i,s:i,s:n}", "keyname", stats.keyname, "cmp_type", stats.cmpType,
+                         "nmatches", static_cast<Py_ssize_t>(stats.nmatches));
+}
+
+static PyObject *
+explain(_QueryObject *self, PyObject *args, PyObject *kwds) try
+{
+    const char *kwlist[] = {"analyze", NULL};
+    PyObject *analyze = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O!", (char **)kwlist, &PyBool_Type, &analyze))
+        return NULL;
+
+    bool analyzed = analyze && PyObject_IsTrue(analyze);
+    std::vector<libdnf::FilterStats> pipeline;
+    if (analyzed) {
+        PycompReleaseGIL releaseGIL;
+        self->query->setAnalyze(true);
+        self->query->apply();
+        self->query->setAnalyze(false);
+        pipeline = self->query->getAnalysis();
+    } else {
+        pipeline = self->query->explain();
+    }
+    UniquePtrPyObject list(PyList_New(0));
+    if (!list)
+        return NULL;
+    for (const auto & stats : pipeline) {
+        UniquePtrPyObject item(filterStatsToPyDict(stats, analyzed));
+        if (!item || PyList_Append(list.get(), item.get()) == -1)
+            return NULL;
+    }
+    return list.release();
+} CATCH_TO_PYTHON
+
 static PyObject *
 q_union(PyObject *self, PyObject *args) try
 {
@@ -791,10 +854,13 @@ filter_unneeded_or_safe_to_remove(PyObject *self, PyObject *args, PyObject *kwds
     gboolean c_debug_solver = debug_solver != NULL && PyObject_IsTrue(debug_solver);
 
     int ret;
-    if (SafeToRemove) {
-        ret = self_query_copy->filterSafeToRemove(*swdb, c_debug_solver);
-    } else {
-        ret = self_query_copy->filterUnneeded(*swdb, c_debug_solver);
+    {
+        PycompReleaseGIL releaseGIL;
+        if (SafeToRemove) {
+            ret = self_query_copy->filterSafeToRemove(*swdb, c_debug_solver);
+        } else {
+            ret = self_query_copy->filterUnneeded(*swdb, c_debug_solver);
+        }
     }
     if (ret == -1) {
         PyErr_SetString(PyExc_SystemError, "Unable to provide query with unneded filter");
@@ -843,8 +909,9 @@ query_contains(PyObject *self, PyObject *pypkg) try
 
     if (pkg) {
         Id id = dnf_package_get_id(pkg);
+        PycompReleaseGIL releaseGIL;
         q->apply();
-        if (MAPTST(q->getResult(), id))
+        if (MAPTST(static_cast<const libdnf::Query *>(q)->getResult(), id))
             return 1;
     }
     return 0;
@@ -854,6 +921,7 @@ static size_t
 query_len(PyObject *self) try
 {
     HyQuery q = ((_QueryObject *) self)->query;
+    PycompReleaseGIL releaseGIL;
     return q->size();
 } CATCH_TO_PYTHON_INT
 
@@ -879,11 +947,15 @@ query_get_item(PyObject *self, int index) try
 static PyObject *
 query_iter(PyObject *self) try
 {
-    const DnfPackageSet * pset = ((_QueryObject *) self)->query->runSet();
-    UniquePtrPyObject list(packageset_to_pylist(pset, ((_QueryObject *) self)->sack));
-    if (!list)
+    const DnfPackageSet * pset;
+    {
+        PycompReleaseGIL releaseGIL;
+        pset = ((_QueryObject *) self)->query->runSet();
+    }
+    UniquePtrPyObject sequence(packageSequenceFromPackageSet(pset, ((_QueryObject *) self)->sack));
+    if (!sequence)
         return NULL;
-    PyObject *iter = PyObject_GetIter(list.get());
+    PyObject *iter = PyObject_GetIter(sequence.get());
     return iter;
 } CATCH_TO_PYTHON
 
@@ -985,6 +1057,115 @@ query_to_name_arch_dict(_QueryObject *self, PyObject *unused) try
         return NULL;
 } CATCH_TO_PYTHON
 
+/// Sets attr to the attribute called name, raises ValueError and returns false if there is none
+static bool
+packageAttrFromName(const char *name, libdnf::PackageAttr & attr)
+{
+    if (!libdnf::packageAttrFromName(name, attr)) {
+        PyErr_Format(PyExc_ValueError, "Unknown package attribute: %s", name);
+        return false;
+    }
+    return true;
+}
+
+/// Returns a tuple with a column per attribute name from the names sequence. Numeric columns
+/// are lists, or NumberColumn buffers when numberBuffers is set.
+static PyObject *
+query_columns(_QueryObject *self, PyObject *names, bool numberBuffers)
+{
+    UniquePtrPyObject sequence(PySequence_Fast(names, "Expected a sequence of attribute names."));
+    if (!sequence)
+        return NULL;
+    std::vector<libdnf::PackageAttr> attrs;
+    Py_ssize_t nargs = PySequence_Fast_GET_SIZE(sequence.get());
+    for (Py_ssize_t i = 0; i < nargs; ++i) {
+        PycompString key(PySequence_Fast_GET_ITEM(sequence.get(), i));
+        if (!key.getCString())
+            return NULL;
+        libdnf::PackageAttr attr;
+        if (!packageAttrFromName(key.getCString(), attr))
+            return NULL;
+        attrs.push_back(attr);
+    }
+
+    Pool *pool = dnf_sack_get_pool(self->query->getSack());
+    libdnf::PackageAttrs table(*self->query->runSet(), attrs);
+    auto size = table.size();
+    UniquePtrPyObject ret(PyTuple_New(attrs.size()));
+    if (!ret)
+        return NULL;
+
+    Py_ssize_t index = 0;
+    for (auto & column : table.getColumns()) {
+#if PY_MAJOR_VERSION >= 3
+        if (numberBuffers && libdnf::packageAttrType(column.attr) == libdnf::PackageAttrType::NUMBER) {
+            PyObject *numbers = numberColumnFromVector(std::move(column.numbers));
+            if (!numbers)
+                return NULL;
+            PyTuple_SET_ITEM(ret.get(), index++, numbers);
+            continue;
+        }
+#endif
+        UniquePtrPyObject list(PyList_New(size));
+        if (!list)
+            return NULL;
+        // names, arches and evrs repeat a lot, share one Python string per pool Id
+        std::map<Id, UniquePtrPyObject> idStrings;
+        for (size_t row = 0; row < size; ++row) {
+            PyObject *item = NULL;
+            switch (libdnf::packageAttrType(column.attr)) {
+                case libdnf::PackageAttrType::ID: {
+                    auto & cached = idStrings[column.ids[row]];
+                    if (!cached) {
+                        cached.reset(PyString_FromString(pool_id2str(pool, column.ids[row])));
+                        if (!cached)
+                            return NULL;
+                    }
+                    item = cached.get();
+                    Py_INCREF(item);
+                    break;
+                }
+                case libdnf::PackageAttrType::NUMBER:
+                    item = PyLong_FromUnsignedLongLong(column.numbers[row]);
+                    break;
+                case libdnf::PackageAttrType::STRING: {
+                    const char *cstr = column.getString(row);
+                    if (cstr) {
+                        item = PyUnicode_FromString(cstr);
+                    } else {
+                        item = Py_None;
+                        Py_INCREF(item);
+                    }
+                    break;
+                }
+            }
+            if (!item)
+                return NULL;
+            PyList_SET_ITEM(list.get(), row, item);
+        }
+        PyTuple_SET_ITEM(ret.get(), index++, list.release());
+    }
+    return ret.release();
+}
+
+static PyObject *
+query_to_attrs(_QueryObject *self, PyObject *args) try
+{
+    return query_columns(self, args, false);
+} CATCH_TO_PYTHON
+
+static PyObject *
+query_to_columns(_QueryObject *self, PyObject *args, PyObject *kwds) try
+{
+    const char *kwlist[] = {"attrs", "buffers", NULL};
+    PyObject *names;
+    PyObject *buffers = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", (char **)kwlist, &names, &buffers))
+        return NULL;
+    return query_columns(self, names, !buffers || PyObject_IsTrue(buffers));
+} CATCH_TO_PYTHON
+
 static PyObject *
 add_nevra_or_other_filter(_QueryObject *self, PyObject *args) try
 {
@@ -1035,6 +1216,67 @@ add_filter_recent(_QueryObject *self, PyObject *args) try
     return final_query;
 } CATCH_TO_PYTHON
 
+static PyObject *
+add_filter_num_range(_QueryObject *self, PyObject *args) try
+{
+    const char *name;
+    unsigned long long min;
+    unsigned long long max;
+    if (!PyArg_ParseTuple(args, "sKK", &name, &min, &max))
+        return NULL;
+    libdnf::PackageAttr attr;
+    if (!packageAttrFromName(name, attr))
+        return NULL;
+    if (libdnf::packageAttrType(attr) != libdnf::PackageAttrType::NUMBER) {
+        PyErr_Format(PyExc_ValueError, "Not a numeric package attribute: %s", name);
+        return NULL;
+    }
+
+    self->query->apply();
+    HyQuery self_query_copy = new libdnf::Query(*self->query);
+    self_query_copy->filterNumRange(attr, min, max);
+    return queryToPyObject(self_query_copy, self->sack, Py_TYPE(self));
+} CATCH_TO_PYTHON
+
+/// Writes the packages rendered by the queryformat to the file descriptor in chunks, without
+/// creating Package objects, returns their number
+static PyObject *
+write_queryformat(_QueryObject *self, PyObject *args) try
+{
+    const char *queryformat;
+    int fd;
+    if (!PyArg_ParseTuple(args, "si", &queryformat, &fd))
+        return NULL;
+
+    libdnf::PackageFormat format(queryformat);
+    const DnfPackageSet *pset = self->query->runSet();
+    size_t count;
+    {
+        PycompReleaseGIL releaseGIL;
+        count = format.write(*pset, fd);
+    }
+    return PyLong_FromSize_t(count);
+} CATCH_TO_PYTHON
+
+static PyObject *
+add_dependency_closure(_QueryObject *self, PyObject *args, PyObject *kwds) try
+{
+    const char *kwlist[] = {"keyname", "reverse", "depth", NULL};
+    int keyname;
+    int reverse = 0;
+    int depth = -1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i|ii", (char**) kwlist, &keyname, &reverse, &depth))
+        return NULL;
+
+    self->query->apply();
+    std::unique_ptr<libdnf::Query> self_query_copy(new libdnf::Query(*self->query));
+    if (self_query_copy->addDependencyClosure(keyname, reverse, depth)) {
+        PyErr_SetString(HyExc_Value, "Not a dependency keyname.");
+        return NULL;
+    }
+    return queryToPyObject(self_query_copy.release(), self->sack, Py_TYPE(self));
+} CATCH_TO_PYTHON
+
 static PyGetSetDef query_getsetters[] = {
     {(char*)"evaluated",  (getter)get_evaluated, NULL, NULL, NULL},
     {NULL}                        /* sentinel */
@@ -1058,10 +1300,11 @@ static struct PyMethodDef query_methods[] = {
      NULL},
     {"filterm", (PyCFunction)filterm, METH_KEYWORDS|METH_VARARGS,
      NULL},
-    {"run", (PyCFunction)run, METH_NOARGS,
+    {"run", (PyCFunction)run, METH_VARARGS | METH_KEYWORDS,
      NULL},
     {"apply", (PyCFunction)apply, METH_NOARGS,
      NULL},
+    {"explain", (PyCFunction)explain, METH_VARARGS | METH_KEYWORDS, NULL},
     {"available", (PyCFunction)add_available_filter, METH_NOARGS, NULL},
     {"downgrades", (PyCFunction)add_downgrades_filter, METH_NOARGS, NULL},
     {"duplicated", (PyCFunction)duplicated_filter, METH_NOARGS, NULL},
@@ -1076,10 +1319,15 @@ static struct PyMethodDef query_methods[] = {
         NULL},
     {"get_advisory_pkgs", (PyCFunction)get_advisory_pkgs, METH_VARARGS, NULL},
     {"userinstalled", (PyCFunction)filter_userinstalled, METH_KEYWORDS|METH_VARARGS, NULL},
+    {"to_columns", (PyCFunction)query_to_columns, METH_KEYWORDS|METH_VARARGS, NULL},
+    {"_attrs", (PyCFunction)query_to_attrs, METH_VARARGS, NULL},
     {"_na_dict", (PyCFunction)query_to_name_arch_dict, METH_NOARGS, NULL},
     {"_name_dict", (PyCFunction)query_to_name_dict, METH_NOARGS, NULL},
     {"_nevra", (PyCFunction)add_nevra_or_other_filter, METH_VARARGS, NULL},
     {"_recent", (PyCFunction)add_filter_recent, METH_VARARGS, NULL},
+    {"_num_range", (PyCFunction)add_filter_num_range, METH_VARARGS, NULL},
+    {"_dep_closure", (PyCFunction)add_dependency_closure, METH_KEYWORDS|METH_VARARGS, NULL},
+    {"_write_queryformat", (PyCFunction)write_queryformat, METH_VARARGS, NULL},
     {"_unneeded", (PyCFunction)filter_unneeded, METH_KEYWORDS|METH_VARARGS, NULL},
     {"_safe_to_remove", (PyCFunction)filter_safe_to_remove, METH_KEYWORDS|METH_VARARGS, NULL},
     {NULL}                      /* sentinel */
@@ -24,6 +24,7 @@
 // hawkey
 #include "libdnf/repo/Repo.hpp"
 #include "dnf-types.h"
+#include "hy-package.h"
 #include "hy-packageset.h"
 #include "hy-repo.h"
 #include "hy-util.h"
@@ -250,21 +251,23 @@ sack_init(_SackObject *self, PyObject *args, PyObject *kwds) try
     const char *arch = NULL;
     const char *rootdir = NULL;
     PyObject *cachedir_py = NULL;
+    PyObject *shared_cachedir_py = NULL;
     PyObject *logfile_py = NULL;
     self->log_out = NULL;
     int make_cache_dir = 0;
     PyObject *debug_object = nullptr;
     gboolean all_arch = FALSE;
+    int huge_pages = 0;
     const char *kwlist[] = {"cachedir", "arch", "rootdir", "pkgcls",
                       "pkginitval", "make_cache_dir", "logfile", "logdebug",
-                      "all_arch", NULL};
+                      "all_arch", "huge_pages", "shared_cachedir", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OssOOiOO!i", (char**) kwlist,
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OssOOiOO!iiO", (char**) kwlist,
                                      &cachedir_py, &arch, &rootdir,
                                      &custom_class, &custom_val,
                                      &make_cache_dir, &logfile_py,
                                      &PyBool_Type, &debug_object,
-                                     &all_arch))
+                                     &all_arch, &huge_pages, &shared_cachedir_py))
         return -1;
 
     bool debug = debug_object != nullptr && PyObject_IsTrue(debug_object);
@@ -277,6 +280,8 @@ sack_init(_SackObject *self, PyObject *args, PyObject *kwds) try
     int flags = 0;
     if (make_cache_dir)
         flags |= DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR;
+    if (huge_pages)
+        flags |= DNF_SACK_SETUP_FLAG_HUGE_PAGES;
     self->sack = dnf_sack_new();
     if (all_arch) {
         dnf_sack_set_all_arch(self->sack, all_arch);
@@ -288,6 +293,12 @@ sack_init(_SackObject *self, PyObject *args, PyObject *kwds) try
     }
     dnf_sack_set_rootdir(self->sack, rootdir);
     dnf_sack_set_cachedir(self->sack, cachedir.getCString());
+    if (shared_cachedir_py != NULL && shared_cachedir_py != Py_None) {
+        PycompString shared_cachedir(shared_cachedir_py);
+        if (!shared_cachedir.getCString())
+            return -1;
+        dnf_sack_set_shared_cachedir(self->sack, shared_cachedir.getCString());
+    }
     if (logfile_py != NULL) {
         PycompString logfile(logfile_py);
         if (!logfile.getCString())
@@ -488,7 +499,10 @@ add_cmdline_package(_SackObject *self, PyObject *fn_obj) try
 
     if (!fn.getCString())
         return NULL;
-    cpkg = dnf_sack_add_cmdline_package_nochecksum(self->sack, fn.getCString());
+    {
+        PycompReleaseGIL releaseGIL;
+        cpkg = dnf_sack_add_cmdline_package_nochecksum(self->sack, fn.getCString());
+    }
     if (cpkg == NULL) {
         PyErr_Format(PyExc_IOError, "Can not load RPM file: %s.", fn.getCString());
         return NULL;
@@ -601,6 +615,13 @@ list_arches(_SackObject *self, PyObject *unused) try
     }
 } CATCH_TO_PYTHON
 
+static PyObject *
+rpmdb_version(_SackObject *self, PyObject *unused) try
+{
+    g_autofree gchar *version = dnf_sack_get_rpmdb_version(self->sack);
+    return PyUnicode_FromString(version);
+} CATCH_TO_PYTHON
+
 static PyObject *
 filter_modules(_SackObject *self, PyObject *args, PyObject *kwds) try
 {
@@ -634,8 +655,12 @@ filter_modules(_SackObject *self, PyObject *args, PyObject *kwds) try
     std::transform(hotfixRepos.begin(), hotfixRepos.end(), hotfixReposCString.begin(),
         std::mem_fn(&std::string::c_str));
     try {
-        auto problems = dnf_sack_filter_modules_v2(self->sack, moduleContainer, hotfixReposCString.data(),
-            installRoot, platformModule, updateOnly, debugSolver, moduleObsoletes);
+        std::pair<std::vector<std::vector<std::string>>, libdnf::ModulePackageContainer::ModuleErrorType> problems;
+        {
+            PycompReleaseGIL releaseGIL;
+            problems = dnf_sack_filter_modules_v2(self->sack, moduleContainer, hotfixReposCString.data(),
+                installRoot, platformModule, updateOnly, debugSolver, moduleObsoletes);
+        }
         if (problems.second == libdnf::ModulePackageContainer::ModuleErrorType::NO_ERROR) {
             PyObject * returnTuple = PyTuple_New(0);
             return returnTuple;
@@ -669,8 +694,11 @@ set_modules_enabled_by_pkgset(_SackObject *self, PyObject *args, PyObject *kwds)
     UniquePtrPyObject thisPyModuleContainer(PyObject_GetAttrString(pyModuleContainer, "this"));
     auto swigContainer = reinterpret_cast< ModulePackageContainerPyObject * >(thisPyModuleContainer.get());
     auto moduleContainer = swigContainer->ptr;
-    auto modules = moduleContainer->requiresModuleEnablement(*pset.get());
-    moduleContainer->enableDependencyTree(modules);
+    {
+        PycompReleaseGIL releaseGIL;
+        auto modules = moduleContainer->requiresModuleEnablement(*pset.get());
+        moduleContainer->enableDependencyTree(modules);
+    }
     Py_RETURN_NONE;
 } CATCH_TO_PYTHON
 
@@ -723,7 +751,11 @@ load_system_repo(_SackObject *self, PyObject *args, PyObject *kwds)
     if (build_cache)
         flags |= DNF_SACK_LOAD_FLAG_BUILD_CACHE;
 
-    gboolean ret = dnf_sack_load_system_repo(self->sack, crepo, flags, &error);
+    gboolean ret;
+    {
+        PycompReleaseGIL releaseGIL;
+        ret = dnf_sack_load_system_repo(self->sack, crepo, flags, &error);
+    }
     if (!ret)
         return op_error2exc(error);
     Py_RETURN_NONE;
@@ -733,14 +765,16 @@ static PyObject *
 load_repo(_SackObject *self, PyObject *args, PyObject *kwds) try
 {
     const char *kwlist[] = {"repo", "build_cache", "load_filelists", "load_presto",
-                      "load_updateinfo", "load_other", NULL};
+                      "load_updateinfo", "load_other", "use_mmap", "slim_updateinfo", NULL};
 
     PyObject * repoPyObj = NULL;
     int build_cache = 0, load_filelists = 0, load_presto = 0, load_updateinfo = 0, load_other = 0;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|iiiii", (char**) kwlist,
+    int use_mmap = 0, slim_updateinfo = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|iiiiiii", (char**) kwlist,
                                      &repoPyObj,
                                      &build_cache, &load_filelists,
-                                     &load_presto, &load_updateinfo, &load_other))
+                                     &load_presto, &load_updateinfo, &load_other, &use_mmap,
+                                     &slim_updateinfo))
         return 0;
 
     // Is it old deprecated _hawkey.Repo object?
@@ -775,14 +809,48 @@ load_repo(_SackObject *self, PyObject *args, PyObject *kwds) try
         flags |= DNF_SACK_LOAD_FLAG_USE_UPDATEINFO;
     if (load_other)
         flags |= DNF_SACK_LOAD_FLAG_USE_OTHER;
-    Py_BEGIN_ALLOW_THREADS;
-    ret = dnf_sack_load_repo(self->sack, crepo, flags, &error);
-    Py_END_ALLOW_THREADS;
+    if (use_mmap)
+        flags |= DNF_SACK_LOAD_FLAG_USE_MMAP;
+    if (slim_updateinfo)
+        flags |= DNF_SACK_LOAD_FLAG_SLIM_UPDATEINFO;
+    {
+        PycompReleaseGIL releaseGIL;
+        ret = dnf_sack_load_repo(self->sack, crepo, flags, &error);
+    }
     if (!ret)
         return op_error2exc(error);
     Py_RETURN_NONE;
 } CATCH_TO_PYTHON
 
+static PyObject *
+get_advisories(_SackObject *self, PyObject *args) try
+{
+    PyObject *seq;
+    int cmp_type;
+
+    if (!PyArg_ParseTuple(args, "Oi", &seq, &cmp_type))
+        return NULL;
+
+    auto pset = pyseq_to_packageset(seq, self->sack);
+    if (!pset)
+        return NULL;
+
+    GHashTable *advisories = dnf_package_get_advisories_for_set(pset.get(), cmp_type);
+    UniquePtrPyObject dict(PyDict_New());
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, advisories);
+    while (dict && g_hash_table_iter_next(&iter, &key, &value)) {
+        UniquePtrPyObject package(new_package((PyObject *)self, GPOINTER_TO_INT(key)));
+        UniquePtrPyObject list(advisorylist_to_pylist(static_cast<GPtrArray *>(value), (PyObject *)self));
+        if (!package || !list || PyDict_SetItem(dict.get(), package.get(), list.get()) == -1)
+            dict.reset();
+    }
+    g_hash_table_unref(advisories);
+
+    return dict.release();
+} CATCH_TO_PYTHON
+
 static Py_ssize_t
 len(_SackObject *self) try
 {
@@ -808,6 +876,8 @@ PyMethodDef sack_methods[] = {
      NULL},
     {"create_package", (PyCFunction)create_package, METH_O,
      NULL},
+    {"get_advisories", (PyCFunction)get_advisories, METH_VARARGS,
+     NULL},
     {"add_cmdline_package", (PyCFunction)add_cmdline_package, METH_O,
      NULL},
     {"add_excludes", (PyCFunction)modify_excl_incl<&dnf_sack_add_excludes>, METH_O, NULL},
@@ -844,6 +914,8 @@ PyMethodDef sack_methods[] = {
      NULL},
     {"list_arches", (PyCFunction)list_arches, METH_NOARGS,
      NULL},
+    {"rpmdb_version", (PyCFunction)rpmdb_version, METH_NOARGS,
+     NULL},
     {"filter_modules", (PyCFunction)filter_modules, METH_VARARGS | METH_KEYWORDS, NULL},
     {"set_modules_enabled_by_pkgset", (PyCFunction)set_modules_enabled_by_pkgset,
         METH_VARARGS | METH_KEYWORDS, NULL},
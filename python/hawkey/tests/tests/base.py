@@ -61,16 +61,18 @@ class TestSack(hawkey.test.TestSackMixin, hawkey.Sack):
                              all_arch=all_arch,
                              )
 
-    def load_repo(self, **kwargs):
+    def load_repo(self, repo_id="messerk", stream_primary=False, **kwargs):
         d = os.path.join(self.repo_dir, 'yum/')
         self._conf = libdnf.conf.ConfigMain()
         repo_conf = libdnf.conf.ConfigRepo(self._conf)
         self._conf.cachedir().set(libdnf.conf.Option.Priority_REPOCONFIG, self.cache_dir)
         repo_conf.baseurl().set(libdnf.conf.Option.Priority_REPOCONFIG, 'file://%s' % d)
         repo_conf.this.disown()  # _repo will be the owner of _config
-        repo = libdnf.repo.Repo("messerk", repo_conf)
+        repo = libdnf.repo.Repo(repo_id, repo_conf)
+        repo.setStreamPrimary(stream_primary)
         repo.load()
         super(TestSack, self).load_repo(repo, **kwargs)
+        return repo
 
     # Loading using hawkey.Repo
     def load_repo_hawkey_Repo(self, **kwargs):
@@ -51,6 +51,22 @@ class Test(base.TestCase):
     def test_description(self):
         self.assertEqual(self.advisory.description, 'An example update to the tour package.')
 
+    def test_description_slim(self):
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        sack.load_repo(load_updateinfo=True, slim_updateinfo=True)
+        advisory = find_advisory(sack, 'FEDORA-2008-9969')
+        self.assertEqual(advisory.description, 'An example update to the tour package.')
+
+    def test_sack_get_advisories(self):
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        sack.load_repo(load_updateinfo=True)
+        packages = hawkey.Query(sack)
+        advisories = sack.get_advisories(packages, hawkey.LT | hawkey.EQ | hawkey.GT)
+        self.assertTrue(advisories)
+        for pkg in packages:
+            expected = pkg.get_advisories(hawkey.LT | hawkey.EQ | hawkey.GT)
+            self.assertEqual([a.id for a in advisories.get(pkg, [])], [a.id for a in expected])
+
     def test_packages(self):
         filenames = [apkg.filename for apkg in self.advisory.packages]
         self.assertEqual(filenames, ['tour.noarch.rpm'])
@@ -23,6 +23,7 @@ from . import base
 from copy import deepcopy
 
 import hawkey
+import sys
 
 class GoalTest(base.TestCase):
     def setUp(self):
@@ -54,10 +55,43 @@ class GoalTest(base.TestCase):
         goal3.add_protected(hawkey.Query(self.sack).filter(name="flying"))
         self.assertFalse(goal3.run(allow_uninstall=True))
 
+    def test_stats(self):
+        goal = hawkey.Goal(self.sack)
+        goal.install(base.by_name(self.sack, "walrus"))
+        self.assertTrue(goal.run())
+        stats = goal.get_stats()
+        self.assertEqual(stats["solves"], 1)
+        self.assertGreaterEqual(stats["jobs"], 1)
+        self.assertGreater(stats["pkg_rules"], 0)
+        self.assertGreaterEqual(stats["rules"], stats["pkg_rules"] + stats["job_rules"])
+        self.assertGreater(stats["decisions"], 0)
+        self.assertGreaterEqual(stats["total_ms"], stats["solve_ms"])
+
     def test_list_err(self):
         goal = hawkey.Goal(self.sack)
         self.assertRaises(hawkey.ValueException, goal.list_installs)
 
+    def test_list_lazy(self):
+        goal = hawkey.Goal(self.sack)
+        self.assertRaises(hawkey.ValueException, goal.list_installs, lazy=True)
+        goal.erase(base.by_name(self.sack, "penny-lib"))
+        self.assertTrue(goal.run(allow_uninstall=True))
+        erasures = goal.list_erasures(lazy=True)
+        self.assertEqual(len(erasures), 2)
+        self.assertItemsEqual(list(map(str, erasures)), list(map(str, goal.list_erasures())))
+
+        results = goal.list_results()
+        self.assertItemsEqual(results.keys(), ("erasures", "installs", "obsoleted", "reinstalls",
+                                               "downgrades", "upgrades"))
+        self.assertItemsEqual(list(map(str, results["erasures"])), list(map(str, erasures)))
+        self.assertLength(results["installs"], 0)
+        if sys.version_info >= (3,):
+            view = memoryview(erasures)
+            self.assertTrue(view.readonly)
+            self.assertEqual(view.format, "i")
+            self.assertEqual(view.tolist(), [hash(pkg) for pkg in erasures])
+            self.assertEqual(memoryview(results["installs"]).tolist(), [])
+
     def test_empty_selector(self):
         sltr = hawkey.Selector(self.sack)
         goal = hawkey.Goal(self.sack)
@@ -23,6 +23,7 @@ from . import base
 
 import hawkey
 import sys
+import tempfile
 import unittest
 
 class TestQuery(base.TestCase):
@@ -63,6 +64,35 @@ class TestQuery(base.TestCase):
         self.assertFalse(q)
         self.assertEqual(len(q.run()), 0)
 
+    def test_explain(self):
+        q = hawkey.Query(self.sack).filter(requires__glob="*", name=["flying", "penny"])
+        pipeline = q.explain()
+        self.assertEqual([f["keyname"] for f in pipeline],
+                         [hawkey.PKG_NAME, hawkey.PKG_REQUIRES])
+        self.assertEqual(pipeline[0]["nmatches"], 2)
+
+        analysis = q.explain(analyze=True)
+        self.assertEqual(len(analysis), 2)
+        self.assertTrue(analysis[0]["executed"])
+        self.assertEqual(analysis[0]["output"], 2)
+        self.assertEqual(analysis[1]["input"], 2)
+        self.assertEqual(analysis[1]["output"], len(q))
+        self.assertEqual(q.explain(), [])
+
+    def test_run_lazy(self):
+        q = hawkey.Query(self.sack).filter(name=["flying", "penny"])
+        packages = q.run()
+        lazy = q.run(lazy=True)
+        self.assertIsInstance(lazy, hawkey.PackageSequence)
+        self.assertEqual(len(lazy), len(packages))
+        self.assertEqual(list(lazy), packages)
+        self.assertEqual(lazy[0], packages[0])
+        self.assertEqual(lazy[-1], packages[-1])
+        self.assertEqual(lazy[1:], packages[1:])
+        self.assertEqual(lazy[::-1], packages[::-1])
+        self.assertRaises(IndexError, lambda: lazy[len(packages)])
+        self.assertLength(hawkey.Query(self.sack).filter(empty=True).run(lazy=True), 0)
+
     def test_kwargs_check(self):
         q = hawkey.Query(self.sack)
         self.assertRaises(hawkey.ValueException, q.filter, name="flying", upgrades="maracas")
@@ -98,6 +128,56 @@ class TestQuery(base.TestCase):
         self.assertEqual(q.count(), 2)
         self.assertNotEqual(q[0], q[1])
 
+    def test_attrs(self):
+        q = hawkey.Query(self.sack).filter(name="jay")
+        names, evrs, reponames, epochs = q._attrs("name", "evr", "reponame", "epoch")
+        pkgs = list(q)
+        self.assertEqual(names, [pkg.name for pkg in pkgs])
+        self.assertEqual(evrs, [pkg.evr for pkg in pkgs])
+        self.assertEqual(reponames, [pkg.reponame for pkg in pkgs])
+        self.assertEqual(epochs, [pkg.epoch for pkg in pkgs])
+        self.assertEqual(hawkey.Query(self.sack).filter(empty=True)._attrs("name"), ([],))
+        self.assertRaises(ValueError, q._attrs, "nosuchattr")
+
+    def test_to_columns(self):
+        q = hawkey.Query(self.sack).filter(name="jay")
+        names, epochs, sizes = q.to_columns(["name", "epoch", "installsize"])
+        pkgs = list(q)
+        self.assertEqual(names, [pkg.name for pkg in pkgs])
+        self.assertEqual(list(epochs), [pkg.epoch for pkg in pkgs])
+        self.assertEqual(len(sizes), len(pkgs))
+        self.assertEqual(list(sizes), [pkg.installsize for pkg in pkgs])
+        if sys.version_info >= (3,):
+            view = memoryview(epochs)
+            self.assertEqual(view.format, "q")
+            self.assertEqual(view.tolist(), [pkg.epoch for pkg in pkgs])
+        epochs, = q.to_columns(["epoch"], buffers=False)
+        self.assertEqual(epochs, [pkg.epoch for pkg in pkgs])
+        self.assertRaises(ValueError, q.to_columns, ["nosuchattr"])
+
+    def test_write_queryformat(self):
+        q = hawkey.Query(self.sack).filter(name="jay")
+        with tempfile.TemporaryFile() as f:
+            count = q._write_queryformat(r"%{name}-%{evr}.%{arch} %-6{epoch}%% %{reponame}\n",
+                                         f.fileno())
+            f.seek(0)
+            lines = f.read().decode("utf-8").splitlines()
+        self.assertEqual(count, len(q))
+        self.assertItemsEqual(lines, ["%s-%s.%s %-6d%% %s" % (pkg.name, pkg.evr, pkg.arch, pkg.epoch,
+                                                             pkg.reponame) for pkg in q])
+        self.assertRaises(hawkey.Exception, q._write_queryformat, "%{nosuchtag}", 1)
+
+    def test_num_range(self):
+        q = hawkey.Query(self.sack)
+        pkgs = list(q)
+        epoch_pkgs = q._num_range("epoch", 1, 2**64 - 1)
+        self.assertEqual(set(epoch_pkgs), set(p for p in pkgs if p.epoch >= 1))
+        self.assertEqual(q._num_range("epoch", 0, 0).count(), len(pkgs) - len(epoch_pkgs))
+        sized = q._num_range("installsize", 1, 2**64 - 1)
+        self.assertEqual(len(sized), len([p for p in pkgs if p.installsize >= 1]))
+        self.assertRaises(ValueError, q._num_range, "name", 0, 1)
+        self.assertRaises(ValueError, q._num_range, "nosuchattr", 0, 1)
+
     def test_clone(self):
         q = hawkey.Query(self.sack)
         q.filterm(name__substr=["penny"])
@@ -296,6 +376,18 @@ class TestQueryAllRepos(base.TestCase):
         self.assertEqual({str(pkg) for pkg in query},
                          {"baby-6:5.0-11.x86_64", "jay-5.0-0.x86_64"})
 
+    def test_duplicated(self):
+        query = hawkey.Query(self.sack).duplicated()
+        self.assertEqual({str(pkg) for pkg in query},
+                         {"jay-5.0-0.x86_64", "jay-6.0-0.x86_64"})
+
+    def test_extras(self):
+        available = {(pkg.name, pkg.arch) for pkg in hawkey.Query(self.sack).available()}
+        expected = {str(pkg) for pkg in hawkey.Query(self.sack).installed()
+                    if (pkg.name, pkg.arch) not in available}
+        self.assertEqual({str(pkg) for pkg in hawkey.Query(self.sack).extras()}, expected)
+        self.assertLength(hawkey.Query(self.sack).filter(name="jay").extras(), 0)
+
     def test_rco_glob(self):
         q1 = hawkey.Query(self.sack).filter(requires__glob="*")
         self.assertLength(q1, 12)
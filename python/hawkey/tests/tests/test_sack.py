@@ -58,6 +58,29 @@ class TestSackTest(base.TestCase):
         self.assertEqual(len(sack), hawkey.test.EXPECT_YUM_NSOLVABLES +
                          hawkey.test.EXPECT_SYSTEM_NSOLVABLES)
 
+    def test_load_yum_mmap(self):
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        sack.load_repo(build_cache=True)
+        # the second sack is loaded from the cache written by the first one
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        sack.load_system_repo()
+        sack.load_repo(build_cache=True, use_mmap=True)
+        self.assertEqual(len(sack), hawkey.test.EXPECT_YUM_NSOLVABLES +
+                         hawkey.test.EXPECT_SYSTEM_NSOLVABLES)
+
+    def test_load_yum_streamed(self):
+        # a repo id of its own, the metadata of "messerk" may be cached already
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        repo = sack.load_repo(repo_id="streamed", stream_primary=True, build_cache=True)
+        self.assertEqual(len(sack), hawkey.test.EXPECT_YUM_NSOLVABLES)
+        primary = repo.getMetadataPath("primary")
+        self.assertTrue(os.path.isfile(primary))
+        # the next run uses the streamed primary from the cache
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        repo = sack.load_repo(repo_id="streamed", stream_primary=True, build_cache=True)
+        self.assertEqual(len(sack), hawkey.test.EXPECT_YUM_NSOLVABLES)
+        self.assertEqual(repo.getMetadataPath("primary"), primary)
+
     def test_cache_dir(self):
         sack = base.TestSack(repo_dir=self.repo_dir)
         self.assertTrue(sack.cache_dir.startswith("/tmp/pyhawkey"))
@@ -112,6 +135,14 @@ class BasicTest(unittest.TestCase):
         self.assertGreater(sack.evr_cmp("3.11-4", "3.10-5"), 0)
         self.assertGreater(sack.evr_cmp("1:3.10-4", "3.10-5"), 0)
 
+    def test_rpmdb_version(self):
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        sack.load_system_repo()
+        count, checksum = sack.rpmdb_version().split(":")
+        self.assertEqual(int(count), hawkey.test.EXPECT_SYSTEM_NSOLVABLES)
+        self.assertEqual(len(checksum), 64)
+        self.assertEqual(sack.rpmdb_version(), ":".join((count, checksum)))
+
     def test_all_arch(self):
         sack = hawkey.Sack(arch="x86_64")
         # greater than noarch as it has picked up the default architecture
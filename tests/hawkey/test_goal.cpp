@@ -31,6 +31,8 @@
 #include "libdnf/hy-packageset.h"
 #include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/hy-repo.h"
+#include "libdnf/hy-repo-private.hpp"
+#include "libdnf/repo/Repo-private.hpp"
 #include "libdnf/hy-query.h"
 #include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/dnf-goal.h"
@@ -176,6 +178,24 @@ START_TEST(test_goal_install)
 }
 END_TEST
 
+START_TEST(test_goal_install_pset)
+{
+    DnfPackage *walrus = get_latest_pkg(test_globals.sack, "walrus");
+    DnfPackage *devel = get_latest_pkg(test_globals.sack, "penny-lib-devel");
+    libdnf::PackageSet pset(test_globals.sack);
+    pset.set(walrus);
+    pset.set(devel);
+    g_object_unref(walrus);
+    g_object_unref(devel);
+
+    libdnf::Goal goal(test_globals.sack);
+    goal.install(pset, false);
+    fail_unless(goal.jobLength() == 2);
+    fail_if(goal.run(DNF_NONE));
+    assert_iueo(&goal, 3, 0, 0, 0);
+}
+END_TEST
+
 START_TEST(test_goal_install_multilib)
 {
     // Tests installation of multilib package. The package is selected via
@@ -415,6 +435,70 @@ START_TEST(test_goal_upgrade)
 }
 END_TEST
 
+START_TEST(test_goal_run_many)
+{
+    DnfPackage *walrus = get_latest_pkg(test_globals.sack, "walrus");
+    DnfPackage *fool = get_latest_pkg(test_globals.sack, "fool");
+    libdnf::Goal install(test_globals.sack);
+    libdnf::Goal upgrade(test_globals.sack);
+    install.install(walrus, false);
+    upgrade.upgrade(fool);
+
+    std::vector<libdnf::Goal *> goals{&install, &upgrade};
+    auto ret = libdnf::Goal::runMany(goals, DNF_NONE);
+    ck_assert_int_eq(ret.size(), 2);
+    fail_if(ret[0]);
+    fail_if(ret[1]);
+    assert_iueo(&install, 2, 0, 0, 0);
+    assert_iueo(&upgrade, 0, 1, 0, 1);
+
+    g_object_unref(walrus);
+    g_object_unref(fool);
+}
+END_TEST
+
+START_TEST(test_goal_reuse_solver)
+{
+    DnfPackage *walrus = get_latest_pkg(test_globals.sack, "walrus");
+    DnfPackage *fool = get_latest_pkg(test_globals.sack, "fool");
+    HyGoal goal = hy_goal_create(test_globals.sack);
+    goal->setReuseSolver(true);
+
+    fail_if(hy_goal_install(goal, walrus));
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    assert_iueo(goal, 2, 0, 0, 0);
+
+    // replace the job, results match a fresh goal
+    goal->truncateJobs(0);
+    ck_assert_int_eq(goal->jobLength(), 0);
+    fail_if(goal->hasActions(DNF_INSTALL));
+    fail_if(hy_goal_upgrade_to(goal, fool));
+    fail_unless(goal->hasActions(DNF_UPGRADE));
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    assert_iueo(goal, 0, 1, 0, 1);
+
+    goal->truncateJobs(0);
+    fail_if(goal->hasActions(DNF_UPGRADE));
+    fail_if(hy_goal_install(goal, walrus));
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    assert_iueo(goal, 2, 0, 0, 0);
+
+    // the dropped preresolved distupgrade is not replaced into the remaining jobs
+    goal->truncateJobs(0);
+    goal->distupgradePreresolved();
+    fail_unless(goal->hasActions(DNF_DISTUPGRADE));
+    goal->truncateJobs(0);
+    fail_if(goal->hasActions(DNF_DISTUPGRADE));
+    fail_if(hy_goal_install(goal, walrus));
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    assert_iueo(goal, 2, 0, 0, 0);
+
+    g_object_unref(walrus);
+    g_object_unref(fool);
+    hy_goal_free(goal);
+}
+END_TEST
+
 template<const char * (*getCharFromPackage)(DnfPackage*)>
 static void
 assert_list_names(bool wanted, GPtrArray *plist, ...)
@@ -555,6 +639,75 @@ START_TEST(test_goal_get_reason)
 }
 END_TEST
 
+START_TEST(test_goal_get_reasons)
+{
+    DnfPackage *pkg = get_latest_pkg(test_globals.sack, "walrus");
+    HyGoal goal = hy_goal_create(test_globals.sack);
+    hy_goal_install(goal, pkg);
+    g_object_unref(pkg);
+    hy_goal_run_flags(goal, DNF_NONE);
+
+    auto installs = goal->listInstalls();
+    auto reasons = goal->getReasons(installs);
+    ck_assert_int_eq(reasons.size(), installs.size());
+    for (auto & reason : reasons) {
+        g_autoptr(DnfPackage) installed = dnf_package_new(test_globals.sack, reason.first);
+        ck_assert_int_eq(reason.second, hy_goal_get_reason(goal, installed));
+    }
+
+    hy_goal_free(goal);
+}
+END_TEST
+
+static bool
+same_packages(const libdnf::PackageSet & pset1, const libdnf::PackageSet & pset2)
+{
+    libdnf::PackageSet difference(pset1);
+    difference -= pset2;
+    return pset1.size() == pset2.size() && difference.empty();
+}
+
+START_TEST(test_goal_plan)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    // the test repos are not loaded from metadata, they need checksums for a plan
+    Repo *repo;
+    int i;
+    FOR_REPOS(i, repo) {
+        auto hrepo = static_cast<HyRepo>(repo->appdata);
+        memset(libdnf::repoGetImpl(hrepo)->checksum, i, CHKSUM_BYTES);
+    }
+
+    HyGoal goal = hy_goal_create(sack);
+    hy_goal_upgrade_all(goal);
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    g_autofree gchar *path = g_build_filename(test_globals.tmpdir, "goal.plan", NULL);
+    goal->writePlan(path);
+
+    HyGoal planned = hy_goal_create(sack);
+    fail_unless(planned->loadPlan(path));
+    fail_unless(same_packages(planned->listUpgrades(), goal->listUpgrades()));
+    fail_unless(same_packages(planned->listObsoleted(), goal->listObsoleted()));
+    fail_unless(same_packages(planned->listErasures(), goal->listErasures()));
+    ck_assert_int_eq(planned->countProblems(), 0);
+    auto upgrades = goal->listUpgrades();
+    fail_unless(planned->getReasons(upgrades) == goal->getReasons(upgrades));
+    hy_goal_free(planned);
+
+    // a plan made for another rpmdb is not used
+    auto system = libdnf::repoGetImpl(static_cast<HyRepo>(pool->installed->appdata));
+    system->checksum[0] ^= 0xff;
+    planned = hy_goal_create(sack);
+    fail_if(planned->loadPlan(path));
+    fail_if(hy_goal_run_flags(planned, DNF_NONE));
+    system->checksum[0] ^= 0xff;
+
+    hy_goal_free(planned);
+    hy_goal_free(goal);
+}
+END_TEST
+
 START_TEST(test_goal_get_reason_selector)
 {
 
@@ -599,6 +752,14 @@ START_TEST(test_goal_describe_problem_rules)
     fail_unless(problems[0] == expected[0]);
     fail_unless(problems[1] == expected[1]);
 
+    auto rules = goal->getProblemRules(0);
+    fail_unless(rules.size() == 2);
+    fail_unless(goal->formatProblemRule(rules[0], true) == expected[0]);
+    fail_unless(goal->formatProblemRule(rules[1], true) == expected[1]);
+    auto allRules = goal->getAllProblemRules(1);
+    fail_unless(allRules.size() == 1);
+    fail_unless(allRules[0] == rules);
+
     g_object_unref(pkg);
     hy_goal_free(goal);
 }
@@ -630,6 +791,25 @@ START_TEST(test_goal_erase_simple)
 }
 END_TEST
 
+START_TEST(test_goal_erase_pset)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *penny = by_name_repo(sack, "penny", HY_SYSTEM_REPO_NAME);
+    DnfPackage *fool = by_name_repo(sack, "fool", HY_SYSTEM_REPO_NAME);
+    libdnf::PackageSet pset(sack);
+    pset.set(penny);
+    pset.set(fool);
+    g_object_unref(penny);
+    g_object_unref(fool);
+
+    libdnf::Goal goal(sack);
+    goal.erase(pset);
+    fail_unless(goal.jobLength() == 1);
+    fail_if(goal.run(DNF_NONE));
+    assert_iueo(&goal, 0, 0, 2, 0);
+}
+END_TEST
+
 START_TEST(test_goal_erase_with_deps)
 {
     DnfSack *sack = test_globals.sack;
@@ -650,6 +830,23 @@ START_TEST(test_goal_erase_with_deps)
 }
 END_TEST
 
+START_TEST(test_goal_protected_cache)
+{
+    DnfSack *sack = test_globals.sack;
+    std::vector<std::string> names{"flying", "penny"};
+    auto pset = dnf_sack_get_protected_pkgs(sack, names);
+    auto size = pset->size();
+    fail_unless(size > 0);
+    // served from the cache while neither the sack nor the names change
+    fail_unless(dnf_sack_get_protected_pkgs(sack, names) == pset);
+
+    names.push_back("no-such-package");
+    fail_unless(dnf_sack_get_protected_pkgs(sack, names)->size() == size);
+    names = {"no-such-package"};
+    fail_unless(dnf_sack_get_protected_pkgs(sack, names)->empty());
+}
+END_TEST
+
 START_TEST(test_goal_protected)
 {
     DnfSack *sack = test_globals.sack;
@@ -686,6 +883,9 @@ START_TEST(test_goal_protected)
     expected = "The operation would result in removing "
         "the following protected packages: flying";
     fail_if(g_strcmp0(problem[0].c_str(), expected));
+    auto rules = goal->getProblemRules(0);
+    fail_unless(rules.size() == 1);
+    fail_unless(rules[0].type == libdnf::Goal::ProblemRule::PROTECTED_REMOVAL);
     hy_goal_free(goal);
 
     dnf_packageset_free(protected_pkgs);
@@ -1023,6 +1223,27 @@ START_TEST(test_goal_distupgrade_all)
 }
 END_TEST
 
+START_TEST(test_goal_distupgrade_preresolved)
+{
+    HyGoal goal = hy_goal_create(test_globals.sack);
+    goal->distupgradePreresolved();
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+
+    // the same transaction as the plain distupgrade in a single solve
+    assert_iueo(goal, 0, 1, 0, 0);
+    ck_assert_int_eq(goal->getStats().solves, 1);
+    GPtrArray *plist = hy_goal_list_upgrades(goal, NULL);
+    assert_nevra_eq(static_cast<DnfPackage *>(g_ptr_array_index(plist, 0)), "flying-3-0.noarch");
+    g_ptr_array_unref(plist);
+
+    plist = hy_goal_list_downgrades(goal, NULL);
+    fail_unless(plist->len == 1);
+    assert_nevra_eq(static_cast<DnfPackage *>(g_ptr_array_index(plist, 0)), "baby-6:4.9-3.x86_64");
+    g_ptr_array_unref(plist);
+    hy_goal_free(goal);
+}
+END_TEST
+
 START_TEST(test_goal_distupgrade_all_excludes)
 {
     HyQuery q = hy_query_create_flags(test_globals.sack, HY_IGNORE_EXCLUDES);
@@ -1183,6 +1404,34 @@ START_TEST(test_goal_unneeded)
 }
 END_TEST
 
+START_TEST(test_goal_unneeded_rerun)
+{
+    DnfSack *sack = test_globals.sack;
+    HyGoal goal = hy_goal_create(sack);
+
+    for (auto name : {"baby", "bloop", "dog", "fool", "gun", "jay", "penny", "pilchard"})
+        userinstalled(sack, goal, name);
+    hy_goal_run_flags(goal, DNF_NONE);
+    ck_assert_int_eq(size_and_free(hy_goal_list_unneeded(goal, NULL)), 4);
+    ck_assert_int_eq(size_and_free(hy_goal_list_unneeded(goal, NULL)), 4);
+
+    // an additional job which is already satisfied leaves the unneeded packages as they were
+    DnfPackage *pkg = by_name_repo(sack, "fool", HY_SYSTEM_REPO_NAME);
+    fail_if(hy_goal_install(goal, pkg));
+    hy_goal_run_flags(goal, DNF_NONE);
+    assert_iueo(goal, 0, 0, 0, 0);
+    ck_assert_int_eq(size_and_free(hy_goal_list_unneeded(goal, NULL)), 4);
+
+    // another userinstalled package is computed again, flying needs penny-lib
+    userinstalled(sack, goal, "flying");
+    hy_goal_run_flags(goal, DNF_NONE);
+    ck_assert_int_eq(size_and_free(hy_goal_list_unneeded(goal, NULL)), 2);
+
+    g_object_unref(pkg);
+    hy_goal_free(goal);
+}
+END_TEST
+
 struct Solutions {
     int solutions;
     GPtrArray *installs;
@@ -1207,6 +1456,8 @@ START_TEST(test_goal_installonly_limit)
                     "k-freak-1-0-1-0.x86_64");
     assert_nevra_eq(static_cast<DnfPackage *>(g_ptr_array_index(erasures, 2)), "k-1-1.x86_64");
     g_ptr_array_unref(erasures);
+    // the limit was known before the solve
+    ck_assert_int_eq(goal->getStats().solves, 1);
 
     hy_goal_free(goal);
 }
@@ -1394,6 +1645,9 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_sanity);
     tcase_add_test(tc, test_goal_list_err);
     tcase_add_test(tc, test_goal_install);
+    tcase_add_test(tc, test_goal_reuse_solver);
+    tcase_add_test(tc, test_goal_run_many);
+    tcase_add_test(tc, test_goal_install_pset);
     tcase_add_test(tc, test_goal_install_multilib);
     tcase_add_test(tc, test_goal_install_selector);
     tcase_add_test(tc, test_goal_install_selector_err);
@@ -1407,13 +1661,17 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_upgrade_all);
     tcase_add_test(tc, test_goal_downgrade);
     tcase_add_test(tc, test_goal_get_reason);
+    tcase_add_test(tc, test_goal_get_reasons);
+    tcase_add_test(tc, test_goal_plan);
     tcase_add_test(tc, test_goal_get_reason_selector);
     tcase_add_test(tc, test_goal_describe_problem_rules);
     tcase_add_test(tc, test_goal_distupgrade_all_keep_arch);
     tcase_add_test(tc, test_goal_no_reinstall);
     tcase_add_test(tc, test_goal_erase_simple);
+    tcase_add_test(tc, test_goal_erase_pset);
     tcase_add_test(tc, test_goal_erase_with_deps);
     tcase_add_test(tc, test_goal_protected);
+    tcase_add_test(tc, test_goal_protected_cache);
     tcase_add_test(tc, test_goal_erase_clean_deps);
     tcase_add_test(tc, test_goal_forcebest);
     tcase_add_test(tc, test_goal_favor);
@@ -1434,12 +1692,14 @@ goal_suite(void)
     tc = tcase_create("Main");
     tcase_add_unchecked_fixture(tc, fixture_with_main, teardown);
     tcase_add_test(tc, test_goal_distupgrade_all);
+    tcase_add_test(tc, test_goal_distupgrade_preresolved);
     tcase_add_test(tc, test_goal_distupgrade_selector_upgrade);
     tcase_add_test(tc, test_goal_distupgrade_selector_downgrade);
     tcase_add_test(tc, test_goal_distupgrade_selector_nothing);
     tcase_add_test(tc, test_goal_install_selector_file);
     tcase_add_test(tc, test_goal_rerun);
     tcase_add_test(tc, test_goal_unneeded);
+    tcase_add_test(tc, test_goal_unneeded_rerun);
     tcase_add_test(tc, test_goal_distupgrade_all_excludes);
     suite_add_tcase(s, tc);
 
@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <glib.h>
 
 
@@ -108,11 +109,13 @@ START_TEST(test_dnf_solvfile_userdata)
     build_test_file(new_file);
 
     unsigned char cs_computed[CHKSUM_BYTES];
+    unsigned char cs_stat[CHKSUM_BYTES];
     FILE *fp = fopen(new_file, "r+");
     checksum_fp(cs_computed, fp);
+    fail_if(checksum_stat(cs_stat, fp));
 
     SolvUserdata solv_userdata;
-    fail_if(solv_userdata_fill(&solv_userdata, cs_computed, NULL));
+    fail_if(solv_userdata_fill(&solv_userdata, cs_computed, cs_stat, NULL));
 
     Pool *pool = pool_create();
     Repo *repo = repo_create(pool, "test_repo");
@@ -126,6 +129,43 @@ START_TEST(test_dnf_solvfile_userdata)
     std::unique_ptr<SolvUserdata> dnf_solvfile = solv_userdata_read(fp);
     fail_unless(dnf_solvfile);
     fail_unless(solv_userdata_verify(dnf_solvfile.get(), cs_computed));
+    fail_if(checksum_cmp(dnf_solvfile->repomd_stat, cs_stat));
+    fclose(fp);
+
+    g_free(new_file);
+    repo_free(repo, 0);
+    pool_free(pool);
+}
+END_TEST
+
+START_TEST(test_dnf_solvfile_userdata_without_stat)
+{
+    char *new_file = solv_dupjoin(test_globals.tmpdir,
+                                  "/test_dnf_solvfile_userdata_without_stat", NULL);
+    build_test_file(new_file);
+
+    unsigned char cs_computed[CHKSUM_BYTES];
+    unsigned char cs_zero[CHKSUM_BYTES] = {0};
+    FILE *fp = fopen(new_file, "r+");
+    checksum_fp(cs_computed, fp);
+
+    SolvUserdata solv_userdata;
+    fail_if(solv_userdata_fill(&solv_userdata, cs_computed, NULL, NULL));
+
+    /* written by a version not recording the repomd stat */
+    Pool *pool = pool_create();
+    Repo *repo = repo_create(pool, "test_repo");
+    Repowriter *writer = repowriter_create(repo);
+    repowriter_set_userdata(writer, &solv_userdata, solv_userdata_size_without_stat);
+    fail_if(repowriter_write(writer, fp));
+    repowriter_free(writer);
+    fclose(fp);
+
+    fp = fopen(new_file, "r");
+    std::unique_ptr<SolvUserdata> dnf_solvfile = solv_userdata_read(fp);
+    fail_unless(dnf_solvfile);
+    fail_unless(solv_userdata_verify(dnf_solvfile.get(), cs_computed));
+    fail_if(checksum_cmp(dnf_solvfile->repomd_stat, cs_zero));
     fclose(fp);
 
     g_free(new_file);
@@ -159,6 +199,32 @@ START_TEST(test_mkcachedir)
 }
 END_TEST
 
+START_TEST(test_copy_recursive)
+{
+    const char *workdir = test_globals.tmpdir;
+    g_autofree gchar *src = g_build_filename(workdir, "copy-src", NULL);
+    g_autofree gchar *src_file = g_build_filename(src, "file", NULL);
+    fail_if(g_mkdir_with_parents(src, 0755));
+    build_test_file(src_file);
+
+    for (bool hardlink : {false, true}) {
+        g_autofree gchar *dst = g_build_filename(workdir, hardlink ? "copy-link" : "copy", NULL);
+        g_autofree gchar *dst_file = g_build_filename(dst, "file", NULL);
+        fail_unless(dnf_copy_recursive(src, dst, hardlink, NULL));
+        gchar *contents = NULL;
+        fail_unless(g_file_get_contents(dst_file, &contents, NULL, NULL));
+        ck_assert_str_eq(contents, "empty");
+        g_free(contents);
+
+        struct stat st_src, st_dst;
+        fail_if(stat(src_file, &st_src) || stat(dst_file, &st_dst));
+        ck_assert_int_eq(st_src.st_mode, st_dst.st_mode);
+        /* links stay within the filesystem of the tmpdir */
+        fail_unless((st_src.st_ino == st_dst.st_ino) == hardlink);
+    }
+}
+END_TEST
+
 START_TEST(test_version_split)
 {
     Pool *pool = pool_create();
@@ -194,7 +260,9 @@ iutil_suite(void)
     tcase_add_test(tc, test_abspath);
     tcase_add_test(tc, test_checksum);
     tcase_add_test(tc, test_dnf_solvfile_userdata);
+    tcase_add_test(tc, test_dnf_solvfile_userdata_without_stat);
     tcase_add_test(tc, test_mkcachedir);
+    tcase_add_test(tc, test_copy_recursive);
     tcase_add_test(tc, test_version_split);
     suite_add_tcase(s, tc);
     return s;
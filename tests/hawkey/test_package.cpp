@@ -23,6 +23,7 @@
 
 
 #include "libdnf/dnf-advisory.h"
+#include "libdnf/dnf-package.h"
 #include "libdnf/hy-package.h"
 #include "libdnf/hy-package-private.hpp"
 #include "libdnf/hy-query.h"
@@ -61,6 +62,36 @@ START_TEST(test_identical)
 }
 END_TEST
 
+START_TEST(test_package_cache)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *pkg1 = by_name(sack, "penny-lib");
+    Id id = dnf_package_get_id(pkg1);
+
+    // not shared by default
+    DnfPackage *pkg2 = dnf_package_new(sack, id);
+    fail_if(pkg1 == pkg2);
+    g_object_unref(pkg2);
+    g_object_unref(pkg1);
+
+    dnf_sack_set_use_package_cache(sack, TRUE);
+    pkg1 = dnf_package_new(sack, id);
+    pkg2 = dnf_package_new(sack, id);
+    fail_unless(pkg1 == pkg2);
+    g_object_unref(pkg2);
+    g_object_unref(pkg1);
+
+    // a freed package is forgotten
+    pkg1 = dnf_package_new(sack, id);
+    fail_unless(dnf_package_get_id(pkg1) == id);
+    dnf_sack_set_use_package_cache(sack, FALSE);
+    pkg2 = dnf_package_new(sack, id);
+    fail_if(pkg1 == pkg2);
+    g_object_unref(pkg2);
+    g_object_unref(pkg1);
+}
+END_TEST
+
 START_TEST(test_versions)
 {
     DnfSack *sack = test_globals.sack;
@@ -337,6 +368,26 @@ START_TEST(test_presto)
 }
 END_TEST
 
+START_TEST(test_plan_deltas)
+{
+    DnfSack *sack = test_globals.sack;
+    g_autoptr(GPtrArray) packages = g_ptr_array_new_with_free_func(g_object_unref);
+    g_autoptr(GPtrArray) from_evrs = g_ptr_array_new();
+    g_ptr_array_add(packages, by_name(sack, "tour"));
+    g_ptr_array_add(from_evrs, (gpointer) "4-5");
+
+    // the delta of tour is larger than the package itself
+    GHashTable *deltas = dnf_package_array_plan_deltas(packages, from_evrs, 100, 0, 0, 0);
+    ck_assert_int_eq(g_hash_table_size(deltas), 0);
+    g_hash_table_unref(deltas);
+
+    g_ptr_array_index(from_evrs, 0) = NULL;
+    deltas = dnf_package_array_plan_deltas(packages, from_evrs, 100, 1024, 0, 1);
+    ck_assert_int_eq(g_hash_table_size(deltas), 0);
+    g_hash_table_unref(deltas);
+}
+END_TEST
+
 START_TEST(test_get_files_cmdline)
 {
     DnfSack *sack = test_globals.sack;
@@ -361,6 +412,7 @@ package_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_system_only, teardown);
     tcase_add_test(tc, test_package_summary);
     tcase_add_test(tc, test_identical);
+    tcase_add_test(tc, test_package_cache);
     tcase_add_test(tc, test_versions);
     tcase_add_test(tc, test_no_sourcerpm);
     suite_add_tcase(s, tc);
@@ -384,6 +436,7 @@ package_suite(void)
     tcase_add_test(tc, test_packager);
     tcase_add_test(tc, test_sourcerpm);
     tcase_add_test(tc, test_presto);
+    tcase_add_test(tc, test_plan_deltas);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("WithCmdlinePackage");
@@ -169,6 +169,63 @@ START_TEST(test_get_pkgid)
 }
 END_TEST
 
+START_TEST(test_iteration)
+{
+    DnfSack *sack = test_globals.sack;
+    int max = dnf_sack_last_solvable(sack);
+    libdnf::PackageSet odd(sack);
+    libdnf::PackageSet all(sack);
+    for (Id id = 0; id <= max; ++id) {
+        all.set(id);
+        if (id % 2)
+            odd.set(id);
+    }
+
+    // next() and operator[] agree with a bit by bit walk
+    unsigned int index = 0;
+    Id expected = 1;
+    for (Id id = odd.next(-1); id != -1; id = odd.next(id), expected += 2)
+        ck_assert_int_eq(id, expected);
+    ck_assert_int_eq(expected, max + (max % 2 ? 2 : 1));
+    for (Id id = 1; id <= max; id += 2)
+        ck_assert_int_eq(odd[index++], id);
+    ck_assert_int_eq(odd[index], -1);
+    ck_assert_int_eq(odd.size(), index);
+
+    libdnf::PackageSet even(all);
+    even -= odd;
+    ck_assert_int_eq(even.size(), all.size() - odd.size());
+    fail_if(even.has(1));
+    fail_unless(even.has(max - max % 2));
+    even /= odd;
+    fail_unless(even.empty());
+    even += all;
+    ck_assert_int_eq(even.size(), all.size());
+}
+END_TEST
+
+START_TEST(test_iter)
+{
+    DnfSack *sack = test_globals.sack;
+    int max = dnf_sack_last_solvable(sack);
+    DnfPackageSetIter iter;
+    Id expected[] = {0, 9, max};
+    unsigned int i = 0;
+
+    dnf_packageset_iter_init(&iter, pset);
+    while (dnf_packageset_iter_next(&iter)) {
+        fail_unless(i < G_N_ELEMENTS(expected));
+        ck_assert_int_eq(iter.id, expected[i++]);
+
+        g_autoptr(DnfPackage) pkg = dnf_packageset_iter_get_package(&iter);
+        ck_assert_int_eq(dnf_package_get_id(pkg), iter.id);
+        ck_assert_str_eq(dnf_packageset_iter_get_name(&iter), dnf_package_get_name(pkg));
+        ck_assert_str_eq(dnf_packageset_iter_get_nevra(&iter), dnf_package_get_nevra(pkg));
+    }
+    ck_assert_int_eq(i, G_N_ELEMENTS(expected));
+}
+END_TEST
+
 Suite *
 packageset_suite(void)
 {
@@ -180,6 +237,8 @@ packageset_suite(void)
     tcase_add_test(tc, test_has);
     tcase_add_test(tc, test_get_clone);
     tcase_add_test(tc, test_get_pkgid);
+    tcase_add_test(tc, test_iteration);
+    tcase_add_test(tc, test_iter);
     suite_add_tcase(s, tc);
 
     return s;
@@ -19,6 +19,8 @@
  */
 
 #include <check.h>
+#include <thread>
+#include <vector>
 
 
 #include <solv/testcase.h>
@@ -163,6 +165,34 @@ START_TEST(test_query_name)
 }
 END_TEST
 
+START_TEST(test_query_name_index)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "tour");
+    int count = query_count_results(q);
+    hy_query_free(q);
+
+    // the index built by the query above must pick up new solvables
+    Pool *pool = dnf_sack_get_pool(test_globals.sack);
+    const char *path = pool_tmpjoin(pool, test_globals.repo_dir,
+                                    "yum/tour-4-6.noarch.rpm", NULL);
+    g_object_unref(dnf_sack_add_cmdline_package(test_globals.sack, path));
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "tour");
+    fail_unless(query_count_results(q) == count + 1);
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "noarch");
+    fail_unless(query_count_results(q) == count + 1);
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "tour");
+    hy_query_filter(q, HY_PKG_ARCH, HY_NEQ, "noarch");
+    fail_if(query_count_results(q));
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_query_evr)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -277,6 +307,24 @@ START_TEST(test_query_case)
     hy_query_filter(q, HY_PKG_NAME, HY_EQ|HY_ICASE, "Penny-lib");
     fail_unless(query_count_results(q) == 1);
     hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR, "penny");
+    int count = query_count_results(q);
+    fail_unless(count == 2);
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR|HY_ICASE, "PeNnY");
+    fail_unless(query_count_results(q) == count);
+    hy_query_free(q);
+
+    // the names are only looked up, the other filters still apply
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_NEQ, "penny");
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR|HY_ICASE, "PENNY");
+    fail_unless(query_count_results(q) == 1);
+    hy_query_free(q);
 }
 END_TEST
 
@@ -482,6 +530,32 @@ START_TEST(test_query_conflicts)
 }
 END_TEST
 
+START_TEST(test_query_requires)
+{
+    DnfSack *sack = test_globals.sack;
+    HyQuery q = hy_query_create(sack);
+    DnfReldep *reldep = dnf_reldep_new(sack, "semolina", HY_GT|HY_EQ, "2");
+    hy_query_filter_reldep(q, HY_PKG_REQUIRES, reldep);
+    fail_unless(query_count_results(q) == 1);
+    delete reldep;
+    hy_query_free(q);
+
+    q = hy_query_create(sack);
+    reldep = dnf_reldep_new(sack, "semolina", HY_GT, "2");
+    hy_query_filter_reldep(q, HY_PKG_REQUIRES, reldep);
+    fail_unless(query_count_results(q) == 0);
+    delete reldep;
+    hy_query_free(q);
+
+    // the solvables of the dependency name are intersected with the previous filters
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_NEQ, "walrus");
+    hy_query_filter(q, HY_PKG_REQUIRES, HY_EQ, "fool");
+    fail_unless(query_count_results(q) == 0);
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_upgrades_sanity)
 {
     Pool *pool = dnf_sack_get_pool(test_globals.sack);
@@ -532,6 +606,29 @@ START_TEST(test_filter_latest)
 }
 END_TEST
 
+START_TEST(test_filter_latest_order)
+{
+    // filters applied after latest see only the latest packages
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "fool");
+    hy_query_filter_latest_per_arch(q, 1);
+    hy_query_filter(q, HY_PKG_RELEASE, HY_NEQ, "5");
+    fail_if(query_count_results(q));
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_RELEASE, HY_NEQ, "5");
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "fool");
+    hy_query_filter_latest_per_arch(q, 1);
+    GPtrArray *plist = hy_query_run(q);
+    fail_unless(plist->len == 1);
+    auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, 0));
+    fail_if(strcmp(dnf_package_get_evr(pkg), "1-3"));
+    hy_query_free(q);
+    g_ptr_array_unref(plist);
+}
+END_TEST
+
 START_TEST(test_filter_latest2)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -552,6 +649,41 @@ START_TEST(test_filter_latest2)
 }
 END_TEST
 
+START_TEST(test_filter_latest_by_priority)
+{
+    Pool *pool = dnf_sack_get_pool(test_globals.sack);
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter_num(q, HY_PKG_LATEST_PER_ARCH_BY_PRIORITY, HY_EQ, 1);
+    // jay-6.0-0 is both installed and in main
+    fail_unless(query_count_results(q) == 2);
+    hy_query_free(q);
+
+    // the sorted order cached by the sack has to follow priority changes
+    Repo *main_repo = NULL;
+    Repo *repo;
+    int i;
+    FOR_REPOS(i, repo)
+        if (!strcmp(repo->name, "main"))
+            main_repo = repo;
+    fail_unless(main_repo != NULL);
+    main_repo->priority = 1;
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter_num(q, HY_PKG_LATEST_PER_ARCH_BY_PRIORITY, HY_EQ, 1);
+    GPtrArray *plist = hy_query_run(q);
+    fail_unless(plist->len == 1);
+    auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, 0));
+    fail_if(strcmp(dnf_package_get_reponame(pkg), "main"));
+    fail_if(strcmp(dnf_package_get_evr(pkg), "6.0-0"));
+    g_ptr_array_unref(plist);
+    hy_query_free(q);
+
+    main_repo->priority = 0;
+}
+END_TEST
+
 START_TEST(test_filter_latest_archs)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -757,6 +889,16 @@ START_TEST(test_filter_sourcerpm)
     hy_query_filter(q, HY_PKG_SOURCERPM, HY_EQ,
                     "mystery-devel-19.67-1.noarch.rpm");
     fail_unless(size_and_free(q) == 0);
+
+    const char *srpms[] = {"tour-4-6.src.rpm", "mystery-19.67-1.src.rpm", NULL};
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter_in(q, HY_PKG_SOURCERPM, HY_EQ, srpms);
+    fail_unless(size_and_free(q) == 2);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "tour");
+    hy_query_filter_in(q, HY_PKG_SOURCERPM, HY_EQ, srpms);
+    fail_unless(size_and_free(q) == 1);
 }
 END_TEST
 
@@ -769,6 +911,28 @@ START_TEST(test_filter_description)
 }
 END_TEST
 
+START_TEST(test_filter_substring_index)
+{
+    DnfSack *sack = test_globals.sack;
+    dnf_sack_set_use_substring_index(sack, TRUE);
+
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_DESCRIPTION, HY_SUBSTR, "Magical development files for mystery.");
+    fail_unless(size_and_free(q) == 1);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_DESCRIPTION, HY_SUBSTR|HY_ICASE, "MAGICAL DEVELOPMENT");
+    fail_unless(size_and_free(q) == 1);
+
+    // the trigrams are there, the substring is not
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_DESCRIPTION, HY_SUBSTR, "magical development");
+    fail_unless(size_and_free(q) == 0);
+
+    dnf_sack_set_use_substring_index(sack, FALSE);
+}
+END_TEST
+
 START_TEST(test_filter_obsoletes)
 {
     DnfSack *sack = test_globals.sack;
@@ -790,6 +954,73 @@ START_TEST(test_filter_obsoletes)
 }
 END_TEST
 
+START_TEST(test_filter_requires_pset)
+{
+    DnfSack *sack = test_globals.sack;
+    HyQuery q = hy_query_create(sack);
+    DnfPackageSet *pset = dnf_packageset_new(sack);
+
+    hy_query_filter_package_in(q, HY_PKG_REQUIRES, HY_EQ, pset);
+    fail_unless(query_count_results(q) == 0);
+    hy_query_clear(q);
+
+    // only walrus requires fool
+    DnfPackage *pkg = by_name(sack, "fool");
+    dnf_packageset_add(pset, pkg);
+    g_object_unref(pkg);
+    hy_query_filter_package_in(q, HY_PKG_REQUIRES, HY_EQ, pset);
+    fail_unless(query_count_results(q) == 1);
+    hy_query_clear(q);
+
+    hy_query_filter(q, HY_PKG_NAME, HY_NEQ, "walrus");
+    hy_query_filter_package_in(q, HY_PKG_REQUIRES, HY_EQ, pset);
+    fail_unless(query_count_results(q) == 0);
+
+    hy_query_free(q);
+    delete pset;
+}
+END_TEST
+
+START_TEST(test_query_dependency_closure)
+{
+    DnfSack *sack = test_globals.sack;
+    HyQuery universe = hy_query_create(sack);
+    hy_query_filter(universe, HY_PKG_REPONAME, HY_EQ, "main");
+    const DnfPackageSet *mainPkgs = hy_query_run_set(universe);
+
+    // walrus requires semolina of both arches and fool
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "walrus");
+    hy_query_filter(q, HY_PKG_REPONAME, HY_EQ, "main");
+    libdnf::Query seed(*q);
+    fail_if(q->addDependencyClosure(HY_PKG_REQUIRES, false, 0, mainPkgs));
+    ck_assert_int_eq(q->size(), 1);
+    fail_if(q->addDependencyClosure(HY_PKG_REQUIRES, false, -1, mainPkgs));
+    ck_assert_int_eq(q->size(), 4);
+    hy_query_free(q);
+
+    // only walrus requires fool, nothing requires walrus
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "fool");
+    hy_query_filter(q, HY_PKG_REPONAME, HY_EQ, "main");
+    fail_if(q->addDependencyClosure(HY_PKG_REQUIRES, true, -1, mainPkgs));
+    ck_assert_int_eq(q->size(), 2);
+    hy_query_free(q);
+
+    // all the flyings of all repos but the one requiring P-lib >= 3-4
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "penny-lib");
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    hy_query_filter(q, HY_PKG_REPONAME, HY_EQ, "main");
+    fail_if(q->addDependencyClosure(HY_PKG_REQUIRES, true));
+    ck_assert_int_eq(q->size(), 5);
+    hy_query_free(q);
+
+    fail_unless(seed.addDependencyClosure(HY_PKG_NAME, false) == DNF_ERROR_BAD_QUERY);
+    hy_query_free(universe);
+}
+END_TEST
+
 START_TEST(test_filter_reponames)
 {
     HyQuery q;
@@ -815,6 +1046,37 @@ START_TEST(test_filter_reponames)
 }
 END_TEST
 
+START_TEST(test_query_repo_maps)
+{
+    const char *system_repo[] = {HY_SYSTEM_REPO_NAME, NULL};
+    HyQuery q;
+
+    q = hy_query_create(test_globals.sack);
+    q->installed();
+    fail_unless(query_count_results(q) == TEST_EXPECT_SYSTEM_NSOLVABLES);
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    q->available();
+    fail_unless(query_count_results(q) == TEST_EXPECT_MAIN_NSOLVABLES \
+                                        + TEST_EXPECT_UPDATES_NSOLVABLES);
+    hy_query_free(q);
+
+    // the repo maps cover solvables outside of the result, the filter must not add them
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "penny");
+    hy_query_filter_in(q, HY_PKG_REPONAME, HY_EQ, system_repo);
+    fail_unless(query_count_results(q) == 1);
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter_in(q, HY_PKG_REPONAME, HY_NEQ, system_repo);
+    fail_unless(query_count_results(q) == TEST_EXPECT_MAIN_NSOLVABLES \
+                                        + TEST_EXPECT_UPDATES_NSOLVABLES);
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_excluded)
 {
     DnfSack *sack = test_globals.sack;
@@ -838,6 +1100,156 @@ START_TEST(test_excluded)
 }
 END_TEST
 
+START_TEST(test_query_cache)
+{
+    DnfSack *sack = test_globals.sack;
+    dnf_sack_set_use_query_cache(sack, TRUE);
+
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    int count = query_count_results(q);
+    fail_unless(count > 0);
+    hy_query_free(q);
+
+    // an identical query is answered from the cache
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    fail_unless(query_count_results(q) == count);
+    hy_query_free(q);
+
+    q = hy_query_create_flags(sack, HY_IGNORE_EXCLUDES);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    DnfPackageSet *pset = hy_query_run_set(q);
+    dnf_sack_add_excludes(sack, pset);
+    delete pset;
+    hy_query_free(q);
+
+    // the excludes drop the cached results
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    fail_unless(query_count_results(q) == 0);
+    hy_query_free(q);
+
+    dnf_sack_set_use_query_cache(sack, FALSE);
+}
+END_TEST
+
+START_TEST(test_excluded_incremental)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    HyQuery q = hy_query_create_flags(sack, HY_IGNORE_EXCLUDES);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "penny");
+    DnfPackageSet *pset = hy_query_run_set(q);
+    hy_query_free(q);
+
+    // exclude something first to have a considered map
+    q = hy_query_create_flags(sack, HY_IGNORE_EXCLUDES);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    DnfPackageSet *jay = hy_query_run_set(q);
+    dnf_sack_add_excludes(sack, jay);
+    delete jay;
+    hy_query_free(q);
+    dnf_sack_recompute_considered(sack);
+    fail_unless(pool->considered != NULL);
+
+    // updated in place by adding the excludes
+    dnf_sack_add_excludes(sack, pset);
+    dnf_sack_recompute_considered(sack);
+    Map incremental;
+    map_init_clone(&incremental, pool->considered);
+
+    dnf_sack_set_considered_to_update(sack);
+    dnf_sack_recompute_considered(sack);
+    fail_unless(incremental.size == pool->considered->size);
+    fail_if(memcmp(incremental.map, pool->considered->map, incremental.size));
+    map_free(&incremental);
+    delete pset;
+}
+END_TEST
+
+START_TEST(test_freeze)
+{
+    DnfSack *sack = test_globals.sack;
+    dnf_sack_freeze(sack);
+    fail_unless(dnf_sack_is_frozen(sack));
+
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter(q, HY_PKG_VERSION, HY_EQ, "5.0");
+    GPtrArray *plist = hy_query_run(q);
+    fail_unless(plist->len > 0);
+    for (guint i = 0; i < plist->len; ++i) {
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, i));
+        ck_assert_str_eq(dnf_package_get_version(pkg), "5.0");
+        ck_assert_str_eq(dnf_package_get_release(pkg), "0");
+    }
+    g_ptr_array_unref(plist);
+    hy_query_free(q);
+    fail_unless(dnf_sack_is_frozen(sack));
+
+    // a writer ends the frozen state
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "penny");
+    DnfPackageSet *pset = hy_query_run_set(q);
+    dnf_sack_add_excludes(sack, pset);
+    delete pset;
+    hy_query_free(q);
+    fail_if(dnf_sack_is_frozen(sack));
+}
+END_TEST
+
+START_TEST(test_freeze_threads)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    // as after adding packages, the first query would build the set of all the packages
+    Map empty;
+    map_init(&empty, 0);
+    dnf_sack_set_pkg_solvables(sack, &empty, 0);
+    map_free(&empty);
+    dnf_sack_freeze(sack);
+    ck_assert_int_eq(dnf_sack_get_pool_nsolvables(sack), pool->nsolvables);
+
+    const int nthreads = 8;
+    const int nruns = 50;
+    std::vector<std::vector<size_t>> sizes(nthreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([sack, &sizes, t] {
+            for (int i = 0; i < nruns; ++i) {
+                libdnf::Query all(sack);
+                libdnf::Query jay(sack);
+                jay.addFilter(HY_PKG_NAME, HY_EQ, "jay");
+                libdnf::Query latest(sack);
+                latest.addFilter(HY_PKG_LATEST_PER_ARCH, HY_EQ, 1);
+                sizes[t].push_back(all.size());
+                sizes[t].push_back(jay.size());
+                sizes[t].push_back(latest.size());
+            }
+        });
+    }
+    for (auto & thread : threads)
+        thread.join();
+    fail_unless(dnf_sack_is_frozen(sack));
+
+    libdnf::Query all(sack);
+    libdnf::Query jay(sack);
+    jay.addFilter(HY_PKG_NAME, HY_EQ, "jay");
+    libdnf::Query latest(sack);
+    latest.addFilter(HY_PKG_LATEST_PER_ARCH, HY_EQ, 1);
+    fail_unless(jay.size() > 0);
+    for (const auto & threadSizes : sizes) {
+        ck_assert_int_eq(threadSizes.size(), 3 * nruns);
+        for (int i = 0; i < nruns; ++i) {
+            ck_assert_int_eq(threadSizes[3 * i], all.size());
+            ck_assert_int_eq(threadSizes[3 * i + 1], jay.size());
+            ck_assert_int_eq(threadSizes[3 * i + 2], latest.size());
+        }
+    }
+}
+END_TEST
+
 START_TEST(test_disabled_repo)
 {
     DnfSack *sack = test_globals.sack;
@@ -902,6 +1314,25 @@ START_TEST(test_query_nevra)
 }
 END_TEST
 
+START_TEST(test_query_nevra_strict)
+{
+    DnfSack *sack = test_globals.sack;
+    HyQuery q;
+
+    const char *nevras[] = {"penny-4-1.noarch", "penny-lib-4-1.x86_64", "penny-9-9.noarch", NULL};
+    q = hy_query_create(sack);
+    hy_query_filter_in(q, HY_PKG_NEVRA_STRICT, HY_EQ, nevras);
+    fail_unless(size_and_free(q) == 2);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NEVRA_STRICT, HY_GT, "penny-4-1.noarch");
+    int newer = size_and_free(q);
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NEVRA_STRICT, HY_GT | HY_EQ, "penny-4-1.noarch");
+    fail_unless(size_and_free(q) == newer + 1);
+}
+END_TEST
+
 START_TEST(test_query_multiple_flags)
 {
     DnfSack *sack = test_globals.sack;
@@ -1062,6 +1493,7 @@ query_suite(void)
     tcase_add_test(tc, test_query_provides);
     tcase_add_test(tc, test_query_fileprovides);
     tcase_add_test(tc, test_query_nevra);
+    tcase_add_test(tc, test_query_nevra_strict);
     tcase_add_test(tc, test_query_nevra_glob);
     tcase_add_test(tc, test_query_multiple_flags);
     tcase_add_test(tc, test_query_apply);
@@ -1073,6 +1505,7 @@ query_suite(void)
     tcase_add_test(tc, test_upgrades);
     tcase_add_test(tc, test_upgradable);
     tcase_add_test(tc, test_filter_latest);
+    tcase_add_test(tc, test_filter_latest_order);
     tcase_add_test(tc, test_query_provides_in);
     tcase_add_test(tc, test_query_provides_in_not_found);
     suite_add_tcase(s, tc);
@@ -1092,14 +1525,24 @@ query_suite(void)
     tcase_add_test(tc, test_query_reldep);
     tcase_add_test(tc, test_query_reldep_arbitrary);
     tcase_add_test(tc, test_query_conflicts);
+    tcase_add_test(tc, test_query_requires);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("Indexes");
+    tcase_add_unchecked_fixture(tc, fixture_with_main, teardown);
+    tcase_add_test(tc, test_query_name_index);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Full");
     tcase_add_unchecked_fixture(tc, fixture_all, teardown);
     tcase_add_test(tc, test_filter_latest2);
     tcase_add_test(tc, test_filter_latest_archs);
+    tcase_add_test(tc, test_filter_latest_by_priority);
     tcase_add_test(tc, test_filter_obsoletes);
+    tcase_add_test(tc, test_filter_requires_pset);
+    tcase_add_test(tc, test_query_dependency_closure);
     tcase_add_test(tc, test_filter_reponames);
+    tcase_add_test(tc, test_query_repo_maps);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Filelists etc.");
@@ -1107,6 +1550,7 @@ query_suite(void)
     tcase_add_test(tc, test_filter_files);
     tcase_add_test(tc, test_filter_sourcerpm);
     tcase_add_test(tc, test_filter_description);
+    tcase_add_test(tc, test_filter_substring_index);
     tcase_add_test(tc, test_query_location);
     suite_add_tcase(s, tc);
 
@@ -1114,7 +1558,11 @@ query_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_with_main, teardown);
     tcase_add_checked_fixture(tc, fixture_reset, NULL);
     tcase_add_test(tc, test_excluded);
+    tcase_add_test(tc, test_excluded_incremental);
     tcase_add_test(tc, test_disabled_repo);
+    tcase_add_test(tc, test_query_cache);
+    tcase_add_test(tc, test_freeze);
+    tcase_add_test(tc, test_freeze_threads);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Advisories");
@@ -20,9 +20,13 @@
 
 #include <check.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <set>
+#include <string>
 
 
 #include <solv/testcase.h>
@@ -30,12 +34,17 @@
 #include <glib/gstdio.h>
 
 #include <libdnf/repo/Repo-private.hpp>
+#include "libdnf/dnf-context.hpp"
+#include "libdnf/dnf-repo.h"
+#include "libdnf/dnf-sack-server.h"
 #include "libdnf/dnf-types.h"
 #include "libdnf/hy-package-private.hpp"
 #include "libdnf/hy-repo-private.hpp"
 #include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/hy-util.h"
 #include "libdnf/hy-iutil-private.hpp"
+#include "libdnf/sack/packageset.hpp"
+#include "libdnf/sack/query.hpp"
 #include "fixtures.h"
 #include "testsys.h"
 #include "test_suites.h"
@@ -172,6 +181,114 @@ START_TEST(test_add_cmdline_package)
 }
 END_TEST
 
+START_TEST(test_add_cmdline_packages)
+{
+    g_autoptr(DnfSack) sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+
+    g_autofree gchar *path_mystery = g_build_filename (TESTDATADIR, "/hawkey/yum/mystery-devel-19.67-1.noarch.rpm", NULL);
+    g_autofree gchar *path_null_rpm = g_build_filename (test_globals.tmpdir, "null-batch.rpm", NULL);
+    g_autofree gchar *path_tour = g_build_filename (TESTDATADIR, "/hawkey/yum/tour-4-6.noarch.rpm", NULL);
+    FILE *fp = g_fopen (path_null_rpm, "w");
+    fail_unless (fp != NULL);
+    fclose (fp);
+    const gchar *fns[] = {path_mystery, path_null_rpm, "no-such.rpm", path_tour, NULL};
+
+    g_autoptr(GPtrArray) pkgs = dnf_sack_add_cmdline_packages (sack, fns);
+    ck_assert_int_eq(pkgs->len, 2);
+    auto pkg_mystery = static_cast<DnfPackage *>(g_ptr_array_index(pkgs, 0));
+    auto pkg_tour = static_cast<DnfPackage *>(g_ptr_array_index(pkgs, 1));
+    ck_assert_str_eq(path_mystery, dnf_package_get_location(pkg_mystery));
+    ck_assert_str_eq(path_tour, dnf_package_get_location(pkg_tour));
+    ck_assert_str_eq(dnf_package_get_reponame(pkg_tour), HY_CMDLINE_REPO_NAME);
+    fail_if(dnf_package_get_chksum(pkg_tour, NULL) == NULL);
+    ck_assert_int_eq(dnf_sack_count(sack), 2);
+}
+END_TEST
+
+/* the packages of the sack are those of its repos, no freed solvable of a dropped
+ * repo matches the queries */
+static void
+check_reloaded(DnfSack *sack, size_t expected)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    libdnf::Query all(sack, libdnf::Query::ExcludeFlags::IGNORE_EXCLUDES);
+    auto pset = all.runSet();
+    ck_assert_int_eq(pset->size(), expected);
+    for (Id id = pset->next(-1); id != -1; id = pset->next(id))
+        fail_if(pool_id2solvable(pool, id)->repo == NULL);
+
+    libdnf::Query penny(sack);
+    penny.addFilter(HY_PKG_NAME, HY_EQ, "penny");
+    fail_if(penny.empty());
+}
+
+START_TEST(test_reload_repos)
+{
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *cachedir = g_build_filename(test_globals.tmpdir, "reload", NULL);
+    g_autofree gchar *rootdir = g_build_filename(cachedir, "root", NULL);
+    g_autofree gchar *empty_repomd = g_build_filename(cachedir, "repomd.xml", NULL);
+    g_autofree gchar *empty_primary = g_build_filename(cachedir, "primary.xml", NULL);
+    fail_if(g_mkdir_with_parents(rootdir, 0755));
+
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, cachedir);
+    dnf_sack_set_rootdir(sack, rootdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    Pool *pool = dnf_sack_get_pool(sack);
+
+    // the yum repo in the middle of the pool
+    fail_if(load_repo(pool, HY_SYSTEM_REPO_NAME,
+                      pool_tmpjoin(pool, test_globals.repo_dir, HY_SYSTEM_REPO_NAME, ".repo"), 1));
+    g_autoptr(DnfContext) context = dnf_context_new();
+    g_autoptr(DnfRepo) repo = dnf_repo_new(context);
+    dnf_repo_set_id(repo, YUM_REPO_NAME);
+    HyRepo hrepo = dnf_repo_get_repo(repo);
+    HyRepo yum = glob_for_repofiles(pool, YUM_REPO_NAME,
+                                    pool_tmpjoin(pool, test_globals.repo_dir, YUM_DIR_SUFFIX, NULL));
+    hy_repo_set_string(hrepo, HY_REPO_MD_FN, hy_repo_get_string(yum, HY_REPO_MD_FN));
+    hy_repo_set_string(hrepo, HY_REPO_PRIMARY_FN, hy_repo_get_string(yum, HY_REPO_PRIMARY_FN));
+    hy_repo_free(yum);
+    fail_unless(dnf_sack_load_repo(sack, hrepo, DNF_SACK_LOAD_FLAG_BUILD_CACHE, NULL));
+    fail_if(load_repo(pool, "main", pool_tmpjoin(pool, test_globals.repo_dir, "main", ".repo"), 0));
+
+    const size_t nall = TEST_EXPECT_SYSTEM_NSOLVABLES + TEST_EXPECT_YUM_NSOLVABLES +
+                        TEST_EXPECT_MAIN_NSOLVABLES;
+    check_reloaded(sack, nall);
+
+    fail_unless(dnf_sack_reload_repo(sack, repo, DNF_SACK_ADD_FLAG_NONE, &error));
+    fail_unless(error == NULL);
+    check_reloaded(sack, nall);
+
+    // an emptied repo adds no solvables, pool->nsolvables stays the same
+    fail_unless(g_file_set_contents(empty_repomd,
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\"><revision>2</revision></repomd>\n",
+        -1, NULL));
+    fail_unless(g_file_set_contents(empty_primary,
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" packages=\"0\"></metadata>\n",
+        -1, NULL));
+    hy_repo_set_string(hrepo, HY_REPO_MD_FN, empty_repomd);
+    hy_repo_set_string(hrepo, HY_REPO_PRIMARY_FN, empty_primary);
+    const int nsolvables = pool->nsolvables;
+    fail_unless(dnf_sack_reload_repo(sack, repo, DNF_SACK_ADD_FLAG_NONE, &error));
+    fail_unless(error == NULL);
+    ck_assert_int_eq(pool->nsolvables, nsolvables);
+    check_reloaded(sack, nall - TEST_EXPECT_YUM_NSOLVABLES);
+
+    // the root has no rpmdb, only the installed packages being gone matters here
+    dnf_sack_reload_system_repo(sack, 0, &error);
+    g_clear_error(&error);
+    ck_assert_int_eq(pool->nsolvables, nsolvables);
+    check_reloaded(sack, TEST_EXPECT_MAIN_NSOLVABLES);
+
+    g_object_unref(sack);
+}
+END_TEST
+
 START_TEST(test_repo_load)
 {
     fail_unless(dnf_sack_count(test_globals.sack) ==
@@ -285,6 +402,557 @@ START_TEST(test_presto_from_cache)
 }
 END_TEST
 
+static DnfSack *
+yum_sack_from_cache(int flags = 0)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR | flags, NULL));
+    setup_yum_sack(sack, YUM_REPO_NAME);
+    dnf_sack_make_provides_ready(sack);
+    return sack;
+}
+
+START_TEST(test_whatprovides_from_cache)
+{
+    /* a sack that had to extend the file provides in the repo caches does not
+     * store the index, the next one does */
+    g_object_unref(yum_sack_from_cache());
+    DnfSack *sack1 = yum_sack_from_cache();
+    char *fn = solv_dupjoin(test_globals.tmpdir, "/", DNF_SACK_WHATPROVIDES_CACHE_FN);
+    fail_if(access(fn, R_OK));
+    g_free(fn);
+
+    DnfSack *sack2 = yum_sack_from_cache();
+    Pool *pool1 = dnf_sack_get_pool(sack1);
+    Pool *pool2 = dnf_sack_get_pool(sack2);
+    ck_assert_int_eq(pool1->ss.nstrings, pool2->ss.nstrings);
+    for (Id id = 1; id < pool1->ss.nstrings; ++id) {
+        Id *p1 = pool_whatprovides_ptr(pool1, id);
+        Id *p2 = pool_whatprovides_ptr(pool2, id);
+        for (; *p1 && *p1 == *p2; ++p1, ++p2) ;
+        ck_assert_int_eq(*p1, *p2);
+    }
+    /* the file provides are added to the solvables on a cache hit too */
+    ck_assert_int_eq(pool1->nsolvables, pool2->nsolvables);
+    for (Id p = 2; p < pool1->nsolvables; ++p) {
+        Solvable *s1 = pool_id2solvable(pool1, p);
+        Solvable *s2 = pool_id2solvable(pool2, p);
+        if (!s1->repo || !s1->provides)
+            continue;
+        Id *d1 = s1->repo->idarraydata + s1->provides;
+        Id *d2 = s2->repo->idarraydata + s2->provides;
+        for (; *d1 && *d1 == *d2; ++d1, ++d2) ;
+        ck_assert_int_eq(*d1, *d2);
+    }
+    g_object_unref(sack1);
+    g_object_unref(sack2);
+}
+END_TEST
+
+START_TEST(test_whatprovides_huge_pages)
+{
+    g_object_unref(yum_sack_from_cache());
+    DnfSack *sack1 = yum_sack_from_cache();
+    DnfSack *sack2 = yum_sack_from_cache(DNF_SACK_SETUP_FLAG_HUGE_PAGES);
+    Pool *pool1 = dnf_sack_get_pool(sack1);
+    Pool *pool2 = dnf_sack_get_pool(sack2);
+    ck_assert_int_eq(pool1->ss.nstrings, pool2->ss.nstrings);
+    for (Id id = 1; id < pool1->ss.nstrings; ++id) {
+        Id *p1 = pool_whatprovides_ptr(pool1, id);
+        Id *p2 = pool_whatprovides_ptr(pool2, id);
+        for (; *p1 && *p1 == *p2; ++p1, ++p2) ;
+        ck_assert_int_eq(*p1, *p2);
+    }
+    /* a new relation grows the huge page backed index like any other */
+    libdnf::Query query(sack2);
+    query.addFilter(HY_PKG_PROVIDES, HY_EQ, "no-such-capability > 1");
+    ck_assert_int_eq(query.size(), 0);
+    g_object_unref(sack1);
+    g_object_unref(sack2);
+}
+END_TEST
+
+static DnfSack *
+yum_sack_in(const char *cachedir)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, cachedir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    setup_yum_sack(sack, YUM_REPO_NAME);
+    dnf_sack_make_provides_ready(sack);
+    return sack;
+}
+
+/* the providers of every string and version comparing reldep of pool1 are the same
+ * packages in pool2 */
+static void
+check_same_providers(Pool *pool1, Pool *pool2)
+{
+    for (Id id = 2; id < pool1->ss.nstrings + pool1->nrels; ++id) {
+        Id dep = id, dep2 = 0;
+        if (id < pool1->ss.nstrings) {
+            dep2 = pool_str2id(pool2, pool_id2str(pool1, id), 0);
+        } else {
+            dep = MAKERELDEP(id - pool1->ss.nstrings);
+            Reldep *rd = GETRELDEP(pool1, dep);
+            if (ISRELDEP(rd->name) || ISRELDEP(rd->evr) || rd->flags < 1 || rd->flags > 7)
+                continue;
+            Id name2 = pool_str2id(pool2, pool_id2str(pool1, rd->name), 0);
+            Id evr2 = pool_str2id(pool2, pool_id2str(pool1, rd->evr), 0);
+            if (name2 && evr2)
+                dep2 = pool_rel2id(pool2, name2, evr2, rd->flags, 0);
+        }
+        std::set<std::string> providers1, providers2;
+        for (Id *p = pool_whatprovides_ptr(pool1, dep); *p; ++p)
+            providers1.insert(pool_solvid2str(pool1, *p));
+        if (dep2) {
+            for (Id *p = pool_whatprovides_ptr(pool2, dep2); *p; ++p)
+                providers2.insert(pool_solvid2str(pool2, *p));
+        }
+        fail_unless(providers1 == providers2, "providers of %s differ", pool_dep2str(pool1, dep));
+    }
+}
+
+START_TEST(test_whatprovides_cache_xml)
+{
+    g_autofree gchar *cachedir = g_build_filename(test_globals.tmpdir, "whatprovides-xml", NULL);
+    g_autofree gchar *fn = g_build_filename(cachedir, DNF_SACK_WHATPROVIDES_CACHE_FN, NULL);
+
+    /* the Ids of a sack parsing the XML differ from the sacks reading the solv files */
+    DnfSack *sack_xml = yum_sack_in(cachedir);
+    HyRepo repo = hrepo_by_name(sack_xml, YUM_REPO_NAME);
+    fail_unless(libdnf::repoGetImpl(repo)->state_main == _HY_WRITTEN);
+    fail_unless(access(fn, F_OK) == -1);
+
+    g_object_unref(yum_sack_in(cachedir));
+    g_object_unref(yum_sack_in(cachedir));
+    fail_if(access(fn, R_OK));
+    DnfSack *sack_solv = yum_sack_in(cachedir);
+
+    check_same_providers(dnf_sack_get_pool(sack_xml), dnf_sack_get_pool(sack_solv));
+    check_same_providers(dnf_sack_get_pool(sack_solv), dnf_sack_get_pool(sack_xml));
+    g_object_unref(sack_xml);
+    g_object_unref(sack_solv);
+}
+END_TEST
+
+START_TEST(test_unload_exts)
+{
+    DnfSack *sack = yum_sack_from_cache();
+    HyRepo repo = hrepo_by_name(sack, YUM_REPO_NAME);
+    auto repoImpl = libdnf::repoGetImpl(repo);
+    Id filenames = repoImpl->filenames_repodata;
+    Id presto = repoImpl->presto_repodata;
+    fail_unless(filenames > 0 && presto > filenames);
+
+    fail_unless(dnf_sack_unload_repo_exts(sack, repo, DNF_SACK_LOAD_FLAG_USE_FILELISTS, NULL));
+    fail_unless(repoImpl->state_filelists == _HY_NEW);
+    ck_assert_int_eq(repoImpl->filenames_repodata, 0);
+    ck_assert_int_eq(repoImpl->presto_repodata, presto - 1);
+    check_prestoinfo(dnf_sack_get_pool(sack));
+
+    /* the file is listed only in the filelists, the query loads them again */
+    libdnf::Query query(sack);
+    query.addFilter(HY_PKG_FILE, HY_EQ, "/usr/lib/python2.7/site-packages/tour/today.pyc");
+    ck_assert_int_eq(query.size(), 1);
+    fail_unless(repoImpl->state_filelists == _HY_LOADED_CACHE);
+    check_filelist(dnf_sack_get_pool(sack));
+
+    g_autoptr(GError) error = NULL;
+    fail_if(dnf_sack_unload_repo_exts(sack, repo, DNF_SACK_LOAD_FLAG_USE_UPDATEINFO, &error));
+    fail_unless(g_error_matches(error, DNF_ERROR, DNF_ERROR_NO_CAPABILITY));
+    g_object_unref(sack);
+}
+END_TEST
+
+START_TEST(test_lazy_filelists)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    Pool *pool = dnf_sack_get_pool(sack);
+    const char *repo_path = pool_tmpjoin(pool, test_globals.repo_dir, YUM_DIR_SUFFIX, NULL);
+    HyRepo repo = glob_for_repofiles(pool, YUM_REPO_NAME, repo_path);
+    fail_unless(dnf_sack_load_repo(sack, repo,
+                                   DNF_SACK_LOAD_FLAG_BUILD_CACHE |
+                                   DNF_SACK_LOAD_FLAG_LAZY_FILELISTS, NULL));
+    auto repoImpl = libdnf::repoGetImpl(repo);
+    fail_unless(repoImpl->state_filelists == _HY_NEW);
+
+    /* no dependency in the repo needs a file outside primary */
+    dnf_sack_make_provides_ready(sack);
+    fail_unless(repoImpl->state_filelists == _HY_NEW);
+
+    /* primary lists the files in /etc */
+    libdnf::Query etc(sack);
+    etc.addFilter(HY_PKG_PROVIDES, HY_EQ, "/etc/rollup");
+    ck_assert_int_eq(etc.size(), 1);
+    fail_unless(repoImpl->state_filelists == _HY_NEW);
+
+    libdnf::Query lib(sack);
+    lib.addFilter(HY_PKG_PROVIDES, HY_EQ, "/usr/lib/python2.7/site-packages/tour/today.py");
+    ck_assert_int_eq(lib.size(), 1);
+    fail_unless(repoImpl->state_filelists != _HY_NEW);
+    check_filelist(pool);
+
+    hy_repo_free(repo);
+    g_object_unref(sack);
+}
+END_TEST
+
+START_TEST(test_background_cache)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    Pool *pool = dnf_sack_get_pool(sack);
+    g_autofree char *repo_path = g_strconcat(test_globals.repo_dir, YUM_DIR_SUFFIX, NULL);
+    HyRepo repo = glob_for_repofiles(pool, "test_sack_background", repo_path);
+    fail_unless(dnf_sack_load_repo(sack, repo,
+                                   DNF_SACK_LOAD_FLAG_BUILD_CACHE |
+                                   DNF_SACK_LOAD_FLAG_USE_FILELISTS |
+                                   DNF_SACK_LOAD_FLAG_BACKGROUND_CACHE, NULL));
+    auto repoImpl = libdnf::repoGetImpl(repo);
+    fail_unless(repoImpl->state_main == _HY_WRITTEN);
+    fail_unless(repoImpl->state_filelists == _HY_WRITTEN);
+    check_filelist(pool);
+    char *filename = dnf_sack_give_cache_fn(sack, "test_sack_background", NULL);
+    hy_repo_free(repo);
+    /* finalizing waits for the queued writes */
+    g_object_unref(sack);
+    fail_if(access(filename, R_OK|W_OK));
+    g_free(filename);
+
+    sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    pool = dnf_sack_get_pool(sack);
+    repo = glob_for_repofiles(pool, "test_sack_background", repo_path);
+    fail_unless(dnf_sack_load_repo(sack, repo, DNF_SACK_LOAD_FLAG_USE_FILELISTS, NULL));
+    repoImpl = libdnf::repoGetImpl(repo);
+    fail_unless(repoImpl->state_main == _HY_LOADED_CACHE);
+    fail_unless(repoImpl->state_filelists == _HY_LOADED_CACHE);
+    check_filelist(pool);
+    hy_repo_free(repo);
+    g_object_unref(sack);
+}
+END_TEST
+
+START_TEST(test_solv_snapshot)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    g_autofree char *repo_path = g_strconcat(test_globals.repo_dir, YUM_DIR_SUFFIX, NULL);
+    HyRepo repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_snapshot", repo_path);
+    g_autofree gchar *snapshot = g_build_filename(test_globals.tmpdir, "primary.solv", NULL);
+    fail_unless(dnf_sack_write_solv_snapshot(sack, repo, snapshot, NULL));
+    fail_unless(dnf_sack_count(sack) == 0);
+
+    FILE *fp = fopen(snapshot, "r");
+    fail_if(fp == NULL);
+    char magic[4];
+    fail_unless(fread(magic, sizeof(magic), 1, fp) == 1);
+    fail_unless(memcmp(magic, "SOLV", sizeof(magic)) == 0);
+    fclose(fp);
+
+    libdnf::repoGetImpl(repo)->metadataPaths[MD_TYPE_PRIMARY_SOLV] = snapshot;
+    fail_unless(dnf_sack_load_repo(sack, repo, 0, NULL));
+    fail_unless(libdnf::repoGetImpl(repo)->state_main == _HY_LOADED_FETCH);
+    fail_unless(dnf_sack_count(sack) == TEST_EXPECT_YUM_NSOLVABLES);
+    hy_repo_free(repo);
+    g_object_unref(sack);
+}
+END_TEST
+
+static DnfSack *
+sack_with_shared_cachedir(const char *cachedir, const char *shared_dir)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, cachedir);
+    dnf_sack_set_shared_cachedir(sack, shared_dir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    return sack;
+}
+
+START_TEST(test_shared_cachedir)
+{
+    g_autofree gchar *shared_dir = g_build_filename(test_globals.tmpdir, "shared", NULL);
+    g_autofree gchar *other_dir = g_build_filename(test_globals.tmpdir, "other", NULL);
+    fail_if(g_mkdir(shared_dir, 0755));
+    g_autofree char *repo_path = g_strconcat(test_globals.repo_dir, YUM_DIR_SUFFIX, NULL);
+
+    DnfSack *sack = sack_with_shared_cachedir(test_globals.tmpdir, shared_dir);
+    ck_assert_str_eq(dnf_sack_get_shared_cachedir(sack), shared_dir);
+    HyRepo repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_shared", repo_path);
+    fail_unless(dnf_sack_load_repo(sack, repo, DNF_SACK_LOAD_FLAG_BUILD_CACHE, NULL));
+    fail_unless(libdnf::repoGetImpl(repo)->state_main == _HY_WRITTEN);
+    char hex[2 * CHKSUM_BYTES + 1];
+    solv_bin2hex(libdnf::repoGetImpl(repo)->checksum, CHKSUM_BYTES, hex);
+    g_autofree gchar *shared_fn = g_strconcat(shared_dir, "/", hex, ".solv", NULL);
+    fail_if(access(shared_fn, R_OK));
+    hy_repo_free(repo);
+    g_object_unref(sack);
+
+    /* a process with another cache directory needs no primary */
+    sack = sack_with_shared_cachedir(other_dir, shared_dir);
+    repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_shared", repo_path);
+    libdnf::repoGetImpl(repo)->metadataPaths.erase(MD_TYPE_PRIMARY);
+    fail_unless(dnf_sack_load_repo(sack, repo, 0, NULL));
+    fail_unless(libdnf::repoGetImpl(repo)->state_main == _HY_LOADED_FETCH);
+    fail_unless(dnf_sack_count(sack) == TEST_EXPECT_YUM_NSOLVABLES);
+    hy_repo_free(repo);
+    g_object_unref(sack);
+
+    /* a shared cache anybody could have modified is not used */
+    fail_if(chmod(shared_fn, 0666));
+    sack = sack_with_shared_cachedir(other_dir, shared_dir);
+    repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_shared", repo_path);
+    libdnf::repoGetImpl(repo)->metadataPaths.erase(MD_TYPE_PRIMARY);
+    g_autoptr(GError) error = NULL;
+    fail_if(dnf_sack_load_repo(sack, repo, 0, &error));
+    hy_repo_free(repo);
+    g_object_unref(sack);
+
+    /* nor a symlink, even to a trusted file */
+    g_autofree gchar *target_fn = g_build_filename(shared_dir, "target.solv", NULL);
+    fail_if(rename(shared_fn, target_fn));
+    fail_if(chmod(target_fn, 0644));
+    fail_if(symlink(target_fn, shared_fn));
+    sack = sack_with_shared_cachedir(other_dir, shared_dir);
+    repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_shared", repo_path);
+    libdnf::repoGetImpl(repo)->metadataPaths.erase(MD_TYPE_PRIMARY);
+    g_clear_error(&error);
+    fail_if(dnf_sack_load_repo(sack, repo, 0, &error));
+    hy_repo_free(repo);
+    g_object_unref(sack);
+}
+END_TEST
+
+/* loads the yum repo with a repomd.xml of its own, returns the revision stored in the pool */
+static std::string
+load_unchanged_repo(const char *cachedir, const char *repomd, int state_main)
+{
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, cachedir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    g_autofree char *repo_path = g_strconcat(test_globals.repo_dir, YUM_DIR_SUFFIX, NULL);
+    HyRepo repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_unchanged", repo_path);
+    hy_repo_set_string(repo, HY_REPO_MD_FN, repomd);
+    fail_unless(dnf_sack_load_repo(sack, repo, DNF_SACK_LOAD_FLAG_BUILD_CACHE, NULL));
+    ck_assert_int_eq(libdnf::repoGetImpl(repo)->state_main, state_main);
+    fail_unless(dnf_sack_count(sack) == TEST_EXPECT_YUM_NSOLVABLES);
+    const char *revision = repo_lookup_str(libdnf::repoGetImpl(repo)->libsolvRepo, SOLVID_META,
+                                           REPOSITORY_REVISION);
+    std::string ret = revision ? revision : "";
+    hy_repo_free(repo);
+    g_object_unref(sack);
+    return ret;
+}
+
+START_TEST(test_primary_unchanged)
+{
+    g_autofree gchar *cachedir = g_build_filename(test_globals.tmpdir, "unchanged", NULL);
+    g_autofree gchar *repomd = g_build_filename(test_globals.tmpdir, "unchanged-repomd.xml", NULL);
+    g_autofree gchar *orig_repomd = g_build_filename(test_globals.repo_dir, YUM_DIR_SUFFIX,
+                                                     "repomd.xml", NULL);
+    ck_assert_str_eq(load_unchanged_repo(cachedir, orig_repomd, _HY_WRITTEN).c_str(), "1404109454");
+
+    // a new repomd.xml with the same primary
+    g_autofree gchar *content = NULL;
+    fail_unless(g_file_get_contents(orig_repomd, &content, NULL, NULL));
+    std::string changed = content;
+    const std::string revision = "<revision>1404109454</revision>";
+    auto pos = changed.find(revision);
+    fail_if(pos == std::string::npos);
+    changed.replace(pos, revision.size(), "<revision>unchanged-primary</revision>");
+    fail_unless(g_file_set_contents(repomd, changed.c_str(), -1, NULL));
+
+    // the solv file is rewritten from the old one with the data of the new repomd
+    ck_assert_str_eq(load_unchanged_repo(cachedir, repomd, _HY_WRITTEN).c_str(), "unchanged-primary");
+    ck_assert_str_eq(load_unchanged_repo(cachedir, repomd, _HY_LOADED_CACHE).c_str(),
+                     "unchanged-primary");
+}
+END_TEST
+
+#ifdef WITH_ZSTD
+START_TEST(test_compressed_cache)
+{
+    auto & compression = libdnf::getGlobalMainConfig(false).solv_cache_compression();
+    compression.set(libdnf::Option::Priority::RUNTIME, "zstd");
+    DnfSack *sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    g_autofree char *repo_path = g_strconcat(test_globals.repo_dir, YUM_DIR_SUFFIX, NULL);
+    HyRepo repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_zstd", repo_path);
+    fail_unless(dnf_sack_load_repo(sack, repo,
+                                   DNF_SACK_LOAD_FLAG_BUILD_CACHE |
+                                   DNF_SACK_LOAD_FLAG_USE_FILELISTS, NULL));
+    fail_unless(libdnf::repoGetImpl(repo)->state_filelists == _HY_WRITTEN);
+    check_filelist(dnf_sack_get_pool(sack));
+
+    char *filename = dnf_sack_give_cache_fn(sack, "test_sack_zstd", NULL);
+    FILE *fp = fopen(filename, "r");
+    fail_if(fp == NULL);
+    unsigned char magic[4];
+    fail_unless(fread(magic, sizeof(magic), 1, fp) == 1);
+    fail_unless(magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd);
+    fclose(fp);
+    g_free(filename);
+    hy_repo_free(repo);
+    g_object_unref(sack);
+
+    /* compressed caches are read whatever the option says */
+    compression.set(libdnf::Option::Priority::RUNTIME, "none");
+    sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    dnf_sack_set_arch(sack, TEST_FIXED_ARCH, NULL);
+    fail_unless(dnf_sack_setup(sack, DNF_SACK_SETUP_FLAG_MAKE_CACHE_DIR, NULL));
+    repo = glob_for_repofiles(dnf_sack_get_pool(sack), "test_sack_zstd", repo_path);
+    fail_unless(dnf_sack_load_repo(sack, repo, DNF_SACK_LOAD_FLAG_USE_FILELISTS, NULL));
+    fail_unless(libdnf::repoGetImpl(repo)->state_main == _HY_LOADED_CACHE);
+    fail_unless(libdnf::repoGetImpl(repo)->state_filelists == _HY_LOADED_CACHE);
+    check_filelist(dnf_sack_get_pool(sack));
+    hy_repo_free(repo);
+    g_object_unref(sack);
+}
+END_TEST
+#endif
+
+START_TEST(test_memory_stats)
+{
+    DnfSack *sack = test_globals.sack;
+    dnf_sack_make_provides_ready(sack);
+    g_autoptr(DnfSackMemoryStats) stats = dnf_sack_get_memory_stats(sack);
+
+    fail_unless(stats->string_space > 0);
+    fail_unless(stats->reldeps > 0);
+    fail_unless(stats->whatprovides > 0);
+    fail_unless(stats->solvables > 0);
+
+    const DnfSackRepoMemoryStats *yum = NULL;
+    guint64 sum = stats->string_space + stats->reldeps + stats->whatprovides +
+        stats->solvables + stats->maps + stats->indexes + stats->module_sack;
+    for (guint i = 0; i < stats->repos->len; ++i) {
+        auto repo = static_cast<const DnfSackRepoMemoryStats *>(g_ptr_array_index(stats->repos, i));
+        if (g_strcmp0(repo->name, YUM_REPO_NAME) == 0)
+            yum = repo;
+        sum += repo->main + repo->filelists + repo->other + repo->updateinfo + repo->presto;
+    }
+    fail_if(yum == NULL);
+    fail_unless(yum->main > 0);
+    fail_unless(yum->filelists > 0);
+    fail_unless(yum->updateinfo > 0);
+    fail_unless(yum->presto > 0);
+    ck_assert_int_eq(yum->other, 0);
+    fail_unless(dnf_sack_memory_stats_get_total(stats) == sum);
+}
+END_TEST
+
+struct ServerThread {
+    DnfSackServer *server;
+    GCancellable *cancellable;
+    gboolean ret;
+};
+
+static gpointer
+sack_server_thread(gpointer data)
+{
+    auto thread = static_cast<ServerThread *>(data);
+    thread->ret = dnf_sack_server_run(thread->server, thread->cancellable, NULL);
+    return NULL;
+}
+
+START_TEST(test_sack_server)
+{
+    g_autofree gchar *path = g_build_filename(test_globals.tmpdir, "sack.socket", NULL);
+    g_autoptr(GCancellable) cancellable = g_cancellable_new();
+    DnfSackServer *server = dnf_sack_server_new(test_globals.sack, path, NULL);
+    fail_if(server == NULL);
+    ServerThread server_thread = {server, cancellable, FALSE};
+    GThread *thread = g_thread_new("sack-server", sack_server_thread, &server_thread);
+
+    g_autoptr(GError) error = NULL;
+    DnfSackClient *client = dnf_sack_client_new(path, &error);
+    g_assert_no_error(error);
+
+    const gchar *filters[] = {"name=penny-lib", "repo=main", NULL};
+    g_autoptr(GPtrArray) packages = dnf_sack_client_query(client, filters, &error);
+    g_assert_no_error(error);
+    ck_assert_int_eq(packages->len, 2);
+    auto package = static_cast<DnfSackClientPackage *>(g_ptr_array_index(packages, 0));
+    ck_assert_str_eq(package->reponame, "main");
+    fail_unless(package->action == NULL);
+    fail_unless(g_str_has_prefix(package->nevra, "penny-lib-4-1."));
+
+    const gchar *jobs[] = {"upgrade fool", NULL};
+    g_autoptr(GPtrArray) transaction = dnf_sack_client_resolve(client, jobs, &error);
+    g_assert_no_error(error);
+    ck_assert_int_eq(transaction->len, 1);
+    package = static_cast<DnfSackClientPackage *>(g_ptr_array_index(transaction, 0));
+    ck_assert_str_eq(package->action, "upgrade");
+    ck_assert_str_eq(package->nevra, "fool-1-5.noarch");
+
+    const gchar *bad[] = {"color=red", NULL};
+    fail_if(dnf_sack_client_query(client, bad, &error));
+    fail_unless(g_error_matches(error, DNF_ERROR, DNF_ERROR_BAD_QUERY));
+
+    dnf_sack_client_free(client);
+    g_cancellable_cancel(cancellable);
+    g_thread_join(thread);
+    fail_unless(server_thread.ret);
+    dnf_sack_server_free(server);
+    fail_unless(access(path, F_OK) != 0);
+}
+END_TEST
+
+START_TEST(test_package_ids)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    libdnf::PackageSet all(sack);
+    for (Id id = 2; id < pool->nsolvables; ++id) {
+        if (pool_id2solvable(pool, id)->repo)
+            all.set(id);
+    }
+
+    g_autoptr(GHashTable) origins = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    g_autofree gchar **ids = dnf_sack_get_package_ids(sack, &all, origins);
+    ck_assert_int_eq(g_strv_length(ids), all.size());
+    guint i = 0;
+    for (Id id = all.next(-1); id != -1; id = all.next(id), ++i) {
+        g_autoptr(DnfPackage) pkg = dnf_package_new(sack, id);
+        ck_assert_str_eq(ids[i], dnf_package_get_package_id(pkg));
+
+        g_autoptr(DnfPackage) found = dnf_sack_get_package_by_package_id(sack, ids[i]);
+        fail_if(found == NULL);
+        ck_assert_int_eq(dnf_package_get_id(found), id);
+    }
+
+    // the origin of installed packages
+    g_autoptr(DnfPackage) installed = by_name_repo(sack, "penny-lib", HY_SYSTEM_REPO_NAME);
+    g_hash_table_insert(origins, g_strdup(dnf_package_get_nevra(installed)), (gpointer) "main");
+    libdnf::PackageSet one(sack);
+    one.set(installed);
+    g_autofree gchar **installed_ids = dnf_sack_get_package_ids(sack, &one, origins);
+    fail_unless(g_str_has_suffix(installed_ids[0], ";installed:main"));
+    g_autoptr(DnfPackage) found = dnf_sack_get_package_by_package_id(sack, installed_ids[0]);
+    ck_assert_int_eq(dnf_package_get_id(found), dnf_package_get_id(installed));
+
+    fail_unless(dnf_sack_get_package_by_package_id(sack, "penny-lib;1-1;noarch;nowhere") == NULL);
+}
+END_TEST
+
 Suite *
 sack_suite(void)
 {
@@ -297,6 +965,8 @@ sack_suite(void)
     tcase_add_test(tc, test_load_repo_err);
     tcase_add_test(tc, test_repo_written);
     tcase_add_test(tc, test_add_cmdline_package);
+    tcase_add_test(tc, test_add_cmdline_packages);
+    tcase_add_test(tc, test_reload_repos);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Repos");
@@ -310,10 +980,29 @@ sack_suite(void)
     tcase_add_test(tc, test_filelist_from_cache);
     tcase_add_test(tc, test_presto);
     tcase_add_test(tc, test_presto_from_cache);
+    tcase_add_test(tc, test_whatprovides_from_cache);
+    tcase_add_test(tc, test_whatprovides_huge_pages);
+    tcase_add_test(tc, test_whatprovides_cache_xml);
+    tcase_add_test(tc, test_unload_exts);
+    tcase_add_test(tc, test_lazy_filelists);
+    tcase_add_test(tc, test_background_cache);
+    tcase_add_test(tc, test_solv_snapshot);
+    tcase_add_test(tc, test_shared_cachedir);
+    tcase_add_test(tc, test_primary_unchanged);
+#ifdef WITH_ZSTD
+    tcase_add_test(tc, test_compressed_cache);
+#endif
+    tcase_add_test(tc, test_memory_stats);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("SackKnows");
     tcase_add_unchecked_fixture(tc, fixture_all, teardown);
+    tcase_add_test(tc, test_package_ids);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("Server");
+    tcase_add_unchecked_fixture(tc, fixture_all, teardown);
+    tcase_add_test(tc, test_sack_server);
     suite_add_tcase(s, tc);
 
     return s;
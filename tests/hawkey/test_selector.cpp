@@ -137,6 +137,28 @@ START_TEST(test_sltr_version)
 }
 END_TEST
 
+START_TEST(test_sltr_matching_cached)
+{
+    HySelector sltr = hy_selector_create(test_globals.sack);
+
+    fail_if(hy_selector_set(sltr, HY_PKG_NAME, HY_EQ, "penny"));
+    GPtrArray *plist = hy_selector_matches(sltr);
+    fail_unless(plist->len == 2);
+    g_ptr_array_unref(plist);
+
+    // the cached selection is dropped by changes of the selector
+    fail_if(hy_selector_set(sltr, HY_PKG_REPONAME, HY_EQ, "main"));
+    plist = hy_selector_matches(sltr);
+    fail_unless(plist->len == 1);
+    g_ptr_array_unref(plist);
+
+    plist = hy_selector_matches(sltr);
+    fail_unless(plist->len == 1);
+    g_ptr_array_unref(plist);
+    hy_selector_free(sltr);
+}
+END_TEST
+
 Suite *
 selector_suite(void)
 {
@@ -146,6 +168,7 @@ selector_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_all, teardown);
     tcase_add_test(tc, test_sltr_pkg);
     tcase_add_test(tc, test_sltr_matching);
+    tcase_add_test(tc, test_sltr_matching_cached);
     tcase_add_test(tc, test_sltr_provides);
     tcase_add_test(tc, test_sltr_provides_glob);
     tcase_add_test(tc, test_sltr_reponame);
@@ -29,6 +29,8 @@
 #include "libdnf/dnf-reldep.h"
 #include "libdnf/dnf-sack.h"
 #include "libdnf/hy-subject.h"
+#include "libdnf/sack/packageset.hpp"
+#include "libdnf/sack/query.hpp"
 #include "fixtures.h"
 #include "testshared.h"
 #include "test_suites.h"
@@ -153,6 +155,26 @@ START_TEST(na)
 }
 END_TEST
 
+START_TEST(nevra_fail)
+{
+    libdnf::Nevra nevra;
+    // the epoch has to be numeric and is the only place for ':'
+    ck_assert(!nevra.parse("four-of-fish-x8:3.6.9-11.fc100.x86_64", HY_FORM_NEVRA));
+    ck_assert(!nevra.parse("four-of-fish-:3.6.9-11.fc100.x86_64", HY_FORM_NEVRA));
+    ck_assert(!nevra.parse("four:of-fish-3.6.9-11.fc100.x86_64", HY_FORM_NEVRA));
+    // no part can be empty
+    ck_assert(!nevra.parse("four-of-fish-3.6.9-11.fc100.", HY_FORM_NEVRA));
+    ck_assert(!nevra.parse("-3.6.9-11.fc100.x86_64", HY_FORM_NEVRA));
+    ck_assert(!nevra.parse("four-of-fish-3.6.9-", HY_FORM_NEVR));
+    ck_assert(!nevra.parse("four-of-fish-8:", HY_FORM_NEV));
+    // the arch can't contain '-'
+    ck_assert(!nevra.parse("four-of-fish.x86-64", HY_FORM_NA));
+    ck_assert(!nevra.parse("four-of-fish 3.6.9", HY_FORM_NAME));
+    ck_assert(nevra.parse("four-of-fish-3.6.9", HY_FORM_NAME));
+    ck_assert_str_eq(nevra.getName().c_str(), "four-of-fish-3.6.9");
+}
+END_TEST
+
 START_TEST(module_form_nsvcap)
 {
     libdnf::Nsvcap nsvcap;
@@ -320,6 +342,35 @@ START_TEST(module_form_n)
 }
 END_TEST
 
+START_TEST(resolve_subjects)
+{
+    const std::vector<std::string> subjects{
+        "penny", "penny-lib", "penny.noarch", "penny-lib-4-1", "flying-3-0.noarch", "flying-0:3-0",
+        "fool-1-5.src", "tour-4-6.noarch", "pen*", "P-lib", "/usr/bin/ste", "lane", "walrus-2:2",
+        "penny-lib-4-*", "*lib*", "fl?ing-3*", "*-3-0.noarch", "walrus-2-*.noarch",
+        "p*-4-1.x86_64", "penny-lib-4-1.[xi]*", "nothing*",
+    };
+    libdnf::Query base(test_globals.sack);
+    base.addFilter(HY_PKG_ARCH, HY_NEQ, "src");
+    auto solutions = base.resolveSubjects(subjects, nullptr, false, true, true, true);
+    ck_assert_int_eq(solutions.size(), subjects.size());
+    ck_assert(solutions[0].matched);
+    for (std::size_t i = 0; i < subjects.size(); ++i) {
+        libdnf::Query query(base);
+        auto ret = query.filterSubject(subjects[i].c_str(), nullptr, false, true, true, true);
+        ck_assert(solutions[i].matched == ret.first);
+        ck_assert(!solutions[i].nevra == !ret.second);
+        if (ret.second)
+            ck_assert_int_eq(solutions[i].nevra->compare(*ret.second), 0);
+        libdnf::PackageSet expected(*query.runSet());
+        libdnf::PackageSet resolved(*solutions[i].query->runSet());
+        ck_assert_int_eq(resolved.size(), expected.size());
+        expected -= resolved;
+        ck_assert(expected.empty());
+    }
+}
+END_TEST
+
 Suite *
 subject_suite(void)
 {
@@ -331,6 +382,7 @@ subject_suite(void)
     tcase_add_test(tc, nevr_fail);
     tcase_add_test(tc, nev);
     tcase_add_test(tc, na);
+    tcase_add_test(tc, nevra_fail);
     tcase_add_test(tc, module_form_nsvcap);
     tcase_add_test(tc, module_form_nsvap);
     tcase_add_test(tc, module_form_nsvca);
@@ -351,6 +403,7 @@ subject_suite(void)
 
     tc = tcase_create("Full");
     tcase_add_unchecked_fixture(tc, fixture_all, teardown);
+    tcase_add_test(tc, resolve_subjects);
     suite_add_tcase(s, tc);
 
     return s;
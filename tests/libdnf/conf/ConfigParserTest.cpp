@@ -0,0 +1,110 @@
+#include "ConfigParserTest.hpp"
+
+#include "libdnf/conf/ConfigParser.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConfigParserTest);
+
+static const std::map<std::string, std::string> substitutions = {
+    {"arch", "x86_64"},
+    {"basearch", "x86_64"},
+    {"releasever", "33"},
+    {"loop", "$loop"},
+};
+
+static std::string substitute(std::string text)
+{
+    libdnf::ConfigParser::substitute(text, substitutions);
+    return text;
+}
+
+void ConfigParserTest::setUp()
+{}
+
+void ConfigParserTest::tearDown()
+{}
+
+void ConfigParserTest::testSubstitute()
+{
+    CPPUNIT_ASSERT_EQUAL(std::string("no variables"), substitute("no variables"));
+    CPPUNIT_ASSERT_EQUAL(std::string("http://example.com/33/x86_64/os/"),
+                         substitute("http://example.com/$releasever/${basearch}/os/"));
+    CPPUNIT_ASSERT_EQUAL(std::string("33x86_64"), substitute("${releasever}$arch"));
+    CPPUNIT_ASSERT_EQUAL(std::string("$unknown/${unknown}/33"),
+                         substitute("$unknown/${unknown}/$releasever"));
+    // substituted values are not substituted again
+    CPPUNIT_ASSERT_EQUAL(std::string("$loop-33"), substitute("$loop-$releasever"));
+}
+
+void ConfigParserTest::testSubstituteMalformed()
+{
+    CPPUNIT_ASSERT_EQUAL(std::string("price $"), substitute("price $"));
+    CPPUNIT_ASSERT_EQUAL(std::string("${"), substitute("${"));
+    CPPUNIT_ASSERT_EQUAL(std::string("${arch"), substitute("${arch"));
+    CPPUNIT_ASSERT_EQUAL(std::string("${arch-x86_64}"), substitute("${arch-$arch}"));
+    CPPUNIT_ASSERT_EQUAL(std::string("$$x86_64"), substitute("$$$arch"));
+}
+
+void ConfigParserTest::testTemplateRender()
+{
+    libdnf::ConfigParser::SubstitutionTemplate tmpl("/$releasever/$basearch/$releasever");
+    CPPUNIT_ASSERT(tmpl.hasVariables());
+    CPPUNIT_ASSERT_EQUAL(std::string("/33/x86_64/33"), tmpl.render(substitutions));
+    CPPUNIT_ASSERT_EQUAL(std::string("/34/$basearch/34"), tmpl.render({{"releasever", "34"}}));
+    CPPUNIT_ASSERT_EQUAL(std::string("/$releasever/$basearch/$releasever"), tmpl.render({}));
+}
+
+void ConfigParserTest::testReadWithoutRawItems()
+{
+    char path[] = "/tmp/libdnf-configparser-XXXXXX";
+    int fd = mkstemp(path);
+    CPPUNIT_ASSERT(fd >= 0);
+    close(fd);
+    {
+        std::ofstream ofs(path);
+        ofs << "# header\n[main]\n# comment\nkey = value\n  continued\n\nother=1\n";
+    }
+
+    libdnf::ConfigParser parser;
+    parser.read(path, false);
+    unlink(path);
+    CPPUNIT_ASSERT_EQUAL(std::string("value\ncontinued"), parser.getValue("main", "key"));
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), parser.getValue("main", "other"));
+    CPPUNIT_ASSERT(parser.getHeader().empty());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), parser.getData().find("main")->second.size());
+
+    std::ostringstream out;
+    parser.write(out);
+    CPPUNIT_ASSERT_EQUAL(std::string("[main]\nkey=value\n continued\nother=1\n"), out.str());
+}
+
+void ConfigParserTest::testManyOptions()
+{
+    // big sections are indexed, the order of the options must not change
+    libdnf::ConfigParser parser;
+    CPPUNIT_ASSERT(parser.addSection("main"));
+    for (int i = 0; i < 100; ++i)
+        parser.setValue("main", "key" + std::to_string(i), std::to_string(i));
+    CPPUNIT_ASSERT(parser.removeOption("main", "key10"));
+    CPPUNIT_ASSERT(!parser.removeOption("main", "key10"));
+    parser.setValue("main", "key5", "five");
+
+    CPPUNIT_ASSERT(!parser.hasOption("main", "key10"));
+    CPPUNIT_ASSERT_EQUAL(std::string("five"), parser.getValue("main", "key5"));
+    CPPUNIT_ASSERT_EQUAL(std::string("99"), parser.getValue("main", "key99"));
+    const auto & options = parser.getData().find("main")->second;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(99), options.size());
+    int expected = 0;
+    for (const auto & option : options) {
+        if (expected == 10)
+            ++expected;
+        CPPUNIT_ASSERT_EQUAL("key" + std::to_string(expected), option.first);
+        ++expected;
+    }
+}
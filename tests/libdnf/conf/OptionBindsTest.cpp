@@ -0,0 +1,51 @@
+#include "OptionBindsTest.hpp"
+
+#include "libdnf/conf/ConfigMain.hpp"
+#include "libdnf/conf/ConfigRepo.hpp"
+#include "libdnf/conf/OptionBinds.hpp"
+#include "libdnf/conf/OptionNumber.hpp"
+#include "libdnf/conf/OptionString.hpp"
+
+#include <string>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OptionBindsTest);
+
+void OptionBindsTest::setUp()
+{}
+
+void OptionBindsTest::tearDown()
+{}
+
+void OptionBindsTest::testLookup()
+{
+    libdnf::OptionString name("");
+    libdnf::OptionNumber<std::int32_t> cost(1000);
+    libdnf::OptionBinds binds;
+    binds.add("name", name);
+    binds.add("cost", cost);
+
+    CPPUNIT_ASSERT_THROW(binds.add("name", cost), libdnf::OptionBinds::AlreadyExists);
+    CPPUNIT_ASSERT_THROW(binds.at("nonexistent"), libdnf::OptionBinds::OutOfRange);
+    CPPUNIT_ASSERT(binds.find("co") == binds.end());
+    CPPUNIT_ASSERT(binds.find("costs") == binds.end());
+
+    binds.at("cost").newString(libdnf::Option::Priority::RUNTIME, "500");
+    CPPUNIT_ASSERT_EQUAL(500, cost.getValue());
+    CPPUNIT_ASSERT(&binds.find("name")->second.getOption() == &name);
+}
+
+void OptionBindsTest::testIterationOrder()
+{
+    libdnf::ConfigMain mainConfig;
+    libdnf::ConfigRepo config(mainConfig);
+    auto & binds = config.optBinds();
+    CPPUNIT_ASSERT(binds.find("baseurl") != binds.end());
+    CPPUNIT_ASSERT(binds.find("exclude") != binds.end());
+
+    std::string previous;
+    for (const auto & item : binds) {
+        CPPUNIT_ASSERT(previous < item.first);
+        previous = item.first;
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef LIBDNF_OPTIONBINDSTEST_HPP
+#define LIBDNF_OPTIONBINDSTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class OptionBindsTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(OptionBindsTest);
+        CPPUNIT_TEST(testLookup);
+        CPPUNIT_TEST(testIterationOrder);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testLookup();
+    void testIterationOrder();
+};
+
+#endif //LIBDNF_OPTIONBINDSTEST_HPP
@@ -188,6 +188,101 @@ dnf_lock_threads_func(void)
     g_object_unref(lock);
 }
 
+static void
+dnf_lock_shared_func(void)
+{
+    gboolean ret;
+    GError *error = NULL;
+    guint lock_id1;
+    guint lock_id2;
+    guint lock_id3;
+    g_autoptr(DnfLock) lock = NULL;
+
+    lock = dnf_lock_new();
+    dnf_lock_set_lock_dir(lock, "/tmp");
+
+    /* take shared twice */
+    lock_id1 = dnf_lock_take_full(lock,
+                                  DNF_LOCK_TYPE_METADATA,
+                                  DNF_LOCK_MODE_PROCESS,
+                                  DNF_LOCK_ACCESS_SHARED,
+                                  NULL,
+                                  &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(lock_id1, >, 0);
+    lock_id2 = dnf_lock_take_full(lock,
+                                  DNF_LOCK_TYPE_METADATA,
+                                  DNF_LOCK_MODE_PROCESS,
+                                  DNF_LOCK_ACCESS_SHARED,
+                                  NULL,
+                                  &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(lock_id2, ==, lock_id1);
+
+    /* exclusive is not possible while shared */
+    lock_id3 = dnf_lock_take(lock,
+                             DNF_LOCK_TYPE_METADATA,
+                             DNF_LOCK_MODE_PROCESS,
+                             &error);
+    g_assert_error(error, DNF_ERROR, DNF_ERROR_CANNOT_GET_LOCK);
+    g_assert_cmpint(lock_id3, ==, 0);
+    g_clear_error(&error);
+
+    /* different names do not block each other */
+    lock_id2 = dnf_lock_take_full(lock,
+                                  DNF_LOCK_TYPE_METADATA,
+                                  DNF_LOCK_MODE_PROCESS,
+                                  DNF_LOCK_ACCESS_EXCLUSIVE,
+                                  "fedora",
+                                  &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(lock_id2, >, 0);
+    lock_id3 = dnf_lock_take_full(lock,
+                                  DNF_LOCK_TYPE_METADATA,
+                                  DNF_LOCK_MODE_PROCESS,
+                                  DNF_LOCK_ACCESS_EXCLUSIVE,
+                                  "updates",
+                                  &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(lock_id3, >, 0);
+    g_assert_cmpint(lock_id3, !=, lock_id2);
+
+    /* a name with a slash is rejected */
+    g_assert_cmpint(dnf_lock_take_full(lock,
+                                       DNF_LOCK_TYPE_METADATA,
+                                       DNF_LOCK_MODE_PROCESS,
+                                       DNF_LOCK_ACCESS_EXCLUSIVE,
+                                       "../foo",
+                                       &error), ==, 0);
+    g_assert_error(error, DNF_ERROR, DNF_ERROR_INTERNAL_ERROR);
+    g_clear_error(&error);
+
+    ret = dnf_lock_release(lock, lock_id3, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    ret = dnf_lock_release(lock, lock_id2, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    ret = dnf_lock_release(lock, lock_id1, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    ret = dnf_lock_release(lock, lock_id1, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_assert_cmpint(dnf_lock_get_state(lock), ==, 0);
+
+    /* exclusive now works again */
+    lock_id3 = dnf_lock_take(lock,
+                             DNF_LOCK_TYPE_METADATA,
+                             DNF_LOCK_MODE_PROCESS,
+                             &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(lock_id3, >, 0);
+    ret = dnf_lock_release(lock, lock_id3, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+}
+
 static void
 ch_test_repo_func(void)
 {
@@ -808,6 +903,87 @@ dnf_state_small_step_func(void)
     g_object_unref(state);
 }
 
+static void
+dnf_state_rate_limit_func(void)
+{
+    DnfState *state;
+    DnfState *state_local;
+    gboolean ret;
+    GError *error = NULL;
+    guint i;
+
+    _updates = 0;
+    _last_percent = 0;
+
+    state = dnf_state_new();
+    g_signal_connect(state, "percentage-changed",
+            G_CALLBACK(dnf_state_test_percentage_changed_cb), NULL);
+    dnf_state_set_max_update_rate(state, 1);
+    dnf_state_set_number_steps(state, 1);
+
+    /* the child inherits the limit, only the first update and 100% get through */
+    state_local = dnf_state_get_child(state);
+    dnf_state_set_number_steps(state_local, 100);
+    for (i = 0; i < 100; i++) {
+        ret = dnf_state_done(state_local, &error);
+        g_assert_no_error(error);
+        g_assert(ret);
+    }
+    g_assert_cmpint(_updates, ==, 2);
+    g_assert_cmpint(_last_percent, ==, 100);
+    g_assert_cmpint(dnf_state_get_percentage(state), ==, 100);
+
+    g_object_unref(state);
+}
+
+static void
+dnf_state_trace_func(void)
+{
+    DnfState *state;
+    DnfState *state_local;
+    gboolean ret;
+    GError *error = NULL;
+    g_autofree gchar *filename = NULL;
+    g_autofree gchar *contents = NULL;
+    gint fd;
+
+    fd = g_file_open_tmp("dnf-state-trace-XXXXXX.json", &filename, &error);
+    g_assert_no_error(error);
+    close(fd);
+
+    state = dnf_state_new();
+    ret = dnf_state_set_trace_file(state, filename, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    dnf_state_set_number_steps(state, 2);
+    dnf_state_action_start(state, DNF_STATE_ACTION_DOWNLOAD_PACKAGES, "hello\"world");
+
+    state_local = dnf_state_get_child(state);
+    dnf_state_set_number_steps(state_local, 1);
+    ret = dnf_state_done(state_local, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    ret = dnf_state_done(state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    dnf_state_action_stop(state);
+    ret = dnf_state_done(state, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_object_unref(state);
+
+    /* the file is completed once the last state is gone */
+    ret = g_file_get_contents(filename, &contents, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_assert(g_str_has_prefix(contents, "["));
+    g_assert(g_str_has_suffix(contents, "]\n"));
+    g_assert(strstr(contents, "\"cat\":\"step\",\"ph\":\"X\"") != NULL);
+    g_assert(strstr(contents, "\"name\":\"download-packages\"") != NULL);
+    g_assert(strstr(contents, "\"hint\":\"hello\\\"world\"") != NULL);
+    g_unlink(filename);
+}
+
 static void
 dnf_repo_loader_func(void)
 {
@@ -882,6 +1058,45 @@ dnf_repo_loader_func(void)
     g_clear_error(&error);
 }
 
+static void
+dnf_repo_loader_lazy_func(void)
+{
+    GError *error = NULL;
+    DnfRepo *repo;
+    gboolean ret;
+    g_autofree gchar *repos_dir = NULL;
+    g_autoptr(DnfContext) ctx = NULL;
+    g_autoptr(DnfRepoLoader) repo_loader = NULL;
+
+    /* set up local context */
+    ctx = dnf_context_new();
+    repos_dir = dnf_test_get_filename("yum.repos.d");
+    dnf_context_set_repo_dir(ctx, repos_dir);
+    dnf_context_set_solv_dir(ctx, "/tmp");
+    dnf_context_set_lazy_repo_setup(ctx, TRUE);
+    ret = dnf_context_setup(ctx, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+
+    /* enabled repos are set up straight away */
+    repo_loader = dnf_repo_loader_new(ctx);
+    repo = dnf_repo_loader_get_repo_by_id(repo_loader, "local", &error);
+    g_assert_no_error(error);
+    g_assert(repo != NULL);
+    g_assert_cmpint(dnf_repo_get_kind(repo), ==, DNF_REPO_KIND_LOCAL);
+
+    /* disabled ones only have their configuration loaded... */
+    repo = dnf_repo_loader_get_repo_by_id(repo_loader, "bumblebee-source", &error);
+    g_assert_no_error(error);
+    g_assert(repo != NULL);
+    g_assert_cmpint(dnf_repo_get_enabled(repo), ==, DNF_REPO_ENABLED_NONE);
+    g_assert(dnf_repo_get_gpgcheck(repo));
+
+    /* ...until they are used */
+    g_assert(dnf_repo_get_location(repo) != NULL);
+    g_assert(g_str_has_suffix(dnf_repo_get_packages(repo), "/packages"));
+}
+
 static void
 dnf_context_func(void)
 {
@@ -1204,6 +1419,13 @@ dnf_context_cache_clean_check_func(void)
     g_assert(!g_file_test(expire_cache_file, G_FILE_TEST_EXISTS));
     g_assert(g_file_test(non_matching_file, G_FILE_TEST_EXISTS));
 
+    /* the files moved aside were deleted too */
+    g_autoptr(GDir) dir = g_dir_open(cache_dir, 0, &error);
+    g_assert_no_error(error);
+    const gchar *filename;
+    while ((filename = g_dir_read_name(dir)))
+        g_assert(!g_str_has_prefix(filename, ".clean-"));
+
     /* At this stage we clean up the files that we created for testing */
     dnf_remove_recursive(cache_dir, &error);
     g_assert_no_error(error);
@@ -1233,12 +1455,14 @@ main(int argc, char **argv)
     g_test_add_func("/libdnf/repo_loader{gpg-wrong-asc}", dnf_repo_loader_gpg_wrong_asc_func);
     g_test_add_func("/libdnf/repo_loader{gpg-no-asc}", dnf_repo_loader_gpg_no_asc_func);
     g_test_add_func("/libdnf/repo_loader", dnf_repo_loader_func);
+    g_test_add_func("/libdnf/repo_loader[lazy]", dnf_repo_loader_lazy_func);
     g_test_add_func("/libdnf/repo_loader{gpg-no-pubkey}", dnf_repo_loader_gpg_no_pubkey_func);
     g_test_add_func("/libdnf/repo_loader{cache-dir-check}", dnf_repo_loader_cache_dir_check_func);
     g_test_add_func("/libdnf/context", dnf_context_func);
     g_test_add_func("/libdnf/context{cache-clean-check}", dnf_context_cache_clean_check_func);
     g_test_add_func("/libdnf/lock", dnf_lock_func);
     g_test_add_func("/libdnf/lock[threads]", dnf_lock_threads_func);
+    g_test_add_func("/libdnf/lock[shared]", dnf_lock_shared_func);
     g_test_add_func("/libdnf/repo", ch_test_repo_func);
     g_test_add_func("/libdnf/repo_empty_keyfile", dnf_repo_setup_with_empty_keyfile);
     g_test_add_func("/libdnf/state", dnf_state_func);
@@ -1251,6 +1475,8 @@ main(int argc, char **argv)
     g_test_add_func("/libdnf/state[locking]", dnf_state_locking_func);
     g_test_add_func("/libdnf/state[finished]", dnf_state_finished_func);
     g_test_add_func("/libdnf/state[small-step]", dnf_state_small_step_func);
+    g_test_add_func("/libdnf/state[rate-limit]", dnf_state_rate_limit_func);
+    g_test_add_func("/libdnf/state[trace]", dnf_state_trace_func);
 
     return g_test_run();
 }
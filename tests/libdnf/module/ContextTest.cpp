@@ -9,8 +9,18 @@ CPPUNIT_TEST_SUITE_REGISTRATION(ContextTest);
 #include "libdnf/utils/File.hpp"
 #include "libdnf/sack/packageset.hpp"
 #include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/repo/Repo-private.hpp"
+#include "libdnf/utils/utils.hpp"
 
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
 #include <memory>
+#include <thread>
 
 
 void ContextTest::setUp()
@@ -187,6 +197,159 @@ void ContextTest::testLoadModules()
     g_assert_no_error(error);
 }
 
+void ContextTest::testRefreshSack()
+{
+    GError *error = nullptr;
+
+    dnf_context_set_release_ver(context, "26");
+    dnf_context_set_arch(context, "x86_64");
+    dnf_context_set_install_root(context, TESTDATADIR "/modules/");
+    dnf_context_set_repo_dir(context, TESTDATADIR "/modules/yum.repos.d/");
+    dnf_context_set_solv_dir(context, "/tmp");
+    g_assert(dnf_context_setup(context, nullptr, &error));
+    g_assert_no_error(error);
+    DnfRepo *repo = dnf_repo_loader_get_repo_by_id(dnf_context_get_repo_loader(context), "test", &error);
+    g_assert_no_error(error);
+    DnfState *state = dnf_state_new();
+    dnf_repo_check(repo, G_MAXUINT, state, &error);
+    g_object_unref(state);
+    g_clear_pointer(&error, g_error_free);
+    dnf_context_set_platform_module(context, "platform:26");
+
+    state = dnf_context_get_state(context);
+    g_assert(dnf_context_setup_sack(context, state, &error));
+    g_assert_no_error(error);
+    auto sack = dnf_context_get_sack(context);
+    Pool *pool = dnf_sack_get_pool(sack);
+    const int nsolvables = pool->nsolvables;
+    const size_t npackages = libdnf::Query(sack).size();
+
+    // nothing changed on disk
+    dnf_state_reset(state);
+    g_assert(dnf_context_refresh_sack(context, state, DNF_CONTEXT_SETUP_SACK_FLAG_NONE, &error));
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT_EQUAL(nsolvables, pool->nsolvables);
+
+    // as if dnf_repo_update() fetched a new repomd
+    memset(libdnf::repoGetImpl(dnf_repo_get_repo(repo))->checksum, 0, CHKSUM_BYTES);
+    dnf_state_reset(state);
+    g_assert(dnf_context_refresh_sack(context, state, DNF_CONTEXT_SETUP_SACK_FLAG_NONE, &error));
+    g_assert_no_error(error);
+    CPPUNIT_ASSERT(dnf_context_get_sack(context) == sack);
+    CPPUNIT_ASSERT(pool->nsolvables > nsolvables);
+    CPPUNIT_ASSERT_EQUAL(npackages, libdnf::Query(sack).size());
+
+    libdnf::Query grub{sack};
+    grub.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, "grub2-2.02-0.40.x86_64");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), grub.size());
+    auto package = dnf_package_new(sack, grub.runSet()->operator[](0));
+    CPPUNIT_ASSERT_EQUAL(std::string("test"), std::string(dnf_package_get_reponame(package)));
+    g_object_unref(package);
+
+    // modular filtering is recomputed for the reloaded packages
+    libdnf::Query httpd{sack};
+    httpd.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, "httpd-2.2.10-1.x86_64");
+    CPPUNIT_ASSERT(httpd.empty());
+}
+
+static ino_t file_inode(const std::string & path)
+{
+    struct stat st;
+    CPPUNIT_ASSERT_EQUAL(0, stat(path.c_str(), &st));
+    return st.st_ino;
+}
+
+void ContextTest::testPackageStore()
+{
+    GError *error = nullptr;
+    constexpr auto rpm = TESTDATADIR "/modules/modules/_all/x86_64/basesystem-11-3.noarch.rpm";
+    constexpr auto sha256 = "1a4e031f649c3ccd62fffab313102c6bc9eb7e71020fc36bdf0752a9bb587c73";
+
+    dnf_context_set_release_ver(context, "26");
+    dnf_context_set_arch(context, "x86_64");
+    dnf_context_set_install_root(context, TESTDATADIR "/modules/");
+    dnf_context_set_repo_dir(context, TESTDATADIR "/modules/yum.repos.d/");
+    dnf_context_set_solv_dir(context, "/tmp");
+    g_assert(dnf_context_setup(context, nullptr, &error));
+    g_assert_no_error(error);
+    DnfRepo *repo = dnf_repo_loader_get_repo_by_id(dnf_context_get_repo_loader(context), "test", &error);
+    g_assert_no_error(error);
+    DnfState *state = dnf_state_new();
+    dnf_repo_check(repo, G_MAXUINT, state, &error);
+    g_object_unref(state);
+    g_clear_pointer(&error, g_error_free);
+    dnf_context_set_platform_module(context, "platform:26");
+    state = dnf_context_get_state(context);
+    g_assert(dnf_context_setup_sack(context, state, &error));
+    g_assert_no_error(error);
+
+    libdnf::Query query{dnf_context_get_sack(context)};
+    query.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, "basesystem-11-3.noarch");
+    query.addFilter(HY_PKG_REPONAME, HY_EQ, "test");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), query.size());
+    g_autoptr(GPtrArray) pkgs = g_ptr_array_new_with_free_func(g_object_unref);
+    g_ptr_array_add(pkgs, dnf_package_new(dnf_context_get_sack(context), query.runSet()->operator[](0)));
+
+    g_autofree gchar *tmpdir = g_dir_make_tmp("libdnf-test-store-XXXXXX", nullptr);
+    CPPUNIT_ASSERT(tmpdir != nullptr);
+    const std::string storeDir = std::string(tmpdir) + "/store";
+    const std::string storePath = storeDir + "/sha256/" + sha256;
+    auto & storeOption = libdnf::getGlobalMainConfig().package_store_dir();
+    storeOption.set(libdnf::Option::Priority::RUNTIME, storeDir);
+
+    auto download = [&](const char * name) {
+        const std::string dir = std::string(tmpdir) + "/" + name;
+        CPPUNIT_ASSERT_EQUAL(0, g_mkdir_with_parents(dir.c_str(), 0755));
+        DnfState *downloadState = dnf_state_new();
+        g_assert(dnf_repo_download_packages(repo, pkgs, dir.c_str(), downloadState, &error));
+        g_assert_no_error(error);
+        g_object_unref(downloadState);
+        const std::string path = dir + "/basesystem-11-3.noarch.rpm";
+        CPPUNIT_ASSERT(libdnf::filesystem::checksum_check("sha256", path.c_str(), sha256));
+        return path;
+    };
+
+    // miss, the download takes the lock and adds the package to the store
+    auto path = download("owned");
+    CPPUNIT_ASSERT(libdnf::filesystem::checksum_check("sha256", storePath.c_str(), sha256));
+    CPPUNIT_ASSERT_EQUAL(file_inode(storePath), file_inode(path));
+
+    // hit, the package is linked from the store
+    path = download("hit");
+    CPPUNIT_ASSERT_EQUAL(file_inode(storePath), file_inode(path));
+
+    // a store copy not matching the checksum is downloaded again and replaced
+    CPPUNIT_ASSERT_EQUAL(0, unlink(storePath.c_str()));
+    g_assert(g_file_set_contents(storePath.c_str(), "corrupt", -1, &error));
+    g_assert_no_error(error);
+    path = download("mismatch");
+    CPPUNIT_ASSERT(libdnf::filesystem::checksum_check("sha256", storePath.c_str(), sha256));
+    CPPUNIT_ASSERT_EQUAL(file_inode(storePath), file_inode(path));
+
+    // busy, another process holds the lock and adds the package meanwhile
+    CPPUNIT_ASSERT_EQUAL(0, unlink(storePath.c_str()));
+    const std::string lockPath = storePath + ".lock";
+    int lockFd = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    CPPUNIT_ASSERT(lockFd >= 0);
+    CPPUNIT_ASSERT_EQUAL(0, flock(lockFd, LOCK_EX));
+    std::thread other([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        gchar *contents;
+        gsize length;
+        g_assert(g_file_get_contents(rpm, &contents, &length, nullptr));
+        g_assert(g_file_set_contents(storePath.c_str(), contents, length, nullptr));
+        g_free(contents);
+        close(lockFd);
+    });
+    path = download("busy");
+    other.join();
+    CPPUNIT_ASSERT_EQUAL(file_inode(storePath), file_inode(path));
+
+    storeOption.set(libdnf::Option::Priority::RUNTIME, "");
+    g_assert(dnf_remove_recursive(tmpdir, &error));
+    g_assert_no_error(error);
+}
+
 void ContextTest::sackHas(DnfSack * sack, libdnf::ModulePackage * pkg) const
 {
     libdnf::Query query{sack};
@@ -10,6 +10,8 @@ class ContextTest : public CppUnit::TestCase
 {
     CPPUNIT_TEST_SUITE(ContextTest);
         CPPUNIT_TEST(testLoadModules);
+        CPPUNIT_TEST(testRefreshSack);
+        CPPUNIT_TEST(testPackageStore);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -17,6 +19,8 @@ public:
     void tearDown() override;
 
     void testLoadModules();
+    void testRefreshSack();
+    void testPackageStore();
 
 private:
     DnfContext *context;
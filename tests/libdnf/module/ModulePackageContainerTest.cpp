@@ -156,3 +156,39 @@ void ModulePackageContainerTest::testInstallRemoveProfile()
 
     modules->save();
 }
+
+void ModulePackageContainerTest::testQuery()
+{
+    auto exact = modules->query("httpd", "2.4", "", "", "");
+    CPPUNIT_ASSERT(!exact.empty());
+    for (const auto & pkg : exact) {
+        CPPUNIT_ASSERT_EQUAL(std::string("httpd"), pkg->getName());
+        CPPUNIT_ASSERT_EQUAL(std::string("2.4"), pkg->getStream());
+    }
+
+    // exact and glob lookups have to agree
+    CPPUNIT_ASSERT(modules->query("httpd", "", "", "", "") == modules->query("http?", "*", "", "", ""));
+    CPPUNIT_ASSERT(exact == modules->query("h*d", "2.4", "", "", ""));
+
+    auto pkg = exact.front();
+    auto byAttributes = modules->query("httpd", "2.4", pkg->getVersion(), pkg->getContext(), pkg->getArch());
+    CPPUNIT_ASSERT(std::find(byAttributes.begin(), byAttributes.end(), pkg) != byAttributes.end());
+
+    CPPUNIT_ASSERT(modules->query("nonexistent", "", "", "", "").empty());
+    CPPUNIT_ASSERT(modules->query("httpd", "nonexistent", "", "", "").empty());
+}
+
+void ModulePackageContainerTest::testIsStreamActive()
+{
+    modules->resolveActiveModulePackages(false);
+    for (auto pkg : modules->query("httpd", "", "", "", "")) {
+        bool expected = false;
+        for (auto match : modules->query(pkg->getName(), pkg->getStream(), "", pkg->getContext(), "")) {
+            expected = expected || modules->isModuleActive(match);
+        }
+        // the second call is answered from the cache
+        CPPUNIT_ASSERT_EQUAL(expected, modules->isModuleActive(pkg->getName(), pkg->getStream(), pkg->getContext()));
+        CPPUNIT_ASSERT_EQUAL(expected, modules->isModuleActive(pkg->getName(), pkg->getStream(), pkg->getContext()));
+    }
+    CPPUNIT_ASSERT(!modules->isModuleActive("nonexistent", "", ""));
+}
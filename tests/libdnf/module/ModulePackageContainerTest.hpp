@@ -14,6 +14,8 @@ class ModulePackageContainerTest : public CppUnit::TestCase
         CPPUNIT_TEST(testDisableEnableModules);
         CPPUNIT_TEST(testRollback);
         CPPUNIT_TEST(testInstallRemoveProfile);
+        CPPUNIT_TEST(testQuery);
+        CPPUNIT_TEST(testIsStreamActive);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -24,6 +26,8 @@ public:
     void testDisableEnableModules();
     void testRollback();
     void testInstallRemoveProfile();
+    void testQuery();
+    void testIsStreamActive();
 
 private:
     DnfContext *context;
@@ -0,0 +1,137 @@
+#include "NsvcapTest.hpp"
+
+#include "libdnf/utils/utils.hpp"
+#include "libdnf/utils/regex/regex.hpp"
+
+#include <string>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NsvcapTest);
+
+// The patterns Nsvcap::parse() used before it got its own scanner, kept as the reference
+#define GLOB "][*?!"
+#define MODULE_NAME "([" GLOB ASCII_LETTERS DIGITS "+._-" "]+)"
+#define MODULE_VERSION "([" GLOB DIGITS "-]+)"
+#define MODULE_PROFILE_SUFFIX "\\/" MODULE_NAME "$"
+#define MODULE_NO_PROFILE_SUFFIX "\\/?" "()" "$"
+#define MODULE_FORM_PROFILES(prefix) \
+    Regex("^" prefix MODULE_PROFILE_SUFFIX, REG_EXTENDED), \
+    Regex("^" prefix MODULE_NO_PROFILE_SUFFIX, REG_EXTENDED)
+
+static const Regex REFERENCE_REGEX[]{
+    MODULE_FORM_PROFILES(MODULE_NAME ":" MODULE_NAME ":" MODULE_VERSION ":" MODULE_NAME "::?" MODULE_NAME),
+    MODULE_FORM_PROFILES(MODULE_NAME ":" MODULE_NAME ":" MODULE_VERSION "()" "::" MODULE_NAME),
+    MODULE_FORM_PROFILES(MODULE_NAME ":" MODULE_NAME "()" "()" "::" MODULE_NAME),
+    MODULE_FORM_PROFILES(MODULE_NAME ":" MODULE_NAME ":" MODULE_VERSION ":" MODULE_NAME "()"),
+    MODULE_FORM_PROFILES(MODULE_NAME ":" MODULE_NAME ":" MODULE_VERSION "()" "()"),
+    MODULE_FORM_PROFILES(MODULE_NAME ":" MODULE_NAME "()" "()" "()"),
+    MODULE_FORM_PROFILES(MODULE_NAME "()" "()" "()" "::" MODULE_NAME),
+    MODULE_FORM_PROFILES(MODULE_NAME "()" "()" "()" "()")
+};
+
+// REFERENCE_REGEX is ordered by the parts, HyModuleForm lists the profile forms of NSVC and NSV
+// before the forms without profile
+static const Regex &
+referenceRegex(int form)
+{
+    static const int INDEX[]{0, 1, 2, 3, 4, 5, 6, 8, 7, 9, 10, 11, 12, 13, 14, 15};
+    return REFERENCE_REGEX[INDEX[form - 1]];
+}
+
+static bool
+referenceParse(const char * spec, int form, libdnf::Nsvcap & nsvcap)
+{
+    auto result = referenceRegex(form).match(spec, false, 7);
+    if (!result.isMatched() || result.getMatchedLen(1) == 0)
+        return false;
+    nsvcap.setName(result.getMatchedString(1));
+    nsvcap.setStream(result.getMatchedString(2));
+    nsvcap.setVersion(result.getMatchedString(3));
+    nsvcap.setContext(result.getMatchedString(4));
+    nsvcap.setArch(result.getMatchedString(5));
+    nsvcap.setProfile(result.getMatchedString(6));
+    return true;
+}
+
+static std::vector<std::string>
+testSpecs()
+{
+    std::vector<std::string> specs{
+        "", ":", "/", "::", "perl", "perl/", "perl//", "perl:", ":5.26",
+        "perl:5.26", "perl:5.26/", "perl:5.26/default", "perl:5.26/default/x",
+        "perl::x86_64", "perl:::x86_64", "perl::x86_64/default", "perl:5.26::x86_64",
+        "perl:5.26:820181219174508", "perl:5.26:8201-8121:9edba152", "perl:5.26:v1:9edba152",
+        "perl:5.26:820181219174508:9edba152:x86_64", "perl:5.26:820181219174508:9edba152::x86_64",
+        "perl:5.26:820181219174508:9edba152:::x86_64", "perl:5.26:820181219174508::x86_64/default",
+        "perl:5.26:820181219174508:9edba152:x86_64/", "module-name:stream:1:muj-cont_ext.5",
+        "perl*:5.2[0-9]:*:?/mini!mal", "perl 5", "perl:5.26:1:c:x86_64:extra",
+    };
+    // all combinations of a few parts and delimiters
+    const char * parts[]{"", "n", "1", "a-b"};
+    const char * delims[]{"", ":", "::", "/"};
+    std::vector<std::string> prefixes{""};
+    for (int depth = 0; depth < 2; ++depth) {
+        std::vector<std::string> longer;
+        for (const auto & prefix : prefixes) {
+            for (auto part : parts) {
+                for (auto delim : delims) {
+                    longer.push_back(prefix + part + delim);
+                }
+            }
+        }
+        specs.insert(specs.end(), longer.begin(), longer.end());
+        prefixes.swap(longer);
+    }
+    return specs;
+}
+
+void NsvcapTest::setUp()
+{}
+
+void NsvcapTest::tearDown()
+{}
+
+void NsvcapTest::testParse()
+{
+    libdnf::Nsvcap nsvcap;
+    CPPUNIT_ASSERT(nsvcap.parse("perl:5.26:820181219174508:9edba152::x86_64/default",
+                                HY_MODULE_FORM_NSVCAP));
+    CPPUNIT_ASSERT_EQUAL(std::string("perl"), nsvcap.getName());
+    CPPUNIT_ASSERT_EQUAL(std::string("5.26"), nsvcap.getStream());
+    CPPUNIT_ASSERT_EQUAL(std::string("820181219174508"), nsvcap.getVersion());
+    CPPUNIT_ASSERT_EQUAL(std::string("9edba152"), nsvcap.getContext());
+    CPPUNIT_ASSERT_EQUAL(std::string("x86_64"), nsvcap.getArch());
+    CPPUNIT_ASSERT_EQUAL(std::string("default"), nsvcap.getProfile());
+
+    CPPUNIT_ASSERT(nsvcap.parse("perl::x86_64/", HY_MODULE_FORM_NA));
+    CPPUNIT_ASSERT_EQUAL(std::string("perl"), nsvcap.getName());
+    CPPUNIT_ASSERT(nsvcap.getStream().empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("x86_64"), nsvcap.getArch());
+    CPPUNIT_ASSERT(nsvcap.getProfile().empty());
+
+    // the arch has to follow "::" when there is no context
+    CPPUNIT_ASSERT(!nsvcap.parse("perl:5.26:x86_64", HY_MODULE_FORM_NSA));
+    CPPUNIT_ASSERT(!nsvcap.parse("perl:5.26:v1", HY_MODULE_FORM_NSV));
+    CPPUNIT_ASSERT(!nsvcap.parse("perl:5.26/", HY_MODULE_FORM_NSP));
+}
+
+void NsvcapTest::testParseMatchesRegex()
+{
+    for (const auto & spec : testSpecs()) {
+        for (int form = HY_MODULE_FORM_NSVCAP; form <= HY_MODULE_FORM_N; ++form) {
+            libdnf::Nsvcap expected;
+            libdnf::Nsvcap parsed;
+            bool expectedMatch = referenceParse(spec.c_str(), form, expected);
+            bool match = parsed.parse(spec.c_str(), static_cast<HyModuleForm>(form));
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expectedMatch, match);
+            if (!match)
+                continue;
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expected.getName(), parsed.getName());
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expected.getStream(), parsed.getStream());
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expected.getVersion(), parsed.getVersion());
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expected.getContext(), parsed.getContext());
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expected.getArch(), parsed.getArch());
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(spec, expected.getProfile(), parsed.getProfile());
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef LIBDNF_NSVCAPTEST_HPP
+#define LIBDNF_NSVCAPTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libdnf/nsvcap.hpp"
+
+class NsvcapTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(NsvcapTest);
+        CPPUNIT_TEST(testParse);
+        CPPUNIT_TEST(testParseMatchesRegex);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testParse();
+    void testParseMatchesRegex();
+};
+
+#endif //LIBDNF_NSVCAPTEST_HPP
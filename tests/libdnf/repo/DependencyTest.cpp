@@ -1,5 +1,6 @@
 #include <solv/pool.h>
 #include <memory>
+#include <stdexcept>
 #include <solv/repo.h>
 #include <solv/poolarch.h>
 
@@ -38,6 +39,22 @@ void DependencyTest::testParse()
     CPPUNIT_ASSERT(strcmp("", dependency->getVersion()) == 0);
 }
 
+void DependencyTest::testParseOperators()
+{
+    libdnf::Dependency lessEqual(sack, "foo <= 2.0");
+    CPPUNIT_ASSERT(strcmp("foo <= 2.0", lessEqual.toString()) == 0);
+
+    libdnf::Dependency greater(sack, "foo >2.0");
+    CPPUNIT_ASSERT(strcmp("foo > 2.0", greater.toString()) == 0);
 
+    // a name with a space and no operator is kept whole
+    libdnf::Dependency file(sack, "/hello world.jpg");
+    CPPUNIT_ASSERT(strcmp("/hello world.jpg", file.getName()) == 0);
 
+    // the same string parses into the same reldep
+    libdnf::Dependency again(sack, "foo <= 2.0");
+    CPPUNIT_ASSERT_EQUAL(lessEqual.getId(), again.getId());
 
+    CPPUNIT_ASSERT_THROW(libdnf::Dependency(sack, "foo >="), std::runtime_error);
+    CPPUNIT_ASSERT_THROW(libdnf::Dependency(sack, "foo >= 1 2"), std::runtime_error);
+}
@@ -13,6 +13,7 @@ class DependencyTest : public CppUnit::TestCase
         CPPUNIT_TEST(testName);
         CPPUNIT_TEST(testVersion);
         CPPUNIT_TEST(testParse);
+        CPPUNIT_TEST(testParseOperators);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -22,6 +23,7 @@ public:
     void testName();
     void testVersion();
     void testParse();
+    void testParseOperators();
 
 private:
     std::unique_ptr<libdnf::Dependency> dependency;
@@ -0,0 +1,179 @@
+#include "RepoCacheStateTest.hpp"
+
+#include "libdnf/dnf-utils.h"
+#include "libdnf/repo/Repo-private.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <algorithm>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RepoCacheStateTest);
+
+static std::vector<std::string> mirrorList(char ** mirrors)
+{
+    std::vector<std::string> list;
+    for (auto item = mirrors; item && *item; ++item)
+        list.emplace_back(*item);
+    return list;
+}
+
+static std::string readFile(const std::string & path)
+{
+    gchar * content;
+    gsize length;
+    CPPUNIT_ASSERT(g_file_get_contents(path.c_str(), &content, &length, nullptr));
+    std::string result(content, length);
+    g_free(content);
+    return result;
+}
+
+static void writeFile(const std::string & path, const std::string & content)
+{
+    CPPUNIT_ASSERT(g_file_set_contents(path.c_str(), content.data(), content.size(), nullptr));
+}
+
+static void setMtime(const std::string & path, const struct timespec & mtime)
+{
+    struct timespec times[2];
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1] = mtime;
+    CPPUNIT_ASSERT_EQUAL(0, utimensat(AT_FDCWD, path.c_str(), times, 0));
+}
+
+void RepoCacheStateTest::setUp()
+{
+    gchar * dir = g_dir_make_tmp("libdnf-test-repostate-XXXXXX", nullptr);
+    CPPUNIT_ASSERT(dir != nullptr);
+    tmpdir = dir;
+    g_free(dir);
+
+    repo = createRepo();
+    // the cachedir holds a copy of a local repo as if it was downloaded
+    constexpr auto source = TESTDATADIR "/modules/modules/_all/x86_64/repodata";
+    auto repodata = libdnf::repoGetImpl(repo.get())->getCachedir() + "/repodata";
+    CPPUNIT_ASSERT_EQUAL(0, g_mkdir_with_parents(repodata.c_str(), 0755));
+    GDir * sourceDir = g_dir_open(source, 0, nullptr);
+    CPPUNIT_ASSERT(sourceDir != nullptr);
+    while (auto name = g_dir_read_name(sourceDir))
+        writeFile(repodata + "/" + name, readFile(std::string(source) + "/" + name));
+    g_dir_close(sourceDir);
+
+    // writes the state
+    CPPUNIT_ASSERT(libdnf::repoGetImpl(repo.get())->loadCache(true));
+    CPPUNIT_ASSERT(g_file_test(statePath().c_str(), G_FILE_TEST_EXISTS));
+}
+
+void RepoCacheStateTest::tearDown()
+{
+    repo.reset();
+    dnf_remove_recursive(tmpdir.c_str(), nullptr);
+}
+
+std::unique_ptr<libdnf::Repo> RepoCacheStateTest::createRepo()
+{
+    std::unique_ptr<libdnf::ConfigRepo> conf(new libdnf::ConfigRepo(mainConfig));
+    conf->basecachedir().set(libdnf::Option::Priority::RUNTIME, tmpdir);
+    return std::unique_ptr<libdnf::Repo>(new libdnf::Repo("cachestate", std::move(conf)));
+}
+
+std::string RepoCacheStateTest::statePath() const
+{
+    return libdnf::repoGetImpl(repo.get())->getCachedir() + "/repodata/repostate.bin";
+}
+
+void RepoCacheStateTest::testRoundTrip()
+{
+    auto written = libdnf::repoGetImpl(repo.get());
+    auto other = createRepo();
+    auto loaded = libdnf::repoGetImpl(other.get());
+    CPPUNIT_ASSERT(loaded->loadCacheState());
+
+    CPPUNIT_ASSERT_EQUAL(written->repomdFn, loaded->repomdFn);
+    CPPUNIT_ASSERT(written->metadataPaths == loaded->metadataPaths);
+    CPPUNIT_ASSERT(!loaded->getMetadataPath(MD_TYPE_PRIMARY).empty());
+    CPPUNIT_ASSERT(written->content_tags == loaded->content_tags);
+    CPPUNIT_ASSERT(written->distro_tags == loaded->distro_tags);
+    CPPUNIT_ASSERT(written->metadata_locations == loaded->metadata_locations);
+    CPPUNIT_ASSERT_EQUAL(std::string("1528467025"), loaded->revision);
+    CPPUNIT_ASSERT_EQUAL(written->maxTimestamp, loaded->maxTimestamp);
+    CPPUNIT_ASSERT(mirrorList(written->mirrors) == mirrorList(loaded->mirrors));
+}
+
+void RepoCacheStateTest::testRepomdChanged()
+{
+    auto repomd = libdnf::repoGetImpl(repo.get())->repomdFn;
+    struct stat st;
+    CPPUNIT_ASSERT_EQUAL(0, stat(repomd.c_str(), &st));
+
+    // touched
+    auto mtime = st.st_mtim;
+    ++mtime.tv_sec;
+    setMtime(repomd, mtime);
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+    setMtime(repomd, st.st_mtim);
+    CPPUNIT_ASSERT(libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+
+    // rewritten with the mtime kept
+    writeFile(repomd, readFile(repomd) + "\n");
+    setMtime(repomd, st.st_mtim);
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+}
+
+void RepoCacheStateTest::testKeyMismatch()
+{
+    auto gpgcheck = createRepo();
+    libdnf::repoGetImpl(gpgcheck.get())->conf->repo_gpgcheck().set(libdnf::Option::Priority::RUNTIME, true);
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(gpgcheck.get())->loadCacheState());
+
+    auto other = createRepo();
+    other->setLoadMetadataOther(true);
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(other.get())->loadCacheState());
+
+    auto additional = createRepo();
+    additional->addMetadataTypeToDownload("modules");
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(additional.get())->loadCacheState());
+}
+
+void RepoCacheStateTest::testMissingMetadata()
+{
+    auto filelists = libdnf::repoGetImpl(repo.get())->getMetadataPath(MD_TYPE_FILELISTS);
+    CPPUNIT_ASSERT(!filelists.empty());
+    CPPUNIT_ASSERT_EQUAL(0, unlink(filelists.c_str()));
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+}
+
+void RepoCacheStateTest::testCorruptState()
+{
+    auto state = readFile(statePath());
+    CPPUNIT_ASSERT(state.size() > 8);
+
+    for (auto length : {std::string::size_type(0), std::string::size_type(4), state.size() / 2,
+                        state.size() - 1}) {
+        writeFile(statePath(), state.substr(0, length));
+        CPPUNIT_ASSERT_MESSAGE(std::to_string(length),
+                               !libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+    }
+
+    writeFile(statePath(), state + '\0');
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+
+    // another version of the format
+    auto version = state;
+    version[0] ^= 0x7f;
+    writeFile(statePath(), version);
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+
+    // a string longer than the file
+    auto length = state;
+    std::fill(length.begin() + 8, length.begin() + 16, '\x7f');
+    writeFile(statePath(), length);
+    CPPUNIT_ASSERT(!libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+
+    writeFile(statePath(), state);
+    CPPUNIT_ASSERT(libdnf::repoGetImpl(createRepo().get())->loadCacheState());
+}
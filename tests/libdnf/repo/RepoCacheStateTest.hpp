@@ -0,0 +1,42 @@
+#ifndef LIBDNF_REPOCACHESTATETEST_HPP
+#define LIBDNF_REPOCACHESTATETEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libdnf/conf/ConfigMain.hpp"
+#include "libdnf/repo/Repo.hpp"
+
+#include <memory>
+#include <string>
+
+class RepoCacheStateTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(RepoCacheStateTest);
+        CPPUNIT_TEST(testRoundTrip);
+        CPPUNIT_TEST(testRepomdChanged);
+        CPPUNIT_TEST(testKeyMismatch);
+        CPPUNIT_TEST(testMissingMetadata);
+        CPPUNIT_TEST(testCorruptState);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testRoundTrip();
+    void testRepomdChanged();
+    void testKeyMismatch();
+    void testMissingMetadata();
+    void testCorruptState();
+
+private:
+    std::unique_ptr<libdnf::Repo> createRepo();
+    std::string statePath() const;
+
+    std::string tmpdir;
+    libdnf::ConfigMain mainConfig;
+    std::unique_ptr<libdnf::Repo> repo;
+};
+
+#endif //LIBDNF_REPOCACHESTATETEST_HPP
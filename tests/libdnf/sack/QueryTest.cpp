@@ -149,3 +149,63 @@ void QueryTest::testQueryFilterAdvisory()
     g_object_unref(pkg);
     delete query;
 }
+
+void QueryTest::testQueryCopyIsIndependent()
+{
+    libdnf::Query query(sack);
+    query.apply();
+    auto total = query.size();
+    CPPUNIT_ASSERT(total > 0);
+
+    // Copies share the result until one of them is modified
+    libdnf::Query copy(query);
+    CPPUNIT_ASSERT(copy.size() == total);
+    copy.addFilter(HY_PKG_NAME, HY_EQ, "test-perl-DBI");
+    CPPUNIT_ASSERT(copy.size() > 0);
+    CPPUNIT_ASSERT(copy.size() < total);
+    CPPUNIT_ASSERT(query.size() == total);
+
+    libdnf::Query assigned(sack);
+    assigned = query;
+    assigned.installed();
+    CPPUNIT_ASSERT(assigned.size() == 0);
+    CPPUNIT_ASSERT(query.size() == total);
+}
+
+void QueryTest::testQueryExplainAnalyze()
+{
+    libdnf::Query query(sack);
+    query.addFilter(HY_PKG_REQUIRES, HY_GLOB, "*");
+    query.addFilter(HY_PKG_NAME, HY_EQ, "test-perl-DBI");
+
+    // the cheap name filter runs first
+    auto pipeline = query.explain();
+    CPPUNIT_ASSERT(pipeline.size() == 2);
+    CPPUNIT_ASSERT(pipeline[0].keyname == HY_PKG_NAME);
+    CPPUNIT_ASSERT(pipeline[0].nmatches == 1);
+    CPPUNIT_ASSERT(pipeline[1].keyname == HY_PKG_REQUIRES);
+    CPPUNIT_ASSERT(!pipeline[0].executed);
+
+    libdnf::Query total(sack);
+    query.setAnalyze(true);
+    query.apply();
+    auto & analysis = query.getAnalysis();
+    CPPUNIT_ASSERT(analysis.size() == 2);
+    CPPUNIT_ASSERT(analysis[0].executed);
+    CPPUNIT_ASSERT(analysis[0].inputSize == total.size());
+    CPPUNIT_ASSERT(analysis[0].outputSize < analysis[0].inputSize);
+    CPPUNIT_ASSERT(analysis[1].inputSize == analysis[0].outputSize);
+    CPPUNIT_ASSERT(analysis[1].outputSize == query.size());
+    CPPUNIT_ASSERT(analysis[1].elapsed >= 0);
+    CPPUNIT_ASSERT(query.explain().empty());
+}
+
+void QueryTest::testQueryGetStringsFromProvide()
+{
+    libdnf::Query query(sack, libdnf::Query::ExcludeFlags::IGNORE_EXCLUDES);
+    auto strings = query.getStringsFromProvide("test-perl-DBI");
+    CPPUNIT_ASSERT(strings == std::set<std::string>{"x86-64"});
+    // the name has to be followed by the parenthesis
+    CPPUNIT_ASSERT(query.getStringsFromProvide("test-perl").empty());
+    CPPUNIT_ASSERT(query.getStringsFromProvide("test-perl-DB").empty());
+}
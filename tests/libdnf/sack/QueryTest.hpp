@@ -13,6 +13,9 @@ class QueryTest : public CppUnit::TestCase
     CPPUNIT_TEST_SUITE(QueryTest);
         CPPUNIT_TEST(testQueryGetAdvisoryPkgs);
         CPPUNIT_TEST(testQueryFilterAdvisory);
+        CPPUNIT_TEST(testQueryCopyIsIndependent);
+        CPPUNIT_TEST(testQueryExplainAnalyze);
+        CPPUNIT_TEST(testQueryGetStringsFromProvide);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -21,6 +24,9 @@ public:
 
     void testQueryGetAdvisoryPkgs();
     void testQueryFilterAdvisory();
+    void testQueryCopyIsIndependent();
+    void testQueryExplainAnalyze();
+    void testQueryGetStringsFromProvide();
 
 private:
     DnfSack *sack = nullptr;
@@ -0,0 +1,105 @@
+#include "SubstringIndexTest.hpp"
+
+#include "libdnf/sack/substringindex.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SubstringIndexTest);
+
+void SubstringIndexTest::setUp()
+{}
+
+void SubstringIndexTest::tearDown()
+{}
+
+void SubstringIndexTest::testLookup()
+{
+    libdnf::SubstringIndex index;
+    index.add(2, "A library for parsing XML");
+    index.add(3, "Command line tool");
+    index.add(5, nullptr);
+    index.add(7, "xml tool");
+    index.finish();
+
+    std::vector<Id> candidates;
+    CPPUNIT_ASSERT(!index.lookup("xm", candidates));
+    CPPUNIT_ASSERT(index.lookup("XML", candidates));
+    CPPUNIT_ASSERT((candidates == std::vector<Id>{2, 7}));
+    CPPUNIT_ASSERT(index.lookup("line tool", candidates));
+    CPPUNIT_ASSERT((candidates == std::vector<Id>{3}));
+    CPPUNIT_ASSERT(index.lookup("json", candidates));
+    CPPUNIT_ASSERT(candidates.empty());
+
+    // all trigrams present but not in this order, left to the verification
+    CPPUNIT_ASSERT(index.lookup("toolxml", candidates));
+    CPPUNIT_ASSERT(candidates.empty());
+    CPPUNIT_ASSERT(index.lookup("ool", candidates));
+    CPPUNIT_ASSERT((candidates == std::vector<Id>{3, 7}));
+}
+
+void SubstringIndexTest::testSameAsStrstr()
+{
+    std::vector<std::string> texts;
+    unsigned int seed = 1;
+    for (int i = 0; i < 500; ++i) {
+        std::string text;
+        auto length = (seed = seed * 1103515245 + 12345) % 40;
+        for (unsigned int j = 0; j < length; ++j)
+            text.push_back("abcAB -"[((seed = seed * 1103515245 + 12345) >> 16) % 7]);
+        texts.push_back(text);
+    }
+    libdnf::SubstringIndex index;
+    for (std::size_t i = 0; i < texts.size(); ++i)
+        index.add(i + 1, texts[i].c_str());
+    index.finish();
+
+    std::vector<Id> candidates;
+    for (const char * match : {"abc", "aBc", "a-b", "  a", "cca", "bbbb", "ab ab", "c-CA-"}) {
+        CPPUNIT_ASSERT(index.lookup(match, candidates));
+        for (std::size_t i = 0; i < texts.size(); ++i) {
+            bool candidate = std::find(candidates.begin(), candidates.end(), i + 1) != candidates.end();
+            if (strcasestr(texts[i].c_str(), match))
+                CPPUNIT_ASSERT(candidate);
+        }
+    }
+}
+
+void SubstringIndexTest::testReadWrite()
+{
+    libdnf::SubstringIndex index;
+    index.add(2, "summary of a package");
+    index.add(4, "another package");
+    index.finish();
+
+    FILE * fp = tmpfile();
+    CPPUNIT_ASSERT(fp);
+    CPPUNIT_ASSERT(index.write(fp));
+    long size = ftell(fp);
+
+    rewind(fp);
+    libdnf::SubstringIndex loaded;
+    CPPUNIT_ASSERT(loaded.read(fp, 5));
+    std::vector<Id> candidates;
+    CPPUNIT_ASSERT(loaded.lookup("package", candidates));
+    CPPUNIT_ASSERT((candidates == std::vector<Id>{2, 4}));
+
+    // ids out of the pool are refused
+    rewind(fp);
+    CPPUNIT_ASSERT(!loaded.read(fp, 4));
+    CPPUNIT_ASSERT(loaded.lookup("package", candidates));
+    CPPUNIT_ASSERT(candidates.empty());
+
+    // so is a truncated file
+    std::vector<char> data(size);
+    rewind(fp);
+    CPPUNIT_ASSERT(fread(data.data(), 1, data.size(), fp) == data.size());
+    fclose(fp);
+    fp = fmemopen(data.data(), data.size() - 1, "r");
+    CPPUNIT_ASSERT(fp);
+    CPPUNIT_ASSERT(!loaded.read(fp, 5));
+    fclose(fp);
+}
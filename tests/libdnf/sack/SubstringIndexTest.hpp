@@ -0,0 +1,24 @@
+#ifndef LIBDNF_SUBSTRINGINDEXTEST_HPP
+#define LIBDNF_SUBSTRINGINDEXTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class SubstringIndexTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(SubstringIndexTest);
+        CPPUNIT_TEST(testLookup);
+        CPPUNIT_TEST(testSameAsStrstr);
+        CPPUNIT_TEST(testReadWrite);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testLookup();
+    void testSameAsStrstr();
+    void testReadWrite();
+};
+
+#endif //LIBDNF_SUBSTRINGINDEXTEST_HPP
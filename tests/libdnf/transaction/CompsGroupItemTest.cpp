@@ -6,6 +6,7 @@
 #include "../backports.hpp"
 
 #include "libdnf/transaction/CompsGroupItem.hpp"
+#include "libdnf/transaction/Swdb.hpp"
 #include "libdnf/transaction/Transformer.hpp"
 
 #include "CompsGroupItemTest.hpp"
@@ -102,3 +103,75 @@ CompsGroupItemTest::testGetTransactionItems()
         CPPUNIT_ASSERT_EQUAL(std::string("rpm"), pkg->getName());
     }
 }
+
+void
+CompsGroupItemTest::testGetPackageCompsGroups()
+{
+    auto core = createCompsGroup(conn);
+    auto base = std::make_shared< CompsGroupItem >(conn);
+    base->setGroupId("base");
+    base->setName("Base");
+    base->setPackageTypes(CompsPackageType::DEFAULT);
+    base->addPackage("bash", true, CompsPackageType::MANDATORY);
+    base->save();
+
+    libdnf::swdb_private::Transaction trans(conn);
+    trans.addItem(core, "", TransactionItemAction::INSTALL, TransactionItemReason::USER)
+        ->setState(TransactionItemState::DONE);
+    trans.addItem(base, "", TransactionItemAction::INSTALL, TransactionItemReason::USER)
+        ->setState(TransactionItemState::DONE);
+    trans.begin();
+    trans.finish(TransactionState::DONE);
+
+    libdnf::swdb_private::Transaction trans2(conn);
+    trans2.addItem(base, "", TransactionItemAction::REMOVE, TransactionItemReason::USER)
+        ->setState(TransactionItemState::DONE);
+    trans2.begin();
+    trans2.finish(TransactionState::DONE);
+
+    Swdb swdb(conn);
+    // the removal of base is the last record of that group
+    CPPUNIT_ASSERT(swdb.getPackageCompsGroups("bash") == std::vector< std::string >{"core"});
+    // rpm is not installed by the group
+    CPPUNIT_ASSERT(swdb.getPackageCompsGroups("rpm").empty());
+
+    auto groups = swdb.getPackagesCompsGroups({"bash", "rpm", "zsh"});
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), groups.size());
+    CPPUNIT_ASSERT(groups["bash"] == std::vector< std::string >{"core"});
+}
+
+void
+CompsGroupItemTest::testGetCompsGroupItemsByPattern()
+{
+    libdnf::swdb_private::Transaction trans(conn);
+    auto grp = createCompsGroup(conn);
+    trans.addItem(grp, "", TransactionItemAction::INSTALL, TransactionItemReason::USER)
+        ->setState(TransactionItemState::DONE);
+    trans.begin();
+    trans.finish(TransactionState::DONE);
+
+    Swdb swdb(conn);
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), swdb.getCompsGroupItemsByPattern("core").size());
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), swdb.getCompsGroupItemsByPattern("CORE").size());
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), swdb.getCompsGroupItemsByPattern("c*").size());
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), swdb.getCompsGroupItemsByPattern("smallest%").size());
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), swdb.getCompsGroupItemsByPattern("c_re").size());
+    CPPUNIT_ASSERT(swdb.getCompsGroupItemsByPattern("cor").empty());
+    CPPUNIT_ASSERT(swdb.getCompsGroupItemsByPattern("base").empty());
+
+    // a new transaction invalidates the index
+    auto base = std::make_shared< CompsGroupItem >(conn);
+    base->setGroupId("base");
+    base->setName("Base");
+    base->setPackageTypes(CompsPackageType::DEFAULT);
+    libdnf::swdb_private::Transaction trans2(conn);
+    trans2.addItem(base, "", TransactionItemAction::INSTALL, TransactionItemReason::USER)
+        ->setState(TransactionItemState::DONE);
+    trans2.begin();
+    trans2.finish(TransactionState::DONE);
+
+    auto items = swdb.getCompsGroupItemsByPattern("base");
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), items.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("base"), items.at(0)->getCompsGroupItem()->getGroupId());
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(2), swdb.getCompsGroupItemsByPattern("*").size());
+}
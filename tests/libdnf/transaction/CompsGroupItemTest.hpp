@@ -10,6 +10,8 @@ class CompsGroupItemTest : public CppUnit::TestCase {
     CPPUNIT_TEST_SUITE(CompsGroupItemTest);
     CPPUNIT_TEST(testCreate);
     CPPUNIT_TEST(testGetTransactionItems);
+    CPPUNIT_TEST(testGetPackageCompsGroups);
+    CPPUNIT_TEST(testGetCompsGroupItemsByPattern);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -18,6 +20,8 @@ public:
 
     void testCreate();
     void testGetTransactionItems();
+    void testGetPackageCompsGroups();
+    void testGetCompsGroupItemsByPattern();
 
 private:
     std::shared_ptr< SQLite3 > conn;
@@ -1,5 +1,6 @@
 #include <string>
 
+#include "libdnf/hy-iutil-private.hpp"
 #include "libdnf/transaction/Swdb.hpp"
 #include "libdnf/transaction/Transaction.hpp"
 #include "libdnf/transaction/Transformer.hpp"
@@ -74,6 +75,48 @@ MigrationTest::testNonEmptyCommentAfterMigration()
     CPPUNIT_ASSERT_EQUAL(trans.getComment(), std::string("Test comment"));
 }
 
+void
+MigrationTest::testReadOnlyOpen()
+{
+    g_autoptr(GError) error = nullptr;
+    g_autofree gchar *tmpdir = g_strdup("/tmp/libdnfXXXXXX");
+    CPPUNIT_ASSERT(mkdtemp(tmpdir));
+    std::string current = std::string(tmpdir) + "/current.sqlite";
+    std::string outdated = std::string(tmpdir) + "/outdated.sqlite";
+
+    auto writer = std::make_shared< SQLite3 >(current);
+    writer->exec(test_sql_create_tables);
+    {
+        Swdb swdb(writer); // migrate
+        swdb.initTransaction();
+        swdb.beginTransaction(1, "", "", 0);
+        swdb.endTransaction(2, "", TransactionState::DONE);
+        swdb.closeTransaction();
+    }
+    SQLite3(outdated).exec(test_sql_create_tables);
+
+    // Swdb closed the connection, keep a writer connected while the database is read
+    writer->open();
+    SQLite3::Options options;
+    options.readOnly = true;
+    {
+        Swdb reader(current, options);
+        CPPUNIT_ASSERT_EQUAL(current, reader.getPath());
+        auto trans = reader.getLastTransaction();
+        CPPUNIT_ASSERT(trans);
+        CPPUNIT_ASSERT_EQUAL(static_cast< int64_t >(1), trans->getDtBegin());
+    }
+    {
+        // a read-only connection cannot migrate the schema
+        Swdb reader(outdated, options);
+        CPPUNIT_ASSERT_EQUAL(std::string(":memory:"), reader.getPath());
+    }
+
+    writer->close();
+    dnf_remove_recursive_v2(tmpdir, &error);
+    g_assert_no_error(error);
+}
+
 void
 MigrationTest::tearDown()
 {
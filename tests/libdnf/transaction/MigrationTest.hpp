@@ -13,6 +13,7 @@ class MigrationTest : public CppUnit::TestCase {
     CPPUNIT_TEST(testVersionAfterMigration);
     CPPUNIT_TEST(testEmptyCommentAfterMigration);
     CPPUNIT_TEST(testNonEmptyCommentAfterMigration);
+    CPPUNIT_TEST(testReadOnlyOpen);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -24,6 +25,7 @@ public:
     void testVersionAfterMigration();
     void testEmptyCommentAfterMigration();
     void testNonEmptyCommentAfterMigration();
+    void testReadOnlyOpen();
 
 private:
     std::shared_ptr< SQLite3 > history;
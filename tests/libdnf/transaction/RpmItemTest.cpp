@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "../backports.hpp"
 
@@ -119,3 +120,119 @@ RpmItemTest::testGetTransactionItems()
     //CPPUNIT_ASSERT(createMs.count() == 0);
     //CPPUNIT_ASSERT(readMs.count() == 0);
 }
+
+void
+RpmItemTest::testGetTransactionItemColumns()
+{
+    libdnf::swdb_private::Transaction trans(conn);
+    for (auto name : {"bash", "glibc", "kernel"}) {
+        auto rpm = std::make_shared< RPMItem >(conn);
+        rpm->setName(name);
+        rpm->setEpoch(name == std::string("kernel") ? 1 : 0);
+        rpm->setVersion("1.0");
+        rpm->setRelease("1.fc26");
+        rpm->setArch("x86_64");
+        auto action = name == std::string("bash") ? TransactionItemAction::REMOVE
+                                                   : TransactionItemAction::INSTALL;
+        auto ti = trans.addItem(rpm, "base", action, TransactionItemReason::USER);
+        ti->setState(TransactionItemState::DONE);
+    }
+    trans.begin();
+    trans.finish(TransactionState::DONE);
+
+    auto items = RPMItem::getTransactionItems(conn, trans.getId());
+    auto columns = RPMItem::getTransactionItemColumns(conn, trans.getId());
+    CPPUNIT_ASSERT_EQUAL(items.size(), columns.size());
+    for (std::size_t row = 0; row < columns.size(); ++row) {
+        auto rpm = std::dynamic_pointer_cast< RPMItem >(items[row]->getItem());
+        CPPUNIT_ASSERT_EQUAL(items[row]->getId(), columns.getId(row));
+        CPPUNIT_ASSERT(items[row]->getAction() == columns.getAction(row));
+        CPPUNIT_ASSERT_EQUAL(std::string("base"), columns.getRepoid(row));
+        CPPUNIT_ASSERT_EQUAL(rpm->getNEVRA(), columns.getNEVRA(row));
+
+        auto materialized = columns.getTransactionItem(row);
+        CPPUNIT_ASSERT_EQUAL(items[row]->getId(), materialized->getId());
+        CPPUNIT_ASSERT_EQUAL(rpm->getNEVRA(),
+                             std::dynamic_pointer_cast< RPMItem >(materialized->getItem())->getNEVRA());
+    }
+
+    auto counts = trans.getItemCounts();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), counts.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(1), counts[TransactionItemAction::REMOVE]);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), counts[TransactionItemAction::INSTALL]);
+}
+
+void
+RpmItemTest::testCachedQuery()
+{
+    for (auto name : {"bash", "glibc", "kernel"}) {
+        RPMItem rpm(conn);
+        rpm.setName(name);
+        rpm.setEpoch(0);
+        rpm.setVersion("1.0");
+        rpm.setRelease("1.fc26");
+        rpm.setArch("x86_64");
+        rpm.save();
+
+        // the statements prepared by the first save are reused
+        RPMItem rpm2(conn, rpm.getId());
+        CPPUNIT_ASSERT_EQUAL(std::string(name), rpm2.getName());
+    }
+
+    const char *sql = "SELECT name FROM rpm ORDER BY name";
+    auto first = conn->getCachedQuery(sql);
+    auto firstStatement = first.get();
+    first.reset();
+
+    auto outer = conn->getCachedQuery(sql);
+    CPPUNIT_ASSERT(outer.get() == firstStatement);
+    CPPUNIT_ASSERT(outer->step() == SQLite3::Statement::StepResult::ROW);
+    CPPUNIT_ASSERT_EQUAL(std::string("bash"), outer->get< std::string >(0));
+    {
+        // the same SQL while the first query is in use gets its own statement
+        auto inner = conn->getCachedQuery(sql);
+        CPPUNIT_ASSERT(inner.get() != outer.get());
+        CPPUNIT_ASSERT(inner->step() == SQLite3::Statement::StepResult::ROW);
+        CPPUNIT_ASSERT_EQUAL(std::string("bash"), inner->get< std::string >(0));
+    }
+    CPPUNIT_ASSERT(outer->step() == SQLite3::Statement::StepResult::ROW);
+    CPPUNIT_ASSERT_EQUAL(std::string("glibc"), outer->get< std::string >(0));
+    outer.reset();
+
+    // a reused statement starts from the first row
+    auto again = conn->getCachedQuery(sql);
+    CPPUNIT_ASSERT(again->step() == SQLite3::Statement::StepResult::ROW);
+    CPPUNIT_ASSERT_EQUAL(std::string("bash"), again->get< std::string >(0));
+}
+
+void
+RpmItemTest::testSearchTransactions()
+{
+    std::vector< std::vector< std::string > > transNames = {{"bash", "bash-completion"}, {"kernel"}};
+    std::vector< int64_t > ids;
+    for (const auto &names : transNames) {
+        libdnf::swdb_private::Transaction trans(conn);
+        for (const auto &name : names) {
+            auto rpm = std::make_shared< RPMItem >(conn);
+            rpm->setName(name);
+            rpm->setEpoch(0);
+            rpm->setVersion("1");
+            rpm->setRelease("2");
+            rpm->setArch("x86_64");
+            auto ti = trans.addItem(rpm, "base", TransactionItemAction::INSTALL, TransactionItemReason::USER);
+            ti->setState(TransactionItemState::DONE);
+        }
+        trans.begin();
+        trans.finish(TransactionState::DONE);
+        ids.push_back(trans.getId());
+    }
+
+    typedef std::vector< int64_t > Ids;
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"bash"}) == Ids({ids[0]}));
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"bash-*"}) == Ids({ids[0]}));
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"ba"}).empty());
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"*e*"}) == Ids({ids[0], ids[1]}));
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"x86_64"}) == Ids({ids[0], ids[1]}));
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"kernel", "bash"}) == Ids({ids[0], ids[1]}));
+    CPPUNIT_ASSERT(RPMItem::searchTransactions(conn, {"k*", "b?sh"}) == Ids({ids[0], ids[1]}));
+}
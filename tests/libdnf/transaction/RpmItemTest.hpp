@@ -10,6 +10,9 @@ class RpmItemTest : public CppUnit::TestCase {
     CPPUNIT_TEST(testCreate);
     CPPUNIT_TEST(testCreateDuplicates);
     CPPUNIT_TEST(testGetTransactionItems);
+    CPPUNIT_TEST(testGetTransactionItemColumns);
+    CPPUNIT_TEST(testCachedQuery);
+    CPPUNIT_TEST(testSearchTransactions);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -19,6 +22,9 @@ public:
     void testCreate();
     void testCreateDuplicates();
     void testGetTransactionItems();
+    void testGetTransactionItemColumns();
+    void testCachedQuery();
+    void testSearchTransactions();
 
 private:
     std::shared_ptr< SQLite3 > conn;
@@ -325,6 +325,116 @@ TransactionItemReasonTest::testRemovedPackage()
         static_cast< TransactionItemReason >(swdb.resolveRPMTransactionItemReason("bash", "", -1)));
 }
 
+// bulk resolution -> the same reasons as resolving the packages one by one
+void
+TransactionItemReasonTest::testResolveAllReasons()
+{
+    Swdb swdb(conn);
+
+    auto rpm_bash = std::make_shared< RPMItem >(conn);
+    rpm_bash->setName("bash");
+    rpm_bash->setEpoch(0);
+    rpm_bash->setVersion("4.4.12");
+    rpm_bash->setRelease("5.fc26");
+    rpm_bash->setArch("x86_64");
+
+    auto rpm_glibc = std::make_shared< RPMItem >(conn);
+    rpm_glibc->setName("glibc");
+    rpm_glibc->setEpoch(0);
+    rpm_glibc->setVersion("2.26");
+    rpm_glibc->setRelease("6.fc27");
+    rpm_glibc->setArch("i686");
+
+    std::string repoid = "base";
+
+    swdb.initTransaction();
+    auto ti = swdb.addItem(
+        rpm_bash, repoid, TransactionItemAction::INSTALL, TransactionItemReason::DEPENDENCY);
+    ti->setState(TransactionItemState::DONE);
+    ti = swdb.addItem(
+        rpm_glibc, repoid, TransactionItemAction::INSTALL, TransactionItemReason::USER);
+    ti->setState(TransactionItemState::DONE);
+    swdb.beginTransaction(1, "", "", 0);
+    swdb.endTransaction(2, "", TransactionState::DONE);
+    swdb.closeTransaction();
+
+    swdb.initTransaction();
+    ti = swdb.addItem(
+        rpm_bash, repoid, TransactionItemAction::REASON_CHANGE, TransactionItemReason::GROUP);
+    ti->setState(TransactionItemState::DONE);
+    ti = swdb.addItem(
+        rpm_glibc, repoid, TransactionItemAction::REMOVE, TransactionItemReason::USER);
+    ti->setState(TransactionItemState::DONE);
+    swdb.beginTransaction(3, "", "", 0);
+    swdb.endTransaction(4, "", TransactionState::DONE);
+    swdb.closeTransaction();
+
+    auto reasons = RPMItem::resolveTransactionItemReasons(conn);
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(1), reasons.size());
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::GROUP, reasons.at("bash.x86_64"));
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::GROUP,
+                         static_cast< TransactionItemReason >(
+                             swdb.resolveRPMTransactionItemReason("bash", "x86_64", -1)));
+    CPPUNIT_ASSERT(reasons.find("glibc.i686") == reasons.end());
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::UNKNOWN,
+                         static_cast< TransactionItemReason >(
+                             swdb.resolveRPMTransactionItemReason("glibc", "i686", -1)));
+}
+
+// a finished transaction invalidates the cached reasons and repos
+void
+TransactionItemReasonTest::testReasonCache()
+{
+    Swdb swdb(conn);
+
+    auto rpm_bash = std::make_shared< RPMItem >(conn);
+    rpm_bash->setName("bash");
+    rpm_bash->setEpoch(0);
+    rpm_bash->setVersion("4.4.12");
+    rpm_bash->setRelease("5.fc26");
+    rpm_bash->setArch("x86_64");
+
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::UNKNOWN,
+                         static_cast< TransactionItemReason >(
+                             swdb.resolveRPMTransactionItemReason("bash", "x86_64", -1)));
+    CPPUNIT_ASSERT_EQUAL(std::string(), swdb.getRPMRepo("bash-0:4.4.12-5.fc26.x86_64"));
+
+    swdb.initTransaction();
+    auto ti = swdb.addItem(
+        rpm_bash, "base", TransactionItemAction::INSTALL, TransactionItemReason::DEPENDENCY);
+    ti->setState(TransactionItemState::DONE);
+    swdb.beginTransaction(1, "", "", 0);
+    swdb.endTransaction(2, "", TransactionState::DONE);
+    swdb.closeTransaction();
+
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::DEPENDENCY,
+                         static_cast< TransactionItemReason >(
+                             swdb.resolveRPMTransactionItemReason("bash", "x86_64", -1)));
+    CPPUNIT_ASSERT_EQUAL(std::string("base"), swdb.getRPMRepo("bash-0:4.4.12-5.fc26.x86_64"));
+
+    swdb.initTransaction();
+    ti = swdb.addItem(
+        rpm_bash, "base", TransactionItemAction::REASON_CHANGE, TransactionItemReason::USER);
+    ti->setState(TransactionItemState::DONE);
+    swdb.beginTransaction(3, "", "", 0);
+    swdb.endTransaction(4, "", TransactionState::DONE);
+    swdb.closeTransaction();
+
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::USER,
+                         static_cast< TransactionItemReason >(
+                             swdb.resolveRPMTransactionItemReason("bash", "x86_64", -1)));
+
+    // the bulk lookup accepts the NEVRAs with and without the epoch
+    auto repos = swdb.getRPMRepos({"bash-4.4.12-5.fc26.x86_64",
+                                   "bash-0:4.4.12-5.fc26.x86_64",
+                                   "glibc-0:2.26-15.fc27.x86_64"});
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(2), repos.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("base"), repos.at("bash-4.4.12-5.fc26.x86_64"));
+    CPPUNIT_ASSERT_EQUAL(std::string("base"), repos.at("bash-0:4.4.12-5.fc26.x86_64"));
+    CPPUNIT_ASSERT_EQUAL(std::string("base"), swdb.getRPMRepo("bash-4.4.12-5.fc26.x86_64"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), swdb.getRPMRepo("glibc-0:2.26-15.fc27.x86_64"));
+}
+
 void
 TransactionItemReasonTest::testCompareReasons()
 {
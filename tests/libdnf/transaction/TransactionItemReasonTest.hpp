@@ -15,6 +15,8 @@ class TransactionItemReasonTest : public CppUnit::TestCase {
     CPPUNIT_TEST(test_OneTransaction_TwoTransactionItems);
     CPPUNIT_TEST(test_TwoTransactions_TwoTransactionItems);
     CPPUNIT_TEST(testRemovedPackage);
+    CPPUNIT_TEST(testResolveAllReasons);
+    CPPUNIT_TEST(testReasonCache);
     CPPUNIT_TEST(testCompareReasons);
     CPPUNIT_TEST(testTransactionItemReasonCompare);
     CPPUNIT_TEST_SUITE_END();
@@ -30,6 +32,8 @@ public:
     void test_OneTransaction_TwoTransactionItems();
     void test_TwoTransactions_TwoTransactionItems();
     void testRemovedPackage();
+    void testResolveAllReasons();
+    void testReasonCache();
     void testCompareReasons();
     void testTransactionItemReasonCompare();
 
@@ -1,6 +1,7 @@
 #include "libdnf/hy-subject.h"
 #include "libdnf/nevra.hpp"
 #include "libdnf/transaction/RPMItem.hpp"
+#include "libdnf/transaction/Swdb.hpp"
 #include "libdnf/transaction/Transaction.hpp"
 #include "libdnf/transaction/private/Transaction.hpp"
 #include "libdnf/transaction/Transformer.hpp"
@@ -153,3 +154,63 @@ TransactionTest::testComparison()
     second.setRpmdbVersionBegin("0");
     CPPUNIT_ASSERT(first == second);
 }
+
+void
+TransactionTest::testListPages()
+{
+    Swdb swdb(conn);
+    for (int64_t i = 1; i <= 5; ++i) {
+        swdb_private::Transaction trans(conn);
+        trans.setDtBegin(i * 10);
+        trans.setCmdline("cmd " + std::to_string(i));
+        trans.begin();
+    }
+
+    auto first = swdb.listTransactions(0, 2);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), first.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(1), first[0]->getId());
+    CPPUNIT_ASSERT_EQUAL(int64_t(10), first[0]->getDtBegin());
+    CPPUNIT_ASSERT_EQUAL(std::string("cmd 1"), first[0]->getCmdline());
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), first[1]->getId());
+
+    auto rest = swdb.listTransactions(first.back()->getId(), 0);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), rest.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(3), rest[0]->getId());
+    CPPUNIT_ASSERT_EQUAL(int64_t(5), rest[2]->getId());
+
+    auto newest = swdb.listTransactions(0, 2, true);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), newest.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(5), newest[0]->getId());
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), newest[1]->getId());
+
+    auto older = swdb.listTransactions(newest.back()->getId(), 10, true);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), older.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(1), older.back()->getId());
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(5), swdb.listTransactions().size());
+}
+
+void
+TransactionTest::testConsoleOutput()
+{
+    swdb_private::Transaction trans(conn);
+    trans.begin();
+    trans.addConsoleOutputLine(1, "Running scriptlet");
+    trans.addConsoleOutputLine(2, "");
+    trans.addConsoleOutputLine(2, "multi\nline");
+    trans.finish(TransactionState::DONE);
+
+    // all the lines are stored in a single compressed block
+    SQLite3::Query count(*conn, "SELECT COUNT(*) FROM console_output_block");
+    count.step();
+    CPPUNIT_ASSERT_EQUAL(1, count.get< int >(0));
+
+    Transaction trans2(conn, trans.getId());
+    auto output = trans2.getConsoleOutput();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), output.size());
+    CPPUNIT_ASSERT_EQUAL(1, output[0].first);
+    CPPUNIT_ASSERT_EQUAL(std::string("Running scriptlet"), output[0].second);
+    CPPUNIT_ASSERT_EQUAL(2, output[1].first);
+    CPPUNIT_ASSERT_EQUAL(std::string(), output[1].second);
+    CPPUNIT_ASSERT_EQUAL(std::string("multi\nline"), output[2].second);
+}
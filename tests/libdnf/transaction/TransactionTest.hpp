@@ -12,6 +12,8 @@ class TransactionTest : public CppUnit::TestCase {
     CPPUNIT_TEST(testInsertWithSpecifiedId);
     CPPUNIT_TEST(testUpdate);
     CPPUNIT_TEST(testComparison);
+    CPPUNIT_TEST(testListPages);
+    CPPUNIT_TEST(testConsoleOutput);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -22,6 +24,8 @@ public:
     void testInsertWithSpecifiedId();
     void testUpdate();
     void testComparison();
+    void testListPages();
+    void testConsoleOutput();
 
 private:
     std::shared_ptr< SQLite3 > conn;
@@ -0,0 +1,88 @@
+#include "AsyncLoggerTest.hpp"
+
+#include "libdnf/utils/AsyncLogger.hpp"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AsyncLoggerTest);
+
+namespace {
+
+class MemoryLogger : public libdnf::Logger {
+public:
+    void write(int, time_t, pid_t, Level, const std::string & message) override
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        messages.push_back(message);
+    }
+
+    std::vector<std::string> getMessages()
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        return messages;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> messages;
+};
+
+}
+
+void AsyncLoggerTest::setUp()
+{}
+
+void AsyncLoggerTest::tearDown()
+{}
+
+void AsyncLoggerTest::testOrder()
+{
+    MemoryLogger target;
+    {
+        // a small ring makes the writers wait for the background thread
+        libdnf::AsyncLogger logger(target, 4);
+        for (int i = 0; i < 100; ++i)
+            logger.debug(std::to_string(i));
+        logger.flush();
+        CPPUNIT_ASSERT_EQUAL(std::size_t{100}, target.getMessages().size());
+        logger.info("last");
+    }
+
+    auto messages = target.getMessages();
+    CPPUNIT_ASSERT_EQUAL(std::size_t{101}, messages.size());
+    for (int i = 0; i < 100; ++i)
+        CPPUNIT_ASSERT_EQUAL(std::to_string(i), messages[i]);
+    CPPUNIT_ASSERT_EQUAL(std::string("last"), messages.back());
+}
+
+void AsyncLoggerTest::testErrorIsSynchronous()
+{
+    MemoryLogger target;
+    libdnf::AsyncLogger logger(target);
+    logger.debug("debug");
+    logger.error("error");
+
+    auto messages = target.getMessages();
+    CPPUNIT_ASSERT_EQUAL(std::size_t{2}, messages.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("error"), messages[1]);
+}
+
+void AsyncLoggerTest::testMaxLevel()
+{
+    MemoryLogger target;
+    libdnf::AsyncLogger logger(target);
+    logger.setMaxLevel(libdnf::Logger::Level::INFO);
+    CPPUNIT_ASSERT(logger.isEnabled(libdnf::Logger::Level::WARNING));
+    CPPUNIT_ASSERT(!logger.isEnabled(libdnf::Logger::Level::DEBUG));
+
+    logger.debug("debug");
+    logger.trace(libdnf::Logger::LOG_SOURCE_LIBREPO, "trace");
+    logger.info("info");
+    logger.flush();
+
+    auto messages = target.getMessages();
+    CPPUNIT_ASSERT_EQUAL(std::size_t{1}, messages.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("info"), messages[0]);
+}
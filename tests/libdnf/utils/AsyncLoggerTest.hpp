@@ -0,0 +1,24 @@
+#ifndef LIBDNF_ASYNCLOGGERTEST_HPP
+#define LIBDNF_ASYNCLOGGERTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class AsyncLoggerTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(AsyncLoggerTest);
+        CPPUNIT_TEST(testOrder);
+        CPPUNIT_TEST(testErrorIsSynchronous);
+        CPPUNIT_TEST(testMaxLevel);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testOrder();
+    void testErrorIsSynchronous();
+    void testMaxLevel();
+};
+
+#endif //LIBDNF_ASYNCLOGGERTEST_HPP
@@ -0,0 +1,42 @@
+#include "GlobMatcherTest.hpp"
+
+#include "libdnf/utils/GlobMatcher.hpp"
+
+#include <fnmatch.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(GlobMatcherTest);
+
+void GlobMatcherTest::setUp()
+{}
+
+void GlobMatcherTest::tearDown()
+{}
+
+void GlobMatcherTest::testPrefix()
+{
+    CPPUNIT_ASSERT_EQUAL(std::string("python3-"), libdnf::GlobMatcher("python3-*").getPrefix());
+    CPPUNIT_ASSERT_EQUAL(std::string("lib"), libdnf::GlobMatcher("lib?ar*").getPrefix());
+    CPPUNIT_ASSERT_EQUAL(std::string("a*b"), libdnf::GlobMatcher("a\\*b[cd]").getPrefix());
+    CPPUNIT_ASSERT(libdnf::GlobMatcher("*-devel").getPrefix().empty());
+    CPPUNIT_ASSERT(libdnf::GlobMatcher("Python*", FNM_CASEFOLD).getPrefix().empty());
+}
+
+void GlobMatcherTest::testSameAsFnmatch()
+{
+    const char * patterns[]{
+        "python3-*", "*-devel", "*lib*", "lib?*.so", "a*b*c", "[[:alpha:]]*x*y", "*[]]*x*", "*[!]]x*",
+        "[a*b*]", "a[", "a\\", "a\\*b*", "*[[:digit:]]", "??", "*", "",
+    };
+    const char * strings[]{
+        "python3-libs", "python2-libs", "python3", "glibc-devel", "devel", "libfoo.so", "lib.so",
+        "abc", "acb", "ax1y", "]x", "x]x", "a", "b", "*", "a[", "a\\", "a*bc", "ab", "x1", "",
+    };
+    for (auto pattern : patterns) {
+        for (int flags : {0, FNM_CASEFOLD}) {
+            libdnf::GlobMatcher matcher(pattern, flags);
+            for (auto str : strings) {
+                CPPUNIT_ASSERT_EQUAL(fnmatch(pattern, str, flags) == 0, matcher.match(str));
+            }
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef LIBDNF_GLOBMATCHERTEST_HPP
+#define LIBDNF_GLOBMATCHERTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class GlobMatcherTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(GlobMatcherTest);
+        CPPUNIT_TEST(testPrefix);
+        CPPUNIT_TEST(testSameAsFnmatch);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testPrefix();
+    void testSameAsFnmatch();
+};
+
+#endif //LIBDNF_GLOBMATCHERTEST_HPP
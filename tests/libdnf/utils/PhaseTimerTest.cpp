@@ -0,0 +1,49 @@
+#include "PhaseTimerTest.hpp"
+
+#include "libdnf/utils/PhaseTimer.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PhaseTimerTest);
+
+void PhaseTimerTest::setUp()
+{
+    wasEnabled = libdnf::PhaseTimings::isEnabled();
+    libdnf::PhaseTimings::clear();
+}
+
+void PhaseTimerTest::tearDown()
+{
+    libdnf::PhaseTimings::setEnabled(wasEnabled);
+    libdnf::PhaseTimings::clear();
+}
+
+void PhaseTimerTest::testDisabled()
+{
+    libdnf::PhaseTimings::setEnabled(false);
+    {
+        libdnf::PhaseTimer timer("phase");
+    }
+    CPPUNIT_ASSERT(libdnf::PhaseTimings::get().empty());
+}
+
+void PhaseTimerTest::testNested()
+{
+    libdnf::PhaseTimings::setEnabled(true);
+    {
+        libdnf::PhaseTimer outer("outer");
+        libdnf::PhaseTimer inner("inner", "repo");
+    }
+
+    auto timings = libdnf::PhaseTimings::get();
+    CPPUNIT_ASSERT_EQUAL(std::size_t{2}, timings.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("inner"), timings[0].phase);
+    CPPUNIT_ASSERT_EQUAL(std::string("repo"), timings[0].repoId);
+    CPPUNIT_ASSERT_EQUAL(1, timings[0].depth);
+    CPPUNIT_ASSERT_EQUAL(std::string("outer"), timings[1].phase);
+    CPPUNIT_ASSERT(timings[1].repoId.empty());
+    CPPUNIT_ASSERT_EQUAL(0, timings[1].depth);
+    CPPUNIT_ASSERT(timings[1].wallTime >= timings[0].wallTime);
+
+    auto report = libdnf::PhaseTimings::report();
+    CPPUNIT_ASSERT(report.find("\n  inner ") != std::string::npos);
+    CPPUNIT_ASSERT(report.find("\nouter ") != std::string::npos);
+}
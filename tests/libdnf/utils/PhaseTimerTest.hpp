@@ -0,0 +1,25 @@
+#ifndef LIBDNF_PHASETIMERTEST_HPP
+#define LIBDNF_PHASETIMERTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class PhaseTimerTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(PhaseTimerTest);
+        CPPUNIT_TEST(testDisabled);
+        CPPUNIT_TEST(testNested);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testDisabled();
+    void testNested();
+
+private:
+    bool wasEnabled;
+};
+
+#endif //LIBDNF_PHASETIMERTEST_HPP